@@ -0,0 +1,1325 @@
+/*----------------------------------------------------------------------------
+Name         benchcases.cpp
+
+Purpose      Benchmark cases for the calculation and logging hot paths;
+
+Notes        Inputs are built before each case is timed, so the cases only
+             measure the calls they are named after.  Latitudes, longitudes,
+             and times cycle through fixed grids so that no single case is
+             timed against one lucky input;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "benchcases.h"
+
+#include "solarcalc.h" // USES SolarCalc, the object under test;
+#include "solarephemeriscache.h" // USES SolarEphemerisCache;
+#include "sunposition.h" // USES the precision tiers, the objects under test;
+#include "timezonetable.h" // USES TimeZoneTable, the object under test;
+#include "fastmath.h" // USES the fastmath kernels, the objects under test;
+#include "gotcalc.h" // USES GotCalc, the object under test;
+#include "fluxspectrum.h" // USES FluxSpectrum, the object under test;
+#include "gotuncertainty.h" // USES GotUncertainty, the object under test;
+#include "sunscan.h" // USES SunScan, the object under test;
+#include "suntracker.h" // USES SunTracker, the object under test;
+#include "simulatedcontroller.h" // USES SimulatedController to follow it;
+#include "sunshare.h" // USES SunSharePublisher, the object under test;
+#include "logfile.h" // USES LogFile, the object under test;
+#include "radiometercapture.h" // USES the capture file, the object under test;
+#include "powerstats.h" // USES PowerStats, the object under test;
+#include <QDir>
+#include <QFile>
+#include <vector>
+
+namespace
+{
+    // Sites and times cycled through by the solar cases;
+    const int grid_latitudes = 13;
+    const int grid_longitudes = 24;
+    const int grid_sites = grid_latitudes * grid_longitudes;
+
+    // Builds a grid of sites covering the inhabited latitudes;
+    void buildSiteGrid(std::vector<double>& rLatitudes
+                       , std::vector<double>& rLongitudes)
+    {
+        rLatitudes.clear();
+        rLongitudes.clear();
+        for (int i = 0; i < grid_latitudes; i++)
+        {
+            for (int j = 0; j < grid_longitudes; j++)
+            {
+                rLatitudes.push_back(-60.0 + 10.0 * i);
+                rLongitudes.push_back(-172.5 + 15.0 * j);
+            }
+        }
+    }
+
+    // Builds evenly spaced times, in seconds since midnight;
+    std::vector<double> buildTimes(const int& rCount)
+    {
+        std::vector<double> times(rCount);
+        for (int i = 0; i < rCount; i++)
+        {
+            times[i] = 86400.0 * i / rCount;
+        }
+        return times;
+    }
+
+    // Builds an hour of repeatable radiometer samples at 1 kHz, as the
+    // quantised readings of a detector, with a step half way through where
+    // the antenna moves onto the sun;
+    void buildCapture(std::vector<qint64>& rTimes, std::vector<double>& rValues)
+    {
+        const int count = 3600 * 1000;
+        const qint64 start = Q_INT64_C(1466620800000000);
+
+        rTimes.resize(count);
+        rValues.resize(count);
+
+        quint32 seed = 12345;
+        for (int i = 0; i < count; i++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            const double noise = (static_cast<int>(seed >> 24) - 128) / 4.0;
+            const double level = (i < count / 2) ? 12000.0 : 20000.0;
+
+            rTimes[i] = start + Q_INT64_C(1000) * i;
+            rValues[i] = floor(level + noise) * 0.25;
+        }
+    }
+
+    // Builds repeatable measurements, in dB, around a level;
+    std::vector<double> buildMeasurements(const size_t& rCount
+                                          , const double& rLevel)
+    {
+        std::vector<double> measurements(rCount);
+        quint32 state = 2463534242u;
+        for (size_t i = 0; i < rCount; i++)
+        {
+            // xorshift32, scaled to +/- 0.5 dB;
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            measurements[i] = rLevel + (state / 4294967296.0 - 0.5);
+        }
+        return measurements;
+    }
+
+    // Builds a repeatable raster scan of the sun at 2.3 GHz, 4 degrees on a
+    // side, with a 1.3 by 1.1 degree beam slightly off the predicted sun
+    // and 0.05 dB of detector noise;
+    SunScanRaster buildSunScan(const int& rSize)
+    {
+        SunScanRaster raster;
+        raster.sunElevationDeg = 40.0;
+
+        const double cosElevation = cos(raster.sunElevationDeg * M_PI / 180);
+        for (int i = 0; i < rSize; i++)
+        {
+            const double offset = -2.0 + 4.0 * i / (rSize - 1);
+            raster.azimuthOffsetsDeg.push_back(offset / cosElevation);
+            raster.elevationOffsetsDeg.push_back(offset);
+        }
+
+        quint32 state = 2463534242u;
+        for (int row = 0; row < rSize; row++)
+        {
+            for (int column = 0; column < rSize; column++)
+            {
+                const double x = raster.azimuthOffsetsDeg[column]
+                        * cosElevation - 0.2;
+                const double y = raster.elevationOffsetsDeg[row] + 0.1;
+                const double power = 100.0 + 300.0 * exp(-4.0 * log(2.0)
+                        * (x * x / (1.3 * 1.3) + y * y / (1.1 * 1.1)));
+
+                // xorshift32, scaled to +/- 0.05 dB;
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                raster.powerDb.push_back(10.0 * log10(power)
+                                         + 0.1 * (state / 4294967296.0 - 0.5));
+            }
+        }
+
+        return raster;
+    }
+
+    // Sets up a GotCalc as the GUI would for a 2.3 GHz antenna;
+    void setUpGotCalc(GotCalc& rCalc)
+    {
+        rCalc.setOperatingFrequency(2300.0);
+        rCalc.setLowerFrequency(1415.0);
+        rCalc.setHigherFrequency(2695.0);
+        rCalc.setSolarFluxLow(60.0);
+        rCalc.setSolarFluxHigh(80.0);
+        rCalc.setBeamwidth(1.5);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runSolarCases
+
+Purpose      Times single solar positions, batch tables over a grid of sites
+             and times, and the ephemeris cache;
+
+Input        rBench             Harness which times and records each case;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void benchcases::runSolarCases(Benchmark &rBench)
+{
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    buildSiteGrid(latitudes, longitudes);
+
+    const QDate date(2016, 6, 29);
+    const std::vector<double> times = buildTimes(1440);
+
+    // One position through the QObject interface, as the GUI calculates it;
+    rBench.run("solar/calculate", [&](qint64 iterations)
+    {
+        SolarCalc calc;
+        calc.setDate(date);
+        calc.setDaylightSavings(false);
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            const int site = static_cast<int>(i % grid_sites);
+            const int minute = static_cast<int>(i % 1440);
+            calc.setLatitude(latitudes[site]);
+            calc.setLongitude(longitudes[site]);
+            calc.setTime(QTime(minute / 60, minute % 60));
+            calc.calculate();
+            double altitude = calc.getSolarAltitude();
+            doNotOptimize(altitude);
+        }
+    });
+
+    // The same, from a UTC instant rather than a QTime and QDate;
+    const double dayStart = solarmath::epochDay(2016, 6, 29)
+            * solarmath::seconds_per_day;
+    rBench.run("solar/calculate/utc", [&](qint64 iterations)
+    {
+        SolarCalc calc;
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            const int site = static_cast<int>(i % grid_sites);
+            calc.setLatitude(latitudes[site]);
+            calc.setLongitude(longitudes[site]);
+            calc.setUtc(dayStart + times[i % times.size()]);
+            calc.calculate();
+            double altitude = calc.getSolarAltitude();
+            doNotOptimize(altitude);
+        }
+    });
+
+    // One position through the stateless core;
+    rBench.run("solar/position", [&](qint64 iterations)
+    {
+        std::vector<SolarDayTerms> terms(grid_sites);
+        for (int site = 0; site < grid_sites; site++)
+        {
+            terms[site] = SolarCalc::calculateDayTerms(latitudes[site]
+                                                       , longitudes[site]
+                                                       , date.dayOfYear());
+        }
+
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            const SunPosition position = solarmath::position(
+                        terms[i % grid_sites], false, times[i % times.size()]);
+            doNotOptimize(position);
+        }
+    });
+
+    // Tables of one day for every site on the grid, at several resolutions;
+    const int table_sizes[] = {24, 1440, 86400};
+    for (size_t t = 0; t < sizeof(table_sizes) / sizeof(table_sizes[0]); t++)
+    {
+        const int count = table_sizes[t];
+        const std::vector<double> tableTimes = buildTimes(count);
+        std::vector<double> azimuth(count);
+        std::vector<double> altitude(count);
+        std::vector<double> zenith(count);
+        std::vector<double> hourAngle(count);
+
+        rBench.run(QString("solar/batch/%1").arg(count), [&](qint64 iterations)
+        {
+            for (qint64 i = 0; i < iterations; i++)
+            {
+                const int site = static_cast<int>(i % grid_sites);
+                SolarCalc::calculateBatch(latitudes[site], longitudes[site]
+                                          , date, false
+                                          , tableTimes.data(), count
+                                          , azimuth.data(), altitude.data()
+                                          , zenith.data(), hourAngle.data());
+                doNotOptimize(altitude[count - 1]);
+            }
+        }, count);
+    }
+
+    // A day's track in UTC, every minute from noon, so crossing midnight;
+    std::vector<double> utcTimes(times.size());
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        utcTimes[i] = dayStart + 43200.0 + times[i];
+    }
+    std::vector<double> utcAltitude(utcTimes.size());
+
+    rBench.run(QString("solar/batch-utc/%1").arg(utcTimes.size())
+               , [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            const int site = static_cast<int>(i % grid_sites);
+            SolarCalc::calculateBatchUtc(latitudes[site], longitudes[site]
+                                         , utcTimes.data(), utcTimes.size()
+                                         , 0, utcAltitude.data(), 0, 0);
+            doNotOptimize(utcAltitude[utcTimes.size() - 1]);
+        }
+    }, utcTimes.size());
+
+    // Local times of a year, every 6 hours, converted to UTC in bulk.  A
+    // fixed offset stands in if the zone is not known to this Qt;
+    TimeZoneTable zone;
+    if (!zone.load("America/Los_Angeles", 2016, 2016))
+    {
+        zone.setFixedOffset(-8 * 3600);
+    }
+    std::vector<double> localTimes;
+    for (int i = 0; i < 4 * 366; i++)
+    {
+        localTimes.push_back(TimeZoneTable::localSeconds(2016, 1, 1
+                                                         , i * 21600.0));
+    }
+    std::vector<double> zoneUtc(localTimes.size());
+
+    rBench.run(QString("solar/timezone/to-utc/%1").arg(localTimes.size())
+               , [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            zone.toUtc(localTimes.data(), zoneUtc.data(), localTimes.size());
+            doNotOptimize(zoneUtc[localTimes.size() - 1]);
+        }
+    }, localTimes.size());
+
+    // The cache, once every site is resident;
+    rBench.run("solar/cache/hit", [&](qint64 iterations)
+    {
+        SolarEphemerisCache cache(grid_sites);
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            const int site = static_cast<int>(i % grid_sites);
+            double azimuth;
+            double altitude;
+            cache.calculate(latitudes[site], longitudes[site], date
+                            , times[i % times.size()], false
+                            , azimuth, altitude);
+            doNotOptimize(altitude);
+        }
+    });
+
+    // The cache, when every lookup is for a new day and so misses;
+    rBench.run("solar/cache/miss", [&](qint64 iterations)
+    {
+        SolarEphemerisCache cache(64);
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            const int site = static_cast<int>(i % grid_sites);
+            double azimuth;
+            double altitude;
+            cache.calculate(latitudes[site], longitudes[site]
+                            , date.addDays(i / grid_sites)
+                            , times[i % times.size()], false
+                            , azimuth, altitude);
+            doNotOptimize(altitude);
+        }
+    });
+}
+
+/*----------------------------------------------------------------------------
+Name         runSolarTierCases
+
+Purpose      Times each precision tier of SunPositionEngine, and reports how
+             far each one is from its reference;
+
+Input        rBench             Harness which times and records each case;
+
+Notes        The precise tier is checked against the worked example of the
+             NREL SPA (Reda and Andreas, 2004), whose topocentric zenith and
+             azimuth are given to 1e-5 degree.  The fast tier is checked
+             against the precise tier over a year at the grid sites, while
+             the sun is more than 5 degrees up.  Azimuth errors are scaled by
+             the cosine of the altitude, giving the error on the sky;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void benchcases::runSolarTierCases(Benchmark &rBench)
+{
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    buildSiteGrid(latitudes, longitudes);
+
+    std::vector<SunSite> sites(grid_sites);
+    for (int site = 0; site < grid_sites; site++)
+    {
+        sites[site].latitudeDeg = latitudes[site];
+        sites[site].longitudeDeg = longitudes[site];
+    }
+
+    const std::vector<double> times = buildTimes(1440);
+
+    // One position, with the day terms of every site already worked out;
+    rBench.run("solar/tier/fast/position", [&](qint64 iterations)
+    {
+        std::vector<FastSunEngine> engines;
+        for (int site = 0; site < grid_sites; site++)
+        {
+            engines.push_back(FastSunEngine(sites[site], 2016, 6, 29));
+        }
+
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            const SunPosition position = engines[i % grid_sites].position(
+                        false, times[i % times.size()]);
+            doNotOptimize(position);
+        }
+    });
+
+    rBench.run("solar/tier/precise/position", [&](qint64 iterations)
+    {
+        std::vector<PreciseSunEngine> engines;
+        for (int site = 0; site < grid_sites; site++)
+        {
+            engines.push_back(PreciseSunEngine(sites[site], 2016, 6, 29));
+        }
+
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            const SunPosition position = engines[i % grid_sites].position(
+                        false, times[i % times.size()]);
+            doNotOptimize(position);
+        }
+    });
+
+    // A table of one day, a minute apart, including the day terms;
+    const int count = static_cast<int>(times.size());
+    std::vector<double> azimuth(count);
+    std::vector<double> altitude(count);
+
+    rBench.run(QString("solar/tier/fast/batch/%1").arg(count)
+               , [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            const FastSunEngine engine(sites[i % grid_sites], 2016, 6, 29);
+            engine.positions(false, times.data(), count
+                             , azimuth.data(), altitude.data(), 0, 0);
+            doNotOptimize(altitude[count - 1]);
+        }
+    }, count);
+
+    rBench.run(QString("solar/tier/precise/batch/%1").arg(count)
+               , [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            const PreciseSunEngine engine(sites[i % grid_sites], 2016, 6, 29);
+            engine.positions(false, times.data(), count
+                             , azimuth.data(), altitude.data(), 0, 0);
+            doNotOptimize(altitude[count - 1]);
+        }
+    }, count);
+
+    // The SPA example: 17 Oct 2003 12:30:30 at UTC-7, which is converted to
+    // the local time of the longitude convention used by the engine;
+    SunSite golden;
+    golden.latitudeDeg = 39.742476;
+    golden.longitudeDeg = -105.1786;
+    golden.pressureMbar = 820.0;
+    golden.temperatureC = 11.0;
+
+    const double utSeconds = 19.0 * 3600.0 + 30.0 * 60.0 + 30.0;
+    const SunPosition spa = PreciseSunEngine(golden, 2003, 10, 17).position(
+                false, utSeconds + 240.0 * golden.longitudeDeg);
+
+    rBench.report("solar/tier/precise/spa-zenith-error"
+                  , 3600.0 * fabs(spa.zenithDeg - 50.11162), "arcsec");
+    rBench.report("solar/tier/precise/spa-azimuth-error"
+                  , 3600.0 * fabs(spa.azimuthDeg - 194.34024)
+                  * sin(spa.zenithDeg * M_PI / 180.0), "arcsec");
+
+    // The fast tier against the precise tier;
+    double maxAltitudeError = 0;
+    double maxAzimuthError = 0;
+    double sumSquares = 0;
+    int samples = 0;
+
+    for (int site = 0; site < grid_sites; site += 7)
+    {
+        for (int day = 0; day < 365; day += 5)
+        {
+            const QDate date = QDate(2026, 1, 1).addDays(day);
+            const FastSunEngine fast(sites[site], date.year()
+                                     , date.month(), date.day());
+            const PreciseSunEngine precise(sites[site], date.year()
+                                           , date.month(), date.day());
+
+            for (size_t t = 0; t < times.size(); t += 10)
+            {
+                const SunPosition fastSun = fast.position(false, times[t]);
+                const SunPosition preciseSun = precise.position(false, times[t]);
+                if (preciseSun.altitudeDeg < 5.0)
+                {
+                    continue;
+                }
+
+                const double altitudeError = fabs(fastSun.altitudeDeg
+                                                  - preciseSun.altitudeDeg);
+                const double azimuthError = fabs(sunposition::wrap360(
+                            fastSun.azimuthDeg - preciseSun.azimuthDeg + 180.0)
+                            - 180.0) * cos(preciseSun.altitudeDeg * M_PI / 180.0);
+
+                maxAltitudeError = qMax(maxAltitudeError, altitudeError);
+                maxAzimuthError = qMax(maxAzimuthError, azimuthError);
+                sumSquares += altitudeError * altitudeError;
+                samples++;
+            }
+        }
+    }
+
+    rBench.report("solar/tier/fast/max-altitude-error"
+                  , maxAltitudeError, "deg");
+    rBench.report("solar/tier/fast/rms-altitude-error"
+                  , sqrt(sumSquares / qMax(1, samples)), "deg");
+    rBench.report("solar/tier/fast/max-azimuth-error"
+                  , maxAzimuthError, "deg");
+}
+
+/*----------------------------------------------------------------------------
+Name         runMathCases
+
+Purpose      Times the fastmath kernels against libm over arrays of inputs, and
+             reports the largest error of each kernel over its whole domain;
+
+Input        rBench             Harness which times and records each case;
+
+Notes        The errors are against the long double functions of libm.  Each
+             domain is swept at over a million evenly spaced points, plus its
+             end points: sin and cos over +-sin_cos_max_argument, the degree
+             forms over +-720 degrees, acos over [-1, 1], atan2 over a grid
+             of (x, y) about the origin, and dbToPower, whose error is
+             relative, over +-db_to_power_max_argument.  Every error must
+             stay below the bound stated in fastmath.h, and a failure is
+             reported in the name of the measurement;
+
+             The solar/batch/1440 cases are repeated with each backend, and
+             the largest difference between their tables is reported;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Added dbToPower;
+----------------------------------------------------------------------------*/
+void benchcases::runMathCases(Benchmark &rBench)
+{
+    const int count = 4096;
+    std::vector<double> angles(count);
+    std::vector<double> cosines(count);
+    std::vector<double> results(count);
+    for (int i = 0; i < count; i++)
+    {
+        angles[i] = -M_PI + (2.0 * M_PI * i) / count;
+        cosines[i] = -1.0 + (2.0 * i) / (count - 1);
+    }
+
+    rBench.run(QString("math/libm/cos/%1").arg(count), [&](qint64 iterations)
+    {
+        for (qint64 n = 0; n < iterations; n++)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                results[i] = cos(angles[i]);
+            }
+            doNotOptimize(results[n % count]);
+        }
+    }, count);
+
+    rBench.run(QString("math/poly/cos/%1").arg(count), [&](qint64 iterations)
+    {
+        for (qint64 n = 0; n < iterations; n++)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                results[i] = fastmath::cos(angles[i]);
+            }
+            doNotOptimize(results[n % count]);
+        }
+    }, count);
+
+    rBench.run(QString("math/libm/acos/%1").arg(count), [&](qint64 iterations)
+    {
+        for (qint64 n = 0; n < iterations; n++)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                results[i] = acos(cosines[i]);
+            }
+            doNotOptimize(results[n % count]);
+        }
+    }, count);
+
+    rBench.run(QString("math/poly/acos/%1").arg(count), [&](qint64 iterations)
+    {
+        for (qint64 n = 0; n < iterations; n++)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                results[i] = fastmath::acos(cosines[i]);
+            }
+            doNotOptimize(results[n % count]);
+        }
+    }, count);
+
+    rBench.run(QString("math/libm/atan2/%1").arg(count)
+               , [&](qint64 iterations)
+    {
+        for (qint64 n = 0; n < iterations; n++)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                results[i] = atan2(cosines[i], angles[i]);
+            }
+            doNotOptimize(results[n % count]);
+        }
+    }, count);
+
+    rBench.run(QString("math/poly/atan2/%1").arg(count)
+               , [&](qint64 iterations)
+    {
+        for (qint64 n = 0; n < iterations; n++)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                results[i] = fastmath::atan2(cosines[i], angles[i]);
+            }
+            doNotOptimize(results[n % count]);
+        }
+    }, count);
+
+    // Radiometer levels, in dB;
+    std::vector<double> levels(count);
+    for (int i = 0; i < count; i++)
+    {
+        levels[i] = -60.0 + (40.0 * i) / count;
+    }
+
+    rBench.run(QString("math/libm/db-to-power/%1").arg(count)
+               , [&](qint64 iterations)
+    {
+        for (qint64 n = 0; n < iterations; n++)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                results[i] = pow(10.0, levels[i] / 10.0);
+            }
+            doNotOptimize(results[n % count]);
+        }
+    }, count);
+
+    rBench.run(QString("math/poly/db-to-power/%1").arg(count)
+               , [&](qint64 iterations)
+    {
+        for (qint64 n = 0; n < iterations; n++)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                results[i] = fastmath::dbToPower(levels[i]);
+            }
+            doNotOptimize(results[n % count]);
+        }
+    }, count);
+
+    // Errors over the whole domain of each kernel;
+    const int sweep = 1 << 21;
+    double sinCosError = 0;
+    double degreeError = 0;
+    double acosError = 0;
+    double atan2Error = 0;
+    double dbToPowerError = 0;
+
+    for (int i = 0; i <= sweep; i++)
+    {
+        const double x = fastmath::sin_cos_max_argument
+                * (2.0 * i / sweep - 1.0);
+        double s;
+        double c;
+        fastmath::sinCos(x, s, c);
+        sinCosError = std::max(sinCosError
+                               , static_cast<double>(fabsl(s - sinl(x))));
+        sinCosError = std::max(sinCosError
+                               , static_cast<double>(fabsl(c - cosl(x))));
+
+        const double degrees = 720.0 * (2.0 * i / sweep - 1.0);
+        const long double radians = degrees
+                * (3.14159265358979323846264338L / 180.0L);
+        fastmath::sinCosDeg(degrees, s, c);
+        degreeError = std::max(degreeError
+                               , static_cast<double>(fabsl(s - sinl(radians))));
+        degreeError = std::max(degreeError
+                               , static_cast<double>(fabsl(c - cosl(radians))));
+
+        const double a = 2.0 * i / sweep - 1.0;
+        acosError = std::max(acosError, static_cast<double>(
+                                 fabsl(fastmath::acos(a) - acosl(a))));
+
+        const double db = fastmath::db_to_power_max_argument * a;
+        const long double power = powl(10.0L, db / 10.0L);
+        dbToPowerError = std::max(dbToPowerError, static_cast<double>(
+                                      fabsl(fastmath::dbToPower(db) - power)
+                                      / power));
+    }
+
+    const int side = 1 << 10;
+    for (int i = 0; i <= side; i++)
+    {
+        for (int j = 0; j <= side; j++)
+        {
+            const double x = 2.0 * i / side - 1.0;
+            const double y = 2.0 * j / side - 1.0;
+            atan2Error = std::max(atan2Error, static_cast<double>(
+                                      fabsl(fastmath::atan2(y, x)
+                                            - atan2l(y, x))));
+        }
+    }
+
+    const struct
+    {
+        const char* name;
+        double error;
+        double bound;
+        const char* unit;
+    } errors[] = {
+        { "math/error/sin-cos", sinCosError, fastmath::sin_cos_max_error
+          , "rad" },
+        { "math/error/sin-cos-deg", degreeError, fastmath::sin_cos_max_error
+          , "rad" },
+        { "math/error/acos", acosError, fastmath::acos_max_error, "rad" },
+        { "math/error/atan2", atan2Error, fastmath::atan2_max_error, "rad" },
+        { "math/error/db-to-power", dbToPowerError
+          , fastmath::db_to_power_max_error, "relative" }
+    };
+
+    for (size_t i = 0; i < sizeof(errors) / sizeof(errors[0]); i++)
+    {
+        const QString name = QString(errors[i].name)
+                + (errors[i].error < errors[i].bound ? "" : "/OVER-BOUND");
+        rBench.report(name, errors[i].error, errors[i].unit);
+    }
+
+    // Tracking tables with each backend;
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    buildSiteGrid(latitudes, longitudes);
+
+    const QDate date(2016, 6, 29);
+    const int tableSize = 1440;
+    const std::vector<double> times = buildTimes(tableSize);
+    std::vector<double> azimuth(tableSize);
+    std::vector<double> altitude(tableSize);
+
+    rBench.run(QString("solar/batch/%1/poly").arg(tableSize)
+               , [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            const int site = static_cast<int>(i % grid_sites);
+            SolarCalc::calculateBatch(latitudes[site], longitudes[site]
+                                      , date, false
+                                      , times.data(), tableSize
+                                      , azimuth.data(), altitude.data()
+                                      , 0, 0, PolynomialMath);
+            doNotOptimize(altitude[tableSize - 1]);
+        }
+    }, tableSize);
+
+    std::vector<double> libmAzimuth(tableSize);
+    std::vector<double> libmAltitude(tableSize);
+    double tableError = 0;
+
+    for (int site = 0; site < grid_sites; site++)
+    {
+        SolarCalc::calculateBatch(latitudes[site], longitudes[site]
+                                  , date, false, times.data(), tableSize
+                                  , libmAzimuth.data(), libmAltitude.data()
+                                  , 0, 0, LibmMath);
+        SolarCalc::calculateBatch(latitudes[site], longitudes[site]
+                                  , date, false, times.data(), tableSize
+                                  , azimuth.data(), altitude.data()
+                                  , 0, 0, PolynomialMath);
+
+        for (int i = 0; i < tableSize; i++)
+        {
+            tableError = std::max(tableError
+                                  , fabs(altitude[i] - libmAltitude[i]));
+
+            // The azimuth is ill-conditioned within a hair of the zenith;
+            if (libmAltitude[i] < 89.9)
+            {
+                tableError = std::max(tableError
+                                      , fabs(azimuth[i] - libmAzimuth[i]));
+            }
+        }
+    }
+
+    rBench.report(QString("solar/batch/%1/poly-difference").arg(tableSize)
+                  , 3600.0 * tableError, "arcsec");
+}
+
+/*----------------------------------------------------------------------------
+Name         runGotCases
+
+Purpose      Times the G/T calculation as the number of measurements grows,
+             both from measurement vectors and from streamed samples, and the
+             reduction of large blocks of samples;
+
+Input        rBench             Harness which times and records each case;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Added the got/reduce cases;
+             17 Oct 26  AFB Added the got/uncertainty cases;
+----------------------------------------------------------------------------*/
+void benchcases::runGotCases(Benchmark &rBench)
+{
+    const size_t counts[] = {3, 100, 10000, 1000000};
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        const size_t count = counts[c];
+        const std::vector<double> hot = buildMeasurements(count, 12.0);
+        const std::vector<double> cold = buildMeasurements(count, 2.0);
+
+        // Measurements entered one at a time, then calculated, as the GUI
+        // does when it saves a session;
+        rBench.run(QString("got/measurements/%1").arg(count)
+                   , [&](qint64 iterations)
+        {
+            GotCalc calc(0);
+            setUpGotCalc(calc);
+            for (qint64 i = 0; i < iterations; i++)
+            {
+                calc.clearHotMeasurments();
+                calc.clearColdMeasurments();
+                for (size_t j = 0; j < count; j++)
+                {
+                    calc.addHotMeasurement(hot[j]);
+                    calc.addColdMeasurement(cold[j]);
+                }
+                calc.calculate();
+                double got = calc.getGotRatiodB();
+                doNotOptimize(got);
+            }
+        }, count);
+
+        // The same measurements streamed in blocks;
+        rBench.run(QString("got/samples/%1").arg(count)
+                   , [&](qint64 iterations)
+        {
+            GotCalc calc(0);
+            setUpGotCalc(calc);
+            for (qint64 i = 0; i < iterations; i++)
+            {
+                calc.clearSamples();
+                calc.addHotSamples(hot.data(), count);
+                calc.addColdSamples(cold.data(), count);
+                calc.calculateFromSamples();
+                double got = calc.getGotRatiodB();
+                doNotOptimize(got);
+            }
+        }, count);
+    }
+
+    // Reduction of a large block of radiometer samples: the mean of the dB
+    // values, which calculate() used to take, against the mean power of dB
+    // samples and of samples which are already power ratios;
+    const size_t sampleCount = 1 << 22;
+    const std::vector<double> levels = buildMeasurements(sampleCount, 12.0);
+    std::vector<double> powers(sampleCount);
+    PowerStats::dbToPower(levels.data(), sampleCount, powers.data());
+
+    rBench.run(QString("got/reduce/db-mean/%1").arg(sampleCount)
+               , [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            RunningStats stats;
+            stats.addSamples(levels.data(), sampleCount);
+            doNotOptimize(stats.getMean());
+        }
+    }, sampleCount);
+
+    rBench.run(QString("got/reduce/power-from-db/%1").arg(sampleCount)
+               , [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            PowerStats stats;
+            stats.addDb(levels.data(), sampleCount);
+            doNotOptimize(stats.getMean());
+        }
+    }, sampleCount);
+
+    rBench.run(QString("got/reduce/power-linear/%1").arg(sampleCount)
+               , [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            PowerStats stats;
+            stats.addLinear(powers.data(), sampleCount);
+            doNotOptimize(stats.getMean());
+        }
+    }, sampleCount);
+
+    // Flux at every channel of a wideband feed, from a fitted spectrum;
+    const double fluxes[constants::number_of_available_frequencies]
+            = {12, 30, 50, 63, 82, 85, 120, 227, 530};
+    const int channels = 4096;
+    std::vector<double> channelFreqs(channels);
+    std::vector<double> channelFlux(channels);
+    for (int i = 0; i < channels; i++)
+    {
+        channelFreqs[i] = 1000.0 + i * 0.5;
+    }
+
+    rBench.run("got/flux-spectrum/fit", [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            FluxSpectrum spectrum;
+            spectrum.setFluxes(fluxes);
+            doNotOptimize(spectrum);
+        }
+    });
+
+    rBench.run(QString("got/flux-spectrum/%1").arg(channels)
+               , [&](qint64 iterations)
+    {
+        FluxSpectrum spectrum;
+        spectrum.setFluxes(fluxes);
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            spectrum.evaluate(channelFreqs.data(), channelFlux.data()
+                              , channels);
+            doNotOptimize(channelFlux[channels - 1]);
+        }
+    }, channels);
+
+    // Looking up the flux frequencies either side of an operating frequency;
+    rBench.run("got/bracketing-frequencies", [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            double lower;
+            double higher;
+            GotCalc::findBracketingFrequencies(100.0 + (i % 16000)
+                                               , lower, higher);
+            doNotOptimize(higher);
+        }
+    });
+
+    // The G/T of a whole array of sessions with the Qt-free core, against
+    // one GotCalc set up for each session in turn;
+    const size_t sessions = 10000;
+    std::vector<gotcore::GotInputs> inputs(sessions);
+    std::vector<gotcore::GotResult> results(sessions);
+    for (size_t i = 0; i < sessions; i++)
+    {
+        gotcore::GotInputs& rInputs = inputs[i];
+        rInputs.operatingFrequencyMHz = 2300.0;
+        rInputs.lowerFrequencyMHz = 1415.0;
+        rInputs.higherFrequencyMHz = 2695.0;
+        rInputs.solarFluxLowSfu = 60.0;
+        rInputs.solarFluxHighSfu = 80.0;
+        rInputs.beamwidthDeg = 1.0 + (i % 40) * 0.1;
+        rInputs.hotDb = 12.0 + (i % 7) * 0.1;
+        rInputs.coldDb = 2.0;
+    }
+
+    rBench.run(QString("got/core/%1").arg(sessions), [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            gotcore::computeGot(inputs.data(), sessions, results.data());
+            doNotOptimize(results[sessions - 1].gotDb);
+        }
+    }, sessions);
+
+    rBench.run(QString("got/gotcalc/%1").arg(sessions)
+               , [&](qint64 iterations)
+    {
+        GotCalc calc(0);
+        setUpGotCalc(calc);
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            for (size_t j = 0; j < sessions; j++)
+            {
+                calc.setBeamwidth(inputs[j].beamwidthDeg);
+                calc.clearHotMeasurments();
+                calc.clearColdMeasurments();
+                calc.addHotMeasurement(inputs[j].hotDb);
+                calc.addColdMeasurement(inputs[j].coldDb);
+                calc.calculate();
+                results[j].gotDb = calc.getGotRatiodB();
+            }
+            doNotOptimize(results[sessions - 1].gotDb);
+        }
+    }, sessions);
+
+    // Monte Carlo estimate of the uncertainty of one G/T, on the calling
+    // thread and on a pool, and the spread it finds;
+    GotUncertaintyInputs uncertaintyInputs;
+    uncertaintyInputs.operatingFrequencyMHz = 2300.0;
+    uncertaintyInputs.solarFluxSfu = 70.0;
+    uncertaintyInputs.solarFluxUncertainty = 0.1;
+    uncertaintyInputs.beamwidthDeg = 1.5;
+    uncertaintyInputs.beamwidthUncertaintyDeg = 0.05;
+    uncertaintyInputs.hotMeanDb = 12.0;
+    uncertaintyInputs.hotStandardErrorDb = 0.05;
+    uncertaintyInputs.coldMeanDb = 2.0;
+    uncertaintyInputs.coldStandardErrorDb = 0.05;
+
+    const unsigned long long draws = 100000;
+    WorkStealingPool pool;
+    GotUncertaintyResult uncertainty;
+
+    rBench.run(QString("got/uncertainty/%1").arg(draws)
+               , [&](qint64 iterations)
+    {
+        GotUncertainty engine(0);
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            uncertainty = engine.estimate(uncertaintyInputs, draws);
+            doNotOptimize(uncertainty.meanDb);
+        }
+    }, draws);
+
+    rBench.run(QString("got/uncertainty/%1/pool").arg(draws)
+               , [&](qint64 iterations)
+    {
+        GotUncertainty engine(&pool);
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            uncertainty = engine.estimate(uncertaintyInputs, draws);
+            doNotOptimize(uncertainty.meanDb);
+        }
+    }, draws);
+
+    uncertainty = GotUncertainty(&pool).estimate(uncertaintyInputs, draws);
+    rBench.report("got/uncertainty/standard-deviation"
+                  , uncertainty.standardDeviationDb, "dB");
+}
+
+/*----------------------------------------------------------------------------
+Name         runSunScanCases
+
+Purpose      Times the beam fit to a 100 by 100 raster scan of the sun, on the
+             calling thread and on a pool, and reports the fitted beamwidth;
+
+Input        rBench             Harness which times and records each case;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void benchcases::runSunScanCases(Benchmark &rBench)
+{
+    const SunScanRaster raster = buildSunScan(100);
+    const int cells = static_cast<int>(raster.powerDb.size());
+    WorkStealingPool pool;
+    SunScanFit fit;
+
+    rBench.run("sunscan/fit/100x100", [&](qint64 iterations)
+    {
+        SunScan scan;
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            scan.fit(raster, 2300.0, fit);
+            doNotOptimize(fit);
+        }
+    }, cells);
+
+    rBench.run("sunscan/fit/100x100/pool", [&](qint64 iterations)
+    {
+        SunScan scan(&pool);
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            scan.fit(raster, 2300.0, fit);
+            doNotOptimize(fit);
+        }
+    }, cells);
+
+    // The map widths the scan was built with, 1.3 and 1.1 degrees;
+    SunScan scan;
+    if (scan.fit(raster, 2300.0, fit))
+    {
+        rBench.report("sunscan/map-width/azimuth", fit.mapAzimuthWidthDeg
+                      , "deg");
+        rBench.report("sunscan/map-width/elevation"
+                      , fit.mapElevationWidthDeg, "deg");
+        rBench.report("sunscan/beamwidth", fit.beamwidthDeg, "deg");
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runTrackerCases
+
+Purpose      Times a tracking setpoint and a read of the latest one, then runs
+             the tracker at 100 Hz for two seconds against two simulated
+             antennas, one of which stalls for longer than a period on every
+             read, and reports the jitter, misses, and pointing errors;
+
+Input        rBench             Harness which times and records each case;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void benchcases::runTrackerCases(Benchmark &rBench)
+{
+    // Local noon at midsummer in Los Angeles;
+    const double noon = solarmath::epochDay(2026, 6, 21)
+            * solarmath::seconds_per_day + 20.0 * 3600.0;
+
+    SunTracker tracker;
+    tracker.setSite(34.05, -118.25);
+    TrackingSetpoint setpoint;
+
+    rBench.run("tracker/setpoint", [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            tracker.setpointAt(noon + i * 0.01, setpoint);
+            doNotOptimize(setpoint);
+        }
+    });
+
+    rBench.run("tracker/latest", [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            doNotOptimize(tracker.latest(setpoint));
+        }
+    });
+
+    if (!rBench.isSelected("tracker/simulated"))
+    {
+        return;
+    }
+
+    tracker.setRateHz(100.0);
+    tracker.setSimulatedTime(noon);
+
+    SimulatedController controller(&tracker);
+    SimulatedController stalled(&tracker);
+    stalled.setStallSeconds(0.05);
+
+    tracker.start(QThread::TimeCriticalPriority);
+    controller.start();
+    stalled.start();
+    QThread::msleep(2000);
+    stalled.stop();
+    controller.stop();
+    tracker.stop();
+
+    const TrackingStatistics stats = tracker.statistics();
+    const ControllerStatistics followed = controller.statistics();
+    const ControllerStatistics lagged = stalled.statistics();
+
+    rBench.report("tracker/simulated/periods", stats.periods, "periods");
+    rBench.report("tracker/simulated/deadline-misses", stats.deadlineMisses
+                  , "periods");
+    rBench.report("tracker/simulated/jitter-mean"
+                  , stats.jitterMeanSeconds * 1e6, "us");
+    rBench.report("tracker/simulated/jitter-max"
+                  , stats.jitterMaxSeconds * 1e6, "us");
+    rBench.report("tracker/simulated/compute-max"
+                  , stats.computeMaxSeconds * 1e6, "us");
+    rBench.report("tracker/simulated/rms-error", followed.rmsErrorDeg, "deg");
+    rBench.report("tracker/simulated/max-error", followed.maxErrorDeg, "deg");
+    rBench.report("tracker/simulated/stalled/rms-error", lagged.rmsErrorDeg
+                  , "deg");
+    rBench.report("tracker/simulated/stalled/setpoint-age-max"
+                  , lagged.maxSetpointAgeSeconds * 1e3, "ms");
+}
+
+/*----------------------------------------------------------------------------
+Name         runSunShareCases
+
+Purpose      Times working out a shared memory snapshot, and reading the
+             latest one while the publisher updates it 100 times a second;
+
+Input        rBench             Harness which times and records each case;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void benchcases::runSunShareCases(Benchmark &rBench)
+{
+    const double noon = solarmath::epochDay(2026, 6, 21)
+            * solarmath::seconds_per_day + 20.0 * 3600.0;
+
+    SunSharePublisher publisher("got-bench-sun-position");
+    publisher.setSite(34.05, -118.25);
+    publisher.setRateHz(100.0);
+    SunShareSnapshot snapshot;
+
+    rBench.run("sunshare/snapshot", [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            publisher.snapshotAt(noon + i, snapshot);
+            doNotOptimize(snapshot);
+        }
+    }, sun_share_lookahead + 1);
+
+    if (!rBench.isSelected("sunshare/read") || !publisher.open())
+    {
+        return;
+    }
+
+    publisher.start();
+    SunShareReader reader("got-bench-sun-position");
+    if (!reader.attach())
+    {
+        publisher.stop();
+        return;
+    }
+
+    // Wait for the first snapshot;
+    while (!reader.read(snapshot))
+    {
+        QThread::msleep(1);
+    }
+
+    rBench.run("sunshare/read", [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            doNotOptimize(reader.read(snapshot));
+        }
+    });
+
+    publisher.stop();
+}
+
+/*----------------------------------------------------------------------------
+Name         runLogCases
+
+Purpose      Times LogFile appends, both written by the calling thread and
+             handed to the writer thread;
+
+Input        rBench             Harness which times and records each case;
+             rDirectory         Directory in which to create the log files;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void benchcases::runLogCases(Benchmark &rBench, const QString &rDirectory)
+{
+    const QString record = "2016-06-29 18:40:16, 2300 MHz, G/T 12.34 dB";
+    const QString path = QDir(rDirectory).filePath("got-bench.log");
+
+    const bool modes[] = {false, true};
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+        const bool async = modes[m];
+
+        // The flush is included, so that asynchronous appends are only
+        // counted once they have reached the file;
+        rBench.run(async ? "log/append/async" : "log/append/sync"
+                   , [&](qint64 iterations)
+        {
+            LogFile log;
+            log.setAsynchronous(async);
+            log.setNameAndOpen(path);
+            for (qint64 i = 0; i < iterations; i++)
+            {
+                log.append(record);
+            }
+            log.flush();
+        });
+    }
+
+    QFile::remove(path);
+}
+
+/*----------------------------------------------------------------------------
+Name         runCaptureCases
+
+Purpose      Times appending to a radiometer capture file and reading time
+             ranges back from it, and reports how well it compresses;
+
+Input        rBench             Harness which times and records each case;
+             rDirectory         Directory in which to create the capture files;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void benchcases::runCaptureCases(Benchmark &rBench, const QString &rDirectory)
+{
+    const QString path = QDir(rDirectory).filePath("got-bench.gcap");
+
+    std::vector<qint64> times;
+    std::vector<double> values;
+    buildCapture(times, values);
+    const qint64 count = static_cast<qint64>(times.size());
+
+    // Appends, including compressing and writing the chunks;
+    rBench.run("capture/append", [&](qint64 iterations)
+    {
+        RadiometerCaptureWriter writer;
+        writer.open(path);
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            writer.append(times[0] + Q_INT64_C(1000) * i, values[i % count]);
+        }
+        writer.close();
+    });
+
+    // The hour, written once, to read back from;
+    RadiometerCaptureWriter writer;
+    writer.open(path);
+    writer.append(times.data(), values.data(), times.size());
+    writer.close();
+
+    RadiometerCaptureReader reader;
+    if (!reader.open(path))
+    {
+        return;
+    }
+
+    QFile file(path);
+    const double bytesPerSample = static_cast<double>(file.size()) / count;
+    rBench.report("capture/bytes-per-sample", bytesPerSample, "bytes");
+    rBench.report("capture/compression-ratio"
+                  , (sizeof(qint64) + sizeof(double)) / bytesPerSample, "x");
+
+    // One second ranges from across the hour;
+    rBench.run("capture/read/1s", [&](qint64 iterations)
+    {
+        QVector<qint64> rangeTimes;
+        QVector<double> rangeValues;
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            const qint64 from = times[(i * 7919) % (count - 1000)];
+            rangeTimes.clear();
+            rangeValues.clear();
+            reader.read(from, from + 1000000, rangeTimes, rangeValues);
+            doNotOptimize(rangeValues);
+        }
+    }, 1000);
+
+    // The whole hour into running statistics;
+    rBench.run("capture/read/all", [&](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; i++)
+        {
+            RunningStats statistics;
+            reader.read(times.front(), times.back() + 1, statistics);
+            doNotOptimize(statistics);
+        }
+    }, count);
+
+    reader.close();
+    QFile::remove(path);
+}
@@ -0,0 +1,36 @@
+/*----------------------------------------------------------------------------
+Name         benchcases.h
+
+Purpose      Benchmark cases for the calculation and logging hot paths;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef BENCHCASES_H
+#define BENCHCASES_H
+
+#include "benchmark.h" // USES Benchmark to time each case;
+
+namespace benchcases
+{
+    // Single position latency, batch tables, and the ephemeris cache;
+    void runSolarCases(Benchmark& rBench);
+    // Throughput and accuracy of each SunPositionEngine precision tier;
+    void runSolarTierCases(Benchmark& rBench);
+    // Throughput and error of the fastmath kernels against libm;
+    void runMathCases(Benchmark& rBench);
+    // G/T calculation with growing measurement vectors and sample streams,
+    // and its Monte Carlo uncertainty;
+    void runGotCases(Benchmark& rBench);
+    // Beam fits to a simulated raster scan of the sun;
+    void runSunScanCases(Benchmark& rBench);
+    // Tracking setpoints, and the tracker run against a simulated antenna;
+    void runTrackerCases(Benchmark& rBench);
+    // Shared memory snapshots of the sun's position, written and read;
+    void runSunShareCases(Benchmark& rBench);
+    // LogFile appends, writing synchronously and through the writer thread;
+    void runLogCases(Benchmark& rBench, const QString& rDirectory);
+    // Radiometer capture appends, range reads, and compression;
+    void runCaptureCases(Benchmark& rBench, const QString& rDirectory);
+}
+
+#endif // BENCHCASES_H
@@ -0,0 +1,354 @@
+/*----------------------------------------------------------------------------
+Name         benchmark.cpp
+
+Purpose      Minimal timing harness for the benchmark executable.  Runs each
+             case for long enough to time it reliably and records ns/op and
+             allocations/op;
+
+Notes        Each case is first run with a growing number of iterations until
+             one run lasts the minimum time, then timed for several
+             repetitions at that count.  The best and median repetitions are
+             both reported, the best being the least disturbed by the rest of
+             the system;
+
+             Allocations are counted by replacing the global operator new, so
+             they cover everything allocated with new, including by the
+             standard containers.  Qt containers allocate with malloc and are
+             not counted;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "benchmark.h"
+
+#include <QElapsedTimer> // USES QElapsedTimer to time each repetition;
+#include <QJsonArray>
+#include <QSysInfo>
+#include <QDateTime>
+#include <QThread>
+#include <QTextStream>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<quint64> gAllocationCount(0);
+    std::atomic<quint64> gAllocationBytes(0);
+}
+
+// Counting replacements of the global allocation functions;
+void* operator new(std::size_t size)
+{
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    gAllocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/*----------------------------------------------------------------------------
+Name         Benchmark
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+Benchmark::Benchmark()
+    : mFilter(".*")
+    , mMinTime(0.2)
+    , mRepetitions(5)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         setFilter
+
+Purpose      Sets the regular expression selecting which cases are run;
+
+Input        rPattern           Pattern matched anywhere within a case name;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void Benchmark::setFilter(const QString &rPattern)
+{
+    mFilter = QRegExp(rPattern);
+}
+
+/*----------------------------------------------------------------------------
+Name         setMinTime
+
+Purpose      Sets how long each timed repetition should last;
+
+Input        rSeconds           Length of a repetition, in seconds;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void Benchmark::setMinTime(const double &rSeconds)
+{
+    mMinTime = qMax(0.001, rSeconds);
+}
+
+/*----------------------------------------------------------------------------
+Name         setRepetitions
+
+Purpose      Sets the number of timed repetitions of each case;
+
+Input        rRepetitions       Number of repetitions;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void Benchmark::setRepetitions(const int &rRepetitions)
+{
+    mRepetitions = qMax(1, rRepetitions);
+}
+
+/*----------------------------------------------------------------------------
+Name         isSelected
+
+Purpose      Returns whether or not the filter selects a name, so that a case
+             which takes a fixed time to set up can be skipped altogether;
+
+Input        rName              Name of the case or measurement;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool Benchmark::isSelected(const QString &rName) const
+{
+    return mFilter.indexIn(rName) >= 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         run
+
+Purpose      Times a case, if it is selected by the filter, and records the
+             result;
+
+Input        rName              Name of the case;
+             rBody              Runs the operation the number of times given;
+             rItemsPerOp        Items each operation processes, so that
+                                throughput may be worked out from ns/op;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void Benchmark::run(const QString &rName, const Body &rBody
+                    , const double &rItemsPerOp)
+{
+    if (mFilter.indexIn(rName) < 0)
+    {
+        return;
+    }
+
+    QElapsedTimer timer;
+    const qint64 minNs = static_cast<qint64>(mMinTime * 1e9);
+
+    // Find an iteration count which takes at least the minimum time;
+    qint64 iterations = 1;
+    while (true)
+    {
+        timer.start();
+        rBody(iterations);
+        const qint64 elapsed = timer.nsecsElapsed();
+
+        if (elapsed >= minNs || iterations >= (Q_INT64_C(1) << 40))
+        {
+            break;
+        }
+
+        // Aim a little beyond the minimum, growing at most tenfold a step;
+        const double scale = (elapsed > 0)
+                ? qMin(10.0, 1.2 * minNs / elapsed) : 10.0;
+        iterations = qMax(iterations + 1
+                          , static_cast<qint64>(iterations * scale));
+    }
+
+    // Time the repetitions;
+    QVector<double> nsPerOp;
+    quint64 allocations = 0;
+    quint64 bytes = 0;
+
+    for (int i = 0; i < mRepetitions; i++)
+    {
+        const quint64 allocationsBefore = allocationCount();
+        const quint64 bytesBefore = allocationBytes();
+
+        timer.start();
+        rBody(iterations);
+        const qint64 elapsed = timer.nsecsElapsed();
+
+        allocations += allocationCount() - allocationsBefore;
+        bytes += allocationBytes() - bytesBefore;
+        nsPerOp.append(static_cast<double>(elapsed) / iterations);
+    }
+
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+
+    const double operations = static_cast<double>(iterations) * mRepetitions;
+
+    BenchmarkResult result;
+    result.name = rName;
+    result.iterations = iterations;
+    result.nsPerOp = nsPerOp.first();
+    result.nsPerOpMedian = nsPerOp.at(nsPerOp.size() / 2);
+    result.allocsPerOp = allocations / operations;
+    result.bytesPerOp = bytes / operations;
+    result.itemsPerOp = rItemsPerOp;
+    mResults.append(result);
+
+    QTextStream(stderr) << QString("%1 %2 ns/op %3 allocs/op\n")
+                           .arg(rName, -48)
+                           .arg(result.nsPerOp, 12, 'f', 1)
+                           .arg(result.allocsPerOp, 10, 'f', 2);
+}
+
+/*----------------------------------------------------------------------------
+Name         report
+
+Purpose      Records a measurement which is not a time, such as the error of
+             an approximation, so that it is kept alongside the timings;
+
+Input        rName              Name of the measurement;
+             rValue             The value;
+             rUnit              Unit of the value;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void Benchmark::report(const QString &rName, const double &rValue
+                       , const QString &rUnit)
+{
+    if (mFilter.indexIn(rName) < 0)
+    {
+        return;
+    }
+
+    BenchmarkMeasurement measurement;
+    measurement.name = rName;
+    measurement.value = rValue;
+    measurement.unit = rUnit;
+    mMeasurements.append(measurement);
+
+    QTextStream(stderr) << QString("%1 %2 %3\n")
+                           .arg(rName, -48)
+                           .arg(rValue, 12, 'g', 4)
+                           .arg(rUnit);
+}
+
+/*----------------------------------------------------------------------------
+Name         getResults
+
+Purpose      Returns every result recorded so far;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+const QVector<BenchmarkResult>& Benchmark::getResults() const
+{
+    return mResults;
+}
+
+/*----------------------------------------------------------------------------
+Name         toJson
+
+Purpose      Returns the results, and details of the machine and run, as a
+             JSON object;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QJsonObject Benchmark::toJson() const
+{
+    QJsonObject context;
+    context.insert("date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    context.insert("host", QSysInfo::machineHostName());
+    context.insert("cpu_architecture", QSysInfo::currentCpuArchitecture());
+    context.insert("os", QSysInfo::prettyProductName());
+    context.insert("threads", QThread::idealThreadCount());
+    context.insert("min_time_s", mMinTime);
+    context.insert("repetitions", mRepetitions);
+
+    QJsonArray benchmarks;
+    for (int i = 0; i < mResults.size(); i++)
+    {
+        const BenchmarkResult& rResult = mResults.at(i);
+
+        QJsonObject object;
+        object.insert("name", rResult.name);
+        object.insert("iterations", static_cast<double>(rResult.iterations));
+        object.insert("ns_per_op", rResult.nsPerOp);
+        object.insert("ns_per_op_median", rResult.nsPerOpMedian);
+        object.insert("allocs_per_op", rResult.allocsPerOp);
+        object.insert("bytes_per_op", rResult.bytesPerOp);
+        object.insert("items_per_op", rResult.itemsPerOp);
+        object.insert("ns_per_item", rResult.nsPerOp / rResult.itemsPerOp);
+        benchmarks.append(object);
+    }
+
+    QJsonArray measurements;
+    for (int i = 0; i < mMeasurements.size(); i++)
+    {
+        const BenchmarkMeasurement& rMeasurement = mMeasurements.at(i);
+
+        QJsonObject object;
+        object.insert("name", rMeasurement.name);
+        object.insert("value", rMeasurement.value);
+        object.insert("unit", rMeasurement.unit);
+        measurements.append(object);
+    }
+
+    QJsonObject root;
+    root.insert("context", context);
+    root.insert("benchmarks", benchmarks);
+    root.insert("measurements", measurements);
+    return root;
+}
+
+/*----------------------------------------------------------------------------
+Name         allocationCount
+
+Purpose      Returns the number of calls to operator new so far;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+quint64 Benchmark::allocationCount()
+{
+    return gAllocationCount.load(std::memory_order_relaxed);
+}
+
+/*----------------------------------------------------------------------------
+Name         allocationBytes
+
+Purpose      Returns the number of bytes requested from operator new so far;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+quint64 Benchmark::allocationBytes()
+{
+    return gAllocationBytes.load(std::memory_order_relaxed);
+}
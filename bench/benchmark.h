@@ -0,0 +1,96 @@
+/*----------------------------------------------------------------------------
+Name         benchmark.h
+
+Purpose      Minimal timing harness for the benchmark executable.  Runs each
+             case for long enough to time it reliably and records ns/op and
+             allocations/op;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QString> // USES QString for case names;
+#include <QVector> // HASA QVector of results;
+#include <QRegExp> // USES QRegExp to select cases;
+#include <QJsonObject> // USES QJsonObject for machine-readable results;
+#include <functional> // USES std::function for the case bodies;
+
+// Result of running one benchmark case;
+struct BenchmarkResult
+{
+    QString name; // Name of the case;
+    qint64 iterations; // Operations timed in the best repetition;
+    double nsPerOp; // Nanoseconds per operation, best repetition;
+    double nsPerOpMedian; // Nanoseconds per operation, median repetition;
+    double allocsPerOp; // Calls to operator new per operation;
+    double bytesPerOp; // Bytes requested from operator new per operation;
+    double itemsPerOp; // Items processed per operation (e.g. batch size);
+};
+
+// A value, other than a time, recorded by a case (e.g. an accuracy);
+struct BenchmarkMeasurement
+{
+    QString name; // Name of the measurement;
+    double value; // The value;
+    QString unit; // Unit of the value;
+};
+
+class Benchmark
+{
+public:
+    // Body of a case; runs the operation the given number of times;
+    typedef std::function<void(qint64)> Body;
+
+    Benchmark(); // Constructor;
+
+    // Sets the regular expression selecting which cases are run;
+    void setFilter(const QString& rPattern);
+    // Sets how long, in seconds, each repetition should last;
+    void setMinTime(const double& rSeconds);
+    // Sets the number of timed repetitions of each case;
+    void setRepetitions(const int& rRepetitions);
+
+    // Whether or not the filter selects a case or measurement;
+    bool isSelected(const QString& rName) const;
+
+    // Times a case, if it is selected by the filter;
+    void run(const QString& rName, const Body& rBody
+             , const double& rItemsPerOp = 1.0);
+
+    // Records a measurement, if it is selected by the filter;
+    void report(const QString& rName, const double& rValue
+                , const QString& rUnit);
+
+    // Returns every result recorded so far;
+    const QVector<BenchmarkResult>& getResults(void) const;
+    // Returns the results, and details of the run, as a JSON object;
+    QJsonObject toJson(void) const;
+
+    // Number of calls to operator new made since the program started;
+    static quint64 allocationCount(void);
+    // Number of bytes requested from operator new since the program started;
+    static quint64 allocationBytes(void);
+
+private:
+    QRegExp mFilter; // Selects which cases are run;
+    double mMinTime; // Length of a repetition, in seconds;
+    int mRepetitions; // Number of timed repetitions;
+    QVector<BenchmarkResult> mResults; // Results recorded so far;
+    // Measurements recorded so far;
+    QVector<BenchmarkMeasurement> mMeasurements;
+};
+
+// Keeps the compiler from optimising away a value which is never used;
+template <typename T>
+inline void doNotOptimize(const T& rValue)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&rValue) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &rValue;
+#endif
+}
+
+#endif // BENCHMARK_H
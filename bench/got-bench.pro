@@ -0,0 +1,29 @@
+#-------------------------------------------------
+#
+# Benchmarks of the calculation and log file hot
+# paths.  Links QtCore only;
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = got-bench
+TEMPLATE = app
+
+CONFIG   += console c++11 release
+CONFIG   -= app_bundle
+
+include(../calc.pri)
+
+SOURCES += main.cpp \
+    benchmark.cpp \
+    benchcases.cpp \
+    ../logfile.cpp \
+    ../logwriter.cpp
+
+HEADERS += benchmark.h \
+    benchcases.h \
+    ../logfile.h \
+    ../logwriter.h \
+    ../spscringbuffer.h
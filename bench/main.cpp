@@ -0,0 +1,104 @@
+/*----------------------------------------------------------------------------
+Name         main.cpp
+
+Purpose      Benchmarks the SolarCalc, GotCalc, and LogFile hot paths and
+             writes the results as JSON, so that runs may be compared from
+             one change to the next;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include <QCoreApplication> // USES QCoreApplication for the argument list;
+#include <QCommandLineParser> // USES QCommandLineParser to read arguments;
+#include <QJsonDocument> // USES QJsonDocument to write the results;
+#include <QFile>
+#include <QDir>
+#include <QTextStream>
+#include "benchmark.h"
+#include "benchcases.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("got-bench");
+
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+                "Benchmarks the solar position, G/T, and log file hot paths "
+                "and writes ns/op and allocations/op as JSON.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("output"
+                                 , "Result file, or - for stdout (default).");
+
+    QCommandLineOption filterOption(QStringList() << "filter"
+                                    , "Only run cases whose names match."
+                                    , "regexp", ".*");
+    QCommandLineOption minTimeOption(QStringList() << "min-time"
+                                     , "Seconds each repetition should last."
+                                     , "seconds", "0.2");
+    QCommandLineOption repetitionsOption(QStringList() << "repetitions"
+                                         , "Timed repetitions of each case."
+                                         , "count", "5");
+    QCommandLineOption logDirOption(QStringList() << "log-dir"
+                                    , "Directory for the log file cases."
+                                    , "directory", QDir::tempPath());
+    parser.addOption(filterOption);
+    parser.addOption(minTimeOption);
+    parser.addOption(repetitionsOption);
+    parser.addOption(logDirOption);
+    parser.process(app);
+
+    Benchmark bench;
+    bench.setFilter(parser.value(filterOption));
+
+    bool ok = false;
+    const double minTime = parser.value(minTimeOption).toDouble(&ok);
+    if (!ok || minTime <= 0.0)
+    {
+        err << "Invalid minimum time: " << parser.value(minTimeOption) << '\n';
+        return 1;
+    }
+    bench.setMinTime(minTime);
+
+    const int repetitions = parser.value(repetitionsOption).toInt(&ok);
+    if (!ok || repetitions < 1)
+    {
+        err << "Invalid repetitions: " << parser.value(repetitionsOption)
+            << '\n';
+        return 1;
+    }
+    bench.setRepetitions(repetitions);
+
+    benchcases::runSolarCases(bench);
+    benchcases::runSolarTierCases(bench);
+    benchcases::runMathCases(bench);
+    benchcases::runGotCases(bench);
+    benchcases::runSunScanCases(bench);
+    benchcases::runTrackerCases(bench);
+    benchcases::runSunShareCases(bench);
+    benchcases::runLogCases(bench, parser.value(logDirOption));
+    benchcases::runCaptureCases(bench, parser.value(logDirOption));
+
+    const QByteArray json = QJsonDocument(bench.toJson()).toJson();
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() > 0 && args.at(0) != "-")
+    {
+        QFile output(args.at(0));
+        if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            err << "Cannot open " << args.at(0) << '\n';
+            return 1;
+        }
+        output.write(json);
+    }
+    else
+    {
+        QFile output;
+        output.open(stdout, QIODevice::WriteOnly);
+        output.write(json);
+    }
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+#-------------------------------------------------
+#
+# Calculation sources shared by the GUI and the
+# command line tools.  These only depend on QtCore;
+#
+#-------------------------------------------------
+
+# The calculation sources use C++11 (atomics, lambdas, and thread_local);
+CONFIG += c++11
+
+# The Qt-free core, which is also built on its own by core/gotcore.pro;
+include($$PWD/gotcore.pri)
+
+SOURCES += $$PWD/sunposition.cpp \
+    $$PWD/solarcalc.cpp \
+    $$PWD/gotcalc.cpp \
+    $$PWD/gotuncertainty.cpp \
+    $$PWD/solarfluxdatabase.cpp \
+    $$PWD/radiometercapture.cpp \
+    $$PWD/powersamplefile.cpp \
+    $$PWD/solarephemeriscache.cpp \
+    $$PWD/suntransit.cpp \
+    $$PWD/workstealingpool.cpp \
+    $$PWD/solarscheduler.cpp \
+    $$PWD/sunscan.cpp \
+    $$PWD/timezonetable.cpp \
+    $$PWD/suntracker.cpp \
+    $$PWD/simulatedcontroller.cpp \
+    $$PWD/sunshare.cpp \
+    $$PWD/metrics.cpp
+
+HEADERS += $$PWD/sunposition.h \
+    $$PWD/solarcalc.h \
+    $$PWD/gotcalc.h \
+    $$PWD/gotuncertainty.h \
+    $$PWD/solarfluxdatabase.h \
+    $$PWD/radiometercapture.h \
+    $$PWD/powersamplefile.h \
+    $$PWD/solarephemeriscache.h \
+    $$PWD/suntransit.h \
+    $$PWD/workstealingpool.h \
+    $$PWD/solarscheduler.h \
+    $$PWD/sunscan.h \
+    $$PWD/timezonetable.h \
+    $$PWD/seqlockslot.h \
+    $$PWD/suntracker.h \
+    $$PWD/simulatedcontroller.h \
+    $$PWD/sunshare.h \
+    $$PWD/metrics.h
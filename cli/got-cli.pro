@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Command line Gain Over Temperature batch processor.
+# Links QtCore only, so no display is required;
+#
+#-------------------------------------------------
+
+QT       += core concurrent sql
+QT       -= gui
+
+TARGET = got-cli
+TEMPLATE = app
+
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+include(../calc.pri)
+
+SOURCES += main.cpp \
+    sessionprocessor.cpp \
+    ../sessioncatalog.cpp
+
+HEADERS += sessionprocessor.h \
+    ../sessioncatalog.h
@@ -0,0 +1,399 @@
+/*----------------------------------------------------------------------------
+Name         main.cpp
+
+Purpose      Command line Gain Over Temperature batch processor.  Reads a file
+             of measurement sessions and writes the G/T of each, without
+             creating any windows;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Add the Monte Carlo uncertainty options;
+----------------------------------------------------------------------------*/
+#include <QCoreApplication> // USES QCoreApplication for the argument list;
+#include <QCommandLineParser> // USES QCommandLineParser to read arguments;
+#include <QFile> // USES QFile for input and output;
+#include <QThreadPool> // USES QThreadPool to set the number of workers;
+#include <QTextStream>
+#include "sessionprocessor.h"
+#include "solarfluxdatabase.h"
+#include "sessioncatalog.h"
+#include "sunshare.h"
+#include "metrics.h"
+#include <atomic> // USES std::atomic for the stop flag;
+#include <csignal> // USES std::signal to stop publishing;
+
+namespace
+{
+    // Works out a format from its name or, failing that, a file extension;
+    bool formatFromName(const QString& rName, SessionProcessor::Format& rFormat)
+    {
+        const QString name = rName.toLower();
+        if (name == "csv" || name.endsWith(".csv"))
+        {
+            rFormat = SessionProcessor::Csv;
+            return true;
+        }
+
+        if (name == "jsonl" || name.endsWith(".jsonl")
+                || name == "json" || name.endsWith(".json"))
+        {
+            rFormat = SessionProcessor::JsonLines;
+            return true;
+        }
+
+        return false;
+    }
+
+    // Set by SIGINT or SIGTERM to stop publishing the sun's position;
+    std::atomic<bool> stopRequested(false);
+
+    // Handles SIGINT and SIGTERM;
+    void requestStop(int)
+    {
+        stopRequested = true;
+    }
+
+    // Publishes the position of the sun to shared memory until stopped;
+    int publishSun(const double& rLatitude
+                   , const double& rLongitude
+                   , const double& rRateHz
+                   , const QString& rKey
+                   , QTextStream& rErr)
+    {
+        SunSharePublisher publisher(rKey);
+        publisher.setSite(rLatitude, rLongitude);
+        if (!publisher.setRateHz(rRateHz) || !publisher.open())
+        {
+            rErr << publisher.getLastError() << endl;
+            return 1;
+        }
+
+        std::signal(SIGINT, requestStop);
+        std::signal(SIGTERM, requestStop);
+
+        rErr << "Publishing the sun's position to " << rKey
+             << "; interrupt to stop" << endl;
+        publisher.start();
+        while (!stopRequested && !publisher.wait(200))
+        {
+        }
+        publisher.stop();
+
+        return 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("got-cli");
+
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+                "Calculates the Gain Over Temperature of each sun-noise "
+                "measurement session in a CSV or JSON Lines file.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("input", "Session file, or - for stdin.");
+    parser.addPositionalArgument("output"
+                                 , "Result file, or - for stdout (default).");
+
+    QCommandLineOption formatOption(QStringList() << "f" << "format"
+                                    , "Input format: csv or jsonl."
+                                    , "format");
+    QCommandLineOption outputFormatOption(QStringList()
+                                          << "o" << "output-format"
+                                          , "Output format: csv or jsonl."
+                                          , "format");
+    QCommandLineOption threadsOption(QStringList() << "j" << "threads"
+                                     , "Number of worker threads."
+                                     , "count");
+    QCommandLineOption chunkOption("chunk"
+                                   , "Number of sessions processed at a time."
+                                   , "count", "4096");
+    parser.addOption(formatOption);
+    parser.addOption(outputFormatOption);
+    parser.addOption(threadsOption);
+    QCommandLineOption fluxDatabaseOption("flux-db"
+                                          , "Solar flux database, used for"
+                                            " sessions which give a date"
+                                            " instead of the flux."
+                                          , "file");
+    QCommandLineOption importFluxOption("import-flux"
+                                        , "Import the observatory flux files"
+                                          " given as arguments into the"
+                                          " --flux-db database, then exit.");
+    QCommandLineOption catalogOption("catalog"
+                                     , "Session catalog to which every"
+                                       " calculated session is added."
+                                     , "file");
+    QCommandLineOption metricsOption("metrics"
+                                     , "Write counters and stage timings to"
+                                       " this file when done: Prometheus"
+                                       " text, or JSON if it ends in .json."
+                                     , "file");
+    QCommandLineOption uncertaintyOption("uncertainty"
+                                         , "Monte Carlo draws made to"
+                                           " estimate the uncertainty of each"
+                                           " G/T, written as its standard"
+                                           " deviation and 95% interval."
+                                         , "draws");
+    QCommandLineOption fluxUncertaintyOption("flux-uncertainty"
+                                             , "Fractional 1-sigma error of"
+                                               " the solar flux, for"
+                                               " --uncertainty."
+                                             , "fraction", "0.1");
+    QCommandLineOption beamwidthUncertaintyOption("beamwidth-uncertainty"
+                                                  , "1-sigma error of the"
+                                                    " beamwidth, in degrees,"
+                                                    " for --uncertainty."
+                                                  , "degrees", "0");
+    QCommandLineOption seedOption("seed"
+                                  , "Seed of the --uncertainty draws."
+                                  , "seed", "1");
+    QCommandLineOption publishSunOption("publish-sun"
+                                        , "Publish the sun's position at"
+                                          " --latitude and --longitude to"
+                                          " shared memory until interrupted.");
+    QCommandLineOption latitudeOption("latitude"
+                                      , "Latitude of the site, in degrees."
+                                      , "degrees");
+    QCommandLineOption longitudeOption("longitude"
+                                       , "Longitude of the site, in degrees,"
+                                         " east positive."
+                                       , "degrees");
+    QCommandLineOption publishRateOption("publish-rate"
+                                         , "Updates per second, 1-100."
+                                         , "hz", "10");
+    QCommandLineOption shmKeyOption("shm-key"
+                                    , "Key of the shared memory segment."
+                                    , "key", sun_share_default_key);
+    parser.addOption(chunkOption);
+    parser.addOption(fluxDatabaseOption);
+    parser.addOption(importFluxOption);
+    parser.addOption(catalogOption);
+    parser.addOption(metricsOption);
+    parser.addOption(uncertaintyOption);
+    parser.addOption(fluxUncertaintyOption);
+    parser.addOption(beamwidthUncertaintyOption);
+    parser.addOption(seedOption);
+    parser.addOption(publishSunOption);
+    parser.addOption(latitudeOption);
+    parser.addOption(longitudeOption);
+    parser.addOption(publishRateOption);
+    parser.addOption(shmKeyOption);
+    parser.process(app);
+
+    // Publishing the sun's position is also a separate job;
+    if (parser.isSet(publishSunOption))
+    {
+        bool latitudeOk = false;
+        bool longitudeOk = false;
+        bool rateOk = false;
+        const double latitude = parser.value(latitudeOption)
+                .toDouble(&latitudeOk);
+        const double longitude = parser.value(longitudeOption)
+                .toDouble(&longitudeOk);
+        const double rate = parser.value(publishRateOption).toDouble(&rateOk);
+        if (!latitudeOk || !longitudeOk || !rateOk)
+        {
+            err << "--publish-sun needs a numeric --latitude, --longitude,"
+                   " and --publish-rate" << endl;
+            return 1;
+        }
+
+        return publishSun(latitude, longitude, rate
+                          , parser.value(shmKeyOption), err);
+    }
+
+    // Importing flux files is a separate job from processing sessions;
+    if (parser.isSet(importFluxOption))
+    {
+        if (!parser.isSet(fluxDatabaseOption)
+                || parser.positionalArguments().isEmpty())
+        {
+            err << "--import-flux needs --flux-db and at least one file"
+                << endl;
+            return 1;
+        }
+
+        QString error;
+        int days = 0;
+        if (!SolarFluxDatabase::import(parser.positionalArguments()
+                                       , parser.value(fluxDatabaseOption)
+                                       , error, &days))
+        {
+            err << error << endl;
+            return 1;
+        }
+
+        err << days << " days of solar flux imported" << endl;
+        return 0;
+    }
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.isEmpty() || arguments.size() > 2)
+    {
+        parser.showHelp(1);
+    }
+
+    const QString inputName = arguments.at(0);
+    const QString outputName = (arguments.size() > 1) ? arguments.at(1) : "-";
+
+    // Work out the formats, defaulting to CSV and to writing results in the
+    // same format as they were read;
+    SessionProcessor::Format inputFormat = SessionProcessor::Csv;
+    if (parser.isSet(formatOption))
+    {
+        if (!formatFromName(parser.value(formatOption), inputFormat))
+        {
+            err << "Unknown input format "
+                << parser.value(formatOption) << endl;
+            return 1;
+        }
+    }
+    else
+    {
+        formatFromName(inputName, inputFormat);
+    }
+
+    SessionProcessor::Format outputFormat = inputFormat;
+    if (parser.isSet(outputFormatOption))
+    {
+        if (!formatFromName(parser.value(outputFormatOption), outputFormat))
+        {
+            err << "Unknown output format "
+                << parser.value(outputFormatOption) << endl;
+            return 1;
+        }
+    }
+    else if (outputName != "-")
+    {
+        formatFromName(outputName, outputFormat);
+    }
+
+    // The draws of the uncertainty estimate, if asked for;
+    unsigned long long draws = 0;
+    double fluxUncertainty = 0;
+    double beamwidthUncertainty = 0;
+    unsigned long long seed = 1;
+    if (parser.isSet(uncertaintyOption))
+    {
+        bool drawsOk = false;
+        bool fluxOk = false;
+        bool beamwidthOk = false;
+        bool seedOk = false;
+        draws = parser.value(uncertaintyOption).toULongLong(&drawsOk);
+        fluxUncertainty = parser.value(fluxUncertaintyOption)
+                .toDouble(&fluxOk);
+        beamwidthUncertainty = parser.value(beamwidthUncertaintyOption)
+                .toDouble(&beamwidthOk);
+        seed = parser.value(seedOption).toULongLong(&seedOk);
+        if (!drawsOk || draws == 0 || !fluxOk || fluxUncertainty < 0
+                || !beamwidthOk || beamwidthUncertainty < 0 || !seedOk)
+        {
+            err << "--uncertainty needs a positive number of draws, and"
+                   " --flux-uncertainty and --beamwidth-uncertainty of at"
+                   " least 0" << endl;
+            return 1;
+        }
+    }
+
+    if (parser.isSet(threadsOption))
+    {
+        QThreadPool::globalInstance()->setMaxThreadCount(
+                    qMax(1, parser.value(threadsOption).toInt()));
+    }
+
+    // Open the input and output, allowing stdin and stdout;
+    QFile input;
+    bool opened = false;
+    if (inputName == "-")
+    {
+        opened = input.open(stdin, QIODevice::ReadOnly);
+    }
+    else
+    {
+        input.setFileName(inputName);
+        opened = input.open(QIODevice::ReadOnly);
+    }
+
+    if (!opened)
+    {
+        err << "Unable to open " << inputName << ": "
+            << input.errorString() << endl;
+        return 1;
+    }
+
+    QFile output;
+    if (outputName == "-")
+    {
+        opened = output.open(stdout, QIODevice::WriteOnly);
+    }
+    else
+    {
+        output.setFileName(outputName);
+        opened = output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+
+    if (!opened)
+    {
+        err << "Unable to open " << outputName << ": "
+            << output.errorString() << endl;
+        return 1;
+    }
+
+    SolarFluxDatabase fluxDatabase;
+    if (parser.isSet(fluxDatabaseOption)
+            && !fluxDatabase.open(parser.value(fluxDatabaseOption)))
+    {
+        err << fluxDatabase.getLastError() << endl;
+        return 1;
+    }
+
+    SessionCatalog catalog;
+    if (parser.isSet(catalogOption)
+            && !catalog.open(parser.value(catalogOption)))
+    {
+        err << catalog.getLastError() << endl;
+        return 1;
+    }
+
+    SessionProcessor processor(inputFormat, outputFormat);
+    processor.setChunkSize(parser.value(chunkOption).toInt());
+    if (fluxDatabase.isOpen())
+    {
+        processor.setFluxDatabase(&fluxDatabase);
+    }
+    if (catalog.isOpen())
+    {
+        processor.setCatalog(&catalog, inputName);
+    }
+    processor.setUncertainty(draws, fluxUncertainty, beamwidthUncertainty
+                             , seed);
+
+    QString error;
+    const bool ran = processor.run(input, output, error);
+
+    // Metrics are written even after a failure, as they may explain it;
+    QString metricsError;
+    if (parser.isSet(metricsOption)
+            && !MetricsRegistry::instance().write(parser.value(metricsOption)
+                                                  , metricsError))
+    {
+        err << metricsError << endl;
+    }
+
+    if (!ran)
+    {
+        err << error << endl;
+        return 1;
+    }
+
+    output.flush();
+
+    err << processor.getSessionCount() << " sessions processed, "
+        << processor.getErrorCount() << " failed" << endl;
+
+    return (processor.getErrorCount() == 0) ? 0 : 2;
+}
@@ -0,0 +1,932 @@
+/*----------------------------------------------------------------------------
+Name         sessionprocessor.cpp
+
+Purpose      Streams sun-noise measurement sessions from a CSV or JSON Lines
+             file through GotCalc and writes out the Gain Over Temperature of
+             each;
+
+Notes        Input is read a chunk of lines at a time.  Each chunk is parsed
+             and calculated across the global QThreadPool, and the results are
+             written out in the same order as the input before the next chunk
+             is read, so memory use is bounded by the chunk size no matter how
+             long the input file is;
+
+             CSV input must begin with a header line naming the columns:
+
+             id, frequency, beamwidth, flux_low, flux_high, hot, cold
+
+             in any order.  The hot and cold columns hold one or more
+             measurements separated by semicolons.  A field may be quoted,
+             with any quote within it doubled, as the results are written.
+             JSON Lines input holds one object per line with the same keys,
+             where hot and cold are arrays;
+
+             When a flux database is set, the flux columns may be left out or
+             left empty, and the flux is looked up for the day given by an
+             ISO "date" column;
+
+             When a session catalog is set, every session calculated is also
+             added to it, one transaction per chunk, under the name given by
+             an optional "antenna" column;
+
+             When Monte Carlo draws are set, the standard deviation of each
+             G/T and the edges of its 95% interval, in dB, are written after
+             the G/T.  Every session's draws start from the same seed, so the
+             results do not depend on the order the sessions were run in;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Add calculated sessions to a session catalog;
+             17 Oct 26  AFB Reject JSON measurements which are not numbers;
+             17 Oct 26  AFB Read quoted CSV fields;
+             17 Oct 26  AFB Estimate the uncertainty of each G/T;
+----------------------------------------------------------------------------*/
+#include "sessionprocessor.h"
+#include "gotcalc.h" // USES GotCalc to calculate Gain Over Temperature;
+#include "solarfluxdatabase.h" // USES SolarFluxDatabase for missing flux;
+#include "sessioncatalog.h" // USES SessionCatalog to keep the results;
+#include "gotuncertainty.h" // USES GotUncertainty to estimate uncertainty;
+
+#include <QtConcurrent> // USES QtConcurrent to process chunks in parallel;
+#include <QJsonDocument> // USES QJsonDocument to parse JSON Lines;
+#include <QJsonObject>
+#include <QJsonArray>
+#include <limits>
+
+namespace
+{
+    // Result of processing one line of input;
+    struct LineResult
+    {
+        QString text; // Formatted output line;
+        bool failed; // Whether or not the session could be processed;
+        CatalogSession record; // The session, as added to the catalog;
+    };
+
+    // Functor used to map a chunk of input lines onto results;
+    struct ProcessLine
+    {
+        typedef LineResult result_type;
+
+        explicit ProcessLine(const SessionProcessor* pProcessor)
+            : mProcessor(pProcessor) {}
+
+        LineResult operator()(const QString& rLine) const
+        {
+            LineResult result;
+            result.text = mProcessor->processLine(rLine, result.failed
+                                                  , &result.record);
+            return result;
+        }
+
+        const SessionProcessor* mProcessor;
+    };
+
+    // Column names shared by the CSV and JSON formats;
+    const char* const column_id = "id";
+    const char* const column_date = "date";
+    const char* const column_antenna = "antenna";
+    const char* const column_frequency = "frequency";
+    const char* const column_beamwidth = "beamwidth";
+    const char* const column_flux_low = "flux_low";
+    const char* const column_flux_high = "flux_high";
+    const char* const column_hot = "hot";
+    const char* const column_cold = "cold";
+
+    // Parses a semicolon separated list of measurements;
+    bool parseMeasurements(const QString& rField, std::vector<double>& rValues)
+    {
+        const QStringList parts = rField.split(';', QString::SkipEmptyParts);
+        for (int i = 0; i < parts.size(); i++)
+        {
+            bool ok = false;
+            rValues.push_back(parts.at(i).trimmed().toDouble(&ok));
+            if (!ok)
+            {
+                return false;
+            }
+        }
+
+        return !rValues.empty();
+    }
+
+    // Parses a JSON array of measurements, every one of which must be a
+    // number;
+    bool parseMeasurements(const QJsonValue& rValue
+                           , std::vector<double>& rValues)
+    {
+        if (!rValue.isArray())
+        {
+            return false;
+        }
+
+        const QJsonArray array = rValue.toArray();
+        for (int i = 0; i < array.size(); i++)
+        {
+            if (!array.at(i).isDouble())
+            {
+                return false;
+            }
+
+            rValues.push_back(array.at(i).toDouble());
+        }
+
+        return true;
+    }
+
+    // Splits a line of CSV into its fields.  A field may be quoted, as
+    // csvField quotes it, with any quote within it doubled; returns false
+    // if a quote is not closed;
+    bool splitCsv(const QString& rLine, QStringList& rFields)
+    {
+        rFields.clear();
+
+        QString field;
+        bool quoted = false;
+        for (int i = 0; i < rLine.size(); i++)
+        {
+            const QChar c = rLine.at(i);
+            if (quoted)
+            {
+                if (c != '"')
+                {
+                    field += c;
+                }
+                else if (i + 1 < rLine.size() && rLine.at(i + 1) == '"')
+                {
+                    field += c;
+                    i++;
+                }
+                else
+                {
+                    quoted = false;
+                }
+            }
+            else if (c == '"')
+            {
+                quoted = true;
+            }
+            else if (c == ',')
+            {
+                rFields.append(field);
+                field.clear();
+            }
+            else
+            {
+                field += c;
+            }
+        }
+
+        rFields.append(field);
+        return !quoted;
+    }
+
+    // Quotes a CSV field if it contains a separator;
+    QString csvField(const QString& rField)
+    {
+        if (rField.contains(',') || rField.contains('"'))
+        {
+            QString quoted = rField;
+            quoted.replace("\"", "\"\"");
+            return "\"" + quoted + "\"";
+        }
+
+        return rField;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         SessionProcessor
+
+Purpose      Constructor;
+
+Input        inputFormat        Format of the sessions to be read;
+             outputFormat       Format of the results to be written;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SessionProcessor::SessionProcessor(Format inputFormat, Format outputFormat)
+    : mInputFormat(inputFormat)
+    , mOutputFormat(outputFormat)
+    , mChunkSize(4096)
+    , mpFluxDatabase(0)
+    , mpCatalog(0)
+    , mUncertaintyDraws(0)
+    , mSolarFluxUncertainty(0)
+    , mBeamwidthUncertaintyDeg(0)
+    , mUncertaintySeed(1)
+    , mSessionCount(0)
+    , mErrorCount(0)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         setChunkSize
+
+Purpose      Sets the number of lines which are read and then processed
+             concurrently before being written out;
+
+Input        rChunkSize         Number of lines per chunk;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SessionProcessor::setChunkSize(const int &rChunkSize)
+{
+    mChunkSize = qMax(1, rChunkSize);
+}
+
+/*----------------------------------------------------------------------------
+Name         setFluxDatabase
+
+Purpose      Sets the database from which the solar flux of sessions which do
+             not give it is looked up.  The database must stay open for as
+             long as the processor runs;
+
+Input        pDatabase          The database, or 0 to require the flux;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SessionProcessor::setFluxDatabase(const SolarFluxDatabase *pDatabase)
+{
+    mpFluxDatabase = pDatabase;
+}
+
+/*----------------------------------------------------------------------------
+Name         setCatalog
+
+Purpose      Sets the catalog to which every session which is calculated is
+             added.  The catalog must stay open for as long as the processor
+             runs;
+
+Input        pCatalog           The catalog, or 0 to keep no record;
+             rSource            Recorded as the source of each session;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SessionProcessor::setCatalog(SessionCatalog *pCatalog
+                                  , const QString &rSource)
+{
+    mpCatalog = pCatalog;
+    mCatalogSource = rSource;
+}
+
+/*----------------------------------------------------------------------------
+Name         setUncertainty
+
+Purpose      Sets the Monte Carlo draws made to estimate the uncertainty of
+             the G/T of each session;
+
+Input        rDraws                     Draws per session, or 0 to make no
+                                        estimate;
+             rSolarFluxUncertainty      Fractional 1-sigma error of the solar
+                                        flux (0.1 for 10%);
+             rBeamwidthUncertaintyDeg   1-sigma error of the beamwidth;
+             rSeed                      Seed from which each session's draws
+                                        are made;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SessionProcessor::setUncertainty(const unsigned long long &rDraws
+                                      , const double &rSolarFluxUncertainty
+                                      , const double &rBeamwidthUncertaintyDeg
+                                      , const unsigned long long &rSeed)
+{
+    mUncertaintyDraws = rDraws;
+    mSolarFluxUncertainty = rSolarFluxUncertainty;
+    mBeamwidthUncertaintyDeg = rBeamwidthUncertaintyDeg;
+    mUncertaintySeed = rSeed;
+}
+
+/*----------------------------------------------------------------------------
+Name         run
+
+Purpose      Reads every session from rIn and writes a result for each to
+             rOut;
+
+Input        rIn                Open device from which sessions are read;
+             rOut               Open device to which results are written;
+
+Output       rError             Description of the failure, if any;
+
+Returns      true  -  If the whole input was read.  Individual sessions which
+                      could not be processed are still reported in the
+                      output and counted by getErrorCount;
+             false -  If the input could not be read, the output could not
+                      be written, or the catalog could not be added to;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Add each chunk to the session catalog;
+----------------------------------------------------------------------------*/
+bool SessionProcessor::run(QIODevice &rIn, QIODevice &rOut, QString &rError)
+{
+    mSessionCount = 0;
+    mErrorCount = 0;
+    mCsvColumns.clear();
+
+    bool needHeader = (mInputFormat == Csv);
+
+    const QString header = outputHeader();
+    if (!header.isEmpty() && rOut.write(header.toUtf8()) < 0)
+    {
+        rError = "Unable to write output: " + rOut.errorString();
+        return false;
+    }
+
+    QStringList chunk;
+    chunk.reserve(mChunkSize);
+
+    while (true)
+    {
+        // Gather a chunk of lines, skipping blank lines and comments;
+        chunk.clear();
+        while (chunk.size() < mChunkSize && !rIn.atEnd())
+        {
+            const QString line = QString::fromUtf8(rIn.readLine()).trimmed();
+            if (line.isEmpty() || line.startsWith('#'))
+            {
+                continue;
+            }
+
+            if (needHeader)
+            {
+                if (!parseCsvHeader(line, rError))
+                {
+                    return false;
+                }
+
+                needHeader = false;
+                continue;
+            }
+
+            chunk.append(line);
+        }
+
+        if (chunk.isEmpty())
+        {
+            break;
+        }
+
+        // Process the chunk across the thread pool.  The results come back
+        // in the same order as the lines they were made from;
+        const QList<LineResult> results
+                = QtConcurrent::blockingMapped<QList<LineResult> >(
+                    chunk, ProcessLine(this));
+
+        QByteArray buffer;
+        QVector<CatalogSession> records;
+        for (int i = 0; i < results.size(); i++)
+        {
+            buffer += results.at(i).text.toUtf8();
+            buffer += '\n';
+
+            if (results.at(i).failed)
+            {
+                mErrorCount++;
+            }
+            else if (mpCatalog)
+            {
+                records.append(results.at(i).record);
+                records.last().source = mCatalogSource;
+            }
+        }
+
+        if (rOut.write(buffer) < 0)
+        {
+            rError = "Unable to write output: " + rOut.errorString();
+            return false;
+        }
+
+        // The whole chunk goes into the catalog in a single transaction;
+        if (!records.isEmpty() && !mpCatalog->insert(records))
+        {
+            rError = mpCatalog->getLastError();
+            return false;
+        }
+
+        mSessionCount += results.size();
+    }
+
+    if (needHeader)
+    {
+        rError = "Input contains no CSV header";
+        return false;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         processLine
+
+Purpose      Parses a single line of input, calculates the Gain Over
+             Temperature, and formats the result;
+
+Input        rLine              Line of input, in the input format;
+
+Output       rFailed            Set if the session could not be processed;
+             pRecord            If not 0, filled in with the session as it
+                                would be kept in a session catalog;
+
+Returns      QString            Line of output, in the output format, without
+                                a trailing newline;
+
+Notes        This is called concurrently from the worker threads and so must
+             not modify the SessionProcessor.  Each call uses its own GotCalc;
+
+             A session without a date is recorded at the time it was
+             processed, and one with only a date at midnight UTC;
+
+             The sessions of a chunk already share the thread pool, so the
+             Monte Carlo draws of each are made on the thread processing it;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Fill in the catalog record;
+             17 Oct 26  AFB Estimate the uncertainty of the G/T;
+----------------------------------------------------------------------------*/
+QString SessionProcessor::processLine(const QString &rLine, bool &rFailed
+                                      , CatalogSession *pRecord) const
+{
+    // The flux starts as NaN, to mark it as not given;
+    Session session;
+    session.frequencyMHz = 0;
+    session.beamwidth = 0;
+    session.solarFluxLow = std::numeric_limits<double>::quiet_NaN();
+    session.solarFluxHigh = std::numeric_limits<double>::quiet_NaN();
+
+    QString error;
+    double lowerFrequency = 0;
+    double higherFrequency = 0;
+
+    bool ok = (mInputFormat == Csv) ? parseCsv(rLine, session, error)
+                                    : parseJson(rLine, session, error);
+
+    if (ok && !GotCalc::findBracketingFrequencies(session.frequencyMHz
+                                                  , lowerFrequency
+                                                  , higherFrequency))
+    {
+        error = "frequency out of range";
+        ok = false;
+    }
+
+    // Look up any flux which was not given;
+    if (ok && (session.solarFluxLow != session.solarFluxLow
+               || session.solarFluxHigh != session.solarFluxHigh))
+    {
+        double lowFlux = 0;
+        double highFlux = 0;
+
+        if (!mpFluxDatabase || !session.date.isValid()
+                || !mpFluxDatabase->getFlux(session.date, lowerFrequency
+                                            , lowFlux)
+                || !mpFluxDatabase->getFlux(session.date, higherFrequency
+                                            , highFlux))
+        {
+            error = "no solar flux for the session's date";
+            ok = false;
+        }
+        else
+        {
+            if (session.solarFluxLow != session.solarFluxLow)
+            {
+                session.solarFluxLow = lowFlux;
+            }
+
+            if (session.solarFluxHigh != session.solarFluxHigh)
+            {
+                session.solarFluxHigh = highFlux;
+            }
+        }
+    }
+
+    GotCalc gotCalc(0);
+    GotUncertaintyResult uncertainty;
+    if (ok)
+    {
+        gotCalc.setOperatingFrequency(session.frequencyMHz);
+        gotCalc.setLowerFrequency(lowerFrequency);
+        gotCalc.setHigherFrequency(higherFrequency);
+        gotCalc.setSolarFluxLow(session.solarFluxLow);
+        gotCalc.setSolarFluxHigh(session.solarFluxHigh);
+        gotCalc.setBeamwidth(session.beamwidth);
+
+        for (size_t i = 0; i < session.hot.size(); i++)
+        {
+            gotCalc.addHotMeasurement(session.hot[i]);
+        }
+
+        for (size_t i = 0; i < session.cold.size(); i++)
+        {
+            gotCalc.addColdMeasurement(session.cold[i]);
+        }
+
+        gotCalc.calculate();
+
+        if (mUncertaintyDraws > 0)
+        {
+            // The edges of the 95% interval;
+            std::vector<double> percentiles;
+            percentiles.push_back(2.5);
+            percentiles.push_back(97.5);
+
+            GotUncertainty engine(0);
+            engine.setSeed(mUncertaintySeed);
+            engine.setPercentiles(percentiles);
+            uncertainty = engine.estimate(gotCalc.getUncertaintyInputs(
+                                              mSolarFluxUncertainty
+                                              , mBeamwidthUncertaintyDeg)
+                                          , mUncertaintyDraws);
+        }
+
+        if (pRecord)
+        {
+            const GotUncertaintyInputs inputs
+                    = gotCalc.getUncertaintyInputs(0, 0);
+
+            pRecord->antenna = session.antenna;
+            pRecord->measuredAt = session.date.isValid()
+                    ? QDateTime(session.date, QTime(0, 0), Qt::UTC)
+                    : QDateTime::currentDateTimeUtc();
+            pRecord->frequencyMHz = session.frequencyMHz;
+            pRecord->beamwidthDeg = session.beamwidth;
+            pRecord->solarFluxSfu = inputs.solarFluxSfu;
+            pRecord->hotDb = inputs.hotMeanDb;
+            pRecord->coldDb = inputs.coldMeanDb;
+            pRecord->gotDb = gotCalc.getGotRatiodB();
+        }
+    }
+
+    rFailed = !ok;
+
+    if (mOutputFormat == JsonLines)
+    {
+        QJsonObject object;
+        object.insert(column_id, session.id);
+        object.insert(column_frequency, session.frequencyMHz);
+        if (ok)
+        {
+            object.insert("lower_frequency", lowerFrequency);
+            object.insert("higher_frequency", higherFrequency);
+            object.insert("solar_flux", gotCalc.getInterpolatedSolarFlux());
+            object.insert("got_ratio", gotCalc.getGotRatio());
+            object.insert("got_db", gotCalc.getGotRatiodB());
+            if (mUncertaintyDraws > 0)
+            {
+                object.insert("got_db_sd", uncertainty.standardDeviationDb);
+                object.insert("got_db_low"
+                              , uncertainty.percentileValuesDb[0]);
+                object.insert("got_db_high"
+                              , uncertainty.percentileValuesDb[1]);
+            }
+        }
+        else
+        {
+            object.insert("error", error);
+        }
+
+        return QString::fromUtf8(
+                    QJsonDocument(object).toJson(QJsonDocument::Compact));
+    }
+
+    QStringList fields;
+    fields << csvField(session.id)
+           << QString::number(session.frequencyMHz, 'g', 10);
+    if (ok)
+    {
+        fields << QString::number(lowerFrequency, 'g', 10)
+               << QString::number(higherFrequency, 'g', 10)
+               << QString::number(gotCalc.getInterpolatedSolarFlux(), 'g', 10)
+               << QString::number(gotCalc.getGotRatio(), 'g', 10)
+               << QString::number(gotCalc.getGotRatiodB(), 'g', 10);
+        if (mUncertaintyDraws > 0)
+        {
+            fields << QString::number(uncertainty.standardDeviationDb, 'g', 10)
+                   << QString::number(uncertainty.percentileValuesDb[0]
+                                      , 'g', 10)
+                   << QString::number(uncertainty.percentileValuesDb[1]
+                                      , 'g', 10);
+        }
+        fields << QString();
+    }
+    else
+    {
+        fields << QString() << QString() << QString() << QString()
+               << QString();
+        if (mUncertaintyDraws > 0)
+        {
+            fields << QString() << QString() << QString();
+        }
+        fields << csvField(error);
+    }
+
+    return fields.join(',');
+}
+
+/*----------------------------------------------------------------------------
+Name         getSessionCount
+
+Purpose      Returns the number of sessions processed by the last run;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+qint64 SessionProcessor::getSessionCount() const
+{
+    return mSessionCount;
+}
+
+/*----------------------------------------------------------------------------
+Name         getErrorCount
+
+Purpose      Returns the number of sessions which could not be processed by
+             the last run;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+qint64 SessionProcessor::getErrorCount() const
+{
+    return mErrorCount;
+}
+
+/*----------------------------------------------------------------------------
+Name         parseCsvHeader
+
+Purpose      Records the position of each column named in the CSV header;
+
+Input        rLine              The header line;
+
+Output       rError             Description of the failure, if any;
+
+Returns      true  -  If every required column is present;
+             false -  If a column is missing or a quote is not closed;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Read quoted column names;
+----------------------------------------------------------------------------*/
+bool SessionProcessor::parseCsvHeader(const QString &rLine, QString &rError)
+{
+    QStringList names;
+    if (!splitCsv(rLine, names))
+    {
+        rError = "CSV header has an unterminated quoted field";
+        return false;
+    }
+
+    for (int i = 0; i < names.size(); i++)
+    {
+        mCsvColumns.insert(names.at(i).trimmed().toLower(), i);
+    }
+
+    const char* const required[] = { column_frequency, column_beamwidth
+                                     , column_hot, column_cold
+                                     , column_flux_low, column_flux_high };
+
+    // The flux may be looked up instead, if there is a database;
+    const size_t requiredCount = sizeof(required) / sizeof(required[0])
+            - (mpFluxDatabase ? 2 : 0);
+
+    for (size_t i = 0; i < requiredCount; i++)
+    {
+        if (!mCsvColumns.contains(required[i]))
+        {
+            rError = QString("CSV header is missing the '%1' column")
+                    .arg(required[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         parseCsv
+
+Purpose      Parses a line of CSV input into a Session;
+
+Input        rLine              Line of input;
+
+Output       rSession           The parsed session;
+             rError             Description of the failure, if any;
+
+Returns      true  -  If the line was parsed;
+             false -  If a field is missing or is not a number, or a quote
+                      is not closed;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Read quoted fields, as the results are written;
+----------------------------------------------------------------------------*/
+bool SessionProcessor::parseCsv(const QString &rLine, Session &rSession
+                                , QString &rError) const
+{
+    QStringList fields;
+    if (!splitCsv(rLine, fields))
+    {
+        rError = "unterminated quoted field";
+        return false;
+    }
+
+    if (mCsvColumns.contains(column_id)
+            && mCsvColumns.value(column_id) < fields.size())
+    {
+        rSession.id = fields.at(mCsvColumns.value(column_id)).trimmed();
+    }
+
+    if (mCsvColumns.contains(column_antenna)
+            && mCsvColumns.value(column_antenna) < fields.size())
+    {
+        rSession.antenna
+                = fields.at(mCsvColumns.value(column_antenna)).trimmed();
+    }
+
+    if (mCsvColumns.contains(column_date)
+            && mCsvColumns.value(column_date) < fields.size())
+    {
+        rSession.date = QDate::fromString(
+                    fields.at(mCsvColumns.value(column_date)).trimmed()
+                    , Qt::ISODate);
+    }
+
+    struct NumberField
+    {
+        const char* name;
+        double* pValue;
+        bool optional; // May be left out when there is a flux database;
+    };
+
+    const NumberField numbers[] = {
+        { column_frequency, &rSession.frequencyMHz, false },
+        { column_beamwidth, &rSession.beamwidth, false },
+        { column_flux_low, &rSession.solarFluxLow, true },
+        { column_flux_high, &rSession.solarFluxHigh, true }
+    };
+
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++)
+    {
+        const int column = mCsvColumns.value(numbers[i].name, fields.size());
+        const QString field = (column < fields.size())
+                ? fields.at(column).trimmed() : QString();
+
+        // Leave a missing flux as NaN, to be looked up;
+        if (field.isEmpty() && numbers[i].optional && mpFluxDatabase)
+        {
+            continue;
+        }
+
+        bool ok = false;
+        *numbers[i].pValue = field.toDouble(&ok);
+
+        if (!ok)
+        {
+            rError = QString("invalid %1").arg(numbers[i].name);
+            return false;
+        }
+    }
+
+    const int hotColumn = mCsvColumns.value(column_hot);
+    const int coldColumn = mCsvColumns.value(column_cold);
+
+    if (hotColumn >= fields.size()
+            || !parseMeasurements(fields.at(hotColumn), rSession.hot))
+    {
+        rError = "invalid hot measurements";
+        return false;
+    }
+
+    if (coldColumn >= fields.size()
+            || !parseMeasurements(fields.at(coldColumn), rSession.cold))
+    {
+        rError = "invalid cold measurements";
+        return false;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         parseJson
+
+Purpose      Parses a line of JSON Lines input into a Session;
+
+Input        rLine              Line of input;
+
+Output       rSession           The parsed session;
+             rError             Description of the failure, if any;
+
+Returns      true  -  If the line was parsed;
+             false -  If the line is not an object, a field is missing, or
+                      a field or measurement is not a number;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Reject hot and cold measurements which are not
+                            numbers;
+----------------------------------------------------------------------------*/
+bool SessionProcessor::parseJson(const QString &rLine, Session &rSession
+                                 , QString &rError) const
+{
+    QJsonParseError parseError;
+    const QJsonDocument document
+            = QJsonDocument::fromJson(rLine.toUtf8(), &parseError);
+
+    if (parseError.error != QJsonParseError::NoError || !document.isObject())
+    {
+        rError = "invalid JSON: " + parseError.errorString();
+        return false;
+    }
+
+    const QJsonObject object = document.object();
+
+    const QJsonValue id = object.value(column_id);
+    if (id.isString())
+    {
+        rSession.id = id.toString();
+    }
+    else if (id.isDouble())
+    {
+        rSession.id = QString::number(id.toDouble(), 'g', 15);
+    }
+
+    rSession.antenna = object.value(column_antenna).toString();
+    rSession.date = QDate::fromString(object.value(column_date).toString()
+                                      , Qt::ISODate);
+
+    struct NumberField
+    {
+        const char* name;
+        double* pValue;
+        bool optional; // May be left out when there is a flux database;
+    };
+
+    const NumberField numbers[] = {
+        { column_frequency, &rSession.frequencyMHz, false },
+        { column_beamwidth, &rSession.beamwidth, false },
+        { column_flux_low, &rSession.solarFluxLow, true },
+        { column_flux_high, &rSession.solarFluxHigh, true }
+    };
+
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++)
+    {
+        const QJsonValue value = object.value(numbers[i].name);
+
+        // Leave a missing flux as NaN, to be looked up;
+        if ((value.isUndefined() || value.isNull()) && numbers[i].optional
+                && mpFluxDatabase)
+        {
+            continue;
+        }
+
+        if (!value.isDouble())
+        {
+            rError = QString("invalid %1").arg(numbers[i].name);
+            return false;
+        }
+
+        *numbers[i].pValue = value.toDouble();
+    }
+
+    const char* const measurements[] = { column_hot, column_cold };
+    std::vector<double>* const pValues[] = { &rSession.hot, &rSession.cold };
+
+    for (size_t i = 0; i < sizeof(measurements) / sizeof(measurements[0]); i++)
+    {
+        const QJsonValue value = object.value(measurements[i]);
+        if (value.isUndefined())
+        {
+            continue;
+        }
+
+        if (!parseMeasurements(value, *pValues[i]))
+        {
+            rError = QString("invalid %1").arg(measurements[i]);
+            return false;
+        }
+    }
+
+    if (rSession.hot.empty() || rSession.cold.empty())
+    {
+        rError = "missing hot or cold measurements";
+        return false;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         outputHeader
+
+Purpose      Returns the header to be written before any results;
+
+Returns      QString            The CSV header line, or an empty string for
+                                JSON Lines output;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Name the uncertainty columns;
+----------------------------------------------------------------------------*/
+QString SessionProcessor::outputHeader() const
+{
+    if (mOutputFormat == JsonLines)
+    {
+        return QString();
+    }
+
+    return QString("id,frequency,lower_frequency,higher_frequency,solar_flux"
+                   ",got_ratio,got_db%1,error\n")
+            .arg((mUncertaintyDraws > 0) ? ",got_db_sd,got_db_low,got_db_high"
+                                         : "");
+}
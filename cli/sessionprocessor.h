@@ -0,0 +1,106 @@
+/*----------------------------------------------------------------------------
+Name         sessionprocessor.h
+
+Purpose      Streams sun-noise measurement sessions from a CSV or JSON Lines
+             file through GotCalc and writes out the Gain Over Temperature of
+             each;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef SESSIONPROCESSOR_H
+#define SESSIONPROCESSOR_H
+
+#include <QIODevice> // USES QIODevice for input and output;
+#include <QString> // USES QString for lines of input and output;
+#include <QStringList> // USES QStringList for chunks of lines;
+#include <QHash> // HASA QHash of CSV column names to indices;
+#include <QDate> // USES QDate for the day of each session;
+#include <vector> // USES std::vector for the hot and cold measurements;
+
+class SolarFluxDatabase;
+class SessionCatalog;
+struct CatalogSession;
+
+// One measurement session, as read from a line of the input file;
+struct Session
+{
+    QString id; // Identifier of the session, copied to the output;
+    QString antenna; // Name of the antenna, kept in the session catalog;
+    QDate date; // Day of the session, used to look up missing flux;
+    double frequencyMHz; // Operating frequency of the antenna;
+    double beamwidth; // Beamwidth of the antenna, in degrees;
+    double solarFluxLow; // Solar flux at the lower bracketing frequency;
+    double solarFluxHigh; // Solar flux at the higher bracketing frequency;
+    std::vector<double> hot; // Measurements pointing at the sun, in dB;
+    std::vector<double> cold; // Measurements pointing away from the sun, in dB;
+};
+
+class SessionProcessor
+{
+public:
+    // Formats in which sessions may be read and results may be written;
+    enum Format
+    {
+        Csv,
+        JsonLines
+    };
+
+    explicit SessionProcessor(Format inputFormat, Format outputFormat);
+
+    // Sets the number of lines handed to the worker threads at a time;
+    void setChunkSize(const int& rChunkSize);
+    // Sets the database from which missing solar flux is looked up;
+    void setFluxDatabase(const SolarFluxDatabase* pDatabase);
+    // Sets the catalog to which every calculated session is added;
+    void setCatalog(SessionCatalog* pCatalog, const QString& rSource);
+    // Sets the Monte Carlo draws made to estimate the uncertainty of each
+    // G/T, 0 for none;
+    void setUncertainty(const unsigned long long& rDraws
+                        , const double& rSolarFluxUncertainty
+                        , const double& rBeamwidthUncertaintyDeg
+                        , const unsigned long long& rSeed);
+
+    // Reads every session from rIn and writes a result for each to rOut;
+    bool run(QIODevice& rIn, QIODevice& rOut, QString& rError);
+
+    // Parses, calculates, and formats a single line of input;
+    QString processLine(const QString& rLine, bool& rFailed
+                        , CatalogSession* pRecord = 0) const;
+
+    // Returns the number of sessions processed by the last run;
+    qint64 getSessionCount(void) const;
+    // Returns the number of sessions which could not be processed;
+    qint64 getErrorCount(void) const;
+
+private:
+    Format mInputFormat; // Format of the sessions being read;
+    Format mOutputFormat; // Format of the results being written;
+    int mChunkSize; // Number of lines processed concurrently;
+    const SolarFluxDatabase* mpFluxDatabase; // Source of missing flux;
+    SessionCatalog* mpCatalog; // Catalog the results are added to, if any;
+    QString mCatalogSource; // Source recorded with each catalogued session;
+    unsigned long long mUncertaintyDraws; // Monte Carlo draws, or 0;
+    double mSolarFluxUncertainty; // Fractional 1-sigma error of the flux;
+    double mBeamwidthUncertaintyDeg; // 1-sigma error of the beamwidth;
+    unsigned long long mUncertaintySeed; // Seed of each session's draws;
+
+    // Column indices of the CSV header, keyed by column name;
+    QHash<QString, int> mCsvColumns;
+
+    qint64 mSessionCount; // Sessions processed by the last run;
+    qint64 mErrorCount; // Sessions which failed in the last run;
+
+    // Reads the CSV header line and records the column positions;
+    bool parseCsvHeader(const QString& rLine, QString& rError);
+
+    // Parses a line of input into a Session;
+    bool parseCsv(const QString& rLine, Session& rSession
+                  , QString& rError) const;
+    bool parseJson(const QString& rLine, Session& rSession
+                   , QString& rError) const;
+
+    // Returns the header to be written before any results, if any;
+    QString outputHeader(void) const;
+};
+
+#endif // SESSIONPROCESSOR_H
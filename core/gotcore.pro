@@ -0,0 +1,27 @@
+#-------------------------------------------------
+#
+# gotcore library: the sun position and G/T
+# calculations, with a C interface, for services
+# which can not take Qt.  Builds a static library,
+# or a shared one with CONFIG+=gotcore_shared;
+#
+#-------------------------------------------------
+
+QT       -= core gui
+CONFIG   -= qt
+
+TARGET = gotcore
+TEMPLATE = lib
+
+VERSION = 1.0.0
+
+gotcore_shared {
+    CONFIG += shared
+    # Only the C interface is exported from the shared library;
+    DEFINES += GOTCORE_SHARED GOTCORE_BUILD
+    contains(QMAKE_COMPILER, gcc): QMAKE_CXXFLAGS += -fvisibility=hidden
+} else {
+    CONFIG += staticlib
+}
+
+include(../gotcore.pri)
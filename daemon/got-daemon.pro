@@ -0,0 +1,27 @@
+#-------------------------------------------------
+#
+# Local query daemon, answering sun position and
+# G/T requests over a Unix socket.  Links QtCore
+# only.  Uses epoll, so builds on Linux only;
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = got-daemon
+TEMPLATE = app
+
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+!linux: error("got-daemon uses epoll, and only builds on Linux")
+
+include(../calc.pri)
+
+SOURCES += main.cpp \
+    querydaemon.cpp \
+    queryprotocol.cpp
+
+HEADERS += querydaemon.h \
+    queryprotocol.h
@@ -0,0 +1,92 @@
+/*----------------------------------------------------------------------------
+Name         main.cpp
+
+Purpose      Local query daemon.  Answers sun position and G/T requests from
+             other processes over a Unix socket until interrupted;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include <QCoreApplication> // USES QCoreApplication for the argument list;
+#include <QCommandLineParser> // USES QCommandLineParser to read arguments;
+#include <QDir> // USES QDir for the default socket path;
+#include <QTextStream>
+#include "querydaemon.h"
+#include "metrics.h"
+#include <csignal> // USES std::signal to stop the daemon;
+
+namespace
+{
+    // The daemon being run, for the signal handler;
+    QueryDaemon* pRunningDaemon = 0;
+
+    // Handles SIGINT and SIGTERM;
+    void requestStop(int)
+    {
+        if (pRunningDaemon)
+        {
+            pRunningDaemon->stop();
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("got-daemon");
+
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+                "Answers sun position and G/T requests from other processes"
+                " over a Unix socket, in batches.");
+    parser.addHelpOption();
+
+    QCommandLineOption socketOption(QStringList() << "s" << "socket"
+                                    , "Path of the Unix socket."
+                                    , "path"
+                                    , QDir::tempPath() + "/got-daemon.sock");
+    QCommandLineOption metricsOption("metrics"
+                                     , "Write counters and batch timings to"
+                                       " this file when stopped: Prometheus"
+                                       " text, or JSON if it ends in .json."
+                                     , "file");
+    parser.addOption(socketOption);
+    parser.addOption(metricsOption);
+    parser.process(app);
+
+    QueryDaemon daemon;
+    if (!daemon.listen(parser.value(socketOption)))
+    {
+        err << daemon.getLastError() << endl;
+        return 1;
+    }
+
+    pRunningDaemon = &daemon;
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    err << "Listening on " << parser.value(socketOption)
+        << "; interrupt to stop" << endl;
+    const bool ran = daemon.run();
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    pRunningDaemon = 0;
+
+    QString metricsError;
+    if (parser.isSet(metricsOption)
+            && !MetricsRegistry::instance().write(parser.value(metricsOption)
+                                                  , metricsError))
+    {
+        err << metricsError << endl;
+    }
+
+    if (!ran)
+    {
+        err << daemon.getLastError() << endl;
+        return 1;
+    }
+
+    return 0;
+}
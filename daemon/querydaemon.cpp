@@ -0,0 +1,814 @@
+/*----------------------------------------------------------------------------
+Name         querydaemon.cpp
+
+Purpose      Serves sun position and G/T requests over a Unix socket, from a
+             single epoll loop which answers the requests that arrive
+             together in batches;
+
+Notes        Every socket is non-blocking and watched by one epoll instance.
+             Each turn of the loop reads whatever every ready connection has
+             sent, decodes the whole frames into the batch, answers the batch,
+             and writes the answers back.  Requests which arrive while a
+             batch is being answered wait for the next turn, so the busier
+             the daemon the larger its batches, without any request waiting
+             on a timer;
+
+             The sun position requests of a batch are sorted by site, and the
+             instants of every request for a site are worked out in a single
+             call of SolarCalc::calculateBatchUtc with the vectorised
+             polynomial kernels.  G/T requests are worked out with gotcore,
+             without a GotCalc.  The answers are then written in the order
+             the requests came in, so each connection gets its answers in
+             order;
+
+             A connection's output which the socket will not take at once is
+             kept, and sent as EPOLLOUT reports room for it.  A client which
+             sends requests without reading the answers is not read from
+             while max_output_bytes of answers wait for it, so its output
+             can not grow without bound; the kernel's buffers hold it back
+             until it reads.  A connection being closed is watched only for
+             room to write, so a client which has shut down its side does
+             not wake the loop again and again;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Calculate G/T with gotcore rather than GotCalc;
+             17 Oct 26  AFB Average the hot and cold levels as power, as
+                            GotCalc does;
+             17 Oct 26  AFB Bound each connection's output, and stop
+                            watching a closing connection for input;
+----------------------------------------------------------------------------*/
+#include "querydaemon.h"
+
+#include <QFile> // USES QFile::encodeName for the socket path;
+#include "solarcalc.h" // USES SolarCalc::calculateBatchUtc for the batches;
+#include "metrics.h" // USES MetricsRegistry to count requests and batches;
+#include <sys/epoll.h> // USES epoll to wait on every socket at once;
+#include <sys/eventfd.h> // USES an eventfd to wake the loop to stop;
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm> // USES std::sort to group the sun requests by site;
+
+namespace
+{
+    // Most events taken from epoll in one turn of the loop;
+    const int max_events = 256;
+
+    // Bytes read from a socket at a time;
+    const int read_chunk_bytes = 64 * 1024;
+
+    // Most bytes read from a connection in one turn of the loop, which
+    // bounds the answers one turn can add to its output;
+    const int max_read_bytes = 16 * read_chunk_bytes;
+
+    // Bytes of answers waiting for a client above which no more of its
+    // requests are read, room for two of the largest answers;
+    const int max_output_bytes = 2 * queryprotocol::max_payload_bytes;
+
+    // Metrics of the daemon;
+    struct DaemonMetrics
+    {
+        DaemonMetrics()
+        {
+            MetricsRegistry& rRegistry = MetricsRegistry::instance();
+            connections = rRegistry.counter("got_daemon_connections_total"
+                                            , "Connections accepted");
+            sunRequests = rRegistry.counter("got_daemon_requests_total"
+                                            , "Requests answered", "op"
+                                            , "sun");
+            gotRequests = rRegistry.counter("got_daemon_requests_total"
+                                            , "Requests answered", "op"
+                                            , "got");
+            errors = rRegistry.counter("got_daemon_errors_total"
+                                       , "Requests answered with an error");
+            batches = rRegistry.histogram("got_daemon_batch_seconds"
+                                          , "Time taken to answer each"
+                                            " batch of requests");
+        }
+
+        MetricsCounter connections; // Connections accepted;
+        MetricsCounter sunRequests; // Sun position requests answered;
+        MetricsCounter gotRequests; // G/T requests answered;
+        MetricsCounter errors; // Requests answered with an error;
+        MetricsHistogram batches; // Time taken by each batch;
+    };
+
+    // Returns the metrics, registering them on first use;
+    const DaemonMetrics& daemonMetrics()
+    {
+        static const DaemonMetrics metrics;
+        return metrics;
+    }
+
+    // Returns a description of errno, after what was being done;
+    QString systemError(const QString& rWhat)
+    {
+        return rWhat + ": " + QString::fromLocal8Bit(strerror(errno));
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         QueryDaemon
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QueryDaemon::QueryDaemon()
+    : mListenFd(-1)
+    , mEpollFd(-1)
+    , mWakeFd(-1)
+    , mBatchSize(0)
+{
+    daemonMetrics();
+}
+
+/*----------------------------------------------------------------------------
+Name         ~QueryDaemon
+
+Purpose      Destructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QueryDaemon::~QueryDaemon()
+{
+    closeAll();
+}
+
+/*----------------------------------------------------------------------------
+Name         listen
+
+Purpose      Creates the socket and the epoll instance, and starts listening;
+
+Input        rPath              Path of the socket file;
+
+Returns      bool               true -  If listening;
+                                false - If not, e.g. as another daemon is
+                                        listening on the path;
+
+Notes        A socket file nobody is listening on, left by a daemon which was
+             killed, is removed first;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool QueryDaemon::listen(const QString &rPath)
+{
+    closeAll();
+
+    const QByteArray path = QFile::encodeName(rPath);
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= static_cast<int>(sizeof(address.sun_path)))
+    {
+        mLastError = "The socket path is too long: " + rPath;
+        return false;
+    }
+    memcpy(address.sun_path, path.constData(), path.size());
+
+    // See whether another daemon is listening before taking the path;
+    const int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe >= 0)
+    {
+        const bool answered = (::connect(probe
+                                         , reinterpret_cast<sockaddr*>(
+                                             &address)
+                                         , sizeof(address)) == 0);
+        close(probe);
+        if (answered)
+        {
+            mLastError = "Another daemon is listening on " + rPath;
+            return false;
+        }
+    }
+    unlink(path.constData());
+
+    mListenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC
+                       , 0);
+    if (mListenFd < 0
+            || bind(mListenFd, reinterpret_cast<sockaddr*>(&address)
+                    , sizeof(address)) != 0
+            || ::listen(mListenFd, SOMAXCONN) != 0)
+    {
+        mLastError = systemError("Unable to listen on " + rPath);
+        closeAll();
+        return false;
+    }
+    mPath = rPath;
+
+    mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    mWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mEpollFd < 0 || mWakeFd < 0)
+    {
+        mLastError = systemError("Unable to create the epoll instance");
+        closeAll();
+        return false;
+    }
+
+    const int watched[] = {mListenFd, mWakeFd};
+    for (size_t i = 0; i < sizeof(watched) / sizeof(watched[0]); i++)
+    {
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = watched[i];
+        if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, watched[i], &event) != 0)
+        {
+            mLastError = systemError("Unable to watch the socket");
+            closeAll();
+            return false;
+        }
+    }
+
+    mLastError.clear();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         getLastError
+
+Purpose      Returns a description of why listen() or run() last failed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString QueryDaemon::getLastError() const
+{
+    return mLastError;
+}
+
+/*----------------------------------------------------------------------------
+Name         run
+
+Purpose      Serves requests until stop() is called;
+
+Returns      bool               true -  If stopped by stop();
+                                false - If epoll failed, or listen() was not
+                                        called;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool QueryDaemon::run()
+{
+    if (mEpollFd < 0)
+    {
+        mLastError = "The daemon is not listening";
+        return false;
+    }
+
+    epoll_event events[max_events];
+    std::vector<Connection*> ready;
+    bool stopping = false;
+
+    while (!stopping)
+    {
+        const int count = epoll_wait(mEpollFd, events, max_events, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            mLastError = systemError("Unable to wait for requests");
+            return false;
+        }
+
+        ready.clear();
+        for (int i = 0; i < count; i++)
+        {
+            const int fd = events[i].data.fd;
+            if (fd == mWakeFd)
+            {
+                stopping = true;
+                continue;
+            }
+
+            if (fd == mListenFd)
+            {
+                acceptConnections();
+                continue;
+            }
+
+            Connection* pConnection = mConnections.value(fd, 0);
+            if (!pConnection)
+            {
+                continue;
+            }
+
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP))
+            {
+                readConnection(pConnection);
+            }
+            if (events[i].events & EPOLLERR)
+            {
+                pConnection->closing = true;
+            }
+            ready.push_back(pConnection);
+        }
+
+        answerBatch();
+
+        for (size_t i = 0; i < ready.size(); i++)
+        {
+            writeConnection(ready[i]);
+            if (ready[i]->closing && ready[i]->output.isEmpty())
+            {
+                closeConnection(ready[i]);
+            }
+        }
+    }
+
+    uint64_t wakes = 0;
+    if (read(mWakeFd, &wakes, sizeof(wakes)) < 0)
+    {
+        wakes = 0;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         stop
+
+Purpose      Makes run() return at the end of its current turn;
+
+Notes        Only writes to the eventfd, which is safe in a signal handler;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void QueryDaemon::stop()
+{
+    const uint64_t one = 1;
+    if (mWakeFd >= 0 && write(mWakeFd, &one, sizeof(one)) < 0)
+    {
+        return;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         acceptConnections
+
+Purpose      Accepts every connection waiting on the listening socket;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void QueryDaemon::acceptConnections()
+{
+    while (true)
+    {
+        const int fd = accept4(mListenFd, 0, 0
+                               , SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            // EAGAIN once there are no more, and anything else is the
+            // client's problem;
+            return;
+        }
+
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            close(fd);
+            continue;
+        }
+
+        Connection* pConnection = new Connection;
+        pConnection->fd = fd;
+        pConnection->events = event.events;
+        pConnection->closing = false;
+        pConnection->json = false;
+        mConnections.insert(fd, pConnection);
+        daemonMetrics().connections.increment();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         readConnection
+
+Purpose      Reads everything a connection has sent, and queues each whole
+             request in the batch;
+
+Input        pConnection        The connection;
+
+Notes        A request which can not be decoded is answered with an error at
+             once.  A frame too large to take closes the connection, as the
+             stream can not be followed past it, and is answered as JSON if
+             its payload starts as JSON, or in the framing of the
+             connection's last request if it does not show;
+
+             At most max_read_bytes are read in a turn, and nothing while
+             max_output_bytes of answers wait to be written.  Whatever is
+             left is read in a later turn;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Bound the bytes read a turn, and answer a frame
+                            too large in the connection's framing;
+----------------------------------------------------------------------------*/
+void QueryDaemon::readConnection(Connection *pConnection)
+{
+    if (pConnection->closing
+            || pConnection->output.size() >= max_output_bytes)
+    {
+        return;
+    }
+
+    char buffer[read_chunk_bytes];
+    int taken = 0;
+    while (taken < max_read_bytes)
+    {
+        const ssize_t got = read(pConnection->fd, buffer, sizeof(buffer));
+        if (got > 0)
+        {
+            pConnection->input.append(buffer, static_cast<int>(got));
+            taken += static_cast<int>(got);
+            continue;
+        }
+
+        if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK
+                         && errno != EINTR))
+        {
+            pConnection->closing = true;
+        }
+        if (got == 0 || errno != EINTR)
+        {
+            break;
+        }
+    }
+
+    const char* pData = pConnection->input.constData();
+    const int size = pConnection->input.size();
+    int offset = 0;
+    while (true)
+    {
+        bool tooLarge = false;
+        const int length = queryprotocol::frameLength(pData + offset
+                                                      , size - offset
+                                                      , tooLarge);
+        if (tooLarge)
+        {
+            const bool json = (size - offset > queryprotocol::length_bytes)
+                    ? pData[offset + queryprotocol::length_bytes] == '{'
+                    : pConnection->json;
+            queryprotocol::appendError(pConnection->output, json, 0
+                                       , "request too large");
+            daemonMetrics().errors.increment();
+            pConnection->closing = true;
+            offset = size;
+            break;
+        }
+
+        if (length == 0)
+        {
+            break;
+        }
+
+        if (mBatchSize == mBatch.size())
+        {
+            mBatch.resize(mBatch.size() + 1);
+        }
+
+        Pending& rPending = mBatch[mBatchSize];
+        rPending.pConnection = pConnection;
+        rPending.request.json = false;
+        rPending.request.id = 0;
+
+        QString error;
+        const bool decoded = queryprotocol::decodeRequest(
+                    pData + offset + queryprotocol::length_bytes
+                    , length - queryprotocol::length_bytes
+                    , rPending.request, error);
+        pConnection->json = rPending.request.json;
+        if (decoded)
+        {
+            mBatchSize++;
+        }
+        else
+        {
+            queryprotocol::appendError(pConnection->output
+                                       , rPending.request.json
+                                       , rPending.request.id, error);
+            daemonMetrics().errors.increment();
+        }
+
+        offset += length;
+    }
+
+    pConnection->input.remove(0, offset);
+}
+
+/*----------------------------------------------------------------------------
+Name         answerBatch
+
+Purpose      Answers every request queued in this turn of the loop, appending
+             the answers to the output of each request's connection in the
+             order the requests came in;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void QueryDaemon::answerBatch()
+{
+    if (mBatchSize == 0)
+    {
+        return;
+    }
+
+    const DaemonMetrics& rMetrics = daemonMetrics();
+    MetricsTimer timer(rMetrics.batches);
+
+    answerSunRequests();
+
+    for (size_t i = 0; i < mBatchSize; i++)
+    {
+        Pending& rPending = mBatch[i];
+        if (rPending.request.type == queryprotocol::SunRequest)
+        {
+            const size_t offset = mOffsets[i];
+            queryprotocol::appendSunResponse(rPending.pConnection->output
+                                             , rPending.request
+                                             , mAzimuth.data() + offset
+                                             , mAltitude.data() + offset
+                                             , mZenith.data() + offset
+                                             , mHourAngle.data() + offset);
+            rMetrics.sunRequests.increment();
+        }
+        else
+        {
+            answerGotRequest(rPending);
+        }
+    }
+
+    mBatchSize = 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         answerSunRequests
+
+Purpose      Works out the positions of every sun request of the batch, one
+             site at a time, into the columns;
+
+Notes        mOffsets[i] is left as the start of request i's positions in the
+             columns;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void QueryDaemon::answerSunRequests()
+{
+    mOrder.clear();
+    mOffsets.assign(mBatchSize, 0);
+
+    size_t total = 0;
+    for (size_t i = 0; i < mBatchSize; i++)
+    {
+        if (mBatch[i].request.type == queryprotocol::SunRequest)
+        {
+            mOrder.push_back(i);
+            total += mBatch[i].request.utcSeconds.size();
+        }
+    }
+
+    if (total == 0)
+    {
+        return;
+    }
+
+    // Group the requests by site;
+    const std::vector<Pending>& rBatch = mBatch;
+    std::sort(mOrder.begin(), mOrder.end(), [&](size_t a, size_t b)
+    {
+        const queryprotocol::Request& rA = rBatch[a].request;
+        const queryprotocol::Request& rB = rBatch[b].request;
+        return (rA.latitude < rB.latitude)
+                || (rA.latitude == rB.latitude && rA.longitude < rB.longitude);
+    });
+
+    mTimes.resize(total);
+    mAzimuth.resize(total);
+    mAltitude.resize(total);
+    mZenith.resize(total);
+    mHourAngle.resize(total);
+
+    size_t offset = 0;
+    size_t first = 0;
+    while (first < mOrder.size())
+    {
+        const queryprotocol::Request& rSite = mBatch[mOrder[first]].request;
+        const size_t start = offset;
+
+        size_t last = first;
+        while (last < mOrder.size()
+               && mBatch[mOrder[last]].request.latitude == rSite.latitude
+               && mBatch[mOrder[last]].request.longitude == rSite.longitude)
+        {
+            const std::vector<double>& rTimes
+                    = mBatch[mOrder[last]].request.utcSeconds;
+            std::copy(rTimes.begin(), rTimes.end(), mTimes.begin() + offset);
+            mOffsets[mOrder[last]] = offset;
+            offset += rTimes.size();
+            last++;
+        }
+
+        SolarCalc::calculateBatchUtc(rSite.latitude, rSite.longitude
+                                     , mTimes.data() + start, offset - start
+                                     , mAzimuth.data() + start
+                                     , mAltitude.data() + start
+                                     , mZenith.data() + start
+                                     , mHourAngle.data() + start
+                                     , PolynomialMath);
+        first = last;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         answerGotRequest
+
+Purpose      Calculates the G/T of a request and appends the answer;
+
+Input        rPending           The request and its connection;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Average as power ratios;
+----------------------------------------------------------------------------*/
+void QueryDaemon::answerGotRequest(Pending &rPending)
+{
+    const queryprotocol::Request& rRequest = rPending.request;
+    QByteArray& rOutput = rPending.pConnection->output;
+
+    gotcore::GotInputs inputs;
+    inputs.operatingFrequencyMHz = rRequest.frequencyMHz;
+    if (!gotcore::findBracketingFrequencies(rRequest.frequencyMHz
+                                            , inputs.lowerFrequencyMHz
+                                            , inputs.higherFrequencyMHz))
+    {
+        queryprotocol::appendError(rOutput, rRequest.json, rRequest.id
+                                   , "frequency out of range");
+        daemonMetrics().errors.increment();
+        return;
+    }
+
+    if (rRequest.hot.empty() || rRequest.cold.empty())
+    {
+        queryprotocol::appendError(rOutput, rRequest.json, rRequest.id
+                                   , "missing hot or cold measurements");
+        daemonMetrics().errors.increment();
+        return;
+    }
+
+    inputs.solarFluxLowSfu = rRequest.solarFluxLow;
+    inputs.solarFluxHighSfu = rRequest.solarFluxHigh;
+    inputs.beamwidthDeg = rRequest.beamwidthDeg;
+    inputs.hotDb = gotcore::meanPowerDb(rRequest.hot.data()
+                                        , rRequest.hot.size());
+    inputs.coldDb = gotcore::meanPowerDb(rRequest.cold.data()
+                                         , rRequest.cold.size());
+
+    const gotcore::GotResult result = gotcore::computeGot(inputs);
+
+    queryprotocol::appendGotResponse(rOutput, rRequest, result.gotDb
+                                     , result.gotRatio
+                                     , result.solarFluxWm2Hz);
+    daemonMetrics().gotRequests.increment();
+}
+
+/*----------------------------------------------------------------------------
+Name         writeConnection
+
+Purpose      Writes as much of a connection's output as the socket will take,
+             waiting on EPOLLOUT for the rest;
+
+Input        pConnection        The connection;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Leave the events to watchConnection;
+----------------------------------------------------------------------------*/
+void QueryDaemon::writeConnection(Connection *pConnection)
+{
+    int written = 0;
+    const int size = pConnection->output.size();
+    while (written < size)
+    {
+        const ssize_t sent = send(pConnection->fd
+                                  , pConnection->output.constData() + written
+                                  , size - written, MSG_NOSIGNAL);
+        if (sent > 0)
+        {
+            written += static_cast<int>(sent);
+            continue;
+        }
+
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+
+        // The client has gone, so its answers can go too;
+        pConnection->closing = true;
+        pConnection->output.clear();
+        return;
+    }
+
+    pConnection->output.remove(0, written);
+    watchConnection(pConnection);
+}
+
+/*----------------------------------------------------------------------------
+Name         watchConnection
+
+Purpose      Watches a connection for the events its state calls for: input
+             while it is open and its output is below max_output_bytes, and
+             room to write while it has output;
+
+Input        pConnection        The connection;
+
+Notes        EPOLLHUP and EPOLLERR are reported whatever is watched, so a
+             closing connection whose client has gone is still closed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void QueryDaemon::watchConnection(Connection *pConnection)
+{
+    quint32 events = 0;
+    if (!pConnection->closing
+            && pConnection->output.size() < max_output_bytes)
+    {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (!pConnection->output.isEmpty())
+    {
+        events |= EPOLLOUT;
+    }
+
+    if (events != pConnection->events)
+    {
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.fd = pConnection->fd;
+        epoll_ctl(mEpollFd, EPOLL_CTL_MOD, pConnection->fd, &event);
+        pConnection->events = events;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         closeConnection
+
+Purpose      Closes a connection and forgets it;
+
+Input        pConnection        The connection, which is deleted;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void QueryDaemon::closeConnection(Connection *pConnection)
+{
+    mConnections.remove(pConnection->fd);
+    close(pConnection->fd);
+    delete pConnection;
+}
+
+/*----------------------------------------------------------------------------
+Name         closeAll
+
+Purpose      Closes every connection, the listening socket, and the epoll
+             instance, and removes the socket file;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void QueryDaemon::closeAll()
+{
+    const QList<Connection*> connections = mConnections.values();
+    for (int i = 0; i < connections.size(); i++)
+    {
+        close(connections.at(i)->fd);
+        delete connections.at(i);
+    }
+    mConnections.clear();
+    mBatchSize = 0;
+
+    const int fds[] = {mListenFd, mEpollFd, mWakeFd};
+    for (size_t i = 0; i < sizeof(fds) / sizeof(fds[0]); i++)
+    {
+        if (fds[i] >= 0)
+        {
+            close(fds[i]);
+        }
+    }
+
+    if (mListenFd >= 0 && !mPath.isEmpty())
+    {
+        unlink(QFile::encodeName(mPath).constData());
+    }
+
+    mListenFd = -1;
+    mEpollFd = -1;
+    mWakeFd = -1;
+    mPath.clear();
+}
@@ -0,0 +1,98 @@
+/*----------------------------------------------------------------------------
+Name         querydaemon.h
+
+Purpose      Serves sun position and G/T requests over a Unix socket, from a
+             single epoll loop which answers the requests that arrive
+             together in batches;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Bound each connection's output;
+----------------------------------------------------------------------------*/
+#ifndef QUERYDAEMON_H
+#define QUERYDAEMON_H
+
+#include <QString>
+#include <QByteArray> // HASA QByteArrays of each connection's input and output;
+#include <QHash> // HASA QHash of the connections by descriptor;
+#include <vector> // HASA std::vectors of the batch and its results;
+#include "queryprotocol.h" // USES queryprotocol to decode and encode;
+#include "gotcore.h" // USES gotcore for the G/T requests;
+
+class QueryDaemon
+{
+public:
+    QueryDaemon(); // Constructor;
+    ~QueryDaemon(); // Destructor, closes every connection and the socket;
+
+    // Listens on a Unix socket, replacing any socket file left behind;
+    bool listen(const QString& rPath);
+    // Returns a description of why listen() or run() last failed;
+    QString getLastError(void) const;
+
+    // Serves requests until stop() is called;
+    bool run(void);
+    // Makes run() return.  May be called from any thread or a signal
+    // handler;
+    void stop(void);
+
+private:
+    Q_DISABLE_COPY(QueryDaemon)
+
+    // A client connection;
+    struct Connection
+    {
+        int fd; // The socket;
+        QByteArray input; // Bytes read which are not yet a whole frame;
+        QByteArray output; // Bytes of responses not yet written;
+        quint32 events; // Events epoll is watching for;
+        bool closing; // Whether to close once the output is written;
+        bool json; // Whether the last request came as JSON;
+    };
+
+    // A request waiting in the batch, with the connection it came from;
+    struct Pending
+    {
+        Connection* pConnection;
+        queryprotocol::Request request;
+    };
+
+    QString mPath; // Path of the socket file;
+    int mListenFd; // The listening socket;
+    int mEpollFd; // The epoll instance;
+    int mWakeFd; // eventfd written by stop();
+    QString mLastError; // Why listen() or run() last failed;
+
+    QHash<int, Connection*> mConnections; // Open connections;
+    std::vector<Pending> mBatch; // Requests read in this turn of the loop;
+    size_t mBatchSize; // Requests of mBatch in use;
+
+    // Columns for a batch of sun positions;
+    std::vector<double> mTimes;
+    std::vector<double> mAzimuth;
+    std::vector<double> mAltitude;
+    std::vector<double> mZenith;
+    std::vector<double> mHourAngle;
+    std::vector<size_t> mOrder; // Sun requests, sorted by site;
+    std::vector<size_t> mOffsets; // Start of each request in the columns;
+
+    // Accepts every waiting connection;
+    void acceptConnections(void);
+    // Reads what a connection has sent, queuing each whole request;
+    void readConnection(Connection* pConnection);
+    // Answers every request queued in this turn of the loop;
+    void answerBatch(void);
+    // Answers the sun position requests of the batch, a site at a time;
+    void answerSunRequests(void);
+    // Answers a G/T request;
+    void answerGotRequest(Pending& rPending);
+    // Writes as much of a connection's output as it will take;
+    void writeConnection(Connection* pConnection);
+    // Watches a connection for the events its state calls for;
+    void watchConnection(Connection* pConnection);
+    // Closes and forgets a connection;
+    void closeConnection(Connection* pConnection);
+    // Closes the connections, socket, and epoll instance;
+    void closeAll(void);
+};
+
+#endif // QUERYDAEMON_H
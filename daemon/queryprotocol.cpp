@@ -0,0 +1,812 @@
+/*----------------------------------------------------------------------------
+Name         queryprotocol.cpp
+
+Purpose      Messages passed between got-daemon and its clients over a Unix
+             socket: sun position and G/T requests and their responses, as
+             binary or as JSON;
+
+Notes        Every message is a frame: the length of the payload, as a 32 bit
+             unsigned integer, then the payload.  A payload starting with '{'
+             is a JSON object, and anything else is binary, starting with its
+             MessageType.  A request is answered in the form it was made in;
+
+             Binary payloads are a fixed header followed by arrays of
+             doubles, in the byte order of the machine, as both ends of a
+             Unix socket are on the same host.  The headers keep the arrays
+             8 byte aligned, and the columns of a sun position response are
+             written straight from the arrays they were calculated into;
+
+             JSON requests use the keys of got-cli's JSON Lines input:
+
+                 {"id": 1, "op": "sun", "latitude": 34.05,
+                  "longitude": -118.25, "utc": [1781294400, ...]}
+                 {"id": 2, "op": "got", "frequency": 2300, "beamwidth": 2.5,
+                  "flux_low": 140, "flux_high": 150, "hot": [...],
+                  "cold": [...]}
+
+             and are answered with "azimuth", "altitude", "zenith" and
+             "hour_angle" arrays, with "got_db", "got_ratio" and
+             "solar_flux", or with "error";
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Bound counts by the bytes left in a payload;
+             17 Oct 26  AFB Reject sun requests with non-finite values;
+----------------------------------------------------------------------------*/
+#include "queryprotocol.h"
+
+#include <QJsonDocument> // USES QJsonDocument for JSON payloads;
+#include <QJsonObject>
+#include <QJsonArray>
+#include <cmath> // USES std::isfinite;
+#include <cstring> // USES memcpy;
+
+namespace
+{
+    // Binary header of a SunRequest, followed by count instants;
+    struct SunRequestHeader
+    {
+        quint8 type;
+        quint8 reserved[3];
+        quint32 id;
+        double latitude;
+        double longitude;
+        quint32 count;
+        quint32 padding;
+    };
+
+    // Binary header of a GotRequest, followed by the hot and then the cold
+    // measurements;
+    struct GotRequestHeader
+    {
+        quint8 type;
+        quint8 reserved[3];
+        quint32 id;
+        double frequencyMHz;
+        double beamwidthDeg;
+        double solarFluxLow;
+        double solarFluxHigh;
+        quint32 hotCount;
+        quint32 coldCount;
+    };
+
+    // Binary header of a SunResponse, followed by the azimuth, altitude,
+    // zenith, and hour angle columns of count entries each;
+    struct SunResponseHeader
+    {
+        quint8 type;
+        quint8 reserved[3];
+        quint32 id;
+        quint32 count;
+        quint32 padding;
+    };
+
+    // Binary GotResponse;
+    struct GotResponseBody
+    {
+        quint8 type;
+        quint8 reserved[3];
+        quint32 id;
+        double gotDb;
+        double gotRatio;
+        double solarFlux;
+    };
+
+    // Binary header of an ErrorResponse, followed by length bytes of UTF-8;
+    struct ErrorResponseHeader
+    {
+        quint8 type;
+        quint8 reserved[3];
+        quint32 id;
+        quint32 length;
+        quint32 padding;
+    };
+
+    // Appends the length of a payload;
+    void appendLength(QByteArray& rOut, const int& rSize)
+    {
+        const quint32 length = static_cast<quint32>(rSize);
+        rOut.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    }
+
+    // Appends a frame holding a JSON object;
+    void appendJson(QByteArray& rOut, const QJsonObject& rObject)
+    {
+        const QByteArray payload
+                = QJsonDocument(rObject).toJson(QJsonDocument::Compact);
+        appendLength(rOut, payload.size());
+        rOut.append(payload);
+    }
+
+    // Appends an array of doubles;
+    void appendDoubles(QByteArray& rOut, const double* pValues, size_t count)
+    {
+        rOut.append(reinterpret_cast<const char*>(pValues)
+                    , static_cast<int>(count * sizeof(double)));
+    }
+
+    // Returns a JSON array of doubles;
+    QJsonArray jsonArray(const double* pValues, size_t count)
+    {
+        QJsonArray array;
+        for (size_t i = 0; i < count; i++)
+        {
+            array.append(pValues[i]);
+        }
+        return array;
+    }
+
+    // Checks that a sun request holds finite values, which the daemon can
+    // sort and group sites by, and that its answer will fit in a frame;
+    bool checkSunRequest(const queryprotocol::Request& rRequest
+                         , QString& rError)
+    {
+        if (rRequest.type != queryprotocol::SunRequest)
+        {
+            return true;
+        }
+
+        if (rRequest.utcSeconds.size() > queryprotocol::max_instants)
+        {
+            rError = QString("more than %1 instants in one request")
+                    .arg(static_cast<int>(queryprotocol::max_instants));
+            return false;
+        }
+
+        if (!std::isfinite(rRequest.latitude)
+                || !std::isfinite(rRequest.longitude))
+        {
+            rError = "latitude and longitude must be finite";
+            return false;
+        }
+
+        for (size_t i = 0; i < rRequest.utcSeconds.size(); i++)
+        {
+            if (!std::isfinite(rRequest.utcSeconds[i]))
+            {
+                rError = "utc must be finite";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Reads a JSON array of numbers;
+    bool readJsonArray(const QJsonValue& rValue, std::vector<double>& rOut)
+    {
+        if (!rValue.isArray())
+        {
+            return false;
+        }
+
+        const QJsonArray array = rValue.toArray();
+        rOut.resize(array.size());
+        for (int i = 0; i < array.size(); i++)
+        {
+            if (!array.at(i).isDouble())
+            {
+                return false;
+            }
+            rOut[i] = array.at(i).toDouble();
+        }
+        return true;
+    }
+
+    // Reads a JSON number;
+    bool readJsonNumber(const QJsonObject& rObject, const char* pName
+                        , double& rOut)
+    {
+        const QJsonValue value = rObject.value(pName);
+        if (!value.isDouble())
+        {
+            return false;
+        }
+        rOut = value.toDouble();
+        return true;
+    }
+
+    // Copies count doubles out of a payload, checking that they are there.
+    // The count is compared with the bytes left rather than multiplied, so
+    // that a count of nearly 2^32 cannot wrap past the check;
+    bool readDoubles(const char* pPayload, const int& rSize, size_t offset
+                     , size_t count, std::vector<double>& rOut)
+    {
+        const size_t size = static_cast<size_t>(rSize);
+        if (offset > size || count > (size - offset) / sizeof(double))
+        {
+            return false;
+        }
+
+        rOut.resize(count);
+        if (count > 0)
+        {
+            memcpy(&rOut[0], pPayload + offset, count * sizeof(double));
+        }
+        return true;
+    }
+
+    // Decodes a JSON request;
+    bool decodeJsonRequest(const char* pPayload, const int& rSize
+                           , queryprotocol::Request& rRequest
+                           , QString& rError)
+    {
+        QJsonParseError parseError;
+        const QJsonDocument document = QJsonDocument::fromJson(
+                    QByteArray::fromRawData(pPayload, rSize), &parseError);
+        if (parseError.error != QJsonParseError::NoError
+                || !document.isObject())
+        {
+            rError = "invalid JSON: " + parseError.errorString();
+            return false;
+        }
+
+        const QJsonObject object = document.object();
+        rRequest.json = true;
+        rRequest.id = static_cast<quint32>(object.value("id").toDouble());
+
+        const QString op = object.value("op").toString();
+        if (op == "sun")
+        {
+            rRequest.type = queryprotocol::SunRequest;
+            if (!readJsonNumber(object, "latitude", rRequest.latitude)
+                    || !readJsonNumber(object, "longitude"
+                                       , rRequest.longitude)
+                    || !readJsonArray(object.value("utc")
+                                      , rRequest.utcSeconds))
+            {
+                rError = "a sun request needs latitude, longitude, and an"
+                         " array of utc";
+                return false;
+            }
+            return true;
+        }
+
+        if (op == "got")
+        {
+            rRequest.type = queryprotocol::GotRequest;
+            if (!readJsonNumber(object, "frequency", rRequest.frequencyMHz)
+                    || !readJsonNumber(object, "beamwidth"
+                                       , rRequest.beamwidthDeg)
+                    || !readJsonNumber(object, "flux_low"
+                                       , rRequest.solarFluxLow)
+                    || !readJsonNumber(object, "flux_high"
+                                       , rRequest.solarFluxHigh)
+                    || !readJsonArray(object.value("hot"), rRequest.hot)
+                    || !readJsonArray(object.value("cold"), rRequest.cold))
+            {
+                rError = "a got request needs frequency, beamwidth,"
+                         " flux_low, flux_high, and arrays of hot and cold";
+                return false;
+            }
+            return true;
+        }
+
+        rError = "unknown op " + op;
+        return false;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         Request
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+queryprotocol::Request::Request()
+    : type(SunRequest)
+    , json(false)
+    , id(0)
+    , latitude(0)
+    , longitude(0)
+    , frequencyMHz(0)
+    , beamwidthDeg(0)
+    , solarFluxLow(0)
+    , solarFluxHigh(0)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         Response
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+queryprotocol::Response::Response()
+    : type(ErrorResponse)
+    , id(0)
+    , gotDb(0)
+    , gotRatio(0)
+    , solarFlux(0)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         frameLength
+
+Purpose      Returns the length of the frame at the start of a buffer;
+
+Input        pData              Start of the buffer;
+             rSize              Bytes in the buffer;
+
+Output       rTooLarge          Set if the frame's payload is larger than
+                                max_payload_bytes, when the stream can not be
+                                read any further;
+
+Returns      int                Bytes of the frame, length included, or 0 if
+                                the buffer does not hold all of it yet;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int queryprotocol::frameLength(const char *pData, const int &rSize
+                               , bool &rTooLarge)
+{
+    rTooLarge = false;
+    if (rSize < length_bytes)
+    {
+        return 0;
+    }
+
+    quint32 length = 0;
+    memcpy(&length, pData, sizeof(length));
+    if (length > max_payload_bytes)
+    {
+        rTooLarge = true;
+        return 0;
+    }
+
+    const int total = length_bytes + static_cast<int>(length);
+    return (rSize >= total) ? total : 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         decodeRequest
+
+Purpose      Decodes the payload of a request frame;
+
+Input        pPayload           The payload, after its length;
+             rSize              Bytes of the payload;
+
+Output       rRequest           The request;
+             rError             Why it could not be decoded, if it could not;
+
+Returns      bool               true -  If the request was decoded;
+                                false - If not.  rRequest's id and json are
+                                        still set when they could be read, so
+                                        that the error can be answered;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Answer JSON which does not parse as JSON;
+----------------------------------------------------------------------------*/
+bool queryprotocol::decodeRequest(const char *pPayload, const int &rSize
+                                  , Request &rRequest, QString &rError)
+{
+    if (rSize < 1)
+    {
+        rError = "empty request";
+        return false;
+    }
+
+    if (pPayload[0] == '{')
+    {
+        // Even JSON which does not parse is answered as JSON;
+        rRequest.json = true;
+        return decodeJsonRequest(pPayload, rSize, rRequest, rError)
+                && checkSunRequest(rRequest, rError);
+    }
+
+    rRequest.json = false;
+    const quint8 type = static_cast<quint8>(pPayload[0]);
+
+    if (type == SunRequest
+            && rSize >= static_cast<int>(sizeof(SunRequestHeader)))
+    {
+        SunRequestHeader header;
+        memcpy(&header, pPayload, sizeof(header));
+        rRequest.type = SunRequest;
+        rRequest.id = header.id;
+        rRequest.latitude = header.latitude;
+        rRequest.longitude = header.longitude;
+        if (!readDoubles(pPayload, rSize, sizeof(header), header.count
+                         , rRequest.utcSeconds))
+        {
+            rError = "sun request shorter than its count of instants";
+            return false;
+        }
+        return checkSunRequest(rRequest, rError);
+    }
+
+    if (type == GotRequest
+            && rSize >= static_cast<int>(sizeof(GotRequestHeader)))
+    {
+        GotRequestHeader header;
+        memcpy(&header, pPayload, sizeof(header));
+        rRequest.type = GotRequest;
+        rRequest.id = header.id;
+        rRequest.frequencyMHz = header.frequencyMHz;
+        rRequest.beamwidthDeg = header.beamwidthDeg;
+        rRequest.solarFluxLow = header.solarFluxLow;
+        rRequest.solarFluxHigh = header.solarFluxHigh;
+        if (!readDoubles(pPayload, rSize, sizeof(header), header.hotCount
+                         , rRequest.hot)
+                || !readDoubles(pPayload, rSize, sizeof(header)
+                                + header.hotCount * sizeof(double)
+                                , header.coldCount, rRequest.cold))
+        {
+            rError = "got request shorter than its counts of measurements";
+            return false;
+        }
+        return true;
+    }
+
+    rError = QString("unknown or short request of type %1").arg(type);
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+Name         decodeResponse
+
+Purpose      Decodes the payload of a response frame;
+
+Input        pPayload           The payload, after its length;
+             rSize              Bytes of the payload;
+
+Output       rResponse          The response;
+             rError             Why it could not be decoded, if it could not;
+
+Returns      bool               true -  If the response was decoded;
+                                false - If not;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool queryprotocol::decodeResponse(const char *pPayload, const int &rSize
+                                   , Response &rResponse, QString &rError)
+{
+    if (rSize >= 1 && pPayload[0] == '{')
+    {
+        QJsonParseError parseError;
+        const QJsonDocument document = QJsonDocument::fromJson(
+                    QByteArray::fromRawData(pPayload, rSize), &parseError);
+        if (parseError.error != QJsonParseError::NoError
+                || !document.isObject())
+        {
+            rError = "invalid JSON: " + parseError.errorString();
+            return false;
+        }
+
+        const QJsonObject object = document.object();
+        rResponse.id = static_cast<quint32>(object.value("id").toDouble());
+        if (object.contains("error"))
+        {
+            rResponse.type = ErrorResponse;
+            rResponse.error = object.value("error").toString();
+            return true;
+        }
+
+        if (object.contains("got_db"))
+        {
+            rResponse.type = GotResponse;
+            rResponse.gotDb = object.value("got_db").toDouble();
+            rResponse.gotRatio = object.value("got_ratio").toDouble();
+            rResponse.solarFlux = object.value("solar_flux").toDouble();
+            return true;
+        }
+
+        rResponse.type = SunResponse;
+        if (!readJsonArray(object.value("azimuth"), rResponse.azimuthDeg)
+                || !readJsonArray(object.value("altitude")
+                                  , rResponse.altitudeDeg)
+                || !readJsonArray(object.value("zenith"), rResponse.zenithDeg)
+                || !readJsonArray(object.value("hour_angle")
+                                  , rResponse.hourAngleDeg))
+        {
+            rError = "sun response without its arrays";
+            return false;
+        }
+        return true;
+    }
+
+    const quint8 type = (rSize >= 1) ? static_cast<quint8>(pPayload[0]) : 0;
+
+    if (type == SunResponse
+            && rSize >= static_cast<int>(sizeof(SunResponseHeader)))
+    {
+        SunResponseHeader header;
+        memcpy(&header, pPayload, sizeof(header));
+        rResponse.type = SunResponse;
+        rResponse.id = header.id;
+
+        const size_t column = header.count * sizeof(double);
+        if (!readDoubles(pPayload, rSize, sizeof(header), header.count
+                         , rResponse.azimuthDeg)
+                || !readDoubles(pPayload, rSize, sizeof(header) + column
+                                , header.count, rResponse.altitudeDeg)
+                || !readDoubles(pPayload, rSize, sizeof(header) + 2 * column
+                                , header.count, rResponse.zenithDeg)
+                || !readDoubles(pPayload, rSize, sizeof(header) + 3 * column
+                                , header.count, rResponse.hourAngleDeg))
+        {
+            rError = "sun response shorter than its count of instants";
+            return false;
+        }
+        return true;
+    }
+
+    if (type == GotResponse
+            && rSize >= static_cast<int>(sizeof(GotResponseBody)))
+    {
+        GotResponseBody body;
+        memcpy(&body, pPayload, sizeof(body));
+        rResponse.type = GotResponse;
+        rResponse.id = body.id;
+        rResponse.gotDb = body.gotDb;
+        rResponse.gotRatio = body.gotRatio;
+        rResponse.solarFlux = body.solarFlux;
+        return true;
+    }
+
+    if (type == ErrorResponse
+            && rSize >= static_cast<int>(sizeof(ErrorResponseHeader)))
+    {
+        ErrorResponseHeader header;
+        memcpy(&header, pPayload, sizeof(header));
+        if (header.length > static_cast<size_t>(rSize) - sizeof(header))
+        {
+            rError = "error response shorter than its message";
+            return false;
+        }
+        rResponse.type = ErrorResponse;
+        rResponse.id = header.id;
+        rResponse.error = QString::fromUtf8(pPayload + sizeof(header)
+                                            , header.length);
+        return true;
+    }
+
+    rError = QString("unknown or short response of type %1").arg(type);
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+Name         appendSunRequest
+
+Purpose      Appends the frame of a sun position request;
+
+Input        rJson              Whether to encode it as JSON;
+             rId                Id returned in the response;
+             rLatitude          Latitude of the site, in degrees;
+             rLongitude         Longitude of the site, in degrees, east
+                                positive;
+             pUtcSeconds        Instants, in seconds since 1970 UTC;
+             rCount             Number of instants;
+
+Output       rOut               Buffer the frame is appended to;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void queryprotocol::appendSunRequest(QByteArray &rOut, const bool &rJson
+                                     , const quint32 &rId
+                                     , const double &rLatitude
+                                     , const double &rLongitude
+                                     , const double *pUtcSeconds
+                                     , const int &rCount)
+{
+    if (rJson)
+    {
+        QJsonObject object;
+        object.insert("id", static_cast<double>(rId));
+        object.insert("op", QString("sun"));
+        object.insert("latitude", rLatitude);
+        object.insert("longitude", rLongitude);
+        object.insert("utc", jsonArray(pUtcSeconds, rCount));
+        appendJson(rOut, object);
+        return;
+    }
+
+    SunRequestHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = SunRequest;
+    header.id = rId;
+    header.latitude = rLatitude;
+    header.longitude = rLongitude;
+    header.count = static_cast<quint32>(rCount);
+
+    appendLength(rOut, sizeof(header) + rCount * sizeof(double));
+    rOut.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    appendDoubles(rOut, pUtcSeconds, rCount);
+}
+
+/*----------------------------------------------------------------------------
+Name         appendGotRequest
+
+Purpose      Appends the frame of a G/T request;
+
+Input        rJson              Whether to encode it as JSON;
+             rId                Id returned in the response;
+             rFrequencyMHz      Operating frequency of the antenna;
+             rBeamwidthDeg      Beamwidth of the antenna, in degrees;
+             rSolarFluxLow      Solar flux at the lower bracketing frequency;
+             rSolarFluxHigh     Solar flux at the higher bracketing frequency;
+             rHot               Measurements on the sun, in dB;
+             rCold              Measurements off the sun, in dB;
+
+Output       rOut               Buffer the frame is appended to;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void queryprotocol::appendGotRequest(QByteArray &rOut, const bool &rJson
+                                     , const quint32 &rId
+                                     , const double &rFrequencyMHz
+                                     , const double &rBeamwidthDeg
+                                     , const double &rSolarFluxLow
+                                     , const double &rSolarFluxHigh
+                                     , const std::vector<double> &rHot
+                                     , const std::vector<double> &rCold)
+{
+    const double* pHot = rHot.empty() ? 0 : &rHot[0];
+    const double* pCold = rCold.empty() ? 0 : &rCold[0];
+
+    if (rJson)
+    {
+        QJsonObject object;
+        object.insert("id", static_cast<double>(rId));
+        object.insert("op", QString("got"));
+        object.insert("frequency", rFrequencyMHz);
+        object.insert("beamwidth", rBeamwidthDeg);
+        object.insert("flux_low", rSolarFluxLow);
+        object.insert("flux_high", rSolarFluxHigh);
+        object.insert("hot", jsonArray(pHot, rHot.size()));
+        object.insert("cold", jsonArray(pCold, rCold.size()));
+        appendJson(rOut, object);
+        return;
+    }
+
+    GotRequestHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = GotRequest;
+    header.id = rId;
+    header.frequencyMHz = rFrequencyMHz;
+    header.beamwidthDeg = rBeamwidthDeg;
+    header.solarFluxLow = rSolarFluxLow;
+    header.solarFluxHigh = rSolarFluxHigh;
+    header.hotCount = static_cast<quint32>(rHot.size());
+    header.coldCount = static_cast<quint32>(rCold.size());
+
+    appendLength(rOut, sizeof(header)
+                 + (rHot.size() + rCold.size()) * sizeof(double));
+    rOut.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    appendDoubles(rOut, pHot, rHot.size());
+    appendDoubles(rOut, pCold, rCold.size());
+}
+
+/*----------------------------------------------------------------------------
+Name         appendSunResponse
+
+Purpose      Appends the frame answering a sun position request;
+
+Input        rRequest           The request answered;
+             pAzimuthDeg        Solar Azimuth of each instant, in degrees;
+             pAltitudeDeg       Solar Altitude of each instant, in degrees;
+             pZenithDeg         Solar Zenith of each instant, in degrees;
+             pHourAngleDeg      Hour Angle of each instant, in degrees;
+
+Output       rOut               Buffer the frame is appended to;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void queryprotocol::appendSunResponse(QByteArray &rOut
+                                      , const Request &rRequest
+                                      , const double *pAzimuthDeg
+                                      , const double *pAltitudeDeg
+                                      , const double *pZenithDeg
+                                      , const double *pHourAngleDeg)
+{
+    const size_t count = rRequest.utcSeconds.size();
+
+    if (rRequest.json)
+    {
+        QJsonObject object;
+        object.insert("id", static_cast<double>(rRequest.id));
+        object.insert("azimuth", jsonArray(pAzimuthDeg, count));
+        object.insert("altitude", jsonArray(pAltitudeDeg, count));
+        object.insert("zenith", jsonArray(pZenithDeg, count));
+        object.insert("hour_angle", jsonArray(pHourAngleDeg, count));
+        appendJson(rOut, object);
+        return;
+    }
+
+    SunResponseHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = SunResponse;
+    header.id = rRequest.id;
+    header.count = static_cast<quint32>(count);
+
+    appendLength(rOut, sizeof(header) + 4 * count * sizeof(double));
+    rOut.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    appendDoubles(rOut, pAzimuthDeg, count);
+    appendDoubles(rOut, pAltitudeDeg, count);
+    appendDoubles(rOut, pZenithDeg, count);
+    appendDoubles(rOut, pHourAngleDeg, count);
+}
+
+/*----------------------------------------------------------------------------
+Name         appendGotResponse
+
+Purpose      Appends the frame answering a G/T request;
+
+Input        rRequest           The request answered;
+             rGotDb             Gain Over Temperature in dB;
+             rGotRatio          Gain Over Temperature as a ratio;
+             rSolarFlux         Solar flux interpolated to the frequency;
+
+Output       rOut               Buffer the frame is appended to;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void queryprotocol::appendGotResponse(QByteArray &rOut
+                                      , const Request &rRequest
+                                      , const double &rGotDb
+                                      , const double &rGotRatio
+                                      , const double &rSolarFlux)
+{
+    if (rRequest.json)
+    {
+        QJsonObject object;
+        object.insert("id", static_cast<double>(rRequest.id));
+        object.insert("got_db", rGotDb);
+        object.insert("got_ratio", rGotRatio);
+        object.insert("solar_flux", rSolarFlux);
+        appendJson(rOut, object);
+        return;
+    }
+
+    GotResponseBody body;
+    memset(&body, 0, sizeof(body));
+    body.type = GotResponse;
+    body.id = rRequest.id;
+    body.gotDb = rGotDb;
+    body.gotRatio = rGotRatio;
+    body.solarFlux = rSolarFlux;
+
+    appendLength(rOut, sizeof(body));
+    rOut.append(reinterpret_cast<const char*>(&body), sizeof(body));
+}
+
+/*----------------------------------------------------------------------------
+Name         appendError
+
+Purpose      Appends the frame of an error answering a request;
+
+Input        rJson              Whether to encode it as JSON;
+             rId                Id of the request;
+             rMessage           What went wrong;
+
+Output       rOut               Buffer the frame is appended to;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void queryprotocol::appendError(QByteArray &rOut, const bool &rJson
+                                , const quint32 &rId
+                                , const QString &rMessage)
+{
+    if (rJson)
+    {
+        QJsonObject object;
+        object.insert("id", static_cast<double>(rId));
+        object.insert("error", rMessage);
+        appendJson(rOut, object);
+        return;
+    }
+
+    const QByteArray message = rMessage.toUtf8();
+
+    ErrorResponseHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = ErrorResponse;
+    header.id = rId;
+    header.length = static_cast<quint32>(message.size());
+
+    appendLength(rOut, sizeof(header) + message.size());
+    rOut.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    rOut.append(message);
+}
@@ -0,0 +1,127 @@
+/*----------------------------------------------------------------------------
+Name         queryprotocol.h
+
+Purpose      Messages passed between got-daemon and its clients over a Unix
+             socket: sun position and G/T requests and their responses, as
+             binary or as JSON;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef QUERYPROTOCOL_H
+#define QUERYPROTOCOL_H
+
+#include <QByteArray> // USES QByteArray for the encoded frames;
+#include <QString>
+#include <vector> // HASA std::vectors of instants and measurements;
+
+namespace queryprotocol
+{
+    // Largest payload of a frame, in bytes;
+    const quint32 max_payload_bytes = 16 * 1024 * 1024;
+
+    // Most instants of a sun position request, so that even the JSON
+    // answer fits in a frame;
+    const size_t max_instants = 100000;
+
+    // Bytes of the length before each payload;
+    const int length_bytes = sizeof(quint32);
+
+    // First byte of a binary payload.  A JSON payload starts with '{';
+    enum MessageType
+    {
+        SunRequest = 0x01,
+        GotRequest = 0x02,
+        SunResponse = 0x81,
+        GotResponse = 0x82,
+        ErrorResponse = 0xff
+    };
+
+    // A request, as decoded by the daemon;
+    struct Request
+    {
+        MessageType type; // SunRequest or GotRequest;
+        bool json; // Whether it came as JSON, and so is answered as JSON;
+        quint32 id; // Chosen by the client and returned in the response;
+
+        // SunRequest;
+        double latitude; // Latitude of the site, in degrees;
+        double longitude; // Longitude of the site, in degrees, east positive;
+        std::vector<double> utcSeconds; // Instants, seconds since 1970 UTC;
+
+        // GotRequest;
+        double frequencyMHz; // Operating frequency of the antenna;
+        double beamwidthDeg; // Beamwidth of the antenna, in degrees;
+        double solarFluxLow; // Solar flux at the lower bracketing frequency;
+        double solarFluxHigh; // Solar flux at the higher bracketing frequency;
+        std::vector<double> hot; // Measurements on the sun, in dB;
+        std::vector<double> cold; // Measurements off the sun, in dB;
+
+        Request(); // Constructor, of an empty SunRequest;
+    };
+
+    // A response, as decoded by a client;
+    struct Response
+    {
+        MessageType type; // SunResponse, GotResponse or ErrorResponse;
+        quint32 id; // Id of the request answered;
+
+        // SunResponse, one entry per instant of the request;
+        std::vector<double> azimuthDeg;
+        std::vector<double> altitudeDeg;
+        std::vector<double> zenithDeg;
+        std::vector<double> hourAngleDeg;
+
+        // GotResponse;
+        double gotDb; // Gain Over Temperature in dB;
+        double gotRatio; // Gain Over Temperature as a ratio;
+        double solarFlux; // Solar flux interpolated to the frequency;
+
+        QString error; // ErrorResponse;
+
+        Response(); // Constructor;
+    };
+
+    // Returns the length of the frame at the start of a buffer, or 0 if the
+    // buffer does not yet hold a whole frame;
+    int frameLength(const char* pData, const int& rSize, bool& rTooLarge);
+
+    // Decodes the payload of a request frame;
+    bool decodeRequest(const char* pPayload, const int& rSize
+                       , Request& rRequest, QString& rError);
+    // Decodes the payload of a response frame;
+    bool decodeResponse(const char* pPayload, const int& rSize
+                        , Response& rResponse, QString& rError);
+
+    // Appends the frame of a sun position request;
+    void appendSunRequest(QByteArray& rOut, const bool& rJson
+                          , const quint32& rId
+                          , const double& rLatitude
+                          , const double& rLongitude
+                          , const double* pUtcSeconds, const int& rCount);
+    // Appends the frame of a G/T request;
+    void appendGotRequest(QByteArray& rOut, const bool& rJson
+                          , const quint32& rId
+                          , const double& rFrequencyMHz
+                          , const double& rBeamwidthDeg
+                          , const double& rSolarFluxLow
+                          , const double& rSolarFluxHigh
+                          , const std::vector<double>& rHot
+                          , const std::vector<double>& rCold);
+
+    // Appends the frame answering a sun position request;
+    void appendSunResponse(QByteArray& rOut, const Request& rRequest
+                           , const double* pAzimuthDeg
+                           , const double* pAltitudeDeg
+                           , const double* pZenithDeg
+                           , const double* pHourAngleDeg);
+    // Appends the frame answering a G/T request;
+    void appendGotResponse(QByteArray& rOut, const Request& rRequest
+                           , const double& rGotDb
+                           , const double& rGotRatio
+                           , const double& rSolarFlux);
+    // Appends the frame of an error answering a request;
+    void appendError(QByteArray& rOut, const bool& rJson, const quint32& rId
+                     , const QString& rMessage);
+}
+
+#endif // QUERYPROTOCOL_H
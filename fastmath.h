@@ -0,0 +1,297 @@
+/*----------------------------------------------------------------------------
+Name         fastmath.h
+
+Purpose      Polynomial sine, cosine, arc cosine, and arc tangent kernels for
+             bulk solar position tables, and a dB to power ratio kernel for
+             bulk radiometer samples, each with a stated maximum error;
+
+Notes        Each kernel reduces its argument to a small interval and then
+             evaluates a near-minimax polynomial, fitted at the Chebyshev nodes
+             of that interval.  There are no table lookups and no branches,
+             only selects, so loops which call them can be vectorised (AVX2,
+             NEON) where the libm functions cannot;
+
+             The maximum errors below are absolute, against libm, over the
+             whole domain given for each function.  They are measured by the
+             math/ cases of got-bench, which sweep each domain, and are well
+             inside the 1e-7 rad (0.02") asked of the solar tables;
+
+             Arguments are rounded by adding and subtracting 1.5 * 2^52
+             rather than by calling floor(), which is a library call on SSE2
+             and would stop the loop from being vectorised.  This relies on
+             strict IEEE arithmetic, so these must not be built with
+             -ffast-math;
+
+             Infinities, NaN, and the sign of zero are not treated specially;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Added dbToPower;
+----------------------------------------------------------------------------*/
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+#include <cmath> // USES std::sqrt and std::fabs;
+#include <algorithm> // USES std::min and std::max;
+#include <cstring> // USES memcpy to build powers of two;
+#include <cstdint> // USES uint64_t;
+
+namespace fastmath
+{
+    // Largest errors of the kernels over their domains;
+    const double sin_cos_max_error = 2e-11;
+    const double acos_max_error = 1e-11;
+    const double atan2_max_error = 1e-11;
+    // Largest error of dbToPower, relative to the power ratio;
+    const double db_to_power_max_error = 2e-14;
+
+    // Largest magnitude, in dB, for which dbToPower is accurate.  It stays
+    // finite and non-zero out to +-3000 dB, and is clamped beyond;
+    const double db_to_power_max_argument = 300.0;
+
+    // Largest argument, in radians, for which sin and cos are accurate;
+    const double sin_cos_max_argument = 1e5;
+
+    const double pi = 3.14159265358979323846;
+    const double pi_2 = 1.57079632679489661923;
+    const double pi_4 = 0.78539816339744830962;
+    const double deg_to_rad = pi / 180.0;
+
+    namespace detail
+    {
+        // pi/2 split so that k * pi_2_high is exact for |k| < 2^20;
+        const double pi_2_high = 1.57079632673412561417e+00;
+        const double pi_2_low = 6.07710050650619224932e-11;
+
+        const double tan_pi_8 = 0.41421356237309504880;
+
+        // log2(10) / 10, the power of two of one dB;
+        const double log2_10_over_10 = 0.33219280948873623479;
+        // The clamp of dbToPower in powers of two, inside the exponent range;
+        const double max_power_of_two = 1000.0;
+
+        // Adding and subtracting this rounds to the nearest integer;
+        const double round_magic = 6755399441055744.0;
+
+        // Rounds x, |x| < 2^51, to the nearest integer;
+        inline double roundNearest(const double x)
+        {
+            return (x + round_magic) - round_magic;
+        }
+
+        // Returns an integer k modulo 4, from 0 to 3.  k / 4 - 3/8 rounds
+        // to the floor of k / 4 for every integer k;
+        inline double quadrantOf(const double k)
+        {
+            return k - 4.0 * roundNearest(k * 0.25 - 0.375);
+        }
+
+        // sin(r) on [-pi/4, pi/4];
+        inline double sinKernel(const double r)
+        {
+            const double z = r * r;
+            const double p = -1.66666666638552924e-01
+                    + z * (8.33333187471076327e-03
+                    + z * (-1.98400867355980060e-04
+                    + z * 2.72499258239475393e-06));
+            return r + r * z * p;
+        }
+
+        // cos(r) on [-pi/4, pi/4];
+        inline double cosKernel(const double r)
+        {
+            const double z = r * r;
+            const double p = 4.16666666643212003e-02
+                    + z * (-1.38888876720168761e-03
+                    + z * (2.48006003771206651e-05
+                    + z * -2.73009591971363705e-07));
+            return 1.0 - 0.5 * z + z * z * p;
+        }
+
+        // asin(s) on [0, 1/2], given z = s * s;
+        inline double asinKernel(const double s, const double z)
+        {
+            const double p = 1.66666666654950862e-01
+                    + z * (7.50000059882845044e-02
+                    + z * (4.46423584852705529e-02
+                    + z * (3.03976341223859518e-02
+                    + z * (2.21324437025522090e-02
+                    + z * (1.93062604838120030e-02
+                    + z * (5.44318602537527136e-03
+                    + z * 2.93052388440855661e-02))))));
+            return s + s * z * p;
+        }
+
+        // atan(t) on [-tan(pi/8), tan(pi/8)];
+        inline double atanKernel(const double t)
+        {
+            const double z = t * t;
+            const double p = -3.33333333314407232e-01
+                    + z * (1.99999989172862686e-01
+                    + z * (-1.42856125112567428e-01
+                    + z * (1.11074951329642346e-01
+                    + z * (-9.02898347334202822e-02
+                    + z * (7.13532499670508080e-02
+                    + z * -4.04322460157785432e-02)))));
+            return t + t * z * p;
+        }
+
+        // 2^f on [-1/2, 1/2], the Taylor series of exp(f ln 2) to f^13;
+        inline double exp2Kernel(const double f)
+        {
+            return 1.0
+                    + f * (6.93147180559945286e-01
+                    + f * (2.40226506959100722e-01
+                    + f * (5.55041086648215831e-02
+                    + f * (9.61812910762847688e-03
+                    + f * (1.33335581464284433e-03
+                    + f * (1.54035303933816088e-04
+                    + f * (1.52527338040598411e-05
+                    + f * (1.32154867901443095e-06
+                    + f * (1.01780860092396999e-07
+                    + f * (7.05491162080112336e-09
+                    + f * (4.44553827187081162e-10
+                    + f * (2.56784359934882055e-11
+                    + f * 1.36914888539041281e-12))))))))))));
+        }
+
+        // 2^k for an integer k in [-1022, 1023], built from its exponent
+        // bits.  Adding round_magic leaves k + 1023 in the low bits of the
+        // mantissa, and the shift moves them into the exponent;
+        inline double powerOfTwo(const double k)
+        {
+            const double biased = k + (1023.0 + round_magic);
+            uint64_t bits;
+            memcpy(&bits, &biased, sizeof(bits));
+            bits <<= 52;
+            double result;
+            memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+
+        // Sine and cosine from a reduced argument and its quadrant (0-3);
+        inline void sinCosQuadrant(const double r
+                                   , const double quadrant
+                                   , double& rSin
+                                   , double& rCos)
+        {
+            const double s = sinKernel(r);
+            const double c = cosKernel(r);
+            const bool odd = (quadrant == 1.0) | (quadrant == 3.0);
+
+            const double sinMagnitude = odd ? c : s;
+            const double cosMagnitude = odd ? s : c;
+
+            rSin = (quadrant >= 2.0) ? -sinMagnitude : sinMagnitude;
+            rCos = ((quadrant == 1.0) | (quadrant == 2.0)) ? -cosMagnitude
+                                                           : cosMagnitude;
+        }
+    }
+
+    // Sine and cosine of x, in radians, for |x| <= sin_cos_max_argument;
+    inline void sinCos(const double x, double& rSin, double& rCos)
+    {
+        const double k = detail::roundNearest(x * (1.0 / pi_2));
+        const double r = (x - k * detail::pi_2_high) - k * detail::pi_2_low;
+        const double quadrant = detail::quadrantOf(k);
+
+        detail::sinCosQuadrant(r, quadrant, rSin, rCos);
+    }
+
+    // Sine and cosine of an angle in degrees, |degrees| < 2^50.  The
+    // reduction to +-45 degrees is exact, so large arguments lose nothing;
+    inline void sinCosDeg(const double degrees, double& rSin, double& rCos)
+    {
+        const double k = detail::roundNearest(degrees * (1.0 / 90.0));
+        const double r = (degrees - k * 90.0) * deg_to_rad;
+        const double quadrant = detail::quadrantOf(k);
+
+        detail::sinCosQuadrant(r, quadrant, rSin, rCos);
+    }
+
+    // Sine of x, in radians;
+    inline double sin(const double x)
+    {
+        double s;
+        double c;
+        sinCos(x, s, c);
+        return s;
+    }
+
+    // Cosine of x, in radians;
+    inline double cos(const double x)
+    {
+        double s;
+        double c;
+        sinCos(x, s, c);
+        return c;
+    }
+
+    // Sine of an angle in degrees;
+    inline double sinDeg(const double degrees)
+    {
+        double s;
+        double c;
+        sinCosDeg(degrees, s, c);
+        return s;
+    }
+
+    // Cosine of an angle in degrees;
+    inline double cosDeg(const double degrees)
+    {
+        double s;
+        double c;
+        sinCosDeg(degrees, s, c);
+        return c;
+    }
+
+    // Arc cosine of x, in radians, for x in [-1, 1].  NaN outside of it;
+    inline double acos(const double x)
+    {
+        // Near +-1 use acos(a) = 2 asin(sqrt((1 - a) / 2)), which keeps the
+        // polynomial's argument within [0, 1/2];
+        const double a = std::fabs(x);
+        const bool nearOne = (a > 0.5);
+        const double z = nearOne ? 0.5 * (1.0 - a) : a * a;
+        const double s = nearOne ? std::sqrt(z) : a;
+        const double p = detail::asinKernel(s, z);
+        const double r = nearOne ? 2.0 * p : pi_2 - p;
+
+        return (x < 0) ? pi - r : r;
+    }
+
+    // Arc tangent of y / x, in radians, in the quadrant of (x, y).  Returns
+    // 0 for (0, 0);
+    inline double atan2(const double y, const double x)
+    {
+        const double ax = std::fabs(x);
+        const double ay = std::fabs(y);
+        const double high = std::max(ax, ay);
+        const double low = std::min(ax, ay);
+
+        // a is in [0, 1].  Above tan(pi/8) use atan(a) = pi/4 + atan(t),
+        // with t = (a - 1) / (a + 1) back within the kernel's interval;
+        const double a = (high > 0) ? low / high : 0.0;
+        const bool upper = (a > detail::tan_pi_8);
+        const double t = upper ? (a - 1.0) / (a + 1.0) : a;
+
+        double r = detail::atanKernel(t) + (upper ? pi_4 : 0.0);
+        r = (ay > ax) ? pi_2 - r : r;
+        r = (x < 0) ? pi - r : r;
+
+        return (y < 0) ? -r : r;
+    }
+
+    // Power ratio of a level in dB, 10^(db / 10), for |db| <=
+    // db_to_power_max_argument;
+    inline double dbToPower(const double db)
+    {
+        double t = db * detail::log2_10_over_10;
+        t = std::min(std::max(t, -detail::max_power_of_two)
+                     , detail::max_power_of_two);
+
+        const double k = detail::roundNearest(t);
+        return detail::exp2Kernel(t - k) * detail::powerOfTwo(k);
+    }
+}
+
+#endif // FASTMATH_H
@@ -0,0 +1,329 @@
+/*----------------------------------------------------------------------------
+Name         fluxspectrum.cpp
+
+Purpose      Model of the solar flux spectrum, fitted through the flux at
+             every available frequency, which may be evaluated at any
+             operating frequency;
+
+Notes        The quiet sun's flux follows a power law over spans of the
+             spectrum, so it is fitted in log10 frequency and log10 flux,
+             where it is close to straight.  The fit is a monotone cubic
+             (Hermite) spline: the slope at each frequency is the weighted
+             harmonic mean of the slopes either side (Fritsch and Butland),
+             or zero where the spectrum turns, so the fitted flux never
+             overshoots the observations between two frequencies.  Beyond the
+             lowest and highest frequencies the flux is extended as a power
+             law with the slope at that end;
+
+             The coefficients of each interval are worked out once, when the
+             fluxes are set.  A table of buckets, evenly spaced in log
+             frequency, gives the first interval of each bucket, so finding an
+             interval is a table lookup followed by at most a step or two;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "fluxspectrum.h"
+
+#include "gotcore.h" // USES the available frequencies;
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+/*----------------------------------------------------------------------------
+Name         FluxSpectrum
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+FluxSpectrum::FluxSpectrum()
+    : mLogLow(0)
+    , mLogHigh(0)
+    , mBucketScale(0)
+{
+    std::fill(mBuckets, mBuckets + bucket_count, 0);
+}
+
+/*----------------------------------------------------------------------------
+Name         setFluxes
+
+Purpose      Fits the spectrum through a set of fluxes;
+
+Input        pFrequenciesMHz    Frequency of each flux, in MHz;
+             pFluxes            The fluxes, in solar flux units;
+             rCount             Number of fluxes;
+
+Returns      true  -  If at least two fluxes, at different frequencies, were
+                      usable;
+             false -  If not, in which case the spectrum is left invalid;
+
+Notes        Fluxes which are not positive, or are NaN, are passed over, as
+             are frequencies which are not positive.  The frequencies need not
+             be in order.  Where a frequency is given more than once, the
+             first flux is used;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool FluxSpectrum::setFluxes(const double *pFrequenciesMHz
+                             , const double *pFluxes
+                             , const int &rCount)
+{
+    mSegments.clear();
+
+    // Gather the usable points, in log10, in order of frequency;
+    std::vector<std::pair<double, double> > points;
+    for (int i = 0; i < rCount; i++)
+    {
+        if (pFrequenciesMHz[i] > 0 && pFluxes[i] > 0)
+        {
+            points.push_back(std::make_pair(log10(pFrequenciesMHz[i])
+                                            , log10(pFluxes[i])));
+        }
+    }
+
+    std::stable_sort(points.begin(), points.end()
+                     , [](const std::pair<double, double>& rA
+                          , const std::pair<double, double>& rB)
+    {
+        return rA.first < rB.first;
+    });
+
+    points.erase(std::unique(points.begin(), points.end()
+                             , [](const std::pair<double, double>& rA
+                                  , const std::pair<double, double>& rB)
+    {
+        return rA.first == rB.first;
+    }), points.end());
+
+    const int n = static_cast<int>(points.size());
+    if (n < 2 || n > 256)
+    {
+        return false;
+    }
+
+    // Width and slope of each interval;
+    std::vector<double> width(n - 1);
+    std::vector<double> slope(n - 1);
+    for (int i = 0; i < n - 1; i++)
+    {
+        width[i] = points[i + 1].first - points[i].first;
+        slope[i] = (points[i + 1].second - points[i].second) / width[i];
+    }
+
+    // Slope at each point.  The ends take the slope of their interval;
+    std::vector<double> tangent(n);
+    tangent[0] = slope[0];
+    tangent[n - 1] = slope[n - 2];
+    for (int i = 1; i < n - 1; i++)
+    {
+        if (slope[i - 1] * slope[i] <= 0)
+        {
+            tangent[i] = 0;
+        }
+        else
+        {
+            const double w1 = 2 * width[i] + width[i - 1];
+            const double w2 = width[i] + 2 * width[i - 1];
+            tangent[i] = (w1 + w2) / (w1 / slope[i - 1] + w2 / slope[i]);
+        }
+    }
+
+    // Cubic of each interval, with the last point closing the table so that
+    // the slope past the highest frequency is at hand;
+    mSegments.resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        Segment& rSegment = mSegments[i];
+        rSegment.x0 = points[i].first;
+        rSegment.y0 = points[i].second;
+        rSegment.m = tangent[i];
+        rSegment.c2 = 0;
+        rSegment.c3 = 0;
+
+        if (i < n - 1)
+        {
+            const double h = width[i];
+            rSegment.c2 = (3 * slope[i] - 2 * tangent[i] - tangent[i + 1]) / h;
+            rSegment.c3 = (tangent[i] + tangent[i + 1] - 2 * slope[i])
+                    / (h * h);
+        }
+    }
+
+    // Table from bucket to the interval holding the bucket's start;
+    mLogLow = points.front().first;
+    mLogHigh = points.back().first;
+    mBucketScale = bucket_count / (mLogHigh - mLogLow);
+
+    int segment = 0;
+    for (int b = 0; b < bucket_count; b++)
+    {
+        const double start = mLogLow + b / mBucketScale;
+        while (segment < n - 2 && mSegments[segment + 1].x0 <= start)
+        {
+            segment++;
+        }
+        mBuckets[b] = static_cast<unsigned char>(segment);
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         setFluxes
+
+Purpose      Fits the spectrum through the flux at each of
+             constants::available_frequencies;
+
+Input        pFluxes            constants::number_of_available_frequencies
+                                fluxes, in the same order, NaN or zero where
+                                there was no observation;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool FluxSpectrum::setFluxes(const double *pFluxes)
+{
+    return setFluxes(constants::available_frequencies, pFluxes
+                     , constants::number_of_available_frequencies);
+}
+
+/*----------------------------------------------------------------------------
+Name         isValid
+
+Purpose      Returns whether or not a spectrum has been fitted;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool FluxSpectrum::isValid() const
+{
+    return !mSegments.empty();
+}
+
+/*----------------------------------------------------------------------------
+Name         evaluate
+
+Purpose      Returns the fitted flux at a frequency;
+
+Input        rFreqMHz           The frequency, in MHz;
+
+Returns      double             The flux, in solar flux units, or NaN if no
+                                spectrum has been fitted or the frequency is
+                                not positive and finite;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double FluxSpectrum::evaluate(const double &rFreqMHz) const
+{
+    if (mSegments.empty())
+    {
+        return NAN;
+    }
+
+    return pow(10.0, evaluateLog(log10(rFreqMHz)));
+}
+
+/*----------------------------------------------------------------------------
+Name         evaluate
+
+Purpose      Returns the fitted flux at each of an array of frequencies, such
+             as the channels of a wideband feed;
+
+Input        pFreqMHz           The frequencies, in MHz;
+             count              Number of frequencies;
+
+Output       pFlux              The flux at each frequency, in solar flux
+                                units, or NaN if no spectrum has been fitted
+                                or the frequency is not positive and finite;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void FluxSpectrum::evaluate(const double *pFreqMHz, double *pFlux
+                            , size_t count) const
+{
+    if (mSegments.empty())
+    {
+        std::fill(pFlux, pFlux + count, NAN);
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        pFlux[i] = pow(10.0, evaluateLog(log10(pFreqMHz[i])));
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         getLowestFrequency
+
+Purpose      Returns the lowest frequency fitted, in MHz, or zero if no
+             spectrum has been fitted;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double FluxSpectrum::getLowestFrequency() const
+{
+    return mSegments.empty() ? 0 : pow(10.0, mLogLow);
+}
+
+/*----------------------------------------------------------------------------
+Name         getHighestFrequency
+
+Purpose      Returns the highest frequency fitted, in MHz, or zero if no
+             spectrum has been fitted;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double FluxSpectrum::getHighestFrequency() const
+{
+    return mSegments.empty() ? 0 : pow(10.0, mLogHigh);
+}
+
+/*----------------------------------------------------------------------------
+Name         evaluateLog
+
+Purpose      Returns log10 of the flux at log10 of a frequency;
+
+Input        rLogFreq           log10 of the frequency in MHz;
+
+Returns      double             log10 of the flux, or NaN if the frequency
+                                was not positive and finite;
+
+Notes        A frequency which is negative or NaN has a NaN log, which the
+             range checks would pass on to index the buckets with;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Return NaN for a frequency with no finite log;
+----------------------------------------------------------------------------*/
+double FluxSpectrum::evaluateLog(const double &rLogFreq) const
+{
+    if (!std::isfinite(rLogFreq))
+    {
+        return NAN;
+    }
+
+    // Power law beyond either end;
+    if (rLogFreq <= mLogLow)
+    {
+        const Segment& rFirst = mSegments.front();
+        return rFirst.y0 + rFirst.m * (rLogFreq - rFirst.x0);
+    }
+
+    if (rLogFreq >= mLogHigh)
+    {
+        const Segment& rLast = mSegments.back();
+        return rLast.y0 + rLast.m * (rLogFreq - rLast.x0);
+    }
+
+    // Look up the bucket's first interval, then step to the right one;
+    const int bucket = std::min(bucket_count - 1, static_cast<int>(
+                                (rLogFreq - mLogLow) * mBucketScale));
+    int segment = mBuckets[bucket];
+    const int last = static_cast<int>(mSegments.size()) - 2;
+    while (segment < last && mSegments[segment + 1].x0 <= rLogFreq)
+    {
+        segment++;
+    }
+
+    const Segment& rSegment = mSegments[segment];
+    const double t = rLogFreq - rSegment.x0;
+    return rSegment.y0 + t * (rSegment.m + t * (rSegment.c2 + t * rSegment.c3));
+}
@@ -0,0 +1,65 @@
+/*----------------------------------------------------------------------------
+Name         fluxspectrum.h
+
+Purpose      Model of the solar flux spectrum, fitted through the flux at
+             every available frequency, which may be evaluated at any
+             operating frequency;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef FLUXSPECTRUM_H
+#define FLUXSPECTRUM_H
+
+#include <cstddef> // USES size_t;
+#include <vector> // HASA std::vector of spline coefficients;
+
+class FluxSpectrum
+{
+public:
+    FluxSpectrum(); // Constructor;
+
+    // Fits the spectrum through a set of fluxes;
+    bool setFluxes(const double* pFrequenciesMHz
+                   , const double* pFluxes
+                   , const int& rCount);
+    // Fits the spectrum through the flux at the available frequencies;
+    bool setFluxes(const double* pFluxes);
+
+    // Whether or not a spectrum has been fitted;
+    bool isValid(void) const;
+
+    // Returns the flux at a frequency;
+    double evaluate(const double& rFreqMHz) const;
+    // Returns the flux at each of an array of frequencies;
+    void evaluate(const double* pFreqMHz, double* pFlux, size_t count) const;
+
+    // Returns the lowest and highest frequency fitted;
+    double getLowestFrequency(void) const;
+    double getHighestFrequency(void) const;
+
+private:
+    // Number of buckets in the table from log frequency to interval;
+    static const int bucket_count = 64;
+
+    // Cubic for one interval, in log10 frequency and log10 flux, as
+    // y = y0 + t * (m + t * (c2 + t * c3)), t = x - x0;
+    struct Segment
+    {
+        double x0;
+        double y0;
+        double m;
+        double c2;
+        double c3;
+    };
+
+    std::vector<Segment> mSegments; // One per interval, then the last knot;
+    double mLogLow; // log10 of the lowest frequency;
+    double mLogHigh; // log10 of the highest frequency;
+    double mBucketScale; // Buckets per decade of frequency;
+    unsigned char mBuckets[bucket_count]; // First interval of each bucket;
+
+    // Returns log10 of the flux at log10 of a frequency;
+    double evaluateLog(const double& rLogFreq) const;
+};
+
+#endif // FLUXSPECTRUM_H
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui concurrent sql
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -12,21 +12,26 @@ TARGET = got
 TEMPLATE = app
 
 
+include(calc.pri)
+
 SOURCES += main.cpp\
         mainwindow.cpp \
-    solarcalc.cpp \
-    gotcalc.cpp \
     howto.cpp \
+    jobrunner.cpp \
     logfile.cpp \
+    logwriter.cpp \
     optionmenu.cpp \
+    sessioncatalog.cpp \
     about.cpp
 
 HEADERS  += mainwindow.h \
-    solarcalc.h \
-    gotcalc.h \
     howto.h \
+    jobrunner.h \
     logfile.h \
+    logwriter.h \
+    spscringbuffer.h \
     optionmenu.h \
+    sessioncatalog.h \
     about.h
 
 FORMS    += mainwindow.ui \
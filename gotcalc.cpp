@@ -7,8 +7,58 @@ Notes        This calculation is based largely on work done by Richard Flagg,
              call sign AH6NM;
 
 History		 7 Jul 16  AFB	Created
+             17 Oct 26  AFB The calculation is now done by gotcore, and
+                            GotCalc keeps the settings and measurements;
+             17 Oct 26  AFB Average the hot and cold levels as power ratios;
 ----------------------------------------------------------------------------*/
 #include "gotcalc.h"
+#include "solarfluxdatabase.h" // USES SolarFluxDatabase to look up fluxes;
+#include "radiometercapture.h" // USES RadiometerCaptureReader for samples;
+#include "powersamplefile.h" // USES PowerSampleFile for raw sample files;
+#include "metrics.h" // USES MetricsRegistry to count and time calculations;
+#include "sunscan.h" // USES SunScanFit for the measured beam;
+
+namespace
+{
+    // Metrics of GotCalc;
+    struct GotMetrics
+    {
+        GotMetrics()
+        {
+            MetricsRegistry& rRegistry = MetricsRegistry::instance();
+            calls = rRegistry.counter("got_gotcalc_calculations_total"
+                                      , "G/T ratios calculated");
+            nanResults = rRegistry.counter("got_nan_results_total"
+                                           , "Calculations with a NaN result"
+                                           , "calculator", "got");
+            frequencyRejections = rRegistry.counter(
+                        "got_frequency_rejections_total"
+                        , "Operating frequencies outside of the solar flux"
+                          " frequencies");
+            average = rRegistry.histogram("got_gotcalc_stage_seconds"
+                                          , "Time spent in each stage of a"
+                                            " G/T calculation"
+                                          , "stage", "average");
+            ratio = rRegistry.histogram("got_gotcalc_stage_seconds"
+                                        , "Time spent in each stage of a"
+                                          " G/T calculation"
+                                        , "stage", "ratio");
+        }
+
+        MetricsCounter calls; // G/T ratios calculated;
+        MetricsCounter nanResults; // Ratios which came out as NaN;
+        MetricsCounter frequencyRejections; // Frequencies out of range;
+        MetricsHistogram average; // Time spent averaging measurements;
+        MetricsHistogram ratio; // Time spent on the ratio itself;
+    };
+
+    // Returns the metrics, registering them on first use;
+    const GotMetrics& gotMetrics()
+    {
+        static const GotMetrics metrics;
+        return metrics;
+    }
+}
 
 GotCalc::GotCalc(QObject *parent) : QObject(parent)
 {
@@ -23,6 +73,7 @@ GotCalc::GotCalc(QObject *parent) : QObject(parent)
 
     mHotAverage = 0;
     mColdAverage = 0;
+    mAveragesFromSamples = false;
 
     mBeamwidth = 0;
     mBeamCorrectionFactor = 0;
@@ -58,52 +109,107 @@ Notes        The following variables are required for this calculation.  These
 History		 10 Jul 16  AFB	Created
              18 Jul 16  AFB Update equation, converting the Y value from dB to
                             a power ratio;
+             17 Oct 26  AFB Moved everything after the averages into
+                            calculateFromAverages;
+             17 Oct 26  AFB Time the averaging;
 ----------------------------------------------------------------------------*/
 void GotCalc::calculate()
 {
-    // Calculate the solar flux at a specific point given two frequencies
-    // (the next frequency above the operating frequency and the frequency
-    // directly beneath the operating frequency) and two solar flux values
-    // (corresponding to the aforementioned frequencies);
-    mSolarFluxPoint = linearInterpolation(mSolarFluxLow
-                                               , mSolarFluxHigh
-                                               , mLowerFreqMHz
-                                               , mHigherFreqMHz
-                                               , mOperatingFrequencyMHz);
-    // Conver the newly obtained Solar Flux value to Watts per Meters
-    // Squared per Hertz;
-    mSolarFluxPoint *= constants::W_M2_Hz;
-
-    // Get the wavelength at the operating frequency, in meters;
-    mWavelengthm = constants::speed_of_light / mOperatingFrequencyMHz;
-
     // Get the average of the hot and cold measurements;
-    mHotAverage = average(mHotMeasurements);
-    mColdAverage = average(mColdMeasurements);
+    {
+        MetricsTimer timer(gotMetrics().average);
+        mHotAverage = average(mHotMeasurements);
+        mColdAverage = average(mColdMeasurements);
+    }
+    mAveragesFromSamples = false;
+
+    calculateFromAverages();
+}
 
-    // Get the Sun Noise Rise;
-    double sunNoiseRise = pow(10.0, ((mHotAverage - mColdAverage)/10.0));
+/*----------------------------------------------------------------------------
+Name         calculateFromSamples
 
-    // Get the Beam Correction Factor;
-    mBeamCorrectionFactor = calculateBeamwidthCorrectionFactor();
+Purpose      Calculates the Gain Over Temperature from the running statistics
+             of the streamed hot and cold samples;
 
-    double wavelengthSquared = mWavelengthm * mWavelengthm;
+Notes        The frequencies, solar flux, and beamwidth must be set as for
+             calculate().  Only the running means are used, so this costs the
+             same no matter how many samples have been streamed, and may be
+             called after every block to follow the G/T as it builds up;
 
-    // Produce the numerator;
-    double numerator = ((sunNoiseRise - 1.0)
-                        * 8.0
-                        * M_PI
-                        * constants::boltzmann_constant
-                        * mBeamCorrectionFactor);
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Use the mean power of the samples;
+----------------------------------------------------------------------------*/
+void GotCalc::calculateFromSamples()
+{
+    mHotAverage = mHotSamples.getMeanDb();
+    mColdAverage = mColdSamples.getMeanDb();
+    mAveragesFromSamples = true;
 
-    // Produce the denominator;
-    double denominator = (mSolarFluxPoint * pow(mWavelengthm, 2.0));
+    calculateFromAverages();
+}
 
-    // Divide to get the Gain Over Temperature Value;
-    mGotPure = numerator / denominator;
+/*----------------------------------------------------------------------------
+Name         calculateFromAverages
 
-    // Convert into a decibel value;
-    mGotdB = 10 * log10(mGotPure);
+Purpose      Calculates the Gain Over Temperature once the hot and cold
+             averages are known;
+
+History		 10 Jul 16  AFB	Created as part of calculate
+             17 Oct 26  AFB Split out of calculate so that it is shared with
+                            calculateFromSamples;
+             17 Oct 26  AFB Use the fitted flux spectrum, if there is one;
+             17 Oct 26  AFB Count and time the calculation;
+             17 Oct 26  AFB The calculation itself is now gotcore::computeGot;
+----------------------------------------------------------------------------*/
+void GotCalc::calculateFromAverages()
+{
+    const GotMetrics& rMetrics = gotMetrics();
+    MetricsTimer timer(rMetrics.ratio);
+    rMetrics.calls.increment();
+
+    // The solar flux is interpolated between the frequencies either side of
+    // the operating frequency, unless a spectrum has been fitted through the
+    // flux at every frequency;
+    const gotcore::GotInputs inputs = getInputs();
+    const gotcore::GotResult result = mSolarFluxSpectrum.isValid()
+            ? gotcore::computeGotAtFlux(inputs, mSolarFluxSpectrum.evaluate(
+                                            mOperatingFrequencyMHz))
+            : gotcore::computeGot(inputs);
+
+    mSolarFluxPoint = result.solarFluxWm2Hz;
+    mBeamCorrectionFactor = result.beamCorrectionFactor;
+    mGotPure = result.gotRatio;
+    mGotdB = result.gotDb;
+
+    if (mGotdB != mGotdB)
+    {
+        rMetrics.nanResults.increment();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         getInputs
+
+Purpose      Returns the inputs of a calculation, from the settings and the
+             hot and cold averages;
+
+Returns      gotcore::GotInputs     The inputs;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+gotcore::GotInputs GotCalc::getInputs() const
+{
+    gotcore::GotInputs inputs;
+    inputs.operatingFrequencyMHz = mOperatingFrequencyMHz;
+    inputs.lowerFrequencyMHz = mLowerFreqMHz;
+    inputs.higherFrequencyMHz = mHigherFreqMHz;
+    inputs.solarFluxLowSfu = mSolarFluxLow;
+    inputs.solarFluxHighSfu = mSolarFluxHigh;
+    inputs.beamwidthDeg = mBeamwidth;
+    inputs.hotDb = mHotAverage;
+    inputs.coldDb = mColdAverage;
+    return inputs;
 }
 
 /*----------------------------------------------------------------------------
@@ -124,6 +230,41 @@ void GotCalc::getAvailableFrequencies(std::vector<double> &rFreq)
     }
 }
 
+/*----------------------------------------------------------------------------
+Name         findBracketingFrequencies
+
+Purpose      Finds the two frequencies, out of those for which solar flux data
+             is available, between which an operating frequency lies;
+
+Input        rFreq              The operating frequency, in MHz;
+
+Output       rLowerFreq         The next available frequency at or below rFreq;
+             rHigherFreq        The next available frequency above rFreq;
+
+Returns      true  -  If rFreq lies within the available frequencies;
+             false -  If rFreq is out of range, in which case the outputs are
+                      left untouched;
+
+Notes        An operating frequency equal to the highest available frequency
+             is bracketed by the top two available frequencies;
+
+History		 17 Oct 26  AFB	Created from MainWindow::setFrequencies
+             17 Oct 26  AFB Count rejected frequencies;
+             17 Oct 26  AFB Moved the search to gotcore;
+----------------------------------------------------------------------------*/
+bool GotCalc::findBracketingFrequencies(const double &rFreq
+                                        , double &rLowerFreq
+                                        , double &rHigherFreq)
+{
+    if (!gotcore::findBracketingFrequencies(rFreq, rLowerFreq, rHigherFreq))
+    {
+        gotMetrics().frequencyRejections.increment();
+        return false;
+    }
+
+    return true;
+}
+
 /*----------------------------------------------------------------------------
 Name         getInterpolatedSolarFlux
 
@@ -195,6 +336,73 @@ void GotCalc::setSolarFluxLow(const double &rFlux)
     mSolarFluxLow = rFlux;
 }
 
+/*----------------------------------------------------------------------------
+Name         setSolarFluxSpectrum
+
+Purpose      Uses a spectrum fitted through the flux at every available
+             frequency, rather than a straight line between the two
+             frequencies either side, for the solar flux at the operating
+             frequency;
+
+Input        rSpectrum       The fitted spectrum.  It is copied;
+
+Notes        Until clearSolarFluxSpectrum() is called, the two Solar Flux
+             values are not used;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void GotCalc::setSolarFluxSpectrum(const FluxSpectrum &rSpectrum)
+{
+    mSolarFluxSpectrum = rSpectrum;
+}
+
+/*----------------------------------------------------------------------------
+Name         clearSolarFluxSpectrum
+
+Purpose      Goes back to interpolating the solar flux between the two Solar
+             Flux values;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void GotCalc::clearSolarFluxSpectrum()
+{
+    mSolarFluxSpectrum = FluxSpectrum();
+}
+
+/*----------------------------------------------------------------------------
+Name         setSolarFluxFromDatabase
+
+Purpose      Sets the solar flux of both the lower and the higher frequency
+             from the fluxes observed on a day;
+
+Input        rDatabase       Database of observed fluxes;
+             rDate           The day of the measurements;
+
+Returns      true  -  If both fluxes were found;
+             false -  If either was not observed that day, in which case
+                      neither flux is changed;
+
+Notes        The lower and higher frequencies must have been set first;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool GotCalc::setSolarFluxFromDatabase(const SolarFluxDatabase &rDatabase
+                                       , const QDate &rDate)
+{
+    double lowFlux = 0;
+    double highFlux = 0;
+
+    if (!rDatabase.getFlux(rDate, mLowerFreqMHz, lowFlux)
+            || !rDatabase.getFlux(rDate, mHigherFreqMHz, highFlux))
+    {
+        return false;
+    }
+
+    mSolarFluxLow = lowFlux;
+    mSolarFluxHigh = highFlux;
+    return true;
+}
+
 /*----------------------------------------------------------------------------
 Name         setOperatingFrequency
 
@@ -243,6 +451,29 @@ void GotCalc::setBeamwidth(const double &rBeamwidth)
     mBeamwidth = rBeamwidth;
 }
 
+/*----------------------------------------------------------------------------
+Name         setFromSunScan
+
+Purpose      Sets the beamwidth, and the hot and cold measurements, from a
+             beam fitted to a raster scan of the sun, in place of typed in
+             values;
+
+Input        rFit               The fitted beam.  Its peak becomes the only
+                                hot measurement and its baseline the only
+                                cold one;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void GotCalc::setFromSunScan(const SunScanFit &rFit)
+{
+    mBeamwidth = rFit.beamwidthDeg;
+
+    mHotMeasurements.clear();
+    mColdMeasurements.clear();
+    mHotMeasurements.push_back(rFit.peakDb);
+    mColdMeasurements.push_back(rFit.baselineDb);
+}
+
 /*----------------------------------------------------------------------------
 Name         addHotMeasurment
 
@@ -295,123 +526,238 @@ void GotCalc::clearColdMeasurments()
     mColdMeasurements.clear();
 }
 
-double GotCalc::calculateBeamwidthCorrectionFactor()
-{
-    double radioSunDiameter = 0;
-    if (mBeamwidth >= 3)
-        return 1;
+/*----------------------------------------------------------------------------
+Name         addHotSamples
 
-    else
-    {
-        if (mOperatingFrequencyMHz > 400)
-        {
-            radioSunDiameter = 0.7;
-        }
+Purpose      Adds a block of streamed hot samples to the running statistics;
 
-        if (mOperatingFrequencyMHz > 1420)
-        {
-            radioSunDiameter = 0.6;
-        }
+Input        pSamples               Array of samples, in dB;
+             count                  Number of samples in pSamples;
 
-        if (mOperatingFrequencyMHz > 3000)
-        {
-            radioSunDiameter = 0.5;
-        }
+Notes        The samples themselves are not kept, so any number of blocks may
+             be streamed in.  These are separate from the measurements added
+             by addHotMeasurement and are used by calculateFromSamples;
 
-        return (1 + 0.38 * pow((radioSunDiameter / mBeamwidth), 2.0));
-    }
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Keep the statistics of their power;
+----------------------------------------------------------------------------*/
+void GotCalc::addHotSamples(const double *pSamples, size_t count)
+{
+    mHotSamples.addDb(pSamples, count);
 }
 
 /*----------------------------------------------------------------------------
-Name         linearInterpolation
+Name         addColdSamples
 
-Purpose      Performs a linear interpolation of the point xPoint given two
-             (x,y) coordinates on a Cartesian plane;
+Purpose      Adds a block of streamed cold samples to the running statistics;
 
-Inputs        y1           y value of the first coordinate;
-              y2           y value of the second coordinate;
-              x1           x value of the first coordinate;
-              x2           x value of the second coordinate;
-              xPoint       The x value for which a y value will be interpolated
+Input        pSamples               Array of samples, in dB;
+             count                  Number of samples in pSamples;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Keep the statistics of their power;
+----------------------------------------------------------------------------*/
+void GotCalc::addColdSamples(const double *pSamples, size_t count)
+{
+    mColdSamples.addDb(pSamples, count);
+}
 
-Returns       yResult      The y value which has been linearly
-                           interpolated from the x value xPoint;
+/*----------------------------------------------------------------------------
+Name         clearSamples
 
-Notes        Solves for a simple y = m(x) + b linear equation;
+Purpose      Forgets all streamed hot and cold samples;
 
-History		 10 Jul 16  AFB	Created
+History		 17 Oct 26  AFB	Created
 ----------------------------------------------------------------------------*/
-double GotCalc::linearInterpolation(double y1
-                                    , double y2
-                                    , double x1
-                                    , double x2
-                                    , double xPoint)
+void GotCalc::clearSamples()
 {
-    double  x = 0, b = 0, yResult = 0;
+    mHotSamples.clear();
+    mColdSamples.clear();
+}
 
-    x = (y2 - y1) / (x2 - x1);
-    b = (y1)  - (x1 * x);
-    yResult = xPoint * x + b;
+/*----------------------------------------------------------------------------
+Name         addSamplesFromCapture
+
+Purpose      Adds the hot and cold samples of a recorded sun transit to the
+             running statistics, read from a capture file by time range;
+
+Input        rCapture               An open capture of samples in dB;
+             rHotFrom               Start of the samples on the sun, us since
+                                    the epoch;
+             rHotTo                 End of the samples on the sun, not
+                                    included;
+             rColdFrom              Start of the samples off the sun;
+             rColdTo                End of the samples off the sun, not
+                                    included;
+
+Returns      bool                   true -  If both ranges were read;
+                                    false - If the capture is damaged;
+
+Notes        Only the chunks of the capture holding the two ranges are
+             decompressed.  The samples are added to any already streamed in,
+             for calculateFromSamples;
 
-    return yResult;
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool GotCalc::addSamplesFromCapture(const RadiometerCaptureReader &rCapture
+                                    , const qint64 &rHotFrom
+                                    , const qint64 &rHotTo
+                                    , const qint64 &rColdFrom
+                                    , const qint64 &rColdTo)
+{
+    return rCapture.read(rHotFrom, rHotTo, mHotSamples)
+            && rCapture.read(rColdFrom, rColdTo, mColdSamples);
 }
 
 /*----------------------------------------------------------------------------
-Name         exponentialInterpolation
+Name         addSamplesFromFiles
 
-Purpose      Performs an exponential interpolation of the point xPoint given
-             two (x,y) coordinates on a Cartesian plane;
+Purpose      Adds every sample of a raw hot and a raw cold sample file to the
+             running statistics;
 
-Inputs        y1           y value of the first coordinate;
-              y2           y value of the second coordinate;
-              x1           x value of the first coordinate;
-              x2           x value of the second coordinate;
-              xPoint       The x value for which a y value will be interpolated
+Input        rHot                   An open file of the samples on the sun;
+             rCold                  An open file of the samples off the sun;
+             pPool                  Pool to spread the work over, or null to
+                                    use the calling thread;
 
-Returns       yResult      The y value which has been exponentially
-                           interpolated from the x value xPoint;
+Notes        The files may be in dB or power ratios, as doubles or floats;
+             see PowerSampleFile.  The samples are added to any already
+             streamed in, for calculateFromSamples;
 
-Notes        Solves for a simple y = A * e ^ (kt) exponential equation;
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void GotCalc::addSamplesFromFiles(const PowerSampleFile &rHot
+                                  , const PowerSampleFile &rCold
+                                  , WorkStealingPool *pPool)
+{
+    rHot.readAll(mHotSamples, pPool);
+    rCold.readAll(mColdSamples, pPool);
+}
 
-History		 10 Jul 16  AFB	Created
+/*----------------------------------------------------------------------------
+Name         getHotStatistics
+
+Purpose      Returns the running statistics of the power of the streamed
+             hot samples;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Statistics of the power rather than of the dB;
 ----------------------------------------------------------------------------*/
-double GotCalc::exponentialInterpolation(double y1
-                                         , double y2
-                                         , double x1
-                                         , double x2
-                                         , double xPoint)
+const PowerStats& GotCalc::getHotStatistics() const
 {
-    double A = 0, k = 0, yResult = 0;
+    return mHotSamples;
+}
 
-    k = log(y2 / y1) / (x2 - x1);
-    A = y2 / exp(x2 * k);
+/*----------------------------------------------------------------------------
+Name         getColdStatistics
 
-    yResult = A * exp(xPoint * k);
+Purpose      Returns the running statistics of the power of the streamed
+             cold samples;
 
-    return yResult;
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Statistics of the power rather than of the dB;
+----------------------------------------------------------------------------*/
+const PowerStats& GotCalc::getColdStatistics() const
+{
+    return mColdSamples;
 }
 
 /*----------------------------------------------------------------------------
-Name         average
+Name         getUncertaintyInputs
 
-Purpose      Takes the average of a set of values;
+Purpose      Returns the inputs of the last calculation, with the uncertainty
+             of each, for GotUncertainty to estimate the uncertainty of the
+             G/T;
 
-Inputs       values             std::vector of doubles for which an average
-                                will be calculated;
+Input        rSolarFluxUncertainty      Fractional 1-sigma error of the solar
+                                        flux (0.1 for 10%);
+             rBeamwidthUncertaintyDeg   1-sigma error of the beamwidth;
 
-Returns      avg                The average of the std::vector values;
+Returns      GotUncertaintyInputs       The inputs.  The errors of the hot and
+                                        cold averages are the standard
+                                        errors of their mean power, in dB,
+                                        from whichever of the measurements
+                                        or the streamed samples the last
+                                        calculation used;
 
-History		 10 Jul 16  AFB	Created
+Notes        calculate() or calculateFromSamples() must have been called
+             first;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Errors of the mean power;
 ----------------------------------------------------------------------------*/
-double GotCalc::average(const std::vector<double>& values)
+GotUncertaintyInputs GotCalc::getUncertaintyInputs(
+        const double &rSolarFluxUncertainty
+        , const double &rBeamwidthUncertaintyDeg)
 {
-    double avg = 0;
-
-    for(size_t i = 0; i < values.size(); i++)
+    GotUncertaintyInputs inputs;
+    inputs.operatingFrequencyMHz = mOperatingFrequencyMHz;
+    inputs.solarFluxSfu = mSolarFluxPoint / constants::W_M2_Hz;
+    inputs.solarFluxUncertainty = rSolarFluxUncertainty;
+    inputs.beamwidthDeg = mBeamwidth;
+    inputs.beamwidthUncertaintyDeg = rBeamwidthUncertaintyDeg;
+    inputs.hotMeanDb = mHotAverage;
+    inputs.coldMeanDb = mColdAverage;
+
+    if (mAveragesFromSamples)
     {
-        avg += values.at(i);
+        inputs.hotStandardErrorDb = mHotSamples.getStandardErrorDb();
+        inputs.coldStandardErrorDb = mColdSamples.getStandardErrorDb();
     }
+    else
+    {
+        PowerStats hot;
+        PowerStats cold;
+        hot.addDb(mHotMeasurements.data(), mHotMeasurements.size());
+        cold.addDb(mColdMeasurements.data(), mColdMeasurements.size());
+        inputs.hotStandardErrorDb = hot.getStandardErrorDb();
+        inputs.coldStandardErrorDb = cold.getStandardErrorDb();
+    }
+
+    return inputs;
+}
 
-    return (avg /= values.size());
+/*----------------------------------------------------------------------------
+Name         getRadioSunDiameter
+
+Purpose      Returns the apparent diameter of the radio sun, which grows
+             towards lower frequencies;
+
+Input        rFreqMHz           The frequency, in MHz;
+
+Returns      double             The diameter, in degrees;
+
+History		 7 Jul 16  AFB	Created as part of
+                            calculateBeamwidthCorrectionFactor
+             17 Oct 26  AFB Split out so that it is shared with
+                            GotUncertainty;
+             17 Oct 26  AFB Moved to gotcore;
+----------------------------------------------------------------------------*/
+double GotCalc::getRadioSunDiameter(const double &rFreqMHz)
+{
+    return gotcore::radioSunDiameter(rFreqMHz);
 }
 
+/*----------------------------------------------------------------------------
+Name         average
+
+Purpose      Takes the average of a set of levels in dB;
+
+Inputs       values             std::vector of levels, in dB, for which an
+                                average will be calculated;
+
+Returns      avg                The mean power of the levels, in dB;
+
+Notes        The levels are averaged as power ratios.  Averaging the dB
+             values themselves falls short by about half their variance,
+             which biased the Y-factor of noisy measurements;
+
+History		 10 Jul 16  AFB	Created
+             17 Oct 26  AFB Moved the sum to gotcore::mean;
+             17 Oct 26  AFB Average as power ratios, with
+                            gotcore::meanPowerDb;
+----------------------------------------------------------------------------*/
+double GotCalc::average(const std::vector<double>& values)
+{
+    return gotcore::meanPowerDb(values.data(), values.size());
+}
@@ -4,6 +4,8 @@ Name         gotcalc.h
 Purpose      Calculate Gain Over Temperature;
 
 History		 7 Jul 16  AFB	Created
+             17 Oct 26  AFB Moved the constants and calculation to gotcore;
+             17 Oct 26  AFB Average as power ratios, and read sample files;
 ----------------------------------------------------------------------------*/
 #ifndef GOTCALC_H
 #define GOTCALC_H
@@ -11,26 +13,17 @@ History		 7 Jul 16  AFB	Created
 #include <QObject> // ISA QObject
 #include <cmath> // USES many math functions;
 #include <QDebug>
-
-// Necessary constants;
-namespace constants
-{
-    const double boltzmann_constant = 1.3806503e-23;
-
-    // Speed of light in megameters per second;
-    const double speed_of_light = 299.792458;
-
-    // Conversion factor from Solar Units to Watts per Meter Squared per Hertz;
-    const double W_M2_Hz = 10e-23;
-
-    // Number of frequencies which are available for Solar Flux Data;
-    const int number_of_available_frequencies = 9;
-
-    // Frequencies for which Solar Flux Data might be provided;
-    const double available_frequencies[number_of_available_frequencies]
-        = {245, 410, 610, 1415, 2695, 2800, 4995, 8800, 15400};
-
-}
+#include "powerstats.h" // HASA PowerStats for streamed samples;
+#include "gotuncertainty.h" // USES GotUncertaintyInputs;
+#include "fluxspectrum.h" // HASA FluxSpectrum for multi-point flux;
+#include "gotcore.h" // USES gotcore to calculate, and its constants;
+
+class SolarFluxDatabase;
+class RadiometerCaptureReader;
+class PowerSampleFile;
+class WorkStealingPool;
+struct SunScanFit;
+class QDate;
 
 class GotCalc : public QObject
 {
@@ -42,9 +35,17 @@ public:
     ~GotCalc(){} // Destructor;
 
     void calculate(); // Calculates the G Over T value;
+    // Calculates the G Over T value from the streamed samples;
+    void calculateFromSamples(void);
 
     // Returns frequencies for which Solar Flux can be gathered;
     void getAvailableFrequencies(std::vector<double>& rFreq);
+    // Finds the available frequencies either side of an operating frequency;
+    static bool findBracketingFrequencies(const double& rFreq
+                                          , double& rLowerFreq
+                                          , double& rHigherFreq);
+    // Returns the apparent diameter of the radio sun at a frequency;
+    static double getRadioSunDiameter(const double& rFreqMHz);
     // Returns the interpolated Solar Flux value;
     double getInterpolatedSolarFlux(void);
     // Returns Gain Over Temperature as a pure ratio;
@@ -56,6 +57,13 @@ public:
     void setSolarFluxHigh(const double& rFlux);
     // Sets the Solar Flux of the lower frequency;
     void setSolarFluxLow(const double& rFlux);
+    // Uses a fitted spectrum for the Solar Flux, in place of the two values;
+    void setSolarFluxSpectrum(const FluxSpectrum& rSpectrum);
+    // Goes back to interpolating between the two Solar Flux values;
+    void clearSolarFluxSpectrum(void);
+    // Sets both Solar Flux values from the database, for a day;
+    bool setSolarFluxFromDatabase(const SolarFluxDatabase& rDatabase
+                                  , const QDate& rDate);
 
     // Sets the frequency at which the antenna is operating;
     void setOperatingFrequency(const double& rFreq);
@@ -66,6 +74,8 @@ public:
 
     // Sets the beamwidth of the antenna;
     void setBeamwidth(const double& rBeamwidth);
+    // Sets the beamwidth and the hot and cold levels from a sun scan;
+    void setFromSunScan(const SunScanFit& rFit);
 
     // Adds a hot measurement to the mHotMeasurements vector;
     void addHotMeasurement(const double& rMeasurement);
@@ -77,25 +87,59 @@ public:
     // Clears the mColdMeasurements vector;
     void clearColdMeasurments(void);
 
+    // Adds a block of streamed hot samples to the running statistics;
+    void addHotSamples(const double* pSamples, size_t count);
+    // Adds a block of streamed cold samples to the running statistics;
+    void addColdSamples(const double* pSamples, size_t count);
+    // Forgets all streamed samples;
+    void clearSamples(void);
+    // Adds the hot and cold samples of a capture file, by time range;
+    bool addSamplesFromCapture(const RadiometerCaptureReader& rCapture
+                               , const qint64& rHotFrom
+                               , const qint64& rHotTo
+                               , const qint64& rColdFrom
+                               , const qint64& rColdTo);
+    // Adds every sample of a raw hot and a raw cold sample file;
+    void addSamplesFromFiles(const PowerSampleFile& rHot
+                             , const PowerSampleFile& rCold
+                             , WorkStealingPool* pPool = 0);
+
+    // Returns the running statistics of the streamed hot samples' power;
+    const PowerStats& getHotStatistics(void) const;
+    // Returns the running statistics of the streamed cold samples' power;
+    const PowerStats& getColdStatistics(void) const;
+
+    // Returns the inputs of the last calculation, with their uncertainties,
+    // for a Monte Carlo estimate of the G/T uncertainty;
+    GotUncertaintyInputs getUncertaintyInputs(
+            const double& rSolarFluxUncertainty
+            , const double& rBeamwidthUncertaintyDeg);
+
 private:
     double mSolarFluxPoint; // Interpolated solar flux value;
     double mSolarFluxHigh; // Solar flux of the higher frequency;
     double mSolarFluxLow; // Solar flux of the lower frequency;
+    FluxSpectrum mSolarFluxSpectrum; // Fitted spectrum, used if valid;
 
     double mOperatingFrequencyMHz; // The frequency at which the antenna works;
     double mHigherFreqMHz; // Higher frequency used in interpolation;
     double mLowerFreqMHz; // Lower frequency used in interpolation;
-    double mWavelengthm; // Wavelength of frequency in meters;
 
     // Vector of the hot measurements entered by the user, in dB;
     std::vector<double> mHotMeasurements;
     // Vector of the cold measurements entered by the user, in dB;
     std::vector<double> mColdMeasurements;
 
+    // Running statistics of the power of the streamed hot and cold samples;
+    PowerStats mHotSamples;
+    PowerStats mColdSamples;
+
     // Average of the measurements taken while pointing at the sun;
     double mHotAverage;
     // Average of the measureents taken while pointing away from the sun;
     double mColdAverage;
+    // Whether the averages came from the streamed samples or the vectors;
+    bool mAveragesFromSamples;
 
     // Beamwidth of the antenna;
     double mBeamwidth;
@@ -108,26 +152,13 @@ private:
     // Gain Over Temperature in dB, the value which will be returned;
     double mGotdB;
 
-    // Calculates the beamwidth correction factor;
-    double calculateBeamwidthCorrectionFactor();
-
-    // Allows for linear interpolation of a solar flux value given two
-    // (x, y) coordinates and the x value for which the y will be interpolated;
-    double linearInterpolation(double y1
-                               , double y2
-                               , double x1
-                               , double x2
-                               , double xPoint);
-
-    // Allows for exponential interpolation of a solar flux value given two
-    // (x, y) coordinates and the x value for which the y will be interpolated;
-    double exponentialInterpolation(double y1
-                                    , double y2
-                                    , double x1
-                                    , double x2
-                                    , double xPoint);
-
-    // Returns an average value given a vector of doubles;
+    // Calculates the G Over T value once the averages are known;
+    void calculateFromAverages(void);
+
+    // Returns the inputs of a calculation from the settings and averages;
+    gotcore::GotInputs getInputs(void) const;
+
+    // Returns the mean power, in dB, of a vector of levels in dB;
     double average(const std::vector<double>& values);
 };
 
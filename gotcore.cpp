@@ -0,0 +1,426 @@
+/*----------------------------------------------------------------------------
+Name         gotcore.cpp
+
+Purpose      Plain value types and pure functions for the Gain Over
+             Temperature and the position of the sun;
+
+Notes        The G/T calculation is based largely on work done by Richard
+             Flagg, call sign AH6NM, as GotCalc's always was.  GotCalc now
+             keeps the measurements and settings, and hands them to these
+             functions to calculate;
+
+             Nothing here counts or times itself, as the metrics registry
+             needs Qt.  The Qt classes wrapping these do that;
+
+History		 17 Oct 26  AFB	Created from GotCalc
+             17 Oct 26  AFB Removed mean, which meanPowerDb replaced;
+----------------------------------------------------------------------------*/
+#include "gotcore.h"
+
+#include "powerstats.h" // USES PowerStats to average power levels;
+#include <cmath> // USES pow, log10, log and exp;
+#include <type_traits> // USES std::is_trivially_copyable;
+
+static_assert(std::is_trivially_copyable<gotcore::Site>::value
+              && std::is_trivially_copyable<gotcore::Epoch>::value
+              && std::is_trivially_copyable<gotcore::GotInputs>::value
+              && std::is_trivially_copyable<gotcore::GotResult>::value
+              && std::is_trivially_copyable<SunPosition>::value
+              , "gotcore value types must be trivially copyable");
+
+/*----------------------------------------------------------------------------
+Name         epochFromNanoseconds
+
+Purpose      Returns the instant of a count of nanoseconds, as kept by capture
+             files and clocks;
+
+Input        rNanoseconds       Nanoseconds since 1 Jan 1970 UTC;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+gotcore::Epoch gotcore::epochFromNanoseconds(const long long &rNanoseconds)
+{
+    Epoch epoch;
+    epoch.utcSeconds = solarmath::secondsFromNanoseconds(rNanoseconds);
+    return epoch;
+}
+
+/*----------------------------------------------------------------------------
+Name         sunPosition
+
+Purpose      Returns the position of the sun at a site and instant;
+
+Input        rSite              The site;
+             rEpoch             The instant;
+
+Returns      SunPosition        The position, as SolarCalc::calculate gives
+                                it for the same instant set with setUtc;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SunPosition gotcore::sunPosition(const Site &rSite, const Epoch &rEpoch)
+{
+    return solarmath::positionUtc(rSite.latitudeDeg, rSite.longitudeDeg
+                                  , rEpoch.utcSeconds);
+}
+
+/*----------------------------------------------------------------------------
+Name         sunPositions
+
+Purpose      Calculates the position of the sun at a site for an array of
+             instants;
+
+Input        rSite              The site;
+             pEpochs            Array of instants, in any order;
+             count              Number of entries in pEpochs and pPositions;
+             rBackend           Trigonometric functions to use;
+
+Output       pPositions         Position of the sun at each instant;
+
+Notes        The instants are worked out a block at a time into columns on
+             the stack, with solarmath::positionsUtc, so the loops are those
+             of the batch calculation and nothing is allocated;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void gotcore::sunPositions(const Site &rSite
+                           , const Epoch *pEpochs
+                           , size_t count
+                           , SunPosition *pPositions
+                           , const SolarMathBackend &rBackend)
+{
+    const size_t blockSize = 256;
+    double utcSeconds[blockSize];
+    double azimuth[blockSize];
+    double altitude[blockSize];
+    double zenith[blockSize];
+    double hourAngle[blockSize];
+
+    for (size_t start = 0; start < count; start += blockSize)
+    {
+        const size_t n = (count - start < blockSize) ? count - start
+                                                     : blockSize;
+        for (size_t i = 0; i < n; i++)
+        {
+            utcSeconds[i] = pEpochs[start + i].utcSeconds;
+        }
+
+        solarmath::positionsUtc(rSite.latitudeDeg, rSite.longitudeDeg
+                                , utcSeconds, n, azimuth, altitude, zenith
+                                , hourAngle, rBackend);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            SunPosition& rPosition = pPositions[start + i];
+            rPosition.azimuthDeg = azimuth[i];
+            rPosition.altitudeDeg = altitude[i];
+            rPosition.zenithDeg = zenith[i];
+            rPosition.hourAngleDeg = hourAngle[i];
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         findBracketingFrequencies
+
+Purpose      Finds the two frequencies, out of those for which solar flux data
+             is available, between which an operating frequency lies;
+
+Input        rFreqMHz           The operating frequency, in MHz;
+
+Output       rLowerFreqMHz      The next available frequency at or below
+                                rFreqMHz;
+             rHigherFreqMHz     The next available frequency above rFreqMHz;
+
+Returns      true  -  If rFreqMHz lies within the available frequencies;
+             false -  If rFreqMHz is out of range, in which case the outputs
+                      are left untouched;
+
+Notes        An operating frequency equal to the highest available frequency
+             is bracketed by the top two available frequencies;
+
+History		 17 Oct 26  AFB	Created from GotCalc::findBracketingFrequencies
+----------------------------------------------------------------------------*/
+bool gotcore::findBracketingFrequencies(const double &rFreqMHz
+                                        , double &rLowerFreqMHz
+                                        , double &rHigherFreqMHz)
+{
+    const int last = constants::number_of_available_frequencies - 1;
+
+    if (rFreqMHz < constants::available_frequencies[0]
+            || rFreqMHz > constants::available_frequencies[last])
+    {
+        return false;
+    }
+
+    // The available frequencies are in ascending order, so the first one
+    // above the operating frequency is the upper bound and the one before it
+    // is the lower bound;
+    for (int i = 1; i < last; i++)
+    {
+        if (rFreqMHz < constants::available_frequencies[i])
+        {
+            rLowerFreqMHz = constants::available_frequencies[i - 1];
+            rHigherFreqMHz = constants::available_frequencies[i];
+            return true;
+        }
+    }
+
+    rLowerFreqMHz = constants::available_frequencies[last - 1];
+    rHigherFreqMHz = constants::available_frequencies[last];
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         radioSunDiameter
+
+Purpose      Returns the apparent diameter of the radio sun, which grows
+             towards lower frequencies;
+
+Input        rFreqMHz           The frequency, in MHz;
+
+Returns      double             The diameter, in degrees;
+
+History		 17 Oct 26  AFB	Created from GotCalc::getRadioSunDiameter
+----------------------------------------------------------------------------*/
+double gotcore::radioSunDiameter(const double &rFreqMHz)
+{
+    double diameter = 0;
+
+    if (rFreqMHz > 400)
+    {
+        diameter = 0.7;
+    }
+
+    if (rFreqMHz > 1420)
+    {
+        diameter = 0.6;
+    }
+
+    if (rFreqMHz > 3000)
+    {
+        diameter = 0.5;
+    }
+
+    return diameter;
+}
+
+/*----------------------------------------------------------------------------
+Name         beamCorrectionFactor
+
+Purpose      Returns the correction for a beam which is not much wider than
+             the radio sun, and so does not take in all of its flux;
+
+Input        rBeamwidthDeg      Beamwidth of the antenna, in degrees;
+             rFreqMHz           The operating frequency, in MHz;
+
+Returns      double             The factor, 1 for beams of 3 degrees or more;
+
+History		 17 Oct 26  AFB	Created from
+                            GotCalc::calculateBeamwidthCorrectionFactor
+----------------------------------------------------------------------------*/
+double gotcore::beamCorrectionFactor(const double &rBeamwidthDeg
+                                     , const double &rFreqMHz)
+{
+    if (rBeamwidthDeg >= 3)
+    {
+        return 1;
+    }
+
+    const double diameter = radioSunDiameter(rFreqMHz);
+    return (1 + 0.38 * pow((diameter / rBeamwidthDeg), 2.0));
+}
+
+/*----------------------------------------------------------------------------
+Name         linearInterpolation
+
+Purpose      Performs a linear interpolation of the point rXPoint given two
+             (x,y) coordinates on a Cartesian plane;
+
+Input        rY1, rX1           The first coordinate;
+             rY2, rX2           The second coordinate;
+             rXPoint            The x value for which a y value will be
+                                interpolated;
+
+Returns      double             The interpolated y value;
+
+Notes        Solves for a simple y = m(x) + b linear equation;
+
+History		 17 Oct 26  AFB	Created from GotCalc::linearInterpolation
+----------------------------------------------------------------------------*/
+double gotcore::linearInterpolation(const double &rY1, const double &rY2
+                                    , const double &rX1, const double &rX2
+                                    , const double &rXPoint)
+{
+    const double m = (rY2 - rY1) / (rX2 - rX1);
+    const double b = rY1 - (rX1 * m);
+
+    return rXPoint * m + b;
+}
+
+/*----------------------------------------------------------------------------
+Name         exponentialInterpolation
+
+Purpose      Performs an exponential interpolation of the point rXPoint given
+             two (x,y) coordinates on a Cartesian plane;
+
+Input        rY1, rX1           The first coordinate;
+             rY2, rX2           The second coordinate;
+             rXPoint            The x value for which a y value will be
+                                interpolated;
+
+Returns      double             The interpolated y value;
+
+Notes        Solves for a simple y = A * e ^ (kt) exponential equation;
+
+History		 17 Oct 26  AFB	Created from GotCalc::exponentialInterpolation
+----------------------------------------------------------------------------*/
+double gotcore::exponentialInterpolation(const double &rY1, const double &rY2
+                                         , const double &rX1, const double &rX2
+                                         , const double &rXPoint)
+{
+    const double k = log(rY2 / rY1) / (rX2 - rX1);
+    const double A = rY2 / exp(rX2 * k);
+
+    return A * exp(rXPoint * k);
+}
+
+/*----------------------------------------------------------------------------
+Name         meanPowerDb
+
+Purpose      Returns the mean power of an array of levels in dB, averaged as
+             power ratios and converted back to dB;
+
+Input        pLevelsDb          The levels, in dB;
+             count              Number of entries in pLevelsDb;
+
+Returns      double             The mean power, in dB, or NaN if count is 0;
+
+Notes        This is the average the Y-factor needs.  The mean of the levels
+             themselves falls short of it by about half their variance, so
+             on noisy measurements it biases the G/T low;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double gotcore::meanPowerDb(const double *pLevelsDb, size_t count)
+{
+    PowerStats power;
+    power.addDb(pLevelsDb, count);
+    return power.getMeanDb();
+}
+
+/*----------------------------------------------------------------------------
+Name         interpolatedSolarFlux
+
+Purpose      Returns the solar flux at the operating frequency, interpolated
+             between the fluxes at the lower and higher frequencies;
+
+Input        rInputs            The inputs;
+
+Returns      double             The solar flux, in sfu;
+
+History		 17 Oct 26  AFB	Created from GotCalc::calculateFromAverages
+----------------------------------------------------------------------------*/
+double gotcore::interpolatedSolarFlux(const GotInputs &rInputs)
+{
+    return linearInterpolation(rInputs.solarFluxLowSfu
+                               , rInputs.solarFluxHighSfu
+                               , rInputs.lowerFrequencyMHz
+                               , rInputs.higherFrequencyMHz
+                               , rInputs.operatingFrequencyMHz);
+}
+
+/*----------------------------------------------------------------------------
+Name         computeGot
+
+Purpose      Calculates the Gain Over Temperature, interpolating the solar
+             flux between the lower and higher frequencies;
+
+Input        rInputs            The inputs;
+
+Returns      GotResult          The result;
+
+History		 17 Oct 26  AFB	Created from GotCalc::calculateFromAverages
+----------------------------------------------------------------------------*/
+gotcore::GotResult gotcore::computeGot(const GotInputs &rInputs)
+{
+    return computeGotAtFlux(rInputs, interpolatedSolarFlux(rInputs));
+}
+
+/*----------------------------------------------------------------------------
+Name         computeGotAtFlux
+
+Purpose      Calculates the Gain Over Temperature given the solar flux at the
+             operating frequency, as from a fitted FluxSpectrum;
+
+Input        rInputs            The inputs.  The flux and frequencies either
+                                side are not used;
+             rSolarFluxSfu      Solar flux at the operating frequency, in sfu;
+
+Returns      GotResult          The result;
+
+Notes        G/T = (Y - 1) * 8 * pi * k * L / (S * lambda^2), where Y is the
+             sun noise rise as a power ratio, L the beam correction factor, S
+             the solar flux, and lambda the wavelength;
+
+History		 10 Jul 16  AFB	Created as GotCalc::calculate
+             18 Jul 16  AFB Update equation, converting the Y value from dB to
+                            a power ratio;
+             17 Oct 26  AFB Moved here from GotCalc::calculateFromAverages;
+----------------------------------------------------------------------------*/
+gotcore::GotResult gotcore::computeGotAtFlux(const GotInputs &rInputs
+                                             , const double &rSolarFluxSfu)
+{
+    GotResult result;
+
+    // Convert the Solar Flux value to Watts per Meters Squared per Hertz;
+    result.solarFluxWm2Hz = rSolarFluxSfu * constants::W_M2_Hz;
+
+    // Get the wavelength at the operating frequency, in meters;
+    const double wavelength = constants::speed_of_light
+            / rInputs.operatingFrequencyMHz;
+
+    // Get the Sun Noise Rise;
+    const double sunNoiseRise = pow(10.0
+                                    , ((rInputs.hotDb - rInputs.coldDb)
+                                       / 10.0));
+
+    result.beamCorrectionFactor = beamCorrectionFactor(
+                rInputs.beamwidthDeg, rInputs.operatingFrequencyMHz);
+
+    const double numerator = ((sunNoiseRise - 1.0)
+                              * 8.0
+                              * M_PI
+                              * constants::boltzmann_constant
+                              * result.beamCorrectionFactor);
+    const double denominator = (result.solarFluxWm2Hz
+                                * pow(wavelength, 2.0));
+
+    result.gotRatio = numerator / denominator;
+    result.gotDb = 10 * log10(result.gotRatio);
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------
+Name         computeGot
+
+Purpose      Calculates the Gain Over Temperature of each of an array of
+             inputs;
+
+Input        pInputs            The inputs;
+             count              Number of entries in pInputs and pResults;
+
+Output       pResults           The result for each entry of pInputs;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void gotcore::computeGot(const GotInputs *pInputs
+                         , size_t count
+                         , GotResult *pResults)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        pResults[i] = computeGot(pInputs[i]);
+    }
+}
@@ -0,0 +1,129 @@
+/*----------------------------------------------------------------------------
+Name         gotcore.h
+
+Purpose      Plain value types and pure functions for the Gain Over
+             Temperature and the position of the sun.  These hold the
+             mathematics behind GotCalc and SolarCalc in a form which keeps no
+             state and needs no Qt, for services which embed the calculation
+             or call it through the C interface of gotcore_c.h;
+
+Notes        Every type here is trivially copyable, so may be kept in arrays
+             of any size and copied with memcpy, and every function depends
+             only on its arguments, so any number of threads may call them at
+             once without locking;
+
+History		 17 Oct 26  AFB	Created from GotCalc
+             17 Oct 26  AFB Removed mean, which meanPowerDb replaced;
+----------------------------------------------------------------------------*/
+#ifndef GOTCORE_H
+#define GOTCORE_H
+
+#include <cstddef> // USES size_t;
+#include "solarmath.h" // USES SunPosition and SolarMathBackend;
+
+// Necessary constants;
+namespace constants
+{
+    const double boltzmann_constant = 1.3806503e-23;
+
+    // Speed of light in megameters per second;
+    const double speed_of_light = 299.792458;
+
+    // Conversion factor from Solar Units to Watts per Meter Squared per Hertz;
+    const double W_M2_Hz = 10e-23;
+
+    // Number of frequencies which are available for Solar Flux Data;
+    const int number_of_available_frequencies = 9;
+
+    // Frequencies for which Solar Flux Data might be provided;
+    const double available_frequencies[number_of_available_frequencies]
+        = {245, 410, 610, 1415, 2695, 2800, 4995, 8800, 15400};
+
+}
+
+namespace gotcore
+{
+    // Location of an antenna;
+    struct Site
+    {
+        double latitudeDeg; // Latitude, in degrees;
+        double longitudeDeg; // Longitude, in degrees, east positive;
+    };
+
+    // An instant;
+    struct Epoch
+    {
+        double utcSeconds; // Seconds since 1 Jan 1970 UTC, with any fraction;
+    };
+
+    // Everything a G/T calculation depends upon;
+    struct GotInputs
+    {
+        double operatingFrequencyMHz; // Frequency at which the antenna works;
+        double lowerFrequencyMHz; // Available frequency at or below it;
+        double higherFrequencyMHz; // Available frequency above it;
+        double solarFluxLowSfu; // Solar flux at the lower frequency;
+        double solarFluxHighSfu; // Solar flux at the higher frequency;
+        double beamwidthDeg; // Beamwidth of the antenna;
+        double hotDb; // Average of the measurements on the sun;
+        double coldDb; // Average of the measurements off the sun;
+    };
+
+    // Result of a G/T calculation;
+    struct GotResult
+    {
+        // Solar flux at the operating frequency, in W / m^2 / Hz;
+        double solarFluxWm2Hz;
+        double beamCorrectionFactor; // Beamwidth correction factor;
+        double gotRatio; // Gain Over Temperature as a pure ratio;
+        double gotDb; // Gain Over Temperature in dB;
+    };
+
+    // Returns the instant of a count of nanoseconds since 1970 UTC;
+    Epoch epochFromNanoseconds(const long long& rNanoseconds);
+
+    // Returns the position of the sun at a site and instant;
+    SunPosition sunPosition(const Site& rSite, const Epoch& rEpoch);
+    // Calculates the position of the sun at a site for an array of instants;
+    void sunPositions(const Site& rSite
+                      , const Epoch* pEpochs
+                      , size_t count
+                      , SunPosition* pPositions
+                      , const SolarMathBackend& rBackend = LibmMath);
+
+    // Finds the available frequencies either side of an operating frequency;
+    bool findBracketingFrequencies(const double& rFreqMHz
+                                   , double& rLowerFreqMHz
+                                   , double& rHigherFreqMHz);
+    // Returns the apparent diameter of the radio sun at a frequency;
+    double radioSunDiameter(const double& rFreqMHz);
+    // Returns the correction for a beam not much wider than the sun;
+    double beamCorrectionFactor(const double& rBeamwidthDeg
+                                , const double& rFreqMHz);
+
+    // Interpolates linearly between two points;
+    double linearInterpolation(const double& rY1, const double& rY2
+                               , const double& rX1, const double& rX2
+                               , const double& rXPoint);
+    // Interpolates exponentially between two points;
+    double exponentialInterpolation(const double& rY1, const double& rY2
+                                    , const double& rX1, const double& rX2
+                                    , const double& rXPoint);
+
+    // Returns the mean power of an array of levels in dB, in dB;
+    double meanPowerDb(const double* pLevelsDb, size_t count);
+
+    // Returns the solar flux, in sfu, interpolated to the operating frequency;
+    double interpolatedSolarFlux(const GotInputs& rInputs);
+    // Calculates the G/T, interpolating the solar flux;
+    GotResult computeGot(const GotInputs& rInputs);
+    // Calculates the G/T given the solar flux at the operating frequency;
+    GotResult computeGotAtFlux(const GotInputs& rInputs
+                               , const double& rSolarFluxSfu);
+    // Calculates the G/T of each of an array of inputs;
+    void computeGot(const GotInputs* pInputs
+                    , size_t count
+                    , GotResult* pResults);
+}
+
+#endif // GOTCORE_H
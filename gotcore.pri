@@ -0,0 +1,38 @@
+#-------------------------------------------------
+#
+# Sources of the gotcore library: the sun position
+# and G/T calculations as plain value types, pure
+# functions, and a C interface.  These need no Qt;
+#
+#-------------------------------------------------
+
+# The core uses C++11 (static_assert and type traits);
+CONFIG += c++11
+
+# The solar tables and the fastmath.h kernels are written to be vectorised.
+# Nothing reads errno or traps on floating point exceptions, and leaving
+# those on stops GCC and Clang from turning the kernels' selects into vector
+# blends.  GCC also needs its full cost model to vectorise loops at -O2;
+contains(QMAKE_COMPILER, gcc) {
+    QMAKE_CXXFLAGS += -fno-math-errno -fno-trapping-math
+    !contains(QMAKE_COMPILER, clang): QMAKE_CXXFLAGS_RELEASE += \
+        -fvect-cost-model=dynamic
+}
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += $$PWD/solarmath.cpp \
+    $$PWD/fluxspectrum.cpp \
+    $$PWD/runningstats.cpp \
+    $$PWD/powerstats.cpp \
+    $$PWD/gotcore.cpp \
+    $$PWD/gotcore_c.cpp
+
+HEADERS += $$PWD/solarmath.h \
+    $$PWD/fastmath.h \
+    $$PWD/fluxspectrum.h \
+    $$PWD/runningstats.h \
+    $$PWD/powerstats.h \
+    $$PWD/gotcore.h \
+    $$PWD/gotcore_c.h
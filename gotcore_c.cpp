@@ -0,0 +1,253 @@
+/*----------------------------------------------------------------------------
+Name         gotcore_c.cpp
+
+Purpose      C interface to the gotcore library;
+
+Notes        Each C structure has the same members, in the same order, as its
+             C++ value type, which is checked below, so values are moved
+             between the two with memcpy.  No C++ exception can be thrown
+             from gotcore, so none can cross into C;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "gotcore_c.h"
+
+#include "gotcore.h" // USES the gotcore functions being wrapped;
+#include <cstddef> // USES offsetof;
+#include <cstring> // USES memcpy;
+
+static_assert(sizeof(got_site) == sizeof(gotcore::Site)
+              && offsetof(got_site, longitude_deg)
+                 == offsetof(gotcore::Site, longitudeDeg)
+              , "got_site must match gotcore::Site");
+static_assert(sizeof(got_sun_position) == sizeof(SunPosition)
+              && offsetof(got_sun_position, altitude_deg)
+                 == offsetof(SunPosition, altitudeDeg)
+              && offsetof(got_sun_position, hour_angle_deg)
+                 == offsetof(SunPosition, hourAngleDeg)
+              , "got_sun_position must match SunPosition");
+static_assert(sizeof(got_inputs) == sizeof(gotcore::GotInputs)
+              && offsetof(got_inputs, solar_flux_low_sfu)
+                 == offsetof(gotcore::GotInputs, solarFluxLowSfu)
+              && offsetof(got_inputs, cold_db)
+                 == offsetof(gotcore::GotInputs, coldDb)
+              , "got_inputs must match gotcore::GotInputs");
+static_assert(sizeof(got_result) == sizeof(gotcore::GotResult)
+              && offsetof(got_result, got_db)
+                 == offsetof(gotcore::GotResult, gotDb)
+              , "got_result must match gotcore::GotResult");
+
+namespace
+{
+    // Returns the C++ site of a C one;
+    gotcore::Site toSite(const got_site* pSite)
+    {
+        gotcore::Site site;
+        memcpy(&site, pSite, sizeof(site));
+        return site;
+    }
+
+    // Returns the backend of a C backend;
+    SolarMathBackend toBackend(got_backend backend)
+    {
+        return (backend == GOT_BACKEND_POLYNOMIAL) ? PolynomialMath
+                                                   : LibmMath;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         got_abi_version
+
+Purpose      Returns the version of the interface the library was built with,
+             so a caller can check it against GOT_ABI_VERSION;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int got_abi_version(void)
+{
+    return GOT_ABI_VERSION;
+}
+
+/*----------------------------------------------------------------------------
+Name         got_sun_position_at
+
+Purpose      Calculates the position of the sun at a site and instant;
+
+Input        site               The site;
+             utc_seconds        Seconds since 1 Jan 1970 UTC;
+
+Output       position           The position of the sun;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void got_sun_position_at(const got_site* site
+                         , double utc_seconds
+                         , got_sun_position* position)
+{
+    gotcore::Epoch epoch;
+    epoch.utcSeconds = utc_seconds;
+
+    const SunPosition sun = gotcore::sunPosition(toSite(site), epoch);
+    memcpy(position, &sun, sizeof(sun));
+}
+
+/*----------------------------------------------------------------------------
+Name         got_sun_positions
+
+Purpose      Calculates the position of the sun at a site for an array of
+             instants;
+
+Input        site               The site;
+             utc_seconds        Array of instants, seconds since 1970 UTC;
+             count              Number of entries in utc_seconds and
+                                positions;
+             backend            Trigonometric functions to use;
+
+Output       positions          Position of the sun at each instant;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void got_sun_positions(const got_site* site
+                       , const double* utc_seconds
+                       , size_t count
+                       , got_sun_position* positions
+                       , got_backend backend)
+{
+    static_assert(sizeof(gotcore::Epoch) == sizeof(double)
+                  , "gotcore::Epoch must be a bare double");
+
+    const size_t blockSize = 256;
+    gotcore::Epoch epochs[blockSize];
+    SunPosition suns[blockSize];
+    const gotcore::Site where = toSite(site);
+
+    for (size_t start = 0; start < count; start += blockSize)
+    {
+        const size_t n = (count - start < blockSize) ? count - start
+                                                     : blockSize;
+        memcpy(epochs, utc_seconds + start, n * sizeof(double));
+        gotcore::sunPositions(where, epochs, n, suns, toBackend(backend));
+        memcpy(positions + start, suns, n * sizeof(SunPosition));
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         got_sun_columns
+
+Purpose      Calculates the position of the sun at a site for an array of
+             instants, into separate columns;
+
+Input        site               The site;
+             utc_seconds        Array of instants, seconds since 1970 UTC;
+             count              Number of entries in utc_seconds and in each
+                                column;
+             backend            Trigonometric functions to use;
+
+Output       azimuth_deg        Solar Azimuth in degrees;
+             altitude_deg       Solar Altitude in degrees;
+             zenith_deg         Solar Zenith in degrees;
+             hour_angle_deg     Hour Angle in degrees;
+
+Notes        Any of the columns may be null if not wanted.  This is the
+             fastest form, as it is solarmath::positionsUtc itself;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void got_sun_columns(const got_site* site
+                     , const double* utc_seconds
+                     , size_t count
+                     , double* azimuth_deg
+                     , double* altitude_deg
+                     , double* zenith_deg
+                     , double* hour_angle_deg
+                     , got_backend backend)
+{
+    solarmath::positionsUtc(site->latitude_deg, site->longitude_deg
+                            , utc_seconds, count, azimuth_deg, altitude_deg
+                            , zenith_deg, hour_angle_deg
+                            , toBackend(backend));
+}
+
+/*----------------------------------------------------------------------------
+Name         got_bracketing_frequencies
+
+Purpose      Finds the available solar flux frequencies either side of an
+             operating frequency;
+
+Input        frequency_mhz      The operating frequency, in MHz;
+
+Output       lower_mhz          The available frequency at or below it;
+             higher_mhz         The available frequency above it;
+
+Returns      int                1 if found, or 0 if out of range;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int got_bracketing_frequencies(double frequency_mhz
+                               , double* lower_mhz
+                               , double* higher_mhz)
+{
+    return gotcore::findBracketingFrequencies(frequency_mhz, *lower_mhz
+                                              , *higher_mhz) ? 1 : 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         got_mean_power_db
+
+Purpose      Returns the mean power of an array of levels in dB, as the hot
+             and cold averages of a G/T calculation should be taken;
+
+Input        levels_db          The levels, in dB;
+             count              Number of entries in levels_db;
+
+Returns      double             The mean power, in dB, or NaN if count is 0;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double got_mean_power_db(const double* levels_db, size_t count)
+{
+    return gotcore::meanPowerDb(levels_db, count);
+}
+
+/*----------------------------------------------------------------------------
+Name         got_compute
+
+Purpose      Calculates the Gain Over Temperature;
+
+Input        inputs             The inputs;
+
+Output       result             The result;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void got_compute(const got_inputs* inputs, got_result* result)
+{
+    gotcore::GotInputs in;
+    memcpy(&in, inputs, sizeof(in));
+
+    const gotcore::GotResult out = gotcore::computeGot(in);
+    memcpy(result, &out, sizeof(out));
+}
+
+/*----------------------------------------------------------------------------
+Name         got_compute_batch
+
+Purpose      Calculates the Gain Over Temperature of each of an array of
+             inputs;
+
+Input        inputs             The inputs;
+             count              Number of entries in inputs and results;
+
+Output       results            The result of each entry of inputs;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void got_compute_batch(const got_inputs* inputs
+                       , size_t count
+                       , got_result* results)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        got_compute(inputs + i, results + i);
+    }
+}
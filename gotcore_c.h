@@ -0,0 +1,135 @@
+/*----------------------------------------------------------------------------
+Name         gotcore_c.h
+
+Purpose      C interface to the gotcore library, for services written in C,
+             or in any language which can call C, that need the position of
+             the sun or the Gain Over Temperature without Qt or C++;
+
+Notes        The structures have the same layout as the C++ value types of
+             gotcore.h, and like them may be kept in arrays of any size.
+             Every function may be called from any number of threads at once;
+
+             Link against the static library, or define GOTCORE_SHARED when
+             using the shared one (see core/gotcore.pro).  got_abi_version
+             is raised whenever a structure or signature here changes;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Added got_mean_power_db;
+----------------------------------------------------------------------------*/
+#ifndef GOTCORE_C_H
+#define GOTCORE_C_H
+
+#include <stddef.h> /* USES size_t; */
+
+#if defined(GOTCORE_SHARED) && defined(_WIN32)
+#  if defined(GOTCORE_BUILD)
+#    define GOTCORE_API __declspec(dllexport)
+#  else
+#    define GOTCORE_API __declspec(dllimport)
+#  endif
+#elif defined(GOTCORE_SHARED) && defined(__GNUC__)
+#  define GOTCORE_API __attribute__((visibility("default")))
+#else
+#  define GOTCORE_API
+#endif
+
+#define GOT_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Location of an antenna; */
+typedef struct got_site
+{
+    double latitude_deg; /* Latitude, in degrees; */
+    double longitude_deg; /* Longitude, in degrees, east positive; */
+} got_site;
+
+/* Position of the sun at one instant; */
+typedef struct got_sun_position
+{
+    double azimuth_deg;
+    double altitude_deg;
+    double zenith_deg;
+    double hour_angle_deg;
+} got_sun_position;
+
+/* Everything a G/T calculation depends upon; */
+typedef struct got_inputs
+{
+    double operating_frequency_mhz;
+    double lower_frequency_mhz; /* Available frequency at or below it; */
+    double higher_frequency_mhz; /* Available frequency above it; */
+    double solar_flux_low_sfu; /* Solar flux at the lower frequency; */
+    double solar_flux_high_sfu; /* Solar flux at the higher frequency; */
+    double beamwidth_deg;
+    double hot_db; /* Average of the measurements on the sun; */
+    double cold_db; /* Average of the measurements off the sun; */
+} got_inputs;
+
+/* Result of a G/T calculation; */
+typedef struct got_result
+{
+    double solar_flux_w_m2_hz; /* Solar flux at the operating frequency; */
+    double beam_correction_factor;
+    double got_ratio; /* Gain Over Temperature as a pure ratio; */
+    double got_db; /* Gain Over Temperature in dB; */
+} got_result;
+
+/* Trigonometric functions used for arrays of sun positions; */
+typedef enum got_backend
+{
+    GOT_BACKEND_LIBM = 0, /* The C library; */
+    GOT_BACKEND_POLYNOMIAL = 1 /* Vectorised, error below 2e-11 rad; */
+} got_backend;
+
+/* Returns GOT_ABI_VERSION as the library was built; */
+GOTCORE_API int got_abi_version(void);
+
+/* Calculates the position of the sun at a site and instant, in seconds since
+   1 Jan 1970 UTC; */
+GOTCORE_API void got_sun_position_at(const got_site* site
+                                     , double utc_seconds
+                                     , got_sun_position* position);
+
+/* Calculates the position of the sun at a site for an array of instants; */
+GOTCORE_API void got_sun_positions(const got_site* site
+                                   , const double* utc_seconds
+                                   , size_t count
+                                   , got_sun_position* positions
+                                   , got_backend backend);
+
+/* As got_sun_positions, into separate columns.  Any column may be null; */
+GOTCORE_API void got_sun_columns(const got_site* site
+                                 , const double* utc_seconds
+                                 , size_t count
+                                 , double* azimuth_deg
+                                 , double* altitude_deg
+                                 , double* zenith_deg
+                                 , double* hour_angle_deg
+                                 , got_backend backend);
+
+/* Finds the available solar flux frequencies either side of an operating
+   frequency.  Returns 0, leaving the outputs untouched, if out of range; */
+GOTCORE_API int got_bracketing_frequencies(double frequency_mhz
+                                           , double* lower_mhz
+                                           , double* higher_mhz);
+
+/* Returns the mean power of an array of levels in dB, averaged as power
+   ratios, in dB; */
+GOTCORE_API double got_mean_power_db(const double* levels_db, size_t count);
+
+/* Calculates the G/T; */
+GOTCORE_API void got_compute(const got_inputs* inputs, got_result* result);
+
+/* Calculates the G/T of each of an array of inputs; */
+GOTCORE_API void got_compute_batch(const got_inputs* inputs
+                                   , size_t count
+                                   , got_result* results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GOTCORE_C_H */
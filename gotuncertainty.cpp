@@ -0,0 +1,353 @@
+/*----------------------------------------------------------------------------
+Name         gotuncertainty.cpp
+
+Purpose      Monte Carlo estimate of the uncertainty of a Gain Over
+             Temperature result, propagating radiometer noise, solar flux
+             uncertainty, and beamwidth tolerance;
+
+Notes        Each draw perturbs the hot and cold means, the solar flux, and
+             the beamwidth with independent normal errors and works out the
+             G/T of each with gotcore::computeGotAtFlux, as GotCalc does.
+             The flux error is a single scale factor, as the error of the
+             observatory calibration is shared by neighbouring frequencies;
+
+             The draws are made in blocks of draws_per_block, each block
+             generated from its own seed, which is made from the engine's
+             seed and the index of the block.  Blocks are independent jobs on
+             the pool, and their statistics are merged in block order, so the
+             result only depends on the seed and the number of draws, not on
+             the number of workers or the order in which they ran;
+
+             Within a block the draws are made in batches laid out as arrays,
+             with no branches in the loops which make the normal numbers, so
+             that the compiler may vectorise them;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Fill the last draw of an odd batch;
+             17 Oct 26  AFB Work out each draw with gotcore::computeGotAtFlux;
+             17 Oct 26  AFB Run the draws on the calling thread without a pool;
+----------------------------------------------------------------------------*/
+#include "gotuncertainty.h"
+
+#include "gotcore.h" // USES gotcore::computeGotAtFlux for each draw;
+#include "runningstats.h" // USES RunningStats for each block's statistics;
+#include <algorithm> // USES std::nth_element for the percentiles;
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Draws made at once within a block;
+    const int batch_size = 256;
+
+    // Draws per job handed to the pool, in blocks;
+    const int blocks_per_job = 4;
+
+    // Mixes a 64 bit value into a well spread seed (SplitMix64);
+    quint64 splitMix64(quint64& rState)
+    {
+        quint64 z = (rState += Q_UINT64_C(0x9E3779B97F4A7C15));
+        z = (z ^ (z >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+        z = (z ^ (z >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+        return z ^ (z >> 31);
+    }
+
+    // Small, fast generator of uniform numbers (xoshiro256+);
+    class Xoshiro256
+    {
+    public:
+        explicit Xoshiro256(quint64 seed)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                mState[i] = splitMix64(seed);
+            }
+        }
+
+        // Returns a uniform number in (0, 1], never zero so that its log
+        // may be taken;
+        double nextOpenUniform(void)
+        {
+            const quint64 result = mState[0] + mState[3];
+            const quint64 t = mState[1] << 17;
+
+            mState[2] ^= mState[0];
+            mState[3] ^= mState[1];
+            mState[1] ^= mState[2];
+            mState[0] ^= mState[3];
+            mState[2] ^= t;
+            mState[3] = (mState[3] << 45) | (mState[3] >> 19);
+
+            return ((result >> 11) + 1) * (1.0 / 9007199254740992.0);
+        }
+
+    private:
+        quint64 mState[4];
+    };
+
+    // Fills an array with standard normal numbers (Box-Muller).  Numbers
+    // come in pairs, so an odd count makes one pair more and drops its
+    // second number;
+    void fillNormal(Xoshiro256& rRng, double* pOut, const int& rCount)
+    {
+        double u1[batch_size / 2];
+        double u2[batch_size / 2];
+        double normal[batch_size];
+        const int pairs = (rCount + 1) / 2;
+
+        for (int i = 0; i < pairs; i++)
+        {
+            u1[i] = rRng.nextOpenUniform();
+            u2[i] = rRng.nextOpenUniform();
+        }
+
+        for (int i = 0; i < pairs; i++)
+        {
+            const double radius = sqrt(-2.0 * log(u1[i]));
+            const double angle = 2.0 * M_PI * u2[i];
+            normal[2 * i] = radius * cos(angle);
+            normal[2 * i + 1] = radius * sin(angle);
+        }
+
+        std::copy(normal, normal + rCount, pOut);
+    }
+
+    // Inputs of the G/T equation at their means, and the 1-sigma error of
+    // each input which is drawn;
+    struct Kernel
+    {
+        gotcore::GotInputs inputs; // Inputs at their means;
+        double fluxSfu; // Solar flux at the operating frequency, in SFU;
+        double hotErrorDb;
+        double coldErrorDb;
+        double fluxError; // Fractional error of the flux;
+        double beamwidthError;
+    };
+
+    // Works out the G/T, in dB, of a batch of draws.  Draws with no sun
+    // noise rise, or a flux or beamwidth which is not positive, give NaN;
+    void drawBatch(const Kernel& rKernel, Xoshiro256& rRng
+                   , double* pGotDb, const int& rCount)
+    {
+        double hot[batch_size];
+        double cold[batch_size];
+        double flux[batch_size];
+        double beam[batch_size];
+
+        fillNormal(rRng, hot, rCount);
+        fillNormal(rRng, cold, rCount);
+        fillNormal(rRng, flux, rCount);
+        fillNormal(rRng, beam, rCount);
+
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+
+        for (int i = 0; i < rCount; i++)
+        {
+            gotcore::GotInputs inputs = rKernel.inputs;
+            inputs.hotDb += rKernel.hotErrorDb * hot[i];
+            inputs.coldDb += rKernel.coldErrorDb * cold[i];
+            inputs.beamwidthDeg += rKernel.beamwidthError * beam[i];
+            const double fluxSfu = rKernel.fluxSfu
+                    * (1.0 + rKernel.fluxError * flux[i]);
+
+            const bool valid = inputs.hotDb > inputs.coldDb
+                    && fluxSfu > 0.0 && inputs.beamwidthDeg > 0.0;
+            pGotDb[i] = valid ? gotcore::computeGotAtFlux(inputs
+                                                          , fluxSfu).gotDb
+                              : nan;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         GotUncertainty
+
+Purpose      Constructor;
+
+Input        pPool              Pool on which the draws are run, or 0 to run
+                                them on the thread which calls estimate;
+
+Notes        The percentiles reported default to the median and the edges of
+             the 95% interval;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+GotUncertainty::GotUncertainty(WorkStealingPool *pPool)
+    : mPool(pPool)
+    , mSeed(1)
+{
+    mPercentiles.push_back(2.5);
+    mPercentiles.push_back(50.0);
+    mPercentiles.push_back(97.5);
+}
+
+/*----------------------------------------------------------------------------
+Name         setSeed
+
+Purpose      Sets the seed from which every draw is generated.  The same seed
+             and number of draws always give the same result;
+
+Input        rSeed              The seed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void GotUncertainty::setSeed(const unsigned long long &rSeed)
+{
+    mSeed = rSeed;
+}
+
+/*----------------------------------------------------------------------------
+Name         setPercentiles
+
+Purpose      Sets the percentiles to report;
+
+Input        rPercentiles       Percentiles, in percent, each from 0 to 100;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void GotUncertainty::setPercentiles(const std::vector<double> &rPercentiles)
+{
+    mPercentiles = rPercentiles;
+}
+
+/*----------------------------------------------------------------------------
+Name         estimate
+
+Purpose      Draws perturbed input sets, works out the G/T of each, and
+             summarises the spread;
+
+Input        rInputs            The inputs and their 1-sigma uncertainties;
+             rDraws             Number of draws to make;
+
+Returns      GotUncertaintyResult   Mean, standard deviation, and percentiles
+                                    of the G/T over the draws which had a sun
+                                    noise rise;
+
+Notes        Every draw is kept for the percentiles, so memory grows by eight
+             bytes a draw;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+GotUncertaintyResult GotUncertainty::estimate(
+        const GotUncertaintyInputs &rInputs
+        , const unsigned long long &rDraws) const
+{
+    Kernel kernel;
+    kernel.inputs.operatingFrequencyMHz = rInputs.operatingFrequencyMHz;
+    kernel.inputs.lowerFrequencyMHz = rInputs.operatingFrequencyMHz;
+    kernel.inputs.higherFrequencyMHz = rInputs.operatingFrequencyMHz;
+    kernel.inputs.solarFluxLowSfu = rInputs.solarFluxSfu;
+    kernel.inputs.solarFluxHighSfu = rInputs.solarFluxSfu;
+    kernel.inputs.beamwidthDeg = rInputs.beamwidthDeg;
+    kernel.inputs.hotDb = rInputs.hotMeanDb;
+    kernel.inputs.coldDb = rInputs.coldMeanDb;
+    kernel.fluxSfu = rInputs.solarFluxSfu;
+    kernel.hotErrorDb = rInputs.hotStandardErrorDb;
+    kernel.coldErrorDb = rInputs.coldStandardErrorDb;
+    kernel.fluxError = rInputs.solarFluxUncertainty;
+    kernel.beamwidthError = rInputs.beamwidthUncertaintyDeg;
+
+    const quint64 draws = rDraws;
+    const int blocks = static_cast<int>(
+                (draws + draws_per_block - 1) / draws_per_block);
+
+    std::vector<double> values(draws);
+    std::vector<RunningStats> blockStats(blocks);
+    const quint64 seed = mSeed;
+
+    const WorkStealingPool::RangeTask runBlocks = [&](int begin, int end)
+    {
+        double valid[batch_size];
+
+        for (int block = begin; block < end; block++)
+        {
+            quint64 blockSeed = seed ^ (static_cast<quint64>(block)
+                                        * Q_UINT64_C(0xD1B54A32D192ED03));
+            Xoshiro256 rng(splitMix64(blockSeed));
+
+            const quint64 first = static_cast<quint64>(block)
+                    * draws_per_block;
+            const quint64 last = qMin(first + draws_per_block, draws);
+
+            for (quint64 i = first; i < last; i += batch_size)
+            {
+                const int count = static_cast<int>(
+                            qMin<quint64>(batch_size, last - i));
+                drawBatch(kernel, rng, &values[i], count);
+
+                int validCount = 0;
+                for (int j = 0; j < count; j++)
+                {
+                    const double value = values[i + j];
+                    if (value == value)
+                    {
+                        valid[validCount++] = value;
+                    }
+                }
+                blockStats[block].addSamples(valid, validCount);
+            }
+        }
+    };
+
+    // Without a pool, as when the caller already runs on a pool's worker,
+    // the blocks are run here, in order;
+    if (mPool)
+    {
+        mPool->parallelFor(0, blocks, blocks_per_job, runBlocks);
+    }
+    else
+    {
+        runBlocks(0, blocks);
+    }
+
+    // Merge in block order, so the sums are always made the same way;
+    RunningStats stats;
+    for (int block = 0; block < blocks; block++)
+    {
+        stats.merge(blockStats[block]);
+    }
+
+    GotUncertaintyResult result;
+    result.draws = draws;
+    result.rejected = draws - stats.getCount();
+    result.meanDb = stats.getMean();
+    result.standardDeviationDb = stats.getStandardDeviation();
+    result.percentiles = mPercentiles;
+
+    // Drop the rejected draws, then find each percentile by selection,
+    // interpolating between the nearest two draws;
+    values.erase(std::remove_if(values.begin(), values.end()
+                                , [](double value) { return value != value; })
+                 , values.end());
+
+    for (size_t p = 0; p < mPercentiles.size(); p++)
+    {
+        if (values.empty())
+        {
+            result.percentileValuesDb.push_back(
+                        std::numeric_limits<double>::quiet_NaN());
+            continue;
+        }
+
+        const double position = qBound(0.0, mPercentiles[p] / 100.0, 1.0)
+                * (values.size() - 1);
+        const size_t lower = static_cast<size_t>(position);
+        const double fraction = position - lower;
+
+        std::nth_element(values.begin(), values.begin() + lower
+                         , values.end());
+        double value = values[lower];
+
+        if (fraction > 0.0 && lower + 1 < values.size())
+        {
+            // The next draw up is the smallest of those above lower;
+            const double next = *std::min_element(values.begin() + lower + 1
+                                                  , values.end());
+            value += fraction * (next - value);
+        }
+
+        result.percentileValuesDb.push_back(value);
+    }
+
+    return result;
+}
@@ -0,0 +1,64 @@
+/*----------------------------------------------------------------------------
+Name         gotuncertainty.h
+
+Purpose      Monte Carlo estimate of the uncertainty of a Gain Over
+             Temperature result, propagating radiometer noise, solar flux
+             uncertainty, and beamwidth tolerance;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef GOTUNCERTAINTY_H
+#define GOTUNCERTAINTY_H
+
+#include <vector> // HASA std::vector of percentiles;
+#include "workstealingpool.h" // USES WorkStealingPool to run the draws;
+
+// Inputs of a G/T calculation, and the 1-sigma uncertainty of each;
+struct GotUncertaintyInputs
+{
+    double operatingFrequencyMHz; // Frequency at which the antenna works;
+    double solarFluxSfu; // Solar flux interpolated to the frequency, SFU;
+    double solarFluxUncertainty; // Fractional 1-sigma error of the flux;
+    double beamwidthDeg; // Beamwidth of the antenna, in degrees;
+    double beamwidthUncertaintyDeg; // 1-sigma error of the beamwidth;
+    double hotMeanDb; // Mean of the hot measurements, in dB;
+    double hotStandardErrorDb; // 1-sigma error of the hot mean;
+    double coldMeanDb; // Mean of the cold measurements, in dB;
+    double coldStandardErrorDb; // 1-sigma error of the cold mean;
+};
+
+// Spread of the G/T over every draw;
+struct GotUncertaintyResult
+{
+    unsigned long long draws; // Number of draws made;
+    unsigned long long rejected; // Draws with no sun noise rise, left out;
+    double meanDb; // Mean G/T, in dB;
+    double standardDeviationDb; // Standard deviation of the G/T, in dB;
+    std::vector<double> percentiles; // Percentiles asked for, in percent;
+    std::vector<double> percentileValuesDb; // G/T at each percentile, in dB;
+};
+
+class GotUncertainty
+{
+public:
+    explicit GotUncertainty(WorkStealingPool* pPool); // Constructor;
+
+    // Sets the seed from which every draw is generated;
+    void setSeed(const unsigned long long& rSeed);
+    // Sets the percentiles to report, in percent;
+    void setPercentiles(const std::vector<double>& rPercentiles);
+
+    // Draws rDraws perturbed input sets and summarises the G/T of each;
+    GotUncertaintyResult estimate(const GotUncertaintyInputs& rInputs
+                                  , const unsigned long long& rDraws) const;
+
+    // Number of draws generated from each seed, and handed to a worker;
+    static const int draws_per_block = 4096;
+
+private:
+    WorkStealingPool* mPool; // Pool the draws are run on, or 0;
+    unsigned long long mSeed; // Seed from which each block's seed is made;
+    std::vector<double> mPercentiles; // Percentiles to report;
+};
+
+#endif // GOTUNCERTAINTY_H
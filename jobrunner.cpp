@@ -0,0 +1,323 @@
+/*----------------------------------------------------------------------------
+Name         jobrunner.cpp
+
+Purpose      Runs calculations on worker threads, one job at a time for each
+             channel, so that the window stays responsive while they run;
+
+Notes        Each channel runs at most one job, with at most one more waiting
+             behind it.  Submitting a job while one is running cancels the
+             running job and takes the place of any job already waiting, so
+             however quickly jobs are submitted only the latest is run once
+             the current one stops.  Jobs are cancelled cooperatively: a job
+             should check JobControl::isCancelled() between steps, and the
+             result of a cancelled job is never delivered;
+
+             Jobs run on QThreadPool::globalInstance() through QtConcurrent,
+             and must not touch any widget.  Everything they need should be
+             copied into the job before it is submitted;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "jobrunner.h"
+
+#include <QtConcurrent/QtConcurrentRun> // USES QtConcurrent::run;
+
+/*----------------------------------------------------------------------------
+Name         JobControl
+
+Purpose      Constructor;
+
+Input        pRunner            Runner to which progress is reported;
+             rChannel           Channel the job was submitted on;
+             rGeneration        Which of the channel's jobs this is;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+JobControl::JobControl(JobRunner *pRunner, const int &rChannel
+                       , const quint64 &rGeneration)
+    : mRunner(pRunner)
+    , mChannel(rChannel)
+    , mGeneration(rGeneration)
+    , mCancelled(false)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         isCancelled
+
+Purpose      Returns whether the job has been cancelled or superseded by a
+             newer job, in which case it should return as soon as it can;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool JobControl::isCancelled() const
+{
+    return mCancelled.load(std::memory_order_relaxed);
+}
+
+/*----------------------------------------------------------------------------
+Name         setProgress
+
+Purpose      Reports how far the job has got.  The report is passed on by the
+             runner's progress() signal, on the runner's thread;
+
+Input        rDone              Steps done so far;
+             rTotal             Steps in all;
+
+Notes        Every report is queued to the runner's thread, so a job should
+             report at a coarse step rather than on every iteration;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void JobControl::setProgress(const int &rDone, const int &rTotal)
+{
+    if (isCancelled())
+    {
+        return;
+    }
+
+    QMetaObject::invokeMethod(mRunner, "reportProgress", Qt::QueuedConnection
+                              , Q_ARG(int, mChannel)
+                              , Q_ARG(qulonglong, mGeneration)
+                              , Q_ARG(int, rDone)
+                              , Q_ARG(int, rTotal));
+}
+
+/*----------------------------------------------------------------------------
+Name         JobRunner
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+JobRunner::JobRunner(QObject *parent) : QObject(parent)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         ~JobRunner
+
+Purpose      Destructor.  Cancels every job and waits for the running ones to
+             return, as they refer to the runner;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+JobRunner::~JobRunner()
+{
+    cancelAll();
+
+    QHash<int, Channel*>::iterator it;
+    for (it = mChannels.begin(); it != mChannels.end(); ++it)
+    {
+        it.value()->watcher->disconnect(this);
+        it.value()->watcher->waitForFinished();
+        delete it.value();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         submit
+
+Purpose      Runs a job on a channel.  If the channel is idle the job starts
+             straight away; otherwise the running job is cancelled and this
+             job waits for it to stop, replacing any job already waiting;
+
+Input        rChannel           Channel on which to run the job;
+             rJob               The job;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void JobRunner::submit(const int &rChannel, const Job &rJob)
+{
+    Channel* pChannel = channel(rChannel);
+
+    if (!pChannel->watcher->isRunning())
+    {
+        start(rChannel, pChannel, rJob);
+        return;
+    }
+
+    pChannel->control->mCancelled.store(true, std::memory_order_relaxed);
+    pChannel->pending = rJob;
+    pChannel->hasPending = true;
+}
+
+/*----------------------------------------------------------------------------
+Name         cancel
+
+Purpose      Cancels the running job, and drops any waiting job, on a channel;
+
+Input        rChannel           The channel;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void JobRunner::cancel(const int &rChannel)
+{
+    Channel* pChannel = mChannels.value(rChannel, 0);
+    if (!pChannel)
+    {
+        return;
+    }
+
+    if (pChannel->control)
+    {
+        pChannel->control->mCancelled.store(true, std::memory_order_relaxed);
+    }
+    pChannel->pending = Job();
+    pChannel->hasPending = false;
+}
+
+/*----------------------------------------------------------------------------
+Name         cancelAll
+
+Purpose      Cancels the running job, and drops any waiting job, on every
+             channel;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void JobRunner::cancelAll()
+{
+    const QList<int> channels = mChannels.keys();
+    for (int i = 0; i < channels.size(); i++)
+    {
+        cancel(channels.at(i));
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         isBusy
+
+Purpose      Returns whether a job is running on a channel;
+
+Input        rChannel           The channel;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool JobRunner::isBusy(const int &rChannel) const
+{
+    const Channel* pChannel = mChannels.value(rChannel, 0);
+    return pChannel && pChannel->watcher->isRunning();
+}
+
+/*----------------------------------------------------------------------------
+Name         jobFinished
+
+Purpose      Handles the end of a running job, delivering its result unless
+             it was cancelled, then starts the waiting job, if any;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void JobRunner::jobFinished()
+{
+    QFutureWatcher<QVariant>* pWatcher
+            = static_cast<QFutureWatcher<QVariant>*>(sender());
+    const int channelId = pWatcher->property("channel").toInt();
+    Channel* pChannel = mChannels.value(channelId, 0);
+    if (!pChannel)
+    {
+        return;
+    }
+
+    const bool wasCancelled = pChannel->control->isCancelled();
+    const QVariant result = wasCancelled ? QVariant() : pWatcher->result();
+
+    // Start the waiting job before announcing the result, so that a slot
+    // which submits another job sees the channel as busy;
+    if (pChannel->hasPending)
+    {
+        const Job job = pChannel->pending;
+        pChannel->pending = Job();
+        pChannel->hasPending = false;
+        start(channelId, pChannel, job);
+    }
+
+    if (wasCancelled)
+    {
+        emit cancelled(channelId);
+    }
+    else
+    {
+        emit finished(channelId, result);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         reportProgress
+
+Purpose      Passes on progress reported by a job, unless the job has since
+             finished, or been cancelled or superseded;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void JobRunner::reportProgress(int channel, qulonglong generation
+                               , int done, int total)
+{
+    const Channel* pChannel = mChannels.value(channel, 0);
+    if (!pChannel || pChannel->generation != generation
+            || pChannel->control->isCancelled()
+            || !pChannel->watcher->isRunning())
+    {
+        return;
+    }
+
+    emit progress(channel, done, total);
+}
+
+/*----------------------------------------------------------------------------
+Name         channel
+
+Purpose      Returns a channel, creating it the first time it is used;
+
+Input        rChannel           The channel;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+JobRunner::Channel* JobRunner::channel(const int &rChannel)
+{
+    Channel* pChannel = mChannels.value(rChannel, 0);
+    if (pChannel)
+    {
+        return pChannel;
+    }
+
+    pChannel = new Channel;
+    pChannel->watcher = new QFutureWatcher<QVariant>(this);
+    pChannel->watcher->setProperty("channel", rChannel);
+    pChannel->hasPending = false;
+    pChannel->generation = 0;
+    connect(pChannel->watcher, SIGNAL(finished())
+            , this, SLOT(jobFinished()));
+
+    mChannels.insert(rChannel, pChannel);
+    return pChannel;
+}
+
+/*----------------------------------------------------------------------------
+Name         start
+
+Purpose      Starts a job on an idle channel;
+
+Input        rChannel           The channel;
+             pChannel           Its state;
+             rJob               The job;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void JobRunner::start(const int &rChannel, Channel *pChannel, const Job &rJob)
+{
+    pChannel->generation++;
+    pChannel->control = QSharedPointer<JobControl>(
+                new JobControl(this, rChannel, pChannel->generation));
+
+    // The job holds its own reference to the control, which may be replaced
+    // on the channel while the job is still running;
+    const QSharedPointer<JobControl> control = pChannel->control;
+    const Job job = rJob;
+
+    pChannel->watcher->setFuture(QtConcurrent::run([control, job]()
+    {
+        return control->isCancelled() ? QVariant() : job(*control);
+    }));
+
+    emit started(rChannel);
+}
@@ -0,0 +1,101 @@
+/*----------------------------------------------------------------------------
+Name         jobrunner.h
+
+Purpose      Runs calculations on worker threads, one job at a time for each
+             channel, so that the window stays responsive while they run;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef JOBRUNNER_H
+#define JOBRUNNER_H
+
+#include <QObject> // ISA QObject;
+#include <QVariant> // USES QVariant to hand back each job's result;
+#include <QHash> // HASA QHash of channels;
+#include <QFutureWatcher> // HASA QFutureWatcher for the running job;
+#include <QSharedPointer> // HASA QSharedPointer to the running job's control;
+#include <atomic> // USES std::atomic for the cancel flag;
+#include <functional> // USES std::function for the jobs;
+
+class JobRunner;
+
+// Handed to a running job, to check for cancellation and report progress;
+class JobControl
+{
+public:
+    // Whether the job has been cancelled or superseded, and should stop;
+    bool isCancelled(void) const;
+    // Reports how far the job has got;
+    void setProgress(const int& rDone, const int& rTotal);
+
+private:
+    friend class JobRunner;
+
+    JobControl(JobRunner* pRunner, const int& rChannel
+               , const quint64& rGeneration); // Constructor;
+
+    JobRunner* mRunner; // Runner to which progress is reported;
+    int mChannel; // Channel the job was submitted on;
+    quint64 mGeneration; // Which of the channel's jobs this is;
+    std::atomic<bool> mCancelled; // Set to ask the job to stop;
+};
+
+class JobRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    // A job; runs on a worker thread and returns its result;
+    typedef std::function<QVariant(JobControl&)> Job;
+
+    explicit JobRunner(QObject *parent = 0); // Constructor;
+    ~JobRunner(); // Destructor, cancels and waits for running jobs;
+
+    // Runs a job, replacing any job already waiting on the channel;
+    void submit(const int& rChannel, const Job& rJob);
+    // Cancels the running job, and drops any waiting job, on a channel;
+    void cancel(const int& rChannel);
+    // Cancels every channel;
+    void cancelAll(void);
+    // Whether a job is running on a channel;
+    bool isBusy(const int& rChannel) const;
+
+signals:
+    // Emitted when a job starts running;
+    void started(int channel);
+    // Emitted as a job reports its progress;
+    void progress(int channel, int done, int total);
+    // Emitted with the result of a job which ran to completion;
+    void finished(int channel, QVariant result);
+    // Emitted when a job was cancelled or superseded before it finished;
+    void cancelled(int channel);
+
+private slots:
+    // Handles the end of a running job, and starts the waiting one, if any;
+    void jobFinished(void);
+    // Passes on progress reported by a job, if it is still current;
+    void reportProgress(int channel, qulonglong generation
+                        , int done, int total);
+
+private:
+    friend class JobControl;
+
+    // The running and waiting jobs of a channel;
+    struct Channel
+    {
+        QFutureWatcher<QVariant>* watcher; // Watches the running job;
+        QSharedPointer<JobControl> control; // Control of the running job;
+        Job pending; // Job waiting for the running one to finish;
+        bool hasPending; // Whether pending holds a job;
+        quint64 generation; // Count of jobs started on the channel;
+    };
+
+    QHash<int, Channel*> mChannels; // Channels, created as they are used;
+
+    // Returns a channel, creating it if need be;
+    Channel* channel(const int& rChannel);
+    // Starts a job on an idle channel;
+    void start(const int& rChannel, Channel* pChannel, const Job& rJob);
+};
+
+#endif // JOBRUNNER_H
@@ -18,6 +18,10 @@ History		11 Jun 16  AFB	Created
 LogFile::LogFile(QObject *parent) : QObject(parent)
 {
     mFile = new QFile(this);
+
+    mAsync = false;
+    mAsyncCapacity = 1024;
+    mWriter = 0;
 }
 
 /*----------------------------------------------------------------------------
@@ -26,9 +30,11 @@ Name		~LogFile
 Purpose		Log file destructor;
 
 History		11 Jun 16  AFB	Created
+            17 Oct 26  AFB  Stop the writer thread, if any;
 ----------------------------------------------------------------------------*/
 LogFile::~LogFile()
 {
+    stopWriter();
 }
 
 /*----------------------------------------------------------------------------
@@ -39,6 +45,7 @@ Purpose		Set the file name and open/test for successful open;
 Inputs      filename        QString of the file name to be used as the log;
 
 History		11 Jun 16  AFB	Created
+            17 Oct 26  AFB  Start the writer thread when asynchronous;
 ----------------------------------------------------------------------------*/
 void LogFile::setNameAndOpen(const QString &filename)
 {
@@ -57,10 +64,18 @@ void LogFile::setNameAndOpen(const QString &filename)
     }
 
     // Output date/time to the log file;
-    QTextStream out(mFile);
-    out << date;
-    date = dT.toString("hh:mm:ss.zzz");
-    out << '\r' << date << '\r';
+    {
+        QTextStream out(mFile);
+        out << date;
+        date = dT.toString("hh:mm:ss.zzz");
+        out << '\r' << date << '\r';
+    }
+
+    // From here on the writer thread, if any, owns the file;
+    if (mAsync && mFile->isOpen())
+    {
+        startWriter();
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -72,12 +87,22 @@ Inputs      str        QString of the data to be output to the file;
 
 History		11 Jun 16  AFB	Created
             12 Jul 16  AFB  Added automatic appending of carriage return;
+            17 Oct 26  AFB  Hand off to the writer thread when asynchronous;
+            17 Oct 26  AFB  Write through LogWriter::writeBatch, so that the
+                            record is counted in the metrics;
 ----------------------------------------------------------------------------*/
 void LogFile::append(const QString& str)
 {
-    QTextStream out(mFile);
-    out << str;
-    out << '\r';
+    if (mWriter)
+    {
+        mWriter->append(str);
+        return;
+    }
+
+    // Encoded as QTextStream would, in the local 8 bit encoding;
+    QByteArray record = str.toLocal8Bit();
+    record += '\r';
+    LogWriter::writeBatch(mFile, record, 1);
 }
 
 /*----------------------------------------------------------------------------
@@ -89,14 +114,140 @@ Inputs      str        std::string of the data to be output to the file;
 
 History		11 Jun 16  AFB	Created
             12 Jul 16  AFB  Added automatic appending of carriage return;
+            17 Oct 26  AFB  Forward to the QString append;
 ----------------------------------------------------------------------------*/
 void LogFile::append(const std::string& str)
 {
-    QTextStream out(mFile);
     // Qt classes only work with Qt type variables.  Convert the std::string
     // to a QString;
     QString qStr(str.c_str());
-    out << qStr;
-    out << '\r';
+    append(qStr);
+}
+
+/*----------------------------------------------------------------------------
+Name		setAsynchronous
+
+Purpose		Chooses whether appends write to the file on the calling thread
+            or are queued for a background writer thread;
+
+Inputs      rAsync          true  - queue appends for a writer thread;
+                            false - write appends on the calling thread;
+            rCapacity       Number of records which may be queued before
+                            append blocks, bounding the memory used;
+
+Notes       When asynchronous, appends return as soon as the record is queued
+            and the writer thread gathers queued records into large writes,
+            so a slow disk (or network share) does not hold up the caller.
+            Use flush to wait until everything has reached the file.  Appends
+            must all be made from one thread at a time;
+
+            This may be called before or after setNameAndOpen.  Switching back
+            to synchronous writes out anything still queued;
+
+History		17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void LogFile::setAsynchronous(const bool &rAsync, const int &rCapacity)
+{
+    stopWriter();
+
+    mAsync = rAsync;
+    mAsyncCapacity = qMax(1, rCapacity);
+
+    if (mAsync && mFile->isOpen())
+    {
+        startWriter();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name		flush
+
+Purpose		Blocks until everything appended so far has been written to the
+            file;
+
+History		17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void LogFile::flush()
+{
+    if (mWriter)
+    {
+        mWriter->flush();
+    }
+    else
+    {
+        mFile->flush();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name		close
+
+Purpose		Closes the file once everything appended so far has been written;
+
+Notes       When asynchronous this returns straight away, and the file is
+            closed once the writer thread has finished.  In either case
+            closed() is emitted once the file has been closed.  Nothing
+            further should be appended after calling this;
+
+History		17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void LogFile::close()
+{
+    if (mWriter)
+    {
+        connect(mWriter, SIGNAL(finished()), this, SLOT(writerFinished())
+                , Qt::UniqueConnection);
+        mWriter->requestStop();
+        return;
+    }
+
+    mFile->close();
+    emit closed();
+}
+
+/*----------------------------------------------------------------------------
+Name		writerFinished
+
+Purpose		Slot: when the writer thread has finished after a close;
+
+History		17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void LogFile::writerFinished()
+{
+    stopWriter();
+    mFile->close();
+    emit closed();
+}
+
+/*----------------------------------------------------------------------------
+Name		startWriter
+
+Purpose		Starts the writer thread;
+
+History		17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void LogFile::startWriter()
+{
+    stopWriter();
+
+    mWriter = new LogWriter(mFile, mAsyncCapacity, this);
+    mWriter->start();
+}
+
+/*----------------------------------------------------------------------------
+Name		stopWriter
+
+Purpose		Writes any pending records and stops the writer thread;
+
+History		17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void LogFile::stopWriter()
+{
+    if (mWriter)
+    {
+        mWriter->stop();
+        delete mWriter;
+        mWriter = 0;
+    }
 }
 
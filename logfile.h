@@ -13,6 +13,7 @@ History		 11 Jun 16  AFB	Created
 #include <QFile> // HASA - QFile object to stream data to;
 #include <QDateTime> // USES - QDateTime to timestamp the file;
 #include <QDebug>
+#include "logwriter.h" // HASA LogWriter for asynchronous writing;
 
 class LogFile : public QObject
 {
@@ -31,10 +32,39 @@ public:
     // Appends a std::string to the log file;
     void append(const std::string& str);
 
+    // Switches appends between the calling thread and a writer thread;
+    void setAsynchronous(const bool& rAsync, const int& rCapacity = 1024);
+
+    // Blocks until everything appended has been written to the file;
+    void flush(void);
+
+    // Closes the file once everything appended has been written;
+    void close(void);
+
+signals:
+    // Emitted once the file has been closed;
+    void closed(void);
+
+private slots:
+    // Closes the file after the writer thread has finished;
+    void writerFinished(void);
+
 private:
     // Object being written to;
     QFile* mFile;
 
+    // Whether or not appends are handed to a writer thread;
+    bool mAsync;
+    // Number of records which may be waiting for the writer thread;
+    int mAsyncCapacity;
+    // Writer thread, only present when asynchronous and open;
+    LogWriter* mWriter;
+
+    // Starts the writer thread;
+    void startWriter(void);
+    // Writes any pending records and stops the writer thread;
+    void stopWriter(void);
+
 };
 
 #endif // LOGFILE_H
@@ -0,0 +1,307 @@
+/*----------------------------------------------------------------------------
+Name         logwriter.cpp
+
+Purpose      Background thread which drains log records queued by LogFile and
+             writes them to the log file in large batches;
+
+Notes        The producer (the thread calling append) and the writer only take
+             mMutex in order to go to sleep or to wake one another.  Each sets
+             its waiting flag and re-checks the queue while holding the mutex
+             before sleeping, and the other side only takes the mutex if it
+             sees that flag, so a wake-up can not be lost and the common case
+             of a non-empty, non-full queue never blocks;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Count records, bytes, and write errors;
+----------------------------------------------------------------------------*/
+#include "logwriter.h"
+#include "metrics.h" // USES MetricsRegistry to count and time the writes;
+
+namespace
+{
+    // Size of the batch which is built up before being written to the file;
+    const int batch_size_bytes = 64 * 1024;
+
+    // Metrics of the log file writes;
+    struct LogMetrics
+    {
+        LogMetrics()
+        {
+            MetricsRegistry& rRegistry = MetricsRegistry::instance();
+            records = rRegistry.counter("got_log_records_total"
+                                        , "Log records written");
+            bytes = rRegistry.counter("got_log_bytes_total"
+                                      , "Bytes written to log files");
+            errors = rRegistry.counter("got_log_write_errors_total"
+                                       , "Log file writes which failed");
+            writes = rRegistry.histogram("got_log_write_seconds"
+                                         , "Time taken by each write to a"
+                                           " log file");
+        }
+
+        MetricsCounter records; // Records written;
+        MetricsCounter bytes; // Bytes written;
+        MetricsCounter errors; // Writes which failed;
+        MetricsHistogram writes; // Time taken by each write;
+    };
+
+    // Returns the metrics, registering them on first use;
+    const LogMetrics& logMetrics()
+    {
+        static const LogMetrics metrics;
+        return metrics;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         LogWriter
+
+Purpose      Constructor;
+
+Input        pFile              Open file the records will be written to.  The
+                                file must not be used by any other thread
+                                while the writer is running;
+             capacity           Number of records which may be queued before
+                                append blocks;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+LogWriter::LogWriter(QFile *pFile, int capacity, QObject *parent)
+    : QThread(parent)
+    , mFile(pFile)
+    , mRecords(capacity)
+    , mWriterWaiting(false)
+    , mProducerWaiting(false)
+    , mStopping(false)
+    , mQueuedCount(0)
+    , mWrittenCount(0)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         ~LogWriter
+
+Purpose      Destructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+LogWriter::~LogWriter()
+{
+    stop();
+}
+
+/*----------------------------------------------------------------------------
+Name         append
+
+Purpose      Queues a record for the writer thread;
+
+Input        str                The record, without its line separator;
+
+Notes        If the queue is full this blocks until the writer has made room,
+             which bounds the memory held by records waiting to be written;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void LogWriter::append(const QString &str)
+{
+    while (!mRecords.push(str))
+    {
+        QMutexLocker locker(&mMutex);
+        mProducerWaiting = true;
+        if (mRecords.isFull())
+        {
+            mSpaceAvailable.wait(&mMutex);
+        }
+        mProducerWaiting = false;
+    }
+
+    mQueuedCount++;
+
+    if (mWriterWaiting)
+    {
+        QMutexLocker locker(&mMutex);
+        mRecordsAvailable.wakeOne();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         flush
+
+Purpose      Blocks until every record queued so far has been written and the
+             file has been flushed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void LogWriter::flush()
+{
+    const quint64 target = mQueuedCount;
+
+    QMutexLocker locker(&mMutex);
+    while (mWrittenCount < target && isRunning())
+    {
+        mRecordsAvailable.wakeOne();
+        mWritten.wait(&mMutex);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         stop
+
+Purpose      Writes any pending records and stops the writer thread;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void LogWriter::stop()
+{
+    requestStop();
+    wait();
+}
+
+/*----------------------------------------------------------------------------
+Name         requestStop
+
+Purpose      Asks the writer thread to stop once the pending records have
+             been written, without waiting for it to do so.  QThread::finished
+             is emitted when it has;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void LogWriter::requestStop()
+{
+    QMutexLocker locker(&mMutex);
+    mStopping = true;
+    mRecordsAvailable.wakeOne();
+}
+
+/*----------------------------------------------------------------------------
+Name         run
+
+Purpose      Body of the writer thread.  Writes out queued records until
+             stopped, sleeping whenever the queue is empty;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void LogWriter::run()
+{
+    while (true)
+    {
+        drain();
+
+        QMutexLocker locker(&mMutex);
+
+        // Let anyone waiting in flush know how far we have got;
+        mWritten.wakeAll();
+
+        mWriterWaiting = true;
+        if (mRecords.isEmpty())
+        {
+            if (mStopping)
+            {
+                mWriterWaiting = false;
+                break;
+            }
+
+            mRecordsAvailable.wait(&mMutex);
+        }
+        mWriterWaiting = false;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         drain
+
+Purpose      Writes the queued records to the file in batches, then flushes
+             the file;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Write through writeBatch;
+----------------------------------------------------------------------------*/
+void LogWriter::drain()
+{
+    QByteArray batch;
+    batch.reserve(batch_size_bytes);
+
+    QString record;
+    quint64 count = 0;
+    quint64 batchStart = 0; // Value of count when the batch was started;
+
+    while (true)
+    {
+        bool more = mRecords.pop(record);
+
+        if (more)
+        {
+            // Records are encoded as QTextStream would, in the local 8 bit
+            // encoding, followed by the carriage return used by LogFile;
+            batch += record.toLocal8Bit();
+            batch += '\r';
+            count++;
+
+            if (mProducerWaiting)
+            {
+                QMutexLocker locker(&mMutex);
+                mSpaceAvailable.wakeOne();
+            }
+        }
+
+        if (!batch.isEmpty() && (!more || batch.size() >= batch_size_bytes))
+        {
+            writeBatch(mFile, batch, count - batchStart);
+            batch.clear();
+            batchStart = count;
+        }
+
+        if (!more)
+        {
+            break;
+        }
+    }
+
+    if (count > 0)
+    {
+        mFile->flush();
+        mWrittenCount += count;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         writeBatch
+
+Purpose      Writes records, already encoded and separated, to a file and
+             counts them, their bytes, any error, and the time taken in the
+             metrics;
+
+Input        pFile              File to write to;
+             rBatch             The encoded records;
+             rRecords           Number of records in rBatch;
+
+Returns      bool               true -  If the whole batch was written;
+                                false - If not, which is also logged;
+
+History		 17 Oct 26  AFB	Created from drain
+----------------------------------------------------------------------------*/
+bool LogWriter::writeBatch(QFile *pFile
+                           , const QByteArray &rBatch
+                           , const quint64 &rRecords)
+{
+    const LogMetrics& rMetrics = logMetrics();
+
+    qint64 written = 0;
+    {
+        MetricsTimer timer(rMetrics.writes);
+        written = pFile->write(rBatch);
+    }
+
+    if (written != rBatch.size())
+    {
+        rMetrics.errors.increment();
+        qWarning("LogWriter: error writing log file: %s"
+                 , qPrintable(pFile->errorString()));
+    }
+
+    rMetrics.records.increment(rRecords);
+    rMetrics.bytes.increment(static_cast<quint64>(qMax(Q_INT64_C(0)
+                                                       , written)));
+
+    return written == rBatch.size();
+}
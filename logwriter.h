@@ -0,0 +1,71 @@
+/*----------------------------------------------------------------------------
+Name         logwriter.h
+
+Purpose      Background thread which drains log records queued by LogFile and
+             writes them to the log file in large batches;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QThread> // ISA QThread;
+#include <QFile> // USES QFile as the destination of the records;
+#include <QMutex> // HASA QMutex guarding the sleep and wake of both threads;
+#include <QWaitCondition> // HASA QWaitConditions to sleep and wake on;
+#include <atomic> // USES std::atomic for the flags shared between threads;
+#include "spscringbuffer.h" // HASA SpscRingBuffer of pending records;
+
+class LogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    // Constructor;
+    explicit LogWriter(QFile* pFile, int capacity, QObject *parent = 0);
+
+    ~LogWriter(); // Destructor, writes any pending records;
+
+    // Queues a record, blocking while the queue is full;
+    void append(const QString& str);
+
+    // Blocks until every queued record has been written to the file;
+    void flush(void);
+
+    // Asks the thread to stop once pending records are written;
+    void requestStop(void);
+
+    // Writes any pending records and stops the thread;
+    void stop(void);
+
+    // Writes encoded records to a file, counting them in the metrics;
+    static bool writeBatch(QFile* pFile
+                           , const QByteArray& rBatch
+                           , const quint64& rRecords);
+
+protected:
+    void run(); // Body of the writer thread;
+
+private:
+    QFile* mFile; // File the records are written to;
+
+    // Records waiting to be written;
+    SpscRingBuffer<QString> mRecords;
+
+    QMutex mMutex; // Guards the waits on the conditions below;
+    QWaitCondition mRecordsAvailable; // Wakes the writer thread;
+    QWaitCondition mSpaceAvailable; // Wakes a producer waiting on a full queue;
+    QWaitCondition mWritten; // Wakes a producer waiting in flush;
+
+    std::atomic<bool> mWriterWaiting; // The writer is asleep;
+    std::atomic<bool> mProducerWaiting; // The producer is asleep;
+    std::atomic<bool> mStopping; // The writer should exit once drained;
+
+    std::atomic<quint64> mQueuedCount; // Records queued by the producer;
+    std::atomic<quint64> mWrittenCount; // Records written by the writer;
+
+    // Writes out the records currently in the queue;
+    void drain(void);
+};
+
+#endif // LOGWRITER_H
@@ -7,6 +7,9 @@ History		 11 Jun 16  AFB	Created
 -----------------------------------------------------------------------------*/
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "metrics.h"
+#include "sunscan.h"
+#include <limits>
 
 /*----------------------------------------------------------------------------
 Name         MainWindow
@@ -25,8 +28,8 @@ MainWindow::MainWindow(QWidget *parent) :
     setWindowIcon(windowIcon);
 
     // Initialize pointer variables;
-    mSolarCalc = new SolarCalc(this);
     mGotCalc = new GotCalc(this);
+    mJobs = new JobRunner(this);
 
     // Initialize member variables to zero;
     mDefaultSaveLoc = "";
@@ -80,10 +83,43 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->actionHowTo, SIGNAL(triggered()), this, SLOT(howTo()));
     connect(ui->actionOptions, SIGNAL(triggered()), this, SLOT(options()));
     connect(ui->actionAbout, SIGNAL(triggered()), this, SLOT(about()));
+    connect(ui->actionImportSolarFlux, SIGNAL(triggered())
+            , this, SLOT(importSolarFlux()));
+    connect(ui->actionFitSunScan, SIGNAL(triggered())
+            , this, SLOT(fitSunScan()));
+    connect(ui->actionExportMetrics, SIGNAL(triggered())
+            , this, SLOT(exportMetrics()));
+    connect(ui->dateEdit, SIGNAL(dateChanged(QDate))
+            , this, SLOT(fillSolarFlux()));
+
+    // Keep a displayed solar position up to date as its inputs are edited;
+    connect(ui->lineEditLatitude, SIGNAL(textEdited(QString))
+            , this, SLOT(solarInputsChanged()));
+    connect(ui->lineEditLongitude, SIGNAL(textEdited(QString))
+            , this, SLOT(solarInputsChanged()));
+    connect(ui->timeEdit, SIGNAL(timeChanged(QTime))
+            , this, SLOT(solarInputsChanged()));
+    connect(ui->dateEdit, SIGNAL(dateChanged(QDate))
+            , this, SLOT(solarInputsChanged()));
+    connect(ui->checkBoxIsDaylightSavings, SIGNAL(toggled(bool))
+            , this, SLOT(solarInputsChanged()));
+
+    // Results and progress of the calculations running in the background;
+    connect(mJobs, SIGNAL(started(int)), this, SLOT(jobStarted(int)));
+    connect(mJobs, SIGNAL(progress(int,int,int))
+            , this, SLOT(jobProgress(int,int,int)));
+    connect(mJobs, SIGNAL(finished(int,QVariant))
+            , this, SLOT(jobFinished(int,QVariant)));
 
     // Load the settings, in this case the default save directory;
     loadSettings();
 
+    // Open the flux database, if one has been imported;
+    if (QFile::exists(fluxDatabaseName()))
+    {
+        mFluxDatabase.open(fluxDatabaseName());
+    }
+
 }
 
 /*----------------------------------------------------------------------------
@@ -96,7 +132,10 @@ History		 29 Jun 16  AFB	Created
 MainWindow::~MainWindow()
 {
     // All objects on the heap are QObject type and will be handled
-    // automatically;
+    // automatically.  The jobs are stopped first, as their results would
+    // otherwise be delivered to a half-destroyed window, and a sun scan fit
+    // must finish before the pool it runs on is destroyed;
+    delete mJobs;
     delete ui;
 }
 
@@ -108,33 +147,55 @@ Purpose      Calculates the values of the Solar Altitude and Elevation which
              directly;
 
 History		 29 Jun 16  AFB	Created
+             17 Oct 26  AFB Calculate on a worker thread;
 ----------------------------------------------------------------------------*/
 void MainWindow::calculateSolarAzAlt()
 {
-    // Set the longitude and latitude of the SolarCalc object to that which
-    // was entered by the user;
-    mSolarCalc->setLatitude(ui->lineEditLatitude->text().toDouble());
-    mSolarCalc->setLongitude(ui->lineEditLongitude->text().toDouble());
-
-    // QTime and QDate objects to pass to the mSolarCalc object;
-    QTime rTime(ui->timeEdit->time());
-    QDate rDate(ui->dateEdit->date());
-
-    // Set the Time, Date, and whether or not it is currently Daylight Savings
-    // Time, in the mSolarCalc object;
-    mSolarCalc->setTime(rTime);
-    mSolarCalc->setDate(rDate);
-    mSolarCalc->setDaylightSavings(ui->checkBoxIsDaylightSavings->isChecked());
-
-    // Issue the calculate command.  This calculates the azimuth and altitude
-    // of the Sun;
-    mSolarCalc->calculate();
-
-    // Get the resulting Azimuth and Altitude from the mSolarCalc object;
-    ui->lineEditSolarAltitude->setText(
-                QString::number(mSolarCalc->getSolarAltitude()));
-    ui->lineEditSolarAzimuth->setText(
-                QString::number(mSolarCalc->getSolarAzimuth()));
+    // Copy the latitude, longitude, time, date, and whether or not it is
+    // currently Daylight Savings Time entered by the user.  The job must not
+    // touch the widgets, as it runs on another thread;
+    const double latitude = ui->lineEditLatitude->text().toDouble();
+    const double longitude = ui->lineEditLongitude->text().toDouble();
+    const QTime time(ui->timeEdit->time());
+    const QDate date(ui->dateEdit->date());
+    const bool dst = ui->checkBoxIsDaylightSavings->isChecked();
+
+    // Calculate the azimuth and altitude of the Sun.  A job already running
+    // is superseded by this one;
+    mJobs->submit(SolarJob, [=](JobControl&) -> QVariant
+    {
+        SolarCalc solarCalc(latitude, longitude, time, date, dst);
+        solarCalc.calculate();
+
+        QVariantMap result;
+        result.insert("altitude", solarCalc.getSolarAltitude());
+        result.insert("azimuth", solarCalc.getSolarAzimuth());
+        return result;
+    });
+}
+
+/*----------------------------------------------------------------------------
+Name         solarInputsChanged
+
+Purpose      Recalculates the solar position when the latitude, longitude,
+             time, date, or daylight savings are changed, once a position has
+             been calculated;
+
+Notes        Edits may come faster than the positions are calculated.  Each
+             supersedes the last, so only the latest is worked out;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void MainWindow::solarInputsChanged()
+{
+    if (ui->lineEditSolarAltitude->text().isEmpty()
+            || !ui->lineEditLatitude->hasAcceptableInput()
+            || !ui->lineEditLongitude->hasAcceptableInput())
+    {
+        return;
+    }
+
+    calculateSolarAzAlt();
 }
 
 /*----------------------------------------------------------------------------
@@ -143,6 +204,10 @@ Name         calculateGot
 Purpose      Calculates the Gain Over Temperature;
 
 History		 29 Jun 16  AFB	Created
+             17 Oct 26  AFB Calculate on a worker thread, and read the cold
+                            measurements from all three fields rather than
+                            the second one three times;
+             17 Oct 26  AFB Return the inputs needed by the session catalog;
 ----------------------------------------------------------------------------*/
 void MainWindow::calculateGot()
 {
@@ -160,31 +225,251 @@ void MainWindow::calculateGot()
     // and the Solar Flux values entered by the user give us our y coordinates;
     setFrequencies();
 
-    // Clear the hot and cold measurement vectors;
-    mGotCalc->clearHotMeasurments();
-    mGotCalc->clearColdMeasurments();
+    // Copy everything the calculation needs, as the job runs on another
+    // thread and must not touch the widgets;
+    const double operatingFrequency
+            = ui->lineEditAntennaFrequency->text().toDouble();
+    const double lowerFrequency = mLowerFreq;
+    const double higherFrequency = mUpperFreq;
+
+    std::vector<double> hot;
+    hot.push_back(ui->lineEditHot1->text().toDouble());
+    hot.push_back(ui->lineEditHot2->text().toDouble());
+    hot.push_back(ui->lineEditHot3->text().toDouble());
+
+    std::vector<double> cold;
+    cold.push_back(ui->lineEditCold1->text().toDouble());
+    cold.push_back(ui->lineEditCold2->text().toDouble());
+    cold.push_back(ui->lineEditCold3->text().toDouble());
+
+    // Our y values for exponential interpolation;
+    const double solarFluxHigh = ui->lineEditSolarFluxHigh->text().toDouble();
+    const double solarFluxLow = ui->lineEditSolarFluxLow->text().toDouble();
+
+    // The antenna beamwidth;
+    const double beamwidth = ui->lineEditBeamWidth->text().toDouble();
+
+    // What the session catalog records alongside the result;
+    const QString antenna = ui->lineEditAntennaName->text().trimmed();
+    const QDateTime measuredAt(ui->dateEdit->date(), ui->timeEdit->time());
+    bool latitudeOk = false;
+    bool longitudeOk = false;
+    const double latitude = ui->lineEditLatitude->text().toDouble(&latitudeOk);
+    const double longitude
+            = ui->lineEditLongitude->text().toDouble(&longitudeOk);
+    const double unknown = std::numeric_limits<double>::quiet_NaN();
+
+    // Calculate our Gain Over Temperature value.  A job already running is
+    // superseded by this one;
+    mJobs->submit(GotJob, [=](JobControl&) -> QVariant
+    {
+        GotCalc gotCalc(0);
+        gotCalc.setOperatingFrequency(operatingFrequency);
+        gotCalc.setLowerFrequency(lowerFrequency);
+        gotCalc.setHigherFrequency(higherFrequency);
+
+        for (size_t i = 0; i < hot.size(); i++)
+        {
+            gotCalc.addHotMeasurement(hot[i]);
+        }
+
+        for (size_t i = 0; i < cold.size(); i++)
+        {
+            gotCalc.addColdMeasurement(cold[i]);
+        }
+
+        gotCalc.setSolarFluxHigh(solarFluxHigh);
+        gotCalc.setSolarFluxLow(solarFluxLow);
+        gotCalc.setBeamwidth(beamwidth);
+
+        gotCalc.calculate();
+
+        const GotUncertaintyInputs inputs = gotCalc.getUncertaintyInputs(0, 0);
+        QVariantMap result;
+        result["got"] = gotCalc.getGotRatiodB();
+        result["hot"] = inputs.hotMeanDb;
+        result["cold"] = inputs.coldMeanDb;
+        result["flux"] = inputs.solarFluxSfu;
+        result["antenna"] = antenna;
+        result["measuredAt"] = measuredAt;
+        result["frequency"] = operatingFrequency;
+        result["beamwidth"] = beamwidth;
+        result["latitude"] = latitudeOk ? latitude : unknown;
+        result["longitude"] = longitudeOk ? longitude : unknown;
+        return result;
+    });
+}
+
+/*----------------------------------------------------------------------------
+Name         jobFinished
+
+Purpose      Displays the result of a calculation which has finished running
+             in the background;
+
+Input        channel            Which calculation finished;
+             rResult            Its result;
+
+History		 17 Oct 26  AFB	Created from calculateSolarAzAlt and
+                            calculateGot
+             17 Oct 26  AFB Record G/T results in the session catalog;
+             17 Oct 26  AFB Fill in the fields from a fitted sun scan;
+----------------------------------------------------------------------------*/
+void MainWindow::jobFinished(int channel, const QVariant &rResult)
+{
+    if (channel == SolarJob)
+    {
+        // Display the resulting Azimuth and Altitude;
+        const QVariantMap result = rResult.toMap();
+        ui->lineEditSolarAltitude->setText(
+                    QString::number(result.value("altitude").toDouble()));
+        ui->lineEditSolarAzimuth->setText(
+                    QString::number(result.value("azimuth").toDouble()));
+    }
+    else if (channel == GotJob)
+    {
+        // Display the Gain Over Temperature to the user;
+        const QVariantMap result = rResult.toMap();
+        ui->lineEditGotOutput->setText(
+                    QString::number(result.value("got").toDouble()));
+
+        // Every computed session is kept in the catalog;
+        catalogSession(result);
+    }
+    else if (channel == FluxImportJob)
+    {
+        // Map the new database, whether or not the import worked, as the old
+        // one was let go of when the import started;
+        const QVariantMap result = rResult.toMap();
+        if (QFile::exists(fluxDatabaseName()))
+        {
+            mFluxDatabase.open(fluxDatabaseName());
+        }
+
+        if (!result.value("ok").toBool())
+        {
+            QMessageBox::critical(this, "Critical"
+                                  , result.value("error").toString());
+        }
+        else
+        {
+            ui->statusBar->showMessage(
+                        tr("Imported solar flux for %1 days")
+                        .arg(result.value("days").toInt()), 5000);
+            fillSolarFlux();
+            return;
+        }
+    }
+
+    else if (channel == SunScanJob)
+    {
+        const QVariantMap result = rResult.toMap();
+        if (!result.value("ok").toBool())
+        {
+            QMessageBox::critical(this, "Critical"
+                                  , result.value("error").toString());
+        }
+        else
+        {
+            // The fitted beam stands in for the typed in beamwidth and
+            // measurements;
+            const QString peak = QString::number(result.value("peak")
+                                                 .toDouble());
+            const QString baseline = QString::number(result.value("baseline")
+                                                     .toDouble());
+            ui->lineEditBeamWidth->setText(
+                        QString::number(result.value("beamwidth").toDouble()));
+            ui->lineEditHot1->setText(peak);
+            ui->lineEditHot2->setText(peak);
+            ui->lineEditHot3->setText(peak);
+            ui->lineEditCold1->setText(baseline);
+            ui->lineEditCold2->setText(baseline);
+            ui->lineEditCold3->setText(baseline);
+
+            ui->statusBar->showMessage(
+                        tr("Sun scan: beamwidth %1 +/- %2 deg, rise %3 dB,"
+                           " pointing off by %4 deg az, %5 deg el")
+                        .arg(result.value("beamwidth").toDouble(), 0, 'f', 3)
+                        .arg(result.value("beamwidthError").toDouble()
+                             , 0, 'f', 3)
+                        .arg(result.value("rise").toDouble(), 0, 'f', 2)
+                        .arg(result.value("azimuthOffset").toDouble()
+                             , 0, 'f', 3)
+                        .arg(result.value("elevationOffset").toDouble()
+                             , 0, 'f', 3));
+            return;
+        }
+    }
+
+    if (!mJobs->isBusy(SolarJob) && !mJobs->isBusy(GotJob)
+            && !mJobs->isBusy(FluxImportJob) && !mJobs->isBusy(SunScanJob))
+    {
+        ui->statusBar->clearMessage();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         jobStarted
+
+Purpose      Shows, in the status bar, that a calculation is running;
+
+Input        channel            Which calculation started;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void MainWindow::jobStarted(int channel)
+{
+    if (channel == FluxImportJob)
+    {
+        ui->statusBar->showMessage(tr("Importing solar flux..."));
+        return;
+    }
+
+    if (channel == SunScanJob)
+    {
+        ui->statusBar->showMessage(tr("Fitting sun scan..."));
+        return;
+    }
 
-    // Add all of the user-entered measurements into the approprate vectors;
-    mGotCalc->addHotMeasurement(ui->lineEditHot1->text().toDouble());
-    mGotCalc->addHotMeasurement(ui->lineEditHot2->text().toDouble());
-    mGotCalc->addHotMeasurement(ui->lineEditHot3->text().toDouble());
+    ui->statusBar->showMessage(channel == SolarJob
+                               ? tr("Calculating solar position...")
+                               : tr("Calculating Gain Over Temperature..."));
+}
 
-    mGotCalc->addColdMeasurement(ui->lineEditCold2->text().toDouble());
-    mGotCalc->addColdMeasurement(ui->lineEditCold2->text().toDouble());
-    mGotCalc->addColdMeasurement(ui->lineEditCold2->text().toDouble());
+/*----------------------------------------------------------------------------
+Name         jobProgress
+
+Purpose      Shows, in the status bar, how far a calculation has got;
+
+Input        channel            Which calculation reported;
+             done               Steps done so far;
+             total              Steps in all;
 
-    // Set our y values for exponential interpolation;
-    mGotCalc->setSolarFluxHigh(ui->lineEditSolarFluxHigh->text().toDouble());
-    mGotCalc->setSolarFluxLow(ui->lineEditSolarFluxLow->text().toDouble());
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Label solar flux imports;
+             17 Oct 26  AFB Label sun scan fits;
+----------------------------------------------------------------------------*/
+void MainWindow::jobProgress(int channel, int done, int total)
+{
+    const int percent = (total > 0) ? (100 * done / total) : 0;
 
-    // Set the antenna beamwidth;
-    mGotCalc->setBeamwidth(ui->lineEditBeamWidth->text().toDouble());
+    if (channel == FluxImportJob)
+    {
+        ui->statusBar->showMessage(tr("Importing solar flux... %1%")
+                                   .arg(percent));
+        return;
+    }
 
-    // Call the calculate, which will produce our Gain Over Temperature value;
-    mGotCalc->calculate();
+    if (channel == SunScanJob)
+    {
+        ui->statusBar->showMessage(tr("Fitting sun scan... %1%")
+                                   .arg(percent));
+        return;
+    }
 
-    // Display that value to the user;
-    ui->lineEditGotOutput->setText(QString::number(mGotCalc->getGotRatiodB()));
+    ui->statusBar->showMessage((channel == SolarJob
+                                ? tr("Calculating solar position... %1%")
+                                : tr("Calculating Gain Over Temperature..."
+                                     " %1%")).arg(percent));
 }
 
 /*----------------------------------------------------------------------------
@@ -195,6 +480,8 @@ Purpose      Evaluates the operational frequency entered by the user against
              flux.
 
 History		 10 Jul 16  AFB	Created
+             17 Oct 26  AFB Moved the search into
+                            GotCalc::findBracketingFrequencies;
 ----------------------------------------------------------------------------*/
 void MainWindow::setFrequencies()
 {
@@ -209,11 +496,14 @@ void MainWindow::setFrequencies()
     // The frequency which was entered by the user;
     double targetFrequency = ui->lineEditAntennaFrequency->text().toDouble();
 
-    // If the frequency entered by the user is less than the minimum frequency
-    // for which we're able to obtain solar flux data, or greater than the
-    // largest frequency for which we're able to obtain solar flux data;
-    if (targetFrequency < frequencyList.at(0)
-            || targetFrequency > frequencyList.at(frequencyList.size() - 1))
+    // Find the frequencies either side of the one entered by the user.  This
+    // fails if the frequency entered by the user is less than the minimum
+    // frequency for which we're able to obtain solar flux data, or greater
+    // than the largest frequency for which we're able to obtain solar flux
+    // data;
+    if (!GotCalc::findBracketingFrequencies(targetFrequency
+                                            , lowerFrequency
+                                            , higherFrequency))
     {
         // Explain that the user's value is out of bounds, giving them the
         // boundaries within which they can entered a frequency;
@@ -231,27 +521,6 @@ void MainWindow::setFrequencies()
         return;
     }
 
-    // Loop through the available frequencies;
-    for (size_t i = 0; i < frequencyList.size(); i++)
-    {
-        // If the frequency entered by the user is less than a given frequency
-        // and the higher frequency has yet to be changed (still equals zero)
-        // then that frequency equals the upper bounds;
-        if (targetFrequency < frequencyList.at(i) && higherFrequency == 0)
-        {
-            // Set the higher frequency;
-            higherFrequency = frequencyList.at(i);
-            // If the higher frequency has been set, then the lower frequency
-            // is obviously the frequency before it (given an ordered list);
-            if (higherFrequency != 0)
-            {
-                // Keep in mind that the bounds error has already been prevented
-                // two 'if' statements ago;
-                lowerFrequency = frequencyList.at(i - 1);
-            }
-        }
-    }
-
     // Set the Labels to let the user know which Solar Flux values they should
     // inquire about;
     ui->labelSolarFluxUpper->setText(
@@ -267,6 +536,176 @@ void MainWindow::setFrequencies()
     // Set the member variables for future use;
     mUpperFreq = higherFrequency;
     mLowerFreq = lowerFrequency;
+
+    // Fill in the flux at the new frequencies, if the database has it;
+    fillSolarFlux();
+}
+
+/*----------------------------------------------------------------------------
+Name         fillSolarFlux
+
+Purpose      Fills in the Solar Flux fields with the fluxes observed, on the
+             date entered, at the frequencies either side of the operating
+             frequency.  The fields are left alone if the flux database has
+             no observation for that day;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void MainWindow::fillSolarFlux()
+{
+    if (!mFluxDatabase.isOpen() || mLowerFreq <= 0 || mUpperFreq <= 0)
+    {
+        return;
+    }
+
+    double lowerFlux = 0;
+    double higherFlux = 0;
+    const QDate date = ui->dateEdit->date();
+
+    if (!mFluxDatabase.getFlux(date, mLowerFreq, lowerFlux)
+            || !mFluxDatabase.getFlux(date, mUpperFreq, higherFlux))
+    {
+        ui->statusBar->showMessage(tr("No solar flux on record for %1")
+                                   .arg(date.toString()), 5000);
+        return;
+    }
+
+    ui->lineEditSolarFluxLow->setText(QString::number(lowerFlux));
+    ui->lineEditSolarFluxHigh->setText(QString::number(higherFlux));
+}
+
+/*----------------------------------------------------------------------------
+Name         fitSunScan
+
+Purpose      Asks for a raster scan of the sun and fits the beam to it in the
+             background, to fill in the beamwidth and the hot and cold
+             measurements;
+
+Notes        The size of the radio sun taken out of the beam depends on the
+             frequency, so the antenna frequency must be entered first;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Fit on the window's pool;
+----------------------------------------------------------------------------*/
+void MainWindow::fitSunScan()
+{
+    if (ui->lineEditAntennaFrequency->text().isEmpty())
+    {
+        QMessageBox::critical(this, "Critical"
+                 , "Enter the antenna frequency before fitting a sun scan.");
+        return;
+    }
+
+    const QString filename = QFileDialog::getOpenFileName(this
+           , tr("Fit Sun Scan")
+           , QStandardPaths::displayName(QStandardPaths::DocumentsLocation)
+           , "Sun Scans (*.csv *.txt);;All Files (*)");
+
+    if (filename.isEmpty())
+    {
+        return;
+    }
+
+    const double frequency = ui->lineEditAntennaFrequency->text().toDouble();
+
+    // Every fit shares the window's pool, rather than starting threads of
+    // its own;
+    WorkStealingPool* pPool = &mScanPool;
+
+    mJobs->submit(SunScanJob, [=](JobControl&) -> QVariant
+    {
+        QVariantMap result;
+        QString error;
+        SunScanRaster raster;
+        SunScanFit fit;
+
+        SunScan scan(pPool);
+        const bool ok = SunScan::readRaster(filename, raster, error)
+                && scan.fit(raster, frequency, fit);
+
+        result.insert("ok", ok);
+        result.insert("error", error.isEmpty() ? scan.getLastError() : error);
+        if (ok)
+        {
+            result.insert("beamwidth", fit.beamwidthDeg);
+            result.insert("beamwidthError", fit.beamwidthUncertaintyDeg);
+            result.insert("peak", fit.peakDb);
+            result.insert("baseline", fit.baselineDb);
+            result.insert("rise", fit.sunNoiseRiseDb);
+            result.insert("azimuthOffset", fit.azimuthOffsetDeg);
+            result.insert("elevationOffset", fit.elevationOffsetDeg);
+        }
+        return result;
+    });
+}
+
+/*----------------------------------------------------------------------------
+Name         exportMetrics
+
+Purpose      Asks for a file name and writes a snapshot of the calculation and
+             logging metrics to it, as JSON or as Prometheus text;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void MainWindow::exportMetrics()
+{
+    const QString filename = QFileDialog::getSaveFileName(this
+           , tr("Export Metrics")
+           , QStandardPaths::displayName(QStandardPaths::DocumentsLocation)
+             + "/got-metrics.prom"
+           , "Prometheus Text (*.prom);;JSON (*.json)");
+
+    if (filename.isEmpty())
+    {
+        return;
+    }
+
+    QString error;
+    if (!MetricsRegistry::instance().write(filename, error))
+    {
+        QMessageBox::critical(this, "Critical", error);
+        return;
+    }
+
+    ui->statusBar->showMessage(tr("Metrics written to %1").arg(filename)
+                               , 5000);
+}
+
+/*----------------------------------------------------------------------------
+Name         importSolarFlux
+
+Purpose      Asks for observatory flux files and imports them into the flux
+             database, in the background;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void MainWindow::importSolarFlux()
+{
+    const QStringList files = QFileDialog::getOpenFileNames(this
+           , tr("Import Solar Flux Files")
+           , QStandardPaths::displayName(QStandardPaths::DocumentsLocation)
+           , "Solar Flux Files (*.txt *.csv);;All Files (*)");
+
+    if (files.isEmpty())
+    {
+        return;
+    }
+
+    // The database is replaced by the import, so let go of the old one;
+    mFluxDatabase.close();
+
+    const QString databaseName = fluxDatabaseName();
+    mJobs->submit(FluxImportJob, [=](JobControl&) -> QVariant
+    {
+        QString error;
+        int days = 0;
+        QVariantMap result;
+        result.insert("ok", SolarFluxDatabase::import(files, databaseName
+                                                      , error, &days));
+        result.insert("error", error);
+        result.insert("days", days);
+        return result;
+    });
 }
 
 /*----------------------------------------------------------------------------
@@ -276,6 +715,7 @@ Purpose      Produces an output file of the data gathered through the Gain Over
              Temperature and Solar Azimuth/Altitude calculations;
 
 History		 11 Jul 16  AFB	Created
+             17 Oct 26  AFB Write the log file asynchronously;
 ----------------------------------------------------------------------------*/
 void MainWindow::save()
 {
@@ -324,8 +764,10 @@ void MainWindow::save()
         return;
     }
 
-    // Create a new LogFile object;
+    // Create a new LogFile object.  Records are written by a background
+    // thread so that a slow disk does not hold up the window;
     mLogFile = new LogFile(this);
+    mLogFile->setAsynchronous(true);
 
     // Open the Log File using the user-provided filename;
     mLogFile->setNameAndOpen(filename);
@@ -397,6 +839,12 @@ void MainWindow::save()
                     "Gain Over Temperature: "
                     + ui->lineEditGotOutput->text());
     }
+
+    // The records are written out in the background.  Once they have all
+    // been written the file is closed and the LogFile object released;
+    connect(mLogFile, SIGNAL(closed()), mLogFile, SLOT(deleteLater()));
+    mLogFile->close();
+    mLogFile = 0;
 }
 
 /*----------------------------------------------------------------------------
@@ -493,3 +941,97 @@ void MainWindow::loadSettings()
         mDefaultSaveLoc = settings.value("DefaultSaveLoc").toString();
     }
 }
+
+/*----------------------------------------------------------------------------
+Name         catalogName
+
+Purpose      Returns the name of the session catalog file.  This is the
+             "SessionCatalog" setting if there is one, otherwise
+             sessions.sqlite in the application's data directory;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString MainWindow::catalogName()
+{
+    // Access the global settings;
+    QCoreApplication::setOrganizationName("RV");
+    QCoreApplication::setApplicationName("Got");
+    QSettings settings;
+
+    if (settings.contains("SessionCatalog"))
+    {
+        return settings.value("SessionCatalog").toString();
+    }
+
+    const QString directory = QStandardPaths::writableLocation(
+                QStandardPaths::AppDataLocation);
+    QDir().mkpath(directory);
+    return directory + "/sessions.sqlite";
+}
+
+/*----------------------------------------------------------------------------
+Name         catalogSession
+
+Purpose      Adds the result of a G Over T calculation to the session
+             catalog, opening the catalog the first time;
+
+Input        rResult            Result of the G Over T job;
+
+Notes        A catalog which cannot be opened or written to is reported in
+             the status bar only, as the result itself is still good;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void MainWindow::catalogSession(const QVariantMap &rResult)
+{
+    if (!mCatalog.isOpen() && !mCatalog.open(catalogName()))
+    {
+        ui->statusBar->showMessage(mCatalog.getLastError(), 5000);
+        return;
+    }
+
+    CatalogSession session;
+    session.antenna = rResult.value("antenna").toString();
+    session.measuredAt = rResult.value("measuredAt").toDateTime();
+    session.frequencyMHz = rResult.value("frequency").toDouble();
+    session.beamwidthDeg = rResult.value("beamwidth").toDouble();
+    session.solarFluxSfu = rResult.value("flux").toDouble();
+    session.hotDb = rResult.value("hot").toDouble();
+    session.coldDb = rResult.value("cold").toDouble();
+    session.gotDb = rResult.value("got").toDouble();
+    session.latitude = rResult.value("latitude").toDouble();
+    session.longitude = rResult.value("longitude").toDouble();
+    session.source = "got";
+
+    if (!mCatalog.insert(session))
+    {
+        ui->statusBar->showMessage(mCatalog.getLastError(), 5000);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         fluxDatabaseName
+
+Purpose      Returns the name of the flux database file.  This is the
+             "FluxDatabase" setting if there is one, otherwise solarflux.gfx
+             in the application's data directory;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString MainWindow::fluxDatabaseName()
+{
+    // Access the global settings;
+    QCoreApplication::setOrganizationName("RV");
+    QCoreApplication::setApplicationName("Got");
+    QSettings settings;
+
+    if (settings.contains("FluxDatabase"))
+    {
+        return settings.value("FluxDatabase").toString();
+    }
+
+    const QString directory = QStandardPaths::writableLocation(
+                QStandardPaths::AppDataLocation);
+    QDir().mkpath(directory);
+    return directory + "/solarflux.gfx";
+}
@@ -12,11 +12,15 @@ History		 11 Jun 16  AFB	Created
 #include <QValidator> // USES QValidators to validate user inputs;
 #include <QMessageBox> // USES QMessageBox to alert users of program events;
 #include "gotcalc.h" // HASA GotCalc member for calulating G Over T;
-#include "solarcalc.h" // HASA SolarCalc member for calculating Solar position;
+#include "solarcalc.h" // USES SolarCalc for calculating Solar position;
 #include "howto.h" // HASA HowTo to display the 'How To' Dialog;
 #include "optionmenu.h" // HASA OptionMenu for providing user options;
 #include "about.h" // HASA About page;
 #include "logfile.h" // HASA LogFile for logging calculations;
+#include "jobrunner.h" // HASA JobRunner to calculate off the GUI thread;
+#include "solarfluxdatabase.h" // HASA SolarFluxDatabase to fill in the flux;
+#include "sessioncatalog.h" // HASA SessionCatalog of computed sessions;
+#include "workstealingpool.h" // HASA WorkStealingPool to fit sun scans on;
 
 namespace Ui {
 class MainWindow;
@@ -33,7 +37,23 @@ public:
 private slots:    
     void calculateSolarAzAlt(); // Calculates the Solar Azimuth and Altitude;
     void calculateGot(); // Calculates Gain Over Temperature;
+    // Recalculates the solar position, if shown, when its inputs change;
+    void solarInputsChanged();
+    // Displays the result of a finished calculation;
+    void jobFinished(int channel, const QVariant& rResult);
+    // Shows that a calculation is running;
+    void jobStarted(int channel);
+    // Shows the progress of a running calculation;
+    void jobProgress(int channel, int done, int total);
     void setFrequencies(); // Used for interpolating data points;
+    // Fills in the Solar Flux fields from the flux database, if it can;
+    void fillSolarFlux();
+    // Imports observatory flux files into the flux database;
+    void importSolarFlux();
+    // Measures the beamwidth and sun noise rise from a raster scan file;
+    void fitSunScan();
+    // Writes the calculation and logging metrics to a file;
+    void exportMetrics();
     void save(); // Saves Log Files;
     void howTo(); // Opens a How To window;
     void options(); // Opens an Options Menu Window;
@@ -42,11 +62,14 @@ private slots:
 private:
     Ui::MainWindow *ui; // UI object;
     GotCalc* mGotCalc; // Used for Calculating Gain Over Temperature;
-    SolarCalc* mSolarCalc; // Used for Calculating Solar Position;
+    JobRunner* mJobs; // Runs the solar and G Over T calculations;
     HowTo* mHowTo; // 'How To' Dialog;
     OptionMenu* mOptions; // Options Menu Dialog;
     About* mAbout; // About page Dialog;
     LogFile* mLogFile; // Used for Logging;
+    SolarFluxDatabase mFluxDatabase; // Observed solar flux, by day;
+    SessionCatalog mCatalog; // Every G Over T session computed;
+    WorkStealingPool mScanPool; // Threads the sun scan fits are run on;
 
     QDoubleValidator mLatValid; // Validates the Latitude input;
     QDoubleValidator mLonValid; // Validates the Longitude input;
@@ -59,8 +82,21 @@ private:
     double mUpperFreq; // Upper frequency used for data interpolation;
     double mLowerFreq; // Lower frequency used for data interpolation;
 
+    // Channels on which the calculations are run;
+    enum JobChannel
+    {
+        SolarJob,
+        GotJob,
+        FluxImportJob,
+        SunScanJob
+    };
+
     bool checkGotFields(void); // Ensures completion of G Over T fields;
     void loadSettings(void); // Loads settings;
+    QString fluxDatabaseName(void); // Returns the flux database file name;
+    QString catalogName(void); // Returns the session catalog file name;
+    // Adds a G Over T result to the session catalog;
+    void catalogSession(const QVariantMap& rResult);
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,758 @@
+/*----------------------------------------------------------------------------
+Name         metrics.cpp
+
+Purpose      Registry of counters and latency histograms for the stages of the
+             calculations and of logging, exported on demand as a Prometheus
+             text file or as JSON;
+
+Notes        Every thread which records a metric has its own shard of values,
+             so recording takes no lock and touches no cache line shared with
+             another thread.  Only the owning thread writes to a shard, with
+             a relaxed load and store rather than a locked add.  A snapshot
+             adds up the shards while holding the registry's mutex, which is
+             otherwise only taken to register a metric or when a thread first
+             records or exits;
+
+             When a thread exits its shard is folded into the retired totals,
+             so counters never go backwards however many threads come and go;
+
+             Metrics are meant to be registered once, into a function's static
+             local, and then used from any thread:
+
+                 static const MetricsCounter calls = MetricsRegistry::instance()
+                         .counter("got_calls_total", "Calls made");
+                 calls.increment();
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "metrics.h"
+
+#include <QMutexLocker>
+#include <QStringList>
+#include <QSaveFile> // USES QSaveFile so a scraper never sees half a file;
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTextStream>
+
+namespace
+{
+    // Upper bound of the first histogram bucket;
+    const qint64 first_bucket_ns = 100;
+
+    // Returns the bucket of a latency;
+    int bucketOf(const qint64& rNanoseconds)
+    {
+        if (rNanoseconds <= first_bucket_ns)
+        {
+            return 0;
+        }
+
+        // Bucket k covers (100 * 2^(k-1), 100 * 2^k] ns;
+        const quint64 units = (rNanoseconds + first_bucket_ns - 1)
+                / first_bucket_ns;
+        const int bucket = 64 - qCountLeadingZeroBits(units - 1);
+        return qMin(bucket, metrics_histogram_buckets);
+    }
+
+    // Returns the upper bound of a finite bucket, in seconds;
+    double bucketBound(const int& rBucket)
+    {
+        return first_bucket_ns * 1e-9 * static_cast<double>(1ULL << rBucket);
+    }
+
+    // Adds to a value owned by the calling thread;
+    inline void add(std::atomic<quint64>& rValue, const quint64& rAmount)
+    {
+        rValue.store(rValue.load(std::memory_order_relaxed) + rAmount
+                     , std::memory_order_relaxed);
+    }
+
+    // Returns the Prometheus label set, with any extra label, e.g. {a="b"};
+    QString labelSet(const QString& rName
+                     , const QString& rValue
+                     , const QString& rExtra = QString())
+    {
+        QStringList labels;
+        if (!rName.isEmpty())
+        {
+            QString value = rValue;
+            value.replace("\\", "\\\\").replace("\"", "\\\"")
+                    .replace("\n", "\\n");
+            labels << rName + "=\"" + value + "\"";
+        }
+        if (!rExtra.isEmpty())
+        {
+            labels << rExtra;
+        }
+
+        return labels.isEmpty() ? QString() : "{" + labels.join(",") + "}";
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         ShardOwner
+
+Purpose      Owns the calling thread's shard, attaching it to the registry when
+             created and retiring it when the thread exits;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+class MetricsRegistry::ShardOwner
+{
+public:
+    ShardOwner() : mpShard(new Shard)
+    {
+        MetricsRegistry::instance().attach(mpShard);
+    }
+
+    ~ShardOwner()
+    {
+        MetricsRegistry::instance().detach(mpShard);
+        delete mpShard;
+    }
+
+    Shard* mpShard; // The thread's shard;
+};
+
+/*----------------------------------------------------------------------------
+Name         MetricsCounter
+
+Purpose      Constructors;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+MetricsCounter::MetricsCounter()
+    : mIndex(-1)
+{
+}
+
+MetricsCounter::MetricsCounter(int index)
+    : mIndex(index)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         increment
+
+Purpose      Adds to the calling thread's value of the counter;
+
+Input        rAmount            Amount to add;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void MetricsCounter::increment(const quint64 &rAmount) const
+{
+    if (mIndex >= 0)
+    {
+        add(MetricsRegistry::localShard()->counters[mIndex], rAmount);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         isValid
+
+Purpose      Returns whether or not the counter was registered;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool MetricsCounter::isValid() const
+{
+    return mIndex >= 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         MetricsHistogram
+
+Purpose      Constructors;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+MetricsHistogram::MetricsHistogram()
+    : mIndex(-1)
+{
+}
+
+MetricsHistogram::MetricsHistogram(int index)
+    : mIndex(index)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         observe
+
+Purpose      Records a latency in the calling thread's buckets;
+
+Input        rNanoseconds       The latency;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void MetricsHistogram::observe(const qint64 &rNanoseconds) const
+{
+    if (mIndex < 0)
+    {
+        return;
+    }
+
+    MetricsRegistry::Shard* pShard = MetricsRegistry::localShard();
+    add(pShard->buckets[mIndex][bucketOf(rNanoseconds)], 1);
+    add(pShard->sums[mIndex], static_cast<quint64>(qMax(Q_INT64_C(0)
+                                                        , rNanoseconds)));
+}
+
+/*----------------------------------------------------------------------------
+Name         isValid
+
+Purpose      Returns whether or not the histogram was registered;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool MetricsHistogram::isValid() const
+{
+    return mIndex >= 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         MetricsTimer
+
+Purpose      Constructor, starting the timer if stages are being timed;
+
+Input        rHistogram         Histogram the elapsed time is recorded in;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+MetricsTimer::MetricsTimer(const MetricsHistogram &rHistogram)
+    : mrHistogram(rHistogram)
+{
+    if (MetricsRegistry::instance().isEnabled())
+    {
+        mTimer.start();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         ~MetricsTimer
+
+Purpose      Destructor, recording the elapsed time;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+MetricsTimer::~MetricsTimer()
+{
+    if (mTimer.isValid())
+    {
+        mrHistogram.observe(mTimer.nsecsElapsed());
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         Shard
+
+Purpose      Constructor, zeroing every value;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+MetricsRegistry::Shard::Shard()
+{
+    for (int i = 0; i < metrics_max_counters; i++)
+    {
+        counters[i].store(0, std::memory_order_relaxed);
+    }
+
+    for (int i = 0; i < metrics_max_histograms; i++)
+    {
+        for (int j = 0; j <= metrics_histogram_buckets; j++)
+        {
+            buckets[i][j].store(0, std::memory_order_relaxed);
+        }
+        sums[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         MetricsRegistry
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+MetricsRegistry::MetricsRegistry()
+    : mEnabled(true)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         instance
+
+Purpose      Returns the registry shared by the whole process;
+
+Notes        The registry is never destroyed, as threads may still record, or
+             retire their shards, while the process is shutting down;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+MetricsRegistry& MetricsRegistry::instance()
+{
+    static MetricsRegistry* pRegistry = new MetricsRegistry;
+    return *pRegistry;
+}
+
+/*----------------------------------------------------------------------------
+Name         counter
+
+Purpose      Registers a counter, or finds the one already registered under
+             the same name and label;
+
+Input        rName              Prometheus name, e.g. got_log_bytes_total;
+             rHelp              Description for the HELP line;
+             rLabelName         Name of a label, or empty for none;
+             rLabelValue        Value of the label;
+
+Returns      MetricsCounter     The counter, invalid if the registry is full;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+MetricsCounter MetricsRegistry::counter(const QString &rName
+                                        , const QString &rHelp
+                                        , const QString &rLabelName
+                                        , const QString &rLabelValue)
+{
+    QMutexLocker locker(&mMutex);
+
+    for (int i = 0; i < mCounters.size(); i++)
+    {
+        const Definition& rDefinition = mCounters.at(i);
+        if (rDefinition.name == rName && rDefinition.labelName == rLabelName
+                && rDefinition.labelValue == rLabelValue)
+        {
+            return MetricsCounter(rDefinition.index);
+        }
+    }
+
+    if (mCounters.size() >= metrics_max_counters)
+    {
+        qWarning("MetricsRegistry: too many counters for %s"
+                 , qPrintable(rName));
+        return MetricsCounter();
+    }
+
+    Definition definition;
+    definition.name = rName;
+    definition.help = rHelp;
+    definition.labelName = rLabelName;
+    definition.labelValue = rLabelValue;
+    definition.index = mCounters.size();
+    mCounters.append(definition);
+
+    return MetricsCounter(definition.index);
+}
+
+/*----------------------------------------------------------------------------
+Name         histogram
+
+Purpose      Registers a latency histogram, or finds the one already
+             registered under the same name and label;
+
+Input        rName              Prometheus name, e.g. got_log_write_seconds;
+             rHelp              Description for the HELP line;
+             rLabelName         Name of a label, or empty for none;
+             rLabelValue        Value of the label;
+
+Returns      MetricsHistogram   The histogram, invalid if the registry is full;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+MetricsHistogram MetricsRegistry::histogram(const QString &rName
+                                            , const QString &rHelp
+                                            , const QString &rLabelName
+                                            , const QString &rLabelValue)
+{
+    QMutexLocker locker(&mMutex);
+
+    for (int i = 0; i < mHistograms.size(); i++)
+    {
+        const Definition& rDefinition = mHistograms.at(i);
+        if (rDefinition.name == rName && rDefinition.labelName == rLabelName
+                && rDefinition.labelValue == rLabelValue)
+        {
+            return MetricsHistogram(rDefinition.index);
+        }
+    }
+
+    if (mHistograms.size() >= metrics_max_histograms)
+    {
+        qWarning("MetricsRegistry: too many histograms for %s"
+                 , qPrintable(rName));
+        return MetricsHistogram();
+    }
+
+    Definition definition;
+    definition.name = rName;
+    definition.help = rHelp;
+    definition.labelName = rLabelName;
+    definition.labelValue = rLabelValue;
+    definition.index = mHistograms.size();
+    mHistograms.append(definition);
+
+    return MetricsHistogram(definition.index);
+}
+
+/*----------------------------------------------------------------------------
+Name         setEnabled
+
+Purpose      Turns the timing of stages on or off.  Timing reads the clock
+             twice per stage, so may be turned off where that matters.  Counts
+             are always kept;
+
+Input        rEnabled           Whether or not to time stages;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void MetricsRegistry::setEnabled(const bool &rEnabled)
+{
+    mEnabled.store(rEnabled, std::memory_order_relaxed);
+}
+
+/*----------------------------------------------------------------------------
+Name         isEnabled
+
+Purpose      Returns whether or not stages are being timed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool MetricsRegistry::isEnabled() const
+{
+    return mEnabled.load(std::memory_order_relaxed);
+}
+
+/*----------------------------------------------------------------------------
+Name         toPrometheus
+
+Purpose      Returns every metric in the Prometheus text exposition format,
+             e.g. for the node exporter's textfile collector;
+
+Notes        Metrics which share a name, with different labels, are written
+             together under one HELP and TYPE line;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString MetricsRegistry::toPrometheus() const
+{
+    QMutexLocker locker(&mMutex);
+
+    QString text;
+    QTextStream out(&text);
+    out.setRealNumberPrecision(10);
+
+    QStringList written;
+    for (int i = 0; i < mCounters.size(); i++)
+    {
+        const QString& rName = mCounters.at(i).name;
+        if (written.contains(rName))
+        {
+            continue;
+        }
+        written << rName;
+
+        out << "# HELP " << rName << " " << mCounters.at(i).help << "\n";
+        out << "# TYPE " << rName << " counter\n";
+
+        for (int j = i; j < mCounters.size(); j++)
+        {
+            const Definition& rDefinition = mCounters.at(j);
+            if (rDefinition.name == rName)
+            {
+                out << rName
+                    << labelSet(rDefinition.labelName
+                                , rDefinition.labelValue)
+                    << " " << counterTotal(rDefinition.index) << "\n";
+            }
+        }
+    }
+
+    quint64 buckets[metrics_histogram_buckets + 1];
+    quint64 sum = 0;
+
+    written.clear();
+    for (int i = 0; i < mHistograms.size(); i++)
+    {
+        const QString& rName = mHistograms.at(i).name;
+        if (written.contains(rName))
+        {
+            continue;
+        }
+        written << rName;
+
+        out << "# HELP " << rName << " " << mHistograms.at(i).help << "\n";
+        out << "# TYPE " << rName << " histogram\n";
+
+        for (int j = i; j < mHistograms.size(); j++)
+        {
+            const Definition& rDefinition = mHistograms.at(j);
+            if (rDefinition.name != rName)
+            {
+                continue;
+            }
+
+            histogramTotals(rDefinition.index, buckets, sum);
+
+            // Prometheus buckets are cumulative;
+            quint64 count = 0;
+            for (int k = 0; k <= metrics_histogram_buckets; k++)
+            {
+                count += buckets[k];
+                const QString bound = (k < metrics_histogram_buckets)
+                        ? QString::number(bucketBound(k), 'g', 6)
+                        : QString("+Inf");
+                out << rName << "_bucket"
+                    << labelSet(rDefinition.labelName
+                                , rDefinition.labelValue
+                                , "le=\"" + bound + "\"")
+                    << " " << count << "\n";
+            }
+
+            const QString labels = labelSet(rDefinition.labelName
+                                            , rDefinition.labelValue);
+            out << rName << "_sum" << labels << " " << sum * 1e-9 << "\n";
+            out << rName << "_count" << labels << " " << count << "\n";
+        }
+    }
+
+    out.flush();
+    return text;
+}
+
+/*----------------------------------------------------------------------------
+Name         toJson
+
+Purpose      Returns every metric as a JSON object;
+
+Returns      QJsonObject        {"counters": [{"name", "labels", "value"}],
+                                 "histograms": [{"name", "labels", "count",
+                                 "sum", "buckets": [{"le", "count"}]}]},
+                                with times in seconds and cumulative bucket
+                                counts, as in the Prometheus format;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QJsonObject MetricsRegistry::toJson() const
+{
+    QMutexLocker locker(&mMutex);
+
+    QJsonArray counters;
+    for (int i = 0; i < mCounters.size(); i++)
+    {
+        const Definition& rDefinition = mCounters.at(i);
+
+        QJsonObject labels;
+        if (!rDefinition.labelName.isEmpty())
+        {
+            labels.insert(rDefinition.labelName, rDefinition.labelValue);
+        }
+
+        QJsonObject counter;
+        counter.insert("name", rDefinition.name);
+        counter.insert("labels", labels);
+        counter.insert("value"
+                       , static_cast<double>(counterTotal(rDefinition.index)));
+        counters.append(counter);
+    }
+
+    quint64 buckets[metrics_histogram_buckets + 1];
+    quint64 sum = 0;
+
+    QJsonArray histograms;
+    for (int i = 0; i < mHistograms.size(); i++)
+    {
+        const Definition& rDefinition = mHistograms.at(i);
+        histogramTotals(rDefinition.index, buckets, sum);
+
+        QJsonObject labels;
+        if (!rDefinition.labelName.isEmpty())
+        {
+            labels.insert(rDefinition.labelName, rDefinition.labelValue);
+        }
+
+        QJsonArray bucketArray;
+        quint64 count = 0;
+        for (int k = 0; k <= metrics_histogram_buckets; k++)
+        {
+            count += buckets[k];
+
+            QJsonObject bucket;
+            bucket.insert("le", (k < metrics_histogram_buckets)
+                          ? QJsonValue(bucketBound(k)) : QJsonValue("+Inf"));
+            bucket.insert("count", static_cast<double>(count));
+            bucketArray.append(bucket);
+        }
+
+        QJsonObject histogram;
+        histogram.insert("name", rDefinition.name);
+        histogram.insert("labels", labels);
+        histogram.insert("count", static_cast<double>(count));
+        histogram.insert("sum", sum * 1e-9);
+        histogram.insert("buckets", bucketArray);
+        histograms.append(histogram);
+    }
+
+    QJsonObject snapshot;
+    snapshot.insert("counters", counters);
+    snapshot.insert("histograms", histograms);
+    return snapshot;
+}
+
+/*----------------------------------------------------------------------------
+Name         write
+
+Purpose      Writes a snapshot of every metric to a file;
+
+Input        rFileName          File to write.  JSON if the name ends in
+                                .json, otherwise Prometheus text (.prom);
+
+Output       rError             Description of the failure, if any;
+
+Returns      bool               true -  If the file was written;
+                                false - If not;
+
+Notes        The file is written alongside and then renamed into place, so a
+             scraper reading it never sees a partial snapshot;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool MetricsRegistry::write(const QString &rFileName, QString &rError) const
+{
+    const QByteArray snapshot = rFileName.endsWith(".json", Qt::CaseInsensitive)
+            ? QJsonDocument(toJson()).toJson()
+            : toPrometheus().toUtf8();
+
+    QSaveFile file(rFileName);
+    if (!file.open(QIODevice::WriteOnly)
+            || file.write(snapshot) != snapshot.size()
+            || !file.commit())
+    {
+        rError = "Unable to write " + rFileName + ": " + file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         localShard
+
+Purpose      Returns the calling thread's shard, creating and attaching it the
+             first time the thread records a metric;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+MetricsRegistry::Shard* MetricsRegistry::localShard()
+{
+    thread_local ShardOwner owner;
+    return owner.mpShard;
+}
+
+/*----------------------------------------------------------------------------
+Name         attach
+
+Purpose      Adds a thread's shard to those summed by a snapshot;
+
+Input        pShard             The shard;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void MetricsRegistry::attach(Shard *pShard)
+{
+    QMutexLocker locker(&mMutex);
+    mShards.append(pShard);
+}
+
+/*----------------------------------------------------------------------------
+Name         detach
+
+Purpose      Folds the shard of an exiting thread into the retired totals;
+
+Input        pShard             The shard;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void MetricsRegistry::detach(Shard *pShard)
+{
+    QMutexLocker locker(&mMutex);
+
+    for (int i = 0; i < metrics_max_counters; i++)
+    {
+        add(mRetired.counters[i]
+            , pShard->counters[i].load(std::memory_order_relaxed));
+    }
+
+    for (int i = 0; i < metrics_max_histograms; i++)
+    {
+        for (int j = 0; j <= metrics_histogram_buckets; j++)
+        {
+            add(mRetired.buckets[i][j]
+                , pShard->buckets[i][j].load(std::memory_order_relaxed));
+        }
+        add(mRetired.sums[i], pShard->sums[i].load(std::memory_order_relaxed));
+    }
+
+    mShards.removeOne(pShard);
+}
+
+/*----------------------------------------------------------------------------
+Name         counterTotal
+
+Purpose      Returns the total of a counter over every thread.  The mutex
+             must be held;
+
+Input        rIndex             Index of the counter;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+quint64 MetricsRegistry::counterTotal(const int &rIndex) const
+{
+    quint64 total = mRetired.counters[rIndex].load(std::memory_order_relaxed);
+    for (int i = 0; i < mShards.size(); i++)
+    {
+        total += mShards.at(i)->counters[rIndex].load(
+                    std::memory_order_relaxed);
+    }
+
+    return total;
+}
+
+/*----------------------------------------------------------------------------
+Name         histogramTotals
+
+Purpose      Returns the totals of a histogram over every thread.  The mutex
+             must be held;
+
+Input        rIndex             Index of the histogram;
+
+Output       pBuckets           Count in each bucket, not cumulative, with the
+                                +Inf bucket last;
+             rSumNanoseconds    Total of the latencies;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void MetricsRegistry::histogramTotals(const int &rIndex
+                                      , quint64 *pBuckets
+                                      , quint64 &rSumNanoseconds) const
+{
+    for (int k = 0; k <= metrics_histogram_buckets; k++)
+    {
+        pBuckets[k] = mRetired.buckets[rIndex][k].load(
+                    std::memory_order_relaxed);
+    }
+    rSumNanoseconds = mRetired.sums[rIndex].load(std::memory_order_relaxed);
+
+    for (int i = 0; i < mShards.size(); i++)
+    {
+        const Shard* pShard = mShards.at(i);
+        for (int k = 0; k <= metrics_histogram_buckets; k++)
+        {
+            pBuckets[k] += pShard->buckets[rIndex][k].load(
+                        std::memory_order_relaxed);
+        }
+        rSumNanoseconds += pShard->sums[rIndex].load(
+                    std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,160 @@
+/*----------------------------------------------------------------------------
+Name         metrics.h
+
+Purpose      Registry of counters and latency histograms for the stages of the
+             calculations and of logging, exported on demand as a Prometheus
+             text file or as JSON;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QString>
+#include <QVector> // HASA QVector of metric definitions and shards;
+#include <QMutex> // HASA QMutex guarding registration and the shard list;
+#include <QElapsedTimer> // HASA QElapsedTimer in each MetricsTimer;
+#include <QJsonObject> // USES QJsonObject for the JSON snapshot;
+#include <atomic> // USES std::atomic for the per-thread values;
+
+// Largest number of counters and histograms which may be registered;
+const int metrics_max_counters = 128;
+const int metrics_max_histograms = 64;
+
+// Number of finite histogram buckets.  Bucket k holds latencies of up to
+// 100 ns * 2^k, so the last finite bucket ends at about 0.84 s;
+const int metrics_histogram_buckets = 24;
+
+// Counts events.  Cheap to copy; an invalid counter ignores increments;
+class MetricsCounter
+{
+public:
+    MetricsCounter(); // Constructor, of an invalid counter;
+
+    // Adds to the counter of the calling thread;
+    void increment(const quint64& rAmount = 1) const;
+    // Whether or not the counter was registered;
+    bool isValid(void) const;
+
+private:
+    friend class MetricsRegistry;
+    explicit MetricsCounter(int index); // Constructor;
+
+    int mIndex; // Index of the counter within each shard;
+};
+
+// Counts latencies into exponential buckets, as a Prometheus histogram;
+class MetricsHistogram
+{
+public:
+    MetricsHistogram(); // Constructor, of an invalid histogram;
+
+    // Records a latency, in nanoseconds, on the calling thread;
+    void observe(const qint64& rNanoseconds) const;
+    // Whether or not the histogram was registered;
+    bool isValid(void) const;
+
+private:
+    friend class MetricsRegistry;
+    explicit MetricsHistogram(int index); // Constructor;
+
+    int mIndex; // Index of the histogram within each shard;
+};
+
+// Records the time from its construction to its destruction in a histogram;
+class MetricsTimer
+{
+public:
+    explicit MetricsTimer(const MetricsHistogram& rHistogram);
+    ~MetricsTimer(); // Records the elapsed time;
+
+private:
+    Q_DISABLE_COPY(MetricsTimer)
+
+    const MetricsHistogram& mrHistogram; // Histogram recorded into;
+    QElapsedTimer mTimer; // Started only while metrics are enabled;
+};
+
+class MetricsRegistry
+{
+public:
+    // Returns the registry shared by the whole process;
+    static MetricsRegistry& instance(void);
+
+    // Registers a counter, or returns the one already registered under the
+    // same name and label;
+    MetricsCounter counter(const QString& rName
+                           , const QString& rHelp
+                           , const QString& rLabelName = QString()
+                           , const QString& rLabelValue = QString());
+    // Registers a latency histogram, in seconds, likewise;
+    MetricsHistogram histogram(const QString& rName
+                               , const QString& rHelp
+                               , const QString& rLabelName = QString()
+                               , const QString& rLabelValue = QString());
+
+    // Turns the timing of stages on or off.  Counting is always on;
+    void setEnabled(const bool& rEnabled);
+    bool isEnabled(void) const; // Whether or not stages are timed;
+
+    // Returns every metric in the Prometheus text exposition format;
+    QString toPrometheus(void) const;
+    // Returns every metric as a JSON object;
+    QJsonObject toJson(void) const;
+    // Writes a snapshot, as JSON if the name ends in .json, else as text;
+    bool write(const QString& rFileName, QString& rError) const;
+
+private:
+    // Values recorded by one thread.  Only that thread writes to them;
+    struct Shard
+    {
+        Shard(); // Constructor, zeroing every value;
+
+        std::atomic<quint64> counters[metrics_max_counters];
+        std::atomic<quint64> buckets[metrics_max_histograms]
+                                    [metrics_histogram_buckets + 1];
+        std::atomic<quint64> sums[metrics_max_histograms]; // Nanoseconds;
+    };
+
+    // A registered counter or histogram;
+    struct Definition
+    {
+        QString name; // Prometheus name;
+        QString help; // Description for the HELP line;
+        QString labelName; // Name of the label, or empty for none;
+        QString labelValue; // Value of the label;
+        int index; // Index within each shard;
+    };
+
+    // Owns the calling thread's shard, and retires it at thread exit;
+    class ShardOwner;
+    friend class ShardOwner;
+    friend class MetricsCounter;
+    friend class MetricsHistogram;
+
+    MetricsRegistry(); // Constructor;
+    Q_DISABLE_COPY(MetricsRegistry)
+
+    mutable QMutex mMutex; // Guards the definitions and the shard list;
+    QVector<Definition> mCounters; // Registered counters;
+    QVector<Definition> mHistograms; // Registered histograms;
+    QVector<Shard*> mShards; // Shards of the running threads;
+    Shard mRetired; // Totals of threads which have exited;
+    std::atomic<bool> mEnabled; // Whether or not stages are timed;
+
+    // Returns the calling thread's shard, creating it the first time;
+    static Shard* localShard(void);
+    // Adds a shard to the list of live shards;
+    void attach(Shard* pShard);
+    // Folds a shard into the retired totals and forgets it;
+    void detach(Shard* pShard);
+
+    // Returns the total of a counter over every thread;
+    quint64 counterTotal(const int& rIndex) const;
+    // Returns the totals of a histogram's buckets over every thread;
+    void histogramTotals(const int& rIndex
+                         , quint64* pBuckets
+                         , quint64& rSumNanoseconds) const;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,331 @@
+/*----------------------------------------------------------------------------
+Name         powersamplefile.cpp
+
+Purpose      Raw file of radiometer power samples, in dB or as power ratios,
+             read through a memory map and reduced to PowerStats;
+
+Notes        The file is nothing but the samples, as doubles or floats in the
+             byte order of the machine, as dumped by most radiometer and SDR
+             software.  Whether they are in dB or are power ratios is given
+             when it is opened;
+
+             The whole file is mapped, so reading it costs no copy and no
+             system call per block, and the kernel is told it will be read in
+             order so that it reads ahead.  Files of hundreds of millions of
+             samples are reduced a job of samples_per_job at a time, spread
+             over a WorkStealingPool if one is given, and the statistics of
+             the jobs merged in order, so the result does not depend on the
+             number of threads;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "powersamplefile.h"
+
+#include "powerstats.h" // USES PowerStats to reduce the samples;
+#include "workstealingpool.h" // USES WorkStealingPool to spread the jobs;
+#include <vector>
+#ifdef Q_OS_UNIX
+#include <sys/mman.h> // USES posix_madvise to ask for read ahead;
+#endif
+
+namespace
+{
+    // Samples reduced by each job, 8 MiB of doubles;
+    const qint64 samples_per_job = 1 << 20;
+}
+
+/*----------------------------------------------------------------------------
+Name         PowerSampleFile
+
+Purpose      Constructor, with no file open;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+PowerSampleFile::PowerSampleFile()
+    : mpData(0)
+    , mSampleCount(0)
+    , mUnits(Decibels)
+    , mType(Float64)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         ~PowerSampleFile
+
+Purpose      Destructor, unmapping the file;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+PowerSampleFile::~PowerSampleFile()
+{
+    close();
+}
+
+/*----------------------------------------------------------------------------
+Name         open
+
+Purpose      Opens and maps a file of samples;
+
+Input        rFileName          Name of the file;
+             rUnits             Whether the samples are in dB or are power
+                                ratios;
+             rType              Whether the samples are doubles or floats;
+
+Returns      bool               true -  If the file was opened;
+                                false - If not, in which case getLastError()
+                                        explains why;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool PowerSampleFile::open(const QString &rFileName
+                           , const Units &rUnits
+                           , const SampleType &rType)
+{
+    close();
+
+    mFile.setFileName(rFileName);
+    if (!mFile.open(QIODevice::ReadOnly))
+    {
+        mLastError = "Unable to open " + rFileName + ": " + mFile.errorString();
+        return false;
+    }
+
+    const qint64 sampleSize = (rType == Float64) ? sizeof(double)
+                                                 : sizeof(float);
+    const qint64 size = mFile.size();
+    if (size % sampleSize != 0)
+    {
+        mLastError = rFileName + " does not hold a whole number of samples";
+        close();
+        return false;
+    }
+
+    uchar* pData = (size > 0) ? mFile.map(0, size) : 0;
+    if (size > 0 && !pData)
+    {
+        mLastError = "Unable to map " + rFileName + ": "
+                + mFile.errorString();
+        close();
+        return false;
+    }
+
+#ifdef Q_OS_UNIX
+    if (pData)
+    {
+        posix_madvise(pData, size, POSIX_MADV_SEQUENTIAL);
+    }
+#endif
+
+    mpData = pData;
+    mSampleCount = size / sampleSize;
+    mUnits = rUnits;
+    mType = rType;
+
+    mLastError.clear();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         close
+
+Purpose      Unmaps and closes the file;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void PowerSampleFile::close()
+{
+    if (mpData)
+    {
+        mFile.unmap(mpData);
+    }
+
+    mFile.close();
+    mpData = 0;
+    mSampleCount = 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         isOpen
+
+Purpose      Returns whether or not a file is open;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool PowerSampleFile::isOpen() const
+{
+    return mFile.isOpen();
+}
+
+/*----------------------------------------------------------------------------
+Name         getSampleCount
+
+Purpose      Returns the number of samples in the file;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+qint64 PowerSampleFile::getSampleCount() const
+{
+    return mSampleCount;
+}
+
+/*----------------------------------------------------------------------------
+Name         getUnits
+
+Purpose      Returns whether the samples are in dB or are power ratios;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+PowerSampleFile::Units PowerSampleFile::getUnits() const
+{
+    return mUnits;
+}
+
+/*----------------------------------------------------------------------------
+Name         getSampleType
+
+Purpose      Returns whether the samples are doubles or floats;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+PowerSampleFile::SampleType PowerSampleFile::getSampleType() const
+{
+    return mType;
+}
+
+/*----------------------------------------------------------------------------
+Name         read
+
+Purpose      Adds a run of samples to statistics, in the linear domain, e.g.
+             the hot or cold part of a sun transit;
+
+Input        rFirst             Index of the first sample;
+             rCount             Number of samples;
+             pPool              Pool to spread the work over, or null to use
+                                the calling thread;
+
+Output       rStatistics        The samples are added;
+
+Returns      bool               true -  If the samples were added;
+                                false - If the run is not within the file;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool PowerSampleFile::read(const qint64 &rFirst
+                           , const qint64 &rCount
+                           , PowerStats &rStatistics
+                           , WorkStealingPool *pPool) const
+{
+    if (rFirst < 0 || rCount < 0 || rFirst > mSampleCount
+            || rCount > mSampleCount - rFirst)
+    {
+        return false;
+    }
+
+    const int jobs = static_cast<int>((rCount + samples_per_job - 1)
+                                      / samples_per_job);
+    if (!pPool || jobs < 2)
+    {
+        reduce(rFirst, rCount, rStatistics);
+        return true;
+    }
+
+    std::vector<PowerStats> partial(jobs);
+    pPool->parallelFor(0, jobs, 1, [&](int begin, int end)
+    {
+        for (int job = begin; job < end; job++)
+        {
+            const qint64 first = job * samples_per_job;
+            reduce(rFirst + first
+                   , qMin(samples_per_job, rCount - first)
+                   , partial[job]);
+        }
+    });
+
+    // Merge in job order, so the sums are always made the same way;
+    for (int job = 0; job < jobs; job++)
+    {
+        rStatistics.merge(partial[job]);
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         readAll
+
+Purpose      Adds every sample of the file to statistics;
+
+Input        pPool              Pool to spread the work over, or null to use
+                                the calling thread;
+
+Output       rStatistics        The samples are added;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void PowerSampleFile::readAll(PowerStats &rStatistics
+                              , WorkStealingPool *pPool) const
+{
+    read(0, mSampleCount, rStatistics, pPool);
+}
+
+/*----------------------------------------------------------------------------
+Name         getLastError
+
+Purpose      Returns a description of why open() last failed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString PowerSampleFile::getLastError() const
+{
+    return mLastError;
+}
+
+/*----------------------------------------------------------------------------
+Name         reduce
+
+Purpose      Adds a run of samples, known to be within the file, to
+             statistics;
+
+Input        rFirst             Index of the first sample;
+             rCount             Number of samples;
+
+Output       rStatistics        The samples are added;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void PowerSampleFile::reduce(const qint64 &rFirst
+                             , const qint64 &rCount
+                             , PowerStats &rStatistics) const
+{
+    if (rCount == 0)
+    {
+        return;
+    }
+
+    if (mType == Float64)
+    {
+        const double* pSamples = reinterpret_cast<const double*>(mpData)
+                + rFirst;
+        if (mUnits == Decibels)
+        {
+            rStatistics.addDb(pSamples, rCount);
+        }
+        else
+        {
+            rStatistics.addLinear(pSamples, rCount);
+        }
+    }
+    else
+    {
+        const float* pSamples = reinterpret_cast<const float*>(mpData)
+                + rFirst;
+        if (mUnits == Decibels)
+        {
+            rStatistics.addDb(pSamples, rCount);
+        }
+        else
+        {
+            rStatistics.addLinear(pSamples, rCount);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/*----------------------------------------------------------------------------
+Name         powersamplefile.h
+
+Purpose      Raw file of radiometer power samples, in dB or as power ratios,
+             read through a memory map and reduced to PowerStats;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef POWERSAMPLEFILE_H
+#define POWERSAMPLEFILE_H
+
+#include <QFile> // HASA QFile the samples are mapped from;
+#include <QString>
+
+class PowerStats;
+class WorkStealingPool;
+
+class PowerSampleFile
+{
+public:
+    // What each sample holds;
+    enum Units
+    {
+        Decibels, // A level in dB;
+        Linear // A power ratio;
+    };
+
+    // How each sample is stored;
+    enum SampleType
+    {
+        Float64, // A double;
+        Float32 // A float;
+    };
+
+    PowerSampleFile(); // Constructor;
+    ~PowerSampleFile(); // Destructor, unmaps the file;
+
+    // Opens and maps a file of samples;
+    bool open(const QString& rFileName
+              , const Units& rUnits
+              , const SampleType& rType = Float64);
+    // Unmaps and closes the file;
+    void close(void);
+    // Whether or not a file is open;
+    bool isOpen(void) const;
+
+    // Returns the number of samples in the file;
+    qint64 getSampleCount(void) const;
+    // Returns what each sample holds;
+    Units getUnits(void) const;
+    // Returns how each sample is stored;
+    SampleType getSampleType(void) const;
+
+    // Adds rCount samples from rFirst to statistics;
+    bool read(const qint64& rFirst
+              , const qint64& rCount
+              , PowerStats& rStatistics
+              , WorkStealingPool* pPool = 0) const;
+    // Adds every sample to statistics;
+    void readAll(PowerStats& rStatistics, WorkStealingPool* pPool = 0) const;
+
+    // Returns a description of why open() last failed;
+    QString getLastError(void) const;
+
+private:
+    Q_DISABLE_COPY(PowerSampleFile)
+
+    QFile mFile; // The sample file;
+    uchar* mpData; // Start of the mapped file;
+    qint64 mSampleCount; // Number of samples in the file;
+    Units mUnits; // What each sample holds;
+    SampleType mType; // How each sample is stored;
+    QString mLastError; // Why open() last failed;
+
+    // Adds a run of samples to statistics;
+    void reduce(const qint64& rFirst
+                , const qint64& rCount
+                , PowerStats& rStatistics) const;
+};
+
+#endif // POWERSAMPLEFILE_H
@@ -0,0 +1,451 @@
+/*----------------------------------------------------------------------------
+Name         powerstats.cpp
+
+Purpose      Keeps a running count, mean, and variance of a stream of
+             radiometer power samples in the linear domain;
+
+Notes        Samples are taken a block at a time, small enough to stay in the
+             L1 cache.  Samples in dB are converted into a block on the stack
+             with fastmath::dbToPower.  Each block is reduced on its own, the
+             mean by pairwise summation and then the squared differences from
+             it the same way, and merged into the running statistics as
+             RunningStats::merge does;
+
+             The pairwise sums end in eight independent partial sums, so the
+             compiler can keep them in vector registers without reordering
+             any addition, which strict IEEE arithmetic forbids it to do to a
+             single running sum.  Their error grows with the log of the block
+             size rather than with the block size;
+
+             The sums of the blocks are added with Neumaier's compensated
+             summation, so the mean of hundreds of millions of samples is as
+             good as that of one block;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "powerstats.h"
+
+#include "fastmath.h" // USES fastmath::dbToPower;
+#include <cmath> // USES sqrt, log10, and log;
+
+namespace
+{
+    // Samples reduced at a time, 8 KiB of doubles;
+    const size_t block_size = 1024;
+
+    // Partial sums kept by the pairwise summation;
+    const size_t lanes = 8;
+
+    // Largest array summed directly rather than split in two;
+    const size_t pairwise_base = 128;
+
+    // Converts a block of levels in dB to power ratios;
+    template <typename T>
+    void dbBlockToPower(const T* pDb, size_t count, double* pPower)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            pPower[i] = fastmath::dbToPower(static_cast<double>(pDb[i]));
+        }
+    }
+
+    // Copies a block of power ratios as doubles;
+    template <typename T>
+    void linearBlockToPower(const T* pLinear, size_t count, double* pPower)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            pPower[i] = static_cast<double>(pLinear[i]);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         PowerStats
+
+Purpose      Constructor, with no samples;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+PowerStats::PowerStats()
+    : mCount(0)
+    , mSum(0)
+    , mCompensation(0)
+    , mM2(0)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         addDb
+
+Purpose      Adds a block of samples in dB to the statistics, as power
+             ratios;
+
+Input        pSamples           Array of samples, in dB;
+             count              Number of samples in pSamples;
+
+Notes        Levels beyond +-fastmath::db_to_power_max_argument lose accuracy;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void PowerStats::addDb(const double *pSamples, size_t count)
+{
+    double power[block_size];
+
+    for (size_t start = 0; start < count; start += block_size)
+    {
+        const size_t n = (count - start < block_size) ? count - start
+                                                      : block_size;
+        dbBlockToPower(pSamples + start, n, power);
+        addBlock(power, n);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         addDb
+
+Purpose      Adds a block of single precision samples in dB to the
+             statistics, as power ratios;
+
+Input        pSamples           Array of samples, in dB;
+             count              Number of samples in pSamples;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void PowerStats::addDb(const float *pSamples, size_t count)
+{
+    double power[block_size];
+
+    for (size_t start = 0; start < count; start += block_size)
+    {
+        const size_t n = (count - start < block_size) ? count - start
+                                                      : block_size;
+        dbBlockToPower(pSamples + start, n, power);
+        addBlock(power, n);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         addLinear
+
+Purpose      Adds a block of samples which are power ratios to the
+             statistics;
+
+Input        pSamples           Array of samples;
+             count              Number of samples in pSamples;
+
+Notes        The samples are reduced where they lie, without being copied;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void PowerStats::addLinear(const double *pSamples, size_t count)
+{
+    for (size_t start = 0; start < count; start += block_size)
+    {
+        const size_t n = (count - start < block_size) ? count - start
+                                                      : block_size;
+        addBlock(pSamples + start, n);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         addLinear
+
+Purpose      Adds a block of single precision samples which are power ratios
+             to the statistics;
+
+Input        pSamples           Array of samples;
+             count              Number of samples in pSamples;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void PowerStats::addLinear(const float *pSamples, size_t count)
+{
+    double power[block_size];
+
+    for (size_t start = 0; start < count; start += block_size)
+    {
+        const size_t n = (count - start < block_size) ? count - start
+                                                      : block_size;
+        linearBlockToPower(pSamples + start, n, power);
+        addBlock(power, n);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         merge
+
+Purpose      Combines the statistics of another stream of samples into these,
+             as though its samples had been added here;
+
+Input        rOther             Statistics of the other stream;
+
+Notes        Parts of a file may be reduced on separate threads and merged;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void PowerStats::merge(const PowerStats &rOther)
+{
+    if (rOther.mCount == 0)
+    {
+        return;
+    }
+
+    if (mCount == 0)
+    {
+        *this = rOther;
+        return;
+    }
+
+    const double count = static_cast<double>(mCount + rOther.mCount);
+    const double delta = rOther.getMean() - getMean();
+
+    mM2 += rOther.mM2 + delta * delta * (mCount * (rOther.mCount / count));
+    addToSum(rOther.mSum);
+    addToSum(rOther.mCompensation);
+    mCount += rOther.mCount;
+}
+
+/*----------------------------------------------------------------------------
+Name         clear
+
+Purpose      Forgets every sample added so far;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void PowerStats::clear()
+{
+    mCount = 0;
+    mSum = 0;
+    mCompensation = 0;
+    mM2 = 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         getCount
+
+Purpose      Returns the number of samples added;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+unsigned long long PowerStats::getCount() const
+{
+    return mCount;
+}
+
+/*----------------------------------------------------------------------------
+Name         getMean
+
+Purpose      Returns the mean power ratio of the samples;
+
+Returns      double             The mean, or NaN if there are no samples;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double PowerStats::getMean() const
+{
+    return (mSum + mCompensation) / static_cast<double>(mCount);
+}
+
+/*----------------------------------------------------------------------------
+Name         getMeanDb
+
+Purpose      Returns the mean power ratio of the samples, in dB;
+
+Returns      double             The mean, or NaN if there are no samples;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double PowerStats::getMeanDb() const
+{
+    return 10.0 * log10(getMean());
+}
+
+/*----------------------------------------------------------------------------
+Name         getVariance
+
+Purpose      Returns the sample variance of the power ratios;
+
+Returns      double             The variance, or 0 with fewer than two
+                                samples;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double PowerStats::getVariance() const
+{
+    if (mCount < 2)
+    {
+        return 0;
+    }
+
+    return mM2 / (mCount - 1);
+}
+
+/*----------------------------------------------------------------------------
+Name         getStandardError
+
+Purpose      Returns the standard error of the mean power ratio;
+
+Returns      double             The standard error, or 0 with fewer than two
+                                samples;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double PowerStats::getStandardError() const
+{
+    if (mCount < 2)
+    {
+        return 0;
+    }
+
+    return sqrt(getVariance() / mCount);
+}
+
+/*----------------------------------------------------------------------------
+Name         getStandardErrorDb
+
+Purpose      Returns the standard error of the mean power ratio in dB;
+
+Returns      double             The standard error, in dB;
+
+Notes        Propagated to first order: d(10 log10 P) = 10 / ln 10 * dP / P;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double PowerStats::getStandardErrorDb() const
+{
+    if (mCount < 2)
+    {
+        return 0;
+    }
+
+    return (10.0 / log(10.0)) * getStandardError() / getMean();
+}
+
+/*----------------------------------------------------------------------------
+Name         dbToPower
+
+Purpose      Converts an array of levels in dB to power ratios, 10^(dB / 10);
+
+Input        pDb                Array of levels, in dB;
+             count              Number of entries in pDb and pPower;
+
+Output       pPower             The power ratios.  May be pDb itself;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void PowerStats::dbToPower(const double *pDb, size_t count, double *pPower)
+{
+    dbBlockToPower(pDb, count, pPower);
+}
+
+/*----------------------------------------------------------------------------
+Name         pairwiseSum
+
+Purpose      Returns the sum of an array by pairwise summation;
+
+Input        pValues            The values;
+             count              Number of entries in pValues;
+
+Returns      double             The sum;
+
+Notes        Arrays of up to pairwise_base entries are summed into lanes
+             partial sums, which are then added as a balanced tree.  Longer
+             arrays are split in two at a multiple of lanes, and the sums of
+             the halves added;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double PowerStats::pairwiseSum(const double *pValues, size_t count)
+{
+    if (count > pairwise_base)
+    {
+        const size_t half = (count / 2) & ~(lanes - 1);
+        return pairwiseSum(pValues, half)
+                + pairwiseSum(pValues + half, count - half);
+    }
+
+    double partial[lanes] = {0, 0, 0, 0, 0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes)
+    {
+        for (size_t lane = 0; lane < lanes; lane++)
+        {
+            partial[lane] += pValues[i + lane];
+        }
+    }
+
+    double tail = 0;
+    for (; i < count; i++)
+    {
+        tail += pValues[i];
+    }
+
+    return ((partial[0] + partial[1]) + (partial[2] + partial[3]))
+            + ((partial[4] + partial[5]) + (partial[6] + partial[7]))
+            + tail;
+}
+
+/*----------------------------------------------------------------------------
+Name         addBlock
+
+Purpose      Adds a block of power ratios to the statistics;
+
+Input        pPower             Array of power ratios;
+             count              Number of entries, at most block_size;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void PowerStats::addBlock(const double *pPower, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Reduce the block on its own; the mean first, then the squared
+    // differences from it;
+    const double sum = pairwiseSum(pPower, count);
+    const double mean = sum / count;
+
+    double squares[block_size];
+    for (size_t i = 0; i < count; i++)
+    {
+        const double delta = pPower[i] - mean;
+        squares[i] = delta * delta;
+    }
+
+    PowerStats block;
+    block.mCount = count;
+    block.mSum = sum;
+    block.mM2 = pairwiseSum(squares, count);
+
+    merge(block);
+}
+
+/*----------------------------------------------------------------------------
+Name         addToSum
+
+Purpose      Adds a value to the running sum, keeping in mCompensation the
+             low order part which rounding drops (Neumaier's variant of Kahan
+             summation, which also holds when the value is the larger);
+
+Input        rValue             The value;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void PowerStats::addToSum(const double &rValue)
+{
+    const double total = mSum + rValue;
+
+    if (fabs(mSum) >= fabs(rValue))
+    {
+        mCompensation += (mSum - total) + rValue;
+    }
+    else
+    {
+        mCompensation += (rValue - total) + mSum;
+    }
+
+    mSum = total;
+}
@@ -0,0 +1,63 @@
+/*----------------------------------------------------------------------------
+Name         powerstats.h
+
+Purpose      Keeps a running count, mean, and variance of a stream of
+             radiometer power samples in the linear domain, whether they
+             arrive as power ratios or in dB, without storing the samples;
+
+Notes        The mean of samples in dB is the mean of their logarithms, which
+             is below the logarithm of their mean power by about half the
+             variance, so on noisy samples it biases the Y-factor.  These
+             statistics are of the power itself, and getMeanDb converts only
+             the mean back to dB;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef POWERSTATS_H
+#define POWERSTATS_H
+
+#include <cstddef> // USES size_t;
+
+class PowerStats
+{
+public:
+    PowerStats(); // Constructor;
+
+    // Adds a block of samples in dB;
+    void addDb(const double* pSamples, size_t count);
+    void addDb(const float* pSamples, size_t count);
+    // Adds a block of samples which are power ratios;
+    void addLinear(const double* pSamples, size_t count);
+    void addLinear(const float* pSamples, size_t count);
+    // Combines the statistics of another stream into this one;
+    void merge(const PowerStats& rOther);
+
+    void clear(void); // Forgets every sample added so far;
+
+    unsigned long long getCount(void) const; // Number of samples;
+    double getMean(void) const; // Mean power ratio;
+    double getMeanDb(void) const; // Mean power ratio, in dB;
+    double getVariance(void) const; // Sample (n - 1) variance of the power;
+    // Standard deviation of the mean power (standard error);
+    double getStandardError(void) const;
+    // Standard error of getMeanDb, in dB;
+    double getStandardErrorDb(void) const;
+
+    // Converts an array of levels in dB to power ratios;
+    static void dbToPower(const double* pDb, size_t count, double* pPower);
+    // Returns the sum of an array by pairwise summation;
+    static double pairwiseSum(const double* pValues, size_t count);
+
+private:
+    unsigned long long mCount; // Number of samples added;
+    double mSum; // Running sum of the power;
+    double mCompensation; // Low order part of mSum lost to rounding;
+    double mM2; // Running sum of squared differences from the mean;
+
+    // Adds a block of power ratios held in the cache;
+    void addBlock(const double* pPower, size_t count);
+    // Adds to the running sum, keeping what rounding loses;
+    void addToSum(const double& rValue);
+};
+
+#endif // POWERSTATS_H
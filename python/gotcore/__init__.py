@@ -0,0 +1,123 @@
+"""Batch sun position and G/T calculations of the GOT application.
+
+The arithmetic is the gotcore library itself, the same code SolarCalc and
+GotCalc run, so the results match the C++ tools to the bit.  NumPy arrays are
+handed to it through the buffer protocol without being copied, and the GIL is
+released while it runs, so calls from several threads use several cores.
+"""
+
+import numpy as np
+
+from . import _kernels
+
+__all__ = ["sun_positions", "got", "mean_power_db", "bracketing_frequencies"]
+
+
+def _utc(utc):
+    """Returns instants as float64 seconds or int64 nanoseconds since 1970.
+
+    Plain integers are refused rather than guessed at: seconds and
+    nanoseconds since 1970 are both common, and reading one as the other
+    puts the sun in the wrong place without any error.
+    """
+    utc = np.asarray(utc)
+    if utc.dtype.kind == "M":
+        utc = utc.astype("datetime64[ns]").view(np.int64)
+    elif utc.dtype.kind in "iub":
+        raise TypeError("utc must be datetime64 or float seconds since 1970, "
+                        "not %s; convert integer seconds with "
+                        "utc.astype('datetime64[s]') or utc.astype(float)"
+                        % utc.dtype)
+    else:
+        utc = utc.astype(np.float64, copy=False)
+    return np.ascontiguousarray(utc.ravel())
+
+
+def _output(out, name, count):
+    """Returns a given output array, checked, or a new one."""
+    if out is None:
+        return np.empty(count)
+    if (not isinstance(out, np.ndarray) or out.dtype != np.float64
+            or out.shape != (count,) or not out.flags.c_contiguous
+            or not out.flags.writeable):
+        raise ValueError("%s must be a writable contiguous float64 array of "
+                         "%d entries" % (name, count))
+    return out
+
+
+def sun_positions(latitude, longitude, utc, backend="libm", out=None):
+    """Calculates the position of the sun at a site for an array of instants.
+
+    utc holds datetime64 values, or float seconds since 1 Jan 1970 UTC.
+    Integer arrays raise TypeError, as their unit is not known.  backend is "libm", or "polynomial" for the
+    vectorised kernels.  out may be a tuple of four float64 arrays to fill.
+
+    Returns the azimuth, altitude, zenith, and hour angle in degrees, as
+    float64 arrays of the shape of utc.
+    """
+    shape = np.shape(utc)
+    utc = _utc(utc)
+    if out is None:
+        out = (None,) * 4
+    columns = [_output(column, name, utc.size) for column, name
+               in zip(out, ("azimuth", "altitude", "zenith", "hour_angle"))]
+    _kernels.sun_positions(float(latitude), float(longitude), utc,
+                           *(columns + [backend]))
+    return tuple(column if column.shape == shape else column.reshape(shape)
+                 for column in columns)
+
+
+def got(frequency, hot, cold, beamwidth, flux_low, flux_high, lower=None,
+        higher=None, out=None):
+    """Calculates the Gain Over Temperature of an array of sessions.
+
+    Every argument may be an array with one entry per session or a scalar
+    for every session: the operating frequency in MHz, the mean power of
+    the hot and of the cold measurements in dB (see mean_power_db), the
+    beamwidth in degrees, and the solar flux in sfu at the lower and higher
+    available frequencies.  Those frequencies are found from the operating
+    frequency if not given.
+    out may be a tuple of four float64 arrays to fill.
+
+    Returns the solar flux in W/m^2/Hz, the beam correction factor, and
+    the G/T as a ratio and in dB, as float64 arrays.
+    """
+    frequency = np.asarray(frequency, dtype=np.float64)
+    if lower is None or higher is None:
+        unique, index = np.unique(frequency, return_inverse=True)
+        brackets = np.array([bracketing_frequencies(f) for f in unique])
+        brackets = brackets.reshape(-1, 2)[index.ravel()]
+        lower = brackets[:, 0] if lower is None else lower
+        higher = brackets[:, 1] if higher is None else higher
+
+    inputs = [np.ascontiguousarray(value, dtype=np.float64).ravel()
+              for value in (frequency, lower, higher, flux_low, flux_high,
+                            beamwidth, hot, cold)]
+    count = max(value.size for value in inputs)
+    if out is None:
+        out = (None,) * 4
+    columns = [_output(column, name, count) for column, name
+               in zip(out, ("solar_flux", "beam_correction", "got_ratio",
+                            "got_db"))]
+    _kernels.got(*(inputs + columns))
+    return tuple(columns)
+
+
+def mean_power_db(levels):
+    """Returns the mean power of levels in dB, averaged as power ratios, in
+    dB, as GotCalc averages the hot and cold measurements.
+
+    The mean of the dB values themselves is low by about half their
+    variance, which biases the G/T of noisy measurements.
+    """
+    levels = np.ascontiguousarray(levels, dtype=np.float64).ravel()
+    return _kernels.mean_power_db(levels)
+
+
+def bracketing_frequencies(frequency):
+    """Returns the available solar flux frequencies either side of an
+    operating frequency in MHz, as (lower, higher).
+
+    Raises ValueError if there are none.
+    """
+    return _kernels.bracketing_frequencies(float(frequency))
@@ -0,0 +1,510 @@
+/*----------------------------------------------------------------------------
+Name         gotcoremodule.cpp
+
+Purpose      Python extension module gotcore._kernels, the batch sun position
+             and G/T kernels of gotcore over Python buffers;
+
+Notes        Arrays are taken through the buffer protocol, so a NumPy array
+             of float64 is read, and written, where it lies without being
+             copied.  The inputs must be C contiguous, and the outputs C
+             contiguous and writable; the gotcore package makes them so;
+
+             The buffers are held for the whole call, which stops their
+             owners resizing them, and the GIL is released while the kernels
+             run, so calls from several Python threads run on as many cores;
+
+             Each kernel is the very function the C++ path calls, with the
+             same arguments, so the results are the same to the bit;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Added mean_power_db;
+----------------------------------------------------------------------------*/
+#define PY_SSIZE_T_CLEAN
+#include <Python.h> // USES the CPython API and the buffer protocol;
+
+#include "gotcore.h" // USES the gotcore kernels being wrapped;
+#include <cstdio> // USES snprintf;
+#include <cstring> // USES strcmp;
+
+namespace
+{
+    // Instants converted from nanoseconds at a time, on the stack;
+    const size_t block_size = 256;
+
+    // A buffer of doubles or 64 bit integers, held for one call;
+    class Column
+    {
+    public:
+        Column() : mHeld(false)
+        {
+            memset(&mView, 0, sizeof(mView));
+        }
+
+        ~Column()
+        {
+            if (mHeld)
+            {
+                PyBuffer_Release(&mView);
+            }
+        }
+
+        // Takes hold of the buffer of an object, if it is not None;
+        bool acquire(PyObject* pObject, const char* pName, bool writable
+                     , bool allowIntegers = false)
+        {
+            if (pObject == 0 || pObject == Py_None)
+            {
+                return true;
+            }
+
+            int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT;
+            if (writable)
+            {
+                flags |= PyBUF_WRITABLE;
+            }
+            if (PyObject_GetBuffer(pObject, &mView, flags) != 0)
+            {
+                return false;
+            }
+            mHeld = true;
+
+            if (mView.ndim > 1)
+            {
+                PyErr_Format(PyExc_ValueError
+                             , "%s must be one dimensional", pName);
+                return false;
+            }
+
+            if (isFormat('d') && mView.itemsize == sizeof(double))
+            {
+                return true;
+            }
+            if (allowIntegers && (isFormat('q') || isFormat('l'))
+                && mView.itemsize == sizeof(long long))
+            {
+                return true;
+            }
+
+            PyErr_Format(PyExc_TypeError, allowIntegers
+                         ? "%s must be float64 seconds or int64 nanoseconds"
+                         : "%s must be float64", pName);
+            return false;
+        }
+
+        // Returns whether a buffer was given;
+        bool given(void) const
+        {
+            return mHeld;
+        }
+
+        // Returns whether the buffer holds integers rather than doubles;
+        bool integers(void) const
+        {
+            return mHeld && !isFormat('d');
+        }
+
+        // Returns the number of entries;
+        size_t size(void) const
+        {
+            return mHeld ? size_t(mView.len / mView.itemsize) : 0;
+        }
+
+        // Returns the entries as doubles, or null if not given;
+        double* doubles(void) const
+        {
+            return mHeld ? static_cast<double*>(mView.buf) : 0;
+        }
+
+        // Returns the entries as 64 bit integers;
+        const long long* nanoseconds(void) const
+        {
+            return static_cast<const long long*>(mView.buf);
+        }
+
+        // Returns entry i, or entry 0 of a single entry buffer;
+        double at(size_t i) const
+        {
+            return doubles()[mView.len == mView.itemsize ? 0 : i];
+        }
+
+    private:
+        Py_buffer mView; // The buffer, while held;
+        bool mHeld; // Whether mView must be released;
+
+        // Returns whether the format is a native type, with any byte order
+        // prefix which means native order;
+        bool isFormat(char type) const
+        {
+            const char* pFormat = mView.format ? mView.format : "B";
+            if (*pFormat == '@' || *pFormat == '=')
+            {
+                pFormat++;
+            }
+#if PY_LITTLE_ENDIAN
+            else if (*pFormat == '<')
+#else
+            else if (*pFormat == '>')
+#endif
+            {
+                pFormat++;
+            }
+            return pFormat[0] == type && pFormat[1] == '\0';
+        }
+    };
+
+    // Checks an output is missing or holds count entries;
+    bool checkOutput(const Column& rColumn, const char* pName, size_t count)
+    {
+        if (rColumn.given() && rColumn.size() != count)
+        {
+            PyErr_Format(PyExc_ValueError, "%s must have %zu entries"
+                         , pName, count);
+            return false;
+        }
+        return true;
+    }
+
+    // Checks an input holds count entries, or a single one to use for all;
+    bool checkInput(const Column& rColumn, const char* pName, size_t count)
+    {
+        if (rColumn.size() != count && rColumn.size() != 1)
+        {
+            PyErr_Format(PyExc_ValueError
+                         , "%s must have 1 or %zu entries", pName, count);
+            return false;
+        }
+        return true;
+    }
+
+    // Returns the backend of its name, or sets an error;
+    bool parseBackend(const char* pName, SolarMathBackend& rBackend)
+    {
+        if (pName == 0 || strcmp(pName, "libm") == 0)
+        {
+            rBackend = LibmMath;
+            return true;
+        }
+        if (strcmp(pName, "polynomial") == 0)
+        {
+            rBackend = PolynomialMath;
+            return true;
+        }
+        PyErr_Format(PyExc_ValueError
+                     , "backend must be 'libm' or 'polynomial', not '%s'"
+                     , pName);
+        return false;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         sunPositions
+
+Purpose      _kernels.sun_positions(latitude, longitude, utc, azimuth,
+             altitude, zenith, hour_angle, backend): calculates the position
+             of the sun at a site for an array of instants, into the given
+             columns;
+
+Input        pArgs              latitude and longitude in degrees; utc as
+                                float64 seconds, or int64 nanoseconds, since
+                                1 Jan 1970 UTC; an output buffer or None for
+                                each column; and 'libm' or 'polynomial';
+
+Returns      PyObject*          None, or null with an exception set;
+
+Notes        Seconds are handed straight to solarmath::positionsUtc, as by
+             SolarCalc::calculateBatchUtc.  Nanoseconds are converted a block
+             at a time with solarmath::secondsFromNanoseconds first;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+static PyObject* sunPositions(PyObject*, PyObject* pArgs)
+{
+    double latitude;
+    double longitude;
+    PyObject* pUtc;
+    PyObject* pAzimuth;
+    PyObject* pAltitude;
+    PyObject* pZenith;
+    PyObject* pHourAngle;
+    const char* pBackendName = 0;
+    if (!PyArg_ParseTuple(pArgs, "ddOOOOO|s:sun_positions", &latitude
+                          , &longitude, &pUtc, &pAzimuth, &pAltitude
+                          , &pZenith, &pHourAngle, &pBackendName))
+    {
+        return 0;
+    }
+
+    SolarMathBackend backend;
+    Column utc;
+    Column azimuth;
+    Column altitude;
+    Column zenith;
+    Column hourAngle;
+    if (!parseBackend(pBackendName, backend)
+        || !utc.acquire(pUtc, "utc", false, true)
+        || !azimuth.acquire(pAzimuth, "azimuth", true)
+        || !altitude.acquire(pAltitude, "altitude", true)
+        || !zenith.acquire(pZenith, "zenith", true)
+        || !hourAngle.acquire(pHourAngle, "hour_angle", true))
+    {
+        return 0;
+    }
+
+    const size_t count = utc.size();
+    if (!checkOutput(azimuth, "azimuth", count)
+        || !checkOutput(altitude, "altitude", count)
+        || !checkOutput(zenith, "zenith", count)
+        || !checkOutput(hourAngle, "hour_angle", count))
+    {
+        return 0;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    if (!utc.integers())
+    {
+        solarmath::positionsUtc(latitude, longitude, utc.doubles(), count
+                                , azimuth.doubles(), altitude.doubles()
+                                , zenith.doubles(), hourAngle.doubles()
+                                , backend);
+    }
+    else
+    {
+        double seconds[block_size];
+        const long long* pNanoseconds = utc.nanoseconds();
+        for (size_t start = 0; start < count; start += block_size)
+        {
+            const size_t n = (count - start < block_size) ? count - start
+                                                          : block_size;
+            for (size_t i = 0; i < n; i++)
+            {
+                seconds[i] = solarmath::secondsFromNanoseconds(
+                            pNanoseconds[start + i]);
+            }
+
+            // Null columns stay null rather than being offset;
+            solarmath::positionsUtc(
+                        latitude, longitude, seconds, n
+                        , azimuth.given() ? azimuth.doubles() + start : 0
+                        , altitude.given() ? altitude.doubles() + start : 0
+                        , zenith.given() ? zenith.doubles() + start : 0
+                        , hourAngle.given() ? hourAngle.doubles() + start
+                                            : 0
+                        , backend);
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    Py_RETURN_NONE;
+}
+
+/*----------------------------------------------------------------------------
+Name         computeGot
+
+Purpose      _kernels.got(frequency, lower, higher, flux_low, flux_high,
+             beamwidth, hot, cold, solar_flux, beam_correction, got_ratio,
+             got_db): calculates the Gain Over Temperature of each of an
+             array of sessions, into the given columns;
+
+Input        pArgs              Eight float64 input buffers, each holding one
+                                entry per session, or a single entry for
+                                every session: the operating, lower, and
+                                higher frequencies in MHz; the solar flux at
+                                the lower and higher frequencies in sfu; the
+                                beamwidth in degrees; and the average of the
+                                hot and of the cold measurements in dB.  Then
+                                an output buffer or None for each column;
+
+Returns      PyObject*          None, or null with an exception set;
+
+Notes        The sessions are the length of the longest input.  Each one is
+             worked out by gotcore::computeGot, as by GotCalc;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+static PyObject* computeGot(PyObject*, PyObject* pArgs)
+{
+    static const char* const input_names[] =
+        {"frequency", "lower", "higher", "flux_low", "flux_high"
+         , "beamwidth", "hot", "cold"};
+    static const char* const output_names[] =
+        {"solar_flux", "beam_correction", "got_ratio", "got_db"};
+    const int input_count = 8;
+    const int output_count = 4;
+
+    PyObject* pObjects[input_count + output_count];
+    if (!PyArg_ParseTuple(pArgs, "OOOOOOOOOOOO:got", &pObjects[0]
+                          , &pObjects[1], &pObjects[2], &pObjects[3]
+                          , &pObjects[4], &pObjects[5], &pObjects[6]
+                          , &pObjects[7], &pObjects[8], &pObjects[9]
+                          , &pObjects[10], &pObjects[11]))
+    {
+        return 0;
+    }
+
+    Column inputs[input_count];
+    Column outputs[output_count];
+    size_t count = 0;
+    for (int i = 0; i < input_count; i++)
+    {
+        if (pObjects[i] == Py_None)
+        {
+            PyErr_Format(PyExc_TypeError, "%s must not be None"
+                         , input_names[i]);
+            return 0;
+        }
+        if (!inputs[i].acquire(pObjects[i], input_names[i], false))
+        {
+            return 0;
+        }
+        if (inputs[i].size() > count)
+        {
+            count = inputs[i].size();
+        }
+    }
+    for (int i = 0; i < input_count; i++)
+    {
+        if (!checkInput(inputs[i], input_names[i], count))
+        {
+            return 0;
+        }
+    }
+    for (int i = 0; i < output_count; i++)
+    {
+        if (!outputs[i].acquire(pObjects[input_count + i], output_names[i]
+                                , true)
+            || !checkOutput(outputs[i], output_names[i], count))
+        {
+            return 0;
+        }
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    for (size_t i = 0; i < count; i++)
+    {
+        gotcore::GotInputs session;
+        session.operatingFrequencyMHz = inputs[0].at(i);
+        session.lowerFrequencyMHz = inputs[1].at(i);
+        session.higherFrequencyMHz = inputs[2].at(i);
+        session.solarFluxLowSfu = inputs[3].at(i);
+        session.solarFluxHighSfu = inputs[4].at(i);
+        session.beamwidthDeg = inputs[5].at(i);
+        session.hotDb = inputs[6].at(i);
+        session.coldDb = inputs[7].at(i);
+
+        const gotcore::GotResult result = gotcore::computeGot(session);
+        const double values[output_count] = {result.solarFluxWm2Hz
+                                             , result.beamCorrectionFactor
+                                             , result.gotRatio
+                                             , result.gotDb};
+        for (int j = 0; j < output_count; j++)
+        {
+            if (outputs[j].given())
+            {
+                outputs[j].doubles()[i] = values[j];
+            }
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    Py_RETURN_NONE;
+}
+
+/*----------------------------------------------------------------------------
+Name         meanPowerDb
+
+Purpose      _kernels.mean_power_db(levels): returns the mean power of an
+             array of levels in dB, averaged as power ratios, in dB;
+
+Returns      PyObject*          The mean, or null with an exception set;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+static PyObject* meanPowerDb(PyObject*, PyObject* pArgs)
+{
+    PyObject* pLevels;
+    if (!PyArg_ParseTuple(pArgs, "O:mean_power_db", &pLevels))
+    {
+        return 0;
+    }
+
+    Column levels;
+    if (pLevels == Py_None || !levels.acquire(pLevels, "levels", false))
+    {
+        if (!PyErr_Occurred())
+        {
+            PyErr_SetString(PyExc_TypeError, "levels must not be None");
+        }
+        return 0;
+    }
+
+    double mean;
+    Py_BEGIN_ALLOW_THREADS
+    mean = gotcore::meanPowerDb(levels.doubles(), levels.size());
+    Py_END_ALLOW_THREADS
+
+    return PyFloat_FromDouble(mean);
+}
+
+/*----------------------------------------------------------------------------
+Name         bracketingFrequencies
+
+Purpose      _kernels.bracketing_frequencies(frequency): returns the
+             available solar flux frequencies either side of an operating
+             frequency, as a (lower, higher) tuple;
+
+Returns      PyObject*          The tuple, or null with ValueError set if the
+                                frequency is out of range;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+static PyObject* bracketingFrequencies(PyObject*, PyObject* pArgs)
+{
+    double frequency;
+    if (!PyArg_ParseTuple(pArgs, "d:bracketing_frequencies", &frequency))
+    {
+        return 0;
+    }
+
+    double lower;
+    double higher;
+    if (!gotcore::findBracketingFrequencies(frequency, lower, higher))
+    {
+        // PyErr_Format has no %g;
+        char message[80];
+        snprintf(message, sizeof(message)
+                 , "no solar flux frequencies either side of %g MHz"
+                 , frequency);
+        PyErr_SetString(PyExc_ValueError, message);
+        return 0;
+    }
+    return Py_BuildValue("(dd)", lower, higher);
+}
+
+static PyMethodDef kernel_methods[] =
+{
+    {"sun_positions", sunPositions, METH_VARARGS
+     , "sun_positions(latitude, longitude, utc, azimuth, altitude, zenith,"
+       " hour_angle, backend='libm')\n\n"
+       "Calculates the position of the sun into the output buffers."},
+    {"got", computeGot, METH_VARARGS
+     , "got(frequency, lower, higher, flux_low, flux_high, beamwidth, hot,"
+       " cold, solar_flux, beam_correction, got_ratio, got_db)\n\n"
+       "Calculates the G/T of each session into the output buffers."},
+    {"mean_power_db", meanPowerDb, METH_VARARGS
+     , "mean_power_db(levels) -> mean power of the levels, in dB"},
+    {"bracketing_frequencies", bracketingFrequencies, METH_VARARGS
+     , "bracketing_frequencies(frequency) -> (lower, higher)"},
+    {0, 0, 0, 0}
+};
+
+static PyModuleDef kernel_module =
+{
+    PyModuleDef_HEAD_INIT, "gotcore._kernels"
+    , "Batch sun position and G/T kernels over Python buffers.", -1
+    , kernel_methods, 0, 0, 0, 0
+};
+
+PyMODINIT_FUNC PyInit__kernels(void)
+{
+    return PyModule_Create(&kernel_module);
+}
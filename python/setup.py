@@ -0,0 +1,68 @@
+"""Builds the gotcore Python package from the gotcore sources.
+
+    pip install ./python
+
+The sources and compiler flags are those of gotcore.pri, so the kernels
+are built as the C++ tools build them.  Built from the repository, the
+sources are first copied into core/ beside this file, so that every path
+the build, and an sdist, needs lies inside the package directory.  An
+sdist carries core/ with it and builds from that alone.
+"""
+
+import os
+import shutil
+
+from setuptools import Extension, setup
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+CORE = "core"
+
+# The sources and headers of gotcore.pri;
+CORE_SOURCES = ["solarmath.cpp", "fluxspectrum.cpp", "runningstats.cpp",
+                "powerstats.cpp", "gotcore.cpp"]
+CORE_HEADERS = ["solarmath.h", "fastmath.h", "fluxspectrum.h",
+                "runningstats.h", "powerstats.h", "gotcore.h"]
+
+# The flags of gotcore.pri, for GCC and Clang;
+CORE_FLAGS = ["-std=c++11", "-fno-math-errno", "-fno-trapping-math"]
+if os.name == "nt":
+    CORE_FLAGS = []
+
+
+def copy_core():
+    """Copies the gotcore sources into core/ when building from the
+    repository, where they are newer than any copy already there."""
+    if not os.path.exists(os.path.join(ROOT, "gotcore.pri")):
+        return
+    target = os.path.join(HERE, CORE)
+    if not os.path.isdir(target):
+        os.mkdir(target)
+    for name in CORE_SOURCES + CORE_HEADERS:
+        source = os.path.join(ROOT, name)
+        copy = os.path.join(target, name)
+        if (not os.path.exists(copy)
+                or os.path.getmtime(copy) < os.path.getmtime(source)):
+            shutil.copy2(source, copy)
+
+
+copy_core()
+
+kernels = Extension(
+    "gotcore._kernels",
+    sources=["gotcoremodule.cpp"]
+    + [CORE + "/" + name for name in CORE_SOURCES],
+    depends=[CORE + "/" + name for name in CORE_HEADERS],
+    include_dirs=[CORE],
+    extra_compile_args=CORE_FLAGS,
+    language="c++",
+)
+
+setup(
+    name="gotcore",
+    version="1.0.0",
+    description="Sun position and G/T calculations of the GOT application",
+    packages=["gotcore"],
+    ext_modules=[kernels],
+    install_requires=["numpy"],
+)
@@ -0,0 +1,143 @@
+"""Checks of the gotcore Python package.
+
+    pip install ./python && python -m pytest python/tests
+
+The reference values were printed by the C++ core, gotcore::sunPositions
+and gotcore::computeGot, for the same inputs, so a difference here is a
+difference between the package and the C++ tools.  They are compared to a
+relative 1e-12 rather than to the bit, as the compiler may contract the
+arithmetic differently in the two builds.
+"""
+
+import numpy as np
+import pytest
+
+import gotcore
+
+# The site and instants of the references: the SPA example site at
+# 17 Oct 2003 19:30:30 UTC, half a second later, and 14 Nov 2023 22:13:20;
+LATITUDE = 39.742476
+LONGITUDE = -105.1786
+UTC = np.array([1066419030.0, 1066419030.5, 1700000000.0])
+
+# Azimuth, altitude, zenith, and hour angle at each instant, from the C++
+# core with the libm backend;
+POSITIONS = np.array([
+    [194.27115411609282, 38.84916214356474, 51.15083785643526,
+     11.25325489050698],
+    [194.27373648564156, 38.848767215322596, 51.151232784677404,
+     11.25533822384034],
+    [230.11972968057148, 13.968576603534373, 76.031423396465627,
+     51.923420842344967],
+])
+
+# Solar flux, beam correction, and G/T as a ratio and in dB of a 2300 MHz
+# session: 1.5 degree beam, hot 12 dB, cold 2 dB, 70 and 95 sfu;
+GOT = (8.7285156249999997e-21, 1.0608, 22.339499780000704, 13.4907344428462)
+
+
+def test_positions_match_the_core():
+    positions = gotcore.sun_positions(LATITUDE, LONGITUDE, UTC)
+    np.testing.assert_allclose(np.array(positions).T, POSITIONS, rtol=1e-12)
+
+
+def test_polynomial_backend_agrees():
+    libm = gotcore.sun_positions(LATITUDE, LONGITUDE, UTC)
+    poly = gotcore.sun_positions(LATITUDE, LONGITUDE, UTC,
+                                 backend="polynomial")
+    np.testing.assert_allclose(poly, libm, rtol=0, atol=1e-9)
+    with pytest.raises(ValueError):
+        gotcore.sun_positions(LATITUDE, LONGITUDE, UTC, backend="fast")
+
+
+def test_datetime64_is_read_as_the_instant():
+    seconds = gotcore.sun_positions(LATITUDE, LONGITUDE, UTC)
+    for unit in ("ms", "us", "ns"):
+        instants = (UTC * 1000).astype("datetime64[ms]").astype(
+            "datetime64[%s]" % unit)
+        np.testing.assert_array_equal(
+            gotcore.sun_positions(LATITUDE, LONGITUDE, instants), seconds)
+
+
+@pytest.mark.parametrize("dtype", [np.int64, np.int32, np.uint64, np.bool_])
+def test_integer_instants_are_refused(dtype):
+    with pytest.raises(TypeError):
+        gotcore.sun_positions(LATITUDE, LONGITUDE,
+                              np.array([1700000000], dtype=dtype))
+
+
+def test_integer_scalar_is_refused():
+    with pytest.raises(TypeError):
+        gotcore.sun_positions(LATITUDE, LONGITUDE, 1700000000)
+
+
+def test_strided_and_shaped_instants():
+    every = np.repeat(UTC, 2)
+    positions = gotcore.sun_positions(LATITUDE, LONGITUDE, every[::2])
+    np.testing.assert_allclose(np.array(positions).T, POSITIONS, rtol=1e-12)
+
+    grid = np.tile(UTC, (2, 1))
+    azimuth = gotcore.sun_positions(LATITUDE, LONGITUDE, grid)[0]
+    assert azimuth.shape == (2, 3)
+    np.testing.assert_allclose(azimuth[1], POSITIONS[:, 0], rtol=1e-12)
+
+
+def test_outputs_are_filled_in_place():
+    out = tuple(np.empty(3) for _ in range(4))
+    positions = gotcore.sun_positions(LATITUDE, LONGITUDE, UTC, out=out)
+    assert all(a is b for a, b in zip(positions, out))
+    np.testing.assert_allclose(out[0], POSITIONS[:, 0], rtol=1e-12)
+
+
+def _outputs(first):
+    """Returns four outputs for three instants, the first given."""
+    return (first,) + tuple(np.empty(3) for _ in range(3))
+
+
+@pytest.mark.parametrize("first", [
+    np.empty(3, dtype=np.float32),
+    np.empty(4),
+    np.empty(6)[::2],
+    np.empty((3, 1)),
+    [0.0, 0.0, 0.0],
+])
+def test_unsuitable_outputs_are_refused(first):
+    with pytest.raises(ValueError):
+        gotcore.sun_positions(LATITUDE, LONGITUDE, UTC, out=_outputs(first))
+
+
+def test_read_only_output_is_refused():
+    first = np.empty(3)
+    first.flags.writeable = False
+    with pytest.raises(ValueError):
+        gotcore.sun_positions(LATITUDE, LONGITUDE, UTC, out=_outputs(first))
+
+
+def test_got_matches_the_core():
+    result = gotcore.got(2300, 12, 2, 1.5, 70, 95)
+    np.testing.assert_allclose([column[0] for column in result], GOT,
+                               rtol=1e-12)
+    given = gotcore.got(2300, 12, 2, 1.5, 70, 95, lower=1415, higher=2695)
+    np.testing.assert_array_equal(given, result)
+
+
+def test_got_broadcasts_scalars():
+    hot = np.array([12.0, 12.0, 13.0])
+    result = gotcore.got(2300, hot, 2, 1.5, 70, 95)
+    assert result[3].shape == (3,)
+    assert result[3][0] == result[3][1]
+    np.testing.assert_allclose(result[3][0], GOT[3], rtol=1e-12)
+    assert result[3][2] > result[3][0]
+
+
+def test_mean_power_db():
+    levels = np.array([12.0, 12.5, 11.5, 12.2])
+    np.testing.assert_allclose(gotcore.mean_power_db(levels),
+                               12.065086074926754, rtol=1e-12)
+    assert gotcore.mean_power_db(levels) > levels.mean()
+
+
+def test_bracketing_frequencies():
+    assert gotcore.bracketing_frequencies(2300) == (1415.0, 2695.0)
+    with pytest.raises(ValueError):
+        gotcore.bracketing_frequencies(100000)
@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Client and load tester of got-daemon.  Links
+# QtCore only;
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = got-query
+TEMPLATE = app
+
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+INCLUDEPATH += ../daemon
+
+SOURCES += main.cpp \
+    ../daemon/queryprotocol.cpp
+
+HEADERS += ../daemon/queryprotocol.h
@@ -0,0 +1,507 @@
+/*----------------------------------------------------------------------------
+Name         main.cpp
+
+Purpose      Client of got-daemon.  Asks the daemon for the sun's position
+             or a G/T ratio and prints the answer, or loads the daemon with
+             requests from many connections and reports its latency and
+             throughput;
+
+Notes        In the load test each connection sends a request, waits for the
+             answer, and sends the next, so the latencies are those a client
+             sees and the number of connections sets how many requests the
+             daemon can coalesce into a batch;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include <QCoreApplication> // USES QCoreApplication for the argument list;
+#include <QCommandLineParser> // USES QCommandLineParser to read arguments;
+#include <QDateTime> // USES QDateTime for the default instant;
+#include <QDir> // USES QDir for the default socket path;
+#include <QFile>
+#include <QTextStream>
+#include "queryprotocol.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm> // USES std::sort for the latency percentiles;
+#include <atomic> // USES std::atomic to start the load test together;
+#include <chrono> // USES std::chrono::steady_clock to time requests;
+#include <functional> // USES std::ref to pass each thread its results;
+#include <thread> // USES std::thread for each connection of a load test;
+
+namespace
+{
+    // A blocking connection to the daemon;
+    class Client
+    {
+    public:
+        Client() : mFd(-1) {} // Constructor;
+        ~Client() // Destructor, closes the connection;
+        {
+            if (mFd >= 0)
+            {
+                close(mFd);
+            }
+        }
+
+        // Connects to the daemon's socket;
+        bool connectTo(const QString& rPath, QString& rError)
+        {
+            const QByteArray path = QFile::encodeName(rPath);
+            sockaddr_un address;
+            memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            if (path.size() >= static_cast<int>(sizeof(address.sun_path)))
+            {
+                rError = "The socket path is too long: " + rPath;
+                return false;
+            }
+            memcpy(address.sun_path, path.constData(), path.size());
+
+            mFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (mFd < 0 || ::connect(mFd
+                                     , reinterpret_cast<sockaddr*>(&address)
+                                     , sizeof(address)) != 0)
+            {
+                rError = "Unable to connect to " + rPath + ": "
+                        + QString::fromLocal8Bit(strerror(errno));
+                return false;
+            }
+
+            return true;
+        }
+
+        // Sends frames, returning once all are written;
+        bool send(const QByteArray& rFrames)
+        {
+            int written = 0;
+            while (written < rFrames.size())
+            {
+                const ssize_t sent = ::send(mFd, rFrames.constData() + written
+                                            , rFrames.size() - written
+                                            , MSG_NOSIGNAL);
+                if (sent < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (sent <= 0)
+                {
+                    return false;
+                }
+                written += static_cast<int>(sent);
+            }
+
+            return true;
+        }
+
+        // Receives the next response;
+        bool receive(queryprotocol::Response& rResponse, QString& rError)
+        {
+            bool tooLarge = false;
+            int length = 0;
+            while ((length = queryprotocol::frameLength(mInput.constData()
+                                                        , mInput.size()
+                                                        , tooLarge)) == 0)
+            {
+                if (tooLarge)
+                {
+                    rError = "Response too large";
+                    return false;
+                }
+
+                char buffer[64 * 1024];
+                const ssize_t got = read(mFd, buffer, sizeof(buffer));
+                if (got < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (got <= 0)
+                {
+                    rError = "The daemon closed the connection";
+                    return false;
+                }
+                mInput.append(buffer, static_cast<int>(got));
+            }
+
+            const bool decoded = queryprotocol::decodeResponse(
+                        mInput.constData() + queryprotocol::length_bytes
+                        , length - queryprotocol::length_bytes, rResponse
+                        , rError);
+            mInput.remove(0, length);
+            return decoded;
+        }
+
+    private:
+        Q_DISABLE_COPY(Client)
+
+        int mFd; // The socket;
+        QByteArray mInput; // Bytes read which are not yet a whole frame;
+    };
+
+    // Reads a comma separated list of numbers;
+    bool readList(const QString& rText, std::vector<double>& rValues)
+    {
+        rValues.clear();
+        const QStringList parts = rText.split(',', QString::SkipEmptyParts);
+        for (int i = 0; i < parts.size(); i++)
+        {
+            bool ok = false;
+            rValues.push_back(parts.at(i).trimmed().toDouble(&ok));
+            if (!ok)
+            {
+                return false;
+            }
+        }
+
+        return !rValues.empty();
+    }
+
+    // Results of one connection of a load test;
+    struct LoadResult
+    {
+        std::vector<double> latencies; // Seconds, one per request;
+        quint64 errors; // Requests answered with an error;
+        QString failure; // Why the connection stopped, if it did;
+
+        LoadResult() : errors(0) {}
+    };
+
+    // Runs one connection of a load test;
+    void runLoadConnection(const QString& rPath, const int& rRequests
+                           , const QByteArray& rFrame
+                           , const std::atomic<bool>& rGo
+                           , LoadResult& rResult)
+    {
+        Client client;
+        if (!client.connectTo(rPath, rResult.failure))
+        {
+            return;
+        }
+
+        while (!rGo.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+
+        rResult.latencies.reserve(rRequests);
+        queryprotocol::Response response;
+        for (int i = 0; i < rRequests; i++)
+        {
+            const std::chrono::steady_clock::time_point sent
+                    = std::chrono::steady_clock::now();
+            if (!client.send(rFrame))
+            {
+                rResult.failure = "Unable to send a request";
+                return;
+            }
+            if (!client.receive(response, rResult.failure))
+            {
+                return;
+            }
+            rResult.latencies.push_back(std::chrono::duration<double>(
+                                            std::chrono::steady_clock::now()
+                                            - sent).count());
+            if (response.type == queryprotocol::ErrorResponse)
+            {
+                rResult.errors++;
+            }
+        }
+    }
+
+    // Returns the latency below which a fraction of the sorted latencies
+    // fall;
+    double percentile(const std::vector<double>& rSorted
+                      , const double& rFraction)
+    {
+        if (rSorted.empty())
+        {
+            return 0;
+        }
+
+        const size_t index = static_cast<size_t>(rFraction
+                                                 * (rSorted.size() - 1) + 0.5);
+        return rSorted[std::min(index, rSorted.size() - 1)];
+    }
+
+    // Loads the daemon from many connections at once and reports;
+    int runLoad(const QString& rPath, const int& rConnections
+                , const int& rRequests, const QByteArray& rFrame
+                , const int& rInstants, QTextStream& rOut
+                , QTextStream& rErr)
+    {
+        std::vector<LoadResult> results(rConnections);
+        std::vector<std::thread> threads;
+        std::atomic<bool> go(false);
+        for (int i = 0; i < rConnections; i++)
+        {
+            threads.push_back(std::thread(runLoadConnection, rPath, rRequests
+                                          , rFrame, std::cref(go)
+                                          , std::ref(results[i])));
+        }
+
+        const std::chrono::steady_clock::time_point start
+                = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (size_t i = 0; i < threads.size(); i++)
+        {
+            threads[i].join();
+        }
+        const double elapsed = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count();
+
+        std::vector<double> latencies;
+        quint64 errors = 0;
+        int failed = 0;
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            latencies.insert(latencies.end(), results[i].latencies.begin()
+                             , results[i].latencies.end());
+            errors += results[i].errors;
+            if (!results[i].failure.isEmpty())
+            {
+                if (failed == 0)
+                {
+                    rErr << results[i].failure << endl;
+                }
+                failed++;
+            }
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        const double answered = static_cast<double>(latencies.size());
+        rOut << "connections " << rConnections
+             << ", requests " << latencies.size()
+             << ", errors " << errors
+             << ", failed connections " << failed << endl;
+        rOut << "throughput " << qRound64(answered / elapsed)
+             << " requests/s";
+        if (rInstants > 0)
+        {
+            rOut << ", " << qRound64(answered * rInstants / elapsed)
+                 << " positions/s";
+        }
+        rOut << endl;
+        rOut << "latency p50 " << percentile(latencies, 0.5) * 1e6
+             << " us, p99 " << percentile(latencies, 0.99) * 1e6
+             << " us, max " << (latencies.empty() ? 0 : latencies.back() * 1e6)
+             << " us" << endl;
+
+        return (failed == 0 && errors == 0) ? 0 : 2;
+    }
+
+    // Prints a response;
+    void printResponse(const queryprotocol::Response& rResponse
+                       , const std::vector<double>& rUtcSeconds
+                       , QTextStream& rOut)
+    {
+        if (rResponse.type == queryprotocol::SunResponse)
+        {
+            rOut << "utc,azimuth,altitude,zenith,hour_angle" << endl;
+            for (size_t i = 0; i < rResponse.azimuthDeg.size(); i++)
+            {
+                rOut << QString::number(rUtcSeconds[i], 'f', 3) << ','
+                     << QString::number(rResponse.azimuthDeg[i], 'f', 6) << ','
+                     << QString::number(rResponse.altitudeDeg[i], 'f', 6)
+                     << ','
+                     << QString::number(rResponse.zenithDeg[i], 'f', 6) << ','
+                     << QString::number(rResponse.hourAngleDeg[i], 'f', 6)
+                     << endl;
+            }
+        }
+        else
+        {
+            rOut << "got_db " << QString::number(rResponse.gotDb, 'f', 4)
+                 << endl
+                 << "got_ratio " << QString::number(rResponse.gotRatio, 'g', 8)
+                 << endl
+                 << "solar_flux "
+                 << QString::number(rResponse.solarFlux, 'f', 3) << endl;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("got-query");
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+                "Asks got-daemon for the sun's position or a G/T ratio, or"
+                " loads it with requests and reports latency and"
+                " throughput.");
+    parser.addHelpOption();
+
+    QCommandLineOption socketOption(QStringList() << "s" << "socket"
+                                    , "Path of the daemon's Unix socket."
+                                    , "path"
+                                    , QDir::tempPath() + "/got-daemon.sock");
+    QCommandLineOption gotOption("got"
+                                 , "Ask for a G/T ratio instead of the sun's"
+                                   " position.");
+    QCommandLineOption jsonOption("json"
+                                  , "Send JSON requests instead of binary.");
+    QCommandLineOption latitudeOption("latitude"
+                                      , "Latitude of the site, in degrees."
+                                      , "degrees", "0");
+    QCommandLineOption longitudeOption("longitude"
+                                       , "Longitude of the site, in degrees,"
+                                         " east positive."
+                                       , "degrees", "0");
+    QCommandLineOption utcOption("utc"
+                                 , "Comma separated instants, in seconds"
+                                   " since 1970 UTC.  Defaults to now."
+                                 , "seconds");
+    QCommandLineOption instantsOption("instants"
+                                      , "Instants a second apart to ask for,"
+                                        " from --utc, in each load test"
+                                        " request."
+                                      , "count", "1");
+    QCommandLineOption frequencyOption("frequency"
+                                       , "Operating frequency, in MHz."
+                                       , "mhz", "2300");
+    QCommandLineOption beamwidthOption("beamwidth"
+                                       , "Beamwidth, in degrees."
+                                       , "degrees", "2.5");
+    QCommandLineOption fluxLowOption("flux-low"
+                                     , "Solar flux at the lower bracketing"
+                                       " frequency."
+                                     , "sfu", "140");
+    QCommandLineOption fluxHighOption("flux-high"
+                                      , "Solar flux at the higher bracketing"
+                                        " frequency."
+                                      , "sfu", "150");
+    QCommandLineOption hotOption("hot"
+                                 , "Comma separated measurements on the sun,"
+                                   " in dB."
+                                 , "db", "-40.1,-40.0,-39.9");
+    QCommandLineOption coldOption("cold"
+                                  , "Comma separated measurements off the"
+                                    " sun, in dB."
+                                  , "db", "-45.1,-45.0,-44.9");
+    QCommandLineOption loadOption("load"
+                                  , "Load the daemon with requests and"
+                                    " report latency and throughput.");
+    QCommandLineOption connectionsOption("connections"
+                                         , "Connections of the load test."
+                                         , "count", "16");
+    QCommandLineOption requestsOption("requests"
+                                      , "Requests from each connection of"
+                                        " the load test."
+                                      , "count", "10000");
+    parser.addOption(socketOption);
+    parser.addOption(gotOption);
+    parser.addOption(jsonOption);
+    parser.addOption(latitudeOption);
+    parser.addOption(longitudeOption);
+    parser.addOption(utcOption);
+    parser.addOption(instantsOption);
+    parser.addOption(frequencyOption);
+    parser.addOption(beamwidthOption);
+    parser.addOption(fluxLowOption);
+    parser.addOption(fluxHighOption);
+    parser.addOption(hotOption);
+    parser.addOption(coldOption);
+    parser.addOption(loadOption);
+    parser.addOption(connectionsOption);
+    parser.addOption(requestsOption);
+    parser.process(app);
+
+    const bool json = parser.isSet(jsonOption);
+    const bool load = parser.isSet(loadOption);
+
+    // Build the request;
+    QByteArray frame;
+    std::vector<double> utcSeconds;
+    int instants = 0;
+    if (parser.isSet(gotOption))
+    {
+        std::vector<double> hot;
+        std::vector<double> cold;
+        if (!readList(parser.value(hotOption), hot)
+                || !readList(parser.value(coldOption), cold))
+        {
+            err << "--hot and --cold need comma separated numbers" << endl;
+            return 1;
+        }
+
+        queryprotocol::appendGotRequest(frame, json, 1
+                                        , parser.value(frequencyOption)
+                                          .toDouble()
+                                        , parser.value(beamwidthOption)
+                                          .toDouble()
+                                        , parser.value(fluxLowOption)
+                                          .toDouble()
+                                        , parser.value(fluxHighOption)
+                                          .toDouble()
+                                        , hot, cold);
+    }
+    else
+    {
+        if (parser.isSet(utcOption))
+        {
+            if (!readList(parser.value(utcOption), utcSeconds))
+            {
+                err << "--utc needs comma separated numbers" << endl;
+                return 1;
+            }
+        }
+        else
+        {
+            utcSeconds.push_back(
+                        QDateTime::currentMSecsSinceEpoch() / 1000.0);
+        }
+
+        // A load test asks for --instants a second apart from the first;
+        if (load)
+        {
+            instants = qMax(1, parser.value(instantsOption).toInt());
+            utcSeconds.resize(instants);
+            for (int i = 1; i < instants; i++)
+            {
+                utcSeconds[i] = utcSeconds[0] + i;
+            }
+        }
+
+        queryprotocol::appendSunRequest(frame, json, 1
+                                        , parser.value(latitudeOption)
+                                          .toDouble()
+                                        , parser.value(longitudeOption)
+                                          .toDouble()
+                                        , utcSeconds.data()
+                                        , static_cast<int>(utcSeconds.size()));
+    }
+
+    if (load)
+    {
+        return runLoad(parser.value(socketOption)
+                       , qMax(1, parser.value(connectionsOption).toInt())
+                       , qMax(1, parser.value(requestsOption).toInt())
+                       , frame, instants, out, err);
+    }
+
+    Client client;
+    QString error;
+    queryprotocol::Response response;
+    if (!client.connectTo(parser.value(socketOption), error)
+            || !client.send(frame) || !client.receive(response, error))
+    {
+        err << (error.isEmpty() ? QString("Unable to send the request")
+                                : error) << endl;
+        return 1;
+    }
+
+    if (response.type == queryprotocol::ErrorResponse)
+    {
+        err << response.error << endl;
+        return 2;
+    }
+
+    printResponse(response, utcSeconds, out);
+    return 0;
+}
@@ -0,0 +1,1356 @@
+/*----------------------------------------------------------------------------
+Name         radiometercapture.cpp
+
+Purpose      Compressed capture file of the raw power samples of a radiometer,
+             written in chunks as the samples arrive and read back through a
+             memory map, one time range at a time;
+
+Notes        A capture file is a header, then the chunks, then an index of the
+             chunks and a footer which locates the index.  Each chunk holds a
+             run of samples as two columns, the times and then the values,
+             each compressed on its own:
+
+             Times, in microseconds since the epoch, are stored as the change
+             in the interval between samples (delta of delta).  A radiometer
+             samples at a steady rate, so nearly every sample costs one bit;
+
+             Values are stored as the XOR of each value with the one before,
+             giving the count of leading and trailing zero bits and only the
+             bits between.  Successive samples of a steady signal share their
+             sign, exponent, and upper mantissa, so these bits are zero;
+
+             Every chunk has a header giving its time span, its range of
+             values, and the size of each column, so the file can be read
+             back without the index.  The index and footer are only written
+             by close(); a capture which was not closed, for instance after a
+             crash, is read by scanning the chunk headers, and can be
+             reopened to append to, which rewrites the index;
+
+             A range is read by a binary search of the index for its first
+             chunk, then decompressing only the chunks the range overlaps.
+             Everything is written in the byte order of the machine, which is
+             checked when the file is opened;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Reject a window of bits past the end of a value;
+----------------------------------------------------------------------------*/
+#include "radiometercapture.h"
+
+#include <QDateTime> // USES QDateTime to stamp the file header;
+#include <QtAlgorithms> // USES qCountLeadingZeroBits and the like;
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    // Header at the start of the capture file;
+    struct FileHeader
+    {
+        char magic[8]; // "GOTCAPT", null terminated;
+        quint32 version; // Version of the layout;
+        quint32 headerSize; // Size of this header, in bytes;
+        quint32 byteOrderMark; // byte_order_mark, as written;
+        quint32 reserved; // Zero;
+        qint64 created; // When the file was created, ms since the epoch;
+    };
+
+    // Header at the start of each chunk, followed by the two columns;
+    struct ChunkHeader
+    {
+        quint32 magic; // chunk_magic;
+        quint32 sampleCount; // Number of samples;
+        qint64 firstTime; // Time of the first sample;
+        qint64 lastTime; // Time of the last sample;
+        double minimum; // Smallest sample;
+        double maximum; // Largest sample;
+        quint32 timeBytes; // Size of the time column;
+        quint32 valueBytes; // Size of the value column;
+    };
+
+    // Entry of the index, one per chunk;
+    struct IndexEntry
+    {
+        qint64 firstTime; // Time of the first sample;
+        qint64 lastTime; // Time of the last sample;
+        qint64 offset; // Offset of the chunk header within the file;
+        quint32 sampleCount; // Number of samples;
+        quint32 reserved; // Zero;
+        double minimum; // Smallest sample;
+        double maximum; // Largest sample;
+    };
+
+    // Footer at the end of a closed file;
+    struct Footer
+    {
+        qint64 indexOffset; // Offset of the first index entry;
+        qint64 sampleCount; // Number of samples in the file;
+        quint32 chunkCount; // Number of index entries;
+        quint32 magic; // index_magic;
+    };
+
+    const char file_magic[8] = "GOTCAPT";
+    const quint32 file_version = 1;
+    const quint32 byte_order_mark = 0x01020304;
+    const quint32 chunk_magic = 0x4b484347; // "GCHK";
+    const quint32 index_magic = 0x58444947; // "GIDX";
+
+    // Writes a stream of bits, most significant first;
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<uchar>& rBytes)
+            : mBytes(rBytes)
+            , mBuffer(0)
+            , mBits(0)
+        {
+            mBytes.clear();
+        }
+
+        // Writes the low bits of a value, up to 32 at a time;
+        void write(const quint64& rValue, const int& rBits)
+        {
+            const quint64 mask = (Q_UINT64_C(1) << rBits) - 1;
+            mBuffer = (mBuffer << rBits) | (rValue & mask);
+            mBits += rBits;
+            while (mBits >= 8)
+            {
+                mBits -= 8;
+                mBytes.push_back(static_cast<uchar>(mBuffer >> mBits));
+            }
+        }
+
+        // Writes all 64 bits of a value;
+        void write64(const quint64& rValue)
+        {
+            write(rValue >> 32, 32);
+            write(rValue, 32);
+        }
+
+        // Pads the stream out to a whole byte;
+        void finish(void)
+        {
+            if (mBits > 0)
+            {
+                write(0, 8 - mBits);
+            }
+        }
+
+    private:
+        std::vector<uchar>& mBytes;
+        quint64 mBuffer;
+        int mBits;
+    };
+
+    // Reads a stream of bits written by BitWriter;
+    class BitReader
+    {
+    public:
+        BitReader(const uchar* pBytes, const size_t& rSize)
+            : mpBytes(pBytes)
+            , mSize(rSize)
+            , mPosition(0)
+            , mBuffer(0)
+            , mBits(0)
+        {
+        }
+
+        // Reads up to 32 bits.  Reads beyond the end give zero bits;
+        quint64 read(const int& rBits)
+        {
+            while (mBits < rBits)
+            {
+                const uchar byte = (mPosition < mSize) ? mpBytes[mPosition] : 0;
+                mPosition++;
+                mBuffer = (mBuffer << 8) | byte;
+                mBits += 8;
+            }
+
+            mBits -= rBits;
+            return (mBuffer >> mBits) & ((Q_UINT64_C(1) << rBits) - 1);
+        }
+
+        // Reads all 64 bits of a value;
+        quint64 read64(void)
+        {
+            const quint64 high = read(32);
+            return (high << 32) | read(32);
+        }
+
+        // Whether the reads went beyond the end of the stream;
+        bool overrun(void) const
+        {
+            return mPosition > mSize;
+        }
+
+    private:
+        const uchar* mpBytes;
+        size_t mSize;
+        size_t mPosition;
+        quint64 mBuffer;
+        int mBits;
+    };
+
+    // Returns a value of the given width, sign extended;
+    inline qint64 signExtend(const quint64& rValue, const int& rBits)
+    {
+        const quint64 sign = Q_UINT64_C(1) << (rBits - 1);
+        return static_cast<qint64>((rValue ^ sign) - sign);
+    }
+
+    // Whether a value fits in the given width, signed;
+    inline bool fits(const qint64& rValue, const int& rBits)
+    {
+        const qint64 limit = Q_INT64_C(1) << (rBits - 1);
+        return rValue >= -limit && rValue < limit;
+    }
+
+    // Compresses the times after the first, which is kept in the header;
+    void encodeTimes(const qint64* pTimes, size_t count, BitWriter& rOut)
+    {
+        qint64 previousDelta = 0;
+        for (size_t i = 1; i < count; i++)
+        {
+            const qint64 delta = pTimes[i] - pTimes[i - 1];
+            const qint64 dod = delta - previousDelta;
+            previousDelta = delta;
+
+            if (dod == 0)
+            {
+                rOut.write(0, 1);
+            }
+            else if (fits(dod, 7))
+            {
+                rOut.write(0x2, 2);
+                rOut.write(dod, 7);
+            }
+            else if (fits(dod, 12))
+            {
+                rOut.write(0x6, 3);
+                rOut.write(dod, 12);
+            }
+            else if (fits(dod, 20))
+            {
+                rOut.write(0xe, 4);
+                rOut.write(dod, 20);
+            }
+            else
+            {
+                rOut.write(0xf, 4);
+                rOut.write64(dod);
+            }
+        }
+        rOut.finish();
+    }
+
+    // Decompresses the times of a chunk;
+    void decodeTimes(BitReader& rIn, const qint64& rFirst, size_t count
+                     , qint64* pTimes)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        pTimes[0] = rFirst;
+        qint64 delta = 0;
+        for (size_t i = 1; i < count; i++)
+        {
+            qint64 dod = 0;
+            if (rIn.read(1) != 0)
+            {
+                if (rIn.read(1) == 0)
+                {
+                    dod = signExtend(rIn.read(7), 7);
+                }
+                else if (rIn.read(1) == 0)
+                {
+                    dod = signExtend(rIn.read(12), 12);
+                }
+                else if (rIn.read(1) == 0)
+                {
+                    dod = signExtend(rIn.read(20), 20);
+                }
+                else
+                {
+                    dod = static_cast<qint64>(rIn.read64());
+                }
+            }
+
+            delta += dod;
+            pTimes[i] = pTimes[i - 1] + delta;
+        }
+    }
+
+    // Returns the bits of a double;
+    inline quint64 toBits(const double& rValue)
+    {
+        quint64 bits;
+        memcpy(&bits, &rValue, sizeof(bits));
+        return bits;
+    }
+
+    // Returns the double of some bits;
+    inline double fromBits(const quint64& rBits)
+    {
+        double value;
+        memcpy(&value, &rBits, sizeof(value));
+        return value;
+    }
+
+    // Compresses the values of a chunk;
+    void encodeValues(const double* pValues, size_t count, BitWriter& rOut)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        quint64 previous = toBits(pValues[0]);
+        rOut.write64(previous);
+
+        // The window of meaningful bits of the last value written in full;
+        int leading = -1;
+        int trailing = 0;
+
+        for (size_t i = 1; i < count; i++)
+        {
+            const quint64 bits = toBits(pValues[i]);
+            const quint64 xorBits = bits ^ previous;
+            previous = bits;
+
+            if (xorBits == 0)
+            {
+                rOut.write(0, 1);
+                continue;
+            }
+
+            rOut.write(1, 1);
+
+            const int newLeading = qMin(31u, qCountLeadingZeroBits(xorBits));
+            const int newTrailing = qCountTrailingZeroBits(xorBits);
+
+            // Reuse the window when the meaningful bits fall within it;
+            if (leading >= 0
+                    && newLeading >= leading && newTrailing >= trailing)
+            {
+                const int length = 64 - leading - trailing;
+                rOut.write(0, 1);
+                if (length > 32)
+                {
+                    rOut.write((xorBits >> trailing) >> 32, length - 32);
+                    rOut.write(xorBits >> trailing, 32);
+                }
+                else
+                {
+                    rOut.write(xorBits >> trailing, length);
+                }
+                continue;
+            }
+
+            leading = newLeading;
+            trailing = newTrailing;
+            const int length = 64 - leading - trailing;
+
+            rOut.write(1, 1);
+            rOut.write(leading, 5);
+            rOut.write(length & 0x3f, 6); // 64 is written as 0;
+            if (length > 32)
+            {
+                rOut.write((xorBits >> trailing) >> 32, length - 32);
+                rOut.write(xorBits >> trailing, 32);
+            }
+            else
+            {
+                rOut.write(xorBits >> trailing, length);
+            }
+        }
+        rOut.finish();
+    }
+
+    // Decompresses the values of a chunk, returning false if a window of
+    // meaningful bits runs past the end of a value;
+    bool decodeValues(BitReader& rIn, size_t count, double* pValues)
+    {
+        if (count == 0)
+        {
+            return true;
+        }
+
+        quint64 previous = rIn.read64();
+        pValues[0] = fromBits(previous);
+
+        int leading = 0;
+        int trailing = 0;
+
+        for (size_t i = 1; i < count; i++)
+        {
+            if (rIn.read(1) != 0)
+            {
+                if (rIn.read(1) != 0)
+                {
+                    leading = static_cast<int>(rIn.read(5));
+                    int length = static_cast<int>(rIn.read(6));
+                    length = (length == 0) ? 64 : length;
+                    if (leading + length > 64)
+                    {
+                        return false;
+                    }
+                    trailing = 64 - leading - length;
+                }
+
+                const int length = 64 - leading - trailing;
+                quint64 meaningful;
+                if (length > 32)
+                {
+                    const quint64 high = rIn.read(length - 32);
+                    meaningful = (high << 32) | rIn.read(32);
+                }
+                else
+                {
+                    meaningful = rIn.read(length);
+                }
+
+                previous ^= meaningful << trailing;
+            }
+
+            pValues[i] = fromBits(previous);
+        }
+        return true;
+    }
+
+    // Decompresses a chunk of a mapped file;
+    bool decodeChunk(const uchar* pData
+                     , const qint64& rSize
+                     , const CaptureChunk& rChunk
+                     , std::vector<qint64>& rTimes
+                     , std::vector<double>& rValues)
+    {
+        if (rChunk.offset + static_cast<qint64>(sizeof(ChunkHeader)) > rSize)
+        {
+            return false;
+        }
+
+        ChunkHeader header;
+        memcpy(&header, pData + rChunk.offset, sizeof(header));
+
+        if (header.magic != chunk_magic
+                || header.sampleCount != rChunk.sampleCount
+                || rChunk.offset + static_cast<qint64>(sizeof(ChunkHeader))
+                   + header.timeBytes + header.valueBytes > rSize)
+        {
+            return false;
+        }
+
+        const uchar* pTimes = pData + rChunk.offset + sizeof(header);
+        const uchar* pValues = pTimes + header.timeBytes;
+
+        rTimes.resize(header.sampleCount);
+        rValues.resize(header.sampleCount);
+
+        BitReader times(pTimes, header.timeBytes);
+        decodeTimes(times, header.firstTime, header.sampleCount, rTimes.data());
+
+        BitReader values(pValues, header.valueBytes);
+        if (!decodeValues(values, header.sampleCount, rValues.data()))
+        {
+            return false;
+        }
+
+        return !times.overrun() && !values.overrun()
+                && (header.sampleCount == 0
+                    || rTimes.back() == header.lastTime);
+    }
+
+    // Checks the header of a mapped file;
+    bool validHeader(const uchar* pData, const qint64& rSize)
+    {
+        if (rSize < static_cast<qint64>(sizeof(FileHeader)))
+        {
+            return false;
+        }
+
+        FileHeader header;
+        memcpy(&header, pData, sizeof(header));
+
+        return qstrncmp(header.magic, file_magic, sizeof(file_magic)) == 0
+                && header.version == file_version
+                && header.byteOrderMark == byte_order_mark
+                && header.headerSize >= sizeof(FileHeader)
+                && header.headerSize <= rSize;
+    }
+
+    // Finds the chunks of a mapped file, from its index if it was closed,
+    // otherwise by scanning the chunk headers.  rEnd is set to the end of
+    // the last chunk, where appending continues;
+    void loadChunks(const uchar* pData
+                    , const qint64& rSize
+                    , QVector<CaptureChunk>& rChunks
+                    , qint64& rEnd
+                    , bool& rRecovered)
+    {
+        FileHeader header;
+        memcpy(&header, pData, sizeof(header));
+
+        rChunks.clear();
+
+        // The index, if the footer is intact;
+        if (rSize >= static_cast<qint64>(header.headerSize + sizeof(Footer)))
+        {
+            Footer footer;
+            memcpy(&footer, pData + rSize - sizeof(Footer), sizeof(footer));
+
+            if (footer.magic == index_magic
+                    && footer.indexOffset >= header.headerSize
+                    && footer.indexOffset + footer.chunkCount
+                       * static_cast<qint64>(sizeof(IndexEntry))
+                       + static_cast<qint64>(sizeof(Footer)) == rSize)
+            {
+                bool valid = true;
+                for (quint32 i = 0; valid && i < footer.chunkCount; i++)
+                {
+                    IndexEntry entry;
+                    memcpy(&entry, pData + footer.indexOffset
+                           + i * sizeof(IndexEntry), sizeof(entry));
+
+                    CaptureChunk chunk;
+                    chunk.firstTime = entry.firstTime;
+                    chunk.lastTime = entry.lastTime;
+                    chunk.offset = entry.offset;
+                    chunk.sampleCount = entry.sampleCount;
+                    chunk.minimum = entry.minimum;
+                    chunk.maximum = entry.maximum;
+
+                    valid = chunk.offset >= header.headerSize
+                            && chunk.offset + static_cast<qint64>(
+                                   sizeof(ChunkHeader)) <= footer.indexOffset;
+                    rChunks.append(chunk);
+                }
+
+                if (valid)
+                {
+                    rEnd = footer.indexOffset;
+                    rRecovered = false;
+                    return;
+                }
+
+                rChunks.clear();
+            }
+        }
+
+        // Otherwise scan the chunks, stopping at the first which is not whole;
+        qint64 offset = header.headerSize;
+        qint64 lastTime = std::numeric_limits<qint64>::min();
+
+        while (offset + static_cast<qint64>(sizeof(ChunkHeader)) <= rSize)
+        {
+            ChunkHeader chunkHeader;
+            memcpy(&chunkHeader, pData + offset, sizeof(chunkHeader));
+
+            const qint64 end = offset + sizeof(ChunkHeader)
+                    + chunkHeader.timeBytes + chunkHeader.valueBytes;
+
+            if (chunkHeader.magic != chunk_magic
+                    || chunkHeader.sampleCount == 0
+                    || end > rSize
+                    || chunkHeader.firstTime < lastTime
+                    || chunkHeader.lastTime < chunkHeader.firstTime)
+            {
+                break;
+            }
+
+            CaptureChunk chunk;
+            chunk.firstTime = chunkHeader.firstTime;
+            chunk.lastTime = chunkHeader.lastTime;
+            chunk.offset = offset;
+            chunk.sampleCount = chunkHeader.sampleCount;
+            chunk.minimum = chunkHeader.minimum;
+            chunk.maximum = chunkHeader.maximum;
+            rChunks.append(chunk);
+
+            lastTime = chunkHeader.lastTime;
+            offset = end;
+        }
+
+        rEnd = offset;
+        rRecovered = true;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         RadiometerCaptureWriter
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+RadiometerCaptureWriter::RadiometerCaptureWriter()
+    : mChunkCapacity(4096)
+    , mLastTime(std::numeric_limits<qint64>::min())
+    , mSampleCount(0)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         ~RadiometerCaptureWriter
+
+Purpose      Destructor, writing the index and closing the file;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+RadiometerCaptureWriter::~RadiometerCaptureWriter()
+{
+    close();
+}
+
+/*----------------------------------------------------------------------------
+Name         setChunkCapacity
+
+Purpose      Sets the number of samples gathered before a chunk is written.
+             Larger chunks compress a little better, smaller ones lose less on
+             a crash and let short ranges be read with less decompression;
+
+Input        rSamples           Samples per chunk;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void RadiometerCaptureWriter::setChunkCapacity(const int &rSamples)
+{
+    mChunkCapacity = qBound(16, rSamples, 1 << 20);
+}
+
+/*----------------------------------------------------------------------------
+Name         open
+
+Purpose      Creates a capture file, or opens an existing one to append to;
+
+Input        rFileName          Name of the capture file;
+             rAppend            Whether to append to an existing file, rather
+                                than replacing it.  A file which does not
+                                exist yet is created either way;
+
+Returns      bool               true -  If the file is ready for samples;
+                                false - If not, in which case getLastError()
+                                        explains why;
+
+Notes        When appending, any index is removed from the end of the file,
+             to be rewritten by close(), as is any partly written chunk left
+             by a crash;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureWriter::open(const QString &rFileName
+                                   , const bool &rAppend)
+{
+    close();
+
+    mFile.setFileName(rFileName);
+    mChunks.clear();
+    mTimes.clear();
+    mValues.clear();
+    mLastTime = std::numeric_limits<qint64>::min();
+    mSampleCount = 0;
+
+    if (rAppend && mFile.exists() && mFile.size() > 0)
+    {
+        if (!mFile.open(QIODevice::ReadWrite))
+        {
+            mLastError = "Unable to open " + rFileName + ": "
+                    + mFile.errorString();
+            return false;
+        }
+
+        const qint64 size = mFile.size();
+        uchar* pData = mFile.map(0, size);
+        if (!pData || !validHeader(pData, size))
+        {
+            mLastError = rFileName + " is not a radiometer capture, or was"
+                                     " written by another version or machine";
+            if (pData)
+            {
+                mFile.unmap(pData);
+            }
+            mFile.close();
+            return false;
+        }
+
+        qint64 end = 0;
+        bool recovered = false;
+        loadChunks(pData, size, mChunks, end, recovered);
+        mFile.unmap(pData);
+
+        for (int i = 0; i < mChunks.size(); i++)
+        {
+            mSampleCount += mChunks.at(i).sampleCount;
+        }
+        if (!mChunks.isEmpty())
+        {
+            mLastTime = mChunks.last().lastTime;
+        }
+
+        if (!mFile.resize(end) || !mFile.seek(end))
+        {
+            mLastError = "Unable to append to " + rFileName + ": "
+                    + mFile.errorString();
+            mFile.close();
+            return false;
+        }
+    }
+    else
+    {
+        if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            mLastError = "Unable to create " + rFileName + ": "
+                    + mFile.errorString();
+            return false;
+        }
+
+        FileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, file_magic, sizeof(file_magic));
+        header.version = file_version;
+        header.headerSize = sizeof(FileHeader);
+        header.byteOrderMark = byte_order_mark;
+        header.created = QDateTime::currentMSecsSinceEpoch();
+
+        if (mFile.write(reinterpret_cast<const char*>(&header)
+                        , sizeof(header)) != sizeof(header))
+        {
+            mLastError = "Unable to write " + rFileName + ": "
+                    + mFile.errorString();
+            mFile.close();
+            return false;
+        }
+    }
+
+    mTimes.reserve(mChunkCapacity);
+    mValues.reserve(mChunkCapacity);
+    mLastError.clear();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         isOpen
+
+Purpose      Returns whether or not a capture is open;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureWriter::isOpen() const
+{
+    return mFile.isOpen();
+}
+
+/*----------------------------------------------------------------------------
+Name         append
+
+Purpose      Appends a sample.  Samples are gathered until there are enough
+             for a chunk, which is then compressed and written;
+
+Input        rTime              Time of the sample, us since the epoch;
+             rValue             The sample;
+
+Returns      bool               true -  If the sample was appended;
+                                false - If the file is not open, the sample is
+                                        older than the one before, or a chunk
+                                        could not be written;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureWriter::append(const qint64 &rTime, const double &rValue)
+{
+    return append(&rTime, &rValue, 1);
+}
+
+/*----------------------------------------------------------------------------
+Name         append
+
+Purpose      Appends a block of samples;
+
+Input        pTimes             Times of the samples, us since the epoch;
+             pValues            The samples;
+             count              Number of samples;
+
+Returns      bool               true -  If every sample was appended;
+                                false - If not, in which case the samples
+                                        before the one at fault were appended;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureWriter::append(const qint64 *pTimes
+                                     , const double *pValues
+                                     , size_t count)
+{
+    if (!isOpen())
+    {
+        mLastError = "No capture file is open";
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pTimes[i] < mLastTime)
+        {
+            mLastError = "Samples must be appended in time order";
+            return false;
+        }
+
+        mTimes.push_back(pTimes[i]);
+        mValues.push_back(pValues[i]);
+        mLastTime = pTimes[i];
+        mSampleCount++;
+
+        if (static_cast<int>(mTimes.size()) >= mChunkCapacity && !writeChunk())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         flush
+
+Purpose      Writes any gathered samples as a chunk, however few, and flushes
+             the file, so that they survive if the program stops;
+
+Returns      bool               true -  If the samples were written;
+                                false - If not;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureWriter::flush()
+{
+    if (!isOpen())
+    {
+        return true;
+    }
+
+    return writeChunk() && mFile.flush();
+}
+
+/*----------------------------------------------------------------------------
+Name         close
+
+Purpose      Writes any gathered samples, then the index of the chunks and the
+             footer, and closes the file;
+
+Returns      bool               true -  If everything was written;
+                                false - If not.  The chunks written can still
+                                        be read, by scanning;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureWriter::close()
+{
+    if (!isOpen())
+    {
+        return true;
+    }
+
+    bool written = writeChunk();
+
+    if (written)
+    {
+        Footer footer;
+        footer.indexOffset = mFile.pos();
+        footer.sampleCount = mSampleCount;
+        footer.chunkCount = mChunks.size();
+        footer.magic = index_magic;
+
+        QByteArray index;
+        index.reserve(mChunks.size() * sizeof(IndexEntry) + sizeof(Footer));
+        for (int i = 0; i < mChunks.size(); i++)
+        {
+            const CaptureChunk& rChunk = mChunks.at(i);
+
+            IndexEntry entry;
+            entry.firstTime = rChunk.firstTime;
+            entry.lastTime = rChunk.lastTime;
+            entry.offset = rChunk.offset;
+            entry.sampleCount = rChunk.sampleCount;
+            entry.reserved = 0;
+            entry.minimum = rChunk.minimum;
+            entry.maximum = rChunk.maximum;
+            index.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        }
+        index.append(reinterpret_cast<const char*>(&footer), sizeof(footer));
+
+        written = mFile.write(index) == index.size();
+        if (!written)
+        {
+            mLastError = "Unable to write the index of " + mFile.fileName()
+                    + ": " + mFile.errorString();
+        }
+    }
+
+    mFile.close();
+    mChunks.clear();
+    return written;
+}
+
+/*----------------------------------------------------------------------------
+Name         getSampleCount
+
+Purpose      Returns the number of samples in the file, including any still
+             gathered for the next chunk;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+qint64 RadiometerCaptureWriter::getSampleCount() const
+{
+    return mSampleCount;
+}
+
+/*----------------------------------------------------------------------------
+Name         getLastError
+
+Purpose      Returns a description of why the last call failed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString RadiometerCaptureWriter::getLastError() const
+{
+    return mLastError;
+}
+
+/*----------------------------------------------------------------------------
+Name         writeChunk
+
+Purpose      Compresses the gathered samples and writes them as a chunk;
+
+Returns      bool               true -  If the chunk was written, or there was
+                                        nothing to write;
+                                false - If not;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureWriter::writeChunk()
+{
+    const size_t count = mTimes.size();
+    if (count == 0)
+    {
+        return true;
+    }
+
+    std::vector<uchar> times;
+    std::vector<uchar> values;
+    BitWriter timeWriter(times);
+    encodeTimes(mTimes.data(), count, timeWriter);
+    BitWriter valueWriter(values);
+    encodeValues(mValues.data(), count, valueWriter);
+
+    ChunkHeader header;
+    header.magic = chunk_magic;
+    header.sampleCount = static_cast<quint32>(count);
+    header.firstTime = mTimes.front();
+    header.lastTime = mTimes.back();
+    header.minimum = *std::min_element(mValues.begin(), mValues.end());
+    header.maximum = *std::max_element(mValues.begin(), mValues.end());
+    header.timeBytes = static_cast<quint32>(times.size());
+    header.valueBytes = static_cast<quint32>(values.size());
+
+    CaptureChunk chunk;
+    chunk.firstTime = header.firstTime;
+    chunk.lastTime = header.lastTime;
+    chunk.offset = mFile.pos();
+    chunk.sampleCount = header.sampleCount;
+    chunk.minimum = header.minimum;
+    chunk.maximum = header.maximum;
+
+    const qint64 timeBytes = times.size();
+    const qint64 valueBytes = values.size();
+
+    const bool written =
+            mFile.write(reinterpret_cast<const char*>(&header), sizeof(header))
+                == sizeof(header)
+            && mFile.write(reinterpret_cast<const char*>(times.data())
+                           , timeBytes) == timeBytes
+            && mFile.write(reinterpret_cast<const char*>(values.data())
+                           , valueBytes) == valueBytes;
+
+    if (!written)
+    {
+        mLastError = "Unable to write " + mFile.fileName() + ": "
+                + mFile.errorString();
+        return false;
+    }
+
+    mChunks.append(chunk);
+    mTimes.clear();
+    mValues.clear();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         RadiometerCaptureReader
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+RadiometerCaptureReader::RadiometerCaptureReader()
+    : mpData(0)
+    , mSize(0)
+    , mSampleCount(0)
+    , mRecovered(false)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         ~RadiometerCaptureReader
+
+Purpose      Destructor, unmapping the file;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+RadiometerCaptureReader::~RadiometerCaptureReader()
+{
+    close();
+}
+
+/*----------------------------------------------------------------------------
+Name         open
+
+Purpose      Opens and maps a capture file, and finds its chunks;
+
+Input        rFileName          Name of the capture file;
+
+Returns      bool               true -  If the file was opened;
+                                false - If not, in which case getLastError()
+                                        explains why;
+
+Notes        A file which is still being written, or was never closed, is
+             opened by scanning its chunks; see wasRecovered();
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureReader::open(const QString &rFileName)
+{
+    close();
+
+    mFile.setFileName(rFileName);
+    if (!mFile.open(QIODevice::ReadOnly))
+    {
+        mLastError = "Unable to open " + rFileName + ": " + mFile.errorString();
+        return false;
+    }
+
+    const qint64 size = mFile.size();
+    uchar* pData = (size > 0) ? mFile.map(0, size) : 0;
+    if (!pData || !validHeader(pData, size))
+    {
+        mLastError = rFileName + " is not a radiometer capture, or was"
+                                 " written by another version or machine";
+        if (pData)
+        {
+            mFile.unmap(pData);
+        }
+        close();
+        return false;
+    }
+
+    qint64 end = 0;
+    loadChunks(pData, size, mChunks, end, mRecovered);
+
+    mpData = pData;
+    mSize = size;
+    mSampleCount = 0;
+    for (int i = 0; i < mChunks.size(); i++)
+    {
+        mSampleCount += mChunks.at(i).sampleCount;
+    }
+
+    mLastError.clear();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         close
+
+Purpose      Unmaps and closes the capture file;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void RadiometerCaptureReader::close()
+{
+    if (mpData)
+    {
+        mFile.unmap(mpData);
+    }
+
+    mFile.close();
+    mpData = 0;
+    mSize = 0;
+    mChunks.clear();
+    mSampleCount = 0;
+    mRecovered = false;
+}
+
+/*----------------------------------------------------------------------------
+Name         isOpen
+
+Purpose      Returns whether or not a capture is open;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureReader::isOpen() const
+{
+    return mpData != 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         getSampleCount
+
+Purpose      Returns the number of samples in the file;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+qint64 RadiometerCaptureReader::getSampleCount() const
+{
+    return mSampleCount;
+}
+
+/*----------------------------------------------------------------------------
+Name         getFirstTime
+
+Purpose      Returns the time of the first sample, or 0 if there is none;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+qint64 RadiometerCaptureReader::getFirstTime() const
+{
+    return mChunks.isEmpty() ? 0 : mChunks.first().firstTime;
+}
+
+/*----------------------------------------------------------------------------
+Name         getLastTime
+
+Purpose      Returns the time of the last sample, or 0 if there is none;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+qint64 RadiometerCaptureReader::getLastTime() const
+{
+    return mChunks.isEmpty() ? 0 : mChunks.last().lastTime;
+}
+
+/*----------------------------------------------------------------------------
+Name         getChunks
+
+Purpose      Returns the chunks of the file.  Their ranges of values give an
+             overview of a whole recording without decompressing it;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+const QVector<CaptureChunk>& RadiometerCaptureReader::getChunks() const
+{
+    return mChunks;
+}
+
+/*----------------------------------------------------------------------------
+Name         wasRecovered
+
+Purpose      Returns whether the chunks were found by scanning the file,
+             because it had no index.  This is the case while a capture is
+             still being written, or if it was never closed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureReader::wasRecovered() const
+{
+    return mRecovered;
+}
+
+/*----------------------------------------------------------------------------
+Name         read
+
+Purpose      Reads the samples of a time range;
+
+Input        rFrom              Start of the range, us since the epoch;
+             rTo                End of the range, which is not included;
+
+Output       rTimes             The times of the samples are appended;
+             rValues            The samples are appended;
+
+Returns      bool               true -  If the range was read;
+                                false - If a chunk was damaged.  The samples
+                                        before it are still appended;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Walk the chunks with readRuns;
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureReader::read(const qint64 &rFrom
+                                   , const qint64 &rTo
+                                   , QVector<qint64> &rTimes
+                                   , QVector<double> &rValues) const
+{
+    return readRuns(rFrom, rTo, [&](const qint64* pTimes
+                                    , const double* pValues
+                                    , const size_t& rCount)
+    {
+        for (size_t i = 0; i < rCount; i++)
+        {
+            rTimes.append(pTimes[i]);
+            rValues.append(pValues[i]);
+        }
+    });
+}
+
+/*----------------------------------------------------------------------------
+Name         read
+
+Purpose      Adds the samples of a time range to statistics, without keeping
+             them, e.g. to average the hot or cold part of a sun transit;
+
+Input        rFrom              Start of the range, us since the epoch;
+             rTo                End of the range, which is not included;
+
+Output       rStatistics        The samples are added;
+
+Returns      bool               true -  If the range was read;
+                                false - If a chunk was damaged;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Walk the chunks with readRuns;
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureReader::read(const qint64 &rFrom
+                                   , const qint64 &rTo
+                                   , RunningStats &rStatistics) const
+{
+    return readRuns(rFrom, rTo, [&](const qint64*
+                                    , const double* pValues
+                                    , const size_t& rCount)
+    {
+        rStatistics.addSamples(pValues, rCount);
+    });
+}
+
+/*----------------------------------------------------------------------------
+Name         read
+
+Purpose      Adds the samples of a time range, which are in dB, to statistics
+             of their power, e.g. to average the hot or cold part of a sun
+             transit in the linear domain;
+
+Input        rFrom              Start of the range, us since the epoch;
+             rTo                End of the range, which is not included;
+
+Output       rStatistics        The samples are added;
+
+Returns      bool               true -  If the range was read;
+                                false - If a chunk was damaged;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Walk the chunks with readRuns;
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureReader::read(const qint64 &rFrom
+                                   , const qint64 &rTo
+                                   , PowerStats &rStatistics) const
+{
+    return readRuns(rFrom, rTo, [&](const qint64*
+                                    , const double* pValues
+                                    , const size_t& rCount)
+    {
+        rStatistics.addDb(pValues, rCount);
+    });
+}
+
+/*----------------------------------------------------------------------------
+Name         getLastError
+
+Purpose      Returns a description of why open() last failed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString RadiometerCaptureReader::getLastError() const
+{
+    return mLastError;
+}
+
+/*----------------------------------------------------------------------------
+Name         firstChunk
+
+Purpose      Finds the first chunk which may hold samples at or after a time;
+
+Input        rTime              The time, us since the epoch;
+
+Returns      int                Index of the chunk, or the number of chunks if
+                                every sample is earlier;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int RadiometerCaptureReader::firstChunk(const qint64 &rTime) const
+{
+    int low = 0;
+    int high = mChunks.size();
+
+    while (low < high)
+    {
+        const int middle = (low + high) / 2;
+        if (mChunks.at(middle).lastTime < rTime)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/*----------------------------------------------------------------------------
+Name         readRuns
+
+Purpose      Decodes each chunk a time range overlaps and hands the samples
+             of the chunk within the range to a sink, so that every read()
+             walks the chunks the same way;
+
+Input        rFrom              Start of the range, us since the epoch;
+             rTo                End of the range, which is not included;
+             rSink              Called with each run of samples, in time
+                                order.  The run is only valid during the
+                                call;
+
+Returns      bool               true -  If the range was read;
+                                false - If a chunk was damaged.  The runs
+                                        before it have still been handed on;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool RadiometerCaptureReader::readRuns(const qint64 &rFrom
+                                       , const qint64 &rTo
+                                       , const RunSink &rSink) const
+{
+    std::vector<qint64> times;
+    std::vector<double> values;
+
+    for (int i = firstChunk(rFrom); i < mChunks.size(); i++)
+    {
+        const CaptureChunk& rChunk = mChunks.at(i);
+        if (rChunk.firstTime >= rTo)
+        {
+            break;
+        }
+
+        if (!decodeChunk(mpData, mSize, rChunk, times, values))
+        {
+            return false;
+        }
+
+        const size_t begin = std::lower_bound(times.begin(), times.end()
+                                              , rFrom) - times.begin();
+        const size_t end = std::lower_bound(times.begin() + begin
+                                            , times.end(), rTo) - times.begin();
+
+        if (end > begin)
+        {
+            rSink(times.data() + begin, values.data() + begin, end - begin);
+        }
+    }
+
+    return true;
+}
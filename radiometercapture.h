@@ -0,0 +1,143 @@
+/*----------------------------------------------------------------------------
+Name         radiometercapture.h
+
+Purpose      Compressed capture file of the raw power samples of a radiometer,
+             written in chunks as the samples arrive and read back through a
+             memory map, one time range at a time;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef RADIOMETERCAPTURE_H
+#define RADIOMETERCAPTURE_H
+
+#include <QFile> // HASA QFile the capture is written to or mapped from;
+#include <QString>
+#include <QVector> // HASA QVector of the chunks in the file;
+#include <vector>
+#include <functional> // USES std::function for the runs of a range;
+#include "runningstats.h" // USES RunningStats to summarise a time range;
+#include "powerstats.h" // USES PowerStats to average a time range;
+
+// Summary of one chunk of a capture file;
+struct CaptureChunk
+{
+    qint64 firstTime; // Time of the first sample, us since the epoch;
+    qint64 lastTime; // Time of the last sample, us since the epoch;
+    qint64 offset; // Offset of the chunk within the file;
+    quint32 sampleCount; // Number of samples in the chunk;
+    double minimum; // Smallest sample in the chunk;
+    double maximum; // Largest sample in the chunk;
+};
+
+class RadiometerCaptureWriter
+{
+public:
+    RadiometerCaptureWriter(); // Constructor;
+    ~RadiometerCaptureWriter(); // Destructor, closes the file;
+
+    // Sets the number of samples gathered before a chunk is written;
+    void setChunkCapacity(const int& rSamples);
+
+    // Creates a capture file, or opens an existing one to append to;
+    bool open(const QString& rFileName, const bool& rAppend = false);
+    // Whether or not a capture is open;
+    bool isOpen(void) const;
+
+    // Appends a sample, in time order;
+    bool append(const qint64& rTime, const double& rValue);
+    // Appends a block of samples, in time order;
+    bool append(const qint64* pTimes, const double* pValues, size_t count);
+
+    // Writes any gathered samples as a chunk and flushes the file;
+    bool flush(void);
+    // Flushes, writes the chunk index, and closes the file;
+    bool close(void);
+
+    // Returns the number of samples in the file, written or gathered;
+    qint64 getSampleCount(void) const;
+    // Returns a description of why the last call failed;
+    QString getLastError(void) const;
+
+private:
+    Q_DISABLE_COPY(RadiometerCaptureWriter)
+
+    QFile mFile; // The capture file;
+    int mChunkCapacity; // Samples gathered before a chunk is written;
+    std::vector<qint64> mTimes; // Times gathered for the next chunk;
+    std::vector<double> mValues; // Samples gathered for the next chunk;
+    QVector<CaptureChunk> mChunks; // Chunks written so far;
+    qint64 mLastTime; // Time of the last sample appended;
+    qint64 mSampleCount; // Samples written or gathered;
+    QString mLastError; // Why the last call failed;
+
+    // Compresses and writes the gathered samples;
+    bool writeChunk(void);
+};
+
+class RadiometerCaptureReader
+{
+public:
+    RadiometerCaptureReader(); // Constructor;
+    ~RadiometerCaptureReader(); // Destructor, unmaps the file;
+
+    // Opens and maps a capture file;
+    bool open(const QString& rFileName);
+    // Unmaps and closes the capture file;
+    void close(void);
+    // Whether or not a capture is open;
+    bool isOpen(void) const;
+
+    // Returns the number of samples in the file;
+    qint64 getSampleCount(void) const;
+    // Returns the time of the first sample, us since the epoch;
+    qint64 getFirstTime(void) const;
+    // Returns the time of the last sample, us since the epoch;
+    qint64 getLastTime(void) const;
+    // Returns the chunks of the file, in time order;
+    const QVector<CaptureChunk>& getChunks(void) const;
+    // Whether the index was rebuilt because the file was not closed;
+    bool wasRecovered(void) const;
+
+    // Appends the samples from rFrom up to, not including, rTo;
+    bool read(const qint64& rFrom
+              , const qint64& rTo
+              , QVector<qint64>& rTimes
+              , QVector<double>& rValues) const;
+    // Adds the samples from rFrom up to, not including, rTo to statistics;
+    bool read(const qint64& rFrom
+              , const qint64& rTo
+              , RunningStats& rStatistics) const;
+    // Adds the samples from rFrom up to, not including, rTo, which are in
+    // dB, to statistics of their power;
+    bool read(const qint64& rFrom
+              , const qint64& rTo
+              , PowerStats& rStatistics) const;
+
+    // Returns a description of why open() last failed;
+    QString getLastError(void) const;
+
+private:
+    Q_DISABLE_COPY(RadiometerCaptureReader)
+
+    QFile mFile; // The capture file;
+    uchar* mpData; // Start of the mapped file;
+    qint64 mSize; // Size of the mapped file;
+    QVector<CaptureChunk> mChunks; // Chunks of the file, in time order;
+    qint64 mSampleCount; // Number of samples in the file;
+    bool mRecovered; // The index was rebuilt by scanning the chunks;
+    QString mLastError; // Why open() last failed;
+
+    // Receives each run of samples of a range, in time order;
+    typedef std::function<void(const qint64* pTimes
+                               , const double* pValues
+                               , const size_t& rCount)> RunSink;
+
+    // Returns the first chunk which may hold samples at or after a time;
+    int firstChunk(const qint64& rTime) const;
+    // Hands the samples from rFrom up to, not including, rTo to a sink;
+    bool readRuns(const qint64& rFrom
+                  , const qint64& rTo
+                  , const RunSink& rSink) const;
+};
+
+#endif // RADIOMETERCAPTURE_H
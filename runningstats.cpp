@@ -0,0 +1,192 @@
+/*----------------------------------------------------------------------------
+Name         runningstats.cpp
+
+Purpose      Keeps a running count, mean, and variance of a stream of samples
+             without storing the samples themselves;
+
+Notes        Single samples are added using Welford's method.  Blocks of
+             samples are first reduced to their own count, mean, and sum of
+             squared differences and then merged in a single step (Chan et
+             al.), so adding a block costs one pass over the block and the
+             statistics never need the earlier samples.  Both forms avoid the
+             cancellation of the naive sum-of-squares formula;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "runningstats.h"
+
+/*----------------------------------------------------------------------------
+Name         RunningStats
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+RunningStats::RunningStats()
+{
+    clear();
+}
+
+/*----------------------------------------------------------------------------
+Name         addSample
+
+Purpose      Adds a single sample to the statistics;
+
+Input        rSample            The sample to be added;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void RunningStats::addSample(const double &rSample)
+{
+    mCount++;
+
+    double delta = rSample - mMean;
+    mMean += delta / mCount;
+    mM2 += delta * (rSample - mMean);
+}
+
+/*----------------------------------------------------------------------------
+Name         addSamples
+
+Purpose      Adds a block of samples to the statistics;
+
+Input        pSamples           Array of samples;
+             count              Number of samples in pSamples;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void RunningStats::addSamples(const double *pSamples, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Reduce the block on its own; the mean first, then the squared
+    // differences from it;
+    double sum = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        sum += pSamples[i];
+    }
+
+    RunningStats block;
+    block.mCount = count;
+    block.mMean = sum / count;
+
+    double m2 = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        double delta = pSamples[i] - block.mMean;
+        m2 += delta * delta;
+    }
+    block.mM2 = m2;
+
+    merge(block);
+}
+
+/*----------------------------------------------------------------------------
+Name         merge
+
+Purpose      Combines the statistics of another stream of samples into these,
+             as though its samples had been added here;
+
+Input        rOther             Statistics of the other stream;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void RunningStats::merge(const RunningStats &rOther)
+{
+    if (rOther.mCount == 0)
+    {
+        return;
+    }
+
+    if (mCount == 0)
+    {
+        *this = rOther;
+        return;
+    }
+
+    const double count = static_cast<double>(mCount + rOther.mCount);
+    const double delta = rOther.mMean - mMean;
+
+    mMean += delta * (rOther.mCount / count);
+    mM2 += rOther.mM2 + delta * delta * (mCount * (rOther.mCount / count));
+    mCount += rOther.mCount;
+}
+
+/*----------------------------------------------------------------------------
+Name         clear
+
+Purpose      Forgets every sample added so far;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void RunningStats::clear()
+{
+    mCount = 0;
+    mMean = 0;
+    mM2 = 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         getCount
+
+Purpose      Returns the number of samples added;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+unsigned long long RunningStats::getCount() const
+{
+    return mCount;
+}
+
+/*----------------------------------------------------------------------------
+Name         getMean
+
+Purpose      Returns the mean of the samples, or zero if there are none;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double RunningStats::getMean() const
+{
+    return mMean;
+}
+
+/*----------------------------------------------------------------------------
+Name         getVariance
+
+Purpose      Returns the sample (n - 1) variance, or zero if there are fewer
+             than two samples;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double RunningStats::getVariance() const
+{
+    return (mCount > 1) ? mM2 / (mCount - 1) : 0.0;
+}
+
+/*----------------------------------------------------------------------------
+Name         getStandardDeviation
+
+Purpose      Returns the sample standard deviation;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double RunningStats::getStandardDeviation() const
+{
+    return sqrt(getVariance());
+}
+
+/*----------------------------------------------------------------------------
+Name         getStandardError
+
+Purpose      Returns the standard deviation of the mean;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double RunningStats::getStandardError() const
+{
+    return (mCount > 0) ? sqrt(getVariance() / mCount) : 0.0;
+}
@@ -0,0 +1,41 @@
+/*----------------------------------------------------------------------------
+Name         runningstats.h
+
+Purpose      Keeps a running count, mean, and variance of a stream of samples
+             without storing the samples themselves;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef RUNNINGSTATS_H
+#define RUNNINGSTATS_H
+
+#include <cstddef> // USES size_t;
+#include <cmath> // USES sqrt;
+
+class RunningStats
+{
+public:
+    RunningStats(); // Constructor;
+
+    void addSample(const double& rSample); // Adds a single sample;
+    // Adds a block of samples;
+    void addSamples(const double* pSamples, size_t count);
+    // Combines the statistics of another stream into this one;
+    void merge(const RunningStats& rOther);
+
+    void clear(void); // Forgets every sample added so far;
+
+    unsigned long long getCount(void) const; // Number of samples;
+    double getMean(void) const; // Mean of the samples;
+    double getVariance(void) const; // Sample (n - 1) variance;
+    double getStandardDeviation(void) const; // Sample standard deviation;
+    // Standard deviation of the mean (standard error);
+    double getStandardError(void) const;
+
+private:
+    unsigned long long mCount; // Number of samples added;
+    double mMean; // Running mean;
+    double mM2; // Running sum of squared differences from the mean;
+};
+
+#endif // RUNNINGSTATS_H
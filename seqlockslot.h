@@ -0,0 +1,151 @@
+/*----------------------------------------------------------------------------
+Name         seqlockslot.h
+
+Purpose      Lock-free slot holding the latest value written by exactly one
+             writer thread, from which any number of threads may read;
+
+Notes        A sequence lock.  The writer makes the sequence odd, stores the
+             value, and makes it even again; a reader copies the value and
+             tries again if the sequence was odd or changed while it copied.
+             The writer never waits on a reader, so a slow or stalled reader
+             can not hold up the thread writing the values;
+
+             The value is held as an array of atomic words so that the copy a
+             torn read makes is still well defined, and T must therefore be
+             trivially copyable;
+
+             Only write() may be called from the writer;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef SEQLOCKSLOT_H
+#define SEQLOCKSLOT_H
+
+#include <atomic> // USES std::atomic for the sequence and the words;
+#include <cstring> // USES memcpy to move the value in and out of words;
+#include <type_traits> // USES std::is_trivially_copyable;
+
+template <typename T>
+class SeqLockSlot
+{
+    static_assert(std::is_trivially_copyable<T>::value
+                  , "SeqLockSlot values must be trivially copyable");
+
+public:
+    SeqLockSlot(); // Constructor, of a slot never written;
+
+    // Replaces the value in the slot;
+    void write(const T& rValue);
+    // Copies the latest value, returning the number of writes it was the
+    // last of, or 0 (and leaving rValue alone) if there have been none;
+    unsigned long long read(T& rValue) const;
+
+    SeqLockSlot(const SeqLockSlot&) = delete; // Not copyable;
+    SeqLockSlot& operator=(const SeqLockSlot&) = delete;
+
+private:
+    // Number of words needed to hold a T;
+    static const size_t word_count = (sizeof(T) + sizeof(unsigned long long)
+                                      - 1) / sizeof(unsigned long long);
+
+    // Twice the number of writes begun, plus one while one is under way;
+    alignas(64) std::atomic<unsigned long long> mSequence;
+    // The value, a word at a time;
+    std::atomic<unsigned long long> mWords[word_count];
+};
+
+/*----------------------------------------------------------------------------
+Name         SeqLockSlot
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+template <typename T>
+SeqLockSlot<T>::SeqLockSlot()
+    : mSequence(0)
+{
+    for (size_t i = 0; i < word_count; i++)
+    {
+        mWords[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         write
+
+Purpose      Replaces the value in the slot.  Never blocks;
+
+Input        rValue             The new value;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+template <typename T>
+void SeqLockSlot<T>::write(const T &rValue)
+{
+    unsigned long long words[word_count] = {0};
+    memcpy(words, &rValue, sizeof(T));
+
+    const unsigned long long sequence
+            = mSequence.load(std::memory_order_relaxed);
+    mSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < word_count; i++)
+    {
+        mWords[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    mSequence.store(sequence + 2, std::memory_order_release);
+}
+
+/*----------------------------------------------------------------------------
+Name         read
+
+Purpose      Copies the latest value out of the slot;
+
+Output       rValue             The value, if one has been written;
+
+Returns      unsigned long long Number of writes up to and including the one
+                                copied, so a reader can tell a new value from
+                                one it has seen.  0 if nothing was written;
+
+Notes        Spins only while a write is under way, which is a copy of a few
+             words;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+template <typename T>
+unsigned long long SeqLockSlot<T>::read(T &rValue) const
+{
+    unsigned long long words[word_count];
+
+    while (true)
+    {
+        const unsigned long long before
+                = mSequence.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            continue;
+        }
+
+        for (size_t i = 0; i < word_count; i++)
+        {
+            words[i] = mWords[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (mSequence.load(std::memory_order_relaxed) == before)
+        {
+            if (before == 0)
+            {
+                return 0;
+            }
+
+            memcpy(&rValue, words, sizeof(T));
+            return before / 2;
+        }
+    }
+}
+
+#endif // SEQLOCKSLOT_H
@@ -0,0 +1,531 @@
+/*----------------------------------------------------------------------------
+Name         sessioncatalog.cpp
+
+Purpose      Local SQLite catalog of Gain Over Temperature sessions, indexed
+             by antenna, frequency, and time so that the history of any
+             antenna or band can be queried;
+
+Notes        The catalog is a single table of sessions, with an index on
+             (antenna, frequency, time) for the trend of one antenna in one
+             band, and indexes on frequency and on time for queries across
+             every antenna.  Times are kept as milliseconds since the epoch,
+             UTC, so that they sort and compare as integers;
+
+             Batches are inserted in a single transaction through one
+             prepared statement, and the database is kept in write-ahead log
+             mode with normal synchronisation, so bulk imports are limited by
+             the formatting of the rows rather than by syncs to the disk;
+
+             Each catalog has its own named connection, so catalogs may be
+             opened on several threads at once, though each one must only be
+             used from the thread which opened it;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "sessioncatalog.h"
+
+#include <QSqlQuery> // USES QSqlQuery to run statements;
+#include <QSqlError>
+#include <QVariant>
+#include <QStringList>
+#include <limits>
+
+namespace
+{
+    const char* const catalog_driver = "QSQLITE";
+
+    const char* const create_table =
+            "CREATE TABLE IF NOT EXISTS sessions ("
+            " id INTEGER PRIMARY KEY,"
+            " antenna TEXT NOT NULL,"
+            " measured_at INTEGER NOT NULL,"
+            " frequency_mhz REAL NOT NULL,"
+            " beamwidth_deg REAL,"
+            " solar_flux_sfu REAL,"
+            " hot_db REAL,"
+            " cold_db REAL,"
+            " got_db REAL NOT NULL,"
+            " latitude REAL,"
+            " longitude REAL,"
+            " source TEXT)";
+
+    const char* const create_indexes[] = {
+        "CREATE INDEX IF NOT EXISTS sessions_antenna_frequency_time"
+        " ON sessions (antenna, frequency_mhz, measured_at)",
+        "CREATE INDEX IF NOT EXISTS sessions_frequency"
+        " ON sessions (frequency_mhz)",
+        "CREATE INDEX IF NOT EXISTS sessions_time"
+        " ON sessions (measured_at)"
+    };
+
+    const char* const insert_session =
+            "INSERT INTO sessions (antenna, measured_at, frequency_mhz,"
+            " beamwidth_deg, solar_flux_sfu, hot_db, cold_db, got_db,"
+            " latitude, longitude, source)"
+            " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+
+    const char* const select_sessions =
+            "SELECT id, antenna, measured_at, frequency_mhz, beamwidth_deg,"
+            " solar_flux_sfu, hot_db, cold_db, got_db, latitude, longitude,"
+            " source FROM sessions";
+
+    // Returns a name to bind, empty rather than null if it is not known,
+    // as a null QString binds as SQL NULL;
+    QVariant notNull(const QString& rValue)
+    {
+        return rValue.isNull() ? QVariant(QString("")) : QVariant(rValue);
+    }
+
+    // Returns a value to bind, null if it is not known (NaN);
+    QVariant nullable(const double& rValue)
+    {
+        return (rValue == rValue) ? QVariant(rValue)
+                                  : QVariant(QVariant::Double);
+    }
+
+    // Returns a value read back, NaN if it was null;
+    double fromNullable(const QVariant& rValue)
+    {
+        return rValue.isNull() ? std::numeric_limits<double>::quiet_NaN()
+                               : rValue.toDouble();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         CatalogSession
+
+Purpose      Constructor, leaving every value unknown;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+CatalogSession::CatalogSession()
+    : id(0)
+    , frequencyMHz(0)
+    , beamwidthDeg(std::numeric_limits<double>::quiet_NaN())
+    , solarFluxSfu(std::numeric_limits<double>::quiet_NaN())
+    , hotDb(std::numeric_limits<double>::quiet_NaN())
+    , coldDb(std::numeric_limits<double>::quiet_NaN())
+    , gotDb(std::numeric_limits<double>::quiet_NaN())
+    , latitude(std::numeric_limits<double>::quiet_NaN())
+    , longitude(std::numeric_limits<double>::quiet_NaN())
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         CatalogQuery
+
+Purpose      Constructor, matching every session;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+CatalogQuery::CatalogQuery()
+    : minFrequencyMHz(std::numeric_limits<double>::quiet_NaN())
+    , maxFrequencyMHz(std::numeric_limits<double>::quiet_NaN())
+    , limit(0)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         SessionCatalog
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SessionCatalog::SessionCatalog()
+    : mConnectionName("SessionCatalog-"
+                      + QString::number(reinterpret_cast<quintptr>(this), 16))
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         ~SessionCatalog
+
+Purpose      Destructor, closing the catalog;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SessionCatalog::~SessionCatalog()
+{
+    close();
+}
+
+/*----------------------------------------------------------------------------
+Name         open
+
+Purpose      Opens a catalog file, creating the file, its table, and its
+             indexes if they do not exist yet;
+
+Input        rFileName          Name of the catalog file;
+
+Returns      bool               true -  If the catalog was opened;
+                                false - If not, in which case getLastError()
+                                        explains why;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SessionCatalog::open(const QString &rFileName)
+{
+    close();
+
+    if (!QSqlDatabase::isDriverAvailable(catalog_driver))
+    {
+        mLastError = "The SQLite driver for Qt is not installed";
+        return false;
+    }
+
+    mDatabase = QSqlDatabase::addDatabase(catalog_driver, mConnectionName);
+    mDatabase.setDatabaseName(rFileName);
+
+    if (!mDatabase.open())
+    {
+        mLastError = "Unable to open " + rFileName + ": "
+                + mDatabase.lastError().text();
+        close();
+        return false;
+    }
+
+    // Write-ahead logging lets readers run alongside an import, and only
+    // syncs at checkpoints;
+    QSqlQuery pragma(mDatabase);
+    pragma.exec("PRAGMA journal_mode = WAL");
+    pragma.exec("PRAGMA synchronous = NORMAL");
+
+    if (!createSchema())
+    {
+        close();
+        return false;
+    }
+
+    mLastError.clear();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         close
+
+Purpose      Closes the catalog and removes its connection;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SessionCatalog::close()
+{
+    if (!mDatabase.isValid())
+    {
+        return;
+    }
+
+    mDatabase.close();
+    mDatabase = QSqlDatabase();
+    QSqlDatabase::removeDatabase(mConnectionName);
+}
+
+/*----------------------------------------------------------------------------
+Name         isOpen
+
+Purpose      Returns whether or not a catalog is open;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SessionCatalog::isOpen() const
+{
+    return mDatabase.isOpen();
+}
+
+/*----------------------------------------------------------------------------
+Name         insert
+
+Purpose      Adds a session to the catalog;
+
+Input        rSession           The session;
+
+Returns      bool               true -  If the session was added;
+                                false - If not;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SessionCatalog::insert(const CatalogSession &rSession)
+{
+    return insert(QVector<CatalogSession>() << rSession);
+}
+
+/*----------------------------------------------------------------------------
+Name         insert
+
+Purpose      Adds a batch of sessions to the catalog in one transaction;
+
+Input        rSessions          The sessions;
+
+Returns      bool               true -  If every session was added;
+                                false - If not, in which case none were;
+
+Notes        The cost of a transaction is mostly its commit, so batches of
+             thousands of sessions are far quicker per session than adding
+             them one at a time;
+
+             A session with no antenna name is kept under an empty name;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Keep a missing antenna name as empty, not NULL;
+----------------------------------------------------------------------------*/
+bool SessionCatalog::insert(const QVector<CatalogSession> &rSessions)
+{
+    if (!isOpen())
+    {
+        mLastError = "No session catalog is open";
+        return false;
+    }
+
+    if (!mDatabase.transaction())
+    {
+        mLastError = "Unable to start a transaction: "
+                + mDatabase.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(mDatabase);
+    bool ok = query.prepare(insert_session);
+
+    for (int i = 0; ok && i < rSessions.size(); i++)
+    {
+        const CatalogSession& rSession = rSessions.at(i);
+
+        query.bindValue(0, notNull(rSession.antenna));
+        query.bindValue(1, rSession.measuredAt.toMSecsSinceEpoch());
+        query.bindValue(2, rSession.frequencyMHz);
+        query.bindValue(3, nullable(rSession.beamwidthDeg));
+        query.bindValue(4, nullable(rSession.solarFluxSfu));
+        query.bindValue(5, nullable(rSession.hotDb));
+        query.bindValue(6, nullable(rSession.coldDb));
+        query.bindValue(7, rSession.gotDb);
+        query.bindValue(8, nullable(rSession.latitude));
+        query.bindValue(9, nullable(rSession.longitude));
+        query.bindValue(10, rSession.source);
+
+        ok = query.exec();
+    }
+
+    if (!ok)
+    {
+        mLastError = "Unable to add sessions: " + query.lastError().text();
+        mDatabase.rollback();
+        return false;
+    }
+
+    if (!mDatabase.commit())
+    {
+        mLastError = "Unable to add sessions: "
+                + mDatabase.lastError().text();
+        mDatabase.rollback();
+        return false;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         find
+
+Purpose      Finds the sessions matching a query;
+
+Input        rQuery             Which sessions to find;
+
+Output       rSessions          The sessions found, oldest first;
+
+Returns      bool               true -  If the query ran;
+                                false - If not;
+
+Notes        Every condition is on an indexed column, so the query reads only
+             the sessions it returns;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SessionCatalog::find(const CatalogQuery &rQuery
+                          , QVector<CatalogSession> &rSessions)
+{
+    rSessions.clear();
+
+    if (!isOpen())
+    {
+        mLastError = "No session catalog is open";
+        return false;
+    }
+
+    QStringList conditions;
+    QVariantList values;
+
+    if (!rQuery.antenna.isEmpty())
+    {
+        conditions << "antenna = ?";
+        values << rQuery.antenna;
+    }
+    if (rQuery.minFrequencyMHz == rQuery.minFrequencyMHz)
+    {
+        conditions << "frequency_mhz >= ?";
+        values << rQuery.minFrequencyMHz;
+    }
+    if (rQuery.maxFrequencyMHz == rQuery.maxFrequencyMHz)
+    {
+        conditions << "frequency_mhz <= ?";
+        values << rQuery.maxFrequencyMHz;
+    }
+    if (rQuery.from.isValid())
+    {
+        conditions << "measured_at >= ?";
+        values << rQuery.from.toMSecsSinceEpoch();
+    }
+    if (rQuery.to.isValid())
+    {
+        conditions << "measured_at < ?";
+        values << rQuery.to.toMSecsSinceEpoch();
+    }
+
+    QString sql = select_sessions;
+    if (!conditions.isEmpty())
+    {
+        sql += " WHERE " + conditions.join(" AND ");
+    }
+    sql += " ORDER BY measured_at";
+    if (rQuery.limit > 0)
+    {
+        sql += " LIMIT " + QString::number(rQuery.limit);
+    }
+
+    QSqlQuery query(mDatabase);
+    query.setForwardOnly(true);
+
+    bool ok = query.prepare(sql);
+    for (int i = 0; ok && i < values.size(); i++)
+    {
+        query.bindValue(i, values.at(i));
+    }
+
+    if (!ok || !query.exec())
+    {
+        mLastError = "Unable to query sessions: " + query.lastError().text();
+        return false;
+    }
+
+    while (query.next())
+    {
+        CatalogSession session;
+        session.id = query.value(0).toLongLong();
+        session.antenna = query.value(1).toString();
+        session.measuredAt = QDateTime::fromMSecsSinceEpoch(
+                    query.value(2).toLongLong()).toUTC();
+        session.frequencyMHz = query.value(3).toDouble();
+        session.beamwidthDeg = fromNullable(query.value(4));
+        session.solarFluxSfu = fromNullable(query.value(5));
+        session.hotDb = fromNullable(query.value(6));
+        session.coldDb = fromNullable(query.value(7));
+        session.gotDb = query.value(8).toDouble();
+        session.latitude = fromNullable(query.value(9));
+        session.longitude = fromNullable(query.value(10));
+        session.source = query.value(11).toString();
+        rSessions.append(session);
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         trend
+
+Purpose      Finds the sessions of one antenna near a frequency over a span of
+             time, e.g. to plot the G/T of a dish at 8.4 GHz over two years;
+
+Input        rAntenna           Name of the antenna;
+             rFrequencyMHz      Operating frequency;
+             rToleranceMHz      How far from rFrequencyMHz a session may be;
+             rFrom              Start of the span;
+             rTo                End of the span, not included;
+
+Output       rSessions          The sessions found, oldest first;
+
+Returns      bool               true -  If the query ran;
+                                false - If not;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SessionCatalog::trend(const QString &rAntenna
+                           , const double &rFrequencyMHz
+                           , const double &rToleranceMHz
+                           , const QDateTime &rFrom
+                           , const QDateTime &rTo
+                           , QVector<CatalogSession> &rSessions)
+{
+    CatalogQuery query;
+    query.antenna = rAntenna;
+    query.minFrequencyMHz = rFrequencyMHz - rToleranceMHz;
+    query.maxFrequencyMHz = rFrequencyMHz + rToleranceMHz;
+    query.from = rFrom;
+    query.to = rTo;
+
+    return find(query, rSessions);
+}
+
+/*----------------------------------------------------------------------------
+Name         count
+
+Purpose      Returns the number of sessions in the catalog;
+
+Returns      qint64             Number of sessions, or -1 on an error;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+qint64 SessionCatalog::count()
+{
+    QSqlQuery query(mDatabase);
+    if (!isOpen() || !query.exec("SELECT COUNT(*) FROM sessions")
+            || !query.next())
+    {
+        mLastError = "Unable to count sessions: " + query.lastError().text();
+        return -1;
+    }
+
+    return query.value(0).toLongLong();
+}
+
+/*----------------------------------------------------------------------------
+Name         getLastError
+
+Purpose      Returns a description of why the last call failed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString SessionCatalog::getLastError() const
+{
+    return mLastError;
+}
+
+/*----------------------------------------------------------------------------
+Name         createSchema
+
+Purpose      Creates the sessions table and its indexes, if they are not
+             already there;
+
+Returns      bool               true -  If the schema is in place;
+                                false - If not;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SessionCatalog::createSchema()
+{
+    QSqlQuery query(mDatabase);
+
+    bool ok = query.exec(create_table);
+    const size_t indexCount
+            = sizeof(create_indexes) / sizeof(create_indexes[0]);
+    for (size_t i = 0; ok && i < indexCount; i++)
+    {
+        ok = query.exec(create_indexes[i]);
+    }
+
+    if (!ok)
+    {
+        mLastError = "Unable to create the session catalog: "
+                + query.lastError().text();
+    }
+
+    return ok;
+}
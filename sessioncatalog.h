@@ -0,0 +1,95 @@
+/*----------------------------------------------------------------------------
+Name         sessioncatalog.h
+
+Purpose      Local SQLite catalog of Gain Over Temperature sessions, indexed
+             by antenna, frequency, and time so that the history of any
+             antenna or band can be queried;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef SESSIONCATALOG_H
+#define SESSIONCATALOG_H
+
+#include <QSqlDatabase> // HASA QSqlDatabase connection to the catalog;
+#include <QDateTime> // USES QDateTime for the time of each session;
+#include <QString>
+#include <QVector> // USES QVector for batches of sessions;
+
+// One G/T session, as kept in the catalog;
+struct CatalogSession
+{
+    CatalogSession();
+
+    qint64 id; // Row of the session, set when read from the catalog;
+    QString antenna; // Name of the antenna measured;
+    QDateTime measuredAt; // When the session was measured;
+    double frequencyMHz; // Operating frequency of the antenna;
+    double beamwidthDeg; // Beamwidth of the antenna, in degrees;
+    double solarFluxSfu; // Solar flux at the operating frequency;
+    double hotDb; // Average of the measurements on the sun, in dB;
+    double coldDb; // Average of the measurements off the sun, in dB;
+    double gotDb; // Gain Over Temperature, in dB/K;
+    double latitude; // Latitude of the antenna, NaN if not known;
+    double longitude; // Longitude of the antenna, NaN if not known;
+    QString source; // Where the session came from (e.g. a file name);
+};
+
+// Selects sessions from the catalog.  Empty or NaN fields match anything;
+struct CatalogQuery
+{
+    CatalogQuery();
+
+    QString antenna; // Antenna name, or empty for every antenna;
+    double minFrequencyMHz; // Lowest frequency, or NaN;
+    double maxFrequencyMHz; // Highest frequency, or NaN;
+    QDateTime from; // Earliest time, or invalid;
+    QDateTime to; // Time before which sessions end, or invalid;
+    int limit; // Largest number of sessions returned, or 0 for all;
+};
+
+class SessionCatalog
+{
+public:
+    SessionCatalog(); // Constructor;
+    ~SessionCatalog(); // Destructor, closes the catalog;
+
+    // Opens a catalog file, creating it and its tables if need be;
+    bool open(const QString& rFileName);
+    // Closes the catalog;
+    void close(void);
+    // Whether or not a catalog is open;
+    bool isOpen(void) const;
+
+    // Adds a session;
+    bool insert(const CatalogSession& rSession);
+    // Adds a batch of sessions, all or none of them;
+    bool insert(const QVector<CatalogSession>& rSessions);
+
+    // Finds the sessions matching a query, oldest first;
+    bool find(const CatalogQuery& rQuery, QVector<CatalogSession>& rSessions);
+    // Finds the sessions of an antenna near a frequency over a time span;
+    bool trend(const QString& rAntenna
+               , const double& rFrequencyMHz
+               , const double& rToleranceMHz
+               , const QDateTime& rFrom
+               , const QDateTime& rTo
+               , QVector<CatalogSession>& rSessions);
+
+    // Returns the number of sessions in the catalog, or -1 on an error;
+    qint64 count(void);
+
+    // Returns a description of why the last call failed;
+    QString getLastError(void) const;
+
+private:
+    Q_DISABLE_COPY(SessionCatalog)
+
+    QString mConnectionName; // Name of this catalog's connection;
+    QSqlDatabase mDatabase; // Connection to the catalog file;
+    QString mLastError; // Why the last call failed;
+
+    // Creates the tables and indexes, if they are not already there;
+    bool createSchema(void);
+};
+
+#endif // SESSIONCATALOG_H
@@ -0,0 +1,278 @@
+/*----------------------------------------------------------------------------
+Name         simulatedcontroller.cpp
+
+Purpose      Simulated antenna controller which follows a SunTracker's
+             setpoints with rate and acceleration limited axes, so that the
+             tracker can be tried out without an antenna;
+
+Notes        Each servo cycle reads the latest setpoint, extrapolates it to
+             the tracker's clock with its rates and accelerations, and drives
+             each axis at the setpoint's rate plus a proportional correction,
+             within the axis limits.  The pointing error on the sky is taken
+             before each correction;
+
+             The axes start on the first setpoint, at its rates, so the
+             statistics are of tracking and not of slewing onto the sun;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "simulatedcontroller.h"
+
+#include <thread> // USES std::this_thread to sleep;
+#include <chrono> // USES std::chrono::steady_clock for the cycles;
+#include <cmath> // USES floor, cos, sqrt, and hypot;
+
+namespace
+{
+    // Proportional gain of the servo, per second;
+    const double servo_gain = 5.0;
+
+    // Position and rate of one axis;
+    struct Axis
+    {
+        double positionDeg;
+        double rateDegPerSec;
+    };
+
+    // Returns an angle, in degrees, brought into -180 to 180;
+    inline double wrap180(double degrees)
+    {
+        return degrees - 360.0 * floor((degrees + 180.0) / 360.0);
+    }
+
+    // Returns a value limited to -limit to limit;
+    inline double clampTo(double value, double limit)
+    {
+        return qBound(-limit, value, limit);
+    }
+
+    // Sets an axis's rate to close an error while moving at a target rate,
+    // within the limits of the axis;
+    void drive(Axis& rAxis, double errorDeg, double targetRate
+               , double dt, double maxRate, double maxAccel)
+    {
+        const double wanted = clampTo(targetRate + servo_gain * errorDeg
+                                      , maxRate);
+        rAxis.rateDegPerSec += clampTo(wanted - rAxis.rateDegPerSec
+                                       , maxAccel * dt);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         SimulatedController
+
+Purpose      Constructor, of a 200 Hz servo with axes limited to 5 degrees/s
+             and 2 degrees/s^2;
+
+Input        pTracker           Tracker the setpoints are read from, which
+                                must outlive the controller;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SimulatedController::SimulatedController(const SunTracker *pTracker
+                                         , QObject *parent)
+    : QThread(parent)
+    , mTracker(pTracker)
+    , mRateHz(200.0)
+    , mMaxRate(5.0)
+    , mMaxAccel(2.0)
+    , mStallSeconds(0.0)
+    , mMaxAge(0.25)
+    , mStopping(false)
+{
+    ControllerStatistics stats = {0, 0, 0, 0.0, 0.0, 0.0};
+    mStatistics = stats;
+}
+
+/*----------------------------------------------------------------------------
+Name         ~SimulatedController
+
+Purpose      Destructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SimulatedController::~SimulatedController()
+{
+    stop();
+}
+
+/*----------------------------------------------------------------------------
+Name         setServo
+
+Purpose      Sets the servo rate and the limits of each axis;
+
+Input        rRateHz            Servo cycles per second;
+             rMaxRateDegPerSec  Largest rate of either axis;
+             rMaxAccelDegPerSec2 Largest acceleration of either axis;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SimulatedController::setServo(const double &rRateHz
+                                   , const double &rMaxRateDegPerSec
+                                   , const double &rMaxAccelDegPerSec2)
+{
+    mRateHz = rRateHz;
+    mMaxRate = rMaxRateDegPerSec;
+    mMaxAccel = rMaxAccelDegPerSec2;
+}
+
+/*----------------------------------------------------------------------------
+Name         setStallSeconds
+
+Purpose      Sets how long each cycle stalls after reading the setpoint, to
+             show that a slow consumer does not hold up the tracker;
+
+Input        rSeconds           The stall, 0 for none;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SimulatedController::setStallSeconds(const double &rSeconds)
+{
+    mStallSeconds = rSeconds;
+}
+
+/*----------------------------------------------------------------------------
+Name         setMaxSetpointAge
+
+Purpose      Sets the age beyond which a setpoint counts as stale;
+
+Input        rSeconds           The age, on the tracker's clock;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SimulatedController::setMaxSetpointAge(const double &rSeconds)
+{
+    mMaxAge = rSeconds;
+}
+
+/*----------------------------------------------------------------------------
+Name         statistics
+
+Purpose      Returns how well the simulated antenna followed the setpoints.
+             Only valid once the thread has stopped;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+ControllerStatistics SimulatedController::statistics() const
+{
+    return mStatistics;
+}
+
+/*----------------------------------------------------------------------------
+Name         requestStop
+
+Purpose      Asks the servo thread to stop at the end of the current cycle;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SimulatedController::requestStop()
+{
+    mStopping = true;
+}
+
+/*----------------------------------------------------------------------------
+Name         stop
+
+Purpose      Stops the servo thread and waits for it to finish;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SimulatedController::stop()
+{
+    requestStop();
+    wait();
+    mStopping = false;
+}
+
+/*----------------------------------------------------------------------------
+Name         run
+
+Purpose      Body of the servo thread.  Follows the setpoints until stopped;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SimulatedController::run()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    ControllerStatistics stats = {0, 0, 0, 0.0, 0.0, 0.0};
+    mStatistics = stats;
+
+    // Wait for the first setpoint, and start on it;
+    TrackingSetpoint setpoint = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0};
+    unsigned long long seen = 0;
+    while (!mStopping && (seen = mTracker->latest(setpoint)) == 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    Axis azimuth = {setpoint.azimuthDeg, setpoint.azimuthRateDegPerSec};
+    Axis elevation = {setpoint.elevationDeg
+                      , setpoint.elevationRateDegPerSec};
+    stats.setpoints = 1;
+
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1.0 / mRateHz));
+    const Clock::time_point start = Clock::now();
+    double last = mTracker->utcNow();
+    double sumSquares = 0.0;
+
+    for (unsigned long long cycle = 1; !mStopping; cycle++)
+    {
+        std::this_thread::sleep_until(start + period * cycle);
+
+        const unsigned long long count = mTracker->latest(setpoint);
+        if (count != seen)
+        {
+            seen = count;
+            stats.setpoints++;
+        }
+
+        if (mStallSeconds > 0.0)
+        {
+            std::this_thread::sleep_for(
+                        std::chrono::duration<double>(mStallSeconds));
+        }
+
+        // Move the axes on to now at the rates set last cycle;
+        const double now = mTracker->utcNow();
+        const double dt = now - last;
+        last = now;
+        azimuth.positionDeg += azimuth.rateDegPerSec * dt;
+        elevation.positionDeg += elevation.rateDegPerSec * dt;
+
+        // Where the setpoint says the sun is now;
+        const double age = now - setpoint.utcSeconds;
+        stats.maxSetpointAgeSeconds = qMax(stats.maxSetpointAgeSeconds, age);
+        if (age > mMaxAge)
+        {
+            stats.staleCycles++;
+        }
+
+        const double azRate = setpoint.azimuthRateDegPerSec
+                + setpoint.azimuthAccelDegPerSec2 * age;
+        const double elRate = setpoint.elevationRateDegPerSec
+                + setpoint.elevationAccelDegPerSec2 * age;
+        const double azError = wrap180(setpoint.azimuthDeg
+                                       + (setpoint.azimuthRateDegPerSec
+                                          + azRate) * 0.5 * age
+                                       - azimuth.positionDeg);
+        const double elError = setpoint.elevationDeg
+                + (setpoint.elevationRateDegPerSec + elRate) * 0.5 * age
+                - elevation.positionDeg;
+
+        // The azimuth error shrinks on the sky with elevation;
+        const double error = hypot(azError * cos(elevation.positionDeg
+                                                 * (M_PI / 180.0))
+                                   , elError);
+        sumSquares += error * error;
+        stats.maxErrorDeg = qMax(stats.maxErrorDeg, error);
+        stats.cycles = cycle;
+        stats.rmsErrorDeg = sqrt(sumSquares / cycle);
+
+        drive(azimuth, azError, azRate, dt, mMaxRate, mMaxAccel);
+        drive(elevation, elError, elRate, dt, mMaxRate, mMaxAccel);
+    }
+
+    mStatistics = stats;
+}
@@ -0,0 +1,73 @@
+/*----------------------------------------------------------------------------
+Name         simulatedcontroller.h
+
+Purpose      Simulated antenna controller which follows a SunTracker's
+             setpoints with rate and acceleration limited axes, so that the
+             tracker can be tried out without an antenna;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef SIMULATEDCONTROLLER_H
+#define SIMULATEDCONTROLLER_H
+
+#include <QThread> // ISA QThread;
+#include <atomic> // USES std::atomic for the stop flag;
+#include "suntracker.h" // USES SunTracker for the setpoints;
+
+// How well the simulated antenna followed the setpoints;
+struct ControllerStatistics
+{
+    unsigned long long cycles; // Servo cycles run;
+    unsigned long long setpoints; // Different setpoints read;
+    unsigned long long staleCycles; // Cycles whose setpoint was too old;
+    double maxSetpointAgeSeconds; // Oldest setpoint used;
+    double rmsErrorDeg; // RMS pointing error on the sky;
+    double maxErrorDeg; // Largest pointing error on the sky;
+};
+
+class SimulatedController : public QThread
+{
+    Q_OBJECT
+
+public:
+    // Constructor, of a controller following a tracker;
+    explicit SimulatedController(const SunTracker* pTracker
+                                 , QObject *parent = 0);
+    ~SimulatedController(); // Destructor, stops the thread;
+
+    // Sets the servo rate, in Hz, and the limits of each axis.  Only while
+    // stopped;
+    void setServo(const double& rRateHz
+                  , const double& rMaxRateDegPerSec
+                  , const double& rMaxAccelDegPerSec2);
+    // Sets how long each cycle stalls after reading, to stand in for a slow
+    // consumer.  Only while stopped;
+    void setStallSeconds(const double& rSeconds);
+    // Sets the age beyond which a setpoint counts as stale.  Only while
+    // stopped;
+    void setMaxSetpointAge(const double& rSeconds);
+
+    // Returns how well the setpoints were followed.  Only once stopped;
+    ControllerStatistics statistics(void) const;
+
+    // Asks the thread to stop at the end of the current cycle;
+    void requestStop(void);
+    // Stops the thread and waits for it to finish;
+    void stop(void);
+
+protected:
+    void run(); // Body of the servo thread;
+
+private:
+    const SunTracker* mTracker; // Tracker the setpoints are read from;
+    double mRateHz; // Servo cycles per second;
+    double mMaxRate; // Largest rate of either axis, in degrees/s;
+    double mMaxAccel; // Largest acceleration of either axis, in degrees/s^2;
+    double mStallSeconds; // Stall after each read;
+    double mMaxAge; // Age, in seconds, beyond which a setpoint is stale;
+
+    std::atomic<bool> mStopping; // The thread should exit;
+    ControllerStatistics mStatistics; // Written by the thread as it runs;
+};
+
+#endif // SIMULATEDCONTROLLER_H
@@ -8,6 +8,49 @@ History		 29 Jun 16  AFB	Created
 ----------------------------------------------------------------------------*/
 
 #include "solarcalc.h"
+#include "metrics.h" // USES MetricsRegistry to count and time each stage;
+
+namespace
+{
+    // Stages of SolarCalc::calculate, in the order they run;
+    const char* const solar_stages[] = {
+        "eot", "tst", "ha", "dec", "zen", "az", "alt"
+    };
+    const int solar_stage_count = sizeof(solar_stages)
+                                  / sizeof(solar_stages[0]);
+
+    // Metrics of SolarCalc::calculate;
+    struct SolarMetrics
+    {
+        SolarMetrics()
+        {
+            MetricsRegistry& rRegistry = MetricsRegistry::instance();
+            calls = rRegistry.counter("got_solar_calculations_total"
+                                      , "Solar positions calculated");
+            nanResults = rRegistry.counter("got_nan_results_total"
+                                           , "Calculations with a NaN result"
+                                           , "calculator", "solar");
+            for (int i = 0; i < solar_stage_count; i++)
+            {
+                stages[i] = rRegistry.histogram(
+                            "got_solar_stage_seconds"
+                            , "Time spent in each stage of a solar position"
+                            , "stage", solar_stages[i]);
+            }
+        }
+
+        MetricsCounter calls; // Calls to calculate;
+        MetricsCounter nanResults; // Positions which came out as NaN;
+        MetricsHistogram stages[solar_stage_count]; // Time in each stage;
+    };
+
+    // Returns the metrics, registering them on first use;
+    const SolarMetrics& solarMetrics()
+    {
+        static const SolarMetrics metrics;
+        return metrics;
+    }
+}
 
 /*----------------------------------------------------------------------------
 Name         SolarCalc
@@ -27,9 +70,10 @@ SolarCalc::SolarCalc(QObject *parent) : QObject(parent)
 
     mTimeWasSet = false;
     mDateWasSet = false;
+    mUtcWasSet = false;
 
-    mHour = 0;
-    mMinute = 0;
+    mSecondsOfDay = 0;
+    mUtcSeconds = 0;
     mDayOfYear = 0;
     mIsDaylightSavings = false;
 
@@ -58,8 +102,12 @@ Input        rLatitude          The latitude of the unit;
              rLongitude         The longitude of the unit;
              time               The current time;
              date               The current date;
+             daylightSavings    Whether or not it is daylight savings time;
 
 History		 29 Jun 16  AFB	Created
+             17 Oct 26  AFB Keep the daylight savings passed in, rather than
+                            resetting it to false;
+             17 Oct 26  AFB Keep the seconds of the time;
 ----------------------------------------------------------------------------*/
 SolarCalc::SolarCalc(const double &rLatitude
                      , const double &rLongitude
@@ -74,16 +122,15 @@ SolarCalc::SolarCalc(const double &rLatitude
     mLatitudeRad = getRadians(mLatitudeDeg);
     mLongitudeRad = getRadians(mLongitudeDeg);
 
-    mHour = mTime.hour();
-    mMinute = mTime.minute();
+    mSecondsOfDay = mTime.msecsSinceStartOfDay() / 1000.0;
+    mUtcSeconds = 0;
     mDayOfYear = mDate.dayOfYear();
 
     mTimeWasSet = true;
     mDateWasSet = true;
+    mUtcWasSet = false;
 
     // Initialize all left over variables;
-    mIsDaylightSavings = false;
-
     mSolarDeclinationDeg = 0;
     mSolarDeclinationRad = 0;
 
@@ -125,16 +172,195 @@ Notes        Because the calculation involes many minor calculations it's
              as arguments can be called;
 
 History		 4 Jul 16  AFB	Created
+             17 Oct 26  AFB Count and time each stage;
 ----------------------------------------------------------------------------*/
 void SolarCalc::calculate()
 {
-     calculateEot(); // Calculates Equation of Time;
-     calculateTst(); // Calculates True Solar Time;
-     calculateHa(); // Calculates Hour Angle;
-     calculateDec(); // Calculates Solar Declination;
-     calculateZen(); // Calculates Solar Zenith;
-     calculateAz(); // Calculates Solar Azimuth;
-     calculateAlt(); // Calculates Solar Altitude (elevation);
+    // The stages, in the same order as solar_stages;
+    typedef void (SolarCalc::*Stage)(void);
+    static const Stage stages[solar_stage_count] = {
+        &SolarCalc::calculateEot, // Calculates Equation of Time;
+        &SolarCalc::calculateTst, // Calculates True Solar Time;
+        &SolarCalc::calculateHa, // Calculates Hour Angle;
+        &SolarCalc::calculateDec, // Calculates Solar Declination;
+        &SolarCalc::calculateZen, // Calculates Solar Zenith;
+        &SolarCalc::calculateAz, // Calculates Solar Azimuth;
+        &SolarCalc::calculateAlt // Calculates Solar Altitude (elevation);
+    };
+
+    const SolarMetrics& rMetrics = solarMetrics();
+    rMetrics.calls.increment();
+
+    for (int i = 0; i < solar_stage_count; i++)
+    {
+        MetricsTimer timer(rMetrics.stages[i]);
+        (this->*stages[i])();
+    }
+
+    if (mSolarAzimuthDeg != mSolarAzimuthDeg
+            || mSolarAltitudeDeg != mSolarAltitudeDeg)
+    {
+        rMetrics.nanResults.increment();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         calculateBatch
+
+Purpose      Calculates the azimuth, altitude, zenith, and hour angle of the sun
+             for an array of times on a single date at a single site;
+
+Input        rLatitude          The latitude of the unit, in degrees;
+             rLongitude         The longitude of the unit, in degrees;
+             rDate              The date shared by every entry of the table;
+             rDaylightSavings   Whether or not the times are daylight savings
+                                time;
+             pSecondsOfDay      Array of local times, in seconds since local
+                                midnight;
+             count              Number of entries in pSecondsOfDay and in each
+                                of the output arrays;
+             rBackend           Trigonometric functions to use.  LibmMath by
+                                default, or PolynomialMath for large tables;
+
+Output       pAzimuthDeg        Solar Azimuth in degrees;
+             pAltitudeDeg       Solar Altitude in degrees;
+             pZenithDeg         Solar Zenith in degrees;
+             pHourAngleDeg      Hour Angle in degrees;
+
+Notes        This is the same calculation performed by calculate(), arranged so
+             that it may be run over a whole tracking table at once.  Everything
+             which depends only upon the site and the date (Equation of Time,
+             declination, and the sine and cosine of the latitude and
+             declination) is worked out once before the loop.  What remains in
+             the loop depends only on the time of the entry, contains no
+             branches, and writes to separate output arrays, which allows the
+             compiler to process several entries per instruction (AVX2, NEON);
+
+             This gives the same answer as calculate(), to the second;
+
+             Any of the output pointers may be null if that column is not
+             wanted, but every non-null array must hold count entries;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Add rBackend;
+----------------------------------------------------------------------------*/
+void SolarCalc::calculateBatch(const double& rLatitude
+                               , const double& rLongitude
+                               , const QDate& rDate
+                               , const bool& rDaylightSavings
+                               , const double* pSecondsOfDay
+                               , size_t count
+                               , double* pAzimuthDeg
+                               , double* pAltitudeDeg
+                               , double* pZenithDeg
+                               , double* pHourAngleDeg
+                               , const SolarMathBackend& rBackend)
+{
+    calculateBatch(calculateDayTerms(rLatitude, rLongitude, rDate.dayOfYear())
+                   , rDaylightSavings
+                   , pSecondsOfDay
+                   , count
+                   , pAzimuthDeg
+                   , pAltitudeDeg
+                   , pZenithDeg
+                   , pHourAngleDeg
+                   , rBackend);
+}
+
+/*----------------------------------------------------------------------------
+Name         calculateBatch
+
+Purpose      Calculates the azimuth, altitude, zenith, and hour angle of the sun
+             for an array of times, given the terms which are constant for the
+             site and date;
+
+Input        rTerms             Terms returned by calculateDayTerms;
+             rDaylightSavings   Whether or not the times are daylight savings
+                                time;
+             pSecondsOfDay      Array of local times, in seconds since local
+                                midnight;
+             count              Number of entries in pSecondsOfDay and in each
+                                of the output arrays;
+             rBackend           Trigonometric functions to use;
+
+Output       pAzimuthDeg        Solar Azimuth in degrees;
+             pAltitudeDeg       Solar Altitude in degrees;
+             pZenithDeg         Solar Zenith in degrees;
+             pHourAngleDeg      Hour Angle in degrees;
+
+Notes        See the other form of calculateBatch.  This form allows the day
+             terms to be worked out once and kept, as SolarEphemerisCache does.
+             The calculation itself is solarmath::positions;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Add rBackend;
+----------------------------------------------------------------------------*/
+void SolarCalc::calculateBatch(const SolarDayTerms& rTerms
+                               , const bool& rDaylightSavings
+                               , const double* pSecondsOfDay
+                               , size_t count
+                               , double* pAzimuthDeg
+                               , double* pAltitudeDeg
+                               , double* pZenithDeg
+                               , double* pHourAngleDeg
+                               , const SolarMathBackend& rBackend)
+{
+    solarmath::positions(rTerms
+                         , rDaylightSavings
+                         , pSecondsOfDay
+                         , count
+                         , pAzimuthDeg
+                         , pAltitudeDeg
+                         , pZenithDeg
+                         , pHourAngleDeg
+                         , rBackend);
+}
+
+/*----------------------------------------------------------------------------
+Name         calculateBatchUtc
+
+Purpose      Calculates the azimuth, altitude, zenith, and hour angle of the sun
+             for an array of UTC instants at a single site;
+
+Input        rLatitude          The latitude of the unit, in degrees;
+             rLongitude         The longitude of the unit, in degrees;
+             pUtcSeconds        Array of instants, in seconds since
+                                1 Jan 1970 UTC, with any fraction;
+             count              Number of entries in pUtcSeconds and in each
+                                of the output arrays;
+             rBackend           Trigonometric functions to use;
+
+Output       pAzimuthDeg        Solar Azimuth in degrees;
+             pAltitudeDeg       Solar Altitude in degrees;
+             pZenithDeg         Solar Zenith in degrees;
+             pHourAngleDeg      Hour Angle in degrees;
+
+Notes        The instants may run across any number of days, and no QDate or
+             QTime is made for them.  Local times may be converted in bulk
+             with a TimeZoneTable first.  The calculation itself is
+             solarmath::positionsUtc;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SolarCalc::calculateBatchUtc(const double &rLatitude
+                                  , const double &rLongitude
+                                  , const double *pUtcSeconds
+                                  , size_t count
+                                  , double *pAzimuthDeg
+                                  , double *pAltitudeDeg
+                                  , double *pZenithDeg
+                                  , double *pHourAngleDeg
+                                  , const SolarMathBackend &rBackend)
+{
+    solarmath::positionsUtc(rLatitude
+                            , rLongitude
+                            , pUtcSeconds
+                            , count
+                            , pAzimuthDeg
+                            , pAltitudeDeg
+                            , pZenithDeg
+                            , pHourAngleDeg
+                            , rBackend);
 }
 
 /*----------------------------------------------------------------------------
@@ -147,14 +373,16 @@ Input        rDate                  QTime with the time to be used to calculate
                                     the solar altitude/azimuth;
 
 History		 4 Jul 16  AFB	Created
+             17 Oct 26  AFB Keep the seconds and milliseconds, and go back to
+                            local time if setUtc was called;
 ----------------------------------------------------------------------------*/
 void SolarCalc::setTime(const QTime& rTime)
 {
     mTimeWasSet = true;
+    mUtcWasSet = false;
 
     mTime = rTime;
-    mHour = mTime.hour();
-    mMinute = mTime.minute();
+    mSecondsOfDay = mTime.msecsSinceStartOfDay() / 1000.0;
 }
 
 /*----------------------------------------------------------------------------
@@ -167,10 +395,12 @@ Input        rDate                  QDate with the day to be used to calculate
                                     the solar altitude/azimuth;
 
 History		 4 Jul 16  AFB	Created
+             17 Oct 26  AFB Go back to local time if setUtc was called;
 ----------------------------------------------------------------------------*/
 void SolarCalc::setDate(const QDate& rDate)
 {
     mDateWasSet = true;
+    mUtcWasSet = false;
 
     mDate = rDate;
     mDayOfYear = mDate.dayOfYear();
@@ -208,6 +438,47 @@ void SolarCalc::setDaylightSavings(const bool &rDst)
     mIsDaylightSavings = rDst;
 }
 
+/*----------------------------------------------------------------------------
+Name         setUtc
+
+Purpose      Sets the instant used for calculation of the solar azimuth and
+             altitude angles, in UTC.  This is used in place of the local
+             time, date, and daylight savings until setTime or setDate is
+             called;
+
+Input        rUtcSeconds            Seconds since 1 Jan 1970 UTC, with any
+                                    fraction;
+
+Notes        No time zone is assumed, so the position is correct anywhere,
+             and no QDate or QTime is made, so this may be called for every
+             sample of a track;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SolarCalc::setUtc(const double &rUtcSeconds)
+{
+    mUtcWasSet = true;
+
+    mUtcSeconds = rUtcSeconds;
+    mDayOfYear = solarmath::dayOfYear(static_cast<long long>(
+                    floor(mUtcSeconds / solarmath::seconds_per_day)));
+}
+
+/*----------------------------------------------------------------------------
+Name         setUtcNanoseconds
+
+Purpose      Sets the instant used for calculation, in UTC, from a count of
+             nanoseconds, as kept by capture files and clocks;
+
+Input        rUtcNanoseconds        Nanoseconds since 1 Jan 1970 UTC;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SolarCalc::setUtcNanoseconds(const qint64 &rUtcNanoseconds)
+{
+    setUtc(solarmath::secondsFromNanoseconds(rUtcNanoseconds));
+}
+
 /*----------------------------------------------------------------------------
 Name         calculateEot
 
@@ -215,20 +486,60 @@ Purpose      Calculates an estimated Equation of Time based on the day of the
              year;
 
 History		 29 Jun 16  AFB	Created
+             17 Oct 26  AFB Moved the equation into equationOfTime so that it
+                            is shared with calculateBatch;
 ----------------------------------------------------------------------------*/
 void SolarCalc::calculateEot()
 {
     // If the date wasn't set by the user, use the current system date;
-    if(!mDateWasSet)
+    if(!mDateWasSet && !mUtcWasSet)
     {
         setDate(QDate::currentDate());
     }
 
-    double b = (360.0/365.0) * (mDayOfYear - 81.0);
-    b = getRadians(b);
+    mEquationOfTime = equationOfTime(mDayOfYear);
+}
+
+/*----------------------------------------------------------------------------
+Name         calculateDayTerms
+
+Purpose      Calculates the terms of the solar position which depend only upon
+             the site and the date;
+
+Input        rLatitude          The latitude of the unit, in degrees;
+             rLongitude         The longitude of the unit, in degrees;
+             rDayOfYear         Day of year (1-365 (366 for leap year));
+
+Returns      SolarDayTerms      The terms, ready to be passed to
+                                calculateBatch;
 
-    mEquationOfTime = (9.87 * sin((2.0 * b)))
-            - (7.53 * cos(b)) - (1.5 * sin(b));
+Notes        See solarmath::dayTerms;
+
+History		 17 Oct 26  AFB	Created from calculateBatch
+----------------------------------------------------------------------------*/
+SolarDayTerms SolarCalc::calculateDayTerms(const double &rLatitude
+                                           , const double &rLongitude
+                                           , const int &rDayOfYear)
+{
+    return solarmath::dayTerms(rLatitude, rLongitude, rDayOfYear);
+}
+
+/*----------------------------------------------------------------------------
+Name         equationOfTime
+
+Purpose      Returns an estimated Equation of Time for a day of the year;
+
+Input        rDayOfYear         Day of year (1-365 (366 for leap year));
+
+Returns      double             Equation of Time, in minutes;
+
+Notes        See solarmath::equationOfTime;
+
+History		 17 Oct 26  AFB	Created from calculateEot
+----------------------------------------------------------------------------*/
+double SolarCalc::equationOfTime(const int& rDayOfYear)
+{
+    return solarmath::equationOfTime(rDayOfYear);
 }
 
 /*----------------------------------------------------------------------------
@@ -238,9 +549,24 @@ Purpose      Calculates the True Solar Time, which is a factor of the current
              local time, the Equation of Time, and the Longitude;
 
 History		 29 Jun 16  AFB	Created
+             17 Oct 26  AFB Keep the seconds, take daylight savings off a
+                            copy rather than off mHour, which drifted an hour
+                            on every call, and add the UTC form;
 ----------------------------------------------------------------------------*/
 void SolarCalc::calculateTst()
 {
+    // In UTC the longitude gives the offset exactly;
+    if (mUtcWasSet)
+    {
+        const double secondsOfDay = mUtcSeconds - solarmath::seconds_per_day
+                * floor(mUtcSeconds / solarmath::seconds_per_day);
+        mTrueSolarTime = secondsOfDay / 60.0 + mEquationOfTime
+                + 4.0 * mLongitudeDeg;
+        mTrueSolarTime = mTrueSolarTime
+                - (1440.0 * (floor(mTrueSolarTime/1440.0)));
+        return;
+    }
+
     // Test if the time was set by the user.  If this is false, use the
     // computer's system time;
     if (!mTimeWasSet)
@@ -249,16 +575,17 @@ void SolarCalc::calculateTst()
     }
 
     // Account for daylight savings time;
+    double minutes = mSecondsOfDay / 60.0;
     if (mIsDaylightSavings)
     {
-        mHour -= 1;
+        minutes -= 60.0;
     }
 
     // Note that in the final portion of this equation:
     // mLongitudeDeg / 15
     // I am using a more precise calculation of the offset from UTC than if
     // I were to have user enter in their UTC offset;
-    mTrueSolarTime = ((((mMinute / 60.0) + mHour) / 24.0) * 1440.0
+    mTrueSolarTime = (minutes
                       + mEquationOfTime + 4.0
                       * mLongitudeDeg - 60.0
                       * (mLongitudeDeg / 15.0));
@@ -295,16 +622,36 @@ Name         calculateDec
 Purpose      Calculates the Solar Declination
 
 History		 29 Jun 16  AFB	Created
+             17 Oct 26  AFB Moved the equation into solarDeclination so that
+                            it is shared with calculateBatch;
+             17 Oct 26  AFB The declination now follows mDayOfYear, rather
+                            than staying at that of day 181;
 ----------------------------------------------------------------------------*/
 void SolarCalc::calculateDec()
 {
-    // 23.45 is the maximum declination over the period of Earth's rotation;
-    mSolarDeclinationDeg = 23.45
-            * sin(getRadians((360.0/365.0) * (181.0 - 81.0)));
+    mSolarDeclinationDeg = solarDeclination(mDayOfYear);
 
     mSolarDeclinationRad = getRadians(mSolarDeclinationDeg);
 }
 
+/*----------------------------------------------------------------------------
+Name         solarDeclination
+
+Purpose      Returns the Solar Declination for a day of the year;
+
+Input        rDayOfYear         Day of year (1-365 (366 for leap year));
+
+Returns      double             Solar Declination, in degrees;
+
+Notes        See solarmath::solarDeclination;
+
+History		 17 Oct 26  AFB	Created from calculateDec
+----------------------------------------------------------------------------*/
+double SolarCalc::solarDeclination(const int& rDayOfYear)
+{
+    return solarmath::solarDeclination(rDayOfYear);
+}
+
 /*----------------------------------------------------------------------------
 Name         calculateZen
 
@@ -14,7 +14,9 @@ History		 29 Jun 16  AFB	Created
 #include <QTime> // HASA QTime object for keeping track of user-entered time;
 #include <QDate> // HASA QDate object for keeping track of user-entered date;
 #include <cmath> // USES several cmath functions;
+#include <algorithm> // USES std::min and std::max;
 #include <QDebug>
+#include "solarmath.h" // USES solarmath for the stateless calculations;
 
 class SolarCalc : public QObject
 {
@@ -32,10 +34,60 @@ public:
 
     void calculate(void); // Makes all necessary calculations;
 
+    // Calculates a table of solar positions for one site and date;
+    static void calculateBatch(const double& rLatitude
+                               , const double& rLongitude
+                               , const QDate& rDate
+                               , const bool& rDaylightSavings
+                               , const double* pSecondsOfDay
+                               , size_t count
+                               , double* pAzimuthDeg
+                               , double* pAltitudeDeg
+                               , double* pZenithDeg
+                               , double* pHourAngleDeg
+                               , const SolarMathBackend& rBackend = LibmMath);
+    // Calculates a table of solar positions from precalculated day terms;
+    static void calculateBatch(const SolarDayTerms& rTerms
+                               , const bool& rDaylightSavings
+                               , const double* pSecondsOfDay
+                               , size_t count
+                               , double* pAzimuthDeg
+                               , double* pAltitudeDeg
+                               , double* pZenithDeg
+                               , double* pHourAngleDeg
+                               , const SolarMathBackend& rBackend = LibmMath);
+
+    // Calculates a table of solar positions for UTC instants at one site;
+    static void calculateBatchUtc(const double& rLatitude
+                                  , const double& rLongitude
+                                  , const double* pUtcSeconds
+                                  , size_t count
+                                  , double* pAzimuthDeg
+                                  , double* pAltitudeDeg
+                                  , double* pZenithDeg
+                                  , double* pHourAngleDeg
+                                  , const SolarMathBackend& rBackend
+                                    = LibmMath);
+
+    // Calculates the terms which are constant for a site and date;
+    static SolarDayTerms calculateDayTerms(const double& rLatitude
+                                           , const double& rLongitude
+                                           , const int& rDayOfYear);
+
+    // Returns the Equation of Time, in minutes, for a day of the year;
+    static double equationOfTime(const int& rDayOfYear);
+    // Returns the Solar Declination, in degrees, for a day of the year;
+    static double solarDeclination(const int& rDayOfYear);
+
 
     void setTime(const QTime& rTime); // Sets the current local time;
     void setDate(const QDate& rDate); // Sets the current date;
     void setDaylightSavings(const bool& rDst); // Sets daylight savings;
+    // Sets the instant, in seconds since 1 Jan 1970 UTC, in place of the
+    // local time, date, and daylight savings;
+    void setUtc(const double& rUtcSeconds);
+    // Sets the instant, in nanoseconds since 1 Jan 1970 UTC;
+    void setUtcNanoseconds(const qint64& rUtcNanoseconds);
     void setLatitude(const double& rLatitude); // Sets the unit's latitude;
     void setLongitude(const double& rLongitude); // Sets the unit's longitude;
 
@@ -59,9 +111,10 @@ private:
     QDate mDate; // Current date;
     bool mTimeWasSet; // Variable for holding whether or not the time was set;
     bool mDateWasSet; // Variable for holding whether or not the date was set;
+    bool mUtcWasSet; // Whether the instant was set in UTC, and is used;
 
-    int mHour; // Current hour;
-    int mMinute; // Current minute;
+    double mSecondsOfDay; // Current local time, in seconds since midnight;
+    double mUtcSeconds; // Current instant, in seconds since 1970 UTC;
     int mDayOfYear; // Day of year (1-365 (366 for leap year));
     bool mIsDaylightSavings; // Whether or not it is currently DST in locale;
 
@@ -90,8 +143,8 @@ private:
     void calculateAz(void); // Calculates Solar Azimuth;
     void calculateAlt(void); // Calculates Solar Altitude (elevation);
 
-    double getRadians(double degrees); // Returns radians from degrees;
-    double getDegrees(double radians); // Returns degrees from radians;
+    static double getRadians(double degrees); // Returns radians from degrees;
+    static double getDegrees(double radians); // Returns degrees from radians;
 };
 
 #endif // SOLARCALC_H
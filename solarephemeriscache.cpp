@@ -0,0 +1,345 @@
+/*----------------------------------------------------------------------------
+Name         solarephemeriscache.cpp
+
+Purpose      Remembers the per-day terms of the solar position for recently
+             used sites and dates, so that repeated queries only need the
+             per-time part of the calculation;
+
+Notes        The Equation of Time, the declination, and the sines and cosines
+             of the latitude and declination only change with the site and the
+             day of the year.  Once they are cached, a query for the position
+             of the sun is left with the hour angle and a few multiplies;
+
+             Lookups which find their entry only take the read lock, so any
+             number of threads may search the table at once.  The entries are
+             also linked into a list in order of use, which a lookup that
+             finds its entry moves it to the head of under a mutex held for a
+             few pointer stores.  The write lock is only taken to add an
+             entry, evicting the one at the tail of the list once the cache
+             is full, so eviction takes constant time whatever the capacity;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Evict from the tail of a list in order of use,
+                            rather than scanning every entry;
+----------------------------------------------------------------------------*/
+#include "solarephemeriscache.h"
+
+/*----------------------------------------------------------------------------
+Name         qHash
+
+Purpose      Hashes a cache key for QHash;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+uint qHash(const SolarEphemerisCache::Key &rKey, uint seed)
+{
+    uint hash = qHash(rKey.latitude, seed);
+    hash = hash * 31 + qHash(rKey.longitude, seed);
+    hash = hash * 31 + qHash(rKey.julianDay, seed);
+    return hash;
+}
+
+/*----------------------------------------------------------------------------
+Name         operator==
+
+Purpose      Compares two cache keys;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SolarEphemerisCache::Key::operator==(const Key &rOther) const
+{
+    return latitude == rOther.latitude
+            && longitude == rOther.longitude
+            && julianDay == rOther.julianDay;
+}
+
+/*----------------------------------------------------------------------------
+Name         SolarEphemerisCache
+
+Purpose      Constructor;
+
+Input        capacity           Maximum number of site and date entries which
+                                are kept;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SolarEphemerisCache::SolarEphemerisCache(int capacity)
+    : mCapacity(qMax(1, capacity))
+    , mpNewest(0)
+    , mpOldest(0)
+    , mHits(0)
+    , mMisses(0)
+{
+    mEntries.reserve(mCapacity);
+}
+
+/*----------------------------------------------------------------------------
+Name         ~SolarEphemerisCache
+
+Purpose      Destructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SolarEphemerisCache::~SolarEphemerisCache()
+{
+    qDeleteAll(mEntries);
+}
+
+/*----------------------------------------------------------------------------
+Name         getDayTerms
+
+Purpose      Returns the terms of the solar position which depend only upon
+             the site and date, calculating and caching them if they are not
+             already cached;
+
+Input        rLatitude          The latitude of the unit, in degrees;
+             rLongitude         The longitude of the unit, in degrees;
+             rDate              The date;
+
+Returns      SolarDayTerms      The terms, ready to be passed to
+                                SolarCalc::calculateBatch;
+
+Notes        Safe to call from any number of threads at once;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SolarDayTerms SolarEphemerisCache::getDayTerms(const double &rLatitude
+                                               , const double &rLongitude
+                                               , const QDate &rDate)
+{
+    Key key;
+    key.latitude = rLatitude;
+    key.longitude = rLongitude;
+    key.julianDay = rDate.toJulianDay();
+
+    {
+        QReadLocker locker(&mLock);
+        QHash<Key, Entry*>::const_iterator it = mEntries.constFind(key);
+        if (it != mEntries.constEnd())
+        {
+            Entry* pEntry = it.value();
+            {
+                QMutexLocker orderLocker(&mOrderLock);
+                if (pEntry != mpNewest)
+                {
+                    unlink(pEntry);
+                    linkNewest(pEntry);
+                }
+            }
+            mHits++;
+            return pEntry->terms;
+        }
+    }
+
+    mMisses++;
+
+    // Calculate the terms without holding the lock;
+    const SolarDayTerms terms
+            = SolarCalc::calculateDayTerms(rLatitude
+                                           , rLongitude
+                                           , rDate.dayOfYear());
+
+    QWriteLocker locker(&mLock);
+
+    // Another thread may have added the same entry in the meantime;
+    if (!mEntries.contains(key))
+    {
+        if (mEntries.size() >= mCapacity)
+        {
+            evictLeastRecentlyUsed();
+        }
+
+        Entry* pEntry = new Entry;
+        pEntry->terms = terms;
+        pEntry->key = key;
+        linkNewest(pEntry);
+        mEntries.insert(key, pEntry);
+    }
+
+    return terms;
+}
+
+/*----------------------------------------------------------------------------
+Name         calculate
+
+Purpose      Calculates the azimuth and altitude of the sun for a site, date,
+             and time, using the cached day terms;
+
+Input        rLatitude          The latitude of the unit, in degrees;
+             rLongitude         The longitude of the unit, in degrees;
+             rDate              The date;
+             rSecondsOfDay      Local time, in seconds since local midnight;
+             rDaylightSavings   Whether or not the time is daylight savings
+                                time;
+
+Output       rAzimuthDeg        Solar Azimuth in degrees;
+             rAltitudeDeg       Solar Altitude in degrees;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SolarEphemerisCache::calculate(const double &rLatitude
+                                    , const double &rLongitude
+                                    , const QDate &rDate
+                                    , const double &rSecondsOfDay
+                                    , const bool &rDaylightSavings
+                                    , double &rAzimuthDeg
+                                    , double &rAltitudeDeg)
+{
+    const SolarDayTerms terms = getDayTerms(rLatitude, rLongitude, rDate);
+
+    SolarCalc::calculateBatch(terms
+                              , rDaylightSavings
+                              , &rSecondsOfDay
+                              , 1
+                              , &rAzimuthDeg
+                              , &rAltitudeDeg
+                              , 0
+                              , 0);
+}
+
+/*----------------------------------------------------------------------------
+Name         clear
+
+Purpose      Forgets every cached entry;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SolarEphemerisCache::clear()
+{
+    QWriteLocker locker(&mLock);
+    qDeleteAll(mEntries);
+    mEntries.clear();
+    mpNewest = 0;
+    mpOldest = 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         getSize
+
+Purpose      Returns the number of entries currently cached;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int SolarEphemerisCache::getSize()
+{
+    QReadLocker locker(&mLock);
+    return mEntries.size();
+}
+
+/*----------------------------------------------------------------------------
+Name         getCapacity
+
+Purpose      Returns the maximum number of entries which are cached;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int SolarEphemerisCache::getCapacity() const
+{
+    return mCapacity;
+}
+
+/*----------------------------------------------------------------------------
+Name         getHits
+
+Purpose      Returns the number of lookups which were found in the cache;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+quint64 SolarEphemerisCache::getHits() const
+{
+    return mHits;
+}
+
+/*----------------------------------------------------------------------------
+Name         getMisses
+
+Purpose      Returns the number of lookups which had to be calculated;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+quint64 SolarEphemerisCache::getMisses() const
+{
+    return mMisses;
+}
+
+/*----------------------------------------------------------------------------
+Name         unlink
+
+Purpose      Takes an entry out of the list in order of use;
+
+Input        pEntry             The entry, which must be in the list;
+
+Notes        Must be called with the write lock held, or the read lock and
+             mOrderLock;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SolarEphemerisCache::unlink(Entry *pEntry)
+{
+    if (pEntry->pNewer)
+    {
+        pEntry->pNewer->pOlder = pEntry->pOlder;
+    }
+    else
+    {
+        mpNewest = pEntry->pOlder;
+    }
+
+    if (pEntry->pOlder)
+    {
+        pEntry->pOlder->pNewer = pEntry->pNewer;
+    }
+    else
+    {
+        mpOldest = pEntry->pNewer;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         linkNewest
+
+Purpose      Puts an entry at the head of the list, as the most recently used;
+
+Input        pEntry             The entry, which must not be in the list;
+
+Notes        Must be called with the write lock held, or the read lock and
+             mOrderLock;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SolarEphemerisCache::linkNewest(Entry *pEntry)
+{
+    pEntry->pNewer = 0;
+    pEntry->pOlder = mpNewest;
+    if (mpNewest)
+    {
+        mpNewest->pNewer = pEntry;
+    }
+    else
+    {
+        mpOldest = pEntry;
+    }
+    mpNewest = pEntry;
+}
+
+/*----------------------------------------------------------------------------
+Name         evictLeastRecentlyUsed
+
+Purpose      Removes the entry which was used longest ago;
+
+Notes        Must be called with the write lock held, which keeps every
+             lookup out of the list;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Take the tail of the list rather than scanning;
+----------------------------------------------------------------------------*/
+void SolarEphemerisCache::evictLeastRecentlyUsed()
+{
+    Entry* pOldest = mpOldest;
+    if (pOldest)
+    {
+        unlink(pOldest);
+        mEntries.remove(pOldest->key);
+        delete pOldest;
+    }
+}
@@ -0,0 +1,89 @@
+/*----------------------------------------------------------------------------
+Name         solarephemeriscache.h
+
+Purpose      Remembers the per-day terms of the solar position for recently
+             used sites and dates, so that repeated queries only need the
+             per-time part of the calculation;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Keep the entries in a list in order of use;
+----------------------------------------------------------------------------*/
+#ifndef SOLAREPHEMERISCACHE_H
+#define SOLAREPHEMERISCACHE_H
+
+#include <QHash> // HASA QHash of cached entries;
+#include <QDate> // USES QDate to identify the day of an entry;
+#include <QReadWriteLock> // HASA QReadWriteLock guarding the entries;
+#include <QMutex> // HASA QMutex guarding the order of use;
+#include <atomic> // USES std::atomic for the statistics;
+#include "solarcalc.h" // USES SolarCalc to calculate the day terms;
+
+class SolarEphemerisCache
+{
+public:
+    explicit SolarEphemerisCache(int capacity = 4096); // Constructor;
+    ~SolarEphemerisCache(); // Destructor;
+
+    // Returns the day terms for a site and date, calculating them if needed;
+    SolarDayTerms getDayTerms(const double& rLatitude
+                              , const double& rLongitude
+                              , const QDate& rDate);
+
+    // Calculates the position of the sun for a site, date, and time;
+    void calculate(const double& rLatitude
+                   , const double& rLongitude
+                   , const QDate& rDate
+                   , const double& rSecondsOfDay
+                   , const bool& rDaylightSavings
+                   , double& rAzimuthDeg
+                   , double& rAltitudeDeg);
+
+    void clear(void); // Forgets every cached entry;
+
+    int getSize(void); // Number of entries currently cached;
+    int getCapacity(void) const; // Maximum number of entries cached;
+    quint64 getHits(void) const; // Number of lookups found in the cache;
+    quint64 getMisses(void) const; // Number of lookups calculated afresh;
+
+private:
+    // Identifies a site and date;
+    struct Key
+    {
+        double latitude;
+        double longitude;
+        qint64 julianDay;
+
+        bool operator==(const Key& rOther) const;
+    };
+
+    // A cached set of day terms, linked into the list in order of use;
+    struct Entry
+    {
+        SolarDayTerms terms;
+        Key key; // Key of the entry in mEntries;
+        Entry* pNewer; // Entry used next after this one, or 0;
+        Entry* pOlder; // Entry used last before this one, or 0;
+    };
+
+    friend uint qHash(const Key& rKey, uint seed);
+
+    QHash<Key, Entry*> mEntries; // Cached entries;
+    QReadWriteLock mLock; // Guards mEntries;
+    int mCapacity; // Maximum number of entries;
+
+    Entry* mpNewest; // Most recently used entry, or 0;
+    Entry* mpOldest; // Least recently used entry, or 0;
+    QMutex mOrderLock; // Guards the list, with mLock held for reading;
+
+    std::atomic<quint64> mHits; // Lookups found in the cache;
+    std::atomic<quint64> mMisses; // Lookups calculated afresh;
+
+    // Unlinks an entry from the list;
+    void unlink(Entry* pEntry);
+    // Links an entry in as the most recently used;
+    void linkNewest(Entry* pEntry);
+    // Removes the least recently used entry;
+    void evictLeastRecentlyUsed(void);
+};
+
+#endif // SOLAREPHEMERISCACHE_H
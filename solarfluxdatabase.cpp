@@ -0,0 +1,683 @@
+/*----------------------------------------------------------------------------
+Name         solarfluxdatabase.cpp
+
+Purpose      Local database of daily solar flux at the available frequencies,
+             imported from observatory flux files and read through a memory
+             map;
+
+Notes        The database file is a fixed header followed by one record per
+             day, from the first day imported to the last with no gaps.  A
+             record holds one 32 bit float per available frequency, in the
+             order of constants::available_frequencies, in solar flux units;
+             NaN marks a flux which was not observed.  As the records are
+             dense, a day's record is found from its offset from the first
+             day, and a lookup costs the same however many years are held.
+             The file is written in the byte order of the machine, which is
+             checked when it is opened;
+
+             The importer reads the daily noon flux files published by the
+             solar radio observatories, in which a line holding a date such
+             as "2016 Jun 29" is followed by one line per station giving the
+             station name and the flux at each of the nine frequencies, with
+             -1 for no observation.  Lines holding an ISO date followed by the
+             nine fluxes, separated by commas or spaces, are also accepted.
+             Where several stations report on a day, the median of their
+             fluxes is stored;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "solarfluxdatabase.h"
+
+#include "gotcalc.h" // USES the available frequencies;
+#include <QSaveFile> // USES QSaveFile to replace the database in one step;
+#include <QTextStream>
+#include <QRegExp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace
+{
+    const int frequency_count = constants::number_of_available_frequencies;
+
+    // Header at the start of the database file;
+    struct FileHeader
+    {
+        char magic[8]; // "GOTFLUX", null terminated;
+        quint32 version; // Version of the layout;
+        quint32 headerSize; // Size of this header, in bytes;
+        quint32 frequencyCount; // Number of fluxes in a record;
+        quint32 byteOrderMark; // byte_order_mark, as written;
+        qint64 firstJulianDay; // Julian day of the first record;
+        qint64 dayCount; // Number of records;
+        float frequencies[frequency_count]; // Frequency of each column, MHz;
+        quint32 reserved; // Zero;
+    };
+
+    const char file_magic[8] = "GOTFLUX";
+    const quint32 file_version = 1;
+    const quint32 byte_order_mark = 0x01020304;
+
+    // The fluxes of a day, one list of observations per frequency;
+    typedef std::vector<std::vector<float> > DayObservations;
+
+    // Works out the month from its English abbreviation;
+    int monthFromName(const QString& rName)
+    {
+        const char* const months[] = { "jan", "feb", "mar", "apr", "may"
+                                       , "jun", "jul", "aug", "sep", "oct"
+                                       , "nov", "dec" };
+        const QString name = rName.left(3).toLower();
+        for (int i = 0; i < 12; i++)
+        {
+            if (name == months[i])
+            {
+                return i + 1;
+            }
+        }
+
+        return 0;
+    }
+
+    // Parses the last frequency_count fields of a line as fluxes;
+    bool parseFluxes(const QStringList& rFields, float* pFluxes)
+    {
+        if (rFields.size() < frequency_count)
+        {
+            return false;
+        }
+
+        const int first = rFields.size() - frequency_count;
+        bool allFrequencies = true;
+
+        for (int i = 0; i < frequency_count; i++)
+        {
+            bool ok = false;
+            const double flux = rFields.at(first + i).toDouble(&ok);
+            if (!ok)
+            {
+                return false;
+            }
+
+            // Anything which is not a positive flux was not observed;
+            pFluxes[i] = (flux > 0) ? static_cast<float>(flux)
+                                    : std::numeric_limits<float>::quiet_NaN();
+            allFrequencies &= (flux == constants::available_frequencies[i]);
+        }
+
+        // A row of the frequencies themselves is a column heading;
+        return !allFrequencies;
+    }
+
+    // Adds a day's fluxes to the observations;
+    void addObservation(std::map<qint64, DayObservations>& rDays
+                        , const QDate& rDate
+                        , const float* pFluxes)
+    {
+        DayObservations& rDay = rDays[rDate.toJulianDay()];
+        rDay.resize(frequency_count);
+
+        for (int i = 0; i < frequency_count; i++)
+        {
+            if (pFluxes[i] == pFluxes[i])
+            {
+                rDay[i].push_back(pFluxes[i]);
+            }
+        }
+    }
+
+    // Reads one observatory flux file into the observations;
+    bool readFluxFile(const QString& rFileName
+                      , std::map<qint64, DayObservations>& rDays
+                      , QString& rError)
+    {
+        QFile file(rFileName);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            rError = "Unable to open " + rFileName + ": " + file.errorString();
+            return false;
+        }
+
+        const QRegExp dayHeading("^(\\d{4})\\s+([A-Za-z]{3,})\\s+(\\d{1,2})$");
+        const QRegExp isoDate("^(\\d{4})-(\\d{2})-(\\d{2})$");
+        const QRegExp separators("[,;\\s]+");
+
+        QTextStream in(&file);
+        QDate currentDate;
+        float fluxes[frequency_count];
+
+        while (!in.atEnd())
+        {
+            const QString line = in.readLine().trimmed();
+            if (line.isEmpty() || line.startsWith('#') || line.startsWith(':'))
+            {
+                continue;
+            }
+
+            // A date heading, followed by a line for each station;
+            if (dayHeading.exactMatch(line))
+            {
+                currentDate = QDate(dayHeading.cap(1).toInt()
+                                    , monthFromName(dayHeading.cap(2))
+                                    , dayHeading.cap(3).toInt());
+                continue;
+            }
+
+            const QStringList fields = line.split(separators
+                                                  , QString::SkipEmptyParts);
+
+            // An ISO date followed by the fluxes;
+            if (isoDate.exactMatch(fields.first()))
+            {
+                const QDate date(isoDate.cap(1).toInt()
+                                 , isoDate.cap(2).toInt()
+                                 , isoDate.cap(3).toInt());
+                if (date.isValid() && fields.size() == frequency_count + 1
+                        && parseFluxes(fields, fluxes))
+                {
+                    addObservation(rDays, date, fluxes);
+                }
+                continue;
+            }
+
+            // A station's fluxes for the current date;
+            if (currentDate.isValid() && fields.size() > frequency_count
+                    && parseFluxes(fields, fluxes))
+            {
+                addObservation(rDays, currentDate, fluxes);
+            }
+        }
+
+        return true;
+    }
+
+    // Returns the median of a list of observations, or NaN if it is empty;
+    float median(std::vector<float>& rValues)
+    {
+        if (rValues.empty())
+        {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        const size_t middle = rValues.size() / 2;
+        std::nth_element(rValues.begin(), rValues.begin() + middle
+                         , rValues.end());
+        float value = rValues[middle];
+
+        if (rValues.size() % 2 == 0)
+        {
+            const float below = *std::max_element(rValues.begin()
+                                                  , rValues.begin() + middle);
+            value = 0.5f * (value + below);
+        }
+
+        return value;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         SolarFluxDatabase
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SolarFluxDatabase::SolarFluxDatabase()
+    : mpData(0)
+    , mpRecords(0)
+    , mFirstJulianDay(0)
+    , mDayCount(0)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         ~SolarFluxDatabase
+
+Purpose      Destructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SolarFluxDatabase::~SolarFluxDatabase()
+{
+    close();
+}
+
+/*----------------------------------------------------------------------------
+Name         open
+
+Purpose      Opens a database file and maps it into memory;
+
+Input        rFileName          The database file;
+
+Returns      true  -  If the file was opened and holds a database;
+             false -  If not, in which case getLastError() explains why;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Bound the day count before sizing the records;
+----------------------------------------------------------------------------*/
+bool SolarFluxDatabase::open(const QString &rFileName)
+{
+    close();
+
+    mFile.setFileName(rFileName);
+    if (!mFile.open(QIODevice::ReadOnly))
+    {
+        mLastError = "Unable to open " + rFileName + ": " + mFile.errorString();
+        return false;
+    }
+
+    const qint64 size = mFile.size();
+    if (size < static_cast<qint64>(sizeof(FileHeader)))
+    {
+        mLastError = rFileName + " is not a solar flux database";
+        close();
+        return false;
+    }
+
+    uchar* pData = mFile.map(0, size);
+    if (!pData)
+    {
+        mLastError = "Unable to map " + rFileName + ": " + mFile.errorString();
+        close();
+        return false;
+    }
+
+    const FileHeader* pHeader = reinterpret_cast<const FileHeader*>(pData);
+    const qint64 recordSize = frequency_count
+            * static_cast<qint64>(sizeof(float));
+
+    // The day count is bounded by the file size before it is multiplied,
+    // so that a damaged header cannot overflow the size of the records;
+    bool valid = qstrncmp(pHeader->magic, file_magic, sizeof(file_magic)) == 0
+            && pHeader->version == file_version
+            && pHeader->byteOrderMark == byte_order_mark
+            && pHeader->headerSize >= sizeof(FileHeader)
+            && pHeader->frequencyCount == frequency_count
+            && pHeader->dayCount >= 0
+            && pHeader->dayCount <= size / recordSize
+            && pHeader->headerSize + pHeader->dayCount * recordSize <= size;
+
+    for (int i = 0; valid && i < frequency_count; i++)
+    {
+        valid = pHeader->frequencies[i]
+                == static_cast<float>(constants::available_frequencies[i]);
+    }
+
+    if (!valid)
+    {
+        mLastError = rFileName + " is not a solar flux database, or was"
+                                 " written by another version or machine";
+        mFile.unmap(pData);
+        close();
+        return false;
+    }
+
+    mpData = pData;
+    mpRecords = reinterpret_cast<const float*>(pData + pHeader->headerSize);
+    mFirstJulianDay = pHeader->firstJulianDay;
+    mDayCount = pHeader->dayCount;
+    mLastError.clear();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         close
+
+Purpose      Unmaps and closes the database file;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SolarFluxDatabase::close()
+{
+    if (mpData)
+    {
+        mFile.unmap(mpData);
+    }
+
+    mFile.close();
+    mpData = 0;
+    mpRecords = 0;
+    mFirstJulianDay = 0;
+    mDayCount = 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         isOpen
+
+Purpose      Returns whether or not a database is open;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SolarFluxDatabase::isOpen() const
+{
+    return mpRecords != 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         getFirstDate
+
+Purpose      Returns the first day held by the database, or an invalid date
+             if none is open;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QDate SolarFluxDatabase::getFirstDate() const
+{
+    return (mDayCount > 0) ? QDate::fromJulianDay(mFirstJulianDay) : QDate();
+}
+
+/*----------------------------------------------------------------------------
+Name         getLastDate
+
+Purpose      Returns the last day held by the database, or an invalid date
+             if none is open;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QDate SolarFluxDatabase::getLastDate() const
+{
+    return (mDayCount > 0)
+            ? QDate::fromJulianDay(mFirstJulianDay + mDayCount - 1) : QDate();
+}
+
+/*----------------------------------------------------------------------------
+Name         getFlux
+
+Purpose      Looks up the flux at one of the available frequencies on a day;
+
+Input        rDate              The day;
+             rFreqMHz           One of constants::available_frequencies;
+
+Output       rFlux              The flux, in solar flux units;
+
+Returns      true  -  If the flux was observed on that day;
+             false -  If not, or if rFreqMHz is not an available frequency;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SolarFluxDatabase::getFlux(const QDate &rDate
+                                , const double &rFreqMHz
+                                , double &rFlux) const
+{
+    const int column = frequencyIndex(rFreqMHz);
+    const float* pRecord = record(rDate);
+
+    if (column < 0 || !pRecord || pRecord[column] != pRecord[column])
+    {
+        return false;
+    }
+
+    rFlux = pRecord[column];
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         getBracketingFlux
+
+Purpose      Looks up the available frequencies either side of an operating
+             frequency, as chosen by GotCalc::findBracketingFrequencies, and
+             the flux at each on a day;
+
+Input        rDate              The day;
+             rFreqMHz           The operating frequency;
+
+Output       rLowerFreq         The lower bracketing frequency;
+             rHigherFreq        The higher bracketing frequency;
+             rLowerFlux         Flux at the lower frequency;
+             rHigherFlux        Flux at the higher frequency;
+
+Returns      true  -  If both fluxes were observed on that day;
+             false -  If not, or if rFreqMHz is out of range, in which case
+                      the outputs are left untouched;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SolarFluxDatabase::getBracketingFlux(const QDate &rDate
+                                          , const double &rFreqMHz
+                                          , double &rLowerFreq
+                                          , double &rHigherFreq
+                                          , double &rLowerFlux
+                                          , double &rHigherFlux) const
+{
+    double lowerFreq = 0;
+    double higherFreq = 0;
+    double lowerFlux = 0;
+    double higherFlux = 0;
+
+    if (!GotCalc::findBracketingFrequencies(rFreqMHz, lowerFreq, higherFreq)
+            || !getFlux(rDate, lowerFreq, lowerFlux)
+            || !getFlux(rDate, higherFreq, higherFlux))
+    {
+        return false;
+    }
+
+    rLowerFreq = lowerFreq;
+    rHigherFreq = higherFreq;
+    rLowerFlux = lowerFlux;
+    rHigherFlux = higherFlux;
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         getSpectrum
+
+Purpose      Fits a spectrum through every flux observed on a day;
+
+Input        rDate              The day;
+
+Output       rSpectrum          The fitted spectrum;
+
+Returns      true  -  If at least two fluxes were observed that day;
+             false -  If not, in which case rSpectrum is left untouched;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SolarFluxDatabase::getSpectrum(const QDate &rDate
+                                    , FluxSpectrum &rSpectrum) const
+{
+    const float* pRecord = record(rDate);
+    if (!pRecord)
+    {
+        return false;
+    }
+
+    // Missing fluxes are NaN, which the fit passes over;
+    double fluxes[frequency_count];
+    std::copy(pRecord, pRecord + frequency_count, fluxes);
+
+    FluxSpectrum spectrum;
+    if (!spectrum.setFluxes(fluxes))
+    {
+        return false;
+    }
+
+    rSpectrum = spectrum;
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         getLastError
+
+Purpose      Returns a description of why open() last failed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString SolarFluxDatabase::getLastError() const
+{
+    return mLastError;
+}
+
+/*----------------------------------------------------------------------------
+Name         import
+
+Purpose      Reads observatory flux files and writes their fluxes into a
+             database file, keeping the days already in the database which
+             the files do not cover;
+
+Input        rTextFiles         Observatory flux files to read;
+             rFileName          The database file, created if need be;
+
+Output       rError             Description of the failure, if any;
+             pDays              If given, the number of days read from the
+                                files;
+
+Returns      true  -  If every file was read and the database written;
+             false -  If not, in which case the database is left as it was;
+
+Notes        The database is written to a temporary file which then replaces
+             the old one, so a database which is open elsewhere is never seen
+             half written.  A fresh mapping must be opened to see the import;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SolarFluxDatabase::import(const QStringList &rTextFiles
+                               , const QString &rFileName
+                               , QString &rError
+                               , int *pDays)
+{
+    std::map<qint64, DayObservations> observed;
+    for (int i = 0; i < rTextFiles.size(); i++)
+    {
+        if (!readFluxFile(rTextFiles.at(i), observed, rError))
+        {
+            return false;
+        }
+    }
+
+    // Start from the days already held, if any;
+    std::map<qint64, std::vector<float> > days;
+    if (QFile::exists(rFileName))
+    {
+        SolarFluxDatabase existing;
+        if (!existing.open(rFileName))
+        {
+            rError = existing.getLastError();
+            return false;
+        }
+
+        for (qint64 day = 0; day < existing.mDayCount; day++)
+        {
+            const float* pRecord = existing.mpRecords + day * frequency_count;
+            days[existing.mFirstJulianDay + day].assign(
+                        pRecord, pRecord + frequency_count);
+        }
+    }
+
+    // Fluxes read from the files replace those already held;
+    std::map<qint64, DayObservations>::iterator it;
+    for (it = observed.begin(); it != observed.end(); ++it)
+    {
+        std::vector<float>& rRecord = days[it->first];
+        rRecord.resize(frequency_count
+                       , std::numeric_limits<float>::quiet_NaN());
+
+        for (int i = 0; i < frequency_count; i++)
+        {
+            if (!it->second[i].empty())
+            {
+                rRecord[i] = median(it->second[i]);
+            }
+        }
+    }
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, file_magic, sizeof(file_magic));
+    header.version = file_version;
+    header.headerSize = sizeof(FileHeader);
+    header.frequencyCount = frequency_count;
+    header.byteOrderMark = byte_order_mark;
+    header.firstJulianDay = days.empty() ? 0 : days.begin()->first;
+    header.dayCount = days.empty()
+            ? 0 : days.rbegin()->first - days.begin()->first + 1;
+    for (int i = 0; i < frequency_count; i++)
+    {
+        header.frequencies[i]
+                = static_cast<float>(constants::available_frequencies[i]);
+    }
+
+    // Lay the records out densely, leaving days with no data as NaN;
+    std::vector<float> records(header.dayCount * frequency_count
+                               , std::numeric_limits<float>::quiet_NaN());
+    std::map<qint64, std::vector<float> >::const_iterator day;
+    for (day = days.begin(); day != days.end(); ++day)
+    {
+        std::copy(day->second.begin(), day->second.end()
+                  , records.begin()
+                    + (day->first - header.firstJulianDay) * frequency_count);
+    }
+
+    QSaveFile file(rFileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        rError = "Unable to create " + rFileName + ": " + file.errorString();
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data())
+               , records.size() * sizeof(float));
+
+    if (!file.commit())
+    {
+        rError = "Unable to write " + rFileName + ": " + file.errorString();
+        return false;
+    }
+
+    if (pDays)
+    {
+        *pDays = static_cast<int>(observed.size());
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         frequencyIndex
+
+Purpose      Returns the column of an available frequency within a record;
+
+Input        rFreqMHz           The frequency;
+
+Returns      int                Index into constants::available_frequencies,
+                                or -1 if rFreqMHz is not one of them;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int SolarFluxDatabase::frequencyIndex(const double &rFreqMHz)
+{
+    for (int i = 0; i < frequency_count; i++)
+    {
+        if (rFreqMHz == constants::available_frequencies[i])
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*----------------------------------------------------------------------------
+Name         record
+
+Purpose      Returns the record of a day;
+
+Input        rDate              The day;
+
+Returns      const float*       The day's fluxes, or 0 if the day is not held;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+const float* SolarFluxDatabase::record(const QDate &rDate) const
+{
+    const qint64 day = rDate.toJulianDay() - mFirstJulianDay;
+
+    if (!mpRecords || !rDate.isValid() || day < 0 || day >= mDayCount)
+    {
+        return 0;
+    }
+
+    return mpRecords + day * frequency_count;
+}
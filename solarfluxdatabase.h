@@ -0,0 +1,77 @@
+/*----------------------------------------------------------------------------
+Name         solarfluxdatabase.h
+
+Purpose      Local database of daily solar flux at the available frequencies,
+             imported from observatory flux files and read through a memory
+             map;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef SOLARFLUXDATABASE_H
+#define SOLARFLUXDATABASE_H
+
+#include <QFile> // HASA QFile which is memory mapped;
+#include <QDate> // USES QDate to look up a day;
+#include <QStringList> // USES QStringList for the files to import;
+#include "fluxspectrum.h" // USES FluxSpectrum to fit a day's fluxes;
+
+class SolarFluxDatabase
+{
+public:
+    SolarFluxDatabase(); // Constructor;
+    ~SolarFluxDatabase(); // Destructor, unmaps the file;
+
+    // Opens and maps a database file;
+    bool open(const QString& rFileName);
+    // Unmaps and closes the database file;
+    void close(void);
+    // Whether or not a database is open;
+    bool isOpen(void) const;
+
+    // Returns the first day held by the database;
+    QDate getFirstDate(void) const;
+    // Returns the last day held by the database;
+    QDate getLastDate(void) const;
+
+    // Looks up the flux at one of the available frequencies on a day;
+    bool getFlux(const QDate& rDate
+                 , const double& rFreqMHz
+                 , double& rFlux) const;
+    // Looks up the fluxes either side of an operating frequency on a day;
+    bool getBracketingFlux(const QDate& rDate
+                           , const double& rFreqMHz
+                           , double& rLowerFreq
+                           , double& rHigherFreq
+                           , double& rLowerFlux
+                           , double& rHigherFlux) const;
+
+    // Fits a spectrum through every flux observed on a day;
+    bool getSpectrum(const QDate& rDate, FluxSpectrum& rSpectrum) const;
+
+    // Returns a description of why open() last failed;
+    QString getLastError(void) const;
+
+    // Imports observatory flux files into a database file;
+    static bool import(const QStringList& rTextFiles
+                       , const QString& rFileName
+                       , QString& rError
+                       , int* pDays = 0);
+
+    // Returns the column of an available frequency, or -1;
+    static int frequencyIndex(const double& rFreqMHz);
+
+private:
+    Q_DISABLE_COPY(SolarFluxDatabase)
+
+    QFile mFile; // The database file;
+    uchar* mpData; // Start of the mapped file;
+    const float* mpRecords; // First day's record, within the mapped file;
+    qint64 mFirstJulianDay; // Julian day of the first record;
+    qint64 mDayCount; // Number of records, one per day;
+    QString mLastError; // Why open() last failed;
+
+    // Returns a day's record, or 0 if the day is not held;
+    const float* record(const QDate& rDate) const;
+};
+
+#endif // SOLARFLUXDATABASE_H
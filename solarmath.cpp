@@ -0,0 +1,566 @@
+/*----------------------------------------------------------------------------
+Name         solarmath.cpp
+
+Purpose      Stateless functions for the position of the sun.  These hold the
+             mathematics behind SolarCalc in a form which keeps no state and
+             needs no Qt, so that it may be called from any number of threads
+             at once;
+
+Notes        Every function here depends only on its arguments and writes only
+             to its outputs, so any number of threads may call them at once
+             without locking;
+
+History		 17 Oct 26  AFB	Created from SolarCalc
+             17 Oct 26  AFB Add the polynomial backend to positions;
+             17 Oct 26  AFB Add positions at UTC instants;
+----------------------------------------------------------------------------*/
+#include "solarmath.h"
+#include "fastmath.h" // USES fastmath kernels for the polynomial backend;
+
+#include <cmath> // USES several cmath functions;
+#include <algorithm> // USES std::min and std::max;
+
+namespace
+{
+    // Returns radians from degrees;
+    inline double toRadians(double degrees)
+    {
+        return (degrees * (M_PI / 180.0));
+    }
+
+    // Trigonometric functions of the LibmMath backend;
+    struct LibmKernels
+    {
+        static double cosDeg(double degrees)
+        {
+            return cos(toRadians(degrees));
+        }
+
+        static double acos(double x)
+        {
+            return ::acos(x);
+        }
+    };
+
+    // Trigonometric functions of the PolynomialMath backend;
+    struct PolynomialKernels
+    {
+        static double cosDeg(double degrees)
+        {
+            return fastmath::cosDeg(degrees);
+        }
+
+        static double acos(double x)
+        {
+            return fastmath::acos(x);
+        }
+    };
+
+    // The body of solarmath::positions, for one backend;
+    template <typename Kernels>
+    void positionsWith(const SolarDayTerms& rTerms
+                       , const bool& rDaylightSavings
+                       , const double* pSecondsOfDay
+                       , size_t count
+                       , double* pAzimuthDeg
+                       , double* pAltitudeDeg
+                       , double* pZenithDeg
+                       , double* pHourAngleDeg);
+}
+
+/*----------------------------------------------------------------------------
+Name         equationOfTime
+
+Purpose      Returns an estimated Equation of Time for a day of the year;
+
+Input        rDayOfYear         Day of year (1-365 (366 for leap year));
+
+Returns      double             Equation of Time, in minutes;
+
+History		 17 Oct 26  AFB	Created as SolarCalc::equationOfTime
+----------------------------------------------------------------------------*/
+double solarmath::equationOfTime(const int& rDayOfYear)
+{
+    double b = (360.0/365.0) * (rDayOfYear - 81.0);
+    b = toRadians(b);
+
+    return (9.87 * sin((2.0 * b)))
+            - (7.53 * cos(b)) - (1.5 * sin(b));
+}
+
+/*----------------------------------------------------------------------------
+Name         solarDeclination
+
+Purpose      Returns the Solar Declination for a day of the year;
+
+Input        rDayOfYear         Day of year (1-365 (366 for leap year));
+
+Returns      double             Solar Declination, in degrees;
+
+Notes        An approximation good to about a degree.  See sunposition.h for
+             a precise alternative;
+
+History		 17 Oct 26  AFB	Created as SolarCalc::solarDeclination
+             17 Oct 26  AFB Evaluate the declination at rDayOfYear, rather
+                            than at the fixed day 181;
+----------------------------------------------------------------------------*/
+double solarmath::solarDeclination(const int& rDayOfYear)
+{
+    return 23.45 * sin(toRadians((360.0/365.0) * (rDayOfYear - 81.0)));
+}
+
+/*----------------------------------------------------------------------------
+Name         dayTerms
+
+Purpose      Calculates the terms of the solar position which depend only upon
+             the site and the date;
+
+Input        rLatitude          The latitude of the unit, in degrees;
+             rLongitude         The longitude of the unit, in degrees;
+             rDayOfYear         Day of year (1-365 (366 for leap year));
+
+Returns      SolarDayTerms      The terms, ready to be passed to positions;
+
+History		 17 Oct 26  AFB	Created as SolarCalc::calculateDayTerms
+----------------------------------------------------------------------------*/
+SolarDayTerms solarmath::dayTerms(const double &rLatitude
+                                 , const double &rLongitude
+                                 , const int &rDayOfYear)
+{
+    SolarDayTerms terms;
+
+    terms.dayOfYear = rDayOfYear;
+    terms.equationOfTime = equationOfTime(rDayOfYear);
+    terms.declinationDeg = solarDeclination(rDayOfYear);
+
+    // See SolarCalc::calculateTst for the origin of each of these terms;
+    terms.solarTimeOffset = terms.equationOfTime
+            + 4.0 * rLongitude
+            - 60.0 * (rLongitude / 15.0);
+
+    const double latitudeRad = toRadians(rLatitude);
+    const double declinationRad = toRadians(terms.declinationDeg);
+
+    terms.sinLatitude = sin(latitudeRad);
+    terms.cosLatitude = cos(latitudeRad);
+    terms.sinDeclination = sin(declinationRad);
+    terms.cosDeclination = cos(declinationRad);
+
+    return terms;
+}
+
+/*----------------------------------------------------------------------------
+Name         positions
+
+Purpose      Calculates the azimuth, altitude, zenith, and hour angle of the sun
+             for an array of times, given the terms which are constant for the
+             site and date;
+
+Input        rTerms             Terms returned by dayTerms;
+             rDaylightSavings   Whether or not the times are daylight savings
+                                time;
+             pSecondsOfDay      Array of local times, in seconds since local
+                                midnight;
+             count              Number of entries in pSecondsOfDay and in each
+                                of the output arrays;
+             rBackend           Trigonometric functions to use;
+
+Output       pAzimuthDeg        Solar Azimuth in degrees;
+             pAltitudeDeg       Solar Altitude in degrees;
+             pZenithDeg         Solar Zenith in degrees;
+             pHourAngleDeg      Hour Angle in degrees;
+
+Notes        This is the same calculation performed by SolarCalc::calculate(),
+             arranged so that it may be run over a whole tracking table at
+             once.  Everything which depends only upon the site and the date
+             is in rTerms, worked out once by dayTerms.  What remains in the
+             loop depends only on the time of the entry, contains no branches,
+             and writes to separate output arrays, which allows the compiler to
+             process several entries per instruction (AVX2, NEON);
+
+             Unlike SolarCalc::calculate(), seconds are not discarded.  For
+             times falling on a whole minute the two give the same answer;
+
+             Any of the output pointers may be null if that column is not
+             wanted, but every non-null array must hold count entries;
+
+             With PolynomialMath the cosine and arc cosines come from
+             fastmath.h rather than libm.  Their error, below 2e-11 rad, is
+             far smaller than that of the model itself, and the loops which
+             use them can then be vectorised;
+
+History		 17 Oct 26  AFB	Created as SolarCalc::calculateBatch
+             17 Oct 26  AFB Add rBackend;
+----------------------------------------------------------------------------*/
+void solarmath::positions(const SolarDayTerms& rTerms
+                          , const bool& rDaylightSavings
+                          , const double* pSecondsOfDay
+                          , size_t count
+                          , double* pAzimuthDeg
+                          , double* pAltitudeDeg
+                          , double* pZenithDeg
+                          , double* pHourAngleDeg
+                          , const SolarMathBackend& rBackend)
+{
+    if (rBackend == PolynomialMath)
+    {
+        positionsWith<PolynomialKernels>(rTerms, rDaylightSavings
+                                         , pSecondsOfDay, count
+                                         , pAzimuthDeg, pAltitudeDeg
+                                         , pZenithDeg, pHourAngleDeg);
+    }
+    else
+    {
+        positionsWith<LibmKernels>(rTerms, rDaylightSavings
+                                   , pSecondsOfDay, count
+                                   , pAzimuthDeg, pAltitudeDeg
+                                   , pZenithDeg, pHourAngleDeg);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         positionsWith
+
+Purpose      Calculates the azimuth, altitude, zenith, and hour angle of the sun
+             for an array of times, using the trigonometric functions of one
+             backend;
+
+Notes        See solarmath::positions;
+
+History		 17 Oct 26  AFB	Created from solarmath::positions
+----------------------------------------------------------------------------*/
+namespace
+{
+template <typename Kernels>
+void positionsWith(const SolarDayTerms& rTerms
+                   , const bool& rDaylightSavings
+                   , const double* pSecondsOfDay
+                   , size_t count
+                   , double* pAzimuthDeg
+                   , double* pAltitudeDeg
+                   , double* pZenithDeg
+                   , double* pHourAngleDeg)
+{
+    const double sinLat = rTerms.sinLatitude;
+    const double cosLat = rTerms.cosLatitude;
+    const double sinDec = rTerms.sinDeclination;
+    const double cosDec = rTerms.cosDeclination;
+
+    const double tstOffset = rTerms.solarTimeOffset
+            - (rDaylightSavings ? 60.0 : 0.0);
+
+    const double radToDeg = 180.0 / M_PI;
+
+    // Process the table in blocks so that the intermediate columns stay in
+    // the cache between passes;
+    const size_t blockSize = 256;
+    double hourAngle[blockSize];
+    double cosZenith[blockSize];
+    double zenith[blockSize];
+    double azimuth[blockSize];
+
+    for (size_t start = 0; start < count; start += blockSize)
+    {
+        const size_t n = std::min(blockSize, count - start);
+        const double* __restrict pTime = pSecondsOfDay + start;
+
+        // True Solar Time and Hour Angle;
+        for (size_t i = 0; i < n; i++)
+        {
+            double tst = pTime[i] / 60.0 + tstOffset;
+            tst = tst - (1440.0 * floor(tst / 1440.0));
+            hourAngle[i] = tst / 4.0 - 180.0;
+        }
+
+        // Zenith.  The cosine is clamped, as rounding can otherwise push it
+        // just outside of the domain of acos;
+        for (size_t i = 0; i < n; i++)
+        {
+            double c = sinLat * sinDec
+                    + cosLat * cosDec * Kernels::cosDeg(hourAngle[i]);
+            c = std::max(-1.0, std::min(1.0, c));
+            cosZenith[i] = c;
+            zenith[i] = Kernels::acos(c);
+        }
+
+        // Azimuth, selecting the morning or afternoon form of the equation
+        // without branching;
+        for (size_t i = 0; i < n; i++)
+        {
+            double sinZenith = sqrt(1.0 - cosZenith[i] * cosZenith[i]);
+            double a = (sinLat * cosZenith[i] - sinDec) / (cosLat * sinZenith);
+            a = std::max(-1.0, std::min(1.0, a));
+            a = Kernels::acos(a) * radToDeg;
+
+            // az is within [180, 540], so one subtraction wraps it;
+            double az = (hourAngle[i] > 0) ? (a + 180.0) : (540.0 - a);
+            azimuth[i] = (az >= 360.0) ? (az - 360.0) : az;
+        }
+
+        // Write out the requested columns;
+        for (size_t i = 0; i < n; i++)
+        {
+            if (pAzimuthDeg) pAzimuthDeg[start + i] = azimuth[i];
+            if (pZenithDeg) pZenithDeg[start + i] = zenith[i] * radToDeg;
+            if (pAltitudeDeg) pAltitudeDeg[start + i] =
+                    90.0 - zenith[i] * radToDeg;
+            if (pHourAngleDeg) pHourAngleDeg[start + i] = hourAngle[i];
+        }
+    }
+}
+}
+
+/*----------------------------------------------------------------------------
+Name         position
+
+Purpose      Calculates the position of the sun for a single local time;
+
+Input        rTerms             Terms returned by dayTerms;
+             rDaylightSavings   Whether or not the time is daylight savings
+                                time;
+             rSecondsOfDay      Local time, in seconds since local midnight;
+
+Returns      SunPosition        The position of the sun;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SunPosition solarmath::position(const SolarDayTerms &rTerms
+                                , const bool &rDaylightSavings
+                                , const double &rSecondsOfDay)
+{
+    SunPosition sun;
+    positions(rTerms
+              , rDaylightSavings
+              , &rSecondsOfDay
+              , 1
+              , &sun.azimuthDeg
+              , &sun.altitudeDeg
+              , &sun.zenithDeg
+              , &sun.hourAngleDeg);
+    return sun;
+}
+
+/*----------------------------------------------------------------------------
+Name         epochDay
+
+Purpose      Returns the number of days from 1 Jan 1970 to a Gregorian date,
+             without constructing a QDate;
+
+Input        rYear              The year;
+             rMonth             The month, 1-12;
+             rDay               The day of the month, 1-31;
+
+Returns      long long          Days since 1 Jan 1970, negative before it;
+
+Notes        Counts in 400 year eras starting on 1 March, so that the leap day
+             falls at the end of each year (H. Hinnant, chrono-compatible
+             low-level date algorithms);
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+long long solarmath::epochDay(const int &rYear
+                              , const int &rMonth
+                              , const int &rDay)
+{
+    const long long year = rYear - (rMonth <= 2 ? 1 : 0);
+    const long long era = (year >= 0 ? year : year - 399) / 400;
+    const long long yearOfEra = year - era * 400;
+    const long long dayOfYear = (153 * (rMonth + (rMonth > 2 ? -3 : 9)) + 2)
+            / 5 + rDay - 1;
+    const long long dayOfEra = yearOfEra * 365 + yearOfEra / 4
+            - yearOfEra / 100 + dayOfYear;
+
+    return era * 146097 + dayOfEra - 719468;
+}
+
+/*----------------------------------------------------------------------------
+Name         dayOfYear
+
+Purpose      Returns the day of the year of a day counted from 1 Jan 1970;
+
+Input        rEpochDay          Days since 1 Jan 1970;
+
+Returns      int                Day of year (1-365 (366 for leap year));
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int solarmath::dayOfYear(const long long &rEpochDay)
+{
+    // Find the year as epochDay's inverse would, then count from 1 Jan;
+    const long long z = rEpochDay + 719468;
+    const long long era = (z >= 0 ? z : z - 146096) / 146097;
+    const long long dayOfEra = z - era * 146097;
+    const long long yearOfEra = (dayOfEra - dayOfEra / 1460
+                                 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const long long marchDay = dayOfEra
+            - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const long long month = (5 * marchDay + 2) / 153;
+    const long long year = yearOfEra + era * 400 + (month >= 10 ? 1 : 0);
+
+    return static_cast<int>(rEpochDay - epochDay(static_cast<int>(year), 1, 1)
+                            + 1);
+}
+
+/*----------------------------------------------------------------------------
+Name         secondsFromNanoseconds
+
+Purpose      Returns seconds from nanoseconds since 1 Jan 1970;
+
+Input        rNanoseconds       Nanoseconds since 1 Jan 1970;
+
+Returns      double             Seconds since 1 Jan 1970;
+
+Notes        The whole seconds and the fraction are converted separately, so
+             the result keeps the precision of a double (under a microsecond
+             this century) rather than losing the fraction;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double solarmath::secondsFromNanoseconds(const long long &rNanoseconds)
+{
+    const long long seconds = rNanoseconds / 1000000000LL;
+    const long long remainder = rNanoseconds - seconds * 1000000000LL;
+
+    return static_cast<double>(seconds) + remainder * 1e-9;
+}
+
+/*----------------------------------------------------------------------------
+Name         utcDayTerms
+
+Purpose      Calculates the terms of the solar position which depend only upon
+             the site and a UTC day;
+
+Input        rLatitude          The latitude of the unit, in degrees;
+             rLongitude         The longitude of the unit, in degrees, east
+                                positive;
+             rEpochDay          The day, counted from 1 Jan 1970;
+
+Returns      SolarDayTerms      The terms, for positions given the seconds
+                                since midnight UTC without daylight savings;
+
+Notes        In UTC the True Solar Time is simply UTC + Equation of Time + 4
+             minutes per degree of longitude, so no time zone is assumed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SolarDayTerms solarmath::utcDayTerms(const double &rLatitude
+                                     , const double &rLongitude
+                                     , const long long &rEpochDay)
+{
+    SolarDayTerms terms = dayTerms(rLatitude, rLongitude
+                                   , dayOfYear(rEpochDay));
+    terms.solarTimeOffset = terms.equationOfTime + 4.0 * rLongitude;
+
+    return terms;
+}
+
+/*----------------------------------------------------------------------------
+Name         positionsUtc
+
+Purpose      Calculates the azimuth, altitude, zenith, and hour angle of the sun
+             for an array of UTC instants at a single site;
+
+Input        rLatitude          The latitude of the unit, in degrees;
+             rLongitude         The longitude of the unit, in degrees, east
+                                positive;
+             pUtcSeconds        Array of instants, in seconds since
+                                1 Jan 1970 UTC, with any fraction;
+             count              Number of entries in pUtcSeconds and in each
+                                of the output arrays;
+             rBackend           Trigonometric functions to use;
+
+Output       pAzimuthDeg        Solar Azimuth in degrees;
+             pAltitudeDeg       Solar Altitude in degrees;
+             pZenithDeg         Solar Zenith in degrees;
+             pHourAngleDeg      Hour Angle in degrees;
+
+Notes        The instants are split into runs falling on the same UTC day,
+             and each run is passed to positions with that day's terms, which
+             are only worked out again when the day changes.  Nothing is
+             allocated, so this may be called at a high rate;
+
+             Any of the output pointers may be null, as for positions;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void solarmath::positionsUtc(const double &rLatitude
+                             , const double &rLongitude
+                             , const double *pUtcSeconds
+                             , size_t count
+                             , double *pAzimuthDeg
+                             , double *pAltitudeDeg
+                             , double *pZenithDeg
+                             , double *pHourAngleDeg
+                             , const SolarMathBackend &rBackend)
+{
+    const size_t blockSize = 256;
+    double secondsOfDay[blockSize];
+
+    SolarDayTerms terms;
+    long long termsDay = 0;
+    bool haveTerms = false;
+
+    size_t i = 0;
+    while (i < count)
+    {
+        const long long day = static_cast<long long>(
+                    floor(pUtcSeconds[i] / seconds_per_day));
+        if (!haveTerms || day != termsDay)
+        {
+            terms = utcDayTerms(rLatitude, rLongitude, day);
+            termsDay = day;
+            haveTerms = true;
+        }
+
+        // Gather the run of instants on this day, up to a block.  The first
+        // is always taken, in case rounding put it just outside of the day;
+        const double dayStart = day * seconds_per_day;
+        size_t n = 0;
+        while (i + n < count && n < blockSize)
+        {
+            const double seconds = pUtcSeconds[i + n] - dayStart;
+            if (n > 0 && (seconds < 0 || seconds >= seconds_per_day))
+            {
+                break;
+            }
+            secondsOfDay[n++] = seconds;
+        }
+
+        positions(terms, false, secondsOfDay, n
+                  , pAzimuthDeg ? pAzimuthDeg + i : 0
+                  , pAltitudeDeg ? pAltitudeDeg + i : 0
+                  , pZenithDeg ? pZenithDeg + i : 0
+                  , pHourAngleDeg ? pHourAngleDeg + i : 0
+                  , rBackend);
+        i += n;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         positionUtc
+
+Purpose      Calculates the position of the sun for a single UTC instant;
+
+Input        rLatitude          The latitude of the unit, in degrees;
+             rLongitude         The longitude of the unit, in degrees;
+             rUtcSeconds        The instant, in seconds since 1 Jan 1970 UTC;
+
+Returns      SunPosition        The position of the sun;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SunPosition solarmath::positionUtc(const double &rLatitude
+                                   , const double &rLongitude
+                                   , const double &rUtcSeconds)
+{
+    SunPosition sun;
+    positionsUtc(rLatitude
+                 , rLongitude
+                 , &rUtcSeconds
+                 , 1
+                 , &sun.azimuthDeg
+                 , &sun.altitudeDeg
+                 , &sun.zenithDeg
+                 , &sun.hourAngleDeg);
+    return sun;
+}
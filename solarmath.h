@@ -0,0 +1,109 @@
+/*----------------------------------------------------------------------------
+Name         solarmath.h
+
+Purpose      Stateless functions for the position of the sun.  These hold the
+             mathematics behind SolarCalc in a form which keeps no state and
+             needs no Qt, so that it may be called from any number of threads
+             at once;
+
+History		 17 Oct 26  AFB	Created from SolarCalc
+             17 Oct 26  AFB Add a choice of trigonometric backend;
+             17 Oct 26  AFB Add positions at UTC instants;
+----------------------------------------------------------------------------*/
+#ifndef SOLARMATH_H
+#define SOLARMATH_H
+
+#include <cstddef> // USES size_t;
+
+// Terms of the solar position which depend only upon the site and the date;
+struct SolarDayTerms
+{
+    int dayOfYear; // Day of year the terms were calculated for;
+    double equationOfTime; // Equation of Time, in minutes;
+    double declinationDeg; // Solar Declination in degrees;
+    // Offset, in minutes, from local standard time to True Solar Time;
+    double solarTimeOffset;
+    double sinLatitude; // Sine of the latitude;
+    double cosLatitude; // Cosine of the latitude;
+    double sinDeclination; // Sine of the declination;
+    double cosDeclination; // Cosine of the declination;
+};
+
+// Implementation of the trigonometric functions used by positions;
+enum SolarMathBackend
+{
+    LibmMath, // The C library, correctly rounded or nearly so;
+    PolynomialMath // fastmath.h kernels, vectorisable, error below 2e-11;
+};
+
+// Position of the sun at one instant;
+struct SunPosition
+{
+    double azimuthDeg; // Solar Azimuth in degrees;
+    double altitudeDeg; // Solar Altitude in degrees;
+    double zenithDeg; // Solar Zenith in degrees;
+    double hourAngleDeg; // Hour Angle in degrees;
+};
+
+namespace solarmath
+{
+    // Seconds in a day;
+    const double seconds_per_day = 86400.0;
+
+    // Returns the Equation of Time, in minutes, for a day of the year;
+    double equationOfTime(const int& rDayOfYear);
+
+    // Returns the Solar Declination, in degrees, for a day of the year;
+    double solarDeclination(const int& rDayOfYear);
+
+    // Calculates the terms which are constant for a site and date;
+    SolarDayTerms dayTerms(const double& rLatitude
+                           , const double& rLongitude
+                           , const int& rDayOfYear);
+
+    // Calculates the position of the sun for an array of local times;
+    void positions(const SolarDayTerms& rTerms
+                   , const bool& rDaylightSavings
+                   , const double* pSecondsOfDay
+                   , size_t count
+                   , double* pAzimuthDeg
+                   , double* pAltitudeDeg
+                   , double* pZenithDeg
+                   , double* pHourAngleDeg
+                   , const SolarMathBackend& rBackend = LibmMath);
+
+    // Calculates the position of the sun for a single local time;
+    SunPosition position(const SolarDayTerms& rTerms
+                         , const bool& rDaylightSavings
+                         , const double& rSecondsOfDay);
+
+    // Returns the days from 1 Jan 1970 to a Gregorian date;
+    long long epochDay(const int& rYear, const int& rMonth, const int& rDay);
+    // Returns the day of the year (1-366) of a day counted from 1 Jan 1970;
+    int dayOfYear(const long long& rEpochDay);
+    // Returns seconds from nanoseconds, both counted from 1 Jan 1970;
+    double secondsFromNanoseconds(const long long& rNanoseconds);
+
+    // Calculates the terms which are constant for a site and a UTC day;
+    SolarDayTerms utcDayTerms(const double& rLatitude
+                              , const double& rLongitude
+                              , const long long& rEpochDay);
+
+    // Calculates the position of the sun for an array of UTC instants;
+    void positionsUtc(const double& rLatitude
+                      , const double& rLongitude
+                      , const double* pUtcSeconds
+                      , size_t count
+                      , double* pAzimuthDeg
+                      , double* pAltitudeDeg
+                      , double* pZenithDeg
+                      , double* pHourAngleDeg
+                      , const SolarMathBackend& rBackend = LibmMath);
+
+    // Calculates the position of the sun for a single UTC instant;
+    SunPosition positionUtc(const double& rLatitude
+                            , const double& rLongitude
+                            , const double& rUtcSeconds);
+}
+
+#endif // SOLARMATH_H
@@ -0,0 +1,193 @@
+/*----------------------------------------------------------------------------
+Name         solarscheduler.cpp
+
+Purpose      Plans sun calibration windows for a network of antennas over a
+             run of days, spreading the work over a WorkStealingPool;
+
+Notes        Each site and day is an independent job: the windows of a day
+             only depend on the site and the date, and are found with the
+             stateless solarmath functions, so the jobs share nothing but
+             their inputs.  Every job writes into its own slot of a table laid
+             out in advance, so no locking is needed and the throughput grows
+             with the number of workers.  Once every day has been found, each
+             site's windows are ranked, again one job per site;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "solarscheduler.h"
+
+#include <algorithm> // USES std::sort to rank the windows;
+
+namespace
+{
+    // Orders windows best first, then by time;
+    bool betterWindow(const CalibrationWindow& rA, const CalibrationWindow& rB)
+    {
+        if (rA.score != rB.score)
+        {
+            return rA.score > rB.score;
+        }
+
+        if (rA.date != rB.date)
+        {
+            return rA.date < rB.date;
+        }
+
+        return rA.startSeconds < rB.startSeconds;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         SolarScheduler
+
+Purpose      Constructor;
+
+Input        pPool              Pool on which the jobs are run;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SolarScheduler::SolarScheduler(WorkStealingPool *pPool)
+    : mPool(pPool)
+    , mMinimumDuration(0)
+    , mGrain(16)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         setMinimumDuration
+
+Purpose      Sets the shortest window worth scheduling.  Shorter windows are
+             left out of the schedule;
+
+Input        rSeconds           The shortest duration, in seconds;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SolarScheduler::setMinimumDuration(const double &rSeconds)
+{
+    mMinimumDuration = rSeconds;
+}
+
+/*----------------------------------------------------------------------------
+Name         setGrain
+
+Purpose      Sets how many site-days are handed to a worker at a time.  Larger
+             grains lower the overhead of the pool, smaller ones balance the
+             load more evenly;
+
+Input        rGrain             Site-days per job;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SolarScheduler::setGrain(const int &rGrain)
+{
+    mGrain = qMax(1, rGrain);
+}
+
+/*----------------------------------------------------------------------------
+Name         schedule
+
+Purpose      Plans the calibration windows of every site over a run of days;
+
+Input        rSites             The antennas;
+             rStart             The first day;
+             rDays              Number of days;
+
+Returns      QVector            One AntennaSchedule per site, in the same
+                                order as rSites, each with its windows ranked
+                                best first;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QVector<AntennaSchedule> SolarScheduler::schedule(
+        const QVector<AntennaSite> &rSites
+        , const QDate &rStart
+        , const int &rDays) const
+{
+    const int siteCount = rSites.size();
+    const int days = qMax(0, rDays);
+
+    // One slot per site and day, filled in by the jobs;
+    std::vector<QVector<SunWindow> > found(siteCount * days);
+
+    mPool->parallelFor(0, siteCount * days, mGrain
+                       , [&](int begin, int end)
+    {
+        for (int job = begin; job < end; job++)
+        {
+            const AntennaSite& rSite = rSites.at(job / days);
+            const SunTransitFinder finder(rSite.latitude
+                                          , rSite.longitude
+                                          , rSite.daylightSavings);
+
+            found[job] = finder.findWindows(rStart.addDays(job % days)
+                                            , rSite.minElevationDeg);
+        }
+    });
+
+    // Gather and rank each site's windows;
+    QVector<AntennaSchedule> schedules(siteCount);
+    const double minimumDuration = mMinimumDuration;
+
+    mPool->parallelFor(0, siteCount, 1, [&](int begin, int end)
+    {
+        for (int site = begin; site < end; site++)
+        {
+            AntennaSchedule& rSchedule = schedules[site];
+            rSchedule.site = rSites.at(site);
+
+            for (int day = 0; day < days; day++)
+            {
+                const QVector<SunWindow>& rDay = found[site * days + day];
+                for (int i = 0; i < rDay.size(); i++)
+                {
+                    const SunWindow& rWindow = rDay.at(i);
+                    if (rWindow.endSeconds - rWindow.startSeconds
+                            < minimumDuration)
+                    {
+                        continue;
+                    }
+
+                    CalibrationWindow window;
+                    window.date = rWindow.date;
+                    window.startSeconds = rWindow.startSeconds;
+                    window.endSeconds = rWindow.endSeconds;
+                    window.peakAltitudeDeg = rWindow.peakAltitudeDeg;
+                    window.score = score(rWindow);
+                    rSchedule.windows.append(window);
+                }
+            }
+
+            std::sort(rSchedule.windows.begin()
+                      , rSchedule.windows.end()
+                      , betterWindow);
+        }
+    });
+
+    return schedules;
+}
+
+/*----------------------------------------------------------------------------
+Name         score
+
+Purpose      Scores a window for ranking;
+
+Input        rWindow            The window;
+
+Returns      double             The score, higher is better;
+
+Notes        A sun-noise measurement wants the sun as high as possible, where
+             the path through the atmosphere and the pick-up from the ground
+             are smallest, and long enough to take the hot and cold readings.
+             The score is the sine of the peak altitude (the inverse of the
+             air mass) times the length of the window in hours, with no credit
+             given beyond two hours;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double SolarScheduler::score(const SunWindow &rWindow)
+{
+    const double hours = (rWindow.endSeconds - rWindow.startSeconds) / 3600.0;
+
+    return sin(rWindow.peakAltitudeDeg * M_PI / 180.0) * qMin(hours, 2.0);
+}
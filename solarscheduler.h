@@ -0,0 +1,69 @@
+/*----------------------------------------------------------------------------
+Name         solarscheduler.h
+
+Purpose      Plans sun calibration windows for a network of antennas over a
+             run of days, spreading the work over a WorkStealingPool;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef SOLARSCHEDULER_H
+#define SOLARSCHEDULER_H
+
+#include <QString> // USES QString for antenna names;
+#include <QVector> // USES QVector for lists of sites and windows;
+#include <QDate> // USES QDate for the days planned;
+#include "suntransit.h" // USES SunTransitFinder to find the windows;
+#include "workstealingpool.h" // USES WorkStealingPool to run the jobs;
+
+// An antenna to be scheduled;
+struct AntennaSite
+{
+    QString name; // Name of the antenna;
+    double latitude; // Latitude, in degrees;
+    double longitude; // Longitude, in degrees;
+    double minElevationDeg; // Lowest elevation usable for calibration;
+    bool daylightSavings; // Whether or not times are daylight savings;
+};
+
+// A window during which an antenna may calibrate on the sun;
+struct CalibrationWindow
+{
+    QDate date; // The day of the window;
+    double startSeconds; // Start, in local seconds since midnight;
+    double endSeconds; // End, in local seconds since midnight;
+    double peakAltitudeDeg; // Highest altitude of the sun in the window;
+    double score; // Ranking score, higher is better;
+};
+
+// The ranked calibration windows of one antenna;
+struct AntennaSchedule
+{
+    AntennaSite site; // The antenna;
+    QVector<CalibrationWindow> windows; // Windows, best first;
+};
+
+class SolarScheduler
+{
+public:
+    explicit SolarScheduler(WorkStealingPool* pPool); // Constructor;
+
+    // Sets the shortest window worth scheduling, in seconds;
+    void setMinimumDuration(const double& rSeconds);
+    // Sets how many site-days are handed to a worker at a time;
+    void setGrain(const int& rGrain);
+
+    // Plans the calibration windows of every site over a run of days;
+    QVector<AntennaSchedule> schedule(const QVector<AntennaSite>& rSites
+                                      , const QDate& rStart
+                                      , const int& rDays) const;
+
+    // Scores a window for ranking;
+    static double score(const SunWindow& rWindow);
+
+private:
+    WorkStealingPool* mPool; // Pool the jobs are run on;
+    double mMinimumDuration; // Shortest window worth scheduling;
+    int mGrain; // Site-days per job;
+};
+
+#endif // SOLARSCHEDULER_H
@@ -0,0 +1,171 @@
+/*----------------------------------------------------------------------------
+Name         spscringbuffer.h
+
+Purpose      Fixed capacity, lock-free queue for passing items from exactly
+             one producer thread to exactly one consumer thread;
+
+Notes        The capacity is rounded up to a power of two so that the slot of
+             an index is found with a mask.  The head and tail indices only
+             ever increase and are kept on separate cache lines so that the
+             producer and consumer do not contend for the same line;
+
+             Only push() and isFull() may be called from the producer, and
+             only pop() and isEmpty() from the consumer;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <atomic> // USES std::atomic for the head and tail indices;
+#include <vector> // HASA std::vector of slots;
+#include <cstddef>
+
+template <typename T>
+class SpscRingBuffer
+{
+public:
+    explicit SpscRingBuffer(size_t capacity); // Constructor;
+
+    // Adds an item to the queue, returning false if the queue is full;
+    bool push(const T& rItem);
+    // Removes the oldest item from the queue, returning false if empty;
+    bool pop(T& rItem);
+
+    bool isEmpty(void) const; // Whether or not there is anything to pop;
+    bool isFull(void) const; // Whether or not there is room to push;
+    size_t capacity(void) const; // Number of items the queue can hold;
+
+private:
+    std::vector<T> mSlots; // Storage for the queued items;
+    size_t mMask; // Capacity - 1, used to wrap an index onto a slot;
+
+    // Index of the next slot to be written, owned by the producer;
+    alignas(64) std::atomic<size_t> mHead;
+    // Index of the next slot to be read, owned by the consumer;
+    alignas(64) std::atomic<size_t> mTail;
+};
+
+/*----------------------------------------------------------------------------
+Name         SpscRingBuffer
+
+Purpose      Constructor;
+
+Input        capacity           Minimum number of items the queue must hold;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+template <typename T>
+SpscRingBuffer<T>::SpscRingBuffer(size_t capacity)
+    : mHead(0)
+    , mTail(0)
+{
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    mSlots.resize(size);
+    mMask = size - 1;
+}
+
+/*----------------------------------------------------------------------------
+Name         push
+
+Purpose      Adds an item to the back of the queue;
+
+Input        rItem              The item to be added;
+
+Returns      true  -  If the item was added;
+             false -  If the queue is full;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+template <typename T>
+bool SpscRingBuffer<T>::push(const T &rItem)
+{
+    const size_t head = mHead.load(std::memory_order_relaxed);
+    if (head - mTail.load(std::memory_order_acquire) > mMask)
+    {
+        return false;
+    }
+
+    mSlots[head & mMask] = rItem;
+    mHead.store(head + 1);
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         pop
+
+Purpose      Removes the item at the front of the queue;
+
+Output       rItem              The item which was removed;
+
+Returns      true  -  If an item was removed;
+             false -  If the queue is empty;
+
+Notes        The slot is reset to a default constructed T so that it does not
+             hold on to any memory owned by the item;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+template <typename T>
+bool SpscRingBuffer<T>::pop(T &rItem)
+{
+    const size_t tail = mTail.load(std::memory_order_relaxed);
+    if (tail == mHead.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    T& rSlot = mSlots[tail & mMask];
+    rItem = rSlot;
+    rSlot = T();
+    mTail.store(tail + 1);
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         isEmpty
+
+Purpose      Returns whether or not the queue is empty;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+template <typename T>
+bool SpscRingBuffer<T>::isEmpty() const
+{
+    return mTail.load() == mHead.load();
+}
+
+/*----------------------------------------------------------------------------
+Name         isFull
+
+Purpose      Returns whether or not the queue is full;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+template <typename T>
+bool SpscRingBuffer<T>::isFull() const
+{
+    return (mHead.load() - mTail.load()) > mMask;
+}
+
+/*----------------------------------------------------------------------------
+Name         capacity
+
+Purpose      Returns the number of items the queue can hold;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+template <typename T>
+size_t SpscRingBuffer<T>::capacity() const
+{
+    return mSlots.size();
+}
+
+#endif // SPSCRINGBUFFER_H
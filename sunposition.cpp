@@ -0,0 +1,188 @@
+/*----------------------------------------------------------------------------
+Name         sunposition.cpp
+
+Purpose      Day terms of the sun position precision tiers, and the calendar
+             functions they share;
+
+Notes        Only the work done once per site and date lives here.  The
+             kernels run for every position are inline in sunposition.h;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "sunposition.h"
+
+/*----------------------------------------------------------------------------
+Name         dayOfYear
+
+Purpose      Returns the day of the year of a Gregorian date;
+
+Input        rYear              Year;
+             rMonth             Month (1-12);
+             rDay               Day of the month;
+
+Returns      int                Day of year (1-365 (366 for leap year));
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int sunposition::dayOfYear(const int &rYear, const int &rMonth, const int &rDay)
+{
+    static const int days_before[] = {0, 31, 59, 90, 120, 151
+                                      , 181, 212, 243, 273, 304, 334};
+
+    const bool leap = (rYear % 4 == 0 && rYear % 100 != 0)
+            || (rYear % 400 == 0);
+
+    return days_before[rMonth - 1] + rDay + ((leap && rMonth > 2) ? 1 : 0);
+}
+
+/*----------------------------------------------------------------------------
+Name         julianDay
+
+Purpose      Returns the Julian Day at 0h UT of a Gregorian date;
+
+Input        rYear              Year;
+             rMonth             Month (1-12);
+             rDay               Day of the month;
+
+Returns      double             Julian Day;
+
+Notes        Meeus, Astronomical Algorithms, eq. 7.1;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double sunposition::julianDay(const int &rYear
+                              , const int &rMonth
+                              , const int &rDay)
+{
+    int year = rYear;
+    int month = rMonth;
+    if (month <= 2)
+    {
+        year -= 1;
+        month += 12;
+    }
+
+    const int a = year / 100;
+    const int b = 2 - a + a / 4;
+
+    return floor(365.25 * (year + 4716)) + floor(30.6001 * (month + 1))
+            + rDay + b - 1524.5;
+}
+
+/*----------------------------------------------------------------------------
+Name         deltaT
+
+Purpose      Returns an estimate of Delta T, the difference between
+             Terrestrial Time and Universal Time;
+
+Input        rYear              Decimal year;
+
+Returns      double             Delta T, in seconds;
+
+Notes        Polynomials of Espenak and Meeus, which follow the observed values
+             to within a few seconds from 1961 to the present.  Outside of
+             1961 to 2150 the long term parabola is used.  An error of a few
+             seconds moves the sun by well under an arc second;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double sunposition::deltaT(const double &rYear)
+{
+    const double y = rYear;
+
+    if (y >= 1961.0 && y < 1986.0)
+    {
+        const double t = y - 1975.0;
+        return 45.45 + 1.067 * t - t * t / 260.0 - t * t * t / 718.0;
+    }
+
+    if (y >= 1986.0 && y < 2005.0)
+    {
+        const double t = y - 2000.0;
+        return 63.86 + 0.3345 * t - 0.060374 * t * t
+                + 0.0017275 * t * t * t
+                + 0.000651814 * t * t * t * t
+                + 0.00002373599 * t * t * t * t * t;
+    }
+
+    if (y >= 2005.0 && y < 2050.0)
+    {
+        const double t = y - 2000.0;
+        return 62.92 + 0.32217 * t + 0.005589 * t * t;
+    }
+
+    const double u = (y - 1820.0) / 100.0;
+    if (y >= 2050.0 && y < 2150.0)
+    {
+        return -20.0 + 32.0 * u * u - 0.5628 * (2150.0 - y);
+    }
+
+    return -20.0 + 32.0 * u * u;
+}
+
+/*----------------------------------------------------------------------------
+Name         dayTerms
+
+Purpose      Calculates the terms of the fast tier which are constant for a
+             site and date;
+
+Input        rSite              The site;
+             rYear              Year;
+             rMonth             Month (1-12);
+             rDay               Day of the month;
+
+Returns      DayTerms           The terms;
+
+Notes        See solarmath::dayTerms;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+FastSunPosition::DayTerms FastSunPosition::dayTerms(const SunSite &rSite
+                                                    , const int &rYear
+                                                    , const int &rMonth
+                                                    , const int &rDay)
+{
+    return solarmath::dayTerms(rSite.latitudeDeg
+                               , rSite.longitudeDeg
+                               , sunposition::dayOfYear(rYear, rMonth, rDay));
+}
+
+/*----------------------------------------------------------------------------
+Name         dayTerms
+
+Purpose      Calculates the terms of the precise tier which are constant for a
+             site and date;
+
+Input        rSite              The site;
+             rYear              Year;
+             rMonth             Month (1-12);
+             rDay               Day of the month;
+
+Returns      DayTerms           The terms;
+
+Notes        The refraction is scaled to the pressure and temperature of the
+             site as in the NREL SPA, from its value at 1010 mbar and 10 C;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+PreciseSunPosition::DayTerms PreciseSunPosition::dayTerms(
+        const SunSite &rSite
+        , const int &rYear
+        , const int &rMonth
+        , const int &rDay)
+{
+    const double latitudeRad = rSite.latitudeDeg * (M_PI / 180.0);
+
+    DayTerms terms;
+    terms.julianDay = sunposition::julianDay(rYear, rMonth, rDay);
+    terms.deltaTDays = sunposition::deltaT(rYear + (rMonth - 0.5) / 12.0)
+            / 86400.0;
+    terms.utOffsetSeconds = -240.0 * rSite.longitudeDeg;
+    terms.longitudeDeg = rSite.longitudeDeg;
+    terms.sinLatitude = sin(latitudeRad);
+    terms.cosLatitude = cos(latitudeRad);
+    terms.refractionScale = (rSite.pressureMbar / 1010.0)
+            * (283.0 / (273.0 + rSite.temperatureC));
+
+    return terms;
+}
@@ -0,0 +1,344 @@
+/*----------------------------------------------------------------------------
+Name         sunposition.h
+
+Purpose      Sun position engine with the algorithm chosen at compile time.
+             Each precision tier is a policy class, and SunPositionEngine is
+             instantiated on one of them, so every tier compiles to its own
+             inlined kernel with no test of the tier at run time;
+
+Notes        Two tiers are provided:
+
+             FastSunPosition      The Equation of Time and declination
+                                  approximations SolarCalc has always used,
+                                  worked out once per day, leaving one cosine,
+                                  two arc cosines, and a square root per
+                                  position.  Errors against PreciseSunPosition
+                                  are up to about 1 degree in altitude and
+                                  azimuth, mostly from the declination.  For
+                                  planning over many sites and days;
+
+             PreciseSunPosition   Apparent position from the solar theory of
+                                  Meeus (Astronomical Algorithms, ch. 25) with
+                                  the main terms of nutation and aberration,
+                                  Delta T, apparent sidereal time, solar
+                                  parallax, and refraction after Saemundsson,
+                                  corrected for pressure and temperature as in
+                                  the NREL SPA.  On the SPA's worked example
+                                  it is 3 arc seconds out in zenith and 20 in
+                                  azimuth (194.33479 against 194.34024
+                                  degrees).  Without the SPA's VSOP87 tables
+                                  it is not good to the arc second: take it as
+                                  good to about 0.01 degree (36 arc seconds)
+                                  above the horizon.  For pointing
+                                  narrow-beam dishes;
+
+             got-bench reports the throughput of each tier and its errors
+             against the reference (solar/tier/...);
+
+             Both tiers take local time as the rest of the program does: the
+             time zone is taken to be the longitude / 15 hours, less an hour
+             during daylight savings time;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Stated the precise tier's measured error;
+----------------------------------------------------------------------------*/
+#ifndef SUNPOSITION_H
+#define SUNPOSITION_H
+
+#include "solarmath.h" // USES SolarDayTerms and SunPosition;
+#include <cmath> // USES several cmath functions;
+#include <cstddef> // USES size_t;
+
+// Site of an antenna, as needed by the engine;
+struct SunSite
+{
+    SunSite()
+        : latitudeDeg(0)
+        , longitudeDeg(0)
+        , pressureMbar(1010.0)
+        , temperatureC(10.0)
+    {
+    }
+
+    double latitudeDeg; // Latitude, in degrees, north positive;
+    double longitudeDeg; // Longitude, in degrees, east positive;
+    double pressureMbar; // Mean air pressure, for refraction;
+    double temperatureC; // Mean air temperature, for refraction;
+};
+
+namespace sunposition
+{
+    // Returns the day of the year (1-366) of a Gregorian date;
+    int dayOfYear(const int& rYear, const int& rMonth, const int& rDay);
+
+    // Returns the Julian Day at 0h UT of a Gregorian date;
+    double julianDay(const int& rYear, const int& rMonth, const int& rDay);
+
+    // Returns an estimate of Delta T (TT - UT), in seconds, for a year;
+    double deltaT(const double& rYear);
+
+    // Wraps an angle, in degrees, into [0, 360);
+    inline double wrap360(const double& rDegrees)
+    {
+        return rDegrees - 360.0 * floor(rDegrees / 360.0);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         FastSunPosition
+
+Purpose      Precision policy for bulk planning.  The cheapest kernel, using
+             the same approximations as SolarCalc and solarmath;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+struct FastSunPosition
+{
+    typedef SolarDayTerms DayTerms;
+
+    // Calculates the terms which are constant for a site and date;
+    static DayTerms dayTerms(const SunSite& rSite
+                             , const int& rYear
+                             , const int& rMonth
+                             , const int& rDay);
+
+    // Calculates the position of the sun at a local time;
+    static inline SunPosition position(const DayTerms& rTerms
+                                       , const bool& rDaylightSavings
+                                       , const double& rSecondsOfDay)
+    {
+        const double degToRad = M_PI / 180.0;
+        const double radToDeg = 180.0 / M_PI;
+
+        double tst = rSecondsOfDay / 60.0 + rTerms.solarTimeOffset
+                - (rDaylightSavings ? 60.0 : 0.0);
+        tst = tst - 1440.0 * floor(tst / 1440.0);
+
+        const double hourAngle = tst / 4.0 - 180.0;
+        const double cosH = cos(hourAngle * degToRad);
+
+        double cosZenith = rTerms.sinLatitude * rTerms.sinDeclination
+                + rTerms.cosLatitude * rTerms.cosDeclination * cosH;
+        cosZenith = (cosZenith > 1.0) ? 1.0
+                                      : ((cosZenith < -1.0) ? -1.0 : cosZenith);
+
+        // Azimuth from north, selecting the morning or afternoon form of
+        // the arc cosine from the sign of the hour angle;
+        const double sinZenith = sqrt(1.0 - cosZenith * cosZenith);
+        double a = (rTerms.sinLatitude * cosZenith - rTerms.sinDeclination)
+                / (rTerms.cosLatitude * sinZenith);
+        a = (a > 1.0) ? 1.0 : ((a < -1.0) ? -1.0 : a);
+        a = acos(a) * radToDeg;
+        const double azimuth = (hourAngle > 0) ? (a + 180.0) : (540.0 - a);
+
+        SunPosition sun;
+        sun.zenithDeg = acos(cosZenith) * radToDeg;
+        sun.altitudeDeg = 90.0 - sun.zenithDeg;
+        sun.azimuthDeg = sunposition::wrap360(azimuth);
+        sun.hourAngleDeg = hourAngle;
+        return sun;
+    }
+};
+
+/*----------------------------------------------------------------------------
+Name         PreciseSunPosition
+
+Purpose      Precision policy for pointing.  Works out the apparent position
+             of the sun at each instant, as seen from the surface through the
+             atmosphere;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+struct PreciseSunPosition
+{
+    // Terms which are constant for a site and date;
+    struct DayTerms
+    {
+        double julianDay; // Julian Day at 0h UT of the date;
+        double deltaTDays; // Delta T, in days;
+        // Offset, in seconds, from local standard time to UT;
+        double utOffsetSeconds;
+        double longitudeDeg; // Longitude, east positive;
+        double sinLatitude; // Sine of the latitude;
+        double cosLatitude; // Cosine of the latitude;
+        // Pressure and temperature correction applied to the refraction;
+        double refractionScale;
+    };
+
+    // Calculates the terms which are constant for a site and date;
+    static DayTerms dayTerms(const SunSite& rSite
+                             , const int& rYear
+                             , const int& rMonth
+                             , const int& rDay);
+
+    // Calculates the position of the sun at a local time;
+    static inline SunPosition position(const DayTerms& rTerms
+                                       , const bool& rDaylightSavings
+                                       , const double& rSecondsOfDay)
+    {
+        const double degToRad = M_PI / 180.0;
+        const double radToDeg = 180.0 / M_PI;
+
+        // Days from J2000.0, in UT for the rotation of the earth and in TT
+        // for the motion of the sun;
+        const double ut = rSecondsOfDay + rTerms.utOffsetSeconds
+                - (rDaylightSavings ? 3600.0 : 0.0);
+        const double d = (rTerms.julianDay - 2451545.0) + ut / 86400.0;
+        const double t = (d + rTerms.deltaTDays) / 36525.0;
+
+        // Geometric mean longitude, mean anomaly, and eccentricity;
+        const double l0 = 280.46646 + t * (36000.76983 + t * 0.0003032);
+        const double m = (357.52911 + t * (35999.05029 - t * 0.0001537))
+                * degToRad;
+        const double e = 0.016708634 - t * (0.000042037 + t * 0.0000001267);
+
+        // Equation of the centre, giving the true longitude and anomaly;
+        const double c = (1.914602 - t * (0.004817 + t * 0.000014)) * sin(m)
+                + (0.019993 - t * 0.000101) * sin(2.0 * m)
+                + 0.000289 * sin(3.0 * m);
+        const double trueAnomaly = m + c * degToRad;
+        const double radius = 1.000001018 * (1.0 - e * e)
+                / (1.0 + e * cos(trueAnomaly));
+
+        // Apparent longitude, corrected for nutation and aberration, and the
+        // true obliquity of the ecliptic;
+        const double omega = (125.04452 - 1934.136261 * t) * degToRad;
+        const double l = 2.0 * l0 * degToRad;
+        const double nutationLongitude = (-17.20 * sin(omega)
+                                          - 1.32 * sin(l)) / 3600.0;
+        const double nutationObliquity = (9.20 * cos(omega)
+                                          + 0.57 * cos(l)) / 3600.0;
+        const double lambda = (l0 + c + nutationLongitude
+                               - 20.4898 / (3600.0 * radius)) * degToRad;
+        const double epsilon = (23.439291111
+                                - t * (0.013004167
+                                       + t * (1.6389e-7 - t * 5.0361e-7))
+                                + nutationObliquity) * degToRad;
+
+        // Right ascension and declination;
+        const double sinLambda = sin(lambda);
+        const double alpha = atan2(cos(epsilon) * sinLambda, cos(lambda));
+        const double sinDec = sin(epsilon) * sinLambda;
+        const double cosDec = sqrt(1.0 - sinDec * sinDec);
+
+        // Apparent sidereal time and the local hour angle;
+        const double tu = d / 36525.0;
+        const double siderealTime = 280.46061837 + 360.98564736629 * d
+                + tu * tu * (0.000387933 - tu / 38710000.0)
+                + nutationLongitude * cos(epsilon);
+        const double hourAngle = sunposition::wrap360(siderealTime
+                                                      + rTerms.longitudeDeg
+                                                      - alpha * radToDeg
+                                                      + 180.0) - 180.0;
+        const double h = hourAngle * degToRad;
+        const double cosH = cos(h);
+
+        // Geocentric altitude and azimuth from north;
+        double sinAltitude = rTerms.sinLatitude * sinDec
+                + rTerms.cosLatitude * cosDec * cosH;
+        sinAltitude = (sinAltitude > 1.0) ? 1.0
+                      : ((sinAltitude < -1.0) ? -1.0 : sinAltitude);
+        const double azimuth = atan2(sin(h) * cosDec
+                                     , cosH * rTerms.sinLatitude * cosDec
+                                     - sinDec * rTerms.cosLatitude);
+
+        // Parallax in altitude, then refraction, which is only applied
+        // while the sun is near or above the horizon;
+        double altitude = asin(sinAltitude) * radToDeg;
+        altitude -= (8.794 / (3600.0 * radius)) * cos(altitude * degToRad);
+
+        const double refraction = (altitude >= -0.83337)
+                ? rTerms.refractionScale * 1.02
+                  / (60.0 * tan((altitude + 10.3 / (altitude + 5.11))
+                                * degToRad))
+                : 0.0;
+        altitude += refraction;
+
+        SunPosition sun;
+        sun.altitudeDeg = altitude;
+        sun.zenithDeg = 90.0 - altitude;
+        sun.azimuthDeg = sunposition::wrap360(azimuth * radToDeg + 180.0);
+        sun.hourAngleDeg = hourAngle;
+        return sun;
+    }
+};
+
+/*----------------------------------------------------------------------------
+Name         SunPositionEngine
+
+Purpose      Calculates the position of the sun for a site, with the
+             algorithm given by the Precision policy;
+
+Notes        The engine keeps the site and the terms of the current date, so
+             one engine should be kept per thread.  Everything it calls is
+             inline, so a loop over positions compiles to the tier's kernel
+             alone;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+template <typename Precision>
+class SunPositionEngine
+{
+public:
+    typedef typename Precision::DayTerms DayTerms;
+
+    // Constructor;
+    SunPositionEngine(const SunSite& rSite
+                      , const int& rYear
+                      , const int& rMonth
+                      , const int& rDay)
+        : mSite(rSite)
+        , mTerms(Precision::dayTerms(rSite, rYear, rMonth, rDay))
+    {
+    }
+
+    // Sets the date, working out the terms which are constant for the day;
+    void setDate(const int& rYear, const int& rMonth, const int& rDay)
+    {
+        mTerms = Precision::dayTerms(mSite, rYear, rMonth, rDay);
+    }
+
+    // Returns the terms of the current date;
+    const DayTerms& getDayTerms(void) const
+    {
+        return mTerms;
+    }
+
+    // Calculates the position of the sun at a local time;
+    SunPosition position(const bool& rDaylightSavings
+                         , const double& rSecondsOfDay) const
+    {
+        return Precision::position(mTerms, rDaylightSavings, rSecondsOfDay);
+    }
+
+    // Calculates the position of the sun for an array of local times.  Any
+    // of the outputs may be null if that column is not wanted;
+    void positions(const bool& rDaylightSavings
+                   , const double* pSecondsOfDay
+                   , size_t count
+                   , double* pAzimuthDeg
+                   , double* pAltitudeDeg
+                   , double* pZenithDeg
+                   , double* pHourAngleDeg) const
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const SunPosition sun = Precision::position(mTerms
+                                                        , rDaylightSavings
+                                                        , pSecondsOfDay[i]);
+            if (pAzimuthDeg) pAzimuthDeg[i] = sun.azimuthDeg;
+            if (pAltitudeDeg) pAltitudeDeg[i] = sun.altitudeDeg;
+            if (pZenithDeg) pZenithDeg[i] = sun.zenithDeg;
+            if (pHourAngleDeg) pHourAngleDeg[i] = sun.hourAngleDeg;
+        }
+    }
+
+private:
+    SunSite mSite; // Site of the antenna;
+    DayTerms mTerms; // Terms of the current date;
+};
+
+typedef SunPositionEngine<FastSunPosition> FastSunEngine;
+typedef SunPositionEngine<PreciseSunPosition> PreciseSunEngine;
+
+#endif // SUNPOSITION_H
@@ -0,0 +1,688 @@
+/*----------------------------------------------------------------------------
+Name         sunscan.cpp
+
+Purpose      Fits a two dimensional Gaussian beam to a raster scan of the sun,
+             measuring the beamwidth, pointing offset, and sun noise rise in
+             place of typing them in;
+
+Notes        The readings are turned from dB into power and fitted with
+
+                 P(x, y) = B + A exp(-4 ln2 ((x - x0)^2 / wx^2
+                                            + (y - y0)^2 / wy^2))
+
+             by Levenberg-Marquardt, where x is the azimuth offset on the sky
+             (scaled by the cosine of the sun's elevation) and y the
+             elevation offset.  The beam's axes are taken to lie along
+             azimuth and elevation, as they do for a symmetric dish on an
+             az-el mount;
+
+             The model is separable, so each pass needs only one exp() per
+             row and per column.  The normal equations are summed over
+             blocks of rows on the pool and added up in block order, so the
+             result does not depend on the number of workers;
+
+             The map is the beam smeared by the radio sun's disc.  Taking
+             the disc as a uniform one of diameter D, with the same second
+             moment as a Gaussian of half power width sqrt(ln2 / 2) D, the
+             beamwidth is found as sqrt(w^2 - ln2 D^2 / 2), with D from
+             GotCalc::getRadioSunDiameter;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "sunscan.h"
+
+#include "gotcalc.h" // USES GotCalc for the diameter of the radio sun;
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QRegExp>
+#include <algorithm> // USES std::nth_element for the baseline guess;
+#include <cmath>
+
+namespace
+{
+    // Parameters of the model, in the order of the normal equations;
+    enum Parameter
+    {
+        Baseline,
+        Amplitude,
+        AzimuthCentre,
+        AzimuthWidth,
+        ElevationCentre,
+        ElevationWidth,
+        parameter_count
+    };
+
+    // 4 ln 2, which makes the widths half power widths;
+    const double four_ln2 = 2.77258872223978123767;
+
+    // Rows summed by each job handed to the pool;
+    const int rows_per_job = 8;
+
+    // A step smaller than this, relative to each parameter's scale, has
+    // converged;
+    const double step_tolerance = 1e-9;
+
+    // Damping beyond which no step can lower the misfit any further;
+    const double max_damping = 1e15;
+
+    // Grid and readings being fitted;
+    struct Grid
+    {
+        std::vector<double> x; // Azimuth offset of each column, on the sky;
+        std::vector<double> y; // Elevation offset of each row;
+        std::vector<double> power; // Reading of each cell, as a power;
+    };
+
+    // Normal equations of one pass over the grid;
+    struct NormalEquations
+    {
+        double a[parameter_count][parameter_count]; // J'J, upper triangle;
+        double b[parameter_count]; // J'r;
+        double chiSquared; // Sum of the squared residuals;
+
+        void clear()
+        {
+            for (int i = 0; i < parameter_count; i++)
+            {
+                for (int j = 0; j < parameter_count; j++)
+                {
+                    a[i][j] = 0;
+                }
+                b[i] = 0;
+            }
+            chiSquared = 0;
+        }
+    };
+
+    // Sums the normal equations of a block of rows;
+    void sumRows(const Grid& rGrid
+                 , const double* pParameters
+                 , const double* pColumnGain
+                 , const double* pColumnCentre
+                 , const double* pColumnWidth
+                 , const int& rFirstRow
+                 , const int& rEndRow
+                 , NormalEquations& rSums)
+    {
+        const int columns = static_cast<int>(rGrid.x.size());
+        const double baseline = pParameters[Baseline];
+        const double amplitude = pParameters[Amplitude];
+        const double centre = pParameters[ElevationCentre];
+        const double width = pParameters[ElevationWidth];
+
+        rSums.clear();
+
+        for (int row = rFirstRow; row < rEndRow; row++)
+        {
+            const double v = (rGrid.y[row] - centre) / width;
+            const double rowGain = exp(-four_ln2 * v * v);
+            const double rowCentre = 2.0 * four_ln2 * v / width;
+            const double rowWidth = rowCentre * v;
+            const double* pPower = &rGrid.power[row * columns];
+
+            for (int column = 0; column < columns; column++)
+            {
+                const double shape = pColumnGain[column] * rowGain;
+                const double gain = amplitude * shape;
+
+                double j[parameter_count];
+                j[Baseline] = 1.0;
+                j[Amplitude] = shape;
+                j[AzimuthCentre] = gain * pColumnCentre[column];
+                j[AzimuthWidth] = gain * pColumnWidth[column];
+                j[ElevationCentre] = gain * rowCentre;
+                j[ElevationWidth] = gain * rowWidth;
+
+                const double residual = pPower[column] - (baseline + gain);
+
+                for (int p = 0; p < parameter_count; p++)
+                {
+                    rSums.b[p] += j[p] * residual;
+                    for (int q = p; q < parameter_count; q++)
+                    {
+                        rSums.a[p][q] += j[p] * j[q];
+                    }
+                }
+                rSums.chiSquared += residual * residual;
+            }
+        }
+    }
+
+    // Sums the normal equations over the whole grid;
+    void evaluate(const Grid& rGrid
+                  , const double* pParameters
+                  , WorkStealingPool* pPool
+                  , NormalEquations& rSums)
+    {
+        const int columns = static_cast<int>(rGrid.x.size());
+        const int rows = static_cast<int>(rGrid.y.size());
+
+        // The column factors are shared by every row;
+        std::vector<double> columnGain(columns);
+        std::vector<double> columnCentre(columns);
+        std::vector<double> columnWidth(columns);
+        for (int column = 0; column < columns; column++)
+        {
+            const double u = (rGrid.x[column] - pParameters[AzimuthCentre])
+                    / pParameters[AzimuthWidth];
+            columnGain[column] = exp(-four_ln2 * u * u);
+            columnCentre[column] = 2.0 * four_ln2 * u
+                    / pParameters[AzimuthWidth];
+            columnWidth[column] = columnCentre[column] * u;
+        }
+
+        const int jobs = (rows + rows_per_job - 1) / rows_per_job;
+        std::vector<NormalEquations> partial(jobs);
+
+        const WorkStealingPool::RangeTask body = [&](int begin, int end)
+        {
+            for (int job = begin; job < end; job++)
+            {
+                sumRows(rGrid, pParameters, columnGain.data()
+                        , columnCentre.data(), columnWidth.data()
+                        , job * rows_per_job
+                        , qMin(rows, (job + 1) * rows_per_job)
+                        , partial[job]);
+            }
+        };
+
+        if (pPool)
+        {
+            pPool->parallelFor(0, jobs, 1, body);
+        }
+        else
+        {
+            body(0, jobs);
+        }
+
+        // Add up in block order, so the sums are always made the same way;
+        rSums.clear();
+        for (int job = 0; job < jobs; job++)
+        {
+            for (int p = 0; p < parameter_count; p++)
+            {
+                for (int q = p; q < parameter_count; q++)
+                {
+                    rSums.a[p][q] += partial[job].a[p][q];
+                }
+                rSums.b[p] += partial[job].b[p];
+            }
+            rSums.chiSquared += partial[job].chiSquared;
+        }
+    }
+
+    // Solves (J'J + damping * diag(J'J)) x = b by Cholesky decomposition;
+    bool solve(const NormalEquations& rSums
+               , const double& rDamping
+               , const double* pB
+               , double* pX)
+    {
+        double l[parameter_count][parameter_count];
+
+        for (int i = 0; i < parameter_count; i++)
+        {
+            for (int j = 0; j <= i; j++)
+            {
+                double sum = rSums.a[j][i];
+                if (i == j)
+                {
+                    sum *= 1.0 + rDamping;
+                }
+
+                for (int k = 0; k < j; k++)
+                {
+                    sum -= l[i][k] * l[j][k];
+                }
+
+                if (i == j)
+                {
+                    if (!(sum > 0))
+                    {
+                        return false;
+                    }
+                    l[i][i] = sqrt(sum);
+                }
+                else
+                {
+                    l[i][j] = sum / l[j][j];
+                }
+            }
+        }
+
+        double z[parameter_count];
+        for (int i = 0; i < parameter_count; i++)
+        {
+            double sum = pB[i];
+            for (int k = 0; k < i; k++)
+            {
+                sum -= l[i][k] * z[k];
+            }
+            z[i] = sum / l[i][i];
+        }
+
+        for (int i = parameter_count - 1; i >= 0; i--)
+        {
+            double sum = z[i];
+            for (int k = i + 1; k < parameter_count; k++)
+            {
+                sum -= l[k][i] * pX[k];
+            }
+            pX[i] = sum / l[i][i];
+        }
+
+        return true;
+    }
+
+    // Returns the median of some values;
+    double median(std::vector<double> values)
+    {
+        const size_t middle = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + middle
+                         , values.end());
+        return values[middle];
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         SunScan
+
+Purpose      Constructor;
+
+Input        pPool              Pool on which the fit is run, or 0 to run it
+                                on the calling thread;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SunScan::SunScan(WorkStealingPool *pPool)
+    : mPool(pPool)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         fit
+
+Purpose      Fits the beam to a raster scan of the sun;
+
+Input        rRaster            The scan, with at least three rows and three
+                                columns about the predicted sun position;
+             rFreqMHz           Frequency of the scan, which sets the size of
+                                the radio sun taken out of the map;
+
+Output       rFit               The fitted beam;
+
+Returns      bool               true -  If the fit converged on a beam;
+                                false - If not, see getLastError();
+
+Notes        The starting point takes the median of the raster's edge as the
+             baseline, the hottest cell as the centre, and the area above
+             half of its rise as a circular beam.  The raster should reach
+             out to well past the half power points on every side;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SunScan::fit(const SunScanRaster &rRaster
+                  , const double &rFreqMHz
+                  , SunScanFit &rFit)
+{
+    const int columns = static_cast<int>(rRaster.azimuthOffsetsDeg.size());
+    const int rows = static_cast<int>(rRaster.elevationOffsetsDeg.size());
+
+    if (columns < 3 || rows < 3)
+    {
+        mLastError = "A sun scan needs at least three rows and columns";
+        return false;
+    }
+
+    if (rRaster.powerDb.size() != static_cast<size_t>(rows) * columns)
+    {
+        mLastError = QString("A %1 by %2 sun scan needs %3 readings, not %4")
+                .arg(rows).arg(columns).arg(rows * columns)
+                .arg(rRaster.powerDb.size());
+        return false;
+    }
+
+    const double cosElevation = cos(rRaster.sunElevationDeg * M_PI / 180.0);
+    if (!(cosElevation > 0.01))
+    {
+        mLastError = "The sun is too close to the zenith to scan in azimuth";
+        return false;
+    }
+
+    Grid grid;
+    grid.x.resize(columns);
+    grid.y = rRaster.elevationOffsetsDeg;
+    grid.power.resize(rRaster.powerDb.size());
+
+    for (int column = 0; column < columns; column++)
+    {
+        grid.x[column] = rRaster.azimuthOffsetsDeg[column] * cosElevation;
+    }
+
+    for (size_t i = 0; i < grid.power.size(); i++)
+    {
+        grid.power[i] = pow(10.0, rRaster.powerDb[i] / 10.0);
+        if (!std::isfinite(grid.power[i]))
+        {
+            mLastError = "The sun scan holds a reading which is not a number";
+            return false;
+        }
+    }
+
+    const double columnSpacing = fabs(grid.x[columns - 1] - grid.x[0])
+            / (columns - 1);
+    const double rowSpacing = fabs(grid.y[rows - 1] - grid.y[0]) / (rows - 1);
+    if (!(columnSpacing > 0) || !(rowSpacing > 0))
+    {
+        mLastError = "The sun scan's offsets do not span any angle";
+        return false;
+    }
+
+    // Start from the edge's median, the hottest cell, and the half power
+    // area;
+    std::vector<double> edge;
+    for (int column = 0; column < columns; column++)
+    {
+        edge.push_back(grid.power[column]);
+        edge.push_back(grid.power[(rows - 1) * columns + column]);
+    }
+    for (int row = 1; row < rows - 1; row++)
+    {
+        edge.push_back(grid.power[row * columns]);
+        edge.push_back(grid.power[row * columns + columns - 1]);
+    }
+
+    const size_t hottest = std::max_element(grid.power.begin()
+                                            , grid.power.end())
+            - grid.power.begin();
+
+    double parameters[parameter_count];
+    parameters[Baseline] = median(edge);
+    parameters[Amplitude] = grid.power[hottest] - parameters[Baseline];
+    parameters[AzimuthCentre] = grid.x[hottest % columns];
+    parameters[ElevationCentre] = grid.y[hottest / columns];
+
+    if (!(parameters[Amplitude] > 0))
+    {
+        mLastError = "The sun scan shows no rise over its edge";
+        return false;
+    }
+
+    int halfPowerCells = 0;
+    for (size_t i = 0; i < grid.power.size(); i++)
+    {
+        if (grid.power[i] - parameters[Baseline]
+                > 0.5 * parameters[Amplitude])
+        {
+            halfPowerCells++;
+        }
+    }
+
+    const double width = sqrt(halfPowerCells * columnSpacing * rowSpacing
+                              * four_ln2 / M_PI);
+    parameters[AzimuthWidth] = qMax(width, columnSpacing);
+    parameters[ElevationWidth] = qMax(width, rowSpacing);
+
+    // Levenberg-Marquardt, with Marquardt's scaling of the damping;
+    NormalEquations sums;
+    NormalEquations trialSums;
+    evaluate(grid, parameters, mPool, sums);
+
+    double damping = 1e-3;
+    bool converged = false;
+    int iteration = 0;
+
+    while (!converged && iteration < max_iterations)
+    {
+        iteration++;
+
+        double step[parameter_count];
+        double trial[parameter_count];
+        bool accepted = false;
+
+        while (!accepted && damping < max_damping)
+        {
+            if (solve(sums, damping, sums.b, step))
+            {
+                for (int p = 0; p < parameter_count; p++)
+                {
+                    trial[p] = parameters[p] + step[p];
+                }
+
+                if (trial[AzimuthWidth] > 0 && trial[ElevationWidth] > 0)
+                {
+                    evaluate(grid, trial, mPool, trialSums);
+                    accepted = (trialSums.chiSquared <= sums.chiSquared);
+                }
+            }
+
+            if (!accepted)
+            {
+                damping *= 10.0;
+            }
+        }
+
+        // No step lowers the misfit, so this is the minimum;
+        if (!accepted)
+        {
+            converged = true;
+            break;
+        }
+
+        // Whether every parameter moved by less than the tolerance of its
+        // scale: the rise for the levels, the widths for the angles;
+        const double scale[parameter_count] =
+        {
+            parameters[Amplitude], parameters[Amplitude]
+            , parameters[AzimuthWidth], parameters[AzimuthWidth]
+            , parameters[ElevationWidth], parameters[ElevationWidth]
+        };
+
+        converged = true;
+        for (int p = 0; p < parameter_count; p++)
+        {
+            converged &= (fabs(step[p]) <= step_tolerance * fabs(scale[p]));
+            parameters[p] = trial[p];
+        }
+
+        sums = trialSums;
+        damping = qMax(damping * 0.1, 1e-12);
+    }
+
+    if (!converged)
+    {
+        mLastError = QString("The sun scan fit did not converge in %1"
+                             " iterations").arg(max_iterations);
+        return false;
+    }
+
+    if (!(parameters[Baseline] > 0) || !(parameters[Amplitude] > 0))
+    {
+        mLastError = "The sun scan fit found no sun above the sky";
+        return false;
+    }
+
+    // Take the radio sun out of the map's widths;
+    const double sunDiameter = GotCalc::getRadioSunDiameter(rFreqMHz);
+    const double sunSquared = 0.5 * log(2.0) * sunDiameter * sunDiameter;
+    const double mapAzimuth = fabs(parameters[AzimuthWidth]);
+    const double mapElevation = fabs(parameters[ElevationWidth]);
+
+    if (mapAzimuth * mapAzimuth <= sunSquared
+            || mapElevation * mapElevation <= sunSquared)
+    {
+        mLastError = "The sun scan is no wider than the radio sun, so the"
+                     " beam is too narrow to measure";
+        return false;
+    }
+
+    const double beamAzimuth = sqrt(mapAzimuth * mapAzimuth - sunSquared);
+    const double beamElevation = sqrt(mapElevation * mapElevation
+                                      - sunSquared);
+    const double beam = sqrt(beamAzimuth * beamElevation);
+
+    // The widths' covariance is the residual variance times the matching
+    // columns of the inverse of J'J;
+    const int cells = rows * columns;
+    const double variance = sums.chiSquared / qMax(1, cells - parameter_count);
+    double unit[parameter_count] = {0};
+    double azimuthColumn[parameter_count];
+    double elevationColumn[parameter_count];
+
+    double beamError = 0;
+    unit[AzimuthWidth] = 1;
+    const bool azimuthSolved = solve(sums, 0, unit, azimuthColumn);
+    unit[AzimuthWidth] = 0;
+    unit[ElevationWidth] = 1;
+    const bool elevationSolved = solve(sums, 0, unit, elevationColumn);
+
+    if (azimuthSolved && elevationSolved)
+    {
+        // d(beam)/d(map width) is map / beam on each axis, and the mean's
+        // relative error is half the combined relative error of the axes;
+        const double dAzimuth = mapAzimuth / (beamAzimuth * beamAzimuth);
+        const double dElevation = mapElevation
+                / (beamElevation * beamElevation);
+        const double relative = variance
+                * (dAzimuth * dAzimuth * azimuthColumn[AzimuthWidth]
+                   + dElevation * dElevation
+                     * elevationColumn[ElevationWidth]
+                   + 2.0 * dAzimuth * dElevation
+                     * azimuthColumn[ElevationWidth]);
+        beamError = 0.5 * beam * sqrt(qMax(0.0, relative));
+    }
+
+    rFit.baselineDb = 10.0 * log10(parameters[Baseline]);
+    rFit.peakDb = 10.0 * log10(parameters[Baseline] + parameters[Amplitude]);
+    rFit.sunNoiseRiseDb = rFit.peakDb - rFit.baselineDb;
+    rFit.azimuthOffsetDeg = parameters[AzimuthCentre] / cosElevation;
+    rFit.elevationOffsetDeg = parameters[ElevationCentre];
+    rFit.mapAzimuthWidthDeg = mapAzimuth;
+    rFit.mapElevationWidthDeg = mapElevation;
+    rFit.azimuthBeamwidthDeg = beamAzimuth;
+    rFit.elevationBeamwidthDeg = beamElevation;
+    rFit.beamwidthDeg = beam;
+    rFit.beamwidthUncertaintyDeg = beamError;
+    rFit.rmsResidual = sqrt(sums.chiSquared / cells) / parameters[Amplitude];
+    rFit.iterations = iteration;
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         getLastError
+
+Purpose      Returns a description of why fit() last failed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString SunScan::getLastError() const
+{
+    return mLastError;
+}
+
+/*----------------------------------------------------------------------------
+Name         readRaster
+
+Purpose      Reads a raster scan from a text file;
+
+Input        rFileName          The file;
+
+Output       rRaster            The raster read;
+             rError             Description of the failure, if any;
+
+Returns      bool               true -  If a raster was read;
+                                false - If not;
+
+Notes        Fields are separated by commas, semicolons, or tabs.  Blank lines
+             and lines starting with # are skipped.  An optional line
+             "sun_elevation, <degrees>" gives the sun's elevation.  The first
+             other line holds the azimuth offsets, after a first field which
+             is ignored, and each line after it an elevation offset followed
+             by a reading in dB for each azimuth offset:
+
+                 sun_elevation, 41.5
+                 el\az, -2.0, -1.9, ..., 2.0
+                 -2.0, 3.12, 3.15, ..., 3.10
+                 ...
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SunScan::readRaster(const QString &rFileName
+                         , SunScanRaster &rRaster
+                         , QString &rError)
+{
+    QFile file(rFileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        rError = "Unable to open " + rFileName + ": " + file.errorString();
+        return false;
+    }
+
+    rRaster = SunScanRaster();
+
+    const QRegExp separators("[,;\\t]");
+    QTextStream in(&file);
+    int lineNumber = 0;
+    bool haveHeader = false;
+
+    while (!in.atEnd())
+    {
+        const QString line = in.readLine().trimmed();
+        lineNumber++;
+        if (line.isEmpty() || line.startsWith('#'))
+        {
+            continue;
+        }
+
+        const QStringList fields = line.split(separators);
+        std::vector<double> values;
+        bool ok = true;
+        for (int i = 1; i < fields.size() && ok; i++)
+        {
+            values.push_back(fields.at(i).trimmed().toDouble(&ok));
+        }
+
+        if (!ok || values.empty())
+        {
+            rError = QString("%1, line %2: expected numbers")
+                    .arg(rFileName).arg(lineNumber);
+            return false;
+        }
+
+        const QString first = fields.first().trimmed();
+        if (first.compare("sun_elevation", Qt::CaseInsensitive) == 0)
+        {
+            rRaster.sunElevationDeg = values.front();
+            continue;
+        }
+
+        if (!haveHeader)
+        {
+            rRaster.azimuthOffsetsDeg = values;
+            haveHeader = true;
+            continue;
+        }
+
+        const double elevation = first.toDouble(&ok);
+        if (!ok || values.size() != rRaster.azimuthOffsetsDeg.size())
+        {
+            rError = QString("%1, line %2: expected an elevation offset and"
+                             " %3 readings").arg(rFileName).arg(lineNumber)
+                    .arg(rRaster.azimuthOffsetsDeg.size());
+            return false;
+        }
+
+        rRaster.elevationOffsetsDeg.push_back(elevation);
+        rRaster.powerDb.insert(rRaster.powerDb.end(), values.begin()
+                               , values.end());
+    }
+
+    if (rRaster.elevationOffsetsDeg.empty())
+    {
+        rError = rFileName + " holds no sun scan";
+        return false;
+    }
+
+    return true;
+}
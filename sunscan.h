@@ -0,0 +1,86 @@
+/*----------------------------------------------------------------------------
+Name         sunscan.h
+
+Purpose      Fits a two dimensional Gaussian beam to a raster scan of the sun,
+             measuring the beamwidth, pointing offset, and sun noise rise in
+             place of typing them in;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef SUNSCAN_H
+#define SUNSCAN_H
+
+#include <QString>
+#include <vector> // HASA std::vectors of offsets and readings;
+#include "workstealingpool.h" // USES WorkStealingPool to run the fit;
+
+// Readings on a grid of offsets around the predicted position of the sun;
+struct SunScanRaster
+{
+    // Azimuth offset of each column from the predicted sun, in degrees;
+    std::vector<double> azimuthOffsetsDeg;
+    // Elevation offset of each row from the predicted sun, in degrees;
+    std::vector<double> elevationOffsetsDeg;
+    // Reading of each cell, in dB, row by row;
+    std::vector<double> powerDb;
+    // Elevation of the sun during the scan, which shrinks azimuth offsets on
+    // the sky.  0 if the azimuth offsets are already cross-elevation;
+    double sunElevationDeg;
+
+    SunScanRaster() : sunElevationDeg(0) {} // Constructor;
+};
+
+// The fitted beam, and what GotCalc needs from it;
+struct SunScanFit
+{
+    double baselineDb; // Cold sky level, in dB;
+    double peakDb; // Level with the beam on the centre of the sun, in dB;
+    double sunNoiseRiseDb; // Peak over baseline, in dB;
+
+    // Pointing offset of the sun's centre from the predicted position.  The
+    // azimuth offset is in degrees of azimuth, as the mount is corrected;
+    double azimuthOffsetDeg;
+    double elevationOffsetDeg;
+
+    // Half power widths of the scanned map, on the sky, in degrees;
+    double mapAzimuthWidthDeg;
+    double mapElevationWidthDeg;
+
+    // Half power beamwidths of the antenna, with the sun's disc taken out;
+    double azimuthBeamwidthDeg;
+    double elevationBeamwidthDeg;
+    double beamwidthDeg; // Geometric mean of the two, as GotCalc takes;
+    double beamwidthUncertaintyDeg; // 1-sigma error of beamwidthDeg;
+
+    double rmsResidual; // RMS misfit, as a fraction of the peak rise;
+    int iterations; // Levenberg-Marquardt iterations taken;
+};
+
+class SunScan
+{
+public:
+    // Constructor.  Without a pool the fit runs on the calling thread;
+    explicit SunScan(WorkStealingPool* pPool = 0);
+
+    // Fits the beam to a raster taken at a frequency;
+    bool fit(const SunScanRaster& rRaster
+             , const double& rFreqMHz
+             , SunScanFit& rFit);
+
+    // Returns a description of why fit() last failed;
+    QString getLastError(void) const;
+
+    // Reads a raster from a text file;
+    static bool readRaster(const QString& rFileName
+                           , SunScanRaster& rRaster
+                           , QString& rError);
+
+    // Most Levenberg-Marquardt iterations before the fit gives up;
+    static const int max_iterations = 100;
+
+private:
+    WorkStealingPool* mPool; // Pool the fit is run on, if any;
+    QString mLastError; // Why fit() last failed;
+};
+
+#endif // SUNSCAN_H
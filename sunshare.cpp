@@ -0,0 +1,511 @@
+/*----------------------------------------------------------------------------
+Name         sunshare.cpp
+
+Purpose      Publishes the position of the sun, and a table of where it will
+             be, in a shared memory segment, so that every process on a host
+             reads one calculation instead of each making its own;
+
+Notes        The segment holds a short header and a SeqLockSlot of the latest
+             snapshot.  The publisher is its only writer.  Readers map it read
+             only and copy the snapshot out, trying again if the publisher
+             was part way through writing it, so a read is a copy of a few
+             kilobytes with no system call and no lock.  The QSharedMemory
+             lock is never taken;
+
+             The header's magic number is stored last, so a reader which
+             attaches while the publisher is still setting up sees a segment
+             which is not ready rather than one half made.  The publisher
+             marks the segment stopped as it exits, and readers then fail
+             until they attach to the segment of a new publisher;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "sunshare.h"
+
+#include "solarcalc.h" // USES SolarCalc::calculateBatchUtc for the table;
+#include "seqlockslot.h" // HASA SeqLockSlot of the snapshot;
+#include "metrics.h" // USES MetricsRegistry to count the updates;
+#include <QDateTime> // USES QDateTime for the time now;
+#include <chrono> // USES std::chrono::steady_clock for the updates;
+#include <thread> // USES std::this_thread::sleep_until;
+#include <new> // USES placement new to build the segment;
+#include <cmath> // USES fabs;
+
+// Layout of the shared memory segment;
+struct SunShareSegment
+{
+    // sun_share_magic once the rest of the segment is set up;
+    std::atomic<quint32> magic;
+    quint32 version; // sun_share_version;
+    quint32 snapshotSize; // sizeof(SunShareSnapshot);
+    std::atomic<quint32> state; // Live or Stopped;
+    SeqLockSlot<SunShareSnapshot> snapshot; // The latest snapshot;
+};
+
+namespace
+{
+    // Marks a segment made by a SunSharePublisher;
+    const quint32 sun_share_magic = 0x47535350; // "GSSP";
+    // Version of the segment layout, changed whenever it is;
+    const quint32 sun_share_version = 1;
+
+    // State of the publisher, as held in the segment;
+    const quint32 state_live = 1;
+    const quint32 state_stopped = 2;
+
+    // Age, in seconds, beyond which a live segment's publisher is taken
+    // to have died;
+    const double stale_seconds = 5.0;
+
+    // Returns the segment's contents, if it has been set up by a publisher
+    // of this version;
+    const SunShareSegment* validSegment(const void* pData, int size)
+    {
+        const SunShareSegment* pSegment
+                = static_cast<const SunShareSegment*>(pData);
+        if (pSegment == 0 || size < static_cast<int>(sizeof(SunShareSegment))
+                || pSegment->magic.load(std::memory_order_acquire)
+                   != sun_share_magic
+                || pSegment->version != sun_share_version
+                || pSegment->snapshotSize != sizeof(SunShareSnapshot))
+        {
+            return 0;
+        }
+
+        return pSegment;
+    }
+
+    // Returns the updates counter, registering it on first use;
+    const MetricsCounter& updatesCounter()
+    {
+        static const MetricsCounter counter
+                = MetricsRegistry::instance().counter(
+                    "got_sun_share_updates_total"
+                    , "Sun positions published to shared memory");
+        return counter;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         SunSharePublisher
+
+Purpose      Constructor, of a publisher at latitude and longitude 0 updating
+             10 times a second with a table one second apart;
+
+Input        rKey               Key of the segment, which readers must give
+                                too;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SunSharePublisher::SunSharePublisher(const QString &rKey, QObject *parent)
+    : QThread(parent)
+    , mMemory(rKey)
+    , mSegment(0)
+    , mLatitude(0.0)
+    , mLongitude(0.0)
+    , mRateHz(10.0)
+    , mLookaheadSeconds(1.0)
+    , mStopping(false)
+{
+    updatesCounter();
+}
+
+/*----------------------------------------------------------------------------
+Name         ~SunSharePublisher
+
+Purpose      Destructor.  The segment goes once the last reader detaches;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SunSharePublisher::~SunSharePublisher()
+{
+    stop();
+}
+
+/*----------------------------------------------------------------------------
+Name         setSite
+
+Purpose      Sets the site the position is published for;
+
+Input        rLatitude          Latitude of the site, in degrees;
+             rLongitude         Longitude of the site, in degrees, east
+                                positive;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SunSharePublisher::setSite(const double &rLatitude
+                                , const double &rLongitude)
+{
+    mLatitude = rLatitude;
+    mLongitude = rLongitude;
+}
+
+/*----------------------------------------------------------------------------
+Name         setRateHz
+
+Purpose      Sets how often the position is published;
+
+Input        rRateHz            Updates per second, 1-100;
+
+Returns      bool               true -  If the rate was set;
+                                false - If not, as it is out of range or the
+                                        thread is running;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SunSharePublisher::setRateHz(const double &rRateHz)
+{
+    if (isRunning())
+    {
+        mLastError = "The publishing rate can not be changed while"
+                     " publishing";
+        return false;
+    }
+
+    if (!(rRateHz >= 1.0 && rRateHz <= 100.0))
+    {
+        mLastError = QString("The publishing rate must be from 1 to 100 Hz,"
+                             " not %1").arg(rRateHz);
+        return false;
+    }
+
+    mRateHz = rRateHz;
+    mLastError.clear();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         setLookaheadSeconds
+
+Purpose      Sets the spacing of the lookahead table, which covers
+             sun_share_lookahead times this;
+
+Input        rSeconds           Spacing, in seconds, greater than 0;
+
+Returns      bool               true -  If the spacing was set;
+                                false - If not;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SunSharePublisher::setLookaheadSeconds(const double &rSeconds)
+{
+    if (isRunning())
+    {
+        mLastError = "The lookahead can not be changed while publishing";
+        return false;
+    }
+
+    if (!(rSeconds > 0.0))
+    {
+        mLastError = QString("The lookahead spacing must be more than 0"
+                             " seconds, not %1").arg(rSeconds);
+        return false;
+    }
+
+    mLookaheadSeconds = rSeconds;
+    mLastError.clear();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         open
+
+Purpose      Creates and sets up the shared memory segment.  Must be called
+             before start();
+
+Returns      bool               true -  If the segment is ready;
+                                false - If not, e.g. as another publisher is
+                                        using the key;
+
+Notes        A segment left behind by a publisher which died is removed by
+             attaching to it and detaching again, as the last process to
+             detach removes it.  One whose publisher is still updating it is
+             left alone;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SunSharePublisher::open()
+{
+    if (mSegment)
+    {
+        return true;
+    }
+
+    const int size = static_cast<int>(sizeof(SunShareSegment));
+    bool created = mMemory.create(size);
+    if (!created && mMemory.error() == QSharedMemory::AlreadyExists
+            && mMemory.attach(QSharedMemory::ReadOnly))
+    {
+        const SunShareSegment* pOld = validSegment(mMemory.constData()
+                                                   , mMemory.size());
+        SunShareSnapshot snapshot;
+        const bool live = pOld != 0
+                && pOld->state.load(std::memory_order_acquire) == state_live
+                && pOld->snapshot.read(snapshot) != 0
+                && fabs(QDateTime::currentMSecsSinceEpoch() / 1000.0
+                        - snapshot.utcSeconds) < stale_seconds;
+        mMemory.detach();
+
+        if (live)
+        {
+            mLastError = "Another publisher is using the shared memory"
+                         " segment " + mMemory.key();
+            return false;
+        }
+
+        created = mMemory.create(size);
+    }
+
+    if (!created)
+    {
+        mLastError = "Unable to create the shared memory segment "
+                + mMemory.key() + ": " + mMemory.errorString();
+        return false;
+    }
+
+    mSegment = new (mMemory.data()) SunShareSegment;
+    mSegment->version = sun_share_version;
+    mSegment->snapshotSize = sizeof(SunShareSnapshot);
+    mSegment->state.store(state_live, std::memory_order_relaxed);
+    mSegment->magic.store(sun_share_magic, std::memory_order_release);
+
+    mLastError.clear();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         getLastError
+
+Purpose      Returns a description of why a call last failed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString SunSharePublisher::getLastError() const
+{
+    return mLastError;
+}
+
+/*----------------------------------------------------------------------------
+Name         snapshotAt
+
+Purpose      Works out the position of the sun at an instant and the table of
+             where it will be, in one batch;
+
+Input        rUtcSeconds        The instant, in seconds since 1970 UTC;
+
+Output       rSnapshot          The snapshot;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SunSharePublisher::snapshotAt(const double &rUtcSeconds
+                                   , SunShareSnapshot &rSnapshot) const
+{
+    const int count = sun_share_lookahead + 1;
+    double times[count];
+    double azimuth[count];
+    double altitude[count];
+    double zenith[count];
+    double hourAngle[count];
+    for (int i = 0; i < count; i++)
+    {
+        times[i] = rUtcSeconds + i * mLookaheadSeconds;
+    }
+
+    SolarCalc::calculateBatchUtc(mLatitude, mLongitude, times, count
+                                 , azimuth, altitude, zenith, hourAngle);
+
+    rSnapshot.utcSeconds = rUtcSeconds;
+    rSnapshot.latitude = mLatitude;
+    rSnapshot.longitude = mLongitude;
+    rSnapshot.azimuthDeg = azimuth[0];
+    rSnapshot.altitudeDeg = altitude[0];
+    rSnapshot.zenithDeg = zenith[0];
+    rSnapshot.hourAngleDeg = hourAngle[0];
+    rSnapshot.lookaheadSeconds = mLookaheadSeconds;
+    for (int i = 0; i < sun_share_lookahead; i++)
+    {
+        rSnapshot.lookaheadAzimuthDeg[i] = azimuth[i + 1];
+        rSnapshot.lookaheadAltitudeDeg[i] = altitude[i + 1];
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         requestStop
+
+Purpose      Asks the publishing thread to stop at the end of the current
+             update, without waiting for it to do so;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SunSharePublisher::requestStop()
+{
+    mStopping = true;
+}
+
+/*----------------------------------------------------------------------------
+Name         stop
+
+Purpose      Stops the publishing thread, waits for it to finish, and marks
+             the segment stopped so that readers do not take the last
+             position for the current one;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SunSharePublisher::stop()
+{
+    requestStop();
+    wait();
+    mStopping = false;
+
+    if (mSegment)
+    {
+        mSegment->state.store(state_stopped, std::memory_order_release);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         run
+
+Purpose      Body of the publishing thread.  Publishes a snapshot each update
+             until stopped, skipping any updates it falls behind on;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SunSharePublisher::run()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    if (!mSegment)
+    {
+        return;
+    }
+
+    mSegment->state.store(state_live, std::memory_order_release);
+
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1.0 / mRateHz));
+    const Clock::time_point start = Clock::now();
+    unsigned long long next = 0;
+
+    SunShareSnapshot snapshot;
+    while (!mStopping)
+    {
+        std::this_thread::sleep_until(start + period * next);
+
+        snapshotAt(QDateTime::currentMSecsSinceEpoch() / 1000.0, snapshot);
+        mSegment->snapshot.write(snapshot);
+        updatesCounter().increment();
+
+        next = static_cast<unsigned long long>((Clock::now() - start)
+                                               / period) + 1;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         SunShareReader
+
+Purpose      Constructor;
+
+Input        rKey               Key of the segment, as given to the
+                                publisher;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SunShareReader::SunShareReader(const QString &rKey)
+    : mMemory(rKey)
+    , mSegment(0)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         attach
+
+Purpose      Attaches to the segment, read only, dropping any segment
+             attached to before;
+
+Returns      bool               true -  If attached to a segment set up by a
+                                        publisher;
+                                false - If not;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SunShareReader::attach()
+{
+    mSegment = 0;
+    if (mMemory.isAttached())
+    {
+        mMemory.detach();
+    }
+
+    if (!mMemory.attach(QSharedMemory::ReadOnly))
+    {
+        mLastError = "Unable to attach to the shared memory segment "
+                + mMemory.key() + ": " + mMemory.errorString();
+        return false;
+    }
+
+    mSegment = validSegment(mMemory.constData(), mMemory.size());
+    if (!mSegment)
+    {
+        mMemory.detach();
+        mLastError = "The shared memory segment " + mMemory.key()
+                + " is not set up, or is of another version";
+        return false;
+    }
+
+    mLastError.clear();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         isAttached
+
+Purpose      Returns whether or not the reader is attached to a segment;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SunShareReader::isAttached() const
+{
+    return mSegment != 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         getLastError
+
+Purpose      Returns a description of why attach() last failed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString SunShareReader::getLastError() const
+{
+    return mLastError;
+}
+
+/*----------------------------------------------------------------------------
+Name         read
+
+Purpose      Copies the latest snapshot out of the segment;
+
+Output       rSnapshot          The snapshot, if there is one;
+
+Returns      bool               true -  If a snapshot was copied;
+                                false - If not attached, nothing has been
+                                        published yet, or the publisher has
+                                        stopped, when attach() should be
+                                        called again to find a new one;
+
+Notes        Makes no system call and takes no lock, so any number of readers
+             may call this at any rate without slowing the publisher;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SunShareReader::read(SunShareSnapshot &rSnapshot) const
+{
+    if (!mSegment
+            || mSegment->state.load(std::memory_order_acquire) != state_live)
+    {
+        return false;
+    }
+
+    return mSegment->snapshot.read(rSnapshot) != 0;
+}
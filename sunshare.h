@@ -0,0 +1,116 @@
+/*----------------------------------------------------------------------------
+Name         sunshare.h
+
+Purpose      Publishes the position of the sun, and a table of where it will
+             be, in a shared memory segment, so that every process on a host
+             reads one calculation instead of each making its own;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef SUNSHARE_H
+#define SUNSHARE_H
+
+#include <QThread> // ISA QThread;
+#include <QSharedMemory> // HASA QSharedMemory holding the segment;
+#include <QString>
+#include <atomic> // USES std::atomic for the stop flag;
+
+// Number of instants in the lookahead table;
+const int sun_share_lookahead = 120;
+
+// Key of the segment when none is given;
+const char* const sun_share_default_key = "got-sun-position";
+
+// The position of the sun, as published;
+struct SunShareSnapshot
+{
+    double utcSeconds; // Instant of the position, in seconds since 1970 UTC;
+    double latitude; // Latitude of the site, in degrees;
+    double longitude; // Longitude of the site, in degrees, east positive;
+    double azimuthDeg; // Solar Azimuth in degrees;
+    double altitudeDeg; // Solar Altitude in degrees;
+    double zenithDeg; // Solar Zenith in degrees;
+    double hourAngleDeg; // Hour Angle in degrees;
+
+    // Entry i of the table is for utcSeconds + (i + 1) * lookaheadSeconds;
+    double lookaheadSeconds;
+    double lookaheadAzimuthDeg[sun_share_lookahead];
+    double lookaheadAltitudeDeg[sun_share_lookahead];
+};
+
+// Layout of the segment, defined in sunshare.cpp;
+struct SunShareSegment;
+
+class SunSharePublisher : public QThread
+{
+    Q_OBJECT
+
+public:
+    // Constructor, of a publisher to the segment with a key;
+    explicit SunSharePublisher(const QString& rKey = sun_share_default_key
+                               , QObject *parent = 0);
+    ~SunSharePublisher(); // Destructor, stops and removes the segment;
+
+    // Sets the site, in degrees, east positive.  Only while stopped;
+    void setSite(const double& rLatitude, const double& rLongitude);
+    // Sets the updates per second, 1-100.  Only while stopped;
+    bool setRateHz(const double& rRateHz);
+    // Sets the spacing of the lookahead table, in seconds.  Only while
+    // stopped;
+    bool setLookaheadSeconds(const double& rSeconds);
+
+    // Creates the segment, replacing one left by a publisher which died;
+    bool open(void);
+    // Returns a description of why a call last failed;
+    QString getLastError(void) const;
+
+    // Works out a snapshot at an instant, as run() publishes it;
+    void snapshotAt(const double& rUtcSeconds
+                    , SunShareSnapshot& rSnapshot) const;
+
+    // Asks the thread to stop at the end of the current update;
+    void requestStop(void);
+    // Stops the thread, marks the segment stopped, and waits;
+    void stop(void);
+
+protected:
+    void run(); // Body of the publishing thread;
+
+private:
+    QSharedMemory mMemory; // The segment;
+    SunShareSegment* mSegment; // The segment's contents, once open;
+    double mLatitude; // Latitude of the site, in degrees;
+    double mLongitude; // Longitude of the site, in degrees, east positive;
+    double mRateHz; // Updates per second;
+    double mLookaheadSeconds; // Spacing of the lookahead table;
+    QString mLastError; // Why a call last failed;
+
+    std::atomic<bool> mStopping; // The thread should exit;
+};
+
+class SunShareReader
+{
+public:
+    // Constructor, of a reader of the segment with a key;
+    explicit SunShareReader(const QString& rKey = sun_share_default_key);
+
+    // Attaches to the segment, read only;
+    bool attach(void);
+    // Whether or not the reader is attached;
+    bool isAttached(void) const;
+    // Returns a description of why a call last failed;
+    QString getLastError(void) const;
+
+    // Copies the latest snapshot, without any system call or lock.  Returns
+    // false if there is none yet or the publisher has stopped;
+    bool read(SunShareSnapshot& rSnapshot) const;
+
+private:
+    Q_DISABLE_COPY(SunShareReader)
+
+    QSharedMemory mMemory; // The segment;
+    const SunShareSegment* mSegment; // The segment's contents, once attached;
+    QString mLastError; // Why a call last failed;
+};
+
+#endif // SUNSHARE_H
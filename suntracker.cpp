@@ -0,0 +1,446 @@
+/*----------------------------------------------------------------------------
+Name         suntracker.cpp
+
+Purpose      Periodic thread which works out where to point the antenna at the
+             sun, with the rates and accelerations of each axis, and publishes
+             it for the antenna controllers;
+
+Notes        Each period has an absolute deadline on the steady clock, counted
+             from the start, so that lateness in one period does not push
+             back the next.  The thread sleeps until the deadline, works out
+             the setpoint for the deadline's instant, and publishes it
+             through a SeqLockSlot, which never waits on the readers.  How
+             late each wake was is kept as the jitter;
+
+             A period which is still running at the next deadline has missed
+             it.  The thread then carries on from the first deadline still to
+             come, counting each one skipped as missed, rather than running
+             late periods back to back;
+
+             Start the thread with QThread::TimeCriticalPriority for the
+             least jitter.  Whether that has any effect depends upon the
+             scheduler and the privileges of the process;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "suntracker.h"
+
+#include "solarmath.h" // USES solarmath for the positions of the sun;
+#include "runningstats.h" // USES RunningStats for the jitter;
+#include "metrics.h" // USES MetricsRegistry to count periods and misses;
+#include <thread> // USES std::this_thread::sleep_until;
+#include <cmath> // USES floor and fmod;
+
+namespace
+{
+    // Step, in seconds, either side of an instant used to work out the rates
+    // and accelerations;
+    const double rate_step_seconds = 1.0;
+
+    // Metrics of the tracking thread;
+    struct TrackerMetrics
+    {
+        TrackerMetrics()
+        {
+            MetricsRegistry& rRegistry = MetricsRegistry::instance();
+            periods = rRegistry.counter("got_tracker_periods_total"
+                                        , "Tracking setpoints published");
+            misses = rRegistry.counter("got_tracker_deadline_misses_total"
+                                       , "Tracking periods overrun or"
+                                         " skipped");
+            jitter = rRegistry.histogram("got_tracker_wake_latency_seconds"
+                                         , "Lateness of each wake of the"
+                                           " tracking thread");
+            compute = rRegistry.histogram("got_tracker_compute_seconds"
+                                          , "Time from each wake of the"
+                                            " tracking thread to publishing");
+        }
+
+        MetricsCounter periods; // Setpoints published;
+        MetricsCounter misses; // Deadlines missed;
+        MetricsHistogram jitter; // Lateness of each wake;
+        MetricsHistogram compute; // Time taken by each period;
+    };
+
+    // Returns the metrics, registering them on first use;
+    const TrackerMetrics& trackerMetrics()
+    {
+        static const TrackerMetrics metrics;
+        return metrics;
+    }
+
+    // Returns an angle, in degrees, brought into -180 to 180;
+    inline double wrap180(double degrees)
+    {
+        return degrees - 360.0 * floor((degrees + 180.0) / 360.0);
+    }
+
+    // Returns an angle, in degrees, brought into 0 to 360;
+    inline double wrap360(double degrees)
+    {
+        return degrees - 360.0 * floor(degrees / 360.0);
+    }
+
+    // Returns the seconds of a steady clock duration;
+    inline double toSeconds(const std::chrono::steady_clock::duration& rTime)
+    {
+        return std::chrono::duration<double>(rTime).count();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         SunTracker
+
+Purpose      Constructor, of a tracker at 50 Hz at latitude and longitude 0
+             on the system clock;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SunTracker::SunTracker(QObject *parent)
+    : QThread(parent)
+    , mRateHz(50.0)
+    , mLatitude(0.0)
+    , mLongitude(0.0)
+    , mSimulated(false)
+    , mSimulatedUtc(0.0)
+    , mStopping(false)
+{
+    trackerMetrics();
+}
+
+/*----------------------------------------------------------------------------
+Name         ~SunTracker
+
+Purpose      Destructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SunTracker::~SunTracker()
+{
+    stop();
+}
+
+/*----------------------------------------------------------------------------
+Name         setRateHz
+
+Purpose      Sets the rate setpoints are published at;
+
+Input        rRateHz            Setpoints per second, min_rate_hz to
+                                max_rate_hz;
+
+Returns      bool               true -  If the rate was set;
+                                false - If not, as it is out of range or the
+                                        thread is running;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool SunTracker::setRateHz(const double &rRateHz)
+{
+    if (isRunning())
+    {
+        mLastError = "The tracking rate can not be changed while tracking";
+        return false;
+    }
+
+    if (!(rRateHz >= min_rate_hz && rRateHz <= max_rate_hz))
+    {
+        mLastError = QString("The tracking rate must be from %1 to %2 Hz,"
+                             " not %3").arg(min_rate_hz).arg(max_rate_hz)
+                                       .arg(rRateHz);
+        return false;
+    }
+
+    mRateHz = rRateHz;
+    mLastError.clear();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         setSite
+
+Purpose      Sets the site the sun is tracked from;
+
+Input        rLatitude          Latitude of the site, in degrees;
+             rLongitude         Longitude of the site, in degrees, east
+                                positive;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SunTracker::setSite(const double &rLatitude, const double &rLongitude)
+{
+    mLatitude = rLatitude;
+    mLongitude = rLongitude;
+}
+
+/*----------------------------------------------------------------------------
+Name         setSimulatedTime
+
+Purpose      Runs the tracker's clock from a given UTC instant, starting now,
+             instead of from the system clock.  This lets a simulated
+             controller track the sun by day at any hour;
+
+Input        rUtcSeconds        The instant the clock reads now, in seconds
+                                since 1970 UTC;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SunTracker::setSimulatedTime(const double &rUtcSeconds)
+{
+    mSimulated = true;
+    mSimulatedUtc = rUtcSeconds;
+    mSimulatedStart = Clock::now();
+}
+
+/*----------------------------------------------------------------------------
+Name         getLastError
+
+Purpose      Returns a description of why a setting was last refused;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString SunTracker::getLastError() const
+{
+    return mLastError;
+}
+
+/*----------------------------------------------------------------------------
+Name         setOffsets
+
+Purpose      Sets the pointing offsets added to every setpoint from the next
+             period on;
+
+Input        rAzimuthDeg        Offset in degrees of azimuth;
+             rElevationDeg      Offset in degrees of elevation;
+
+Notes        Only one thread at a time may set the offsets, as the slot they
+             are passed through has a single writer;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SunTracker::setOffsets(const double &rAzimuthDeg
+                            , const double &rElevationDeg)
+{
+    Offsets offsets;
+    offsets.azimuthDeg = rAzimuthDeg;
+    offsets.elevationDeg = rElevationDeg;
+    mOffsets.write(offsets);
+}
+
+/*----------------------------------------------------------------------------
+Name         latest
+
+Purpose      Copies the latest setpoint;
+
+Output       rSetpoint          The setpoint, if there is one;
+
+Returns      unsigned long long Setpoints published so far, or 0 if none;
+
+Notes        Never blocks the tracking thread, however slow the caller;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+unsigned long long SunTracker::latest(TrackingSetpoint &rSetpoint) const
+{
+    return mSetpoint.read(rSetpoint);
+}
+
+/*----------------------------------------------------------------------------
+Name         statistics
+
+Purpose      Returns how well the tracker has kept to its periods, as of the
+             latest period;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+TrackingStatistics SunTracker::statistics() const
+{
+    TrackingStatistics stats = {0, 0, 0.0, 0.0, 0.0, 0.0};
+    mStatistics.read(stats);
+    return stats;
+}
+
+/*----------------------------------------------------------------------------
+Name         utcNow
+
+Purpose      Returns the tracker's clock, which controllers compare the
+             instants of the setpoints with;
+
+Returns      double             Seconds since 1970 UTC;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double SunTracker::utcNow() const
+{
+    return utcAt(Clock::now());
+}
+
+/*----------------------------------------------------------------------------
+Name         setpointAt
+
+Purpose      Works out where to point at the sun at an instant, with the
+             rates and accelerations of each axis;
+
+Input        rUtcSeconds        The instant, in seconds since 1970 UTC;
+
+Output       rSetpoint          The setpoint, without offsets and with a
+                                period of 0;
+
+Notes        The rates and accelerations are central differences of positions
+             rate_step_seconds either side.  All three are worked out with the
+             terms of the instant's day, so they do not jump at midnight UTC
+             when the declination steps, and the azimuth differences are
+             wrapped so that crossing north does not jump either;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SunTracker::setpointAt(const double &rUtcSeconds
+                            , TrackingSetpoint &rSetpoint) const
+{
+    const long long day = static_cast<long long>(
+                floor(rUtcSeconds / solarmath::seconds_per_day));
+    const SolarDayTerms terms = solarmath::utcDayTerms(mLatitude, mLongitude
+                                                       , day);
+
+    const double secondsOfDay = rUtcSeconds - day * solarmath::seconds_per_day;
+    const double times[3] = {secondsOfDay - rate_step_seconds
+                             , secondsOfDay
+                             , secondsOfDay + rate_step_seconds};
+    double azimuth[3];
+    double altitude[3];
+    solarmath::positions(terms, false, times, 3, azimuth, altitude, 0, 0);
+
+    const double h = rate_step_seconds;
+    const double azBefore = wrap180(azimuth[1] - azimuth[0]);
+    const double azAfter = wrap180(azimuth[2] - azimuth[1]);
+
+    rSetpoint.utcSeconds = rUtcSeconds;
+    rSetpoint.azimuthDeg = azimuth[1];
+    rSetpoint.elevationDeg = altitude[1];
+    rSetpoint.azimuthRateDegPerSec = (azBefore + azAfter) / (2.0 * h);
+    rSetpoint.elevationRateDegPerSec = (altitude[2] - altitude[0]) / (2.0 * h);
+    rSetpoint.azimuthAccelDegPerSec2 = (azAfter - azBefore) / (h * h);
+    rSetpoint.elevationAccelDegPerSec2 = (altitude[2] - 2.0 * altitude[1]
+                                          + altitude[0]) / (h * h);
+    rSetpoint.period = 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         requestStop
+
+Purpose      Asks the tracking thread to stop at the end of the current
+             period, without waiting for it to do so;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SunTracker::requestStop()
+{
+    mStopping = true;
+}
+
+/*----------------------------------------------------------------------------
+Name         stop
+
+Purpose      Stops the tracking thread and waits for it to finish.  The last
+             setpoint stays readable;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SunTracker::stop()
+{
+    requestStop();
+    wait();
+    mStopping = false;
+}
+
+/*----------------------------------------------------------------------------
+Name         run
+
+Purpose      Body of the tracking thread.  Publishes a setpoint each period
+             until stopped;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void SunTracker::run()
+{
+    const TrackerMetrics& rMetrics = trackerMetrics();
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1.0 / mRateHz));
+
+    TrackingStatistics stats = {0, 0, 0.0, 0.0, 0.0, 0.0};
+    RunningStats jitter;
+
+    const Clock::time_point start = Clock::now();
+    unsigned long long next = 0;
+
+    while (!mStopping)
+    {
+        const unsigned long long current = next;
+        const Clock::time_point deadline = start + period * current;
+        std::this_thread::sleep_until(deadline);
+        const Clock::time_point woke = Clock::now();
+
+        TrackingSetpoint setpoint;
+        setpointAt(utcAt(deadline), setpoint);
+
+        Offsets offsets = {0.0, 0.0};
+        mOffsets.read(offsets);
+        setpoint.azimuthDeg = wrap360(setpoint.azimuthDeg
+                                      + offsets.azimuthDeg);
+        setpoint.elevationDeg += offsets.elevationDeg;
+        setpoint.period = current;
+        mSetpoint.write(setpoint);
+
+        const Clock::time_point done = Clock::now();
+
+        // Carry on from the first deadline still to come;
+        next = current + 1;
+        if (done >= start + period * next)
+        {
+            next = static_cast<unsigned long long>((done - start) / period)
+                    + 1;
+            stats.deadlineMisses += next - current - 1;
+            rMetrics.misses.increment(next - current - 1);
+        }
+
+        const double late = toSeconds(woke - deadline);
+        const double compute = toSeconds(done - woke);
+        jitter.addSample(late);
+
+        stats.periods++;
+        stats.jitterMeanSeconds = jitter.getMean();
+        stats.jitterStdDevSeconds = jitter.getStandardDeviation();
+        stats.jitterMaxSeconds = qMax(stats.jitterMaxSeconds, late);
+        stats.computeMaxSeconds = qMax(stats.computeMaxSeconds, compute);
+        mStatistics.write(stats);
+
+        rMetrics.periods.increment();
+        rMetrics.jitter.observe(static_cast<qint64>(late * 1e9));
+        rMetrics.compute.observe(static_cast<qint64>(compute * 1e9));
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         utcAt
+
+Purpose      Returns the UTC instant of a point on the steady clock;
+
+Input        rTime              The point on the steady clock;
+
+Returns      double             Seconds since 1970 UTC, from the simulated
+                                clock if one was set, else the system clock;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double SunTracker::utcAt(const Clock::time_point &rTime) const
+{
+    if (mSimulated)
+    {
+        return mSimulatedUtc + toSeconds(rTime - mSimulatedStart);
+    }
+
+    const long long nanoseconds = std::chrono::duration_cast<
+            std::chrono::nanoseconds>(std::chrono::system_clock::now()
+                                      .time_since_epoch()).count();
+    return solarmath::secondsFromNanoseconds(nanoseconds)
+            + toSeconds(rTime - Clock::now());
+}
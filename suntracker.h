@@ -0,0 +1,118 @@
+/*----------------------------------------------------------------------------
+Name         suntracker.h
+
+Purpose      Periodic thread which works out where to point the antenna at the
+             sun, with the rates and accelerations of each axis, and publishes
+             it for the antenna controllers;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef SUNTRACKER_H
+#define SUNTRACKER_H
+
+#include <QThread> // ISA QThread;
+#include <QString>
+#include <atomic> // USES std::atomic for the stop flag;
+#include <chrono> // USES std::chrono::steady_clock for the deadlines;
+#include "seqlockslot.h" // HASA SeqLockSlots of setpoints and statistics;
+
+// Where the antenna should point at one instant;
+struct TrackingSetpoint
+{
+    double utcSeconds; // The instant, in seconds since 1970 UTC;
+    double azimuthDeg; // Azimuth, 0-360, with any pointing offset;
+    double elevationDeg; // Elevation, with any pointing offset;
+    double azimuthRateDegPerSec; // Rate of the azimuth axis;
+    double elevationRateDegPerSec; // Rate of the elevation axis;
+    double azimuthAccelDegPerSec2; // Acceleration of the azimuth axis;
+    double elevationAccelDegPerSec2; // Acceleration of the elevation axis;
+    unsigned long long period; // Number of the period it was made in;
+};
+
+// How well the tracker has kept to its periods;
+struct TrackingStatistics
+{
+    unsigned long long periods; // Setpoints published;
+    unsigned long long deadlineMisses; // Periods overrun or skipped;
+    double jitterMeanSeconds; // Mean of the lateness of each wake;
+    double jitterStdDevSeconds; // Standard deviation of the lateness;
+    double jitterMaxSeconds; // Latest wake;
+    double computeMaxSeconds; // Longest from wake to publishing;
+};
+
+class SunTracker : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit SunTracker(QObject *parent = 0); // Constructor;
+    ~SunTracker(); // Destructor, stops the thread;
+
+    // Sets the rate setpoints are published at, 10-100 Hz.  Only while
+    // stopped;
+    bool setRateHz(const double& rRateHz);
+    // Sets the site, in degrees, east positive.  Only while stopped;
+    void setSite(const double& rLatitude, const double& rLongitude);
+    // Runs the tracker's clock from a UTC instant instead of the system
+    // clock, for simulations.  Only while stopped;
+    void setSimulatedTime(const double& rUtcSeconds);
+    // Returns a description of why a setting was last refused;
+    QString getLastError(void) const;
+
+    // Adds pointing offsets, e.g. from a sun scan fit, or the steps of a
+    // raster.  May be called while running, from one thread at a time;
+    void setOffsets(const double& rAzimuthDeg, const double& rElevationDeg);
+
+    // Copies the latest setpoint, returning the number published so far, or
+    // 0 if there is none yet.  Never blocks the tracker; any thread;
+    unsigned long long latest(TrackingSetpoint& rSetpoint) const;
+    // Returns the statistics as of the latest period; any thread;
+    TrackingStatistics statistics(void) const;
+    // Returns the tracker's clock, in seconds since 1970 UTC; any thread;
+    double utcNow(void) const;
+
+    // Works out the setpoint for an instant, without the offsets;
+    void setpointAt(const double& rUtcSeconds
+                    , TrackingSetpoint& rSetpoint) const;
+
+    // Asks the thread to stop at the end of the current period;
+    void requestStop(void);
+    // Stops the thread and waits for it to finish;
+    void stop(void);
+
+    // Limits of the publishing rate, in Hz;
+    static const int min_rate_hz = 10;
+    static const int max_rate_hz = 100;
+
+protected:
+    void run(); // Body of the tracking thread;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // Pointing offsets, in degrees;
+    struct Offsets
+    {
+        double azimuthDeg;
+        double elevationDeg;
+    };
+
+    double mRateHz; // Setpoints published per second;
+    double mLatitude; // Latitude of the site, in degrees;
+    double mLongitude; // Longitude of the site, in degrees, east positive;
+    bool mSimulated; // Whether the clock runs from mSimulatedUtc;
+    double mSimulatedUtc; // UTC instant the simulated clock started at;
+    Clock::time_point mSimulatedStart; // When the simulated clock started;
+    QString mLastError; // Why a setting was last refused;
+
+    std::atomic<bool> mStopping; // The thread should exit;
+
+    SeqLockSlot<Offsets> mOffsets; // Offsets set by setOffsets;
+    SeqLockSlot<TrackingSetpoint> mSetpoint; // Latest setpoint;
+    SeqLockSlot<TrackingStatistics> mStatistics; // Latest statistics;
+
+    // Returns the UTC instant of a point on the steady clock;
+    double utcAt(const Clock::time_point& rTime) const;
+};
+
+#endif // SUNTRACKER_H
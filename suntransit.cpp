@@ -0,0 +1,348 @@
+/*----------------------------------------------------------------------------
+Name         suntransit.cpp
+
+Purpose      Finds sunrise, sunset, solar noon, and the windows of time during
+             which the sun is above a minimum elevation, for a site;
+
+Notes        Rather than stepping a SolarCalc through the day looking for the
+             right altitude, the time is measured from solar noon.  The
+             altitude of the sun rises monotonically from the previous solar
+             midnight up to noon and falls monotonically from noon to the
+             next solar midnight, so each half of the day brackets at most one
+             crossing of a given altitude.  Each crossing is then found by
+             Newton's method on the sine of the altitude, whose derivative is
+             known exactly, falling back to bisection should a Newton step
+             leave the bracket.  A handful of iterations gives the crossing to
+             a millisecond;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "suntransit.h"
+
+namespace
+{
+    const double seconds_per_day = 86400.0;
+    const double half_day_seconds = 43200.0;
+
+    // Rate at which the hour angle advances, in radians per second;
+    const double hour_angle_rate = (M_PI / 180.0) / 240.0;
+
+    // Crossings are found to within this many seconds;
+    const double time_tolerance = 1e-3;
+    const int max_iterations = 50;
+
+    // Sine of the altitude of the sun, less the sine of the target altitude,
+    // at a time measured in seconds from solar noon;
+    struct AltitudeFunction
+    {
+        double constantTerm; // sin(lat)sin(dec) - sin(target);
+        double cosineTerm; // cos(lat)cos(dec);
+
+        double value(double t) const
+        {
+            return constantTerm + cosineTerm * cos(t * hour_angle_rate);
+        }
+
+        double slope(double t) const
+        {
+            return -cosineTerm * hour_angle_rate * sin(t * hour_angle_rate);
+        }
+    };
+
+    // Finds the root of f within [low, high], given that f(low) and f(high)
+    // have opposite signs;
+    double solveBracketed(const AltitudeFunction& rF, double low, double high)
+    {
+        double fLow = rF.value(low);
+        double t = 0.5 * (low + high);
+
+        for (int i = 0; i < max_iterations; i++)
+        {
+            const double f = rF.value(t);
+
+            // Shrink the bracket around the root;
+            if ((f < 0) == (fLow < 0))
+            {
+                low = t;
+                fLow = f;
+            }
+            else
+            {
+                high = t;
+            }
+
+            // Take a Newton step, or bisect if it would leave the bracket;
+            const double slope = rF.slope(t);
+            double next = (slope != 0) ? t - f / slope : low - 1.0;
+            if (!(next > low && next < high))
+            {
+                next = 0.5 * (low + high);
+            }
+
+            const double step = next - t;
+            t = next;
+
+            if (fabs(step) < time_tolerance)
+            {
+                break;
+            }
+        }
+
+        return t;
+    }
+}
+
+const double SunTransitFinder::sunrise_altitude_deg = -0.833;
+
+/*----------------------------------------------------------------------------
+Name         SunTransitFinder
+
+Purpose      Constructor;
+
+Input        rLatitude          The latitude of the site, in degrees;
+             rLongitude         The longitude of the site, in degrees;
+             rDaylightSavings   Whether or not times are given in daylight
+                                savings time;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SunTransitFinder::SunTransitFinder(const double &rLatitude
+                                   , const double &rLongitude
+                                   , const bool &rDaylightSavings)
+    : mLatitudeDeg(rLatitude)
+    , mLongitudeDeg(rLongitude)
+    , mIsDaylightSavings(rDaylightSavings)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         findTransits
+
+Purpose      Finds sunrise, sunset, and solar noon for a day;
+
+Input        rDate              The day;
+
+Returns      SunTransitDay      The times found.  Sunrise and sunset are when
+                                the centre of the sun is at
+                                sunrise_altitude_deg, which allows for
+                                refraction and the radius of the sun;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SunTransitDay SunTransitFinder::findTransits(const QDate &rDate) const
+{
+    const Crossings crossings = solveCrossings(rDate, sunrise_altitude_deg);
+
+    SunTransitDay day;
+    day.date = rDate;
+    day.solarNoonSeconds = crossings.noonSeconds;
+    day.noonAltitudeDeg = crossings.noonAltitudeDeg;
+    day.isUpAllDay = crossings.alwaysAbove;
+
+    day.hasSunrise = !crossings.alwaysAbove && !crossings.alwaysBelow;
+    day.hasSunset = day.hasSunrise;
+
+    day.sunriseSeconds = 0;
+    day.sunsetSeconds = 0;
+    if (day.hasSunrise)
+    {
+        day.sunriseSeconds = wrapSeconds(crossings.noonSeconds
+                                         - crossings.riseOffset);
+        day.sunsetSeconds = wrapSeconds(crossings.noonSeconds
+                                        + crossings.setOffset);
+    }
+
+    return day;
+}
+
+/*----------------------------------------------------------------------------
+Name         findTransits
+
+Purpose      Finds sunrise, sunset, and solar noon for a run of days;
+
+Input        rStart             The first day;
+             rDays              Number of days;
+
+Returns      QVector            One SunTransitDay for each day;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QVector<SunTransitDay> SunTransitFinder::findTransits(const QDate &rStart
+                                                     , const int &rDays) const
+{
+    QVector<SunTransitDay> days;
+    days.reserve(qMax(0, rDays));
+
+    for (int i = 0; i < rDays; i++)
+    {
+        days.append(findTransits(rStart.addDays(i)));
+    }
+
+    return days;
+}
+
+/*----------------------------------------------------------------------------
+Name         findWindows
+
+Purpose      Finds when the sun is above an elevation mask on a day;
+
+Input        rDate              The day;
+             rMinElevationDeg   The elevation mask, in degrees;
+
+Returns      QVector            The windows, in order.  Usually there is one,
+                                but there are none if the sun never clears the
+                                mask, and two if the window crosses local
+                                midnight;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QVector<SunWindow> SunTransitFinder::findWindows(
+        const QDate &rDate, const double &rMinElevationDeg) const
+{
+    QVector<SunWindow> windows;
+    const Crossings crossings = solveCrossings(rDate, rMinElevationDeg);
+
+    if (crossings.alwaysBelow)
+    {
+        return windows;
+    }
+
+    SunWindow window;
+    window.date = rDate;
+    window.peakAltitudeDeg = crossings.noonAltitudeDeg;
+
+    if (crossings.alwaysAbove)
+    {
+        window.startSeconds = 0;
+        window.endSeconds = seconds_per_day;
+        windows.append(window);
+        return windows;
+    }
+
+    const double start = crossings.noonSeconds - crossings.riseOffset;
+    const double end = crossings.noonSeconds + crossings.setOffset;
+
+    // Split a window which crosses local midnight into the part at the start
+    // of the day and the part at the end;
+    if (start < 0 || end > seconds_per_day)
+    {
+        SunWindow early = window;
+        early.startSeconds = 0;
+        early.endSeconds = wrapSeconds(end);
+
+        window.startSeconds = wrapSeconds(start);
+        window.endSeconds = seconds_per_day;
+
+        windows.append(early);
+    }
+    else
+    {
+        window.startSeconds = start;
+        window.endSeconds = end;
+    }
+
+    windows.append(window);
+    return windows;
+}
+
+/*----------------------------------------------------------------------------
+Name         findWindows
+
+Purpose      Finds when the sun is above an elevation mask over a run of days;
+
+Input        rStart             The first day;
+             rDays              Number of days;
+             rMinElevationDeg   The elevation mask, in degrees;
+
+Returns      QVector            The windows of every day, in order;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QVector<SunWindow> SunTransitFinder::findWindows(
+        const QDate &rStart, const int &rDays
+        , const double &rMinElevationDeg) const
+{
+    QVector<SunWindow> windows;
+    windows.reserve(qMax(0, rDays));
+
+    for (int i = 0; i < rDays; i++)
+    {
+        windows += findWindows(rStart.addDays(i), rMinElevationDeg);
+    }
+
+    return windows;
+}
+
+/*----------------------------------------------------------------------------
+Name         solveCrossings
+
+Purpose      Solves for the times at which the sun crosses an altitude on a
+             day;
+
+Input        rDate              The day;
+             rAltitudeDeg       The altitude, in degrees;
+
+Returns      Crossings          Solar noon, and the crossings as offsets from
+                                solar noon;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+SunTransitFinder::Crossings SunTransitFinder::solveCrossings(
+        const QDate &rDate, const double &rAltitudeDeg) const
+{
+    const SolarDayTerms terms
+            = SolarCalc::calculateDayTerms(mLatitudeDeg
+                                           , mLongitudeDeg
+                                           , rDate.dayOfYear());
+
+    // Solar noon is when the True Solar Time is 720 minutes;
+    const double offsetMinutes = terms.solarTimeOffset
+            - (mIsDaylightSavings ? 60.0 : 0.0);
+
+    AltitudeFunction f;
+    f.constantTerm = terms.sinLatitude * terms.sinDeclination
+            - sin(rAltitudeDeg * M_PI / 180.0);
+    f.cosineTerm = terms.cosLatitude * terms.cosDeclination;
+
+    Crossings crossings;
+    crossings.noonSeconds = wrapSeconds((720.0 - offsetMinutes) * 60.0);
+    crossings.riseOffset = 0;
+    crossings.setOffset = 0;
+
+    const double noonValue = f.value(0);
+    const double midnightValue = f.value(half_day_seconds);
+
+    const double noonSine = qBound(-1.0
+                                   , noonValue
+                                   + sin(rAltitudeDeg * M_PI / 180.0)
+                                   , 1.0);
+    crossings.noonAltitudeDeg = asin(noonSine) * 180.0 / M_PI;
+
+    crossings.alwaysBelow = (noonValue < 0);
+    crossings.alwaysAbove = (midnightValue >= 0);
+
+    if (!crossings.alwaysBelow && !crossings.alwaysAbove)
+    {
+        crossings.riseOffset = -solveBracketed(f, -half_day_seconds, 0);
+        crossings.setOffset = solveBracketed(f, 0, half_day_seconds);
+    }
+
+    return crossings;
+}
+
+/*----------------------------------------------------------------------------
+Name         wrapSeconds
+
+Purpose      Wraps a time onto a single day;
+
+Input        seconds            Time, in seconds since midnight, which may be
+                                negative or more than a day;
+
+Returns      double             The time within [0, 86400);
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double SunTransitFinder::wrapSeconds(double seconds)
+{
+    return seconds - seconds_per_day * floor(seconds / seconds_per_day);
+}
@@ -0,0 +1,91 @@
+/*----------------------------------------------------------------------------
+Name         suntransit.h
+
+Purpose      Finds sunrise, sunset, solar noon, and the windows of time during
+             which the sun is above a minimum elevation, for a site;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef SUNTRANSIT_H
+#define SUNTRANSIT_H
+
+#include <QDate> // USES QDate to identify each day;
+#include <QVector> // USES QVector to return lists of days and windows;
+#include "solarcalc.h" // USES SolarCalc for the day terms of the sun;
+
+// Sunrise, sunset, and solar noon for one day;
+struct SunTransitDay
+{
+    QDate date; // The day;
+
+    bool hasSunrise; // False if the sun is up or down all day;
+    bool hasSunset; // False if the sun is up or down all day;
+    bool isUpAllDay; // True if the sun never sets;
+
+    // Times, in local seconds since midnight;
+    double sunriseSeconds;
+    double sunsetSeconds;
+    double solarNoonSeconds;
+
+    double noonAltitudeDeg; // Altitude of the sun at solar noon;
+};
+
+// A span of time during which the sun is above an elevation mask;
+struct SunWindow
+{
+    QDate date; // The day the window falls on;
+    double startSeconds; // Start, in local seconds since midnight;
+    double endSeconds; // End, in local seconds since midnight;
+    double peakAltitudeDeg; // Highest altitude reached within the window;
+};
+
+class SunTransitFinder
+{
+public:
+    // Constructor;
+    explicit SunTransitFinder(const double& rLatitude
+                              , const double& rLongitude
+                              , const bool& rDaylightSavings = false);
+
+    // Finds sunrise, sunset, and solar noon for a day;
+    SunTransitDay findTransits(const QDate& rDate) const;
+    // Finds sunrise, sunset, and solar noon for a run of days;
+    QVector<SunTransitDay> findTransits(const QDate& rStart
+                                        , const int& rDays) const;
+
+    // Finds when the sun is above an elevation mask on a day;
+    QVector<SunWindow> findWindows(const QDate& rDate
+                                   , const double& rMinElevationDeg) const;
+    // Finds when the sun is above an elevation mask over a run of days;
+    QVector<SunWindow> findWindows(const QDate& rStart
+                                   , const int& rDays
+                                   , const double& rMinElevationDeg) const;
+
+    // Altitude of the sun's centre at apparent sunrise and sunset;
+    static const double sunrise_altitude_deg;
+
+private:
+    double mLatitudeDeg; // The site's latitude;
+    double mLongitudeDeg; // The site's longitude;
+    bool mIsDaylightSavings; // Whether or not times are daylight savings;
+
+    // Result of solving for the crossings of an altitude on one day;
+    struct Crossings
+    {
+        bool alwaysAbove; // The altitude is exceeded all day;
+        bool alwaysBelow; // The altitude is never reached;
+        double noonSeconds; // Solar noon, local seconds since midnight;
+        double riseOffset; // Seconds from noon back to the rising crossing;
+        double setOffset; // Seconds from noon forward to the setting crossing;
+        double noonAltitudeDeg; // Altitude at solar noon;
+    };
+
+    // Solves for the crossings of an altitude on a day;
+    Crossings solveCrossings(const QDate& rDate
+                             , const double& rAltitudeDeg) const;
+
+    // Wraps a time onto a single day;
+    static double wrapSeconds(double seconds);
+};
+
+#endif // SUNTRANSIT_H
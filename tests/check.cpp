@@ -0,0 +1,152 @@
+/*----------------------------------------------------------------------------
+Name         check.cpp
+
+Purpose      Minimal harness for the regression check executable.  Records
+             whether each named check held and reports those which did not;
+
+Notes        Checks are named "group/what", and the filter is matched against
+             the group so that a whole group can be run on its own.  Every
+             check is made even after one fails, so a run lists all of the
+             failures at once;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "check.h"
+
+#include <QTextStream> // USES QTextStream to report failures;
+#include <QDir>
+#include <QFile>
+
+/*----------------------------------------------------------------------------
+Name         Check
+
+Purpose      Constructor;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+Check::Check()
+    : mFilter(".*")
+    , mDirectory(QDir::tempPath())
+    , mCheckCount(0)
+{
+}
+
+/*----------------------------------------------------------------------------
+Name         setFilter
+
+Purpose      Sets the regular expression selecting which checks are run;
+
+Input        rPattern           Pattern matched anywhere within a group name;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void Check::setFilter(const QString &rPattern)
+{
+    mFilter = QRegExp(rPattern);
+}
+
+/*----------------------------------------------------------------------------
+Name         setDirectory
+
+Purpose      Sets the directory in which checks may write scratch files;
+
+Input        rDirectory         The directory, which must exist;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void Check::setDirectory(const QString &rDirectory)
+{
+    mDirectory = rDirectory;
+}
+
+/*----------------------------------------------------------------------------
+Name         isSelected
+
+Purpose      Returns whether or not the filter selects a group of checks, so
+             that a group which takes a while to set up can be skipped;
+
+Input        rName              Name of the group;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool Check::isSelected(const QString &rName) const
+{
+    return mFilter.indexIn(rName) >= 0;
+}
+
+/*----------------------------------------------------------------------------
+Name         scratchFile
+
+Purpose      Returns the path of a scratch file in the check directory,
+             removing any file of that name left from an earlier run;
+
+Input        rName              Name of the file;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString Check::scratchFile(const QString &rName) const
+{
+    const QString path = QDir(mDirectory).filePath(rName);
+    QFile::remove(path);
+    return path;
+}
+
+/*----------------------------------------------------------------------------
+Name         verify
+
+Purpose      Records whether or not a check held, and reports it on stderr
+             if it did not;
+
+Input        rName              Name of the check, as "group/what";
+             rCondition         Whether or not the check held;
+             rDetail            What was found instead, if it did not;
+
+Returns      bool               rCondition;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool Check::verify(const QString &rName
+                   , const bool &rCondition
+                   , const QString &rDetail)
+{
+    mCheckCount++;
+
+    if (!rCondition)
+    {
+        mFailures.append(rName);
+
+        QTextStream err(stderr);
+        err << "FAIL " << rName;
+        if (!rDetail.isEmpty())
+        {
+            err << ": " << rDetail;
+        }
+        err << '\n';
+    }
+
+    return rCondition;
+}
+
+/*----------------------------------------------------------------------------
+Name         getCheckCount
+
+Purpose      Returns the number of checks made so far;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int Check::getCheckCount() const
+{
+    return mCheckCount;
+}
+
+/*----------------------------------------------------------------------------
+Name         getFailures
+
+Purpose      Returns the names of the checks which did not hold;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+const QStringList& Check::getFailures() const
+{
+    return mFailures;
+}
@@ -0,0 +1,48 @@
+/*----------------------------------------------------------------------------
+Name         check.h
+
+Purpose      Minimal harness for the regression check executable.  Records
+             whether each named check held and reports those which did not;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <QString> // USES QString for check names;
+#include <QStringList> // HASA QStringList of failed checks;
+#include <QRegExp> // USES QRegExp to select checks;
+
+class Check
+{
+public:
+    Check(); // Constructor;
+
+    // Sets the regular expression selecting which checks are run;
+    void setFilter(const QString& rPattern);
+    // Sets the directory in which checks may write files;
+    void setDirectory(const QString& rDirectory);
+
+    // Whether or not the filter selects a group of checks;
+    bool isSelected(const QString& rName) const;
+    // Returns a path for a scratch file, removing any left from a last run;
+    QString scratchFile(const QString& rName) const;
+
+    // Records whether a check held, reporting it if not;
+    bool verify(const QString& rName
+                , const bool& rCondition
+                , const QString& rDetail = QString());
+
+    // Returns the number of checks made;
+    int getCheckCount(void) const;
+    // Returns the names of the checks which did not hold;
+    const QStringList& getFailures(void) const;
+
+private:
+    QRegExp mFilter; // Selects which checks are run;
+    QString mDirectory; // Where scratch files are written;
+    int mCheckCount; // Checks made so far;
+    QStringList mFailures; // Checks which did not hold;
+};
+
+#endif // CHECK_H
@@ -0,0 +1,383 @@
+/*----------------------------------------------------------------------------
+Name         checkcapture.cpp
+
+Purpose      Regression checks of the radiometer capture file, written and
+             read back to the bit;
+
+Notes        The times are chosen so that the delta of delta falls either
+             side of every width the codec stores it in: 7, 12 and 20 bits,
+             and a full 64 bits beyond.  The values cover a constant signal,
+             random bit patterns, and NaNs, infinities, signed zeros, and
+             subnormals.  Values are compared as bits, so a NaN only matches
+             the same NaN;
+
+History		 17 Oct 26  AFB	Created
+             17 Oct 26  AFB Added a chunk with a corrupt window of bits;
+----------------------------------------------------------------------------*/
+#include "checkcases.h"
+#include "radiometercapture.h" // USES the capture writer and reader;
+
+#include <QFile>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    // Samples gathered before a chunk is written, so that every case but
+    // the widths spans several chunks;
+    const int chunk_capacity = 1024;
+
+    // Layout of a chunk header, as laid out in radiometercapture.cpp;
+    const int chunk_time_bytes_offset = 40;
+    const int chunk_header_bytes = 48;
+
+    // A capture's samples, in time order;
+    struct Samples
+    {
+        std::vector<qint64> times;
+        std::vector<double> values;
+    };
+
+    // Returns the next of a repeatable sequence of random bits;
+    quint64 nextRandom(quint64& rState)
+    {
+        rState = rState * Q_UINT64_C(6364136223846793005)
+                + Q_UINT64_C(1442695040888963407);
+        return rState ^ (rState >> 29);
+    }
+
+    // Returns a double with the given bits;
+    double fromBits(const quint64& rBits)
+    {
+        double value;
+        memcpy(&value, &rBits, sizeof(value));
+        return value;
+    }
+
+    // Writes samples to a capture, creating it or appending to it, and
+    // closes it;
+    bool write(const QString& rFileName, const Samples& rSamples
+               , const size_t& rFirst, const size_t& rCount
+               , const bool& rAppend, QString& rError)
+    {
+        RadiometerCaptureWriter writer;
+        writer.setChunkCapacity(chunk_capacity);
+
+        const bool ok = writer.open(rFileName, rAppend)
+                && writer.append(rSamples.times.data() + rFirst
+                                 , rSamples.values.data() + rFirst, rCount)
+                && writer.close();
+        rError = writer.getLastError();
+        return ok;
+    }
+
+    // Checks that a capture holds the first samples of a list, to the bit;
+    void checkRead(Check& rCheck, const QString& rName
+                   , const QString& rFileName, const Samples& rSamples
+                   , const size_t& rCount, const bool& rRecovered)
+    {
+        RadiometerCaptureReader reader;
+        if (!rCheck.verify(rName + "/open", reader.open(rFileName)
+                           , reader.getLastError()))
+        {
+            return;
+        }
+
+        rCheck.verify(rName + "/recovered"
+                      , reader.wasRecovered() == rRecovered);
+        rCheck.verify(rName + "/count", reader.getSampleCount()
+                      == static_cast<qint64>(rCount)
+                      , QString::number(reader.getSampleCount()));
+
+        QVector<qint64> times;
+        QVector<double> values;
+        const bool ok = reader.read(std::numeric_limits<qint64>::min()
+                                    , std::numeric_limits<qint64>::max()
+                                    , times, values);
+        rCheck.verify(rName + "/read", ok);
+
+        const size_t read = qMin(static_cast<size_t>(times.size()), rCount);
+        size_t same = 0;
+        while (same < read && times.at(same) == rSamples.times[same]
+               && memcmp(&values.at(same), &rSamples.values[same]
+                         , sizeof(double)) == 0)
+        {
+            same++;
+        }
+        rCheck.verify(rName + "/samples"
+                      , same == rCount
+                        && static_cast<size_t>(times.size()) == rCount
+                      , QString("%1 of %2 read, the first %3 the same")
+                        .arg(times.size()).arg(rCount).arg(same));
+    }
+
+    // Checks that samples are read back as written, and that a capture can
+    // be closed, reopened and appended to;
+    void checkRoundTrip(Check& rCheck, const QString& rName
+                        , const Samples& rSamples)
+    {
+        const size_t count = rSamples.times.size();
+        QString error;
+
+        const QString whole = rCheck.scratchFile(rName.section('/', 1)
+                                                 + ".gcap");
+        rCheck.verify(rName + "/write"
+                      , write(whole, rSamples, 0, count, false, error)
+                      , error);
+        checkRead(rCheck, rName, whole, rSamples, count, false);
+
+        const QString appended = rCheck.scratchFile(rName.section('/', 1)
+                                                    + "-append.gcap");
+        const size_t half = count / 2;
+        rCheck.verify(rName + "/append/write"
+                      , write(appended, rSamples, 0, half, false, error)
+                        && write(appended, rSamples, half, count - half
+                                 , true, error)
+                      , error);
+        checkRead(rCheck, rName + "/append", appended, rSamples, count
+                  , false);
+    }
+
+    // Returns samples at a steady rate with the given values;
+    Samples steady(const std::vector<double>& rValues)
+    {
+        Samples samples;
+        const qint64 start = Q_INT64_C(1760000000000000);
+        for (size_t i = 0; i < rValues.size(); i++)
+        {
+            samples.times.push_back(start + static_cast<qint64>(i) * 1000);
+            samples.values.push_back(rValues[i]);
+        }
+        return samples;
+    }
+
+    // Returns samples whose delta of delta steps either side of each width
+    // the codec stores it in, both up and down;
+    Samples widthBoundaries(void)
+    {
+        const qint64 steps[] = { 1, 63, 64, 65, 2047, 2048, 2049
+                                 , (1 << 19) - 1, 1 << 19, (1 << 19) + 1
+                                 , Q_INT64_C(1) << 40 };
+
+        // An interval which stays positive however far it steps down;
+        const qint64 interval = Q_INT64_C(1) << 41;
+
+        Samples samples;
+        qint64 time = 0;
+        samples.times.push_back(time);
+        samples.times.push_back(time += interval);
+
+        for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++)
+        {
+            // The delta of delta is +step then -step, then -step and +step;
+            samples.times.push_back(time += interval + steps[i]);
+            samples.times.push_back(time += interval);
+            samples.times.push_back(time += interval - steps[i]);
+            samples.times.push_back(time += interval);
+        }
+
+        // Repeated times, a delta of delta of minus the whole interval;
+        samples.times.push_back(time);
+        samples.times.push_back(time);
+
+        for (size_t i = 0; i < samples.times.size(); i++)
+        {
+            samples.values.push_back(static_cast<double>(i));
+        }
+        return samples;
+    }
+
+    // Checks captures cut short, as by a crash, are read and appended to
+    // up to the last whole chunk;
+    void checkTruncated(Check& rCheck, const Samples& rSamples)
+    {
+        const size_t count = rSamples.times.size();
+        QString error;
+
+        const QString closed = rCheck.scratchFile("truncated.gcap");
+        if (!rCheck.verify("capture/truncated/write"
+                           , write(closed, rSamples, 0, count, false, error)
+                           , error))
+        {
+            return;
+        }
+
+        QVector<CaptureChunk> chunks;
+        {
+            RadiometerCaptureReader reader;
+            reader.open(closed);
+            chunks = reader.getChunks();
+        }
+        if (!rCheck.verify("capture/truncated/chunks", chunks.size() > 2
+                           , QString::number(chunks.size())))
+        {
+            return;
+        }
+
+        // Losing the end of the footer loses the index but no samples;
+        const QString footer = rCheck.scratchFile("truncated-footer.gcap");
+        QFile::copy(closed, footer);
+        {
+            QFile file(footer);
+            rCheck.verify("capture/truncated/footer/resize"
+                          , file.open(QIODevice::ReadWrite)
+                            && file.resize(file.size() - 1));
+        }
+        checkRead(rCheck, "capture/truncated/footer", footer, rSamples
+                  , count, true);
+
+        // Losing part of the last chunk loses that chunk only;
+        const size_t kept = count - chunks.last().sampleCount;
+        const QString chunk = rCheck.scratchFile("truncated-chunk.gcap");
+        QFile::copy(closed, chunk);
+        {
+            QFile file(chunk);
+            rCheck.verify("capture/truncated/chunk/resize"
+                          , file.open(QIODevice::ReadWrite)
+                            && file.resize(chunks.last().offset + 20));
+        }
+        checkRead(rCheck, "capture/truncated/chunk", chunk, rSamples, kept
+                  , true);
+
+        // A capture which was not closed is appended to after its last
+        // whole chunk;
+        rCheck.verify("capture/truncated/append/write"
+                      , write(chunk, rSamples, kept, count - kept, true
+                              , error)
+                      , error);
+        checkRead(rCheck, "capture/truncated/append", chunk, rSamples
+                  , count, false);
+
+    }
+
+    // Checks a chunk whose values claim a window of bits running past the
+    // end of a value is refused rather than decoded;
+    void checkCorruptWindow(Check& rCheck, const Samples& rSamples)
+    {
+        QString error;
+        const QString name = rCheck.scratchFile("corrupt-window.gcap");
+        if (!rCheck.verify("capture/corrupt/write"
+                           , write(name, rSamples, 0, rSamples.times.size()
+                                   , false, error)
+                           , error))
+        {
+            return;
+        }
+
+        QVector<CaptureChunk> chunks;
+        {
+            RadiometerCaptureReader reader;
+            reader.open(name);
+            chunks = reader.getChunks();
+        }
+        if (!rCheck.verify("capture/corrupt/chunks", !chunks.isEmpty()))
+        {
+            return;
+        }
+
+        // The 13 bits after the first value become a new window of 31
+        // leading zeros and 63 meaningful bits, 94 in all, leaving the rest
+        // of the chunk as it was;
+        const CaptureChunk& rFirst = chunks.first();
+        bool patched = false;
+        {
+            QFile file(name);
+            quint32 timeBytes = 0;
+            char bits[2] = { 0, 0 };
+            patched = file.open(QIODevice::ReadWrite)
+                    && file.seek(rFirst.offset + chunk_time_bytes_offset)
+                    && file.read(reinterpret_cast<char*>(&timeBytes)
+                                 , sizeof(timeBytes)) == sizeof(timeBytes);
+            const qint64 window = rFirst.offset + chunk_header_bytes
+                    + timeBytes + sizeof(double);
+            patched = patched && file.seek(window)
+                    && file.read(bits, sizeof(bits)) == sizeof(bits);
+            bits[0] = static_cast<char>(0xff);
+            bits[1] = static_cast<char>(bits[1] | 0xf8);
+            patched = patched && file.seek(window)
+                    && file.write(bits, sizeof(bits)) == sizeof(bits);
+        }
+        if (!rCheck.verify("capture/corrupt/patch", patched))
+        {
+            return;
+        }
+
+        RadiometerCaptureReader reader;
+        QVector<qint64> times;
+        QVector<double> values;
+        rCheck.verify("capture/corrupt/window"
+                      , reader.open(name)
+                        && !reader.read(std::numeric_limits<qint64>::min()
+                                        , std::numeric_limits<qint64>::max()
+                                        , times, values)
+                      , QString("%1 samples read").arg(times.size()));
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runCaptureCases
+
+Purpose      Checks radiometer captures are read back to the bit, across
+             every width of the time codec and awkward values, and after
+             being truncated or reopened to append to, and that a chunk
+             with a corrupt window of value bits is refused;
+
+Input        rCheck             Records each check;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void checkcases::runCaptureCases(Check &rCheck)
+{
+    if (!rCheck.isSelected("capture"))
+    {
+        return;
+    }
+
+    const int count = 5 * chunk_capacity - 120;
+    quint64 state = 12345;
+
+    std::vector<double> values(count, 12.25);
+    checkRoundTrip(rCheck, "capture/constant", steady(values));
+
+    // Random bits, which include NaNs, and random intervals, which use
+    // every width of the time codec;
+    Samples random;
+    qint64 time = 0;
+    for (int i = 0; i < count; i++)
+    {
+        time += static_cast<qint64>(nextRandom(state) >> 34);
+        random.times.push_back(time);
+        random.values.push_back(fromBits(nextRandom(state)));
+    }
+    checkRoundTrip(rCheck, "capture/random", random);
+
+    const double special[] = {
+        std::numeric_limits<double>::quiet_NaN()
+        , -std::numeric_limits<double>::quiet_NaN()
+        , fromBits(Q_UINT64_C(0x7ff8000000000123))
+        , fromBits(Q_UINT64_C(0x7ff0000000000001))
+        , std::numeric_limits<double>::infinity()
+        , -std::numeric_limits<double>::infinity()
+        , 0.0, -0.0
+        , std::numeric_limits<double>::denorm_min()
+        , std::numeric_limits<double>::max()
+        , 1.0
+    };
+    const int specialCount = sizeof(special) / sizeof(special[0]);
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = special[(i % 3 == 0) ? specialCount - 1
+                                         : nextRandom(state) % specialCount];
+    }
+    checkRoundTrip(rCheck, "capture/nan", steady(values));
+
+    checkRoundTrip(rCheck, "capture/widths", widthBoundaries());
+
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = 12.0 + (nextRandom(state) >> 54) / 256.0;
+    }
+    checkTruncated(rCheck, steady(values));
+    checkCorruptWindow(rCheck, steady(values));
+}
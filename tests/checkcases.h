@@ -0,0 +1,41 @@
+/*----------------------------------------------------------------------------
+Name         checkcases.h
+
+Purpose      Regression checks of the file formats, parsers, and catalogs;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef CHECKCASES_H
+#define CHECKCASES_H
+
+#include "check.h" // USES Check to record each check;
+
+namespace checkcases
+{
+    // got-cli sessions through SessionProcessor into a session catalog;
+    void runSessionCases(Check& rCheck);
+    // Observatory flux files imported into the solar flux database;
+    void runFluxCases(Check& rCheck);
+    // The solar flux spectrum fitted through the available frequencies;
+    void runSpectrumCases(Check& rCheck);
+    // Polynomial kernels of fastmath.h against libm;
+    void runFastMathCases(Check& rCheck);
+    // Precision tiers of the sun position against the NREL SPA;
+    void runSunPositionCases(Check& rCheck);
+    // Sun scan fits of rasters made from a known beam;
+    void runSunScanCases(Check& rCheck);
+    // Local times across the changes of offset of a time zone;
+    void runTimeZoneCases(Check& rCheck);
+    // Sun tracker setpoints, followed by a simulated controller;
+    void runTrackerCases(Check& rCheck);
+    // Torn reads of a SeqLockSlot, and of the shared sun position;
+    void runSeqLockCases(Check& rCheck);
+    // Monte Carlo uncertainty of a G/T, and got-cli's columns of it;
+    void runUncertaintyCases(Check& rCheck);
+    // Radiometer captures written and read back to the bit;
+    void runCaptureCases(Check& rCheck);
+    // Malformed, oversized, and split frames of the query protocol;
+    void runProtocolCases(Check& rCheck);
+}
+
+#endif // CHECKCASES_H
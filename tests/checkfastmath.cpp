@@ -0,0 +1,225 @@
+/*----------------------------------------------------------------------------
+Name         checkfastmath.cpp
+
+Purpose      Regression checks of the fastmath.h polynomial kernels against
+             libm, to the largest errors fastmath.h states for them;
+
+Notes        Each domain is swept at evenly spaced points, plus the points
+             where a kernel changes interval or reduction: multiples of 45
+             degrees, acos either side of 1/2, atan2 either side of
+             tan(pi/8), and the ends of every domain.  got-bench sweeps the
+             same domains at over a million points; these are fewer, so the
+             check runs in a moment;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "checkcases.h"
+#include "fastmath.h" // USES the kernels under test;
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Points of each sweep;
+    const int sweep_points = 100001;
+
+    // Largest error found in a sweep, and where;
+    struct Worst
+    {
+        Worst() : error(0), at(0) {}
+
+        double error;
+        double at;
+
+        // Records the error at a point, NaN counting as the worst;
+        void record(const double& rError, const double& rAt)
+        {
+            if (!(rError <= error))
+            {
+                error = rError;
+                at = rAt;
+            }
+        }
+
+        // Describes the error for a failed check;
+        QString describe(void) const
+        {
+            return QString("error %1 at %2").arg(error, 0, 'g', 3)
+                    .arg(at, 0, 'g', 17);
+        }
+    };
+
+    // Returns point i of a sweep from rLow to rHigh;
+    double sweep(const double& rLow, const double& rHigh, const int& i)
+    {
+        return rLow + (rHigh - rLow) * i / (sweep_points - 1);
+    }
+
+    // Records the errors of sin, cos, and sinCos at x, in radians;
+    void checkRadians(const double& x, Worst& rWorst)
+    {
+        double s;
+        double c;
+        fastmath::sinCos(x, s, c);
+        rWorst.record(fabs(s - std::sin(x)), x);
+        rWorst.record(fabs(c - std::cos(x)), x);
+        rWorst.record(fabs(fastmath::sin(x) - std::sin(x)), x);
+        rWorst.record(fabs(fastmath::cos(x) - std::cos(x)), x);
+    }
+
+    // Records the errors of sinDeg and cosDeg at an angle in degrees;
+    void checkDegrees(const double& rDegrees, Worst& rWorst)
+    {
+        // libm's reference is taken of the exact angle reduced to +-180,
+        // which is exact, so the reference loses nothing to the conversion;
+        const double reduced = std::remainder(rDegrees, 360.0);
+        const double x = reduced * fastmath::deg_to_rad;
+        rWorst.record(fabs(fastmath::sinDeg(rDegrees) - std::sin(x))
+                      , rDegrees);
+        rWorst.record(fabs(fastmath::cosDeg(rDegrees) - std::cos(x))
+                      , rDegrees);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runFastMathCases
+
+Purpose      Checks sin, cos, acos, atan2, and dbToPower from fastmath.h
+             against libm over their stated domains;
+
+Input        rCheck             Records each check;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void checkcases::runFastMathCases(Check &rCheck)
+{
+    if (!rCheck.isSelected("fastmath"))
+    {
+        return;
+    }
+
+    // Sine and cosine over one turn, where the reduction is exact, and
+    // out to the largest argument;
+    Worst turn;
+    for (int i = 0; i < sweep_points; i++)
+    {
+        checkRadians(sweep(-2 * fastmath::pi, 2 * fastmath::pi, i), turn);
+    }
+    for (int k = -8; k <= 8; k++)
+    {
+        const double x = k * fastmath::pi_4;
+        checkRadians(x, turn);
+        checkRadians(nextafter(x, 1e300), turn);
+        checkRadians(nextafter(x, -1e300), turn);
+    }
+    rCheck.verify("fastmath/sincos/turn"
+                  , turn.error <= fastmath::sin_cos_max_error
+                  , turn.describe());
+
+    Worst wide;
+    for (int i = 0; i < sweep_points; i++)
+    {
+        checkRadians(sweep(-fastmath::sin_cos_max_argument
+                           , fastmath::sin_cos_max_argument, i), wide);
+    }
+    rCheck.verify("fastmath/sincos/wide"
+                  , wide.error <= fastmath::sin_cos_max_error
+                  , wide.describe());
+
+    // The same in degrees, including whole multiples of 45 degrees and
+    // angles of many turns;
+    Worst degrees;
+    for (int i = 0; i < sweep_points; i++)
+    {
+        checkDegrees(sweep(-720.0, 720.0, i), degrees);
+    }
+    for (int k = -16; k <= 16; k++)
+    {
+        checkDegrees(k * 45.0, degrees);
+        checkDegrees(k * 45.0 + 1e6 * 360.0, degrees);
+    }
+    rCheck.verify("fastmath/sincos/degrees"
+                  , degrees.error <= fastmath::sin_cos_max_error
+                  , degrees.describe());
+
+    // Arc cosine over [-1, 1], with the change of method at +-1/2, and NaN
+    // outside of it;
+    Worst arc;
+    for (int i = 0; i < sweep_points; i++)
+    {
+        const double x = sweep(-1.0, 1.0, i);
+        arc.record(fabs(fastmath::acos(x) - std::acos(x)), x);
+    }
+    const double acosEdges[] = { -1.0, 1.0, 0.5, nextafter(0.5, 1.0)
+                                 , -0.5, nextafter(-0.5, -1.0), 0.0, -0.0 };
+    for (size_t i = 0; i < sizeof(acosEdges) / sizeof(acosEdges[0]); i++)
+    {
+        arc.record(fabs(fastmath::acos(acosEdges[i])
+                        - std::acos(acosEdges[i])), acosEdges[i]);
+    }
+    rCheck.verify("fastmath/acos", arc.error <= fastmath::acos_max_error
+                  , arc.describe());
+    rCheck.verify("fastmath/acos/outside"
+                  , std::isnan(fastmath::acos(1.5))
+                    && std::isnan(fastmath::acos(-1.0000001)));
+
+    // Arc tangent all the way round the circle, at scales from tiny to
+    // huge, either side of tan(pi/8), and at the origin;
+    Worst tangent;
+    const double scales[] = { 1e-300, 1e-5, 1.0, 1e5, 1e300 };
+    for (size_t s = 0; s < sizeof(scales) / sizeof(scales[0]); s++)
+    {
+        for (int i = 0; i < sweep_points; i += 7)
+        {
+            const double angle = sweep(-fastmath::pi, fastmath::pi, i);
+            const double y = scales[s] * std::sin(angle);
+            const double x = scales[s] * std::cos(angle);
+            tangent.record(fabs(fastmath::atan2(y, x) - std::atan2(y, x))
+                           , angle);
+        }
+    }
+    const double tanPi8 = std::tan(fastmath::pi / 8);
+    // Not 0, as the sign of zero is not kept;
+    const double ratios[] = { tanPi8, nextafter(tanPi8, 1.0)
+                              , nextafter(tanPi8, 0.0), 1.0, 1e-9 };
+    for (size_t i = 0; i < sizeof(ratios) / sizeof(ratios[0]); i++)
+    {
+        for (int quadrant = 0; quadrant < 4; quadrant++)
+        {
+            const double x = (quadrant & 1) ? -1.0 : 1.0;
+            const double y = ((quadrant & 2) ? -1.0 : 1.0) * ratios[i];
+            tangent.record(fabs(fastmath::atan2(y, x) - std::atan2(y, x))
+                           , ratios[i]);
+            tangent.record(fabs(fastmath::atan2(x, y) - std::atan2(x, y))
+                           , ratios[i]);
+        }
+    }
+    rCheck.verify("fastmath/atan2"
+                  , tangent.error <= fastmath::atan2_max_error
+                  , tangent.describe());
+    rCheck.verify("fastmath/atan2/origin", fastmath::atan2(0.0, 0.0) == 0.0);
+
+    // dB to power ratio, relative to the ratio, over its accurate range,
+    // then finite and non-zero well beyond it;
+    Worst power;
+    const double maxDb = fastmath::db_to_power_max_argument;
+    for (int i = 0; i < sweep_points; i++)
+    {
+        const double db = sweep(-maxDb, maxDb, i);
+        const double expected = std::pow(10.0, db / 10.0);
+        power.record(fabs(fastmath::dbToPower(db) - expected) / expected, db);
+    }
+    rCheck.verify("fastmath/dbtopower"
+                  , power.error <= fastmath::db_to_power_max_error
+                  , power.describe());
+
+    const double far[] = { -3000.0, -1e6, 3000.0, 1e6 };
+    bool clamped = true;
+    for (size_t i = 0; i < sizeof(far) / sizeof(far[0]); i++)
+    {
+        const double ratio = fastmath::dbToPower(far[i]);
+        clamped &= std::isfinite(ratio) && ratio > 0;
+    }
+    rCheck.verify("fastmath/dbtopower/clamped", clamped);
+}
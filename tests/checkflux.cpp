@@ -0,0 +1,186 @@
+/*----------------------------------------------------------------------------
+Name         checkflux.cpp
+
+Purpose      Regression checks of the solar flux database, imported from the
+             observatory flux files in tests/data;
+
+Notes        flux-observatory.txt holds two days in the station layout, with
+             frequency heading rows among the stations.  On 29 Jun 2016 four
+             stations report, so the median of an even number of fluxes is
+             taken at 245, 410, and 1415 MHz, and of an odd number where a
+             station has no observation.  flux-iso.txt holds ISO dated lines,
+             one of them for 30 Jun 2016, and none for 1 Jul 2016;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "checkcases.h"
+#include "solarfluxdatabase.h" // USES SolarFluxDatabase to import and read;
+#include "gotcore.h" // USES the available frequencies;
+
+#include <QFile>
+#include <limits>
+
+namespace
+{
+    const int frequency_count = constants::number_of_available_frequencies;
+
+    // Offset of the day count within the database header;
+    const qint64 day_count_offset = 32;
+
+    const char* const observatory_file = ":/data/flux-observatory.txt";
+    const char* const iso_file = ":/data/flux-iso.txt";
+
+    // Fluxes of each day of the fixtures, NaN where none was observed;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double jun29[frequency_count]
+        = {13, 23, 34, 45, 54, 64, 74, 84, 94};
+    const double jun30[frequency_count]
+        = {100, 200, 300, 400, 500, 600, 700, 800, 900};
+    const double jun30Iso[frequency_count]
+        = {111, 211, 311, 411, 511, 611, 711, 811, 911};
+    const double jun30Both[frequency_count]
+        = {105.5, 205.5, 305.5, 405.5, 505.5, 605.5, 705.5, 805.5, 905.5};
+    const double jul01[frequency_count]
+        = {nan, nan, nan, nan, nan, nan, nan, nan, nan};
+    const double jul02[frequency_count]
+        = {101, 201, 301, 401, 501, 601, 701, 801, 901};
+
+    // Checks the fluxes held for a day;
+    void checkDay(Check& rCheck, const QString& rName
+                  , const SolarFluxDatabase& rDatabase
+                  , const QDate& rDate
+                  , const double* pExpected)
+    {
+        for (int i = 0; i < frequency_count; i++)
+        {
+            const double frequency = constants::available_frequencies[i];
+            const bool observed = (pExpected[i] == pExpected[i]);
+
+            double flux = 0;
+            const bool found = rDatabase.getFlux(rDate, frequency, flux);
+
+            rCheck.verify(QString("%1/%2/%3").arg(rName)
+                          .arg(rDate.toString(Qt::ISODate)).arg(frequency)
+                          , found == observed
+                            && (!found || flux == pExpected[i])
+                          , found ? QString::number(flux) : "not held");
+        }
+    }
+
+    // Imports files into a database, checking the days read and the span
+    // of days held;
+    void checkImport(Check& rCheck, const QString& rName
+                     , const QStringList& rFiles
+                     , const QString& rFileName
+                     , const int& rDays
+                     , const QDate& rFirst
+                     , const QDate& rLast)
+    {
+        QString error;
+        int days = 0;
+        rCheck.verify(rName + "/import"
+                      , SolarFluxDatabase::import(rFiles, rFileName, error
+                                                  , &days)
+                      , error);
+        rCheck.verify(rName + "/days", days == rDays, QString::number(days));
+
+        SolarFluxDatabase database;
+        rCheck.verify(rName + "/open", database.open(rFileName)
+                      , database.getLastError());
+        rCheck.verify(rName + "/first", database.getFirstDate() == rFirst
+                      , database.getFirstDate().toString(Qt::ISODate));
+        rCheck.verify(rName + "/last", database.getLastDate() == rLast
+                      , database.getLastDate().toString(Qt::ISODate));
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runFluxCases
+
+Purpose      Checks observatory flux files imported into the solar flux
+             database, alone, together, and into a database which already
+             holds days, and that a damaged database is not opened;
+
+Input        rCheck             Records each check;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void checkcases::runFluxCases(Check &rCheck)
+{
+    if (!rCheck.isSelected("flux"))
+    {
+        return;
+    }
+
+    const QDate june29(2016, 6, 29);
+    const QDate june30(2016, 6, 30);
+    const QDate july1(2016, 7, 1);
+    const QDate july2(2016, 7, 2);
+
+    // The station layout, with its heading rows ignored;
+    const QString observatory = rCheck.scratchFile("flux-observatory.gfx");
+    checkImport(rCheck, "flux/observatory", QStringList() << observatory_file
+                , observatory, 2, june29, june30);
+    {
+        SolarFluxDatabase database;
+        database.open(observatory);
+        checkDay(rCheck, "flux/observatory", database, june29, jun29);
+        checkDay(rCheck, "flux/observatory", database, june30, jun30);
+    }
+
+    // The ISO layout, with a day missing between two which are held;
+    const QString iso = rCheck.scratchFile("flux-iso.gfx");
+    checkImport(rCheck, "flux/iso", QStringList() << iso_file
+                , iso, 2, june30, july2);
+    {
+        SolarFluxDatabase database;
+        database.open(iso);
+        checkDay(rCheck, "flux/iso", database, june30, jun30Iso);
+        checkDay(rCheck, "flux/iso", database, july1, jul01);
+        checkDay(rCheck, "flux/iso", database, july2, jul02);
+    }
+
+    // Both files at once, where the day both report takes the median;
+    const QString both = rCheck.scratchFile("flux-both.gfx");
+    checkImport(rCheck, "flux/both", QStringList() << observatory_file
+                << iso_file, both, 3, june29, july2);
+    {
+        SolarFluxDatabase database;
+        database.open(both);
+        checkDay(rCheck, "flux/both", database, june29, jun29);
+        checkDay(rCheck, "flux/both", database, june30, jun30Both);
+    }
+
+    // A day count which overflows the size of the records when multiplied
+    // by the record size (2^62 * 36 is 0, modulo 2^64);
+    const QString damaged = rCheck.scratchFile("flux-damaged.gfx");
+    QFile::copy(observatory, damaged);
+    {
+        QFile file(damaged);
+        const qint64 dayCount = Q_INT64_C(1) << 62;
+        rCheck.verify("flux/damaged/write"
+                      , file.open(QIODevice::ReadWrite)
+                      && file.seek(day_count_offset)
+                      && file.write(reinterpret_cast<const char*>(&dayCount)
+                                    , sizeof(dayCount)) == sizeof(dayCount)
+                      , file.errorString());
+    }
+    {
+        SolarFluxDatabase database;
+        rCheck.verify("flux/damaged/open", !database.open(damaged)
+                      , "a damaged day count was accepted");
+    }
+
+    // Importing into the first database keeps its days which the file does
+    // not hold, and replaces those which it does;
+    checkImport(rCheck, "flux/merge", QStringList() << iso_file
+                , observatory, 2, june29, july2);
+    {
+        SolarFluxDatabase database;
+        database.open(observatory);
+        checkDay(rCheck, "flux/merge", database, june29, jun29);
+        checkDay(rCheck, "flux/merge", database, june30, jun30Iso);
+        checkDay(rCheck, "flux/merge", database, july1, jul01);
+        checkDay(rCheck, "flux/merge", database, july2, jul02);
+    }
+}
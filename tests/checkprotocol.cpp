@@ -0,0 +1,309 @@
+/*----------------------------------------------------------------------------
+Name         checkprotocol.cpp
+
+Purpose      Regression checks of the got-daemon query protocol against
+             malformed input: short headers, counts beyond the payload,
+             oversized lengths, sites and instants which are not finite,
+             JSON which does not parse, and frames split across reads;
+
+Notes        Only the binary payloads are cut and patched here.  The field
+             offsets are those of the headers laid out in queryprotocol.cpp;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "checkcases.h"
+#include "queryprotocol.h" // USES the protocol's framing and decoding;
+
+#include <QByteArray>
+#include <cstring>
+#include <limits>
+
+using namespace queryprotocol;
+
+namespace
+{
+    // Offsets of the counts within the binary headers;
+    const int sun_request_count_offset = 24;
+    const int got_request_hot_count_offset = 40;
+    const int got_request_cold_count_offset = 44;
+    const int sun_response_count_offset = 8;
+    const int error_response_length_offset = 8;
+
+    // Returns the payload of a single frame;
+    QByteArray payloadOf(const QByteArray& rFrame)
+    {
+        return rFrame.mid(length_bytes);
+    }
+
+    // Returns a payload with a 32 bit field replaced;
+    QByteArray patched(const QByteArray& rPayload, const int& rOffset
+                       , const quint32& rValue)
+    {
+        QByteArray payload = rPayload;
+        memcpy(payload.data() + rOffset, &rValue, sizeof(rValue));
+        return payload;
+    }
+
+    // Whether a request payload decodes;
+    bool requestDecodes(const QByteArray& rPayload, Request& rRequest
+                        , QString& rError)
+    {
+        rRequest = Request();
+        return decodeRequest(rPayload.constData(), rPayload.size()
+                             , rRequest, rError);
+    }
+
+    // Whether a response payload decodes;
+    bool responseDecodes(const QByteArray& rPayload, Response& rResponse
+                         , QString& rError)
+    {
+        rResponse = Response();
+        return decodeResponse(rPayload.constData(), rPayload.size()
+                              , rResponse, rError);
+    }
+
+    // Checks that no part of a payload short of the whole decodes;
+    void checkPrefixes(Check& rCheck, const QString& rName
+                       , const QByteArray& rPayload, const bool& rRequest)
+    {
+        int decoded = -1;
+        for (int size = 0; size < rPayload.size() && decoded < 0; size++)
+        {
+            Request request;
+            Response response;
+            QString error;
+            const QByteArray prefix = rPayload.left(size);
+            if (rRequest ? requestDecodes(prefix, request, error)
+                         : responseDecodes(prefix, response, error))
+            {
+                decoded = size;
+            }
+        }
+
+        rCheck.verify(rName + "/prefixes", decoded < 0
+                      , QString("%1 of %2 bytes decoded").arg(decoded)
+                        .arg(rPayload.size()));
+    }
+
+    // Checks that a payload fails to decode with a count patched to one
+    // more than it holds, and to counts as far as they can go;
+    void checkCounts(Check& rCheck, const QString& rName
+                     , const QByteArray& rPayload, const bool& rRequest
+                     , const int& rOffset, const quint32& rCount)
+    {
+        const quint32 counts[] = { rCount + 1, 0x7fffffff, 0xffffffff };
+        for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+        {
+            Request request;
+            Response response;
+            QString error;
+            const QByteArray payload = patched(rPayload, rOffset, counts[i]);
+            rCheck.verify(QString("%1/%2").arg(rName).arg(counts[i])
+                          , rRequest ? !requestDecodes(payload, request, error)
+                                     : !responseDecodes(payload, response
+                                                        , error)
+                          , "decoded");
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runProtocolCases
+
+Purpose      Checks the framing and binary decoding of the query protocol
+             against frames which are cut short, overstate their counts or
+             length, hold sites or instants which are not finite, or arrive
+             a few bytes at a time;
+
+Input        rCheck             Records each check;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void checkcases::runProtocolCases(Check &rCheck)
+{
+    if (!rCheck.isSelected("protocol"))
+    {
+        return;
+    }
+
+    // One frame of each binary message;
+    const double utc[] = { 1781294400.0, 1781294460.5, 1781294521.0 };
+    const std::vector<double> hot(4, 20.5);
+    const std::vector<double> cold(3, 10.25);
+
+    Request answered;
+    answered.id = 7;
+    answered.utcSeconds.assign(utc, utc + 3);
+
+    QByteArray frames[5];
+    appendSunRequest(frames[0], false, 7, 34.05, -118.25, utc, 3);
+    appendGotRequest(frames[1], false, 8, 2300, 2.5, 140, 150, hot, cold);
+    appendSunResponse(frames[2], answered, utc, utc, utc, utc);
+    appendGotResponse(frames[3], answered, 12.5, 17.78, 145.0);
+    appendError(frames[4], false, 9, "no such operation");
+
+    const int frameCount = sizeof(frames) / sizeof(frames[0]);
+    QByteArray stream;
+    for (int i = 0; i < frameCount; i++)
+    {
+        stream += frames[i];
+    }
+
+    // Whole payloads decode;
+    Request request;
+    Response response;
+    QString error;
+    rCheck.verify("protocol/whole/sun-request"
+                  , requestDecodes(payloadOf(frames[0]), request, error)
+                  && request.type == SunRequest && request.id == 7
+                  && request.latitude == 34.05
+                  && request.utcSeconds.size() == 3
+                  && request.utcSeconds[2] == utc[2]
+                  , error);
+    rCheck.verify("protocol/whole/got-request"
+                  , requestDecodes(payloadOf(frames[1]), request, error)
+                  && request.type == GotRequest && request.id == 8
+                  && request.hot == hot && request.cold == cold
+                  , error);
+    rCheck.verify("protocol/whole/sun-response"
+                  , responseDecodes(payloadOf(frames[2]), response, error)
+                  && response.type == SunResponse && response.id == 7
+                  && response.hourAngleDeg.size() == 3
+                  && response.hourAngleDeg[1] == utc[1]
+                  , error);
+    rCheck.verify("protocol/whole/got-response"
+                  , responseDecodes(payloadOf(frames[3]), response, error)
+                  && response.type == GotResponse && response.gotDb == 12.5
+                  , error);
+    rCheck.verify("protocol/whole/error"
+                  , responseDecodes(payloadOf(frames[4]), response, error)
+                  && response.type == ErrorResponse && response.id == 9
+                  && response.error == "no such operation"
+                  , error);
+
+    // Short headers, and payloads cut anywhere short of their end;
+    checkPrefixes(rCheck, "protocol/short/sun-request"
+                  , payloadOf(frames[0]), true);
+    checkPrefixes(rCheck, "protocol/short/got-request"
+                  , payloadOf(frames[1]), true);
+    checkPrefixes(rCheck, "protocol/short/sun-response"
+                  , payloadOf(frames[2]), false);
+    checkPrefixes(rCheck, "protocol/short/got-response"
+                  , payloadOf(frames[3]), false);
+    checkPrefixes(rCheck, "protocol/short/error"
+                  , payloadOf(frames[4]), false);
+
+    // Counts beyond the payload, by one and by as far as they can go;
+    checkCounts(rCheck, "protocol/count/sun-request", payloadOf(frames[0])
+                , true, sun_request_count_offset, 3);
+    checkCounts(rCheck, "protocol/count/got-hot", payloadOf(frames[1])
+                , true, got_request_hot_count_offset
+                , static_cast<quint32>(hot.size() + cold.size()));
+    checkCounts(rCheck, "protocol/count/got-cold", payloadOf(frames[1])
+                , true, got_request_cold_count_offset
+                , static_cast<quint32>(cold.size()));
+    checkCounts(rCheck, "protocol/count/sun-response", payloadOf(frames[2])
+                , false, sun_response_count_offset, 3);
+    checkCounts(rCheck, "protocol/count/error", payloadOf(frames[4])
+                , false, error_response_length_offset, 17);
+
+    // More instants than a request may hold, though all are present;
+    const std::vector<double> many(max_instants + 1, utc[0]);
+    QByteArray manyFrame;
+    appendSunRequest(manyFrame, false, 10, 0, 0, &many[0]
+                     , static_cast<int>(many.size()));
+    rCheck.verify("protocol/count/max-instants"
+                  , !requestDecodes(payloadOf(manyFrame), request, error)
+                  , "decoded");
+
+    // Sites and instants which are not finite, which the daemon could not
+    // sort or group requests by;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nanUtc[] = { utc[0], nan, utc[2] };
+    const double infUtc[] = { utc[0], utc[1], -inf };
+    QByteArray nanFrames[5];
+    appendSunRequest(nanFrames[0], false, 11, nan, -118.25, utc, 3);
+    appendSunRequest(nanFrames[1], false, 12, 34.05, nan, utc, 3);
+    appendSunRequest(nanFrames[2], false, 13, inf, -118.25, utc, 3);
+    appendSunRequest(nanFrames[3], false, 14, 34.05, -118.25, nanUtc, 3);
+    appendSunRequest(nanFrames[4], false, 15, 34.05, -118.25, infUtc, 3);
+    const char* const nanNames[] = { "latitude", "longitude"
+                                     , "infinite-latitude", "utc"
+                                     , "infinite-utc" };
+    for (int i = 0; i < 5; i++)
+    {
+        rCheck.verify(QString("protocol/nan/%1").arg(nanNames[i])
+                      , !requestDecodes(payloadOf(nanFrames[i]), request
+                                        , error)
+                        && request.id == static_cast<quint32>(11 + i)
+                        && !request.json
+                      , "decoded");
+    }
+
+    // JSON which does not parse is still answered as JSON;
+    const QByteArray broken("{\"op\":\"sun\",");
+    rCheck.verify("protocol/json/broken"
+                  , !requestDecodes(broken, request, error) && request.json
+                  , "decoded or not marked JSON");
+
+    // Lengths beyond the largest payload end the stream at once, before
+    // the payload arrives;
+    const quint32 lengths[] = { max_payload_bytes + 1, 0x80000000
+                                , 0xffffffff };
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+    {
+        bool tooLarge = false;
+        const int length = frameLength(
+                    reinterpret_cast<const char*>(&lengths[i])
+                    , length_bytes, tooLarge);
+        rCheck.verify(QString("protocol/length/%1").arg(lengths[i])
+                      , tooLarge && length == 0);
+    }
+    {
+        bool tooLarge = true;
+        const int length = frameLength(
+                    reinterpret_cast<const char*>(&max_payload_bytes)
+                    , length_bytes, tooLarge);
+        rCheck.verify("protocol/length/largest", !tooLarge && length == 0);
+    }
+
+    // Every prefix of the stream short of the first frame holds no frame,
+    // including those too short to hold its length;
+    bool waited = true;
+    for (int size = 0; size < frames[0].size() && waited; size++)
+    {
+        bool tooLarge = false;
+        waited = frameLength(stream.constData(), size, tooLarge) == 0
+                && !tooLarge;
+    }
+    rCheck.verify("protocol/split/prefixes", waited);
+
+    // The stream, read a few bytes at a time, gives back each frame whole;
+    const int reads[] = { 1, 2, 3, 5, 7, 11, 64 };
+    const int readCount = sizeof(reads) / sizeof(reads[0]);
+    QByteArray pending;
+    int found = 0;
+    bool same = true;
+    for (int offset = 0, i = 0; offset < stream.size(); i++)
+    {
+        const int size = qMin(reads[i % readCount], stream.size() - offset);
+        pending += stream.mid(offset, size);
+        offset += size;
+
+        bool tooLarge = false;
+        int length = 0;
+        while ((length = frameLength(pending.constData(), pending.size()
+                                     , tooLarge)) > 0)
+        {
+            same &= (found < frameCount
+                     && pending.left(length) == frames[found]);
+            found++;
+            pending.remove(0, length);
+        }
+        same &= !tooLarge;
+    }
+    rCheck.verify("protocol/split/frames"
+                  , same && found == frameCount && pending.isEmpty()
+                  , QString("%1 of %2 frames").arg(found).arg(frameCount));
+}
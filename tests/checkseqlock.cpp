@@ -0,0 +1,282 @@
+/*----------------------------------------------------------------------------
+Name         checkseqlock.cpp
+
+Purpose      Regression checks that SeqLockSlot, and the shared memory
+             segment of SunSharePublisher built on it, never hand a reader a
+             value torn between two writes;
+
+Notes        The slot check writes stamps whose every word is the number of
+             the write, and readers check each copy has one number all
+             through, and that it is the count read() returned.  The stamp
+             is a few kilobytes, so a write or read of it spans many time
+             slices and a reader preempted part way through a copy, on one
+             core or many, is common rather than rare;
+
+             The segment check reads snapshots while the publisher writes
+             them, and checks that each one is what the publisher works out
+             for its own instant, to the bit;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "checkcases.h"
+#include "seqlockslot.h" // USES SeqLockSlot, the subject of the checks;
+#include "sunshare.h" // USES SunSharePublisher and SunShareReader;
+
+#include <QCoreApplication> // USES the process id for a key of its own;
+#include <atomic>
+#include <chrono> // USES std::chrono::steady_clock to time the runs;
+#include <cstring> // USES memcmp to compare snapshots;
+#include <thread> // USES std::thread for the readers;
+#include <vector>
+
+namespace
+{
+    // Words in each stamp, and readers of the slot and of the segment;
+    const int stamp_words = 512;
+    const int reader_count = 2;
+
+    // How long the slot is written, and the segment published, for;
+    const int run_milliseconds = 300;
+
+    // A value of many words, each the number of the write;
+    struct Stamp
+    {
+        unsigned long long words[stamp_words];
+    };
+
+    // What one reader of the slot saw;
+    struct SlotReads
+    {
+        SlotReads() : reads(0), torn(0), backwards(0) {}
+
+        unsigned long long reads; // Values copied;
+        unsigned long long torn; // Values not all one write, or miscounted;
+        unsigned long long backwards; // Counts lower than the one before;
+    };
+
+    // Reads the slot until told to stop;
+    void readSlot(const SeqLockSlot<Stamp>* pSlot
+                  , const std::atomic<bool>* pDone
+                  , SlotReads* pReads)
+    {
+        Stamp stamp;
+        unsigned long long last = 0;
+        while (!pDone->load())
+        {
+            const unsigned long long count = pSlot->read(stamp);
+            if (count == 0)
+            {
+                continue;
+            }
+
+            bool whole = (stamp.words[0] == count);
+            for (int i = 1; i < stamp_words; i++)
+            {
+                whole &= (stamp.words[i] == stamp.words[0]);
+            }
+
+            pReads->reads++;
+            pReads->torn += whole ? 0 : 1;
+            pReads->backwards += (count < last) ? 1 : 0;
+            last = count;
+        }
+    }
+
+    // What one reader of the segment saw: each different snapshot, and how
+    // many reads differed from the first snapshot of the same instant;
+    struct SegmentReads
+    {
+        SegmentReads() : reads(0), mismatched(0) {}
+
+        unsigned long long reads;
+        unsigned long long mismatched;
+        std::vector<SunShareSnapshot> snapshots;
+    };
+
+    // Reads the segment until told to stop;
+    void readSegment(const SunShareReader* pReader
+                     , const std::atomic<bool>* pDone
+                     , SegmentReads* pReads)
+    {
+        SunShareSnapshot snapshot;
+        while (!pDone->load())
+        {
+            if (!pReader->read(snapshot))
+            {
+                continue;
+            }
+
+            pReads->reads++;
+            bool seen = false;
+            for (size_t i = 0; i < pReads->snapshots.size() && !seen; i++)
+            {
+                if (pReads->snapshots[i].utcSeconds == snapshot.utcSeconds)
+                {
+                    seen = true;
+                    pReads->mismatched += memcmp(&pReads->snapshots[i]
+                                                 , &snapshot
+                                                 , sizeof(snapshot))
+                            ? 1 : 0;
+                }
+            }
+
+            if (!seen)
+            {
+                pReads->snapshots.push_back(snapshot);
+            }
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runSeqLockCases
+
+Purpose      Checks an empty slot, then reads a slot and a shared memory
+             segment from other threads while they are written, counting any
+             torn or out of order values;
+
+Input        rCheck             Records each check;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void checkcases::runSeqLockCases(Check &rCheck)
+{
+    if (!rCheck.isSelected("seqlock"))
+    {
+        return;
+    }
+
+    // An empty slot gives 0 and leaves the value alone;
+    SeqLockSlot<Stamp> slot;
+    Stamp stamp;
+    stamp.words[0] = 7;
+    rCheck.verify("seqlock/empty", slot.read(stamp) == 0
+                  && stamp.words[0] == 7);
+
+    // Write k is all k, while the readers look on;
+    std::atomic<bool> done(false);
+    std::vector<SlotReads> slotReads(reader_count);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < reader_count; i++)
+    {
+        readers.push_back(std::thread(readSlot, &slot, &done
+                                      , &slotReads[i]));
+    }
+
+    const std::chrono::steady_clock::time_point until
+            = std::chrono::steady_clock::now()
+              + std::chrono::milliseconds(run_milliseconds);
+    unsigned long long writes = 0;
+    while (std::chrono::steady_clock::now() < until)
+    {
+        writes++;
+        for (int i = 0; i < stamp_words; i++)
+        {
+            stamp.words[i] = writes;
+        }
+        slot.write(stamp);
+    }
+
+    done = true;
+    SlotReads total;
+    for (int i = 0; i < reader_count; i++)
+    {
+        readers[i].join();
+        total.reads += slotReads[i].reads;
+        total.torn += slotReads[i].torn;
+        total.backwards += slotReads[i].backwards;
+    }
+
+    rCheck.verify("seqlock/torn"
+                  , total.reads > 0 && total.torn == 0
+                    && total.backwards == 0
+                  , QString("%1 writes, %2 reads, %3 torn, %4 backwards")
+                    .arg(QString::number(writes))
+                    .arg(QString::number(total.reads))
+                    .arg(QString::number(total.torn))
+                    .arg(QString::number(total.backwards)));
+    rCheck.verify("seqlock/latest", slot.read(stamp) == writes
+                  && stamp.words[stamp_words - 1] == writes);
+
+    // The segment, on a key no other process uses;
+    const QString key = QString("got-tests-sun-share-%1")
+            .arg(QCoreApplication::applicationPid());
+    SunShareReader reader(key);
+    rCheck.verify("seqlock/sunshare/absent", !reader.attach()
+                  && !reader.isAttached() && !reader.getLastError().isEmpty());
+
+    SunSharePublisher publisher(key);
+    publisher.setSite(34.05, -118.25);
+    publisher.setRateHz(100.0);
+    const bool opened = publisher.open();
+    rCheck.verify("seqlock/sunshare/open", opened
+                  , publisher.getLastError());
+    if (!opened)
+    {
+        return;
+    }
+
+    publisher.start();
+    const bool attached = reader.attach();
+    SunShareSnapshot first;
+    bool published = false;
+    for (int i = 0; i < 1000 && attached && !published; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        published = reader.read(first);
+    }
+    rCheck.verify("seqlock/sunshare/attach", attached && published
+                  , reader.getLastError());
+
+    // A second publisher on the same key is refused while the first runs;
+    SunSharePublisher rival(key);
+    rCheck.verify("seqlock/sunshare/rival", !rival.open()
+                  && !rival.getLastError().isEmpty());
+
+    done = false;
+    std::vector<SegmentReads> segmentReads(reader_count);
+    readers.clear();
+    for (int i = 0; i < reader_count; i++)
+    {
+        readers.push_back(std::thread(readSegment, &reader, &done
+                                      , &segmentReads[i]));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(run_milliseconds));
+    done = true;
+
+    unsigned long long reads = 0;
+    unsigned long long mismatched = 0;
+    unsigned long long wrong = 0;
+    unsigned long long instants = 0;
+    for (int i = 0; i < reader_count; i++)
+    {
+        readers[i].join();
+        reads += segmentReads[i].reads;
+        mismatched += segmentReads[i].mismatched;
+
+        const std::vector<SunShareSnapshot>& rSeen
+                = segmentReads[i].snapshots;
+        for (size_t j = 0; j < rSeen.size(); j++)
+        {
+            SunShareSnapshot expected;
+            publisher.snapshotAt(rSeen[j].utcSeconds, expected);
+            wrong += memcmp(&expected, &rSeen[j], sizeof(expected)) ? 1 : 0;
+        }
+        instants += rSeen.size();
+    }
+
+    rCheck.verify("seqlock/sunshare/torn"
+                  , reads > 0 && instants > 1 && mismatched == 0
+                    && wrong == 0
+                  , QString("%1 reads of %2 instants, %3 mismatched"
+                            ", %4 wrong")
+                    .arg(QString::number(reads))
+                    .arg(QString::number(instants))
+                    .arg(QString::number(mismatched))
+                    .arg(QString::number(wrong)));
+
+    // Once stopped, readers are told so rather than given the last one;
+    publisher.stop();
+    SunShareSnapshot last;
+    rCheck.verify("seqlock/sunshare/stopped", !reader.read(last));
+}
@@ -0,0 +1,200 @@
+/*----------------------------------------------------------------------------
+Name         checksessions.cpp
+
+Purpose      Regression checks of got-cli sessions, read by SessionProcessor
+             and kept in a SessionCatalog;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "checkcases.h"
+#include "sessionprocessor.h" // USES SessionProcessor to read sessions;
+#include "sessioncatalog.h" // USES SessionCatalog to keep the results;
+
+#include <QBuffer> // USES QBuffer for input and output held in memory;
+
+namespace
+{
+    // Runs sessions through a processor; returns the output, or the error;
+    QString process(SessionProcessor& rProcessor, const QString& rInput
+                    , bool& rOk)
+    {
+        QByteArray inputBytes = rInput.toUtf8();
+        QBuffer input(&inputBytes);
+        input.open(QIODevice::ReadOnly);
+
+        QByteArray outputBytes;
+        QBuffer output(&outputBytes);
+        output.open(QIODevice::WriteOnly);
+
+        QString error;
+        rOk = rProcessor.run(input, output, error);
+        return rOk ? QString::fromUtf8(outputBytes) : error;
+    }
+
+    // Checks that sessions with no antenna are catalogued, under no name;
+    void checkNoAntenna(Check& rCheck, const QString& rName
+                        , const SessionProcessor::Format& rFormat
+                        , const QString& rInput)
+    {
+        SessionCatalog catalog;
+        if (!rCheck.verify(rName + "/open"
+                           , catalog.open(rCheck.scratchFile(
+                                              rName.section('/', 1)
+                                              + ".sqlite"))
+                           , catalog.getLastError()))
+        {
+            return;
+        }
+
+        SessionProcessor processor(rFormat, SessionProcessor::Csv);
+        processor.setCatalog(&catalog, "no-antenna");
+
+        bool ok = false;
+        const QString result = process(processor, rInput, ok);
+        rCheck.verify(rName + "/run", ok, result);
+        rCheck.verify(rName + "/errors", processor.getErrorCount() == 0
+                      , result);
+        rCheck.verify(rName + "/count", catalog.count() == 2
+                      , QString::number(catalog.count()));
+
+        QVector<CatalogSession> sessions;
+        rCheck.verify(rName + "/find"
+                      , catalog.find(CatalogQuery(), sessions)
+                      && sessions.size() == 2
+                      && sessions.at(0).antenna.isEmpty()
+                      && sessions.at(1).antenna.isEmpty()
+                      , catalog.getLastError());
+    }
+
+    // Checks that quoted CSV fields are read back as they are written;
+    void checkQuoted(Check& rCheck, const QString& rName)
+    {
+        const QStringList ids = QStringList() << "\"a,1\""
+                                              << "\"say \"\"hi\"\"\""
+                                              << "\"plain\"";
+        QString input = "\"id\",frequency,beamwidth,flux_low,flux_high"
+                        ",\"hot\",cold\n";
+        for (int i = 0; i < ids.size(); i++)
+        {
+            input += ids.at(i) + ",10000,0.5,100,110,\"20;20.5\",10\n";
+        }
+
+        SessionProcessor processor(SessionProcessor::Csv
+                                   , SessionProcessor::Csv);
+
+        bool ok = false;
+        const QString result = process(processor, input, ok);
+        rCheck.verify(rName + "/run", ok, result);
+        rCheck.verify(rName + "/errors", processor.getErrorCount() == 0
+                      , result);
+
+        // Ids which need quotes are written as they were read, and an id
+        // which does not is written without them;
+        const QStringList output = result.split('\n'
+                                                , QString::SkipEmptyParts);
+        const QStringList expected = QStringList() << ids.at(0) << ids.at(1)
+                                                   << "plain";
+        rCheck.verify(rName + "/lines", output.size() == ids.size() + 1
+                      , result);
+        for (int i = 1; i < output.size() && i <= ids.size(); i++)
+        {
+            rCheck.verify(QString("%1/%2").arg(rName).arg(i)
+                          , output.at(i).startsWith(expected.at(i - 1)
+                                                    + ",10000,")
+                          , output.at(i));
+        }
+    }
+
+    // Checks that each line of input fails with the given error;
+    void checkRejected(Check& rCheck, const QString& rName
+                       , const SessionProcessor::Format& rFormat
+                       , const QString& rHeader
+                       , const QStringList& rLines
+                       , const QString& rError)
+    {
+        SessionProcessor processor(rFormat, SessionProcessor::Csv);
+
+        bool ok = false;
+        const QString result = process(processor
+                                       , rHeader + rLines.join("\n") + "\n"
+                                       , ok);
+        rCheck.verify(rName + "/run", ok, result);
+        rCheck.verify(rName + "/errors"
+                      , processor.getErrorCount() == rLines.size()
+                      , result);
+
+        // The error is the last column of each line after the header;
+        const QStringList output = result.split('\n'
+                                                , QString::SkipEmptyParts);
+        rCheck.verify(rName + "/lines", output.size() == rLines.size() + 1
+                      , result);
+        for (int i = 1; i < output.size(); i++)
+        {
+            rCheck.verify(QString("%1/%2").arg(rName).arg(i)
+                          , output.at(i).endsWith("," + rError)
+                          , output.at(i));
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runSessionCases
+
+Purpose      Checks sessions read by SessionProcessor, as got-cli reads them,
+             and kept in a SessionCatalog;
+
+Input        rCheck             Records each check;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void checkcases::runSessionCases(Check &rCheck)
+{
+    if (!rCheck.isSelected("sessions"))
+    {
+        return;
+    }
+
+    // Input with no antenna, as most files have, must still be kept;
+    checkNoAntenna(rCheck, "sessions/csv-no-antenna", SessionProcessor::Csv
+                   , "id,frequency,beamwidth,flux_low,flux_high,hot,cold\n"
+                     "a,10000,0.5,100,110,20;20.5,10;10.2\n"
+                     "b,2000,3,80,90,15,9\n");
+    checkNoAntenna(rCheck, "sessions/jsonl-no-antenna"
+                   , SessionProcessor::JsonLines
+                   , "{\"id\":\"a\",\"frequency\":10000,\"beamwidth\":0.5,"
+                     "\"flux_low\":100,\"flux_high\":110,"
+                     "\"hot\":[20,20.5],\"cold\":[10,10.2]}\n"
+                     "{\"id\":\"b\",\"frequency\":2000,\"beamwidth\":3,"
+                     "\"flux_low\":80,\"flux_high\":90,"
+                     "\"hot\":[15],\"cold\":[9]}\n");
+
+    // Measurements which are not numbers must not be read as 0 dB;
+    const QString session = "{\"id\":\"a\",\"frequency\":10000,"
+                            "\"beamwidth\":0.5,\"flux_low\":100,"
+                            "\"flux_high\":110,";
+    checkRejected(rCheck, "sessions/jsonl-invalid-hot"
+                  , SessionProcessor::JsonLines, QString()
+                  , QStringList()
+                  << session + "\"hot\":[\"12.3\"],\"cold\":[10]}"
+                  << session + "\"hot\":[20,null],\"cold\":[10]}"
+                  << session + "\"hot\":[true],\"cold\":[10]}"
+                  << session + "\"hot\":20,\"cold\":[10]}"
+                  << session + "\"hot\":\"20;21\",\"cold\":[10]}"
+                  , "invalid hot");
+    checkRejected(rCheck, "sessions/jsonl-invalid-cold"
+                  , SessionProcessor::JsonLines, QString()
+                  , QStringList()
+                  << session + "\"hot\":[20],\"cold\":[10,\"x\"]}"
+                  << session + "\"hot\":[20],\"cold\":{}}"
+                  , "invalid cold");
+
+    // CSV fields are quoted as the results are written;
+    checkQuoted(rCheck, "sessions/csv-quoted");
+    checkRejected(rCheck, "sessions/csv-unterminated-quote"
+                  , SessionProcessor::Csv
+                  , "id,frequency,beamwidth,flux_low,flux_high,hot,cold\n"
+                  , QStringList()
+                  << "\"a,10000,0.5,100,110,20,10"
+                  << "a,10000,0.5,100,110,\"20;21,10"
+                  , "unterminated quoted field");
+}
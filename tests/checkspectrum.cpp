@@ -0,0 +1,155 @@
+/*----------------------------------------------------------------------------
+Name         checkspectrum.cpp
+
+Purpose      Regression checks of the solar flux spectrum, fitted through
+             fluxes at the available frequencies;
+
+Notes        The fluxes fall from 245 to 410 MHz and rise from there on, so
+             the spline has a turning point to hold flat as well as a run to
+             follow.  The fit is made in log10, so fluxes are compared to a
+             relative tolerance;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "checkcases.h"
+#include "fluxspectrum.h" // USES FluxSpectrum to fit and evaluate;
+#include "gotcore.h" // USES the available frequencies;
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    const int frequency_count = constants::number_of_available_frequencies;
+    const double* const frequencies = constants::available_frequencies;
+
+    // Fluxes at each of the available frequencies;
+    const double fluxes[frequency_count]
+        = {60, 45, 50, 70, 100, 105, 140, 220, 400};
+
+    // Relative tolerance of a flux;
+    const double tolerance = 1e-12;
+
+    // Whether a flux is within the tolerance of the one expected;
+    bool near(const double& rFlux, const double& rExpected)
+    {
+        return fabs(rFlux - rExpected) <= tolerance * fabs(rExpected);
+    }
+
+    // Returns the flux at a frequency on the power law through two fluxes;
+    double powerLaw(const double& rFreq, const int& rFrom, const int& rTo)
+    {
+        const double slope = log10(fluxes[rTo] / fluxes[rFrom])
+                / log10(frequencies[rTo] / frequencies[rFrom]);
+        return fluxes[rFrom] * pow(rFreq / frequencies[rFrom], slope);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runSpectrumCases
+
+Purpose      Checks the solar flux spectrum passes through its fluxes, does
+             not overshoot them between frequencies, is extended as a power
+             law beyond them, and is NaN where there is no frequency to
+             evaluate it at;
+
+Input        rCheck             Records each check;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void checkcases::runSpectrumCases(Check &rCheck)
+{
+    if (!rCheck.isSelected("spectrum"))
+    {
+        return;
+    }
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+
+    // A spectrum which has not been fitted;
+    FluxSpectrum spectrum;
+    rCheck.verify("spectrum/empty", !spectrum.isValid()
+                  && std::isnan(spectrum.evaluate(1000.0))
+                  && spectrum.getLowestFrequency() == 0);
+
+    // One usable flux is too few to fit;
+    const double one[frequency_count]
+        = {0, nan, 50, -1, 0, 0, nan, 0, 0};
+    rCheck.verify("spectrum/too-few", !spectrum.setFluxes(one)
+                  && !spectrum.isValid());
+
+    if (!rCheck.verify("spectrum/fit", spectrum.setFluxes(fluxes)
+                       && spectrum.isValid()))
+    {
+        return;
+    }
+    rCheck.verify("spectrum/range"
+                  , near(spectrum.getLowestFrequency(), frequencies[0])
+                  && near(spectrum.getHighestFrequency()
+                          , frequencies[frequency_count - 1])
+                  , QString("%1 to %2").arg(spectrum.getLowestFrequency())
+                    .arg(spectrum.getHighestFrequency()));
+
+    // Through each flux, and between each two without overshooting;
+    for (int i = 0; i < frequency_count; i++)
+    {
+        const double flux = spectrum.evaluate(frequencies[i]);
+        rCheck.verify(QString("spectrum/knot/%1").arg(frequencies[i])
+                      , near(flux, fluxes[i]), QString::number(flux));
+
+        if (i + 1 < frequency_count)
+        {
+            const double low = std::min(fluxes[i], fluxes[i + 1]);
+            const double high = std::max(fluxes[i], fluxes[i + 1]);
+            bool within = true;
+            for (int step = 1; step < 50; step++)
+            {
+                const double freq = frequencies[i] + step
+                        * (frequencies[i + 1] - frequencies[i]) / 50;
+                const double between = spectrum.evaluate(freq);
+                within &= between >= low * (1 - tolerance)
+                        && between <= high * (1 + tolerance);
+            }
+            rCheck.verify(QString("spectrum/between/%1").arg(frequencies[i])
+                          , within);
+        }
+    }
+
+    // A power law beyond either end, with the slope of the end interval;
+    const double below = spectrum.evaluate(100.0);
+    rCheck.verify("spectrum/below", near(below, powerLaw(100.0, 0, 1))
+                  , QString::number(below));
+    const double above = spectrum.evaluate(30000.0);
+    rCheck.verify("spectrum/above"
+                  , near(above, powerLaw(30000.0, frequency_count - 2
+                                         , frequency_count - 1))
+                  , QString::number(above));
+
+    // No flux where the frequency has no finite log;
+    const double invalid[] = { -5.0, 0.0, -0.0, nan, inf, -inf };
+    const int invalidCount = sizeof(invalid) / sizeof(invalid[0]);
+    double flux[invalidCount];
+    spectrum.evaluate(invalid, flux, invalidCount);
+    for (int i = 0; i < invalidCount; i++)
+    {
+        const double single = spectrum.evaluate(invalid[i]);
+        rCheck.verify(QString("spectrum/invalid/%1").arg(invalid[i])
+                      , std::isnan(single) && std::isnan(flux[i])
+                      , QString("%1, %2").arg(single).arg(flux[i]));
+    }
+
+    // The array form agrees with evaluating one frequency at a time;
+    const double channels[] = { 100.0, 245.0, 300.0, 1000.0, 2750.0
+                                , 10000.0, 15400.0, 30000.0 };
+    const int channelCount = sizeof(channels) / sizeof(channels[0]);
+    double channelFlux[channelCount];
+    spectrum.evaluate(channels, channelFlux, channelCount);
+    bool same = true;
+    for (int i = 0; i < channelCount; i++)
+    {
+        same &= channelFlux[i] == spectrum.evaluate(channels[i]);
+    }
+    rCheck.verify("spectrum/array", same);
+}
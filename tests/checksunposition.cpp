@@ -0,0 +1,131 @@
+/*----------------------------------------------------------------------------
+Name         checksunposition.cpp
+
+Purpose      Regression checks of the precision tiers of SunPositionEngine
+             against the worked example of the NREL SPA;
+
+Notes        The SPA example (Reda and Andreas, 2004) is 17 Oct 2003
+             12:30:30 at UTC-7, at 39.742476 N 105.1786 W, 820 mbar and
+             11 C, where the SPA gives a topocentric zenith of 50.11162 and
+             an azimuth of 194.34024 degrees.  The engine takes local time
+             as longitude / 15 hours from UT, so the instant is converted to
+             that.  The precise tier is held to the error measured when it
+             was written, 3 arc seconds in zenith and 20 in azimuth, with a
+             little room; a larger error is a regression;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "checkcases.h"
+#include "sunposition.h" // USES SunPositionEngine and its tiers;
+
+#include <cmath>
+
+namespace
+{
+    // The SPA example's result, in degrees;
+    const double spa_zenith = 50.11162;
+    const double spa_azimuth = 194.34024;
+
+    // Errors allowed the precise tier, in arc seconds;
+    const double zenith_tolerance = 5.0;
+    const double azimuth_tolerance = 25.0;
+
+    // Error allowed the fast tier against the precise tier, in degrees;
+    const double fast_tolerance = 1.5;
+
+    // Returns the site of the SPA example;
+    SunSite spaSite(void)
+    {
+        SunSite site;
+        site.latitudeDeg = 39.742476;
+        site.longitudeDeg = -105.1786;
+        site.pressureMbar = 820.0;
+        site.temperatureC = 11.0;
+        return site;
+    }
+
+    // Describes a position for a failed check;
+    QString describe(const SunPosition& rSun)
+    {
+        return QString("zenith %1, azimuth %2").arg(rSun.zenithDeg, 0, 'f', 6)
+                .arg(rSun.azimuthDeg, 0, 'f', 6);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runSunPositionCases
+
+Purpose      Checks the precise tier against the SPA example, the fast tier
+             against the precise tier, daylight savings time, and that an
+             array of times gives what each time does alone;
+
+Input        rCheck             Records each check;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void checkcases::runSunPositionCases(Check &rCheck)
+{
+    if (!rCheck.isSelected("sunposition"))
+    {
+        return;
+    }
+
+    const SunSite site = spaSite();
+    const double utSeconds = 19.0 * 3600.0 + 30.0 * 60.0 + 30.0;
+    const double localSeconds = utSeconds + 240.0 * site.longitudeDeg;
+
+    const PreciseSunEngine precise(site, 2003, 10, 17);
+    const SunPosition sun = precise.position(false, localSeconds);
+    rCheck.verify("sunposition/spa/zenith"
+                  , fabs(sun.zenithDeg - spa_zenith) * 3600.0
+                    <= zenith_tolerance
+                  , describe(sun));
+    rCheck.verify("sunposition/spa/azimuth"
+                  , fabs(sun.azimuthDeg - spa_azimuth) * 3600.0
+                    <= azimuth_tolerance
+                  , describe(sun));
+    rCheck.verify("sunposition/spa/altitude"
+                  , fabs(sun.altitudeDeg + sun.zenithDeg - 90.0) < 1e-9
+                  , describe(sun));
+
+    // Daylight savings time is an hour later on the clock;
+    const SunPosition summer = precise.position(true, localSeconds + 3600.0);
+    rCheck.verify("sunposition/spa/daylight-savings"
+                  , fabs(summer.zenithDeg - sun.zenithDeg) < 1e-9
+                    && fabs(summer.azimuthDeg - sun.azimuthDeg) < 1e-9
+                  , describe(summer));
+
+    // The fast tier is for planning, within a degree or so;
+    const FastSunEngine fast(site, 2003, 10, 17);
+    const SunPosition rough = fast.position(false, localSeconds);
+    rCheck.verify("sunposition/fast"
+                  , fabs(rough.zenithDeg - sun.zenithDeg) < fast_tolerance
+                    && fabs(rough.azimuthDeg - sun.azimuthDeg)
+                       < fast_tolerance
+                  , describe(rough));
+
+    // An array of times gives the positions of each time alone, to the bit;
+    const int count = 97;
+    double times[count];
+    double azimuth[count];
+    double altitude[count];
+    double zenith[count];
+    double hourAngle[count];
+    for (int i = 0; i < count; i++)
+    {
+        times[i] = i * 900.0;
+    }
+    precise.positions(false, times, count, azimuth, altitude, zenith
+                      , hourAngle);
+    int same = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const SunPosition alone = precise.position(false, times[i]);
+        same += (alone.azimuthDeg == azimuth[i]
+                 && alone.altitudeDeg == altitude[i]
+                 && alone.zenithDeg == zenith[i]
+                 && alone.hourAngleDeg == hourAngle[i]) ? 1 : 0;
+    }
+    rCheck.verify("sunposition/array", same == count
+                  , QString("%1 of %2 the same").arg(same).arg(count));
+}
@@ -0,0 +1,211 @@
+/*----------------------------------------------------------------------------
+Name         checksunscan.cpp
+
+Purpose      Regression checks of the sun scan fit against rasters made from
+             a known beam;
+
+Notes        Each raster is the model SunScan fits, a Gaussian map on a flat
+             baseline, with the map's widths those of the beam smeared by
+             the radio sun as sunscan.cpp takes it.  Without noise the fit
+             must give back the beam it was made from to within rounding;
+             with noise, to within a few of the uncertainties it states.
+             The noise comes from a fixed linear congruential sequence, so
+             every run checks the same raster;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "checkcases.h"
+#include "sunscan.h" // USES SunScan to fit the rasters;
+#include "gotcore.h" // USES gotcore::radioSunDiameter for the maps' widths;
+
+#include <cmath>
+
+namespace
+{
+    // The beam, sun, and sky of every raster;
+    const double freq_mhz = 2300.0;
+    const double azimuth_beamwidth = 1.6;
+    const double elevation_beamwidth = 1.2;
+    const double azimuth_offset = 0.3;
+    const double elevation_offset = -0.15;
+    const double sun_elevation = 40.0;
+    const double baseline_db = 10.0;
+    const double rise_db = 8.0;
+
+    // Cells on each side of the raster, and its half width in map widths;
+    const int raster_cells = 31;
+    const double raster_reach = 2.5;
+
+    // Errors allowed a noiseless fit, in degrees and dB;
+    const double exact_tolerance = 1e-6;
+
+    // Noise added to each reading, as a fraction of the rise in power, and
+    // how many stated uncertainties the noisy beamwidth may be out by;
+    const double noise_fraction = 0.02;
+    const double noise_sigmas = 4.0;
+
+    // Returns the next of a fixed sequence of numbers with a mean of 0 and
+    // a standard deviation of 1, as the sum of twelve uniform draws;
+    double nextNoise(unsigned int& rState)
+    {
+        double sum = 0;
+        for (int i = 0; i < 12; i++)
+        {
+            rState = rState * 1664525u + 1013904223u;
+            sum += rState / 4294967296.0;
+        }
+        return sum - 6.0;
+    }
+
+    // Returns a raster of the beam above, with noise of rNoise times the
+    // rise in power if rNoise is not 0;
+    SunScanRaster makeRaster(const double& rNoise)
+    {
+        const double sunDiameter = gotcore::radioSunDiameter(freq_mhz);
+        const double sunSquared = 0.5 * log(2.0) * sunDiameter * sunDiameter;
+        const double mapAzimuth = sqrt(azimuth_beamwidth * azimuth_beamwidth
+                                       + sunSquared);
+        const double mapElevation = sqrt(elevation_beamwidth
+                                         * elevation_beamwidth + sunSquared);
+        const double cosElevation = cos(sun_elevation * M_PI / 180.0);
+
+        SunScanRaster raster;
+        raster.sunElevationDeg = sun_elevation;
+        for (int i = 0; i < raster_cells; i++)
+        {
+            const double step = raster_reach
+                    * (2.0 * i / (raster_cells - 1) - 1.0);
+            raster.azimuthOffsetsDeg.push_back(step * mapAzimuth
+                                               / cosElevation);
+            raster.elevationOffsetsDeg.push_back(step * mapElevation);
+        }
+
+        const double baseline = pow(10.0, baseline_db / 10.0);
+        const double rise = baseline * (pow(10.0, rise_db / 10.0) - 1.0);
+        unsigned int state = 2026;
+        for (int row = 0; row < raster_cells; row++)
+        {
+            const double y = (raster.elevationOffsetsDeg[row]
+                              - elevation_offset) / mapElevation;
+            for (int column = 0; column < raster_cells; column++)
+            {
+                const double x = (raster.azimuthOffsetsDeg[column]
+                                  - azimuth_offset) * cosElevation
+                        / mapAzimuth;
+                double power = baseline + rise
+                        * exp(-4.0 * log(2.0) * (x * x + y * y));
+                if (rNoise != 0)
+                {
+                    power += rNoise * rise * nextNoise(state);
+                }
+                raster.powerDb.push_back(10.0 * log10(power));
+            }
+        }
+        return raster;
+    }
+
+    // Describes a fit for a failed check;
+    QString describe(const SunScanFit& rFit)
+    {
+        return QString("beam %1 x %2 +- %3, offset %4, %5, rise %6 dB")
+                .arg(rFit.azimuthBeamwidthDeg, 0, 'g', 9)
+                .arg(rFit.elevationBeamwidthDeg, 0, 'g', 9)
+                .arg(rFit.beamwidthUncertaintyDeg, 0, 'g', 3)
+                .arg(rFit.azimuthOffsetDeg, 0, 'g', 9)
+                .arg(rFit.elevationOffsetDeg, 0, 'g', 9)
+                .arg(rFit.sunNoiseRiseDb, 0, 'g', 9);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runSunScanCases
+
+Purpose      Checks that the sun scan fit recovers a known beam, offset, and
+             rise, with and without noise, that it gives the same fit on a
+             pool as on one thread, and that it refuses a raster with no
+             sun in it;
+
+Input        rCheck             Records each check;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void checkcases::runSunScanCases(Check &rCheck)
+{
+    if (!rCheck.isSelected("sunscan"))
+    {
+        return;
+    }
+
+    const double beam = sqrt(azimuth_beamwidth * elevation_beamwidth);
+
+    // A noiseless raster gives back exactly what it was made from;
+    const SunScanRaster exact = makeRaster(0);
+    SunScan serial;
+    SunScanFit fit;
+    const bool fitted = serial.fit(exact, freq_mhz, fit);
+    rCheck.verify("sunscan/exact/fitted", fitted, serial.getLastError());
+    rCheck.verify("sunscan/exact/beam"
+                  , fitted
+                    && fabs(fit.azimuthBeamwidthDeg - azimuth_beamwidth)
+                       < exact_tolerance
+                    && fabs(fit.elevationBeamwidthDeg - elevation_beamwidth)
+                       < exact_tolerance
+                    && fabs(fit.beamwidthDeg - beam) < exact_tolerance
+                  , describe(fit));
+    rCheck.verify("sunscan/exact/offset"
+                  , fitted
+                    && fabs(fit.azimuthOffsetDeg - azimuth_offset)
+                       < exact_tolerance
+                    && fabs(fit.elevationOffsetDeg - elevation_offset)
+                       < exact_tolerance
+                  , describe(fit));
+    rCheck.verify("sunscan/exact/levels"
+                  , fitted
+                    && fabs(fit.baselineDb - baseline_db) < exact_tolerance
+                    && fabs(fit.sunNoiseRiseDb - rise_db) < exact_tolerance
+                    && fit.rmsResidual < exact_tolerance
+                  , describe(fit));
+
+    // A noisy one gives it back to within the uncertainty the fit states,
+    // which must itself be neither nothing nor a sizeable part of the beam;
+    const SunScanRaster noisy = makeRaster(noise_fraction);
+    SunScanFit rough;
+    const bool roughFitted = serial.fit(noisy, freq_mhz, rough);
+    rCheck.verify("sunscan/noisy/beam"
+                  , roughFitted && rough.beamwidthUncertaintyDeg > 0
+                    && rough.beamwidthUncertaintyDeg < 0.05 * beam
+                    && fabs(rough.beamwidthDeg - beam)
+                       < noise_sigmas * rough.beamwidthUncertaintyDeg
+                  , roughFitted ? describe(rough) : serial.getLastError());
+    rCheck.verify("sunscan/noisy/offset"
+                  , roughFitted
+                    && fabs(rough.azimuthOffsetDeg - azimuth_offset)
+                       < 0.02 * azimuth_beamwidth
+                    && fabs(rough.elevationOffsetDeg - elevation_offset)
+                       < 0.02 * elevation_beamwidth
+                  , describe(rough));
+
+    // The pool sums in the same order as one thread, so to the bit;
+    WorkStealingPool pool(4);
+    SunScan pooled(&pool);
+    SunScanFit shared;
+    const bool sharedFitted = pooled.fit(noisy, freq_mhz, shared);
+    rCheck.verify("sunscan/pool"
+                  , sharedFitted && roughFitted
+                    && shared.beamwidthDeg == rough.beamwidthDeg
+                    && shared.azimuthOffsetDeg == rough.azimuthOffsetDeg
+                    && shared.elevationOffsetDeg == rough.elevationOffsetDeg
+                    && shared.peakDb == rough.peakDb
+                    && shared.iterations == rough.iterations
+                  , describe(shared));
+
+    // A raster with no sun in it is refused rather than fitted;
+    SunScanRaster flat = exact;
+    for (size_t i = 0; i < flat.powerDb.size(); i++)
+    {
+        flat.powerDb[i] = baseline_db;
+    }
+    SunScanFit none;
+    rCheck.verify("sunscan/flat", !serial.fit(flat, freq_mhz, none)
+                  && !serial.getLastError().isEmpty());
+}
@@ -0,0 +1,183 @@
+/*----------------------------------------------------------------------------
+Name         checktimezone.cpp
+
+Purpose      Regression checks of TimeZoneTable across the changes of offset
+             of a northern and a southern zone;
+
+Notes        In 2024 Los Angeles went from PST (UTC-8) to PDT (UTC-7) at
+             02:00 local on 10 March, 10:00 UTC, and back at 02:00 local on
+             3 November, 09:00 UTC.  Sydney went from AEDT (UTC+11) to AEST
+             (UTC+10) at 03:00 local on 7 April, 16:00 UTC on the 6th, and
+             back at 02:00 local on 6 October, 16:00 UTC on the 5th, so its
+             year begins in summer time.  Local 02:30 on 10 March did not
+             happen in Los Angeles, and local 01:30 on 3 November happened
+             twice;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "checkcases.h"
+#include "timezonetable.h" // USES TimeZoneTable, the subject of the checks;
+
+#include <vector>
+
+namespace
+{
+    // Offsets of the two zones, in seconds;
+    const int pst = -8 * 3600;
+    const int pdt = -7 * 3600;
+    const int aest = 10 * 3600;
+    const int aedt = 11 * 3600;
+
+    // Returns seconds since 1970 UTC of a date and time of day in UTC;
+    double utc(const int& rMonth
+               , const int& rDay
+               , const int& rHour
+               , const int& rMinute)
+    {
+        return TimeZoneTable::localSeconds(2024, rMonth, rDay
+                                           , rHour * 3600.0 + rMinute * 60.0);
+    }
+
+    // Describes a pair of times for a failed check;
+    QString describe(const double& rGot, const double& rExpected)
+    {
+        return QString("%1, expected %2").arg(rGot, 0, 'f', 0)
+                .arg(rExpected, 0, 'f', 0);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runTimeZoneCases
+
+Purpose      Checks the offsets either side of each change, local times in
+             the gap and the overlap, round trips through local time, and
+             that the array conversions give what the single ones do;
+
+Input        rCheck             Records each check;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void checkcases::runTimeZoneCases(Check &rCheck)
+{
+    if (!rCheck.isSelected("timezone"))
+    {
+        return;
+    }
+
+    TimeZoneTable losAngeles;
+    const bool loaded = losAngeles.load("America/Los_Angeles", 2024, 2024);
+    rCheck.verify("timezone/load", loaded && losAngeles.getTransitionCount()
+                  == 2, losAngeles.getLastError());
+
+    TimeZoneTable unknown;
+    rCheck.verify("timezone/load/unknown"
+                  , !unknown.load("Nowhere/Atlantis", 2024, 2024)
+                    && !unknown.getLastError().isEmpty()
+                    && unknown.offsetAt(utc(6, 1, 0, 0)) == 0);
+    rCheck.verify("timezone/load/backwards"
+                  , !unknown.load("America/Los_Angeles", 2025, 2024));
+
+    // The offset changes at the transition and not a second either side;
+    const double spring = utc(3, 10, 10, 0);
+    const double autumn = utc(11, 3, 9, 0);
+    rCheck.verify("timezone/offset"
+                  , losAngeles.offsetAt(spring - 1) == pst
+                    && losAngeles.offsetAt(spring) == pdt
+                    && losAngeles.offsetAt(autumn - 1) == pdt
+                    && losAngeles.offsetAt(autumn) == pst
+                    && losAngeles.offsetAt(utc(1, 1, 0, 0)) == pst
+                    && losAngeles.offsetAt(utc(12, 31, 23, 59)) == pst);
+
+    // Either side of the gap, the old and new offsets;
+    const double beforeGap = losAngeles.toUtc(utc(3, 10, 2, 0) - 1);
+    const double afterGap = losAngeles.toUtc(utc(3, 10, 3, 0));
+    rCheck.verify("timezone/gap/edges"
+                  , beforeGap == spring - 1 && afterGap == spring
+                  , describe(afterGap, spring));
+
+    // A local time in the gap is moved forward by the gap, to 03:30 PDT;
+    const double inGap = losAngeles.toUtc(utc(3, 10, 2, 30));
+    rCheck.verify("timezone/gap", inGap == utc(3, 10, 10, 30)
+                  , describe(inGap, utc(3, 10, 10, 30)));
+    rCheck.verify("timezone/gap/local"
+                  , losAngeles.toLocal(inGap) == utc(3, 10, 3, 30));
+
+    // A repeated local time is the first of the two, in PDT, and the hour
+    // after the overlap is PST;
+    const double inOverlap = losAngeles.toUtc(utc(11, 3, 1, 30));
+    rCheck.verify("timezone/overlap", inOverlap == utc(11, 3, 8, 30)
+                  , describe(inOverlap, utc(11, 3, 8, 30)));
+    const double afterOverlap = losAngeles.toUtc(utc(11, 3, 2, 0));
+    rCheck.verify("timezone/overlap/edges"
+                  , afterOverlap == utc(11, 3, 10, 0)
+                    && losAngeles.toLocal(autumn) == utc(11, 3, 1, 0)
+                    && losAngeles.toLocal(autumn - 1) == utc(11, 3, 2, 0) - 1
+                  , describe(afterOverlap, utc(11, 3, 10, 0)));
+
+    // Every quarter hour of the year goes to local time and back, and the
+    // array conversions, run forward and then backward, agree with it;
+    std::vector<double> instants;
+    for (double t = utc(1, 1, 0, 0); t < utc(12, 31, 0, 0); t += 900.0)
+    {
+        instants.push_back(t);
+    }
+    const size_t count = instants.size();
+    std::vector<double> local(count);
+    std::vector<double> back(count);
+    losAngeles.toLocal(&instants[0], &local[0], count);
+    losAngeles.toUtc(&local[0], &back[0], count);
+
+    size_t same = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const double single = losAngeles.toLocal(instants[i]);
+        // Local times in the second pass of the overlap go to the first;
+        const bool repeated = (instants[i] >= autumn
+                               && instants[i] < autumn + 3600.0);
+        const double expected = repeated ? instants[i] - 3600.0
+                                         : instants[i];
+        same += (single == local[i] && back[i] == expected
+                 && losAngeles.toUtc(local[i]) == expected) ? 1 : 0;
+    }
+    rCheck.verify("timezone/round-trip", same == count
+                  , QString("%1 of %2 the same").arg(same).arg(count));
+
+    std::vector<double> reversed(local.rbegin(), local.rend());
+    std::vector<double> reversedBack(count);
+    losAngeles.toUtc(&reversed[0], &reversedBack[0], count);
+    same = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        same += (reversedBack[i] == back[count - 1 - i]) ? 1 : 0;
+    }
+    rCheck.verify("timezone/reversed", same == count
+                  , QString("%1 of %2 the same").arg(same).arg(count));
+
+    // Converted in place;
+    std::vector<double> inPlace(local);
+    losAngeles.toUtc(&inPlace[0], &inPlace[0], count);
+    rCheck.verify("timezone/in-place", inPlace == back);
+
+    // A southern zone begins the year in summer time;
+    TimeZoneTable sydney;
+    const bool southern = sydney.load("Australia/Sydney", 2024, 2024);
+    rCheck.verify("timezone/southern"
+                  , southern && sydney.getTransitionCount() == 2
+                    && sydney.offsetAt(utc(1, 1, 0, 0)) == aedt
+                    && sydney.offsetAt(utc(4, 6, 16, 0) - 1) == aedt
+                    && sydney.offsetAt(utc(4, 6, 16, 0)) == aest
+                    && sydney.offsetAt(utc(10, 5, 16, 0) - 1) == aest
+                    && sydney.offsetAt(utc(10, 5, 16, 0)) == aedt
+                  , sydney.getLastError());
+    rCheck.verify("timezone/southern/gap"
+                  , sydney.toUtc(utc(10, 6, 2, 30)) == utc(10, 5, 16, 30)
+                    && sydney.toUtc(utc(4, 7, 2, 30)) == utc(4, 6, 15, 30));
+
+    // A fixed offset has no transitions, and is used at every instant;
+    TimeZoneTable fixed;
+    fixed.setFixedOffset(5 * 3600 + 1800);
+    rCheck.verify("timezone/fixed"
+                  , fixed.getTransitionCount() == 0
+                    && fixed.toLocal(spring) == spring + 19800.0
+                    && fixed.toUtc(spring) == spring - 19800.0);
+}
@@ -0,0 +1,221 @@
+/*----------------------------------------------------------------------------
+Name         checktracker.cpp
+
+Purpose      Regression checks of SunTracker's setpoints, and of a
+             SimulatedController following them while the tracker runs;
+
+Notes        The tracker runs on a simulated clock set to noon in Los
+             Angeles on the June solstice, so the sun is high whatever the
+             time the check is run.  The running checks take about a second,
+             and only hold the threads to what any machine manages easily:
+             the controllers' errors are those of a servo following the
+             extrapolated setpoints, a small fraction of what a lost or torn
+             setpoint would give, and the tracker need only keep to half its
+             rate while a controller stalls on every read;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "checkcases.h"
+#include "suntracker.h" // USES SunTracker, the subject of the checks;
+#include "simulatedcontroller.h" // USES SimulatedController to follow it;
+#include "solarmath.h" // USES solarmath::epochDay for the instants;
+
+#include <chrono> // USES std::chrono::steady_clock to time the run;
+#include <thread> // USES std::this_thread to wait on the threads;
+#include <cmath>
+
+namespace
+{
+    // Site and instant of the running checks: Los Angeles at noon on the
+    // June solstice, 20:00 UTC;
+    const double site_latitude = 34.05;
+    const double site_longitude = -118.25;
+    const double noon_hour = 20.0;
+
+    // Rate of the running tracker, and how long the controllers follow it;
+    const double tracker_rate_hz = 100.0;
+    const int run_milliseconds = 1000;
+
+    // Stall of the slow controller after each read, in seconds;
+    const double stall_seconds = 0.05;
+
+    // Largest pointing errors allowed a controller, in degrees;
+    const double max_rms_error = 1e-4;
+    const double max_error = 1e-3;
+
+    // Offsets set while the tracker runs, in degrees;
+    const double azimuth_offset = 1.25;
+    const double elevation_offset = -0.5;
+
+    // Returns seconds since 1970 UTC of an hour of the June solstice, 2024;
+    double solstice(const double& rHour)
+    {
+        return solarmath::epochDay(2024, 6, 21) * solarmath::seconds_per_day
+                + rHour * 3600.0;
+    }
+
+    // Waits until the tracker has published rCount setpoints, or a second
+    // has passed, returning the number published;
+    unsigned long long waitFor(const SunTracker& rTracker
+                               , const unsigned long long& rCount)
+    {
+        TrackingSetpoint setpoint;
+        unsigned long long count = rTracker.latest(setpoint);
+        for (int i = 0; i < 1000 && count < rCount; i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            count = rTracker.latest(setpoint);
+        }
+        return count;
+    }
+
+    // Describes a controller's statistics for a failed check;
+    QString describe(const ControllerStatistics& rStats)
+    {
+        return QString("%1 cycles, %2 setpoints, %3 stale, age %4 s"
+                       ", rms %5, max %6 degrees")
+                .arg(rStats.cycles).arg(rStats.setpoints)
+                .arg(rStats.staleCycles)
+                .arg(rStats.maxSetpointAgeSeconds, 0, 'g', 3)
+                .arg(rStats.rmsErrorDeg, 0, 'g', 3)
+                .arg(rStats.maxErrorDeg, 0, 'g', 3);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runTrackerCases
+
+Purpose      Checks the tracker's settings, that its rates and accelerations
+             extrapolate to its later positions, that azimuth rates do not
+             jump crossing north, and that controllers follow the running
+             tracker closely without holding it up, offsets included;
+
+Input        rCheck             Records each check;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void checkcases::runTrackerCases(Check &rCheck)
+{
+    if (!rCheck.isSelected("tracker"))
+    {
+        return;
+    }
+
+    SunTracker tracker;
+    rCheck.verify("tracker/rate"
+                  , !tracker.setRateHz(SunTracker::min_rate_hz - 1)
+                    && !tracker.getLastError().isEmpty()
+                    && !tracker.setRateHz(SunTracker::max_rate_hz + 1)
+                    && tracker.setRateHz(tracker_rate_hz)
+                    && tracker.getLastError().isEmpty());
+
+    // Half a second on, the rates and accelerations give the position;
+    tracker.setSite(site_latitude, site_longitude);
+    const double noon = solstice(noon_hour);
+    TrackingSetpoint now;
+    TrackingSetpoint later;
+    tracker.setpointAt(noon, now);
+    tracker.setpointAt(noon + 0.5, later);
+    const double azimuthAhead = now.azimuthDeg
+            + now.azimuthRateDegPerSec * 0.5
+            + now.azimuthAccelDegPerSec2 * 0.125;
+    const double elevationAhead = now.elevationDeg
+            + now.elevationRateDegPerSec * 0.5
+            + now.elevationAccelDegPerSec2 * 0.125;
+    rCheck.verify("tracker/setpoint/rates"
+                  , fabs(azimuthAhead - later.azimuthDeg) < 1e-7
+                    && fabs(elevationAhead - later.elevationDeg) < 1e-7
+                  , QString("%1, %2").arg(azimuthAhead - later.azimuthDeg)
+                    .arg(elevationAhead - later.elevationDeg));
+
+    // Above the arctic circle the midnight sun crosses north, where the
+    // azimuth wraps, at a steady rate of about 14 degrees an hour.  Every
+    // second is tried, so some setpoint straddles the wrap;
+    SunTracker arctic;
+    arctic.setSite(70.0, 0.0);
+    double lowestRate = 1.0;
+    double highestRate = -1.0;
+    bool wrapped = false;
+    for (double t = solstice(-0.5); t <= solstice(0.5); t += 1.0)
+    {
+        TrackingSetpoint setpoint;
+        arctic.setpointAt(t, setpoint);
+        lowestRate = qMin(lowestRate, setpoint.azimuthRateDegPerSec);
+        highestRate = qMax(highestRate, setpoint.azimuthRateDegPerSec);
+        wrapped |= (setpoint.azimuthDeg < 1.0);
+    }
+    rCheck.verify("tracker/setpoint/north"
+                  , wrapped && lowestRate > 0.003 && highestRate < 0.005
+                    && highestRate - lowestRate < 1e-5
+                  , QString("rates %1 to %2").arg(lowestRate, 0, 'g', 9)
+                    .arg(highestRate, 0, 'g', 9));
+
+    TrackingSetpoint none;
+    rCheck.verify("tracker/latest/none", tracker.latest(none) == 0);
+
+    // A controller, and one which stalls on every read, follow the tracker;
+    tracker.setSimulatedTime(noon);
+    SimulatedController controller(&tracker);
+    SimulatedController stalled(&tracker);
+    stalled.setStallSeconds(stall_seconds);
+
+    const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    tracker.start(QThread::TimeCriticalPriority);
+    controller.start();
+    stalled.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(run_milliseconds));
+
+    rCheck.verify("tracker/rate/running", !tracker.setRateHz(10.0));
+
+    controller.stop();
+    stalled.stop();
+    const TrackingStatistics tracking = tracker.statistics();
+    const double elapsed = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+
+    const ControllerStatistics following = controller.statistics();
+    rCheck.verify("tracker/controller"
+                  , following.cycles > 0 && following.setpoints > 1
+                    && following.rmsErrorDeg < max_rms_error
+                    && following.maxErrorDeg < max_error
+                  , describe(following));
+
+    // The stalled controller sees a new setpoint on nearly every read, so
+    // it has not held up the tracker, and follows as closely as the other;
+    const ControllerStatistics slow = stalled.statistics();
+    rCheck.verify("tracker/controller/stalled"
+                  , slow.cycles > 0 && 2 * slow.setpoints >= slow.cycles
+                    && slow.rmsErrorDeg < max_rms_error
+                    && slow.maxErrorDeg < max_error
+                  , describe(slow));
+
+    rCheck.verify("tracker/periods"
+                  , tracking.periods >= 0.5 * tracker_rate_hz * elapsed
+                    && tracking.periods <= tracker_rate_hz * elapsed + 1
+                  , QString("%1 periods, %2 missed, in %3 s")
+                    .arg(tracking.periods).arg(tracking.deadlineMisses)
+                    .arg(elapsed, 0, 'f', 3));
+
+    // Offsets are added from the next period on, and the last setpoint
+    // stays readable once stopped;
+    TrackingSetpoint offset;
+    const unsigned long long published = tracker.latest(offset);
+    tracker.setOffsets(azimuth_offset, elevation_offset);
+    waitFor(tracker, published + 2);
+    tracker.stop();
+    const unsigned long long count = tracker.latest(offset);
+
+    TrackingSetpoint bare;
+    tracker.setpointAt(offset.utcSeconds, bare);
+    rCheck.verify("tracker/offsets"
+                  , count >= published + 2
+                    && fabs(offset.azimuthDeg - bare.azimuthDeg
+                            - azimuth_offset) < 1e-9
+                    && fabs(offset.elevationDeg - bare.elevationDeg
+                            - elevation_offset) < 1e-9
+                    && offset.azimuthRateDegPerSec
+                       == bare.azimuthRateDegPerSec
+                  , QString("%1, %2").arg(offset.azimuthDeg - bare.azimuthDeg)
+                    .arg(offset.elevationDeg - bare.elevationDeg));
+}
@@ -0,0 +1,171 @@
+/*----------------------------------------------------------------------------
+Name         checkuncertainty.cpp
+
+Purpose      Regression checks of the Monte Carlo estimate of the uncertainty
+             of a G/T, and of got-cli's uncertainty columns;
+
+Notes        Results are compared exactly, as the same seed and number of
+             draws must give the same result to the bit, however many
+             workers made the draws.  The draw counts are odd, and not whole
+             blocks or batches, so the last batch has an odd number of draws;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "checkcases.h"
+#include "gotuncertainty.h" // USES GotUncertainty, the engine under test;
+#include "gotcore.h" // USES gotcore::computeGotAtFlux for the expected G/T;
+#include "sessionprocessor.h" // USES SessionProcessor for got-cli's output;
+
+#include <cmath>
+
+namespace
+{
+    // Inputs of a G/T with a small error in each;
+    GotUncertaintyInputs buildInputs(void)
+    {
+        GotUncertaintyInputs inputs;
+        inputs.operatingFrequencyMHz = 2300.0;
+        inputs.solarFluxSfu = 70.0;
+        inputs.solarFluxUncertainty = 0.05;
+        inputs.beamwidthDeg = 1.5;
+        inputs.beamwidthUncertaintyDeg = 0.02;
+        inputs.hotMeanDb = 12.0;
+        inputs.hotStandardErrorDb = 0.05;
+        inputs.coldMeanDb = 2.0;
+        inputs.coldStandardErrorDb = 0.05;
+        return inputs;
+    }
+
+    // Whether two results are the same to the bit;
+    bool same(const GotUncertaintyResult& rA, const GotUncertaintyResult& rB)
+    {
+        return rA.draws == rB.draws && rA.rejected == rB.rejected
+                && rA.meanDb == rB.meanDb
+                && rA.standardDeviationDb == rB.standardDeviationDb
+                && rA.percentileValuesDb == rB.percentileValuesDb;
+    }
+
+    // Describes a result for a failed check;
+    QString describe(const GotUncertaintyResult& rResult)
+    {
+        QString text = QString("%1 draws, %2 rejected, mean %3, sd %4")
+                .arg(rResult.draws).arg(rResult.rejected)
+                .arg(rResult.meanDb, 0, 'g', 17)
+                .arg(rResult.standardDeviationDb, 0, 'g', 17);
+        for (size_t i = 0; i < rResult.percentileValuesDb.size(); i++)
+        {
+            text += QString(", %1").arg(rResult.percentileValuesDb[i], 0, 'g'
+                                        , 17);
+        }
+        return text;
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         runUncertaintyCases
+
+Purpose      Checks the Monte Carlo estimate is the same for the same seed,
+             with or without a pool, centres on the G/T of the inputs, has
+             no spread when the inputs have no error, and is written by
+             got-cli the same way on every run;
+
+Input        rCheck             Records each check;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void checkcases::runUncertaintyCases(Check &rCheck)
+{
+    if (!rCheck.isSelected("uncertainty"))
+    {
+        return;
+    }
+
+    const GotUncertaintyInputs inputs = buildInputs();
+    const unsigned long long draws = 3 * GotUncertainty::draws_per_block
+            + 1001;
+
+    // The same seed gives the same result, run serially or on a pool;
+    GotUncertainty serial(0);
+    serial.setSeed(42);
+    const GotUncertaintyResult first = serial.estimate(inputs, draws);
+    const GotUncertaintyResult again = serial.estimate(inputs, draws);
+    rCheck.verify("uncertainty/seed/repeat", same(first, again)
+                  , describe(first) + " against " + describe(again));
+
+    WorkStealingPool pool(3);
+    GotUncertainty pooled(&pool);
+    pooled.setSeed(42);
+    const GotUncertaintyResult onPool = pooled.estimate(inputs, draws);
+    rCheck.verify("uncertainty/seed/pool", same(first, onPool)
+                  , describe(first) + " against " + describe(onPool));
+
+    serial.setSeed(43);
+    const GotUncertaintyResult other = serial.estimate(inputs, draws);
+    rCheck.verify("uncertainty/seed/other", other.meanDb != first.meanDb
+                  , describe(other));
+
+    // Small errors leave the G/T about where the inputs put it;
+    gotcore::GotInputs core;
+    core.operatingFrequencyMHz = inputs.operatingFrequencyMHz;
+    core.beamwidthDeg = inputs.beamwidthDeg;
+    core.hotDb = inputs.hotMeanDb;
+    core.coldDb = inputs.coldMeanDb;
+    const double got = gotcore::computeGotAtFlux(core, inputs.solarFluxSfu)
+            .gotDb;
+    rCheck.verify("uncertainty/centre"
+                  , first.draws == draws && first.rejected == 0
+                    && fabs(first.meanDb - got) < 0.05
+                    && first.standardDeviationDb > 0.1
+                    && first.standardDeviationDb < 0.5
+                    && first.percentileValuesDb.size() == 3
+                    && first.percentileValuesDb[0] < got
+                    && first.percentileValuesDb[2] > got
+                  , QString("G/T %1; ").arg(got) + describe(first));
+
+    // With no error in any input, every draw is the G/T itself;
+    GotUncertaintyInputs exact = inputs;
+    exact.solarFluxUncertainty = 0;
+    exact.beamwidthUncertaintyDeg = 0;
+    exact.hotStandardErrorDb = 0;
+    exact.coldStandardErrorDb = 0;
+    const GotUncertaintyResult none = serial.estimate(exact, 1001);
+    rCheck.verify("uncertainty/exact"
+                  , none.rejected == 0
+                    && fabs(none.meanDb - got) < 1e-9
+                    && none.standardDeviationDb < 1e-9
+                    && fabs(none.percentileValuesDb[0] - got) < 1e-9
+                    && fabs(none.percentileValuesDb[2] - got) < 1e-9
+                  , QString("G/T %1; ").arg(got) + describe(none));
+
+    // No sun noise rise on average, so about half the draws have none;
+    GotUncertaintyInputs flat = inputs;
+    flat.hotMeanDb = flat.coldMeanDb;
+    const GotUncertaintyResult rejected = serial.estimate(flat, draws);
+    rCheck.verify("uncertainty/rejected"
+                  , rejected.rejected > draws * 4 / 10
+                    && rejected.rejected < draws * 6 / 10
+                  , describe(rejected));
+
+    // got-cli writes the spread after the G/T, the same on every run;
+    SessionProcessor processor(SessionProcessor::JsonLines
+                               , SessionProcessor::Csv);
+    processor.setUncertainty(1001, 0.05, 0.02, 7);
+    const QString session = "{\"id\":\"a\",\"frequency\":2300,"
+                            "\"beamwidth\":1.5,\"flux_low\":60,"
+                            "\"flux_high\":80,\"hot\":[12,12.1,11.9],"
+                            "\"cold\":[2,2.1,1.9]}";
+    bool failedOnce = true;
+    bool failedTwice = true;
+    const QString once = processor.processLine(session, failedOnce);
+    const QString twice = processor.processLine(session, failedTwice);
+    const QStringList fields = once.split(',');
+    rCheck.verify("uncertainty/cli/repeat"
+                  , !failedOnce && !failedTwice && once == twice
+                  , once + " against " + twice);
+    rCheck.verify("uncertainty/cli/columns"
+                  , fields.size() == 11 && fields.at(10).isEmpty()
+                    && fields.at(7).toDouble() > 0
+                    && fields.at(8).toDouble() < fields.at(6).toDouble()
+                    && fields.at(9).toDouble() > fields.at(6).toDouble()
+                  , once);
+}
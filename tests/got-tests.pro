@@ -0,0 +1,47 @@
+#-------------------------------------------------
+#
+# Regression checks of the file formats, parsers,
+# and catalogs.  Links QtCore only;
+#
+#-------------------------------------------------
+
+QT       += core concurrent sql
+QT       -= gui
+
+TARGET = got-tests
+TEMPLATE = app
+
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+include(../calc.pri)
+
+INCLUDEPATH += ../cli \
+    ../daemon
+
+SOURCES += main.cpp \
+    check.cpp \
+    checksessions.cpp \
+    checkflux.cpp \
+    checkspectrum.cpp \
+    checkfastmath.cpp \
+    checksunposition.cpp \
+    checksunscan.cpp \
+    checktimezone.cpp \
+    checktracker.cpp \
+    checkseqlock.cpp \
+    checkuncertainty.cpp \
+    checkcapture.cpp \
+    checkprotocol.cpp \
+    ../cli/sessionprocessor.cpp \
+    ../sessioncatalog.cpp \
+    ../daemon/queryprotocol.cpp
+
+HEADERS += check.h \
+    checkcases.h \
+    ../cli/sessionprocessor.h \
+    ../sessioncatalog.h \
+    ../daemon/queryprotocol.h
+
+RESOURCES += \
+    checkdata.qrc
@@ -0,0 +1,65 @@
+/*----------------------------------------------------------------------------
+Name         main.cpp
+
+Purpose      Runs the regression checks of the file formats, parsers, and
+             catalogs, and exits with a failure status if any did not hold;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include <QCoreApplication> // USES QCoreApplication for the argument list;
+#include <QCommandLineParser> // USES QCommandLineParser to read arguments;
+#include <QTemporaryDir> // USES QTemporaryDir for scratch files;
+#include <QTextStream>
+#include "check.h"
+#include "checkcases.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("got-tests");
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+                "Checks the file formats, parsers, and catalogs against "
+                "known inputs, and lists any checks which fail.");
+    parser.addHelpOption();
+
+    QCommandLineOption filterOption(QStringList() << "filter"
+                                    , "Only run groups whose names match."
+                                    , "regexp", ".*");
+    parser.addOption(filterOption);
+    parser.process(app);
+
+    QTemporaryDir directory;
+    if (!directory.isValid())
+    {
+        err << "Unable to create a scratch directory" << '\n';
+        return 1;
+    }
+
+    Check check;
+    check.setFilter(parser.value(filterOption));
+    check.setDirectory(directory.path());
+
+    checkcases::runSessionCases(check);
+    checkcases::runFluxCases(check);
+    checkcases::runSpectrumCases(check);
+    checkcases::runFastMathCases(check);
+    checkcases::runSunPositionCases(check);
+    checkcases::runSunScanCases(check);
+    checkcases::runTimeZoneCases(check);
+    checkcases::runTrackerCases(check);
+    checkcases::runSeqLockCases(check);
+    checkcases::runUncertaintyCases(check);
+    checkcases::runCaptureCases(check);
+    checkcases::runProtocolCases(check);
+
+    const int failures = check.getFailures().size();
+    out << check.getCheckCount() << " checks, " << failures << " failed"
+        << '\n';
+
+    return (failures == 0) ? 0 : 1;
+}
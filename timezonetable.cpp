@@ -0,0 +1,347 @@
+/*----------------------------------------------------------------------------
+Name         timezonetable.cpp
+
+Purpose      Table of the UTC offsets of a time zone and the instants at which
+             they change, built once so that local times may be converted to
+             and from UTC in bulk without a QDateTime per time;
+
+Notes        Times are doubles of seconds since 1970-01-01 00:00, in UTC or in
+             local time, so a conversion is a lookup and an addition.
+             Lookups start from the period of the one before, so a run of
+             times in order costs a comparison or two each, and only a time
+             out of order is searched for;
+
+             Before the first year of the table the first offset is used,
+             and after the last year the last offset;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "timezonetable.h"
+
+#include "solarmath.h" // USES solarmath::epochDay to count days;
+#include <QTimeZone> // USES QTimeZone for the zone's transitions;
+#include <QDateTime>
+#include <algorithm> // USES std::upper_bound;
+
+/*----------------------------------------------------------------------------
+Name         TimeZoneTable
+
+Purpose      Constructor, of UTC;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+TimeZoneTable::TimeZoneTable()
+{
+    mOffsets.push_back(0);
+}
+
+/*----------------------------------------------------------------------------
+Name         load
+
+Purpose      Builds the table of a time zone for a span of years;
+
+Input        rIanaId            IANA name of the zone, e.g.
+                                "America/Los_Angeles";
+             rFirstYear         First year to hold the transitions of;
+             rLastYear          Last year to hold the transitions of;
+
+Returns      bool               true -  If the table was built;
+                                false - If not, and the table is unchanged;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool TimeZoneTable::load(const QByteArray &rIanaId
+                         , const int &rFirstYear
+                         , const int &rLastYear)
+{
+    const QTimeZone zone(rIanaId);
+    if (!zone.isValid())
+    {
+        mLastError = "Unknown time zone " + QString::fromLatin1(rIanaId);
+        return false;
+    }
+
+    if (rLastYear < rFirstYear)
+    {
+        mLastError = QString("The time zone table's years run backwards,"
+                             " from %1 to %2").arg(rFirstYear).arg(rLastYear);
+        return false;
+    }
+
+    const QDateTime from(QDate(rFirstYear, 1, 1), QTime(0, 0), Qt::UTC);
+    const QDateTime to(QDate(rLastYear + 1, 1, 1), QTime(0, 0), Qt::UTC);
+
+    mTransitions.clear();
+    mOffsets.clear();
+    mOffsets.push_back(zone.offsetFromUtc(from));
+
+    const QTimeZone::OffsetDataList transitions = zone.transitions(from, to);
+    for (int i = 0; i < transitions.size(); i++)
+    {
+        const QTimeZone::OffsetData& rTransition = transitions.at(i);
+        mTransitions.push_back(rTransition.atUtc.toMSecsSinceEpoch()
+                               / 1000.0);
+        mOffsets.push_back(rTransition.offsetFromUtc);
+    }
+
+    mLastError.clear();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+Name         setFixedOffset
+
+Purpose      Makes the table a single offset from UTC, with no transitions;
+
+Input        rOffsetSeconds     Offset of local time from UTC, in seconds,
+                                east positive;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void TimeZoneTable::setFixedOffset(const int &rOffsetSeconds)
+{
+    mTransitions.clear();
+    mOffsets.assign(1, rOffsetSeconds);
+}
+
+/*----------------------------------------------------------------------------
+Name         getLastError
+
+Purpose      Returns a description of why load() last failed;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+QString TimeZoneTable::getLastError() const
+{
+    return mLastError;
+}
+
+/*----------------------------------------------------------------------------
+Name         offsetAt
+
+Purpose      Returns the offset from UTC in force at an instant;
+
+Input        rUtcSeconds        The instant, in seconds since 1970 UTC;
+
+Returns      int                Offset of local time from UTC, in seconds;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int TimeZoneTable::offsetAt(const double &rUtcSeconds) const
+{
+    size_t hint = 0;
+    return mOffsets[periodOf(rUtcSeconds, hint)];
+}
+
+/*----------------------------------------------------------------------------
+Name         toUtc
+
+Purpose      Converts a local time to UTC;
+
+Input        rLocalSeconds      Local time, in seconds since
+                                1970-01-01 00:00 local;
+
+Returns      double             The instant, in seconds since 1970 UTC;
+
+Notes        A local time repeated when the clocks go back is taken as the
+             first of the two.  A local time skipped when the clocks go
+             forward is moved forward by the size of the gap, as QDateTime
+             does;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double TimeZoneTable::toUtc(const double &rLocalSeconds) const
+{
+    size_t hint = 0;
+    return toUtc(rLocalSeconds, hint);
+}
+
+/*----------------------------------------------------------------------------
+Name         toLocal
+
+Purpose      Converts an instant to local time;
+
+Input        rUtcSeconds        The instant, in seconds since 1970 UTC;
+
+Returns      double             Local time, in seconds since
+                                1970-01-01 00:00 local;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double TimeZoneTable::toLocal(const double &rUtcSeconds) const
+{
+    return rUtcSeconds + offsetAt(rUtcSeconds);
+}
+
+/*----------------------------------------------------------------------------
+Name         toUtc
+
+Purpose      Converts an array of local times to UTC;
+
+Input        pLocalSeconds      Local times, in seconds since
+                                1970-01-01 00:00 local;
+             count              Number of entries in each array;
+
+Output       pUtcSeconds        The instants, in seconds since 1970 UTC.  May
+                                be the same array as pLocalSeconds;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void TimeZoneTable::toUtc(const double *pLocalSeconds
+                          , double *pUtcSeconds
+                          , size_t count) const
+{
+    size_t hint = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        pUtcSeconds[i] = toUtc(pLocalSeconds[i], hint);
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         toLocal
+
+Purpose      Converts an array of UTC instants to local time;
+
+Input        pUtcSeconds        The instants, in seconds since 1970 UTC;
+             count              Number of entries in each array;
+
+Output       pLocalSeconds      Local times, in seconds since
+                                1970-01-01 00:00 local.  May be the same
+                                array as pUtcSeconds;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void TimeZoneTable::toLocal(const double *pUtcSeconds
+                            , double *pLocalSeconds
+                            , size_t count) const
+{
+    size_t hint = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const double utc = pUtcSeconds[i];
+        pLocalSeconds[i] = utc + mOffsets[periodOf(utc, hint)];
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         localSeconds
+
+Purpose      Returns the local seconds of a date and a time of day, for
+             toUtc;
+
+Input        rYear              The year;
+             rMonth             The month, 1-12;
+             rDay               The day of the month;
+             rSecondsOfDay      Seconds since local midnight;
+
+Returns      double             Seconds since 1970-01-01 00:00 local;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double TimeZoneTable::localSeconds(const int &rYear
+                                   , const int &rMonth
+                                   , const int &rDay
+                                   , const double &rSecondsOfDay)
+{
+    return solarmath::epochDay(rYear, rMonth, rDay)
+            * solarmath::seconds_per_day + rSecondsOfDay;
+}
+
+/*----------------------------------------------------------------------------
+Name         getTransitionCount
+
+Purpose      Returns the number of changes of offset held by the table;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int TimeZoneTable::getTransitionCount() const
+{
+    return static_cast<int>(mTransitions.size());
+}
+
+/*----------------------------------------------------------------------------
+Name         periodOf
+
+Purpose      Returns the period holding an instant.  Period p runs from
+             transition p - 1 up to transition p, and has offset mOffsets[p];
+
+Input        rUtcSeconds        The instant;
+             rHint              Period of the last lookup;
+
+Output       rHint              Period of this lookup;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+size_t TimeZoneTable::periodOf(const double &rUtcSeconds, size_t &rHint) const
+{
+    const size_t count = mTransitions.size();
+
+    // The same period as last time, or the next, for times in order;
+    for (size_t p = qMin(rHint, count); p <= qMin(rHint + 1, count); p++)
+    {
+        if ((p == 0 || mTransitions[p - 1] <= rUtcSeconds)
+                && (p == count || rUtcSeconds < mTransitions[p]))
+        {
+            rHint = p;
+            return p;
+        }
+    }
+
+    rHint = std::upper_bound(mTransitions.begin(), mTransitions.end()
+                             , rUtcSeconds) - mTransitions.begin();
+    return rHint;
+}
+
+/*----------------------------------------------------------------------------
+Name         toUtc
+
+Purpose      Converts a local time to UTC, starting from a period;
+
+Input        rLocalSeconds      Local time, in seconds since
+                                1970-01-01 00:00 local;
+             rHint              Period of the last lookup;
+
+Output       rHint              Period of this lookup;
+
+Returns      double             The instant, in seconds since 1970 UTC;
+
+Notes        The local time less the offset of the hinted period lands within
+             a period of the answer, so only that period and its neighbours
+             are tried.  The first whose offset puts the instant inside it
+             wins, which is the earlier of a repeated local time;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+double TimeZoneTable::toUtc(const double &rLocalSeconds, size_t &rHint) const
+{
+    const size_t count = mTransitions.size();
+    const size_t guess = periodOf(rLocalSeconds
+                                  - mOffsets[qMin(rHint, count)], rHint);
+    const size_t first = (guess > 0) ? guess - 1 : 0;
+    const size_t last = qMin(guess + 1, count);
+
+    for (size_t p = first; p <= last; p++)
+    {
+        const double utc = rLocalSeconds - mOffsets[p];
+        if ((p == 0 || mTransitions[p - 1] <= utc)
+                && (p == count || utc < mTransitions[p]))
+        {
+            rHint = p;
+            return utc;
+        }
+    }
+
+    // In a gap, keep the offset from before it, which lands after it;
+    for (size_t p = first; p < last; p++)
+    {
+        if (rLocalSeconds - mOffsets[p] >= mTransitions[p]
+                && rLocalSeconds - mOffsets[p + 1] < mTransitions[p])
+        {
+            rHint = p + 1;
+            return rLocalSeconds - mOffsets[p];
+        }
+    }
+
+    return rLocalSeconds - mOffsets[guess];
+}
@@ -0,0 +1,72 @@
+/*----------------------------------------------------------------------------
+Name         timezonetable.h
+
+Purpose      Table of the UTC offsets of a time zone and the instants at which
+             they change, built once so that local times may be converted to
+             and from UTC in bulk without a QDateTime per time;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef TIMEZONETABLE_H
+#define TIMEZONETABLE_H
+
+#include <QString>
+#include <QByteArray> // USES QByteArray for the IANA zone name;
+#include <vector> // HASA std::vectors of transitions and offsets;
+
+class TimeZoneTable
+{
+public:
+    TimeZoneTable(); // Constructor, of UTC;
+
+    // Builds the table of a zone, e.g. "America/Los_Angeles", for a span of
+    // years;
+    bool load(const QByteArray& rIanaId
+              , const int& rFirstYear
+              , const int& rLastYear);
+    // Makes the table a single fixed offset from UTC;
+    void setFixedOffset(const int& rOffsetSeconds);
+    // Returns a description of why load() last failed;
+    QString getLastError(void) const;
+
+    // Returns the offset from UTC, in seconds, in force at an instant;
+    int offsetAt(const double& rUtcSeconds) const;
+
+    // Converts a local time to UTC;
+    double toUtc(const double& rLocalSeconds) const;
+    // Converts UTC to local time;
+    double toLocal(const double& rUtcSeconds) const;
+
+    // Converts an array of local times to UTC;
+    void toUtc(const double* pLocalSeconds
+               , double* pUtcSeconds
+               , size_t count) const;
+    // Converts an array of UTC instants to local time;
+    void toLocal(const double* pUtcSeconds
+                 , double* pLocalSeconds
+                 , size_t count) const;
+
+    // Returns local seconds, counted from 1970-01-01 00:00 local, of a date
+    // and a time of day;
+    static double localSeconds(const int& rYear
+                               , const int& rMonth
+                               , const int& rDay
+                               , const double& rSecondsOfDay);
+
+    int getTransitionCount(void) const; // Number of changes of offset;
+
+private:
+    // Instants, in seconds since 1970 UTC, at which the offset changes;
+    std::vector<double> mTransitions;
+    // Offset, in seconds, before the first transition and after each one;
+    std::vector<int> mOffsets;
+    QString mLastError; // Why load() last failed;
+
+    // Returns the period (index into mOffsets) holding an instant, trying
+    // the period of the last lookup first;
+    size_t periodOf(const double& rUtcSeconds, size_t& rHint) const;
+    // Converts a local time to UTC, starting the search at a period;
+    double toUtc(const double& rLocalSeconds, size_t& rHint) const;
+};
+
+#endif // TIMEZONETABLE_H
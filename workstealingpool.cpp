@@ -0,0 +1,399 @@
+/*----------------------------------------------------------------------------
+Name         workstealingpool.cpp
+
+Purpose      Pool of worker threads, each with its own queue of tasks, which
+             take work from one another when their own queue runs dry;
+
+Notes        A worker pushes and pops tasks at the back of its own queue, so
+             the work it has just created (and whose data is still in its
+             cache) is run first.  An idle worker steals from the front of
+             another's queue, taking the oldest and therefore usually largest
+             piece of work.  parallelFor relies on this: each range is split
+             in half, the upper half pushed for others to steal, until the
+             pieces reach the grain size, so the work spreads itself over the
+             workers without a central queue;
+
+             Each queue has its own mutex, which is only contended when a
+             worker is being stolen from.  Idle workers sleep on a single
+             condition and are woken as tasks are queued;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#include "workstealingpool.h"
+
+namespace
+{
+    // The pool and index of the worker running on this thread, if any;
+    thread_local const WorkStealingPool* tPool = 0;
+    thread_local int tWorkerIndex = -1;
+}
+
+// A worker's queue of tasks;
+struct WorkStealingPool::Queue
+{
+    QMutex mutex;
+    std::deque<Task> tasks;
+};
+
+// Count of a parallelFor's unfinished ranges, and a way to wait for it;
+struct WorkStealingPool::Counter
+{
+    std::atomic<int> remaining;
+    QMutex mutex;
+    QWaitCondition finished;
+};
+
+// Thread which runs WorkStealingPool::workerLoop;
+class WorkStealingPool::Worker : public QThread
+{
+public:
+    Worker(WorkStealingPool* pPool, int index)
+        : mPool(pPool)
+        , mIndex(index) {}
+
+protected:
+    void run()
+    {
+        tPool = mPool;
+        tWorkerIndex = mIndex;
+        mPool->workerLoop(mIndex);
+    }
+
+private:
+    WorkStealingPool* mPool;
+    int mIndex;
+};
+
+/*----------------------------------------------------------------------------
+Name         WorkStealingPool
+
+Purpose      Constructor, starts the worker threads;
+
+Input        threadCount        Number of workers, or zero for one per core;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+WorkStealingPool::WorkStealingPool(int threadCount)
+    : mQueued(0)
+    , mIdle(0)
+    , mStopping(false)
+    , mNextQueue(0)
+{
+    if (threadCount <= 0)
+    {
+        threadCount = qMax(1, QThread::idealThreadCount());
+    }
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        mQueues.push_back(new Queue);
+    }
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        mWorkers.push_back(new Worker(this, i));
+        mWorkers.back()->start();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         ~WorkStealingPool
+
+Purpose      Destructor, runs any tasks still queued and stops the workers;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        QMutexLocker locker(&mIdleMutex);
+        mStopping = true;
+        mWorkAvailable.wakeAll();
+    }
+
+    for (size_t i = 0; i < mWorkers.size(); i++)
+    {
+        mWorkers[i]->wait();
+        delete mWorkers[i];
+    }
+
+    for (size_t i = 0; i < mQueues.size(); i++)
+    {
+        delete mQueues[i];
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         submit
+
+Purpose      Queues a task to be run on one of the workers;
+
+Input        rTask              The task;
+
+Notes        A task submitted from a worker goes on that worker's own queue.
+             Tasks from other threads are dealt out to the queues in turn;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void WorkStealingPool::submit(const Task &rTask)
+{
+    int index = currentWorker();
+    if (index < 0)
+    {
+        index = mNextQueue++ % mQueues.size();
+    }
+
+    push(index, rTask);
+}
+
+/*----------------------------------------------------------------------------
+Name         parallelFor
+
+Purpose      Runs rBody over every index in [rBegin, rEnd), in parallel, and
+             waits for it to finish;
+
+Input        rBegin             First index;
+             rEnd               One past the last index;
+             rGrain             Largest range passed to a single call of rBody;
+             rBody              Called with a half-open range of indices.  It
+                                is called from several threads at once, so
+                                must only write to data belonging to its own
+                                indices;
+
+Notes        The calling thread takes part in the work rather than simply
+             waiting, so parallelFor may itself be called from inside a task;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void WorkStealingPool::parallelFor(const int &rBegin
+                                   , const int &rEnd
+                                   , const int &rGrain
+                                   , const RangeTask &rBody)
+{
+    if (rEnd <= rBegin)
+    {
+        return;
+    }
+
+    Counter counter;
+    counter.remaining = 1;
+
+    runRange(rBegin, rEnd, qMax(1, rGrain), rBody, &counter);
+
+    // Help with the work until every range has been run;
+    const int index = currentWorker();
+    Task task;
+    while (counter.remaining > 0)
+    {
+        if (take(qMax(0, index), task))
+        {
+            task();
+            continue;
+        }
+
+        // Nothing left to take; the remaining ranges are being run by other
+        // workers, so sleep until the last of them finishes;
+        QMutexLocker locker(&counter.mutex);
+        if (counter.remaining > 0)
+        {
+            counter.finished.wait(&counter.mutex);
+        }
+    }
+
+    // Wait for the last range to let go of the counter;
+    QMutexLocker locker(&counter.mutex);
+}
+
+/*----------------------------------------------------------------------------
+Name         getThreadCount
+
+Purpose      Returns the number of worker threads;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int WorkStealingPool::getThreadCount() const
+{
+    return static_cast<int>(mWorkers.size());
+}
+
+/*----------------------------------------------------------------------------
+Name         workerLoop
+
+Purpose      Body of each worker thread.  Runs tasks from its own queue, or
+             stolen from the others, sleeping when there are none;
+
+Input        rIndex             Index of the worker;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void WorkStealingPool::workerLoop(const int &rIndex)
+{
+    Task task;
+
+    while (true)
+    {
+        if (take(rIndex, task))
+        {
+            task();
+            task = Task();
+            continue;
+        }
+
+        QMutexLocker locker(&mIdleMutex);
+        mIdle++;
+        while (mQueued == 0 && !mStopping)
+        {
+            mWorkAvailable.wait(&mIdleMutex);
+        }
+        mIdle--;
+
+        if (mStopping && mQueued == 0)
+        {
+            break;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         push
+
+Purpose      Queues a task on a particular worker's queue and wakes an idle
+             worker to take it;
+
+Input        rIndex             Index of the queue;
+             rTask              The task;
+
+Notes        The queued count is raised before the idle count is read, and an
+             idle worker raises the idle count before reading the queued
+             count, with both holding mIdleMutex to sleep or wake, so a task
+             can not be queued without either a worker seeing it or being
+             woken for it;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void WorkStealingPool::push(const int &rIndex, const Task &rTask)
+{
+    {
+        QMutexLocker locker(&mQueues[rIndex]->mutex);
+        mQueues[rIndex]->tasks.push_back(rTask);
+    }
+
+    mQueued++;
+
+    if (mIdle > 0)
+    {
+        QMutexLocker locker(&mIdleMutex);
+        mWorkAvailable.wakeOne();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         take
+
+Purpose      Takes the newest task from a worker's own queue or, if that is
+             empty, the oldest task from another worker's queue;
+
+Input        rIndex             Index of the worker's own queue;
+
+Output       rTask              The task taken;
+
+Returns      true  -  If a task was taken;
+             false -  If every queue was empty;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+bool WorkStealingPool::take(const int &rIndex, Task &rTask)
+{
+    if (mQueued == 0)
+    {
+        return false;
+    }
+
+    {
+        Queue* pOwn = mQueues[rIndex];
+        QMutexLocker locker(&pOwn->mutex);
+        if (!pOwn->tasks.empty())
+        {
+            rTask.swap(pOwn->tasks.back());
+            pOwn->tasks.pop_back();
+            mQueued--;
+            return true;
+        }
+    }
+
+    const int count = static_cast<int>(mQueues.size());
+    for (int i = 1; i < count; i++)
+    {
+        Queue* pVictim = mQueues[(rIndex + i) % count];
+        QMutexLocker locker(&pVictim->mutex);
+        if (!pVictim->tasks.empty())
+        {
+            rTask.swap(pVictim->tasks.front());
+            pVictim->tasks.pop_front();
+            mQueued--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+Name         runRange
+
+Purpose      Runs a range of a parallelFor, pushing the upper half of the
+             range for other workers to steal until what is left is no larger
+             than the grain;
+
+Input        begin              First index of the range;
+             end                One past the last index of the range;
+             grain              Largest range run in one call of rBody;
+             rBody              Body of the loop;
+             pCounter           Count of the loop's unfinished ranges;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+void WorkStealingPool::runRange(int begin, int end, int grain
+                                , const RangeTask &rBody, Counter *pCounter)
+{
+    while (end - begin > grain)
+    {
+        const int middle = begin + (end - begin) / 2;
+        pCounter->remaining++;
+
+        const RangeTask* pBody = &rBody;
+        const int upperEnd = end;
+        submit([this, middle, upperEnd, grain, pBody, pCounter]()
+        {
+            runRange(middle, upperEnd, grain, *pBody, pCounter);
+        });
+
+        end = middle;
+    }
+
+    rBody(begin, end);
+
+    // The count is only lowered with the mutex held, and parallelFor takes
+    // the mutex before returning, so the counter can not be destroyed while
+    // the last range is still signalling it;
+    QMutexLocker locker(&pCounter->mutex);
+    if (--pCounter->remaining == 0)
+    {
+        pCounter->finished.wakeAll();
+    }
+}
+
+/*----------------------------------------------------------------------------
+Name         currentWorker
+
+Purpose      Returns the index of the calling thread in this pool;
+
+Returns      int                The worker index, or -1 if the calling thread
+                                is not one of this pool's workers;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+int WorkStealingPool::currentWorker() const
+{
+    return (tPool == this) ? tWorkerIndex : -1;
+}
@@ -0,0 +1,74 @@
+/*----------------------------------------------------------------------------
+Name         workstealingpool.h
+
+Purpose      Pool of worker threads, each with its own queue of tasks, which
+             take work from one another when their own queue runs dry;
+
+History		 17 Oct 26  AFB	Created
+----------------------------------------------------------------------------*/
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <QThread> // HASA QThread for each worker;
+#include <QMutex> // HASA QMutex for each queue and for idle workers;
+#include <QWaitCondition> // HASA QWaitCondition on which idle workers sleep;
+#include <atomic> // USES std::atomic for counts shared between threads;
+#include <deque> // HASA std::deque of tasks for each worker;
+#include <functional> // USES std::function for tasks;
+#include <vector> // HASA std::vector of queues and workers;
+
+class WorkStealingPool
+{
+public:
+    typedef std::function<void()> Task; // A unit of work;
+    // Body of a parallel loop, called with a half-open range of indices;
+    typedef std::function<void(int, int)> RangeTask;
+
+    explicit WorkStealingPool(int threadCount = 0); // Constructor;
+    ~WorkStealingPool(); // Destructor, finishes queued tasks;
+
+    // Queues a task to be run on one of the workers;
+    void submit(const Task& rTask);
+
+    // Runs rBody over [begin, end) in parallel and waits for it to finish;
+    void parallelFor(const int& rBegin
+                     , const int& rEnd
+                     , const int& rGrain
+                     , const RangeTask& rBody);
+
+    int getThreadCount(void) const; // Number of worker threads;
+
+private:
+    class Worker; // Thread which runs workerLoop;
+    struct Queue; // A worker's queue of tasks;
+    struct Counter; // Count of a parallelFor's unfinished ranges;
+
+    std::vector<Queue*> mQueues; // One queue per worker;
+    std::vector<Worker*> mWorkers; // The worker threads;
+
+    QMutex mIdleMutex; // Guards the sleep and wake of idle workers;
+    QWaitCondition mWorkAvailable; // Wakes idle workers;
+
+    std::atomic<int> mQueued; // Tasks waiting in any queue;
+    std::atomic<int> mIdle; // Workers asleep on mWorkAvailable;
+    std::atomic<bool> mStopping; // Workers should exit once drained;
+    std::atomic<unsigned> mNextQueue; // Queue for the next outside task;
+
+    // Body of each worker thread;
+    void workerLoop(const int& rIndex);
+
+    // Queues a task on a particular worker's queue;
+    void push(const int& rIndex, const Task& rTask);
+
+    // Takes a task from a worker's own queue or, failing that, steals one;
+    bool take(const int& rIndex, Task& rTask);
+
+    // Splits a range in half until it is no larger than the grain;
+    void runRange(int begin, int end, int grain
+                  , const RangeTask& rBody, Counter* pCounter);
+
+    // Index of the calling worker in this pool, or -1 if not a worker;
+    int currentWorker(void) const;
+};
+
+#endif // WORKSTEALINGPOOL_H